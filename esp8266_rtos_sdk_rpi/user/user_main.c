@@ -2,7 +2,7 @@
  * @file user_main.c
  *
  */
-/* Copyright (C) 2016 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+/* Copyright (C) 2016-2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -33,6 +33,7 @@
 
 #include "debug.h"
 
+#include "esp8266_burst.h"
 #include "esp8266_cmd.h"
 #include "esp8266_peri.h"
 #include "esp8266_rpi.h"
@@ -64,7 +65,7 @@ typedef enum conn_state {
 *
 *
 ************************************************************************/
-LOCAL const char COMPILED_STRING[] = "Compiled on "__DATE__" at "__TIME__;
+LOCAL const char COMPILED_STRING[] = "Compiled on "__DATE__" at "__TIME__" "ESP8266_BURST_SIGNATURE;
 LOCAL const uint16_t g_compiled_string_length = (uint32) sizeof(COMPILED_STRING) - 1;
 
 LOCAL const uint8_t gc_zero = (uint8_t) 0;
@@ -78,6 +79,7 @@ LOCAL char *g_host_name;
 LOCAL uint32_t g_host_name_length;
 LOCAL int32 g_sock_fd = -1;
 LOCAL int16_t g_port_udp_begin;
+LOCAL bool g_is_burst = false;	///< Negotiated with the Pi, see esp8266_burst.h
 LOCAL xTaskHandle g_task_rpi_handle = NULL;
 
 LOCAL int8_t g_recvfrom_buffer[UDP_BUFFER_SIZE];
@@ -302,6 +304,105 @@ void ICACHE_FLASH_ATTR ota_rpi_write_bytes(uint8_t *p, uint16_t nLength)  {
 	return;
 }
 
+/*
+ * Burst transfers, see esp8266_burst.h
+ * The Pi raises its control line for the low nibble and lowers it for the high nibble.
+ */
+
+/**
+ *
+ * @param is_high
+ * @param timeout_us
+ * @return false on a timeout
+ */
+static bool IRAM_ATTR rpi_wait_ctrl_in(bool is_high, uint32_t timeout_us) {
+	const uint32_t micros_now = system_get_time();
+
+	while (((GPI & (uint32_t) (1 << ESP8266_RPI_CTRL_IN)) != 0) != is_high) {
+		if (system_get_time() - micros_now > timeout_us) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Back to the command level: our control line low, wait for the Pi to time out as well
+ */
+static void IRAM_ATTR rpi_burst_resync(void) {
+	GPOC = (uint32_t) (1 << ESP8266_RPI_CTRL_OUT);
+	(void) rpi_wait_ctrl_in(false, 2 * ESP8266_BURST_TIMEOUT_US);
+}
+
+/**
+ *
+ * @param p
+ * @param nLength
+ * @return false on a timeout
+ */
+static bool IRAM_ATTR rpi_read_burst(uint8_t *p, uint16_t nLength) {
+	uint16_t i;
+	uint8_t data;
+
+	data_gpio_fsel_input();
+
+	for (i = 0; i < nLength; i++) {
+		if (!rpi_wait_ctrl_in(true, ESP8266_BURST_TIMEOUT_US)) {
+			rpi_burst_resync();
+			return false;
+		}
+		data = (GPI >> 12) & 0x0F;
+		GPOS = (uint32_t) (1 << ESP8266_RPI_CTRL_OUT);
+
+		if (!rpi_wait_ctrl_in(false, ESP8266_BURST_TIMEOUT_US)) {
+			rpi_burst_resync();
+			return false;
+		}
+		data |= ((GPI >> 12) & 0x0F) << 4;
+		GPOC = (uint32_t) (1 << ESP8266_RPI_CTRL_OUT);
+
+		p[i] = data;
+	}
+
+	return true;
+}
+
+/**
+ *
+ * @param p
+ * @param nLength
+ * @return false on a timeout
+ */
+static bool IRAM_ATTR rpi_write_burst(const uint8_t *p, uint16_t nLength) {
+	uint16_t i;
+	uint32_t out_gpio;
+
+	data_gpio_fsel_output();
+
+	for (i = 0; i < nLength; i++) {
+		if (!rpi_wait_ctrl_in(true, ESP8266_BURST_TIMEOUT_US)) {
+			rpi_burst_resync();
+			return false;
+		}
+		out_gpio = (p[i] & 0x0F) << 12;
+		GPOS = out_gpio;
+		GPOC = out_gpio ^ (0x0F << 12);
+		GPOS = (uint32_t) (1 << ESP8266_RPI_CTRL_OUT);
+
+		if (!rpi_wait_ctrl_in(false, ESP8266_BURST_TIMEOUT_US)) {
+			rpi_burst_resync();
+			return false;
+		}
+		out_gpio = ((p[i] >> 4) & 0x0F) << 12;
+		GPOS = out_gpio;
+		GPOC = out_gpio ^ (0x0F << 12);
+		GPOC = (uint32_t) (1 << ESP8266_RPI_CTRL_OUT);
+	}
+
+	return true;
+}
+
 /**
  *
  * @param lhs
@@ -524,6 +625,9 @@ void ICACHE_FLASH_ATTR reply_with_sdk_version(void) {
 void ICACHE_FLASH_ATTR reply_with_firmware_version(void) {
   printf("reply_with_firmware_version : %s[%d]\n", COMPILED_STRING, g_compiled_string_length);
 
+  // Every Pi reads the version at start-up, burst mode must be requested again
+  g_is_burst = false;
+
   rpi_write_bytes((uint8_t *)COMPILED_STRING, g_compiled_string_length);
   rpi_write_bytes((uint8_t *)&gc_zero, 1);
 
@@ -531,12 +635,20 @@ void ICACHE_FLASH_ATTR reply_with_firmware_version(void) {
 
 /**
  *
+ * @return false when burst mode was requested, no socket is opened
  */
-void ICACHE_FLASH_ATTR handle_udp_begin(void) {
+bool ICACHE_FLASH_ATTR handle_udp_begin(void) {
 	printf("handle_udp_begin\n");
 
 	g_port_udp_begin = rpi_read_halfword();
 
+	if (g_port_udp_begin == ESP8266_BURST_REQUEST_PORT) {
+		const uint8_t ack = ESP8266_BURST_ACK;
+		rpi_write_bytes((uint8_t *) &ack, 1);
+		g_is_burst = true;
+		return false;
+	}
+
 	if (g_sock_fd != -1) {
 		close(g_sock_fd);
 		g_sock_fd = -1;
@@ -570,6 +682,8 @@ void ICACHE_FLASH_ATTR handle_udp_begin(void) {
 	} while (ret != 0);
 
     setsockopt(g_sock_fd,SOL_SOCKET,SO_RCVTIMEO,(void *)&recv_timeout,sizeof(recv_timeout));
+
+    return true;
 }
 
 /**
@@ -760,18 +874,32 @@ void ICACHE_FLASH_ATTR reply_with_wifi_station_status(void) {
 void IRAM_ATTR reply_with_udp_packet(void) {
 	struct sockaddr_in address_remote;
 	int slen = sizeof(address_remote);
-	size_t len;
-
-	if ((len = recvfrom(g_sock_fd, g_recvfrom_buffer, UDP_BUFFER_SIZE, 0, (struct sockaddr * )&address_remote, &slen)) == -1) {
-		const uint16_t data = 0;
-		rpi_write_bytes((uint8_t *) &data, 2);
+	int len;
+
+	if ((len = recvfrom(g_sock_fd, g_recvfrom_buffer, UDP_BUFFER_SIZE, 0, (struct sockaddr * )&address_remote, &slen)) < 0) {
+		if (g_is_burst) {
+			(void) esp8266_burst_send(rpi_write_burst, NULL, 0, NULL, 0);
+		} else {
+			const uint16_t data = 0;
+			rpi_write_bytes((uint8_t *) &data, 2);
+		}
 	} else {
-		rpi_write_bytes((uint8_t *) &len, 2);
 		const uint32_t ip = address_remote.sin_addr.s_addr;
-		rpi_write_bytes((uint8_t *) &ip, 4);
 		const uint16_t port = address_remote.sin_port;
-		rpi_write_bytes((uint8_t *) &port, 2);
-		rpi_write_bytes((uint8_t *) g_recvfrom_buffer, len);
+
+		if (g_is_burst) {
+			uint8_t header[ESP8266_BURST_UDP_HEADER_SIZE];
+
+			memcpy(&header[0], &ip, 4);
+			memcpy(&header[4], &port, 2);
+
+			(void) esp8266_burst_send(rpi_write_burst, header, ESP8266_BURST_UDP_HEADER_SIZE, (uint8_t *) g_recvfrom_buffer, (uint16_t) len);
+		} else {
+			rpi_write_bytes((uint8_t *) &len, 2);
+			rpi_write_bytes((uint8_t *) &ip, 4);
+			rpi_write_bytes((uint8_t *) &port, 2);
+			rpi_write_bytes((uint8_t *) g_recvfrom_buffer, (uint16_t) len);
+		}
 	}
 }
 
@@ -783,17 +911,33 @@ void IRAM_ATTR handle_udp_packet(void) {
 
 	struct sockaddr_in address_remote;
 	int slen = sizeof(address_remote);
+	uint32_t ip_address;
+	uint16_t port;
+	int32_t len;
 
-	const uint16_t len = rpi_read_halfword();
-	const uint32_t ip_address = rpi_read_word();
-	const uint16_t port = rpi_read_halfword();
-	rpi_read_bytes((uint8_t *) g_sendto_buffer, len);
+	if (g_is_burst) {
+		uint8_t header[ESP8266_BURST_UDP_HEADER_SIZE];
+
+		len = esp8266_burst_receive(rpi_read_burst, header, ESP8266_BURST_UDP_HEADER_SIZE, (uint8_t *) g_sendto_buffer, UDP_BUFFER_SIZE);
+
+		if (len <= 0) {
+			return;
+		}
+
+		memcpy(&ip_address, &header[0], 4);
+		memcpy(&port, &header[4], 2);
+	} else {
+		len = rpi_read_halfword();
+		ip_address = rpi_read_word();
+		port = rpi_read_halfword();
+		rpi_read_bytes((uint8_t *) g_sendto_buffer, (uint16_t) len);
+	}
 
 	address_remote.sin_family = AF_INET;
 	address_remote.sin_addr.s_addr = ip_address;
 	address_remote.sin_port = htons(port);
 
-	if ((sendto(g_sock_fd, g_sendto_buffer, len, 0, (const struct sockaddr * )&address_remote, slen)) == -1) {
+	if ((sendto(g_sock_fd, g_sendto_buffer, (len < UDP_BUFFER_SIZE) ? len : UDP_BUFFER_SIZE, 0, (const struct sockaddr * )&address_remote, slen)) == -1) {
 		printf("ERROR sendto\n");
 	}
 }
@@ -850,8 +994,9 @@ void IRAM_ATTR task_rpi(void *pvParameters) {
 			reply_with_ip_config();
 			break;
 		case CMD_UDP_BEGIN:
-			handle_udp_begin();
-			vTaskDelay(10000 / portTICK_RATE_MS);
+			if (handle_udp_begin()) {
+				vTaskDelay(10000 / portTICK_RATE_MS);
+			}
 			break;
 		case CMD_UPD_JOIN_GROUP:
 			handle_udp_join_group();
@@ -110,6 +110,7 @@ private:
 	void HandleTrigger(void);
 	void ActiveUniversesAdd(uint16_t nUniverse);
 	void ActiveUniversesClear(void);
+	void SendDmx(uint32_t nIp, const uint8_t *pDmxData, uint16_t nLength);
 
 private:
 	struct TArtNetController m_tArtNetController;
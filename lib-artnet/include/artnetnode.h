@@ -55,6 +55,11 @@ enum TArtNetNodeMaxPorts {
 	ARTNET_NODE_MAX_PORTS_INPUT = ARTNET_MAX_PORTS
 };
 
+#define ARTNET_POLLREPLY_JITTER_MAX_MILLIS	1000	///< The largest random delay of an ArtPollReply, 1 second
+#define ARTNET_POLLREPLY_MIN_INTERVAL_MILLIS	100		///< Between the replies to ArtPoll
+#define ARTNET_RDM_QUEUE_ENTRIES				(1 << 2)	///< ArtRdm requests waiting for the RDM transaction in progress
+#define ARTNET_RDM_QUEUE_MASK					(ARTNET_RDM_QUEUE_ENTRIES - 1)
+
 
 /**
  * Table 3 – NodeReport Codes
@@ -86,6 +91,12 @@ enum TNodeStatus {
 	ARTNET_ON		///<
 };
 
+enum TTodControl {
+	TOD_CONTROL_NONE,	///<
+	TOD_CONTROL_SEND,	///< AtcNone : send the TOD
+	TOD_CONTROL_FLUSH	///< AtcFlush : full discovery, then send the TOD
+};
+
 struct TArtNetNodeState {
 	uint32_t ArtPollReplyCount;			///< ArtPollReply : NodeReport : decimal counter that increments every time the Node sends an ArtPollResponse.
 	uint32_t IPAddressDiagSend;			///< ArtPoll : Destination IPAddress for the ArtDiag
@@ -152,6 +163,12 @@ struct TInputPort {
 	uint32_t nDestinationIp;
 };
 
+struct TArtNetRdmRequest {
+	uint32_t nIPAddressFrom;
+	uint8_t nPort;
+	struct TArtRdm ArtRdm;		///< The request, the response is copied into RdmPacket
+};
+
 class ArtNetNode {
 public:
 	ArtNetNode(uint8_t nVersion = 3, uint8_t nPages = 1);
@@ -281,6 +298,17 @@ public:
 
 	void SetArtNet4Handler(ArtNet4Handler *pArtNet4Handler);
 
+	/**
+	 * The reply to an ArtPoll is delayed a random time up to nMillis.
+	 * Default is 0, the reply is sent immediately.
+	 */
+	void SetPollReplyJitter(uint32_t nMillis) {
+		m_nPollReplyJitterMillis = (nMillis <= ARTNET_POLLREPLY_JITTER_MAX_MILLIS) ? nMillis : ARTNET_POLLREPLY_JITTER_MAX_MILLIS;
+	}
+	uint32_t GetPollReplyJitter(void) {
+		return m_nPollReplyJitterMillis;
+	}
+
 	void Print(void);
 
 private:
@@ -299,7 +327,15 @@ private:
 	void HandleTimeSync(void);
 	void HandleTodRequest(void);
 	void HandleTodControl(void);
+	void RunTodControl(void);
 	void HandleRdm(void);
+	void RunRdm(void);
+	/*
+	 * The LightSet of the port is stopped, it is (re)started when the transaction is done
+	 */
+	bool IsRdmPending(uint32_t nPort) const {
+		return m_bIsRdmPending && (m_pRdmRequests[m_nRdmRequestTail & ARTNET_RDM_QUEUE_MASK].nPort == nPort);
+	}
 	void HandleIpProg(void);
 	void HandleDmxIn(void);
 	void HandleTrigger(void);
@@ -310,6 +346,8 @@ private:
 	void CheckMergeTimeouts(uint8_t);
 	bool IsDmxDataChanged(uint8_t, const uint8_t *, uint16_t);
 
+	void BuildPollReply(uint32_t nPage);
+	void SchedulePollReply(void);
 	void SendPollRelply(bool);
 	void SendTod(uint8_t nPortId = 0);
 
@@ -335,13 +373,25 @@ private:
 	struct TArtNetNodeState m_State;
 
 	struct TArtNetPacket m_ArtNetPacket;
-	struct TArtPollReply m_PollReply;
+	struct TArtPollReply m_PollReply;		///< The fields that are the same for all pages
+	struct TArtPollReply *m_pPollReplies;	///< Per page, built when m_bIsPollReplyValid is false
+	bool m_bIsPollReplyValid;
+	bool m_bIsPollReplyPending;
+	uint32_t m_nPollReplyJitterMillis;
+	uint32_t m_nPollReplyMillis;			///< Latest reply sent
+	uint32_t m_nPollReplyDueMillis;
 #if defined ( ENABLE_SENDDIAG )
 	struct TArtDiagData m_DiagData;
 #endif
 	struct TArtTimeCode *m_pTimeCodeData;
 	struct TArtTodData *m_pTodData;
 	struct TArtIpProgReply *m_pIpProgReply;
+	struct TArtNetRdmRequest *m_pRdmRequests;	///< Ring of ARTNET_RDM_QUEUE_ENTRIES
+	uint32_t m_nRdmRequestHead;
+	uint32_t m_nRdmRequestTail;
+	bool m_bIsRdmPending;						///< The request at m_nRdmRequestTail is on the wire
+	uint8_t m_TodControl[ARTNET_NODE_MAX_PORTS_OUTPUT];	///< TTodControl, done when no RDM transaction is pending
+	bool m_bIsTodControlPending;
 
 	struct TOutputPort m_OutputPorts[ARTNET_NODE_MAX_PORTS_OUTPUT];
 	struct TInputPort m_InputPorts[ARTNET_NODE_MAX_PORTS_INPUT];
@@ -357,6 +407,8 @@ private:
 	bool m_IsRdmResponder;
 
 	alignas(uint32_t) char m_aSysName[16];
+	char m_aNodeReportSuffix[sizeof m_aSysName + 8];	///< "<m_aSysName> AvV" of the NodeReport
+	uint32_t m_nNodeReportSuffixLength;
 	alignas(uint32_t) char m_aDefaultNodeLongName[ARTNET_LONG_NAME_LENGTH];
 
 public:
@@ -61,6 +61,7 @@ struct TArtNetParams {
 	bool bEnableNoChangeUpdate;						///< 1	118
 	uint8_t nDirection;								///< 1	119
 	uint32_t nDestinationIpPort[ARTNET_MAX_PORTS];	///< 16	135
+	uint16_t nPollReplyJitter;						///< 2	137
 #if defined (__linux__)
 }__attribute__((packed));
 #else
@@ -103,7 +104,8 @@ enum TArtnetParamsMask {
 	ARTNET_PARAMS_MASK_PROTOCOL_C = (1 << 25),
 	ARTNET_PARAMS_MASK_PROTOCOL_D = (1 << 26),
 	ARTNET_PARAMS_MASK_ENABLE_NO_CHANGE_OUTPUT = (1 << 27),
-	ARTNET_PARAMS_MASK_DIRECTION = (1 << 28)
+	ARTNET_PARAMS_MASK_DIRECTION = (1 << 28),
+	ARTNET_PARAMS_MASK_POLL_REPLY_JITTER = (1 << 29)
 };
 
 class ArtNetParamsStore {
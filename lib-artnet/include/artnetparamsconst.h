@@ -50,6 +50,7 @@ public:
 	static const char PROTOCOL[];
 	static const char PROTOCOL_PORT[ARTNET_MAX_PORTS][16];
 	static const char DIRECTION[];
+	static const char POLL_REPLY_JITTER[];
 	static const char DESTINATION_IP_PORT[ARTNET_MAX_PORTS][24];
 };
 
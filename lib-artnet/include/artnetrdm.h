@@ -33,6 +33,7 @@
 
 class ArtNetRdm {
 public:
+	ArtNetRdm(void): m_pHandlerResponse(0) {}
 	virtual ~ArtNetRdm(void) {}
 
 	virtual void Full(uint8_t nPort)=0;
@@ -40,6 +41,25 @@ public:
 	virtual void Copy(uint8_t nPort, uint8_t *)=0;
 
 	virtual const uint8_t *Handler(uint8_t nPort, const uint8_t *)=0;
+
+	/*
+	 * Non-blocking Handler(), called from ArtNetNode::Run.
+	 * HandlerStart returns false when the port is busy, try again later.
+	 * HandlerPoll returns true when the transaction is done, pResponse is 0 when there is no response.
+	 * The default runs the blocking Handler().
+	 */
+	virtual bool HandlerStart(uint8_t nPort, const uint8_t *pRdmData) {
+		m_pHandlerResponse = Handler(nPort, pRdmData);
+		return true;
+	}
+
+	virtual bool HandlerPoll(__attribute__((unused)) uint8_t nPort, const uint8_t*& pResponse) {
+		pResponse = m_pHandlerResponse;
+		return true;
+	}
+
+private:
+	const uint8_t *m_pHandlerResponse;
 };
 
 #endif /* ARTNETRDM_H_ */
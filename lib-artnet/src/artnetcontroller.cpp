@@ -145,16 +145,6 @@ void ArtNetController::HandleDmxOut(uint16_t nUniverse, const uint8_t *pDmxData,
 		m_pArtDmx->Sequence = 1;
 	}
 
-	if (__builtin_expect((m_nMaster == DMX_MAX_VALUE), 1)) {
-		memcpy(m_pArtDmx->Data, pDmxData, nLength);
-	} else if (m_nMaster == 0) {
-		memset(m_pArtDmx->Data, 0, nLength);
-	} else {
-		for (uint32_t i = 0; i < nLength; i++) {
-			m_pArtDmx->Data[i] = (m_nMaster * static_cast<uint32_t>(pDmxData[i])) / DMX_MAX_VALUE;
-		}
-	}
-
 	uint32_t nCount = 0;
 	struct TArtNetPollTableUniverses *IpAddresses = const_cast<struct TArtNetPollTableUniverses*>(GetIpAddress(nUniverse));
 
@@ -171,7 +161,7 @@ void ArtNetController::HandleDmxOut(uint16_t nUniverse, const uint8_t *pDmxData,
 
 	if (m_bUnicast && (nCount <= 40)) {
 		for (uint32_t nIndex = 0; nIndex < nCount; nIndex++) {
-			Network::Get()->SendTo(m_nHandle, m_pArtDmx, sizeof(struct TArtDmx), IpAddresses->pIpAddresses[nIndex], ARTNET_UDP_PORT);
+			SendDmx(IpAddresses->pIpAddresses[nIndex], pDmxData, nLength);
 		}
 
 		m_bDmxHandled = true;
@@ -181,7 +171,7 @@ void ArtNetController::HandleDmxOut(uint16_t nUniverse, const uint8_t *pDmxData,
 	}
 
 	if (!m_bUnicast || (nCount > 40)) {
-		Network::Get()->SendTo(m_nHandle, m_pArtDmx, sizeof(struct TArtDmx), m_tArtNetController.nIPAddressBroadcast, ARTNET_UDP_PORT);
+		SendDmx(m_tArtNetController.nIPAddressBroadcast, pDmxData, nLength);
 
 		m_bDmxHandled = true;
 	}
@@ -189,6 +179,29 @@ void ArtNetController::HandleDmxOut(uint16_t nUniverse, const uint8_t *pDmxData,
 	DEBUG_EXIT
 }
 
+/*
+ * The ArtDmx packet is built directly in the network send buffer:
+ * the header from m_pArtDmx, the data with the master applied.
+ * With pDmxData == 0 the data is all zero (blackout).
+ */
+void ArtNetController::SendDmx(uint32_t nIp, const uint8_t *pDmxData, uint16_t nLength) {
+	struct TArtDmx *pArtDmx = reinterpret_cast<struct TArtDmx*>(Network::Get()->GetSendBuffer());
+
+	memcpy(pArtDmx, m_pArtDmx, sizeof(struct TArtDmx) - ARTNET_DMX_LENGTH);
+
+	if (__builtin_expect(((pDmxData != 0) && (m_nMaster == DMX_MAX_VALUE)), 1)) {
+		memcpy(pArtDmx->Data, pDmxData, nLength);
+	} else if ((pDmxData == 0) || (m_nMaster == 0)) {
+		memset(pArtDmx->Data, 0, nLength);
+	} else {
+		for (uint32_t i = 0; i < nLength; i++) {
+			pArtDmx->Data[i] = (m_nMaster * static_cast<uint32_t>(pDmxData[i])) / DMX_MAX_VALUE;
+		}
+	}
+
+	Network::Get()->SendBuffer(m_nHandle, sizeof(struct TArtDmx) - ARTNET_DMX_LENGTH + nLength, nIp, ARTNET_UDP_PORT);
+}
+
 void ArtNetController::HandleSync(void) {
 	if (m_bSynchronization && m_bDmxHandled) {
 		m_bDmxHandled = false;
@@ -200,8 +213,6 @@ void ArtNetController::HandleBlackout(void) {
 	m_pArtDmx->LengthHi = (512 & 0xFF00) >> 8;
 	m_pArtDmx->Length = (512 & 0xFF);
 
-	memset(m_pArtDmx->Data, 0, 512);
-
 	for (uint32_t nIndex = 0; nIndex < m_nActiveUniverses; nIndex++) {
 		m_pArtDmx->PortAddress = s_ActiveUniverses[nIndex];
 
@@ -226,7 +237,7 @@ void ArtNetController::HandleBlackout(void) {
 			}
 
 			for (uint32_t nIndex = 0; nIndex < nCount; nIndex++) {
-				Network::Get()->SendTo(m_nHandle, m_pArtDmx, sizeof(struct TArtDmx), IpAddresses->pIpAddresses[nIndex], ARTNET_UDP_PORT);
+				SendDmx(IpAddresses->pIpAddresses[nIndex], 0, 512);
 			}
 
 			continue;
@@ -241,7 +252,7 @@ void ArtNetController::HandleBlackout(void) {
 				m_pArtDmx->Sequence = 1;
 			}
 
-			Network::Get()->SendTo(m_nHandle, m_pArtDmx, sizeof(struct TArtDmx), m_tArtNetController.nIPAddressBroadcast, ARTNET_UDP_PORT);
+			SendDmx(m_tArtNetController.nIPAddressBroadcast, 0, 512);
 		}
 
 	}
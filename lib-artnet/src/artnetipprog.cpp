@@ -80,6 +80,8 @@ void ArtNetNode::HandleIpProg(void) {
 			memcpy(m_PollReply.BindIp, &m_pIpProgReply->ProgIpHi, ARTNET_IP_SIZE);
 		}
 
+		m_bIsPollReplyValid = false;
+
 		if (m_State.SendArtPollReplyOnChange) {
 			SendPollRelply(true);
 		}
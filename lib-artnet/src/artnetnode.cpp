@@ -49,6 +49,8 @@
 #include "hardware.h"
 #include "network.h"
 #include "ledblink.h"
+#include "metrics.h"
+#include "profiler.h"
 
 #include "artnetnode_internal.h"
 
@@ -79,6 +81,62 @@ static const uint8_t DEVICE_SOFTWARE_VERSION[] = { 1, 45 };
 
 #define PORT_IN_STATUS_DISABLED_MASK	0x08
 
+static struct metric s_MetricPackets = METRIC_COUNTER("artnet.rx.packets");
+static struct metric s_MetricDmxPackets = METRIC_COUNTER("artnet.dmx.packets");
+static struct metric s_MetricDmxMerged = METRIC_COUNTER("artnet.dmx.merged");
+static struct metric s_MetricDmxDiscarded = METRIC_COUNTER("artnet.dmx.discarded");
+static struct metric s_MetricDmxUpdates = METRIC_COUNTER("artnet.dmx.updates");
+static struct metric s_MetricPollReplies = METRIC_COUNTER("artnet.pollreply.sent");
+static struct metric s_MetricPollReplyBuilds = METRIC_COUNTER("artnet.pollreply.builds");
+static struct metric s_MetricPollReplyCoalesced = METRIC_COUNTER("artnet.pollreply.coalesced");
+
+static uint32_t s_nRandom = 1;
+
+/*
+ * xorshift32, for the ArtPollReply jitter only
+ */
+static uint32_t random_next(void) {
+	s_nRandom ^= s_nRandom << 13;
+	s_nRandom ^= s_nRandom >> 17;
+	s_nRandom ^= s_nRandom << 5;
+	return s_nRandom;
+}
+
+/*
+ * The "%04x [%04d] " of the NodeReport, returns the length
+ */
+static uint32_t node_report_prefix(char *pReport, uint32_t nCode, uint32_t nCount) {
+	static const char aHex[] = "0123456789abcdef";
+	char aDigits[10];
+	uint32_t nDigits = 0;
+	uint32_t i = 0;
+
+	for (int32_t nShift = 12; nShift >= 0; nShift -= 4) {
+		pReport[i++] = aHex[(nCode >> nShift) & 0xF];
+	}
+
+	pReport[i++] = ' ';
+	pReport[i++] = '[';
+
+	do {
+		aDigits[nDigits++] = static_cast<char>('0' + (nCount % 10));
+		nCount /= 10;
+	} while (nCount != 0);
+
+	while (nDigits < 4) {
+		aDigits[nDigits++] = '0';
+	}
+
+	while (nDigits != 0) {
+		pReport[i++] = aDigits[--nDigits];
+	}
+
+	pReport[i++] = ']';
+	pReport[i++] = ' ';
+
+	return i;
+}
+
 ArtNetNode *ArtNetNode::s_pThis = 0;
 
 ArtNetNode::ArtNetNode(uint8_t nVersion, uint8_t nPages) :
@@ -95,9 +153,20 @@ ArtNetNode::ArtNetNode(uint8_t nVersion, uint8_t nPages) :
 	m_pArtNetDmx(0),
 	m_pArtNetTrigger(0),
 	m_pArtNet4Handler(0),
+	m_pPollReplies(0),
+	m_bIsPollReplyValid(false),
+	m_bIsPollReplyPending(false),
+	m_nPollReplyJitterMillis(0),
+	m_nPollReplyMillis(0),
+	m_nPollReplyDueMillis(0),
 	m_pTimeCodeData(0),
 	m_pTodData(0),
 	m_pIpProgReply(0),
+	m_pRdmRequests(0),
+	m_nRdmRequestHead(0),
+	m_nRdmRequestTail(0),
+	m_bIsRdmPending(false),
+	m_bIsTodControlPending(false),
 	m_bDirectUpdate(false),
 	m_nCurrentPacketMillis(0),
 	m_nPreviousPacketMillis(0),
@@ -113,6 +182,9 @@ ArtNetNode::ArtNetNode(uint8_t nVersion, uint8_t nPages) :
 	m_Node.Status1 = STATUS1_INDICATOR_NORMAL_MODE | STATUS1_PAP_FRONT_PANEL;
 	m_Node.Status2 = STATUS2_PORT_ADDRESS_15BIT | (m_nVersion > 3 ? STATUS2_SACN_ABLE_TO_SWITCH : STATUS2_SACN_NO_SWITCH);
 
+	m_pPollReplies = new struct TArtPollReply[m_nPages];
+	assert(m_pPollReplies != 0);
+
 	memset(&m_State, 0, sizeof (struct TArtNetNodeState));
 	m_State.reportCode = ARTNET_RCPOWEROK;
 	m_State.status = ARTNET_STANDBY;
@@ -120,6 +192,7 @@ ArtNetNode::ArtNetNode(uint8_t nVersion, uint8_t nPages) :
 
 	for (uint32_t i = 0; i < ARTNET_NODE_MAX_PORTS_OUTPUT; i++) {
 		m_IsLightSetRunning[i] = false;
+		m_TodControl[i] = TOD_CONTROL_NONE;
 		memset(&m_OutputPorts[i], 0 , sizeof(struct TOutputPort));
 	}
 
@@ -142,6 +215,9 @@ ArtNetNode::ArtNetNode(uint8_t nVersion, uint8_t nPages) :
 	const char *pSysName = Hardware::Get()->GetSysName(nSysNameLenght);
 	strncpy(m_aSysName, pSysName, (sizeof m_aSysName) - 1);
 	m_aSysName[(sizeof m_aSysName) - 1] = '\0';
+
+	snprintf(m_aNodeReportSuffix, sizeof m_aNodeReportSuffix, "%s AvV", m_aSysName);
+	m_nNodeReportSuffixLength = strlen(m_aNodeReportSuffix);
 }
 
 ArtNetNode::~ArtNetNode(void) {
@@ -151,6 +227,10 @@ ArtNetNode::~ArtNetNode(void) {
 		delete m_pTodData;
 	}
 
+	if (m_pRdmRequests != 0) {
+		delete[] m_pRdmRequests;
+	}
+
 	if (m_pIpProgReply != 0) {
 		delete m_pIpProgReply;
 	}
@@ -158,12 +238,23 @@ ArtNetNode::~ArtNetNode(void) {
 	if (m_pTimeCodeData != 0) {
 		delete m_pTimeCodeData;
 	}
+
+	delete[] m_pPollReplies;
 }
 
 void ArtNetNode::Start(void) {
 	assert(Network::Get() != 0);
 	assert(LedBlink::Get() != 0);
 
+	metrics_register(&s_MetricPackets);
+	metrics_register(&s_MetricDmxPackets);
+	metrics_register(&s_MetricDmxMerged);
+	metrics_register(&s_MetricDmxDiscarded);
+	metrics_register(&s_MetricDmxUpdates);
+	metrics_register(&s_MetricPollReplies);
+	metrics_register(&s_MetricPollReplyBuilds);
+	metrics_register(&s_MetricPollReplyCoalesced);
+
 	m_Node.IPAddressLocal = Network::Get()->GetIp();
 	m_Node.IPAddressBroadcast = m_Node.IPAddressLocal | ~(Network::Get()->GetNetmask());
 
@@ -173,6 +264,15 @@ void ArtNetNode::Start(void) {
 	m_Node.Status2 = (m_Node.Status2 & ~(STATUS2_DHCP_CAPABLE)) | (Network::Get()->IsDhcpCapable() ? STATUS2_DHCP_CAPABLE : 0);
 
 	FillPollReply();
+
+	s_nRandom ^= m_Node.IPAddressLocal ^ Hardware::Get()->Micros();
+
+	if (s_nRandom == 0) {
+		s_nRandom = 1;
+	}
+
+	m_bIsPollReplyPending = false;
+	m_nCurrentPacketMillis = Hardware::Get()->Millis();
 #if defined ( ENABLE_SENDDIAG )
 	FillDiagData();
 #endif
@@ -210,7 +310,9 @@ void ArtNetNode::Stop(void) {
 	if (m_pLightSet != 0) {
 		for (uint32_t i = 0; i < ARTNET_NODE_MAX_PORTS_OUTPUT; i++) {
 			if ((m_OutputPorts[i].tPortProtocol == PORT_ARTNET_ARTNET) && (m_IsLightSetRunning[i])) {
-				m_pLightSet->Stop(i);
+				if (!IsRdmPending(i)) {
+					m_pLightSet->Stop(i);
+				}
 				m_IsLightSetRunning[i] = false;
 			}
 		}
@@ -246,6 +348,8 @@ int ArtNetNode::SetUniverseSwitch(uint8_t nPortIndex, TArtNetPortDir dir, uint8_
 			}
 		}
 
+		m_bIsPollReplyValid = false;
+
 		return ARTNET_EOK;
 	}
 
@@ -285,6 +389,8 @@ int ArtNetNode::SetUniverseSwitch(uint8_t nPortIndex, TArtNetPortDir dir, uint8_
 		}
 	}
 
+	m_bIsPollReplyValid = false;
+
 	if ((m_pArtNet4Handler != 0) && (m_State.status != ARTNET_ON)) {
 		m_pArtNet4Handler->SetPort(nPortIndex, dir);
 	}
@@ -325,6 +431,7 @@ void ArtNetNode::SetSubnetSwitch(uint8_t nAddress, uint8_t nPage) {
 	assert(nPage < ARTNET_MAX_PAGES);
 
 	m_Node.SubSwitch[nPage] = nAddress;
+	m_bIsPollReplyValid = false;
 
 	const uint32_t nPortIndexStart = nPage * ARTNET_MAX_PORTS;
 
@@ -349,6 +456,7 @@ void ArtNetNode::SetNetSwitch(uint8_t nAddress, uint8_t nPage) {
 	assert(nPage < ARTNET_MAX_PAGES);
 
 	m_Node.NetSwitch[nPage] = nAddress;
+	m_bIsPollReplyValid = false;
 
 	const uint32_t nPortIndexStart = nPage * ARTNET_MAX_PORTS;
 
@@ -463,6 +571,7 @@ void ArtNetNode::SetShortName(const char *pShortName) {
 	m_Node.ShortName[ARTNET_SHORT_NAME_LENGTH - 1] = '\0';
 
 	memcpy(m_PollReply.ShortName, m_Node.ShortName, ARTNET_SHORT_NAME_LENGTH);
+	m_bIsPollReplyValid = false;
 
 	if (m_State.status == ARTNET_ON) {
 		if (m_pArtNetStore != 0) {
@@ -481,6 +590,7 @@ void ArtNetNode::SetLongName(const char *pLongName) {
 	m_Node.LongName[ARTNET_LONG_NAME_LENGTH - 1] = '\0';
 
 	memcpy(m_PollReply.LongName, m_Node.LongName, ARTNET_LONG_NAME_LENGTH);
+	m_bIsPollReplyValid = false;
 
 	if (m_State.status == ARTNET_ON) {
 		if (m_pArtNetStore != 0) {
@@ -541,6 +651,82 @@ void ArtNetNode::FillPollReply(void) {
 	m_PollReply.Status2 = m_Node.Status2;
 
 	m_PollReply.NumPortsLo = 4; // Default
+
+	m_bIsPollReplyValid = false;
+}
+
+/*
+ * The fields that change only with the configuration
+ */
+void ArtNetNode::BuildPollReply(uint32_t nPage) {
+	struct TArtPollReply *pPollReply = &m_pPollReplies[nPage];
+
+	memcpy(pPollReply, &m_PollReply, sizeof(struct TArtPollReply));
+
+	pPollReply->Status2 = m_Node.Status2;
+
+	pPollReply->NetSwitch = m_Node.NetSwitch[nPage];
+	pPollReply->SubSwitch = m_Node.SubSwitch[nPage];
+
+	pPollReply->BindIndex = nPage + 1;
+
+	const uint32_t nPortIndexStart = nPage * ARTNET_MAX_PORTS;
+
+	uint32_t NumPortsLo = 0;
+
+	for (uint32_t nPortIndex = nPortIndexStart; nPortIndex < (nPortIndexStart + ARTNET_MAX_PORTS); nPortIndex++) {
+		if (m_OutputPorts[nPortIndex].bIsEnabled) {
+			pPollReply->PortTypes[nPortIndex - nPortIndexStart] = ARTNET_ENABLE_OUTPUT | ARTNET_PORT_DMX;
+			NumPortsLo++;
+		}
+
+		pPollReply->SwOut[nPortIndex - nPortIndexStart] = m_OutputPorts[nPortIndex].port.nDefaultAddress;
+
+		if (nPortIndex < ARTNET_MAX_PORTS) {
+			if (m_InputPorts[nPortIndex].bIsEnabled) {
+				pPollReply->PortTypes[nPortIndex - nPortIndexStart] |= ARTNET_ENABLE_INPUT | ARTNET_PORT_DMX;
+				NumPortsLo++;
+			}
+
+			pPollReply->SwIn[nPortIndex - nPortIndexStart] = m_InputPorts[nPortIndex].port.nDefaultAddress;
+		}
+	}
+
+	pPollReply->NumPortsLo = NumPortsLo;
+	assert(NumPortsLo <= 4);
+
+	metric_inc(&s_MetricPollReplyBuilds);
+}
+
+/*
+ * The replies are broadcast, so one reply answers all the ArtPoll received
+ * within the jitter delay or the minimum interval.
+ */
+void ArtNetNode::SchedulePollReply(void) {
+	if (m_bIsPollReplyPending) {
+		metric_inc(&s_MetricPollReplyCoalesced);
+		return;
+	}
+
+	uint32_t nDueMillis = m_nCurrentPacketMillis;
+
+	if (m_nPollReplyJitterMillis != 0) {
+		nDueMillis += random_next() % (m_nPollReplyJitterMillis + 1);
+	}
+
+	const uint32_t nEarliestMillis = m_nPollReplyMillis + ARTNET_POLLREPLY_MIN_INTERVAL_MILLIS;
+
+	if (static_cast<int32_t>(nEarliestMillis - nDueMillis) > 0) {
+		nDueMillis = nEarliestMillis;
+	}
+
+	if (nDueMillis == m_nCurrentPacketMillis) {
+		SendPollRelply(true);
+		return;
+	}
+
+	m_nPollReplyDueMillis = nDueMillis;
+	m_bIsPollReplyPending = true;
 }
 
 void ArtNetNode::SendPollRelply(bool bResponse) {
@@ -548,19 +734,17 @@ void ArtNetNode::SendPollRelply(bool bResponse) {
 		m_State.ArtPollReplyCount++;
 	}
 
-	m_PollReply.Status1 = m_Node.Status1;
-
 	for (uint32_t nPage = 0; nPage < m_nPages; nPage++) {
+		struct TArtPollReply *pPollReply = &m_pPollReplies[nPage];
 
-		m_PollReply.NetSwitch = m_Node.NetSwitch[nPage];
-		m_PollReply.SubSwitch = m_Node.SubSwitch[nPage];
+		if (!m_bIsPollReplyValid) {
+			BuildPollReply(nPage);
+		}
 
-		m_PollReply.BindIndex = nPage + 1;
+		pPollReply->Status1 = m_Node.Status1;
 
 		const uint32_t nPortIndexStart = nPage * ARTNET_MAX_PORTS;
 
-		uint32_t NumPortsLo = 0;
-
 		for (uint32_t nPortIndex = nPortIndexStart; nPortIndex < (nPortIndexStart + ARTNET_MAX_PORTS); nPortIndex++) {
 			uint8_t nStatus = m_OutputPorts[nPortIndex].port.nStatus;
 
@@ -593,34 +777,36 @@ void ArtNetNode::SendPollRelply(bool bResponse) {
 
 			m_OutputPorts[nPortIndex].port.nStatus = nStatus;
 
-			if (m_OutputPorts[nPortIndex].bIsEnabled) {
-				m_PollReply.PortTypes[nPortIndex - nPortIndexStart] = ARTNET_ENABLE_OUTPUT | ARTNET_PORT_DMX;
-				NumPortsLo++;
-			}
-
-			m_PollReply.GoodOutput[nPortIndex - nPortIndexStart] = m_OutputPorts[nPortIndex].port.nStatus;
-			m_PollReply.SwOut[nPortIndex - nPortIndexStart] = m_OutputPorts[nPortIndex].port.nDefaultAddress;
+			pPollReply->GoodOutput[nPortIndex - nPortIndexStart] = nStatus;
 
 			if (nPortIndex < ARTNET_MAX_PORTS) {
-				if (m_InputPorts[nPortIndex].bIsEnabled) {
-					m_PollReply.PortTypes[nPortIndex - nPortIndexStart] |= ARTNET_ENABLE_INPUT | ARTNET_PORT_DMX;
-					NumPortsLo++;
-				}
-
-				m_PollReply.GoodInput[nPortIndex - nPortIndexStart] = m_InputPorts[nPortIndex].port.nStatus;
-				m_PollReply.SwIn[nPortIndex - nPortIndexStart] = m_InputPorts[nPortIndex].port.nDefaultAddress;
+				pPollReply->GoodInput[nPortIndex - nPortIndexStart] = m_InputPorts[nPortIndex].port.nStatus;
 			}
-
 		}
 
-		m_PollReply.NumPortsLo = NumPortsLo;
-		assert(NumPortsLo <= 4);
+		if (nPage == 0) {
+			// Only the code and the counter are formatted, the system name is cached
+			char *pReport = reinterpret_cast<char*>(pPollReply->NodeReport);
+			const uint32_t nLength = node_report_prefix(pReport, static_cast<uint32_t>(m_State.reportCode), m_State.ArtPollReplyCount);
+			uint32_t nSuffixLength = m_nNodeReportSuffixLength;
 
-		snprintf(reinterpret_cast<char*>(m_PollReply.NodeReport), ARTNET_REPORT_LENGTH, "%04x [%04d] %s AvV", static_cast<int>(m_State.reportCode), static_cast<int>(m_State.ArtPollReplyCount), m_aSysName);
+			if ((nLength + nSuffixLength) > (ARTNET_REPORT_LENGTH - 1)) {
+				nSuffixLength = ARTNET_REPORT_LENGTH - 1 - nLength;
+			}
+
+			memcpy(&pReport[nLength], m_aNodeReportSuffix, nSuffixLength);
+			pReport[nLength + nSuffixLength] = '\0';
+		} else {
+			memcpy(pPollReply->NodeReport, m_pPollReplies[0].NodeReport, ARTNET_REPORT_LENGTH);
+		}
 
-		Network::Get()->SendTo(m_nHandle, &m_PollReply, sizeof(struct TArtPollReply), m_Node.IPAddressBroadcast, ARTNET_UDP_PORT);
+		Network::Get()->SendTo(m_nHandle, pPollReply, sizeof(struct TArtPollReply), m_Node.IPAddressBroadcast, ARTNET_UDP_PORT);
+		metric_inc(&s_MetricPollReplies);
 	}
 
+	m_bIsPollReplyValid = true;
+	m_nPollReplyMillis = m_nCurrentPacketMillis;
+
 	m_State.IsChanged = false;
 }
 
@@ -651,6 +837,8 @@ bool ArtNetNode::IsDmxDataChanged(uint8_t nPortId, const uint8_t *pData, uint16_
 }
 
 bool ArtNetNode::IsMergedDmxDataChanged(uint8_t nPortId, const uint8_t *pData, uint16_t nLength) {
+	PROFILE_SCOPE("artnet.merge");
+
 	bool isChanged = false;
 
 	if (!m_State.IsMergeMode) {
@@ -660,6 +848,7 @@ bool ArtNetNode::IsMergedDmxDataChanged(uint8_t nPortId, const uint8_t *pData, u
 
 	m_OutputPorts[nPortId].port.nStatus |= GO_OUTPUT_IS_MERGING;
 
+	metric_inc(&s_MetricDmxMerged);
 
 	if (m_OutputPorts[nPortId].mergeMode == ARTNET_MERGE_HTP) {
 
@@ -755,7 +944,7 @@ void ArtNetNode::HandlePoll(void) {
 		m_State.IPAddressDiagSend = 0;
 	}
 
-	SendPollRelply(true);
+	SchedulePollReply();
 }
 
 void ArtNetNode::HandleDmx(void) {
@@ -837,16 +1026,19 @@ void ArtNetNode::HandleDmx(void) {
 #if defined ( ENABLE_SENDDIAG )
 				SendDiag("8. Source matches both buffers, this shouldn't be happening!", ARTNET_DP_LOW);
 #endif
+				metric_inc(&s_MetricDmxDiscarded);
 				return;
 			} else if (ipA != m_ArtNetPacket.IPAddressFrom && ipB != m_ArtNetPacket.IPAddressFrom) {
 #if defined ( ENABLE_SENDDIAG )
 				SendDiag("9. More than two sources, discarding data", ARTNET_DP_LOW);
 #endif
+				metric_inc(&s_MetricDmxDiscarded);
 				return;
 			} else {
 #if defined ( ENABLE_SENDDIAG )
 				SendDiag("0. No cases matched, this shouldn't happen!", ARTNET_DP_LOW);
 #endif
+				metric_inc(&s_MetricDmxDiscarded);
 				return;
 			}
 
@@ -856,9 +1048,12 @@ void ArtNetNode::HandleDmx(void) {
 					SendDiag("Send new data", ARTNET_DP_LOW);
 #endif
 					m_pLightSet->SetData(i, m_OutputPorts[i].data, m_OutputPorts[i].nLength);
+					metric_inc(&s_MetricDmxUpdates);
 
 					if(!m_IsLightSetRunning[i]) {
-						m_pLightSet->Start(i);
+						if (!IsRdmPending(i)) {
+							m_pLightSet->Start(i);	// Otherwise started when the RDM transaction is done
+						}
 						m_State.IsChanged |= (!m_IsLightSetRunning[i]);
 						m_IsLightSetRunning[i] = true;
 					}
@@ -891,7 +1086,9 @@ void ArtNetNode::HandleSync(void) {
 			m_pLightSet->SetData(i, m_OutputPorts[i].data, 	m_OutputPorts[i].nLength);
 
 			if(!m_IsLightSetRunning[i]) {
-				m_pLightSet->Start(i);
+				if (!IsRdmPending(i)) {
+					m_pLightSet->Start(i);
+				}
 				m_IsLightSetRunning[i] = true;
 			}
 
@@ -1013,7 +1210,9 @@ void ArtNetNode::HandleAddress(void) {
 	}
 
 	if ((nPort < ARTNET_MAX_PORTS) && (m_OutputPorts[nPort].tPortProtocol == PORT_ARTNET_ARTNET) && !m_IsLightSetRunning[nPort]) {
-		m_pLightSet->Start(nPort);
+		if (!IsRdmPending(nPort)) {
+			m_pLightSet->Start(nPort);
+		}
 		m_IsLightSetRunning[nPort] = true;
 		m_OutputPorts[nPort].port.nStatus |= GO_DATA_IS_BEING_TRANSMITTED;
 	}
@@ -1031,7 +1230,9 @@ void ArtNetNode::SetNetworkDataLossCondition(void) {
 
 	for (uint32_t i = 0; i < (ARTNET_MAX_PORTS * m_nPages); i++) {
 		if  ((m_OutputPorts[i].tPortProtocol == PORT_ARTNET_ARTNET) && (m_IsLightSetRunning[i])) {
-			m_pLightSet->Stop(i);
+			if (!IsRdmPending(i)) {
+				m_pLightSet->Stop(i);
+			}
 			m_IsLightSetRunning[i] = false;
 		}
 
@@ -1043,7 +1244,7 @@ void ArtNetNode::SetNetworkDataLossCondition(void) {
 }
 
 void ArtNetNode::GetType(void) {
-	char *data = reinterpret_cast<char*>(&(m_ArtNetPacket.ArtPacket));
+	const uint8_t *data = reinterpret_cast<uint8_t*>(&(m_ArtNetPacket.ArtPacket));	// char is signed on Linux, the OpCode would be sign extended
 
 	if (m_ArtNetPacket.length < ARTNET_MIN_HEADER_SIZE) {
 		m_ArtNetPacket.OpCode = OP_NOT_DEFINED;
@@ -1069,6 +1270,19 @@ void ArtNetNode::Run(void) {
 
 	m_nCurrentPacketMillis = Hardware::Get()->Millis();
 
+	if (m_bIsPollReplyPending && (static_cast<int32_t>(m_nCurrentPacketMillis - m_nPollReplyDueMillis) >= 0)) {
+		m_bIsPollReplyPending = false;
+		SendPollRelply(true);
+	}
+
+	if (m_bIsTodControlPending) {
+		RunTodControl();
+	}
+
+	if (m_nRdmRequestHead != m_nRdmRequestTail) {
+		RunRdm();
+	}
+
 	if (__builtin_expect((nBytesReceived == 0), 1)) {
 		if ((m_State.nNetworkDataLossTimeoutMillis != 0) && ((m_nCurrentPacketMillis - m_nPreviousPacketMillis) >= m_State.nNetworkDataLossTimeoutMillis)) {
 			SetNetworkDataLossCondition();
@@ -1109,6 +1323,8 @@ void ArtNetNode::Run(void) {
 	m_ArtNetPacket.length = nBytesReceived;
 	m_nPreviousPacketMillis = m_nCurrentPacketMillis;
 
+	metric_inc(&s_MetricPackets);
+
 	GetType();
 
 	if (m_State.IsSynchronousMode) {
@@ -1122,6 +1338,7 @@ void ArtNetNode::Run(void) {
 		HandlePoll();
 		break;
 	case OP_DMX:
+		metric_inc(&s_MetricDmxPackets);
 		if (m_pLightSet != 0) {
 			HandleDmx();
 		}
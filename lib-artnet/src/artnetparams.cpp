@@ -278,6 +278,12 @@ void ArtNetParams::callbackFunction(const char *pLine) {
 		return;
 	}
 
+	if (Sscan::Uint16(pLine, ArtNetParamsConst::POLL_REPLY_JITTER, &nValue16) == SSCAN_OK) {
+		m_tArtNetParams.nPollReplyJitter = nValue16;
+		m_tArtNetParams.nSetList |= ARTNET_PARAMS_MASK_POLL_REPLY_JITTER;
+		return;
+	}
+
 	nLength = 5;
 	if (Sscan::Char(pLine, ArtNetParamsConst::DIRECTION, value, &nLength) == SSCAN_OK) {
 		if (memcmp(value, "input", 5) == 0) {
@@ -400,6 +406,10 @@ void ArtNetParams::Dump(void) {
 						"Input" : "Output");
 	}
 
+	if(isMaskSet(ARTNET_PARAMS_MASK_POLL_REPLY_JITTER)) {
+		printf(" %s=%d [ms]\n", ArtNetParamsConst::POLL_REPLY_JITTER, static_cast<int>(m_tArtNetParams.nPollReplyJitter));
+	}
+
 	for (unsigned i = 0; i < ARTNET_MAX_PORTS; i++) {
 		if (isMaskMultiPortOptionsSet(ARTNET_PARAMS_MASK_MULTI_PORT_DESTINATION_IP_A << i)) {
 			printf(" %s=" IPSTR "\n", ArtNetParamsConst::DESTINATION_IP_PORT[i], IP2STR(m_tArtNetParams.nDestinationIpPort[i]));
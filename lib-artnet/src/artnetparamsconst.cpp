@@ -50,4 +50,5 @@ const char ArtNetParamsConst::MERGE_MODE_PORT[ARTNET_MAX_PORTS][18] = { "merge_m
 const char ArtNetParamsConst::PROTOCOL[] = "protocol";
 const char ArtNetParamsConst::PROTOCOL_PORT[ARTNET_MAX_PORTS][16] = { "protocol_port_a", "protocol_port_b", "protocol_port_c", "protocol_port_d" };
 const char ArtNetParamsConst::DIRECTION[] = "direction";
+const char ArtNetParamsConst::POLL_REPLY_JITTER[] = "poll_reply_jitter";
 const char ArtNetParamsConst::DESTINATION_IP_PORT[ARTNET_MAX_PORTS][24] = { "destination_ip_port_a", "destination_ip_port_b", "destination_ip_port_c", "destination_ip_port_d" };
@@ -75,6 +75,7 @@ void ArtNetParams::Builder(const struct TArtNetParams *pArtNetParams, char *pBuf
 	builder.Add(ArtNetParamsConst::NODE_SHORT_NAME, reinterpret_cast<const char*>(m_tArtNetParams.aShortName), isMaskSet(ARTNET_PARAMS_MASK_SHORT_NAME));
 
 	builder.AddHex16(ArtNetParamsConst::NODE_OEM_VALUE, m_tArtNetParams.aOemValue, isMaskSet(ARTNET_PARAMS_MASK_OEM_VALUE));
+	builder.Add(ArtNetParamsConst::POLL_REPLY_JITTER, m_tArtNetParams.nPollReplyJitter, isMaskSet(ARTNET_PARAMS_MASK_POLL_REPLY_JITTER));
 
 	builder.AddComment("Time");
 	builder.Add(ArtNetParamsConst::TIMECODE, m_tArtNetParams.bUseTimeCode, isMaskSet(ARTNET_PARAMS_MASK_TIMECODE));
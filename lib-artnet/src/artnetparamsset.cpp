@@ -94,4 +94,8 @@ void ArtNetParams::Set(ArtNetNode *pArtNetNode) {
 	if (isMaskSet(ARTNET_PARAMS_MASK_ENABLE_NO_CHANGE_OUTPUT)) {
 		pArtNetNode->SetDirectUpdate(m_tArtNetParams.bEnableNoChangeUpdate);
 	}
+
+	if (isMaskSet(ARTNET_PARAMS_MASK_POLL_REPLY_JITTER)) {
+		pArtNetNode->SetPollReplyJitter(m_tArtNetParams.nPollReplyJitter);
+	}
 }
@@ -36,28 +36,59 @@
 
 #include "artnetnode_internal.h"
 
+/*
+ * The discovery is blocking, so it must not start while an RDM transaction is
+ * on the wire. The TOD control is queued per port and done from Run().
+ */
 void ArtNetNode::HandleTodControl(void) {
 	const struct TArtTodControl *pArtTodControl =  &(m_ArtNetPacket.ArtPacket.ArtTodControl);
 	const uint16_t portAddress = static_cast<uint16_t>((pArtTodControl->Net << 8)) | static_cast<uint16_t>((pArtTodControl->Address));
 
 	for (uint32_t i = 0; i < ARTNET_MAX_PORTS; i++) {
 		if ((portAddress == m_OutputPorts[i].port.nPortAddress) && m_OutputPorts[i].bIsEnabled) {
-
-			if (m_IsLightSetRunning[i] && (!m_IsRdmResponder)) {
-				m_pLightSet->Stop(i);
-			}
-
 			if (pArtTodControl->Command == 0x01) {	// AtcFlush
-				m_pArtNetRdm->Full(i);
+				m_TodControl[i] = TOD_CONTROL_FLUSH;
+			} else if (m_TodControl[i] == TOD_CONTROL_NONE) {
+				m_TodControl[i] = TOD_CONTROL_SEND;
 			}
 
-			SendTod(i);
+			m_bIsTodControlPending = true;
+		}
+	}
 
-			if (m_IsLightSetRunning[i] && (!m_IsRdmResponder)) {
-				m_pLightSet->Start(i);
-			}
+	if (m_bIsTodControlPending) {
+		RunTodControl();
+	}
+}
+
+void ArtNetNode::RunTodControl(void) {
+	if (m_bIsRdmPending) {
+		return;	// Try again in the next Run()
+	}
+
+	for (uint32_t i = 0; i < ARTNET_MAX_PORTS; i++) {
+		if (m_TodControl[i] == TOD_CONTROL_NONE) {
+			continue;
+		}
+
+		if (m_IsLightSetRunning[i] && (!m_IsRdmResponder)) {
+			m_pLightSet->Stop(i);
+		}
+
+		if (m_TodControl[i] == TOD_CONTROL_FLUSH) {
+			m_pArtNetRdm->Full(i);
+		}
+
+		SendTod(i);
+
+		if (m_IsLightSetRunning[i] && (!m_IsRdmResponder)) {
+			m_pLightSet->Start(i);
 		}
+
+		m_TodControl[i] = TOD_CONTROL_NONE;
 	}
+
+	m_bIsTodControlPending = false;
 }
 
 void ArtNetNode::HandleTodRequest(void) {
@@ -102,6 +133,9 @@ void ArtNetNode::SetRdmHandler(ArtNetRdm *pArtNetTRdm, bool IsResponder) {
 		m_pTodData = new TArtTodData;
 		assert(m_pTodData != 0);
 
+		m_pRdmRequests = new struct TArtNetRdmRequest[ARTNET_RDM_QUEUE_ENTRIES];
+		assert(m_pRdmRequests != 0);
+
 		if (m_pTodData != 0) {
 			m_Node.Status1 |= STATUS1_RDM_CAPABLE;
 			memset(m_pTodData, 0, sizeof(struct TArtTodData));
@@ -114,42 +148,90 @@ void ArtNetNode::SetRdmHandler(ArtNetRdm *pArtNetTRdm, bool IsResponder) {
 	}
 }
 
+/*
+ * The RDM transaction is started and polled from Run(), so DMX output
+ * and the other Art-Net packets are not blocked while waiting for the response.
+ * A request for which there is no room in the queue is dropped, the controller will retry.
+ */
 void ArtNetNode::HandleRdm(void) {
-	struct TArtRdm *pArtRdm = &(m_ArtNetPacket.ArtPacket.ArtRdm);
+	const struct TArtRdm *pArtRdm = &(m_ArtNetPacket.ArtPacket.ArtRdm);
 	const uint16_t portAddress = static_cast<uint16_t>((pArtRdm->Net << 8)) | static_cast<uint16_t>((pArtRdm->Address));
 
 	for (uint32_t i = 0; i < ARTNET_MAX_PORTS; i++) {
 		if ((portAddress == m_OutputPorts[i].port.nPortAddress) && m_OutputPorts[i].bIsEnabled) {
 
-			if (!m_IsRdmResponder) {
-				if ((m_OutputPorts[i].tPortProtocol == PORT_ARTNET_SACN) && (m_pArtNet4Handler != 0)) {
-					const uint8_t nMask = GO_OUTPUT_IS_MERGING | GO_DATA_IS_BEING_TRANSMITTED | GO_OUTPUT_IS_SACN;
-					m_IsLightSetRunning[i] = (m_pArtNet4Handler->GetStatus(i) & nMask) != 0;
-				}
-
-				if (m_IsLightSetRunning[i]) {
-					m_pLightSet->Stop(i); // Stop DMX if was running
-				}
+			if ((m_nRdmRequestHead - m_nRdmRequestTail) == ARTNET_RDM_QUEUE_ENTRIES) {
+				return;
 			}
 
-			const uint8_t *response = const_cast<uint8_t*>(m_pArtNetRdm->Handler(i, pArtRdm->RdmPacket));
+			struct TArtNetRdmRequest *pRequest = &m_pRdmRequests[m_nRdmRequestHead & ARTNET_RDM_QUEUE_MASK];
+
+			pRequest->nIPAddressFrom = m_ArtNetPacket.IPAddressFrom;
+			pRequest->nPort = static_cast<uint8_t>(i);
+			memcpy(&pRequest->ArtRdm, pArtRdm, sizeof(struct TArtRdm));
+
+			m_nRdmRequestHead++;
+		}
+	}
+
+	if (m_nRdmRequestHead != m_nRdmRequestTail) {
+		RunRdm();
+	}
+}
 
-			if (response != 0) {
-				pArtRdm->RdmVer = 0x01;
+void ArtNetNode::RunRdm(void) {
+	struct TArtNetRdmRequest *pRequest = &m_pRdmRequests[m_nRdmRequestTail & ARTNET_RDM_QUEUE_MASK];
+	const uint8_t nPort = pRequest->nPort;
 
-				const uint16_t nMessageLength = response[2] + 1;
-				memcpy(pArtRdm->RdmPacket, &response[1], nMessageLength);
+	if (!m_bIsRdmPending) {
+		if (m_bIsTodControlPending) {
+			return; // The queued TOD control goes first
+		}
 
-				const uint16_t nLength = sizeof(struct TArtRdm) - sizeof(pArtRdm->RdmPacket) + nMessageLength;
+		if (!m_IsRdmResponder) {
+			if ((m_OutputPorts[nPort].tPortProtocol == PORT_ARTNET_SACN) && (m_pArtNet4Handler != 0)) {
+				const uint8_t nMask = GO_OUTPUT_IS_MERGING | GO_DATA_IS_BEING_TRANSMITTED | GO_OUTPUT_IS_SACN;
+				m_IsLightSetRunning[nPort] = (m_pArtNet4Handler->GetStatus(nPort) & nMask) != 0;
+			}
 
-				Network::Get()->SendTo(m_nHandle, pArtRdm, nLength, m_ArtNetPacket.IPAddressFrom, ARTNET_UDP_PORT);
-			} else {
-				//printf("\n==> No response <==\n");
+			if (m_IsLightSetRunning[nPort]) {
+				m_pLightSet->Stop(nPort); // Stop DMX if was running
 			}
+		}
 
-			if (m_IsLightSetRunning[i] && (!m_IsRdmResponder)) {
-				m_pLightSet->Start(i); // Start DMX if was running
+		if (!m_pArtNetRdm->HandlerStart(nPort, pRequest->ArtRdm.RdmPacket)) {
+			if (m_IsLightSetRunning[nPort] && (!m_IsRdmResponder)) {
+				m_pLightSet->Start(nPort);
 			}
+			return; // Busy, try again in the next Run()
 		}
+
+		m_bIsRdmPending = true;
 	}
+
+	const uint8_t *response;
+
+	if (!m_pArtNetRdm->HandlerPoll(nPort, response)) {
+		return;
+	}
+
+	if (response != 0) {
+		struct TArtRdm *pArtRdm = &pRequest->ArtRdm;
+
+		pArtRdm->RdmVer = 0x01;
+
+		const uint16_t nMessageLength = response[2] + 1;
+		memcpy(pArtRdm->RdmPacket, &response[1], nMessageLength);
+
+		const uint16_t nLength = sizeof(struct TArtRdm) - sizeof(pArtRdm->RdmPacket) + nMessageLength;
+
+		Network::Get()->SendTo(m_nHandle, pArtRdm, nLength, pRequest->nIPAddressFrom, ARTNET_UDP_PORT);
+	}
+
+	if (m_IsLightSetRunning[nPort] && (!m_IsRdmResponder)) {
+		m_pLightSet->Start(nPort); // Start DMX if was running
+	}
+
+	m_bIsRdmPending = false;
+	m_nRdmRequestTail++;
 }
@@ -63,6 +63,13 @@ public:
 		return m_Bridge.IsStatusChanged();
 	}
 
+	uint8_t GetSacnPriority(uint8_t nPortId) const {
+		return m_Bridge.GetOutputPriority(nPortId);
+	}
+	bool IsSacnPerAddressPriority(uint8_t nPortId) const {
+		return m_Bridge.IsPerAddressPriority(nPortId);
+	}
+
 private:
 	E131Bridge m_Bridge;
 	bool m_bMapUniverse0;
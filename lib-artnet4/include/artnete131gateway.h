@@ -0,0 +1,150 @@
+/**
+ * @file artnete131gateway.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ARTNETE131GATEWAY_H_
+#define ARTNETE131GATEWAY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "artnetcontroller.h"
+#include "e131controller.h"
+
+#include "e131.h"
+
+enum TArtNetE131GatewayDirection {
+	GATEWAY_ARTNET_TO_SACN,
+	GATEWAY_SACN_TO_ARTNET
+};
+
+enum {
+	GATEWAY_MAX_MAPPINGS = 512,		///< Per direction, limited by the E1.31 and Art-Net controller tables
+	GATEWAY_MAX_SOURCES = 2,
+	GATEWAY_MAX_SYNC_ADDRESSES = 8
+};
+
+struct TArtNetE131GatewaySource {
+	uint32_t nIp;
+	uint32_t nMillis;
+	uint16_t nLength;
+	uint8_t nPriority;
+	bool bHasData;
+};
+
+struct TArtNetE131GatewayMapping {
+	uint16_t nFrom;		///< Art-Net Port-Address or sACN universe, the sort key
+	uint16_t nTo;
+	struct TArtNetE131GatewaySource Source[GATEWAY_MAX_SOURCES];
+	uint8_t *pData;		///< GATEWAY_MAX_SOURCES * E131_DMX_LENGTH, only written when merging
+};
+
+struct TArtNetE131GatewayStats {
+	uint32_t nArtNetToSacn;
+	uint32_t nSacnToArtNet;
+	uint32_t nMerged;
+	uint32_t nDiscarded;
+	uint32_t nSync;
+};
+
+/*
+ * Network to network gateway. Art-Net Port-Addresses are forwarded as sACN universes and vice versa,
+ * following a sorted mapping table. There is no LightSet in between: a packet from a single source is
+ * forwarded from the receive buffer, only merging two sources uses a buffer. ArtSync and E1.31
+ * synchronization packets are passed through.
+ */
+class ArtNetE131Gateway {
+public:
+	ArtNetE131Gateway(void);
+	~ArtNetE131Gateway(void);
+
+	bool AddMapping(TArtNetE131GatewayDirection tDirection, uint16_t nFrom, uint16_t nTo, uint16_t nCount = 1);
+	uint32_t GetMappings(TArtNetE131GatewayDirection tDirection) const {
+		return m_nMappings[tDirection];
+	}
+
+	void SetMergeMode(TE131Merge tMergeMode) {
+		m_tMergeMode = tMergeMode;
+	}
+	TE131Merge GetMergeMode(void) const {
+		return m_tMergeMode;
+	}
+
+	void SetPriority(uint8_t nPriority);
+	uint8_t GetPriority(void) const {
+		return m_nPriority;
+	}
+
+	void SetSynchronizationAddress(uint16_t nSynchronizationAddress) {
+		m_nSynchronizationAddress = nSynchronizationAddress;
+	}
+	uint16_t GetSynchronizationAddress(void) const {
+		return m_nSynchronizationAddress;
+	}
+
+	const struct TArtNetE131GatewayStats *GetStats(void) const {
+		return &m_Stats;
+	}
+
+	void Start(void);
+	void Stop(void);
+
+	void Run(void);
+
+	void Print(void);
+
+private:
+	struct TArtNetE131GatewayMapping *Find(TArtNetE131GatewayDirection tDirection, uint16_t nFrom);
+	const uint8_t *Merge(struct TArtNetE131GatewayMapping *pMapping, uint32_t nTimeoutMillis, uint8_t nPriority, const uint8_t *pData, uint16_t &nLength);
+
+	void HandleArtNet(uint16_t nBytesReceived);
+	void HandleSacn(uint16_t nBytesReceived);
+	void HandleSacnSync(uint16_t nUniverse);
+	void JoinSynchronizationAddress(uint16_t nUniverse);
+	void PrintMappings(TArtNetE131GatewayDirection tDirection);
+
+private:
+	ArtNetController m_ArtNetController;
+	E131Controller m_E131Controller;
+	int32_t m_nHandleArtNet;
+	int32_t m_nHandleSacn;
+	uint32_t m_nIpAddress;
+	uint32_t m_nCurrentMillis;
+	uint32_t m_nFromIp;
+	uint8_t *m_pReceiveBuffer;
+	uint8_t *m_pMergeBuffer;
+	struct TArtNetE131GatewayMapping *m_pMappings[2];
+	uint32_t m_nMappings[2];
+	TE131Merge m_tMergeMode;
+	uint8_t m_nPriority;
+	uint16_t m_nSynchronizationAddress;
+	uint32_t m_nArtSyncMillis;
+	bool m_bArtSync;
+	uint16_t m_SynchronizationAddresses[GATEWAY_MAX_SYNC_ADDRESSES];
+	uint32_t m_nSynchronizationAddresses;
+	bool m_bIsRunning;
+	struct TArtNetE131GatewayStats m_Stats;
+};
+
+#endif /* ARTNETE131GATEWAY_H_ */
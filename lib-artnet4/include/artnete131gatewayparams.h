@@ -0,0 +1,94 @@
+/**
+ * @file artnete131gatewayparams.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ARTNETE131GATEWAYPARAMS_H_
+#define ARTNETE131GATEWAYPARAMS_H_
+
+#include <stdint.h>
+
+#include "artnete131gateway.h"
+
+enum {
+	GATEWAY_PARAMS_MAX_RANGES = 64
+};
+
+struct TArtNetE131GatewayRange {
+	uint16_t nFrom;
+	uint16_t nTo;
+	uint16_t nCount;
+	uint8_t nDirection;
+};
+
+struct TArtNetE131GatewayParams {
+	uint32_t nSetList;
+	uint8_t nMergeMode;
+	uint8_t nPriority;
+	uint16_t nSynchronizationAddress;
+	uint32_t nRanges;
+	struct TArtNetE131GatewayRange Ranges[GATEWAY_PARAMS_MAX_RANGES];
+};
+
+enum TArtNetE131GatewayParamsMask {
+	GATEWAY_PARAMS_MASK_MERGE_MODE = (1 << 0),
+	GATEWAY_PARAMS_MASK_PRIORITY = (1 << 1),
+	GATEWAY_PARAMS_MASK_SYNCHRONIZATION_ADDRESS = (1 << 2)
+};
+
+/*
+ * gateway.txt, one line per range:
+ *  artnet2sacn=<Port-Address>:<universe>[:<count>]
+ *  sacn2artnet=<universe>:<Port-Address>[:<count>]
+ */
+class ArtNetE131GatewayParams {
+public:
+	ArtNetE131GatewayParams(void);
+	~ArtNetE131GatewayParams(void);
+
+	bool Load(void);
+	void Load(const char *pBuffer, uint32_t nLength);
+
+	void Set(ArtNetE131Gateway *pGateway);
+
+	void Dump(void);
+
+	uint32_t GetRanges(void) const {
+		return m_tArtNetE131GatewayParams.nRanges;
+	}
+
+public:
+	static void staticCallbackFunction(void *p, const char *s);
+
+private:
+	void callbackFunction(const char *s);
+	bool AddRange(uint8_t nDirection, const char *pValue, uint32_t nLength);
+	bool isMaskSet(uint32_t nMask) {
+		return (m_tArtNetE131GatewayParams.nSetList & nMask) == nMask;
+	}
+
+private:
+	struct TArtNetE131GatewayParams m_tArtNetE131GatewayParams;
+};
+
+#endif /* ARTNETE131GATEWAYPARAMS_H_ */
@@ -0,0 +1,606 @@
+/**
+ * @file artnete131gateway.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <assert.h>
+
+#include "artnete131gateway.h"
+
+#include "artnetcontroller.h"
+#include "artnet.h"
+#include "packets.h"
+
+#include "e131controller.h"
+#include "e131.h"
+#include "e131packets.h"
+#include "e117const.h"
+
+#include "hardware.h"
+#include "network.h"
+
+#include "debug.h"
+
+#define GATEWAY_BUFFER_SIZE					1500
+#define GATEWAY_MAX_PACKETS_PER_RUN			16	///< Per socket, the queue is drained without starving the other socket
+#define GATEWAY_ARTNET_MERGE_TIMEOUT_MILLIS	(10 * 1000)
+#define GATEWAY_SACN_MERGE_TIMEOUT_MILLIS	static_cast<uint32_t>(E131_NETWORK_DATA_LOSS_TIMEOUT_SECONDS * 1000)
+#define GATEWAY_ARTSYNC_TIMEOUT_MILLIS		(4 * 1000)
+
+#define ARTDMX_HEADER_SIZE					(sizeof(struct TArtDmx) - ARTNET_DMX_LENGTH)
+
+static uint32_t universe_to_multicast_ip(uint16_t nUniverse) {
+	struct in_addr group_ip;
+	static_cast<void>(inet_aton("239.255.0.0", &group_ip));
+
+	return group_ip.s_addr | ((nUniverse & 0xFF) << 24) | ((nUniverse & 0xFF00) << 8);
+}
+
+ArtNetE131Gateway::ArtNetE131Gateway(void):
+	m_nHandleArtNet(-1),
+	m_nHandleSacn(-1),
+	m_nIpAddress(0),
+	m_nCurrentMillis(0),
+	m_nFromIp(0),
+	m_pReceiveBuffer(0),
+	m_pMergeBuffer(0),
+	m_tMergeMode(E131_MERGE_HTP),
+	m_nPriority(E131_PRIORITY_DEFAULT),
+	m_nSynchronizationAddress(DEFAULT_SYNCHRONIZATION_ADDRESS),
+	m_nArtSyncMillis(0),
+	m_bArtSync(false),
+	m_nSynchronizationAddresses(0),
+	m_bIsRunning(false)
+{
+	DEBUG_ENTRY
+
+	m_pReceiveBuffer = new uint8_t[GATEWAY_BUFFER_SIZE];
+	assert(m_pReceiveBuffer != 0);
+
+	m_pMergeBuffer = new uint8_t[E131_DMX_LENGTH];
+	assert(m_pMergeBuffer != 0);
+
+	for (uint32_t i = 0; i < 2; i++) {
+		m_pMappings[i] = new struct TArtNetE131GatewayMapping[GATEWAY_MAX_MAPPINGS];
+		assert(m_pMappings[i] != 0);
+		m_nMappings[i] = 0;
+	}
+
+	memset(m_SynchronizationAddresses, 0, sizeof(m_SynchronizationAddresses));
+	memset(&m_Stats, 0, sizeof(struct TArtNetE131GatewayStats));
+
+	m_nHandleArtNet = Network::Get()->Begin(ARTNET_UDP_PORT);
+	assert(m_nHandleArtNet != -1);
+
+	m_nHandleSacn = Network::Get()->Begin(E131_DEFAULT_PORT);
+	assert(m_nHandleSacn != -1);
+
+	DEBUG_EXIT
+}
+
+ArtNetE131Gateway::~ArtNetE131Gateway(void) {
+	DEBUG_ENTRY
+
+	Stop();
+
+	for (uint32_t i = 0; i < 2; i++) {
+		for (uint32_t nIndex = 0; nIndex < m_nMappings[i]; nIndex++) {
+			delete[] m_pMappings[i][nIndex].pData;
+		}
+
+		delete[] m_pMappings[i];
+		m_pMappings[i] = 0;
+	}
+
+	delete[] m_pMergeBuffer;
+	m_pMergeBuffer = 0;
+
+	delete[] m_pReceiveBuffer;
+	m_pReceiveBuffer = 0;
+
+	DEBUG_EXIT
+}
+
+/*
+ * The table per direction is kept sorted on nFrom, so a lookup is a binary search.
+ * The Art-Net and sACN universes used by the two directions must not overlap,
+ * otherwise the gateway would forward its own output back.
+ */
+bool ArtNetE131Gateway::AddMapping(TArtNetE131GatewayDirection tDirection, uint16_t nFrom, uint16_t nTo, uint16_t nCount) {
+	DEBUG_ENTRY
+	DEBUG_PRINTF("tDirection=%d, nFrom=%u, nTo=%u, nCount=%u", static_cast<int>(tDirection), nFrom, nTo, nCount);
+
+	assert(!m_bIsRunning);
+
+	const TArtNetE131GatewayDirection tOther = (tDirection == GATEWAY_ARTNET_TO_SACN) ? GATEWAY_SACN_TO_ARTNET : GATEWAY_ARTNET_TO_SACN;
+	const uint32_t nMaxArtNet = 0x7FFF;
+
+	for (uint32_t nOffset = 0; nOffset < nCount; nOffset++) {
+		const uint32_t nSource = nFrom + nOffset;
+		const uint32_t nDestination = nTo + nOffset;
+
+		const uint32_t nArtNet = (tDirection == GATEWAY_ARTNET_TO_SACN) ? nSource : nDestination;
+		const uint32_t nUniverse = (tDirection == GATEWAY_ARTNET_TO_SACN) ? nDestination : nSource;
+
+		if ((nArtNet > nMaxArtNet) || (nUniverse == 0) || (nUniverse > E131_UNIVERSE_MAX)) {
+			DEBUG_PRINTF("Out of range %d:%d", static_cast<int>(nSource), static_cast<int>(nDestination));
+			DEBUG_EXIT
+			return false;
+		}
+
+		if (m_nMappings[tDirection] == GATEWAY_MAX_MAPPINGS) {
+			DEBUG_PUTS("Mapping table is full");
+			DEBUG_EXIT
+			return false;
+		}
+
+		if (Find(tDirection, nSource) != 0) {
+			DEBUG_PRINTF("Duplicate %d", static_cast<int>(nSource));
+			DEBUG_EXIT
+			return false;
+		}
+
+		if (Find(tOther, nDestination) != 0) {
+			DEBUG_PRINTF("Loop %d:%d", static_cast<int>(nSource), static_cast<int>(nDestination));
+			DEBUG_EXIT
+			return false;
+		}
+
+		for (uint32_t nIndex = 0; nIndex < m_nMappings[tOther]; nIndex++) {
+			if (m_pMappings[tOther][nIndex].nTo == nSource) {
+				DEBUG_PRINTF("Loop %d:%d", static_cast<int>(nSource), static_cast<int>(nDestination));
+				DEBUG_EXIT
+				return false;
+			}
+		}
+
+		struct TArtNetE131GatewayMapping *pMappings = m_pMappings[tDirection];
+
+		uint32_t nInsert = m_nMappings[tDirection];
+
+		while ((nInsert > 0) && (pMappings[nInsert - 1].nFrom > nSource)) {
+			pMappings[nInsert] = pMappings[nInsert - 1];
+			nInsert--;
+		}
+
+		memset(&pMappings[nInsert], 0, sizeof(struct TArtNetE131GatewayMapping));
+		pMappings[nInsert].nFrom = static_cast<uint16_t>(nSource);
+		pMappings[nInsert].nTo = static_cast<uint16_t>(nDestination);
+		pMappings[nInsert].pData = new uint8_t[GATEWAY_MAX_SOURCES * E131_DMX_LENGTH];
+		assert(pMappings[nInsert].pData != 0);
+
+		m_nMappings[tDirection]++;
+	}
+
+	DEBUG_EXIT
+	return true;
+}
+
+struct TArtNetE131GatewayMapping *ArtNetE131Gateway::Find(TArtNetE131GatewayDirection tDirection, uint16_t nFrom) {
+	struct TArtNetE131GatewayMapping *pMappings = m_pMappings[tDirection];
+
+	int32_t nLow = 0;
+	int32_t nHigh = static_cast<int32_t>(m_nMappings[tDirection]) - 1;
+
+	while (nLow <= nHigh) {
+		const int32_t nMid = nLow + ((nHigh - nLow) / 2);
+		const uint32_t nMidValue = pMappings[nMid].nFrom;
+
+		if (nMidValue < nFrom) {
+			nLow = nMid + 1;
+		} else if (nMidValue > nFrom) {
+			nHigh = nMid - 1;
+		} else {
+			return &pMappings[nMid];
+		}
+	}
+
+	return 0;
+}
+
+void ArtNetE131Gateway::SetPriority(uint8_t nPriority) {
+	if ((nPriority >= E131_PRIORITY_LOWEST) && (nPriority <= E131_PRIORITY_HIGHEST)) {
+		m_nPriority = nPriority;
+	} else {
+		m_nPriority = E131_PRIORITY_DEFAULT;
+	}
+
+	m_E131Controller.SetPriority(m_nPriority);
+}
+
+void ArtNetE131Gateway::Start(void) {
+	DEBUG_ENTRY
+
+	m_nIpAddress = Network::Get()->GetIp();
+
+	// There is no ArtPoll table, ArtNetController::Run is never called: the gateway owns the Art-Net socket
+	m_ArtNetController.SetUnicast(false);
+	m_ArtNetController.SetSynchronization(true);
+	m_ArtNetController.Start();
+
+	// The sACN synchronization address is only set while ArtSync is received
+	m_E131Controller.SetPriority(m_nPriority);
+	m_E131Controller.SetSynchronizationAddress(0);
+	m_E131Controller.Start();
+
+	// On Linux the number of groups is limited by net.ipv4.igmp_max_memberships
+	for (uint32_t nIndex = 0; nIndex < m_nMappings[GATEWAY_SACN_TO_ARTNET]; nIndex++) {
+		Network::Get()->JoinGroup(m_nHandleSacn, universe_to_multicast_ip(m_pMappings[GATEWAY_SACN_TO_ARTNET][nIndex].nFrom));
+	}
+
+	m_bIsRunning = true;
+
+	DEBUG_EXIT
+}
+
+void ArtNetE131Gateway::Stop(void) {
+	DEBUG_ENTRY
+
+	if (!m_bIsRunning) {
+		DEBUG_EXIT
+		return;
+	}
+
+	for (uint32_t nIndex = 0; nIndex < m_nMappings[GATEWAY_SACN_TO_ARTNET]; nIndex++) {
+		Network::Get()->LeaveGroup(m_nHandleSacn, universe_to_multicast_ip(m_pMappings[GATEWAY_SACN_TO_ARTNET][nIndex].nFrom));
+	}
+
+	for (uint32_t nIndex = 0; nIndex < m_nSynchronizationAddresses; nIndex++) {
+		Network::Get()->LeaveGroup(m_nHandleSacn, universe_to_multicast_ip(m_SynchronizationAddresses[nIndex]));
+	}
+
+	m_nSynchronizationAddresses = 0;
+
+	m_E131Controller.Stop();
+	m_ArtNetController.Stop();
+
+	m_bIsRunning = false;
+
+	DEBUG_EXIT
+}
+
+/*
+ * Returns the data to be forwarded, or 0 when the packet must be discarded.
+ * With one active source, or with LTP, this is the received data itself.
+ * Only with HTP and two active sources the data is kept per source and merged.
+ */
+const uint8_t *ArtNetE131Gateway::Merge(struct TArtNetE131GatewayMapping *pMapping, uint32_t nTimeoutMillis, uint8_t nPriority, const uint8_t *pData, uint16_t &nLength) {
+	int32_t nSlot = -1;
+	int32_t nFree = -1;
+
+	for (uint32_t i = 0; i < GATEWAY_MAX_SOURCES; i++) {
+		struct TArtNetE131GatewaySource *pSource = &pMapping->Source[i];
+
+		if ((pSource->nIp != 0) && ((m_nCurrentMillis - pSource->nMillis) > nTimeoutMillis)) {
+			pSource->nIp = 0;
+			pSource->bHasData = false;
+		}
+
+		if (pSource->nIp == m_nFromIp) {
+			nSlot = i;
+		} else if ((pSource->nIp == 0) && (nFree == -1)) {
+			nFree = i;
+		}
+	}
+
+	if (nSlot == -1) {
+		if (nFree == -1) {
+			// A third source is ignored
+			return 0;
+		}
+		nSlot = nFree;
+	}
+
+	struct TArtNetE131GatewaySource *pSource = &pMapping->Source[nSlot];
+	struct TArtNetE131GatewaySource *pOther = &pMapping->Source[nSlot ^ 1];
+
+	if (pOther->nIp != 0) {
+		if (pOther->nPriority > nPriority) {
+			return 0;
+		}
+
+		if (pOther->nPriority < nPriority) {
+			pOther->nIp = 0;
+			pOther->bHasData = false;
+		}
+	}
+
+	pSource->nIp = m_nFromIp;
+	pSource->nMillis = m_nCurrentMillis;
+	pSource->nPriority = nPriority;
+	pSource->nLength = nLength;
+
+	if ((pOther->nIp == 0) || (m_tMergeMode == E131_MERGE_LTP)) {
+		pSource->bHasData = false;
+		return pData;
+	}
+
+	uint8_t *pSourceData = &pMapping->pData[nSlot * E131_DMX_LENGTH];
+
+	memcpy(pSourceData, pData, nLength);
+	pSource->bHasData = true;
+
+	if (!pOther->bHasData) {
+		return pData;
+	}
+
+	const uint8_t *pOtherData = &pMapping->pData[(nSlot ^ 1) * E131_DMX_LENGTH];
+	const uint16_t nMergeLength = (pSource->nLength > pOther->nLength) ? pSource->nLength : pOther->nLength;
+
+	for (uint32_t i = 0; i < nMergeLength; i++) {
+		const uint8_t nA = (i < pSource->nLength) ? pSourceData[i] : 0;
+		const uint8_t nB = (i < pOther->nLength) ? pOtherData[i] : 0;
+		m_pMergeBuffer[i] = (nA > nB) ? nA : nB;
+	}
+
+	m_Stats.nMerged++;
+
+	nLength = nMergeLength;
+	return m_pMergeBuffer;
+}
+
+void ArtNetE131Gateway::HandleArtNet(uint16_t nBytesReceived) {
+	if (nBytesReceived < 12) {
+		return;
+	}
+
+	if (memcmp(m_pReceiveBuffer, NODE_ID, 8) != 0) {
+		return;
+	}
+
+	const struct TArtDmx *pArtDmx = reinterpret_cast<const struct TArtDmx*>(m_pReceiveBuffer);
+
+	if (pArtDmx->OpCode == OP_SYNC) {
+		m_nArtSyncMillis = m_nCurrentMillis;
+
+		if (!m_bArtSync) {
+			m_bArtSync = true;
+			m_E131Controller.SetSynchronizationAddress(m_nSynchronizationAddress);
+		}
+
+		m_E131Controller.HandleSync();
+		m_Stats.nSync++;
+		return;
+	}
+
+	if ((pArtDmx->OpCode != OP_DMX) || (nBytesReceived <= ARTDMX_HEADER_SIZE)) {
+		return;
+	}
+
+	struct TArtNetE131GatewayMapping *pMapping = Find(GATEWAY_ARTNET_TO_SACN, pArtDmx->PortAddress & 0x7FFF);
+
+	if (pMapping == 0) {
+		return;
+	}
+
+	uint16_t nLength = static_cast<uint16_t>((pArtDmx->LengthHi << 8) | pArtDmx->Length);
+
+	if (nLength > (nBytesReceived - ARTDMX_HEADER_SIZE)) {
+		nLength = static_cast<uint16_t>(nBytesReceived - ARTDMX_HEADER_SIZE);
+	}
+
+	if (nLength > ARTNET_DMX_LENGTH) {
+		nLength = ARTNET_DMX_LENGTH;
+	}
+
+	const uint8_t *pData = Merge(pMapping, GATEWAY_ARTNET_MERGE_TIMEOUT_MILLIS, E131_PRIORITY_DEFAULT, pArtDmx->Data, nLength);
+
+	if (pData == 0) {
+		m_Stats.nDiscarded++;
+		return;
+	}
+
+	m_E131Controller.HandleDmxOut(pMapping->nTo, pData, nLength);
+	m_Stats.nArtNetToSacn++;
+}
+
+void ArtNetE131Gateway::HandleSacn(uint16_t nBytesReceived) {
+	const union UE131Packet *pE131 = reinterpret_cast<const union UE131Packet*>(m_pReceiveBuffer);
+
+	if (nBytesReceived < (ROOT_LAYER_SIZE + sizeof(struct TRawFrameLayer))) {
+		return;
+	}
+
+	if (memcmp(pE131->Raw.RootLayer.ACNPacketIdentifier, E117Const::ACN_PACKET_IDENTIFIER, E117_PACKET_IDENTIFIER_LENGTH) != 0) {
+		return;
+	}
+
+	if (pE131->Raw.RootLayer.Vector == __builtin_bswap32(E131_VECTOR_ROOT_EXTENDED)) {
+		if ((pE131->Raw.FrameLayer.Vector == __builtin_bswap32(E131_VECTOR_EXTENDED_SYNCHRONIZATION)) && (nBytesReceived >= SYNCHRONIZATION_PACKET_SIZE)) {
+			HandleSacnSync(__builtin_bswap16(pE131->Synchronization.FrameLayer.UniverseNumber));
+		}
+		return;
+	}
+
+	if ((pE131->Raw.RootLayer.Vector != __builtin_bswap32(E131_VECTOR_ROOT_DATA)) || (nBytesReceived < DATA_PACKET_SIZE(1))) {
+		return;
+	}
+
+	const struct TE131DataPacket *pData = &pE131->Data;
+
+	if ((pData->DMPLayer.Vector != E131_VECTOR_DMP_SET_PROPERTY)
+			|| (pData->DMPLayer.Type != 0xa1)
+			|| (pData->DMPLayer.FirstAddressProperty != __builtin_bswap16(0x0000))
+			|| (pData->DMPLayer.AddressIncrement != __builtin_bswap16(0x0001))) {
+		return;
+	}
+
+	// Preview data and alternate START codes are not forwarded
+	if (((pData->FrameLayer.Options & E131_OPTIONS_MASK_PREVIEW_DATA) != 0) || (pData->DMPLayer.PropertyValues[0] != 0)) {
+		return;
+	}
+
+	struct TArtNetE131GatewayMapping *pMapping = Find(GATEWAY_SACN_TO_ARTNET, __builtin_bswap16(pData->FrameLayer.Universe));
+
+	if (pMapping == 0) {
+		return;
+	}
+
+	if ((pData->FrameLayer.Options & E131_OPTIONS_MASK_STREAM_TERMINATED) != 0) {
+		for (uint32_t i = 0; i < GATEWAY_MAX_SOURCES; i++) {
+			if (pMapping->Source[i].nIp == m_nFromIp) {
+				pMapping->Source[i].nIp = 0;
+				pMapping->Source[i].bHasData = false;
+			}
+		}
+		return;
+	}
+
+	const uint16_t nSynchronizationAddress = __builtin_bswap16(pData->FrameLayer.SynchronizationAddress);
+
+	if (nSynchronizationAddress != 0) {
+		JoinSynchronizationAddress(nSynchronizationAddress);
+	}
+
+	uint16_t nLength = static_cast<uint16_t>(__builtin_bswap16(pData->DMPLayer.PropertyValueCount) - 1);
+
+	if (nLength > (nBytesReceived - DATA_PACKET_SIZE(1))) {
+		nLength = static_cast<uint16_t>(nBytesReceived - DATA_PACKET_SIZE(1));
+	}
+
+	if (nLength > E131_DMX_LENGTH) {
+		nLength = E131_DMX_LENGTH;
+	}
+
+	const uint8_t *pDmxData = Merge(pMapping, GATEWAY_SACN_MERGE_TIMEOUT_MILLIS, pData->FrameLayer.Priority, &pData->DMPLayer.PropertyValues[1], nLength);
+
+	if (pDmxData == 0) {
+		m_Stats.nDiscarded++;
+		return;
+	}
+
+	// The ArtDmx length must be even, an odd length is padded with a zero slot
+	if ((nLength & 0x1) != 0) {
+		if (pDmxData != m_pMergeBuffer) {
+			memcpy(m_pMergeBuffer, pDmxData, nLength);
+			pDmxData = m_pMergeBuffer;
+		}
+
+		m_pMergeBuffer[nLength++] = 0;
+	}
+
+	m_ArtNetController.HandleDmxOut(pMapping->nTo, pDmxData, nLength);
+	m_Stats.nSacnToArtNet++;
+}
+
+void ArtNetE131Gateway::HandleSacnSync(uint16_t nUniverse) {
+	for (uint32_t nIndex = 0; nIndex < m_nSynchronizationAddresses; nIndex++) {
+		if (m_SynchronizationAddresses[nIndex] == nUniverse) {
+			m_ArtNetController.HandleSync();
+			m_Stats.nSync++;
+			return;
+		}
+	}
+}
+
+void ArtNetE131Gateway::JoinSynchronizationAddress(uint16_t nUniverse) {
+	for (uint32_t nIndex = 0; nIndex < m_nSynchronizationAddresses; nIndex++) {
+		if (m_SynchronizationAddresses[nIndex] == nUniverse) {
+			return;
+		}
+	}
+
+	if (m_nSynchronizationAddresses == GATEWAY_MAX_SYNC_ADDRESSES) {
+		return;
+	}
+
+	DEBUG_PRINTF("Synchronization address %u", nUniverse);
+
+	m_SynchronizationAddresses[m_nSynchronizationAddresses++] = nUniverse;
+
+	if (Find(GATEWAY_SACN_TO_ARTNET, nUniverse) == 0) {
+		Network::Get()->JoinGroup(m_nHandleSacn, universe_to_multicast_ip(nUniverse));
+	}
+}
+
+void ArtNetE131Gateway::Run(void) {
+	uint16_t nForeignPort;
+
+	m_nCurrentMillis = Hardware::Get()->Millis();
+
+	// Packets sent by the gateway itself are received back (broadcast, multicast loopback)
+	for (uint32_t i = 0; i < GATEWAY_MAX_PACKETS_PER_RUN; i++) {
+		const uint16_t nBytesReceived = Network::Get()->RecvFrom(m_nHandleArtNet, m_pReceiveBuffer, GATEWAY_BUFFER_SIZE, &m_nFromIp, &nForeignPort);
+
+		if (nBytesReceived == 0) {
+			break;
+		}
+
+		if (m_nFromIp != m_nIpAddress) {
+			HandleArtNet(nBytesReceived);
+		}
+	}
+
+	for (uint32_t i = 0; i < GATEWAY_MAX_PACKETS_PER_RUN; i++) {
+		const uint16_t nBytesReceived = Network::Get()->RecvFrom(m_nHandleSacn, m_pReceiveBuffer, GATEWAY_BUFFER_SIZE, &m_nFromIp, &nForeignPort);
+
+		if (nBytesReceived == 0) {
+			break;
+		}
+
+		if (m_nFromIp != m_nIpAddress) {
+			HandleSacn(nBytesReceived);
+		}
+	}
+
+	if (m_bArtSync && ((m_nCurrentMillis - m_nArtSyncMillis) >= GATEWAY_ARTSYNC_TIMEOUT_MILLIS)) {
+		m_bArtSync = false;
+		m_E131Controller.SetSynchronizationAddress(0);
+	}
+
+	// Universe Discovery only, nothing is received here
+	m_E131Controller.Run();
+}
+
+void ArtNetE131Gateway::PrintMappings(TArtNetE131GatewayDirection tDirection) {
+	const struct TArtNetE131GatewayMapping *pMappings = m_pMappings[tDirection];
+	uint32_t nStart = 0;
+
+	// Consecutive mappings are printed as a range
+	for (uint32_t nIndex = 1; nIndex <= m_nMappings[tDirection]; nIndex++) {
+		if ((nIndex < m_nMappings[tDirection])
+				&& (pMappings[nIndex].nFrom == pMappings[nIndex - 1].nFrom + 1)
+				&& (pMappings[nIndex].nTo == pMappings[nIndex - 1].nTo + 1)) {
+			continue;
+		}
+
+		printf("  %5u -> %5u [%d]\n", pMappings[nStart].nFrom, pMappings[nStart].nTo, static_cast<int>(nIndex - nStart));
+		nStart = nIndex;
+	}
+}
+
+void ArtNetE131Gateway::Print(void) {
+	printf("Art-Net <-> sACN E1.31 Gateway\n");
+	printf(" Merge mode : %s\n", m_tMergeMode == E131_MERGE_HTP ? "HTP" : "LTP");
+	printf(" sACN priority : %u\n", m_nPriority);
+	printf(" Synchronization Universe : %u\n", m_nSynchronizationAddress);
+	printf(" Art-Net -> sACN : %d\n", static_cast<int>(m_nMappings[GATEWAY_ARTNET_TO_SACN]));
+	PrintMappings(GATEWAY_ARTNET_TO_SACN);
+	printf(" sACN -> Art-Net : %d\n", static_cast<int>(m_nMappings[GATEWAY_SACN_TO_ARTNET]));
+	PrintMappings(GATEWAY_SACN_TO_ARTNET);
+}
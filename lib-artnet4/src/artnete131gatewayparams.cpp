@@ -0,0 +1,237 @@
+/**
+ * @file artnete131gatewayparams.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "artnete131gatewayparams.h"
+#include "artnete131gatewayparamsconst.h"
+#include "artnete131gateway.h"
+
+#include "e131.h"
+
+#include "readconfigfile.h"
+#include "sscan.h"
+
+#include "debug.h"
+
+#define MERGEMODE2STRING(m)		(m == E131_MERGE_HTP) ? "HTP" : "LTP"
+
+ArtNetE131GatewayParams::ArtNetE131GatewayParams(void) {
+	memset(&m_tArtNetE131GatewayParams, 0, sizeof(struct TArtNetE131GatewayParams));
+
+	m_tArtNetE131GatewayParams.nMergeMode = E131_MERGE_HTP;
+	m_tArtNetE131GatewayParams.nPriority = E131_PRIORITY_DEFAULT;
+	m_tArtNetE131GatewayParams.nSynchronizationAddress = DEFAULT_SYNCHRONIZATION_ADDRESS;
+}
+
+ArtNetE131GatewayParams::~ArtNetE131GatewayParams(void) {
+}
+
+bool ArtNetE131GatewayParams::Load(void) {
+	m_tArtNetE131GatewayParams.nSetList = 0;
+	m_tArtNetE131GatewayParams.nRanges = 0;
+
+	ReadConfigFile configfile(ArtNetE131GatewayParams::staticCallbackFunction, this);
+
+	return configfile.Read(ArtNetE131GatewayParamsConst::FILE_NAME);
+}
+
+void ArtNetE131GatewayParams::Load(const char *pBuffer, uint32_t nLength) {
+	assert(pBuffer != 0);
+	assert(nLength != 0);
+
+	m_tArtNetE131GatewayParams.nSetList = 0;
+	m_tArtNetE131GatewayParams.nRanges = 0;
+
+	ReadConfigFile config(ArtNetE131GatewayParams::staticCallbackFunction, this);
+
+	config.Read(pBuffer, nLength);
+}
+
+/*
+ * <from>:<to>[:<count>]
+ */
+bool ArtNetE131GatewayParams::AddRange(uint8_t nDirection, const char *pValue, uint32_t nLength) {
+	uint32_t aNumbers[3] = { 0, 0, 1 };
+	uint32_t nNumbers = 0;
+	bool bDigit = false;
+
+	for (uint32_t i = 0; i < nLength; i++) {
+		const char c = pValue[i];
+
+		if ((c >= '0') && (c <= '9')) {
+			if (nNumbers == 3) {
+				return false;
+			}
+			if (!bDigit) {
+				aNumbers[nNumbers] = 0;
+				bDigit = true;
+			}
+			aNumbers[nNumbers] = aNumbers[nNumbers] * 10 + static_cast<uint32_t>(c - '0');
+			if (aNumbers[nNumbers] > 0xFFFF) {
+				return false;
+			}
+		} else if ((c == ':') && bDigit) {
+			nNumbers++;
+			bDigit = false;
+		} else if ((c == ' ') || (c == '\t') || (c == '\r')) {
+			break;
+		} else {
+			return false;
+		}
+	}
+
+	if (bDigit) {
+		nNumbers++;
+	}
+
+	if ((nNumbers < 2) || (aNumbers[2] == 0) || (m_tArtNetE131GatewayParams.nRanges == GATEWAY_PARAMS_MAX_RANGES)) {
+		return false;
+	}
+
+	struct TArtNetE131GatewayRange *pRange = &m_tArtNetE131GatewayParams.Ranges[m_tArtNetE131GatewayParams.nRanges++];
+
+	pRange->nFrom = static_cast<uint16_t>(aNumbers[0]);
+	pRange->nTo = static_cast<uint16_t>(aNumbers[1]);
+	pRange->nCount = static_cast<uint16_t>(aNumbers[2]);
+	pRange->nDirection = nDirection;
+
+	return true;
+}
+
+void ArtNetE131GatewayParams::callbackFunction(const char *pLine) {
+	assert(pLine != 0);
+
+	char value[24];
+	uint8_t len;
+	uint8_t value8;
+	uint16_t value16;
+
+	len = sizeof(value);
+	if (Sscan::Char(pLine, ArtNetE131GatewayParamsConst::ARTNET_TO_SACN, value, &len) == SSCAN_OK) {
+		if (!AddRange(GATEWAY_ARTNET_TO_SACN, value, len)) {
+			DEBUG_PRINTF("Invalid %s", pLine);
+		}
+		return;
+	}
+
+	len = sizeof(value);
+	if (Sscan::Char(pLine, ArtNetE131GatewayParamsConst::SACN_TO_ARTNET, value, &len) == SSCAN_OK) {
+		if (!AddRange(GATEWAY_SACN_TO_ARTNET, value, len)) {
+			DEBUG_PRINTF("Invalid %s", pLine);
+		}
+		return;
+	}
+
+	len = 3;
+	if (Sscan::Char(pLine, ArtNetE131GatewayParamsConst::MERGE_MODE, value, &len) == SSCAN_OK) {
+		if (memcmp(value, "ltp", 3) == 0) {
+			m_tArtNetE131GatewayParams.nMergeMode = E131_MERGE_LTP;
+			m_tArtNetE131GatewayParams.nSetList |= GATEWAY_PARAMS_MASK_MERGE_MODE;
+		} else if (memcmp(value, "htp", 3) == 0) {
+			m_tArtNetE131GatewayParams.nMergeMode = E131_MERGE_HTP;
+			m_tArtNetE131GatewayParams.nSetList |= GATEWAY_PARAMS_MASK_MERGE_MODE;
+		}
+		return;
+	}
+
+	if (Sscan::Uint8(pLine, ArtNetE131GatewayParamsConst::PRIORITY, &value8) == SSCAN_OK) {
+		if ((value8 >= E131_PRIORITY_LOWEST) && (value8 <= E131_PRIORITY_HIGHEST)) {
+			m_tArtNetE131GatewayParams.nPriority = value8;
+			m_tArtNetE131GatewayParams.nSetList |= GATEWAY_PARAMS_MASK_PRIORITY;
+		}
+		return;
+	}
+
+	if (Sscan::Uint16(pLine, ArtNetE131GatewayParamsConst::SYNCHRONIZATION_ADDRESS, &value16) == SSCAN_OK) {
+		if (value16 <= E131_UNIVERSE_MAX) {
+			m_tArtNetE131GatewayParams.nSynchronizationAddress = value16;
+			m_tArtNetE131GatewayParams.nSetList |= GATEWAY_PARAMS_MASK_SYNCHRONIZATION_ADDRESS;
+		}
+		return;
+	}
+}
+
+void ArtNetE131GatewayParams::Set(ArtNetE131Gateway *pGateway) {
+	assert(pGateway != 0);
+
+	if (isMaskSet(GATEWAY_PARAMS_MASK_MERGE_MODE)) {
+		pGateway->SetMergeMode(static_cast<TE131Merge>(m_tArtNetE131GatewayParams.nMergeMode));
+	}
+
+	if (isMaskSet(GATEWAY_PARAMS_MASK_PRIORITY)) {
+		pGateway->SetPriority(m_tArtNetE131GatewayParams.nPriority);
+	}
+
+	if (isMaskSet(GATEWAY_PARAMS_MASK_SYNCHRONIZATION_ADDRESS)) {
+		pGateway->SetSynchronizationAddress(m_tArtNetE131GatewayParams.nSynchronizationAddress);
+	}
+
+	for (uint32_t i = 0; i < m_tArtNetE131GatewayParams.nRanges; i++) {
+		const struct TArtNetE131GatewayRange *pRange = &m_tArtNetE131GatewayParams.Ranges[i];
+
+		if (!pGateway->AddMapping(static_cast<TArtNetE131GatewayDirection>(pRange->nDirection), pRange->nFrom, pRange->nTo, pRange->nCount)) {
+			printf("Rejected %s=%u:%u:%u\n",
+					pRange->nDirection == GATEWAY_ARTNET_TO_SACN ? ArtNetE131GatewayParamsConst::ARTNET_TO_SACN : ArtNetE131GatewayParamsConst::SACN_TO_ARTNET,
+					pRange->nFrom, pRange->nTo, pRange->nCount);
+		}
+	}
+}
+
+void ArtNetE131GatewayParams::Dump(void) {
+#ifndef NDEBUG
+	printf("%s::%s \'%s\':\n", __FILE__, __FUNCTION__, ArtNetE131GatewayParamsConst::FILE_NAME);
+
+	for (uint32_t i = 0; i < m_tArtNetE131GatewayParams.nRanges; i++) {
+		const struct TArtNetE131GatewayRange *pRange = &m_tArtNetE131GatewayParams.Ranges[i];
+
+		printf(" %s=%u:%u:%u\n",
+				pRange->nDirection == GATEWAY_ARTNET_TO_SACN ? ArtNetE131GatewayParamsConst::ARTNET_TO_SACN : ArtNetE131GatewayParamsConst::SACN_TO_ARTNET,
+				pRange->nFrom, pRange->nTo, pRange->nCount);
+	}
+
+	if (isMaskSet(GATEWAY_PARAMS_MASK_MERGE_MODE)) {
+		printf(" %s=%s\n", ArtNetE131GatewayParamsConst::MERGE_MODE, MERGEMODE2STRING(m_tArtNetE131GatewayParams.nMergeMode));
+	}
+
+	if (isMaskSet(GATEWAY_PARAMS_MASK_PRIORITY)) {
+		printf(" %s=%d\n", ArtNetE131GatewayParamsConst::PRIORITY, m_tArtNetE131GatewayParams.nPriority);
+	}
+
+	if (isMaskSet(GATEWAY_PARAMS_MASK_SYNCHRONIZATION_ADDRESS)) {
+		printf(" %s=%d\n", ArtNetE131GatewayParamsConst::SYNCHRONIZATION_ADDRESS, m_tArtNetE131GatewayParams.nSynchronizationAddress);
+	}
+#endif
+}
+
+void ArtNetE131GatewayParams::staticCallbackFunction(void *p, const char *s) {
+	assert(p != 0);
+	assert(s != 0);
+
+	(static_cast<ArtNetE131GatewayParams*>(p))->callbackFunction(s);
+}
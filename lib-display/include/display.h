@@ -35,6 +35,7 @@
 #include "display7segment.h"
 
 #define DISPLAY_SLEEP_TIMEOUT_DEFAULT	5
+#define DISPLAY_FLUSH_BUDGET_US			200	///< Maximum time spent in Run() sending display updates
 
 enum TDisplayTypes {
 	DISPLAY_BW_UI_1602,
@@ -57,6 +58,10 @@ public:
 		return m_bIsSleep;
 	}
 
+	/*
+	 * The first call switches the display to deferred output,
+	 * the changes are then sent within DISPLAY_FLUSH_BUDGET_US per call.
+	 */
 	void Run(void);
 #endif
 
@@ -130,6 +135,7 @@ private:
 	bool m_bHave7Segment;
 #if !defined(NO_HAL)
 	uint32_t m_nMillis;
+	bool m_bIsFlushDeferred;
 #endif
 	uint32_t m_nSleepTimeout;
 
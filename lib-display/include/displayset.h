@@ -62,6 +62,14 @@ public:
 
 	virtual void SetSleep(bool bSleep);
 
+	/*
+	 * Deferred output: the text is updated in memory only and
+	 * each FlushNext() call sends one changed span to the display.
+	 * FlushNext() returns false when nothing could be sent.
+	 */
+	virtual void SetFlushDeferred(bool bDeferred);
+	virtual bool FlushNext(void);
+
 #if defined(ENABLE_CURSOR_MODE)
 	virtual void SetCursor(TCursorMode)= 0;
 #endif
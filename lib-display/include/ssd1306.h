@@ -60,6 +60,9 @@ public:
 
 	void SetSleep(bool bSleep) override;
 
+	void SetFlushDeferred(bool bDeferred) override;
+	bool FlushNext(void) override;
+
 	bool IsSH1106(void) {
 		return m_bHaveSH1106;
 	}
@@ -76,6 +79,10 @@ private:
 	void Setup(void);
 	void CheckSH1106(void);
 	void InitMembers(void);
+	void ClearPanel(void);
+	void SetChar(int);
+	void Update(void);
+	void FlushAll(void);
 	void SendCommand(uint8_t);
 	void SendData(const uint8_t *, uint32_t);
 
@@ -94,12 +101,14 @@ private:
 	TOledPanel m_OledPanel;
 	uint32_t m_nPages;
 	TCursorMode m_tCursorMode;
-	alignas(uintptr_t) char *m_pShadowRam;
+	alignas(uintptr_t) char *m_pShadowRam;	///< Text to be shown
+	char *m_pPanelRam;						///< Text shown on the panel
 	uint16_t m_nShadowRamIndex;
 	uint8_t m_nCursorOnChar;
 	uint8_t m_nCursorOnCol;
 	uint8_t m_nCursorOnRow;
 	bool m_bHaveSH1106;
+	bool m_bFlushDeferred;
 
 	static Ssd1306 *s_pThis;
 };
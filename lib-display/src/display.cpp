@@ -56,6 +56,7 @@ Display::Display(uint32_t nCols, uint32_t nRows):
 	m_bHave7Segment(false),
 #if !defined(NO_HAL)
 	m_nMillis(Hardware::Get()->Millis()),
+	m_bIsFlushDeferred(false),
 #endif
 	m_nSleepTimeout(1000 * 60 * DISPLAY_SLEEP_TIMEOUT_DEFAULT)
 {
@@ -74,6 +75,7 @@ Display::Display(TDisplayTypes tDisplayType):
 	m_bHave7Segment(false),
 #if !defined(NO_HAL)
 	m_nMillis(Hardware::Get()->Millis()),
+	m_bIsFlushDeferred(false),
 #endif
 	m_nSleepTimeout(1000 * 60 * DISPLAY_SLEEP_TIMEOUT_DEFAULT)
 {
@@ -418,6 +420,29 @@ void Display::SetSleep(bool bSleep) {
 }
 
 void Display::Run(void) {
+	if (m_LcdDisplay != 0) {
+		if (__builtin_expect((!m_bIsFlushDeferred), 0)) {
+			m_bIsFlushDeferred = true;
+			m_LcdDisplay->SetFlushDeferred(true);
+		}
+
+		const uint32_t nMicros = Hardware::Get()->Micros();
+		uint32_t nElapsed = 0;
+
+		// Queue the changed spans, then clock them out within the remaining budget
+		while (m_LcdDisplay->FlushNext()) {
+			nElapsed = Hardware::Get()->Micros() - nMicros;
+
+			if (nElapsed >= DISPLAY_FLUSH_BUDGET_US) {
+				break;
+			}
+		}
+
+		if (nElapsed < DISPLAY_FLUSH_BUDGET_US) {
+			i2c_async_run(DISPLAY_FLUSH_BUDGET_US - nElapsed);
+		}
+	}
+
 	if (m_nSleepTimeout == 0) {
 		return;
 	}
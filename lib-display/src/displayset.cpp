@@ -32,3 +32,10 @@ DisplaySet::~DisplaySet(void) {
 
 void DisplaySet::SetSleep(bool bSleep) {
 }
+
+void DisplaySet::SetFlushDeferred(bool bDeferred) {
+}
+
+bool DisplaySet::FlushNext(void) {
+	return false;
+}
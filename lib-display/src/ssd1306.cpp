@@ -38,6 +38,7 @@
 
 #define SSD1306_COMMAND_MODE			0x00
 #define SSD1306_DATA_MODE				0x40
+#define SSD1306_CONTROL_CO				0x80	///< Another control byte follows the data byte
 
 #define SSD1306_CMD_SET_LOWCOLUMN		0x00
 #define SSD1306_CMD_SET_HIGHCOLUMN		0x10
@@ -67,6 +68,8 @@
 #define OLED_FONT8x6_CHAR_W				6
 #define OLED_FONT8x6_COLS				(SSD1306_LCD_WIDTH / OLED_FONT8x6_CHAR_W)
 
+#define FLUSH_LOOKAHEAD					2	///< Unchanged cells bridged within a span is FLUSH_LOOKAHEAD - 1
+
 static uint8_t _OledFont8x6[] __attribute__((aligned(4))) = {
 	0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 	0x40, 0x00, 0x00, 0x5F, 0x00, 0x00, 0x00,
@@ -230,6 +233,9 @@ Ssd1306::Ssd1306(uint8_t nSlaveAddress, TOledPanel tOledPanel) : m_OledPanel(tOl
 }
 
 Ssd1306::~Ssd1306(void) {
+	delete[] m_pPanelRam;
+	m_pPanelRam = 0;
+
 	delete[] m_pShadowRam;
 	m_pShadowRam = 0;
 }
@@ -298,14 +304,14 @@ bool Ssd1306::Start(void) {
 
 	CheckSH1106();
 
-	Cls();
+	ClearPanel();
 
 	SendCommand(SSD1306_CMD_DISPLAY_ON);
 
 	return true;
 }
 
-void Ssd1306::Cls(void) {
+void Ssd1306::ClearPanel(void) {
 	uint32_t nColumnAdd = 0;
 
 	if (m_bHaveSH1106) {
@@ -337,45 +343,55 @@ void Ssd1306::Cls(void) {
 
 	m_nShadowRamIndex = 0;
 	memset(m_pShadowRam, ' ', m_nCols * m_nRows);
+	memset(m_pPanelRam, ' ', m_nCols * m_nRows);
 }
 
-void Ssd1306::PutChar(int c) {
-	uint8_t i;
+void Ssd1306::Cls(void) {
+	m_nShadowRamIndex = 0;
+	memset(m_pShadowRam, ' ', m_nCols * m_nRows);
 
+	Update();
+}
+
+void Ssd1306::SetChar(int c) {
 	if (c < 32 || c > 127) {
 		c = 32;
-		i = 0;
-	} else {
-		i = (c - 32);
 	}
 
-	m_pShadowRam[m_nShadowRamIndex++] = c;
+	if (m_nShadowRamIndex < (m_nCols * m_nRows)) {
+		m_pShadowRam[m_nShadowRamIndex++] = static_cast<char>(c);
+	}
+}
 
-	const uint8_t *base = _OledFont8x6 + (OLED_FONT8x6_CHAR_W + 1) * i;
-	SendData(base, OLED_FONT8x6_CHAR_W + 1);
+void Ssd1306::PutChar(int c) {
+	SetChar(c);
+	Update();
 }
 
 void Ssd1306::PutString(const char *pString) {
 	const char *p = pString;
 
-	for (uint32_t i = 0; *p != '\0'; i++) {
-		PutChar(static_cast<int>(*p));
+	while (*p != '\0') {
+		SetChar(static_cast<int>(*p));
 		p++;
 	}
+
+	Update();
 }
 
 void Ssd1306::ClearLine(uint8_t nLine) {
-	if (nLine > m_nRows) {
+	if ((nLine == 0) || (nLine > m_nRows)) {
 		return;
 	}
 
+	memset(&m_pShadowRam[(nLine - 1) * m_nCols], ' ', m_nCols);
 	SetCursorPos(0, nLine - 1);
-	SendData(reinterpret_cast<const uint8_t*>(&_ClearBuffer), SSD1306_LCD_WIDTH + 1);
-	SetCursorPos(0, nLine - 1);
+
+	Update();
 }
 
 void Ssd1306::TextLine(uint8_t nLine, const char *pData, uint8_t nLength) {
-	if (nLine > m_nRows) {
+	if ((nLine == 0) || (nLine > m_nRows)) {
 		return;
 	}
 
@@ -389,28 +405,22 @@ void Ssd1306::Text(const char *data, uint8_t nLength) {
 	}
 
 	for (uint32_t i = 0; i < nLength; i++) {
-		PutChar(data[i]);
+		SetChar(data[i]);
 	}
+
+	Update();
 }
 
 void Ssd1306::SetCursorPos(uint8_t col, uint8_t row) {
-	if ((row > m_nRows) || (col > OLED_FONT8x6_COLS)) {
+	if ((row >= m_nRows) || (col >= m_nCols)) {
 		return;
 	}
 
-	col = col * OLED_FONT8x6_CHAR_W;
-
-	if (m_bHaveSH1106) {
-		col += 4;
-	}
-
-	SendCommand(SSD1306_CMD_SET_LOWCOLUMN | (col & 0XF));
-	SendCommand(SSD1306_CMD_SET_HIGHCOLUMN | (col >> 4));
-	SendCommand(SSD1306_CMD_SET_STARTPAGE | row);
-
-	m_nShadowRamIndex = (row * OLED_FONT8x6_COLS) + (col / OLED_FONT8x6_CHAR_W);
+	m_nShadowRamIndex = (row * m_nCols) + col;
 
 #if defined(ENABLE_CURSOR_MODE)
+	FlushAll();
+
 	if (m_tCursorMode == SET_CURSOR_ON) {
 		SetCursorOff();
 		SetCursorOn();
@@ -421,6 +431,96 @@ void Ssd1306::SetCursorPos(uint8_t col, uint8_t row) {
 #endif
 }
 
+void Ssd1306::SetFlushDeferred(bool bDeferred) {
+	m_bFlushDeferred = bDeferred;
+
+	Update();
+}
+
+/*
+ * Sends the first span of changed characters. Cursor position and glyph data
+ * go in one I2C transaction by using the Co bit of the control bytes.
+ */
+bool Ssd1306::FlushNext(void) {
+	const uint32_t nCells = m_nCols * m_nRows;
+	uint32_t nIndex;
+
+	for (nIndex = 0; nIndex < nCells; nIndex++) {
+		if (m_pShadowRam[nIndex] != m_pPanelRam[nIndex]) {
+			break;
+		}
+	}
+
+	if (nIndex == nCells) {
+		return false;
+	}
+
+	const uint32_t nRow = nIndex / m_nCols;
+	const uint32_t nRowEnd = (nRow + 1) * m_nCols;
+	uint32_t nEnd = nIndex + 1;
+
+	for (uint32_t i = nEnd; (i < nRowEnd) && ((i - nEnd) < FLUSH_LOOKAHEAD); i++) {
+		if (m_pShadowRam[i] != m_pPanelRam[i]) {
+			nEnd = i + 1;
+		}
+	}
+
+	uint32_t nColumn = (nIndex - (nRow * m_nCols)) * OLED_FONT8x6_CHAR_W;
+
+	if (m_bHaveSH1106) {
+		nColumn += 4;
+	}
+
+	char buffer[7 + (OLED_FONT8x6_COLS * OLED_FONT8x6_CHAR_W)];
+
+	buffer[0] = SSD1306_CONTROL_CO | SSD1306_COMMAND_MODE;
+	buffer[1] = static_cast<char>(SSD1306_CMD_SET_LOWCOLUMN | (nColumn & 0xF));
+	buffer[2] = SSD1306_CONTROL_CO | SSD1306_COMMAND_MODE;
+	buffer[3] = static_cast<char>(SSD1306_CMD_SET_HIGHCOLUMN | (nColumn >> 4));
+	buffer[4] = SSD1306_CONTROL_CO | SSD1306_COMMAND_MODE;
+	buffer[5] = static_cast<char>(SSD1306_CMD_SET_STARTPAGE | nRow);
+	buffer[6] = SSD1306_DATA_MODE;
+
+	char *p = &buffer[7];
+
+	for (uint32_t i = nIndex; i < nEnd; i++) {
+		const uint8_t *pGlyph = _OledFont8x6 + 1 + (OLED_FONT8x6_CHAR_W + 1) * (m_pShadowRam[i] - 32);
+		memcpy(p, pGlyph, OLED_FONT8x6_CHAR_W);
+		p += OLED_FONT8x6_CHAR_W;
+	}
+
+	const uint32_t nLength = static_cast<uint32_t>(p - buffer);
+
+	Setup();
+
+	if (m_bFlushDeferred) {
+		if (!i2c_write_async(buffer, nLength)) {
+			return false;
+		}
+	} else {
+		i2c_write_nb(buffer, nLength);
+	}
+
+	memcpy(&m_pPanelRam[nIndex], &m_pShadowRam[nIndex], nEnd - nIndex);
+
+	return true;
+}
+
+void Ssd1306::Update(void) {
+	if (!m_bFlushDeferred) {
+		while (FlushNext()) {
+		}
+	}
+}
+
+void Ssd1306::FlushAll(void) {
+	const bool bFlushDeferred = m_bFlushDeferred;
+
+	m_bFlushDeferred = false;
+	Update();
+	m_bFlushDeferred = bFlushDeferred;
+}
+
 void Ssd1306::SetSleep(bool bSleep) {
 	if (bSleep) {
 		SendCommand(SSD1306_CMD_DISPLAY_OFF);
@@ -457,8 +557,15 @@ void Ssd1306::InitMembers(void) {
 	m_nPages = (m_OledPanel == OLED_PANEL_128x64_8ROWS ? 8 : 4);
 
 	m_pShadowRam = new char[OLED_FONT8x6_COLS * m_nRows];
+	assert(m_pShadowRam != 0);
 	m_nShadowRamIndex = 0;
 	memset(m_pShadowRam, ' ', OLED_FONT8x6_COLS * m_nRows);
+
+	m_pPanelRam = new char[OLED_FONT8x6_COLS * m_nRows];
+	assert(m_pPanelRam != 0);
+	memset(m_pPanelRam, ' ', OLED_FONT8x6_COLS * m_nRows);
+
+	m_bFlushDeferred = false;
 }
 
 void Ssd1306::SendCommand(uint8_t cmd) {
@@ -488,6 +595,8 @@ void Ssd1306::SetCursor(TCursorMode tCursorMode) {
 
 	m_tCursorMode = tCursorMode;
 
+	FlushAll();
+
 	switch (static_cast<int>(tCursorMode)) {
 	case SET_CURSOR_OFF:
 		SetCursorOff();
@@ -512,6 +621,10 @@ void Ssd1306::SetCursorOn(void) {
 
 	uint8_t *base = _OledFont8x6 + 1 + (OLED_FONT8x6_CHAR_W + 1) * m_nCursorOnChar;
 
+	SendCommand(SSD1306_CMD_SET_LOWCOLUMN | ((m_nCursorOnCol * OLED_FONT8x6_CHAR_W) & 0XF));
+	SendCommand(SSD1306_CMD_SET_HIGHCOLUMN | ((m_nCursorOnCol * OLED_FONT8x6_CHAR_W) >> 4));
+	SendCommand(SSD1306_CMD_SET_STARTPAGE | m_nCursorOnRow);
+
 	data[0] = 0x40;
 
 	for (int i = 1 ; i <= OLED_FONT8x6_CHAR_W; i++) {
@@ -535,6 +648,10 @@ void Ssd1306::SetCursorBlinkOn(void) {
 
 	uint8_t *base = _OledFont8x6 + 1 + (OLED_FONT8x6_CHAR_W + 1) * m_nCursorOnChar;
 
+	SendCommand(SSD1306_CMD_SET_LOWCOLUMN | ((m_nCursorOnCol * OLED_FONT8x6_CHAR_W) & 0XF));
+	SendCommand(SSD1306_CMD_SET_HIGHCOLUMN | ((m_nCursorOnCol * OLED_FONT8x6_CHAR_W) >> 4));
+	SendCommand(SSD1306_CMD_SET_STARTPAGE | m_nCursorOnRow);
+
 	data[0] = 0x40;
 
 	for (int i = 1 ; i <= OLED_FONT8x6_CHAR_W; i++) {
@@ -145,12 +145,26 @@ public:
 	virtual const uint8_t *RdmReceive(uint8_t nPort)=0;
 	virtual const uint8_t *RdmReceiveTimeOut(uint8_t nPort, uint32_t nTimeOut)=0;
 
+	/*
+	 * Non-blocking transmit, used by the Art-Net RDM controller.
+	 * Returns false when a previous message is still being sent.
+	 * The default sends blocking and returns true.
+	 */
+	virtual bool RdmSendRawAsync(uint8_t nPort, const uint8_t *pRdmData, uint16_t nLength);
+	/*
+	 * Returns true as long as the message is on the wire.
+	 * When done, nSendEndMicros is the time the port was turned around to input.
+	 */
+	virtual bool RdmIsSending(uint32_t& nSendEndMicros);
+
 public:
 	inline static DmxSet* Get(void) {
 		return s_pThis;
 	}
 
 private:
+	uint32_t m_nRdmSendEndMicros;
+
 	static DmxSet *s_pThis;
 };
 
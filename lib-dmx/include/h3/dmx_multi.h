@@ -45,6 +45,9 @@ extern uint32_t dmx_multi_get_output_mab_time(void);
 extern void dmx_multi_set_output_mab_time(uint32_t);
 extern uint32_t dmx_multi_get_output_period(void);
 
+extern bool dmx_multi_rdm_send(uint8_t port, const uint8_t *data, uint16_t length);
+extern bool dmx_multi_rdm_is_sending(void);
+extern uint32_t dmx_multi_rdm_get_send_end(void);
 extern const uint8_t *dmx_multi_rdm_get_available(uint8_t uart);
 
 #ifdef __cplusplus
@@ -56,9 +56,23 @@ public:
 		return dmx_multi_get_output_period();
 	}
 
+	/*
+	 * Blocking, kept for RDMDiscovery and the responder: the discovery algorithm
+	 * is a strict request/response sequence and runs outside the main loop.
+	 */
 	void RdmSendRaw(uint8_t nPort, const uint8_t *pRdmData, uint16_t nLength);
 
+	/*
+	 * Returns immediately, BREAK, MAB, data and the turnaround to input are interrupt driven.
+	 * Returns false when a previous message is still being sent.
+	 */
+	bool RdmSendRawAsync(uint8_t nPort, const uint8_t *pRdmData, uint16_t nLength);
+	bool RdmIsSending(uint32_t& nSendEndMicros);
+
 	const uint8_t *RdmReceive(uint8_t nPort);
+	/*
+	 * Blocking, see RdmSendRaw. The Art-Net RDM controller polls RdmIsSending/RdmReceive instead.
+	 */
 	const uint8_t *RdmReceiveTimeOut(uint8_t nPort, uint32_t nTimeOut);
 
 private:
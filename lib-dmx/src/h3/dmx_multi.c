@@ -2,7 +2,7 @@
  * @file dmx_multi.c
  *
  */
-/* Copyright (C) 2018 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2018-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -27,6 +27,7 @@
 #include <string.h>
 #include <assert.h>
 
+#include "h3/dmx_multi.h"
 #include "dmx_multi_internal.h"
 
 #include "dmx.h"
@@ -49,6 +50,8 @@
 
 #include "uart.h"
 
+#include "profiler.h"
+
 #ifndef ALIGNED
  #define ALIGNED __attribute__ ((aligned (4)))
 #endif
@@ -61,6 +64,8 @@ extern int console_error(const char *);
 
 #define DMX_DATA_OUT_INDEX	(1 << 2)
 
+#define RDM_TRANSMIT_SLOT_TIME	44	///< 11 bits at 250kbit/s
+
 typedef enum {
 	IDLE = 0,
 	PRE_BREAK,
@@ -73,7 +78,9 @@ typedef enum {
 	RDMDISCFE,
 	RDMDISCEUID,
 	RDMDISCECS,
-	DMXINTER
+	DMXINTER,
+	RDMDRAIN,
+	RDMTURNAROUND
 } _tx_rx_state;
 
 typedef enum {
@@ -88,6 +95,8 @@ struct _dmx_multi_data {
 struct coherent_region {
 	struct sunxi_dma_lli lli[DMX_MAX_OUT];
 	struct _dmx_multi_data dmx_data[DMX_MAX_OUT][DMX_DATA_OUT_INDEX] ALIGNED;
+	struct sunxi_dma_lli rdm_lli;
+	uint8_t rdm_tx_data[RDM_DATA_BUFFER_SIZE] ALIGNED;
 };
 
 struct _rdm_multi_data {
@@ -125,9 +134,42 @@ static volatile uint32_t rdm_data_read_index[DMX_MAX_OUT] ALIGNED = { 0, };
 static volatile _uart_state uart_state[DMX_MAX_OUT] ALIGNED;
 static volatile uint32_t uarts_sending = 0;
 
+/*
+ * RDM TX, there is just a single RDM process.
+ * BREAK and MAB are timed with TIMER1, the data is sent with DMA.
+ */
+static volatile _tx_rx_state rdm_send_state = IDLE;
+static volatile uint32_t rdm_send_end_us;
+static uint8_t rdm_send_uart;
+
+static void uart_enable_fifo(uint8_t uart);
+static void uart_disable_fifo(uint8_t uart);
+
 static char CONSOLE_ERROR[] ALIGNED = "DMXDATA %\n";
 #define CONSOLE_ERROR_LENGTH (sizeof(CONSOLE_ERROR) / sizeof(CONSOLE_ERROR[0]))
 
+static H3_DMA_CHL_TypeDef *_get_dma_channel(uint8_t uart) {
+	switch (uart) {
+	case 0:
+		return H3_DMA_CHL0;
+		break;
+	case 1:
+		return H3_DMA_CHL1;
+		break;
+	case 2:
+		return H3_DMA_CHL2;
+		break;
+	case 3:
+		return H3_DMA_CHL3;
+		break;
+	default:
+		assert(0);
+		break;
+	}
+
+	return 0;
+}
+
 static void dmx_multi_clear_data(uint8_t uart) {
 	uint32_t i, j;
 
@@ -298,6 +340,65 @@ static void irq_timer0_dmx_multi_sender(uint32_t clo) {
 #endif
 }
 
+static void irq_timer1_rdm_sender(__attribute__((unused)) uint32_t clo) {
+	H3_UART_TypeDef *p = _get_uart(rdm_send_uart);
+	H3_DMA_CHL_TypeDef *dma;
+
+	switch (rdm_send_state) {
+	case BREAK:
+		H3_TIMER->TMR1_INTV = RDM_TRANSMIT_MAB_TIME * 12;
+		H3_TIMER->TMR1_CTRL |= (TIMER_CTRL_EN_START | TIMER_CTRL_RELOAD);
+
+		p->LCR = UART_LCR_8_N_2;
+
+		dmb();
+		rdm_send_state = MAB;
+		break;
+	case MAB:
+		dma = _get_dma_channel(rdm_send_uart);
+		dma->DESC_ADDR = (uint32_t) &p_coherent_region->rdm_lli;
+		dma->EN = DMA_CHAN_ENABLE_START;
+		isb();
+
+		dmb();
+		rdm_send_state = RDMDATA;
+		break;
+	case RDMDRAIN:
+		// The DMA is done, wait for the last slots leaving the FIFO
+		if ((p->LSR & UART_LSR_TEMT) != UART_LSR_TEMT) {
+			H3_TIMER->TMR1_INTV = RDM_TRANSMIT_SLOT_TIME * 12;
+			H3_TIMER->TMR1_CTRL |= (TIMER_CTRL_EN_START | TIMER_CTRL_RELOAD);
+			break;
+		}
+
+		H3_TIMER->TMR1_INTV = RDM_RESPONDER_DATA_DIRECTION_DELAY * 12;
+		H3_TIMER->TMR1_CTRL |= (TIMER_CTRL_EN_START | TIMER_CTRL_RELOAD);
+
+		dmb();
+		rdm_send_state = RDMTURNAROUND;
+		break;
+	case RDMTURNAROUND:
+		h3_gpio_clr(dmx_data_direction_gpio_pin[rdm_send_uart]);	// 0 = input, 1 = output
+		dmx_port_direction[rdm_send_uart] = DMX_PORT_DIRECTION_INP;
+		rdm_receive_state[rdm_send_uart] = IDLE;
+
+		while ((p->USR & UART_USR_BUSY) == UART_USR_BUSY) {
+			(void) p->O00.RBR;
+		}
+
+		uart_disable_fifo(rdm_send_uart);
+		uart_state[rdm_send_uart] = UART_STATE_RX;
+		rdm_send_end_us = h3_hs_timer_lo_us();
+
+		dmb();
+		rdm_send_state = IDLE;
+		break;
+	default:
+		assert(0);
+		break;
+	}
+}
+
 static void fiq_rdm_in_handler(uint8_t uart, const H3_UART_TypeDef *u) {
 	uint16_t index;
 
@@ -426,13 +527,24 @@ static void fiq_rdm_in_handler(uint8_t uart, const H3_UART_TypeDef *u) {
 	dmb();
 }
 
+PROFILER_ISR_SECTION(s_profile_fiq, "fiq_dmx_multi");
+
 static void __attribute__((interrupt("FIQ"))) fiq_dmx_multi(void) {
+	PROFILE_ISR_ENTER(s_profile_fiq);
 	dmb();
 
 #ifdef LOGIC_ANALYZER
 	h3_gpio_set(3);
 #endif
 
+	// RDM TX
+	if ((rdm_send_state == RDMDATA) && (H3_DMA->IRQ_PEND0 & (DMA_IRQ_PEND0_DMA0_PKG_IRQ_EN << (rdm_send_uart * 4)))) {
+		H3_TIMER->TMR1_INTV = RDM_TRANSMIT_SLOT_TIME * 12;
+		H3_TIMER->TMR1_CTRL |= (TIMER_CTRL_EN_START | TIMER_CTRL_RELOAD);
+
+		rdm_send_state = RDMDRAIN;
+	}
+
 	// UART1
 	if (H3_DMA->IRQ_PEND0 & (DMA_IRQ_PEND0_DMA1_HALF_IRQ_EN | DMA_IRQ_PEND0_DMA1_PKG_IRQ_EN)) {
 		uarts_sending &= ~(1 << 1);
@@ -459,7 +571,7 @@ static void __attribute__((interrupt("FIQ"))) fiq_dmx_multi(void) {
 		gic_unpend(H3_DMA_IRQn);
 		isb();
 		
-		if (uarts_sending == 0) {
+		if ((uarts_sending == 0) && (dmx_send_state == DMXDATA)) {
 			dmb();
 			dmx_send_state = DMXINTER;
 		}
@@ -492,6 +604,7 @@ static void __attribute__((interrupt("FIQ"))) fiq_dmx_multi(void) {
 	h3_gpio_clr(3);
 #endif
 	dmb();
+	PROFILE_ISR_EXIT(s_profile_fiq);
 }
 
 static void uart_enable_fifo(uint8_t uart) {	// DMX TX
@@ -665,6 +778,17 @@ void dmx_multi_set_port_send_data_without_sc(uint8_t port, const uint8_t *data,
 void dmx_multi_set_port_direction(uint8_t port, _dmx_port_direction port_direction, bool enable_data) {
 	const uint32_t uart = _port_to_uart(port);
 
+	if ((rdm_send_state != IDLE) && (rdm_send_uart == uart)) {
+		if ((port_direction == DMX_PORT_DIRECTION_INP) && enable_data) {
+			// The turnaround is done by the RDM sender
+			return;
+		}
+
+		while (rdm_send_state != IDLE) {
+			dmb();
+		}
+	}
+
 	if (port_direction != dmx_port_direction[uart]) {
 		dmx_multi_stop_data(uart);
 		switch (port_direction) {
@@ -689,6 +813,60 @@ void dmx_multi_set_port_direction(uint8_t port, _dmx_port_direction port_directi
 	}
 }
 
+bool dmx_multi_rdm_send(uint8_t port, const uint8_t *data, uint16_t length) {
+	assert(data != 0);
+	assert(length != 0);
+	assert(length <= RDM_DATA_BUFFER_SIZE);
+
+	dmb();
+	if (rdm_send_state != IDLE) {
+		return false;
+	}
+
+	const uint32_t uart = _port_to_uart(port);
+	assert(uart < DMX_MAX_OUT);
+
+	if (dmx_port_direction[uart] != DMX_PORT_DIRECTION_OUTP) {
+		dmx_multi_set_port_direction(port, DMX_PORT_DIRECTION_OUTP, false);
+	} else {
+		dmx_multi_stop_data(uart);
+	}
+
+	memcpy(p_coherent_region->rdm_tx_data, data, (size_t) length);
+
+	struct sunxi_dma_lli *lli = &p_coherent_region->rdm_lli;
+	H3_UART_TypeDef *p = _get_uart(uart);
+
+	lli->cfg = DMA_CHAN_CFG_DST_IO_MODE | DMA_CHAN_CFG_SRC_LINEAR_MODE | DMA_CHAN_CFG_SRC_DRQ(DRQSRC_SDRAM) | DMA_CHAN_CFG_DST_DRQ(uart + DRQDST_UART0TX);
+	lli->src = (uint32_t) &p_coherent_region->rdm_tx_data[0];
+	lli->dst = (uint32_t) &p->O00.THR;
+	lli->len = length;
+	lli->para = DMA_NORMAL_WAIT;
+	lli->p_lli_next = DMA_LLI_LAST_ITEM;
+
+	rdm_send_uart = uart;
+
+	uart_enable_fifo(uart);
+	p->LCR = UART_LCR_8_N_2 | UART_LCR_BC;
+
+	dmb();
+	rdm_send_state = BREAK;
+
+	H3_TIMER->TMR1_INTV = RDM_TRANSMIT_BREAK_TIME * 12;
+	H3_TIMER->TMR1_CTRL |= (TIMER_CTRL_EN_START | TIMER_CTRL_RELOAD);
+
+	return true;
+}
+
+bool dmx_multi_rdm_is_sending(void) {
+	dmb();
+	return (rdm_send_state != IDLE);
+}
+
+uint32_t dmx_multi_rdm_get_send_end(void) {
+	return rdm_send_end_us;
+}
+
 const uint8_t *dmx_multi_rdm_get_available(uint8_t uart)  {
 	dmb();
 
@@ -837,6 +1015,12 @@ void dmx_multi_init(void) {
 	irq_timer_set(IRQ_TIMER_0, irq_timer0_dmx_multi_sender);
 
 	H3_TIMER->TMR0_CTRL |= TIMER_CTRL_SINGLE_MODE;
+
+	rdm_send_state = IDLE;
+
+	irq_timer_set(IRQ_TIMER_1, irq_timer1_rdm_sender);
+
+	H3_TIMER->TMR1_CTRL |= TIMER_CTRL_SINGLE_MODE;
 	H3_TIMER->TMR0_INTV = 12000; // Wait 1ms
 	H3_TIMER->TMR0_CTRL |= (TIMER_CTRL_EN_START | TIMER_CTRL_RELOAD); // 0x3;
 
@@ -67,23 +67,26 @@ void DmxMulti::RdmSendRaw(uint8_t nPort, const uint8_t* pRdmData, uint16_t nLeng
 	assert(pRdmData != 0);
 	assert(nLength != 0);
 
-	H3_UART_TypeDef *p = _get_uart(_port_to_uart(nPort));
+	// Only wait when a previous RDM message is still in flight
+	while (!dmx_multi_rdm_send(nPort, pRdmData, nLength)) {
+	}
+}
 
-	p->LCR = UART_LCR_8_N_2 | UART_LCR_BC;
-	udelay(RDM_TRANSMIT_BREAK_TIME);
+bool DmxMulti::RdmSendRawAsync(uint8_t nPort, const uint8_t *pRdmData, uint16_t nLength) {
+	assert(nPort < DMX_MAX_OUT);
+	assert(pRdmData != 0);
+	assert(nLength != 0);
 
-	p->LCR = UART_LCR_8_N_2;
-	udelay(RDM_TRANSMIT_MAB_TIME);
+	return dmx_multi_rdm_send(nPort, pRdmData, nLength);
+}
 
-	for (uint16_t i = 0; i < nLength; i++) {
-		while (!(p->LSR & UART_LSR_THRE))
-			;
-		p->O00.THR = pRdmData[i];
+bool DmxMulti::RdmIsSending(uint32_t& nSendEndMicros) {
+	if (dmx_multi_rdm_is_sending()) {
+		return true;
 	}
 
-	while ((p->USR & UART_USR_BUSY) == UART_USR_BUSY) {
-		static_cast<void>(p->O00.RBR);
-	}
+	nSendEndMicros = dmx_multi_rdm_get_send_end();
+	return false;
 }
 
 const uint8_t *DmxMulti::RdmReceive(uint8_t nPort) {
@@ -96,14 +99,18 @@ const uint8_t *DmxMulti::RdmReceive(uint8_t nPort) {
 const uint8_t *DmxMulti::RdmReceiveTimeOut(uint8_t nPort, uint32_t nTimeOut) {
 	assert(nPort < DMX_MAX_OUT);
 
+	// The time-out starts when the request has left the wire
+	while (dmx_multi_rdm_is_sending()) {
+	}
+
 	uint8_t *p = 0;
-	const uint32_t nMicros = h3_hs_timer_lo_us() + nTimeOut;
+	const uint32_t nMicros = dmx_multi_rdm_get_send_end();
 
 	do {
 		if ((p = const_cast<uint8_t*>(dmx_multi_rdm_get_available(_port_to_uart(nPort)))) != 0) {
 			return p;
 		}
-	} while (h3_hs_timer_lo_us() < nMicros);
+	} while ((h3_hs_timer_lo_us() - nMicros) < nTimeOut);
 
 	return p;
 }
@@ -28,11 +28,35 @@
 
 #include "dmx.h"
 
+#include "rdm.h"
+
+#include "h3.h"
+#include "h3_hs_timer.h"
+
 DmxSet *DmxSet::s_pThis = 0;
 
-DmxSet::DmxSet(void) {
+DmxSet::DmxSet(void): m_nRdmSendEndMicros(0) {
 	s_pThis = this;
 }
 
 DmxSet::~DmxSet(void) {
 }
+
+bool DmxSet::RdmSendRawAsync(uint8_t nPort, const uint8_t *pRdmData, uint16_t nLength) {
+	SetPortDirection(nPort, DMXRDM_PORT_DIRECTION_OUTP, false);
+
+	RdmSendRaw(nPort, pRdmData, nLength);
+
+	udelay(RDM_RESPONDER_DATA_DIRECTION_DELAY);
+
+	SetPortDirection(nPort, DMXRDM_PORT_DIRECTION_INP, true);
+
+	m_nRdmSendEndMicros = h3_hs_timer_lo_us();
+
+	return true;
+}
+
+bool DmxSet::RdmIsSending(uint32_t& nSendEndMicros) {
+	nSendEndMicros = m_nRdmSendEndMicros;
+	return false;
+}
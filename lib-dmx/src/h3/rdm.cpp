@@ -53,6 +53,32 @@ const uint8_t *Rdm::ReceiveTimeOut(uint8_t nPort, uint32_t nTimeOut) {
 	return DmxSet::Get()->RdmReceiveTimeOut(nPort, nTimeOut);
 }
 
+bool Rdm::SendRawAsync(uint8_t nPort, const uint8_t *pRdmData, uint16_t nLength) {
+	assert(nPort < DMX_MAX_OUT);
+	assert(pRdmData != 0);
+	assert(nLength != 0);
+
+	return DmxSet::Get()->RdmSendRawAsync(nPort, pRdmData, nLength);
+}
+
+const uint8_t *Rdm::ReceiveAsync(uint8_t nPort, uint32_t nTimeOut, bool& bIsTimeOut) {
+	uint32_t nSendEndMicros;
+
+	bIsTimeOut = false;
+
+	if (DmxSet::Get()->RdmIsSending(nSendEndMicros)) {
+		return 0;
+	}
+
+	const uint8_t *p = DmxSet::Get()->RdmReceive(nPort);
+
+	if (p == 0) {
+		bIsTimeOut = ((h3_hs_timer_lo_us() - nSendEndMicros) >= nTimeOut);
+	}
+
+	return p;
+}
+
 void Rdm::Send(uint8_t nPort, struct TRdmMessage *pRdmCommand) {
 	DEBUG_ENTRY
 
@@ -36,6 +36,8 @@
 
 uint8_t Rdm::m_TransactionNumber = 0;
 
+static uint32_t s_nSendEndMicros;
+
 Rdm::Rdm(void) {
 
 }
@@ -62,6 +64,23 @@ const uint8_t *Rdm::ReceiveTimeOut(uint8_t nPort, uint32_t nTimeOut) {
 	return reinterpret_cast<const uint8_t*>(p);
 }
 
+bool Rdm::SendRawAsync(uint8_t nPort, const uint8_t *pRdmData, uint16_t nLength) {
+	// There is no interrupt driven RDM transmit, the message is sent blocking
+	SendRaw(nPort, pRdmData, nLength);
+
+	s_nSendEndMicros = BCM2835_ST->CLO;
+
+	return true;
+}
+
+const uint8_t *Rdm::ReceiveAsync(uint8_t nPort, uint32_t nTimeOut, bool& bIsTimeOut) {
+	const uint8_t *p = rdm_get_available();
+
+	bIsTimeOut = (p == 0) && ((BCM2835_ST->CLO - s_nSendEndMicros) >= nTimeOut);
+
+	return p;
+}
+
 void Rdm::Send(uint8_t nPort, struct TRdmMessage *pRdmCommand) {
 	assert(pRdmCommand != 0);
 
@@ -3,7 +3,7 @@
  * @file dmxsender.cpp
  *
  */
-/* Copyright (C) 2017 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2017-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -30,8 +30,13 @@
 
 #include "dmx.h"
 
+#include "metrics.h"
+
 #include "debug.h"
 
+static struct metric s_MetricUpdates = METRIC_COUNTER("dmx.tx.updates");
+static struct metric s_MetricSlots = METRIC_GAUGE("dmx.tx.slots");
+
 DMXSend::DMXSend(void) : m_bIsStarted(false) {
 }
 
@@ -48,6 +53,9 @@ void DMXSend::Start(uint8_t nPort) {
 
 	m_bIsStarted = true;
 
+	metrics_register(&s_MetricUpdates);
+	metrics_register(&s_MetricSlots);
+
 	SetPortDirection(0, DMXRDM_PORT_DIRECTION_OUTP, true);
 	DEBUG_EXIT
 }
@@ -76,6 +84,9 @@ void DMXSend::SetData(uint8_t nPortId, const uint8_t *pData, uint16_t nLength) {
 
 	dmx_set_send_data_without_sc(pData, nLength);
 
+	metric_inc(&s_MetricUpdates);
+	metric_set(&s_MetricSlots, nLength);
+
 	DEBUG_EXIT
 }
 #endif
@@ -101,7 +101,7 @@ void DmxSerial::SetData(uint8_t nPort, const uint8_t *pData, uint16_t nLength) {
 					continue;
 				}
 
-				m_Serial.Send(pSerialData, nLength);
+				m_Serial.Queue(pSerialData, nLength);
 			}
 		}
 	}
@@ -239,6 +239,8 @@ void DmxSerial::EnableTFTP(bool bEnableTFTP) {
 }
 
 void DmxSerial::Run(void) {
+	m_Serial.Run();
+
 	HandleUdp();
 
 	if (m_pDmxSerialTFTP == 0) {
@@ -111,6 +111,17 @@ enum TPriority {
 	E131_PRIORITY_HIGHEST	= 200	///<
 };
 
+/**
+ * 7.2 DMX512-A START Code
+ *
+ * Only the NULL START Code carries levels. The 0xDD alternate START Code (per-address priority)
+ * carries one priority per slot, 0 meaning the source does not drive that slot.
+ */
+enum TE131StartCode {
+	E131_START_CODE_DMX						= 0x00,	///< NULL START Code
+	E131_START_CODE_PER_ADDRESS_PRIORITY	= 0xDD	///< Per-address priority
+};
+
 /**
  * 6.2.6 Options
  */
@@ -61,7 +61,6 @@ struct TE131BridgeState {
 	uint16_t nSynchronizationAddressSourceB;
 	uint8_t nActiveInputPorts;
 	uint8_t nActiveOutputPorts;
-	uint8_t nPriority;
 };
 
 struct TSource {
@@ -70,6 +69,9 @@ struct TSource {
 	uint8_t data[E131_DMX_LENGTH];
 	uint8_t cid[E131_CID_LENGTH];
 	uint8_t sequenceNumberData;
+	uint8_t priority;							///< Universe priority of the last data packet
+	uint32_t slotPriorityTime;					///< Time of the last 0xDD packet, 0 when never received
+	uint8_t slotPriority[E131_DMX_LENGTH];		///< Per-address priority, 0 is not driving the slot
 };
 
 struct TE131OutputPort {
@@ -81,6 +83,8 @@ struct TE131OutputPort {
 	bool bIsEnabled;
 	bool IsTransmitting;
 	bool IsMerging;
+	bool bIsSlotPriority;				///< Is a source sending per-address priority?
+	uint8_t nPriority;					///< Universe priority this port is listening to
 	struct TSource sourceA;
 	struct TSource sourceB;
 };
@@ -130,6 +134,15 @@ public:
 	bool IsMerging(uint8_t nPortIndex) const;
 	bool IsStatusChanged(void);
 
+	uint8_t GetOutputPriority(uint8_t nPortIndex) const {
+		assert(nPortIndex < E131_MAX_PORTS);
+		return m_OutputPort[nPortIndex].nPriority;
+	}
+	bool IsPerAddressPriority(uint8_t nPortIndex) const {
+		assert(nPortIndex < E131_MAX_PORTS);
+		return m_OutputPort[nPortIndex].bIsSlotPriority;
+	}
+
 	void SetDisableNetworkDataLossTimeout(bool bDisable = true) {
 		m_State.bDisableNetworkDataLossTimeout = bDisable;
 	}
@@ -208,6 +221,10 @@ private:
 	bool isIpCidMatch(const struct TSource *);
 	bool IsDmxDataChanged(uint8_t nPortIndex, const uint8_t *pData, uint16_t nLength);
 	bool IsMergedDmxDataChanged(uint8_t nPortIndex, const uint8_t *pData, uint16_t nLength);
+	// Per-address priority (0xDD)
+	bool IsSlotPriority(uint8_t nPortIndex);
+	void HandleSlotPriority(struct TSource *pSource, const uint8_t *pPriority, uint16_t nLength);
+	bool IsSlotPriorityDmxDataChanged(uint8_t nPortIndex, uint16_t nLength);
 
 	void HandleDmx(void);
 	void HandleSynchronization(void);
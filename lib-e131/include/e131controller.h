@@ -70,10 +70,7 @@ public:
 	void HandleSync(void);
 	void HandleBlackout(void);
 
-	void SetSynchronizationAddress(uint16_t nSynchronizationAddress = DEFAULT_SYNCHRONIZATION_ADDRESS) {
-		m_State.SynchronizationPacket.nUniverseNumber = nSynchronizationAddress;
-		m_State.SynchronizationPacket.nIpAddress = UniverseToMulticastIp(nSynchronizationAddress);
-	}
+	void SetSynchronizationAddress(uint16_t nSynchronizationAddress = DEFAULT_SYNCHRONIZATION_ADDRESS);
 	uint16_t GetSynchronizationAddress(void) {
 		return m_State.SynchronizationPacket.nUniverseNumber;
 	}
@@ -93,6 +90,9 @@ public:
 
 	void SetSourceName(const char *pSourceName);
 	void SetPriority(uint8_t nPriority);
+	uint8_t GetPriority(void) {
+		return m_State.nPriority;
+	}
 
 private:
 	uint32_t UniverseToMulticastIp(uint16_t nUniverse) const;
@@ -40,6 +40,8 @@
 #include "hardware.h"
 #include "network.h"
 #include "ledblink.h"
+#include "metrics.h"
+#include "profiler.h"
 
 #include "debug.h"
 
@@ -51,7 +53,14 @@
  #define MAX(a, b) ((a) > (b) ? (a) : (b))
 #endif
 
-static const uint8_t DEVICE_SOFTWARE_VERSION[] = { 1, 18 };
+static const uint8_t DEVICE_SOFTWARE_VERSION[] = { 1, 19 };
+
+static struct metric s_MetricPackets = METRIC_COUNTER("e131.rx.packets");
+static struct metric s_MetricInvalid = METRIC_COUNTER("e131.rx.invalid");
+static struct metric s_MetricOutOfSequence = METRIC_COUNTER("e131.dmx.out_of_sequence");
+static struct metric s_MetricDmxMerged = METRIC_COUNTER("e131.dmx.merged");
+static struct metric s_MetricDmxUpdates = METRIC_COUNTER("e131.dmx.updates");
+static struct metric s_MetricSync = METRIC_COUNTER("e131.sync.packets");
 
 E131Bridge *E131Bridge::s_pThis = 0;
 
@@ -79,6 +88,7 @@ E131Bridge::E131Bridge(void) :
 		memset(&m_OutputPort[i], 0, sizeof(struct TE131OutputPort));
 		m_OutputPort[i].nUniverse = E131_UNIVERSE_DEFAULT;
 		m_OutputPort[i].mergeMode = E131_MERGE_HTP;
+		m_OutputPort[i].nPriority = E131_PRIORITY_LOWEST;
 	}
 
 	for (uint32_t i = 0; i < E131_MAX_UARTS; i++) {
@@ -87,7 +97,6 @@ E131Bridge::E131Bridge(void) :
 	}
 
 	memset(&m_State, 0, sizeof(struct TE131BridgeState));
-	m_State.nPriority = E131_PRIORITY_LOWEST;
 
 	char aSourceName[E131_SOURCE_NAME_LENGTH];
 	uint8_t nLength;
@@ -106,6 +115,13 @@ E131Bridge::~E131Bridge(void) {
 }
 
 void E131Bridge::Start(void) {
+	metrics_register(&s_MetricPackets);
+	metrics_register(&s_MetricInvalid);
+	metrics_register(&s_MetricOutOfSequence);
+	metrics_register(&s_MetricDmxMerged);
+	metrics_register(&s_MetricDmxUpdates);
+	metrics_register(&s_MetricSync);
+
 	if (m_pE131DmxIn != 0) {
 		if (m_pE131DataPacket == 0) {
 			struct in_addr addr;
@@ -135,7 +151,9 @@ void E131Bridge::Stop(void) {
 
 	if (m_pLightSet != 0) {
 		for (uint32_t i = 0; i < E131_MAX_PORTS; i++) {
-			m_pLightSet->Stop(i);
+			if (m_OutputPort[i].bIsEnabled) {
+				m_pLightSet->Stop(i);
+			}
 			m_OutputPort[i].length = 0;
 			m_OutputPort[i].IsDataPending = false;
 		}
@@ -325,6 +343,10 @@ bool E131Bridge::IsDmxDataChanged(uint8_t nPortIndex, const uint8_t *pData, uint
 	assert(nPortIndex < E131_MAX_PORTS);
 	assert(pData != 0);
 
+	if (m_OutputPort[nPortIndex].bIsSlotPriority) {
+		return IsSlotPriorityDmxDataChanged(nPortIndex, nLength);
+	}
+
 	bool isChanged = false;
 
 	const uint8_t *pSrc = pData;
@@ -351,6 +373,8 @@ bool E131Bridge::IsDmxDataChanged(uint8_t nPortIndex, const uint8_t *pData, uint
 }
 
 bool E131Bridge::IsMergedDmxDataChanged(uint8_t nPortIndex, const uint8_t *pData, uint16_t nLength) {
+	PROFILE_SCOPE("e131.merge");
+
 	assert(nPortIndex < E131_MAX_PORTS);
 	assert(pData != 0);
 
@@ -361,8 +385,14 @@ bool E131Bridge::IsMergedDmxDataChanged(uint8_t nPortIndex, const uint8_t *pData
 		m_State.IsChanged = true;
 	}
 
+	metric_inc(&s_MetricDmxMerged);
+
 	m_OutputPort[nPortIndex].IsMerging = true;
 
+	if (m_OutputPort[nPortIndex].bIsSlotPriority) {
+		return IsSlotPriorityDmxDataChanged(nPortIndex, nLength);
+	}
+
 	if (m_OutputPort[nPortIndex].mergeMode == E131_MERGE_HTP) {
 
 		if (nLength != m_OutputPort[nPortIndex].length) {
@@ -477,9 +507,6 @@ void E131Bridge::HandleDmx(void) {
 		struct TSource *pSourceA = &m_OutputPort[i].sourceA;
 		struct TSource *pSourceB = &m_OutputPort[i].sourceB;
 
-		const uint32_t ipA = pSourceA->ip;
-		const uint32_t ipB = pSourceB->ip;
-
 		const bool isSourceA = isIpCidMatch(pSourceA);
 		const bool isSourceB = isIpCidMatch(pSourceB);
 
@@ -493,12 +520,14 @@ void E131Bridge::HandleDmx(void) {
 			const int8_t diff = (m_E131.E131Packet.Data.FrameLayer.SequenceNumber - pSourceA->sequenceNumberData);
 			pSourceA->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
 			if ((diff <= 0) && (diff > -20)) {
+				metric_inc(&s_MetricOutOfSequence);
 				continue;
 			}
 		} else if (isSourceB) {
 			const int8_t diff = (m_E131.E131Packet.Data.FrameLayer.SequenceNumber - pSourceB->sequenceNumberData);
 			pSourceB->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
 			if ((diff <= 0) && (diff > -20)) {
+				metric_inc(&s_MetricOutOfSequence);
 				continue;
 			}
 		}
@@ -518,30 +547,89 @@ void E131Bridge::HandleDmx(void) {
 			continue;
 		}
 
+		// Alternate START Codes are not DMX data. Per-address priority is only accepted from a source
+		// that is already sending DMX data to this port.
+		const uint8_t nStartCode = m_E131.E131Packet.Data.DMPLayer.PropertyValues[0];
+
+		if (nStartCode != E131_START_CODE_DMX) {
+			if (nStartCode == E131_START_CODE_PER_ADDRESS_PRIORITY) {
+				if (isSourceA) {
+					HandleSlotPriority(pSourceA, p, slots);
+				} else if (isSourceB) {
+					HandleSlotPriority(pSourceB, p, slots);
+				}
+			}
+			continue;
+		}
+
 		if (m_State.IsMergeMode) {
 			if (__builtin_expect((!m_State.bDisableMergeTimeout), 1)) {
 				CheckMergeTimeouts(i);
 			}
 		}
 
-		if (m_E131.E131Packet.Data.FrameLayer.Priority < m_State.nPriority ){
-			if (!IsPriorityTimeOut(i)) {
-				continue;
+		const uint8_t nPriority = m_E131.E131Packet.Data.FrameLayer.Priority;
+
+		// With per-address priority the sources are arbitrated slot by slot, so a lower
+		// universe priority does not discard the packet.
+		const bool bWasSlotPriority = m_OutputPort[i].bIsSlotPriority;
+		m_OutputPort[i].bIsSlotPriority = IsSlotPriority(i);
+
+		if (bWasSlotPriority && !m_OutputPort[i].bIsSlotPriority) {
+			// Back to universe priority, drop the lower source kept for the per-address merge
+			const uint8_t nPriorityA = (pSourceA->ip != 0) ? pSourceA->priority : 0;
+			const uint8_t nPriorityB = (pSourceB->ip != 0) ? pSourceB->priority : 0;
+
+			if (nPriorityA < nPriorityB) {
+				pSourceA->ip = 0;
+			} else if (nPriorityB < nPriorityA) {
+				pSourceB->ip = 0;
 			}
-			m_State.nPriority = m_E131.E131Packet.Data.FrameLayer.Priority;
-		} else if (m_E131.E131Packet.Data.FrameLayer.Priority > m_State.nPriority) {
-			m_OutputPort[i].sourceA.ip = 0;
-			m_OutputPort[i].sourceB.ip = 0;
-			m_State.IsMergeMode = false;
-			m_State.nPriority = m_E131.E131Packet.Data.FrameLayer.Priority;
+
+			m_OutputPort[i].nPriority = MAX(nPriorityA, nPriorityB);
+		}
+
+		if (nPriority < m_OutputPort[i].nPriority) {
+			if (!m_OutputPort[i].bIsSlotPriority) {
+				if (!IsPriorityTimeOut(i)) {
+					continue;
+				}
+				m_OutputPort[i].nPriority = nPriority;
+			}
+		} else if (nPriority > m_OutputPort[i].nPriority) {
+			if (!m_OutputPort[i].bIsSlotPriority) {
+				pSourceA->ip = 0;
+				pSourceB->ip = 0;
+
+				if (m_OutputPort[i].IsMerging) {
+					m_OutputPort[i].IsMerging = false;
+
+					bool bIsMerging = false;
+
+					for (uint32_t nPortIndex = 0; nPortIndex < E131_MAX_PORTS; nPortIndex++) {
+						bIsMerging |= m_OutputPort[nPortIndex].IsMerging;
+					}
+
+					if (!bIsMerging) {
+						m_State.IsChanged = true;
+						m_State.IsMergeMode = false;
+					}
+				}
+			}
+			m_OutputPort[i].nPriority = nPriority;
 		}
 
+		const uint32_t ipA = pSourceA->ip;
+		const uint32_t ipB = pSourceB->ip;
+
 		if ((ipA == 0) && (ipB == 0)) {
 			//printf("1. First package from Source\n");
 			pSourceA->ip = m_E131.IPAddressFrom;
 			pSourceA->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
 			memcpy(pSourceA->cid, m_E131.E131Packet.Data.RootLayer.Cid, 16);
 			pSourceA->time = m_nCurrentPacketMillis;
+			pSourceA->priority = nPriority;
+			pSourceA->slotPriorityTime = 0;
 			memcpy(pSourceA->data, p, slots);
 			sendNewData = IsDmxDataChanged(i, p, slots);
 
@@ -549,6 +637,7 @@ void E131Bridge::HandleDmx(void) {
 			//printf("2. Continue package from SourceA\n");
 			pSourceA->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
 			pSourceA->time = m_nCurrentPacketMillis;
+			pSourceA->priority = nPriority;
 			memcpy(pSourceA->data, p, slots);
 			sendNewData = IsDmxDataChanged(i, p, slots);
 
@@ -556,6 +645,7 @@ void E131Bridge::HandleDmx(void) {
 			//printf("3. Continue package from SourceB\n");
 			pSourceB->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
 			pSourceB->time = m_nCurrentPacketMillis;
+			pSourceB->priority = nPriority;
 			memcpy(pSourceB->data, p, slots);
 			sendNewData = IsDmxDataChanged(i, p, slots);
 
@@ -565,6 +655,8 @@ void E131Bridge::HandleDmx(void) {
 			pSourceB->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
 			memcpy(pSourceB->cid, m_E131.E131Packet.Data.RootLayer.Cid, 16);
 			pSourceB->time = m_nCurrentPacketMillis;
+			pSourceB->priority = nPriority;
+			pSourceB->slotPriorityTime = 0;
 			memcpy(pSourceB->data, p, slots);
 			sendNewData = IsMergedDmxDataChanged(i, pSourceB->data, slots);
 
@@ -574,6 +666,8 @@ void E131Bridge::HandleDmx(void) {
 			pSourceA->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
 			memcpy(pSourceA->cid, m_E131.E131Packet.Data.RootLayer.Cid, 16);
 			pSourceA->time = m_nCurrentPacketMillis;
+			pSourceA->priority = nPriority;
+			pSourceA->slotPriorityTime = 0;
 			memcpy(pSourceA->data, p, slots);
 			sendNewData = IsMergedDmxDataChanged(i, pSourceA->data, slots);
 
@@ -581,6 +675,7 @@ void E131Bridge::HandleDmx(void) {
 			//printf("6. Continue merging\n");
 			pSourceA->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
 			pSourceA->time = m_nCurrentPacketMillis;
+			pSourceA->priority = nPriority;
 			memcpy(pSourceA->data, p, slots);
 			sendNewData = IsMergedDmxDataChanged(i, pSourceA->data, slots);
 
@@ -588,6 +683,7 @@ void E131Bridge::HandleDmx(void) {
 			//printf("7. Continue merging\n");
 			pSourceB->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
 			pSourceB->time = m_nCurrentPacketMillis;
+			pSourceB->priority = nPriority;
 			memcpy(pSourceB->data, p, slots);
 			sendNewData = IsMergedDmxDataChanged(i, pSourceB->data, slots);
 
@@ -637,6 +733,7 @@ void E131Bridge::HandleDmx(void) {
 			if ((!m_State.IsSynchronized) || (m_State.bDisableSynchronize)) {
 
 				m_pLightSet->SetData(i, m_OutputPort[i].data, m_OutputPort[i].length);
+				metric_inc(&s_MetricDmxUpdates);
 
 				if (!m_OutputPort[i].IsTransmitting) {
 					m_pLightSet->Start(i);
@@ -701,9 +798,11 @@ void E131Bridge::SetNetworkDataLossCondition(bool bSourceA, bool bSourceB) {
 		m_State.IsMergeMode = false;
 		m_State.IsSynchronized = false;
 		m_State.IsForcedSynchronized = false;
-		m_State.nPriority = E131_PRIORITY_LOWEST;
 
 		for (uint32_t i = 0; i < E131_MAX_PORTS; i++) {
+			m_OutputPort[i].nPriority = E131_PRIORITY_LOWEST;
+			m_OutputPort[i].bIsSlotPriority = false;
+
 			if (m_OutputPort[i].IsTransmitting) {
 				m_pLightSet->Stop(i);
 				m_OutputPort[i].sourceA.ip = 0;
@@ -733,6 +832,11 @@ void E131Bridge::SetNetworkDataLossCondition(bool bSourceA, bool bSourceB) {
 					m_OutputPort[i].IsMerging = false;
 				}
 
+				if ((m_OutputPort[i].sourceA.ip == 0) && (m_OutputPort[i].sourceB.ip == 0)) {
+					m_OutputPort[i].nPriority = E131_PRIORITY_LOWEST;
+					m_OutputPort[i].bIsSlotPriority = false;
+				}
+
 				if (!m_State.IsMergeMode) {
 					m_pLightSet->Stop(i);
 					m_OutputPort[i].length = 0;
@@ -877,9 +981,12 @@ void E131Bridge::Run(void) {
 	}
 
 	if (__builtin_expect((!IsValidRoot()), 0)) {
+		metric_inc(&s_MetricInvalid);
 		return;
 	}
 
+	metric_inc(&s_MetricPackets);
+
 	m_State.IsNetworkDataLoss = false;
 	m_nPreviousPacketMillis = m_nCurrentPacketMillis;
 
@@ -894,10 +1001,13 @@ void E131Bridge::Run(void) {
 	if (nRootVector == E131_VECTOR_ROOT_DATA) {
 		if (IsValidDataPacket()) {
 			HandleDmx();
+		} else {
+			metric_inc(&s_MetricInvalid);
 		}
 	} else if (nRootVector == E131_VECTOR_ROOT_EXTENDED) {
 		const uint32_t nFramingVector = __builtin_bswap32(m_E131.E131Packet.Raw.FrameLayer.Vector);
 			if (nFramingVector == E131_VECTOR_EXTENDED_SYNCHRONIZATION) {
+			metric_inc(&s_MetricSync);
 			HandleSynchronization();
 		}
 	} else {
@@ -67,19 +67,23 @@ void E131Bridge::HandleDmxIn(void) {
 			const uint8_t *pDmxData = m_pE131DmxIn->Handler(i, nLength, nUpdatesPerSecond);
 
 			if (pDmxData != 0) {
+				// The packet is built directly in the network send buffer
+				struct TE131DataPacket *pE131DataPacket = reinterpret_cast<struct TE131DataPacket*>(Network::Get()->GetSendBuffer());
+
+				memcpy(pE131DataPacket, m_pE131DataPacket, DATA_PACKET_SIZE(0));
 				// Root Layer (See Section 5)
-				m_pE131DataPacket->RootLayer.FlagsLength = __builtin_bswap16((0x07 << 12) | (DATA_ROOT_LAYER_LENGTH(nLength)));
+				pE131DataPacket->RootLayer.FlagsLength = __builtin_bswap16((0x07 << 12) | (DATA_ROOT_LAYER_LENGTH(nLength)));
 				// E1.31 Framing Layer (See Section 6)
-				m_pE131DataPacket->FrameLayer.FLagsLength = __builtin_bswap16((0x07 << 12) | (DATA_FRAME_LAYER_LENGTH(nLength)));
-				m_pE131DataPacket->FrameLayer.Priority = m_InputPort[i].nPriority;
-				m_pE131DataPacket->FrameLayer.SequenceNumber = m_InputPort[i].nSequenceNumber++;
-				m_pE131DataPacket->FrameLayer.Universe = __builtin_bswap16(m_InputPort[i].nUniverse);
+				pE131DataPacket->FrameLayer.FLagsLength = __builtin_bswap16((0x07 << 12) | (DATA_FRAME_LAYER_LENGTH(nLength)));
+				pE131DataPacket->FrameLayer.Priority = m_InputPort[i].nPriority;
+				pE131DataPacket->FrameLayer.SequenceNumber = m_InputPort[i].nSequenceNumber++;
+				pE131DataPacket->FrameLayer.Universe = __builtin_bswap16(m_InputPort[i].nUniverse);
 				// Data Layer
-				m_pE131DataPacket->DMPLayer.FlagsLength = __builtin_bswap16((0x07 << 12) | (DATA_LAYER_LENGTH(nLength)));
-				memcpy(m_pE131DataPacket->DMPLayer.PropertyValues, pDmxData, nLength);
-				m_pE131DataPacket->DMPLayer.PropertyValueCount = __builtin_bswap16(nLength);
+				pE131DataPacket->DMPLayer.FlagsLength = __builtin_bswap16((0x07 << 12) | (DATA_LAYER_LENGTH(nLength)));
+				memcpy(pE131DataPacket->DMPLayer.PropertyValues, pDmxData, nLength);
+				pE131DataPacket->DMPLayer.PropertyValueCount = __builtin_bswap16(nLength);
 
-				Network::Get()->SendTo(m_nHandle, m_pE131DataPacket, DATA_PACKET_SIZE(nLength), m_InputPort[i].nMulticastIp, E131_DEFAULT_PORT);
+				Network::Get()->SendBuffer(m_nHandle, DATA_PACKET_SIZE(nLength), m_InputPort[i].nMulticastIp, E131_DEFAULT_PORT);
 
 				m_State.bIsReceivingDmx = true;
 			} else {
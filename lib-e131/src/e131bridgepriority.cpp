@@ -0,0 +1,167 @@
+/**
+ * @file e131bridgepriority.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#if defined (__ARM_NEON) || defined (__ARM_NEON__)
+# include <arm_neon.h>
+#endif
+
+#include "e131bridge.h"
+
+#include "profiler.h"
+
+#include "debug.h"
+
+/*
+ * Per-address priority (0xDD)
+ *
+ * Each slot is arbitrated on its own: the source with the higher slot priority wins, a priority of 0
+ * means the source does not drive that slot. A source that does not send 0xDD packets uses its
+ * universe priority for all slots. Equal priorities are merged with the port merge mode.
+ * Only the received slots are merged, as with the HTP/LTP merge.
+ */
+
+#if defined (__ARM_NEON) || defined (__ARM_NEON__)
+static bool merge_slots(uint8_t *pOut, const uint8_t *pDataA, const uint8_t *pDataB, const uint8_t *pPriorityA, const uint8_t *pPriorityB, uint8_t nPriorityA, uint8_t nPriorityB, bool bHtp, bool bIsLatestA, uint32_t nLength) {
+	const uint8x16_t vZero = vdupq_n_u8(0);
+	const uint8x16_t vUniformA = vdupq_n_u8(nPriorityA);
+	const uint8x16_t vUniformB = vdupq_n_u8(nPriorityB);
+	uint8x16_t vChanged = vZero;
+
+	// Rounded up to a whole vector, the buffers are E131_DMX_LENGTH (a multiple of 16)
+	for (uint32_t i = 0; i < nLength; i += 16) {
+		const uint8x16_t vDataA = vld1q_u8(&pDataA[i]);
+		const uint8x16_t vDataB = vld1q_u8(&pDataB[i]);
+		const uint8x16_t vPriorityA = (pPriorityA == 0) ? vUniformA : vld1q_u8(&pPriorityA[i]);
+		const uint8x16_t vPriorityB = (pPriorityB == 0) ? vUniformB : vld1q_u8(&pPriorityB[i]);
+
+		const uint8x16_t vIsA = vcgtq_u8(vPriorityA, vPriorityB);
+		const uint8x16_t vIsB = vcgtq_u8(vPriorityB, vPriorityA);
+		const uint8x16_t vIsNone = vceqq_u8(vorrq_u8(vPriorityA, vPriorityB), vZero);
+
+		uint8x16_t vEqual = bHtp ? vmaxq_u8(vDataA, vDataB) : (bIsLatestA ? vDataA : vDataB);
+		vEqual = vbicq_u8(vEqual, vIsNone);
+
+		const uint8x16_t vOut = vbslq_u8(vIsA, vDataA, vbslq_u8(vIsB, vDataB, vEqual));
+
+		vChanged = vorrq_u8(vChanged, veorq_u8(vOut, vld1q_u8(&pOut[i])));
+		vst1q_u8(&pOut[i], vOut);
+	}
+
+	const uint64x2_t v64 = vreinterpretq_u64_u8(vChanged);
+
+	return (vgetq_lane_u64(v64, 0) | vgetq_lane_u64(v64, 1)) != 0;
+}
+#else
+static bool merge_slots(uint8_t *pOut, const uint8_t *pDataA, const uint8_t *pDataB, const uint8_t *pPriorityA, const uint8_t *pPriorityB, uint8_t nPriorityA, uint8_t nPriorityB, bool bHtp, bool bIsLatestA, uint32_t nLength) {
+	uint8_t nChanged = 0;
+
+	for (uint32_t i = 0; i < nLength; i++) {
+		const uint8_t nA = (pPriorityA == 0) ? nPriorityA : pPriorityA[i];
+		const uint8_t nB = (pPriorityB == 0) ? nPriorityB : pPriorityB[i];
+		uint8_t nOut;
+
+		if (nA > nB) {
+			nOut = pDataA[i];
+		} else if (nB > nA) {
+			nOut = pDataB[i];
+		} else if (nA == 0) {
+			nOut = 0;
+		} else if (bHtp) {
+			nOut = (pDataA[i] > pDataB[i]) ? pDataA[i] : pDataB[i];
+		} else {
+			nOut = bIsLatestA ? pDataA[i] : pDataB[i];
+		}
+
+		nChanged |= (nOut ^ pOut[i]);
+		pOut[i] = nOut;
+	}
+
+	return nChanged != 0;
+}
+#endif
+
+bool E131Bridge::IsSlotPriority(uint8_t nPortIndex) {
+	assert(nPortIndex < E131_MAX_PORTS);
+
+	const struct TSource *pSources[2] = { &m_OutputPort[nPortIndex].sourceA, &m_OutputPort[nPortIndex].sourceB };
+
+	for (uint32_t i = 0; i < 2; i++) {
+		const struct TSource *pSource = pSources[i];
+
+		if ((pSource->ip != 0) && (pSource->slotPriorityTime != 0)) {
+			if ((m_nCurrentPacketMillis - pSource->slotPriorityTime) < (E131_NETWORK_DATA_LOSS_TIMEOUT_SECONDS * 1000)) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void E131Bridge::HandleSlotPriority(struct TSource *pSource, const uint8_t *pPriority, uint16_t nLength) {
+	assert(pSource != 0);
+	assert(pPriority != 0);
+
+	if (nLength > E131_DMX_LENGTH) {
+		nLength = E131_DMX_LENGTH;
+	}
+
+	memcpy(pSource->slotPriority, pPriority, nLength);
+	memset(&pSource->slotPriority[nLength], 0, E131_DMX_LENGTH - nLength);
+
+	pSource->slotPriorityTime = m_nCurrentPacketMillis;
+}
+
+bool E131Bridge::IsSlotPriorityDmxDataChanged(uint8_t nPortIndex, uint16_t nLength) {
+	PROFILE_SCOPE("e131.slotmerge");
+
+	assert(nPortIndex < E131_MAX_PORTS);
+
+	struct TE131OutputPort *pPort = &m_OutputPort[nPortIndex];
+	const struct TSource *pSourceA = &pPort->sourceA;
+	const struct TSource *pSourceB = &pPort->sourceB;
+
+	const bool bIsSlotPriorityA = (pSourceA->slotPriorityTime != 0) && ((m_nCurrentPacketMillis - pSourceA->slotPriorityTime) < (E131_NETWORK_DATA_LOSS_TIMEOUT_SECONDS * 1000));
+	const bool bIsSlotPriorityB = (pSourceB->slotPriorityTime != 0) && ((m_nCurrentPacketMillis - pSourceB->slotPriorityTime) < (E131_NETWORK_DATA_LOSS_TIMEOUT_SECONDS * 1000));
+
+	// An inactive source has priority 0 for all slots
+	const uint8_t nPriorityA = (pSourceA->ip == 0) ? 0 : pSourceA->priority;
+	const uint8_t nPriorityB = (pSourceB->ip == 0) ? 0 : pSourceB->priority;
+	const uint8_t *pPriorityA = ((pSourceA->ip != 0) && bIsSlotPriorityA) ? pSourceA->slotPriority : 0;
+	const uint8_t *pPriorityB = ((pSourceB->ip != 0) && bIsSlotPriorityB) ? pSourceB->slotPriority : 0;
+
+	const bool isChanged = merge_slots(pPort->data, pSourceA->data, pSourceB->data, pPriorityA, pPriorityB, nPriorityA, nPriorityB, pPort->mergeMode == E131_MERGE_HTP, isIpCidMatch(pSourceA), nLength);
+
+	if (nLength != pPort->length) {
+		pPort->length = nLength;
+		return true;
+	}
+
+	return isChanged;
+}
@@ -221,19 +221,24 @@ void E131Controller::HandleDmxOut(uint16_t nUniverse, const uint8_t *pDmxData, u
 	// Data Layer
 	m_pE131DataPacket->DMPLayer.FlagsLength = __builtin_bswap16((0x07 << 12) | (DATA_LAYER_LENGTH(1 + nLength)));
 
+	m_pE131DataPacket->DMPLayer.PropertyValueCount = __builtin_bswap16(1 + nLength);
+
+	// The packet is built directly in the network send buffer: header and start code, then the data
+	struct TE131DataPacket *pE131DataPacket = reinterpret_cast<struct TE131DataPacket*>(Network::Get()->GetSendBuffer());
+
+	memcpy(pE131DataPacket, m_pE131DataPacket, DATA_PACKET_SIZE(1));
+
 	if (__builtin_expect((m_nMaster == DMX_MAX_VALUE), 1)) {
-		memcpy(&m_pE131DataPacket->DMPLayer.PropertyValues[1], pDmxData, nLength);
+		memcpy(&pE131DataPacket->DMPLayer.PropertyValues[1], pDmxData, nLength);
 	} else if (m_nMaster == 0) {
-		memset(&m_pE131DataPacket->DMPLayer.PropertyValues[1], 0, nLength);
+		memset(&pE131DataPacket->DMPLayer.PropertyValues[1], 0, nLength);
 	} else {
 		for (uint32_t i = 0; i < nLength; i++) {
-			m_pE131DataPacket->DMPLayer.PropertyValues[1 + i] = (m_nMaster * static_cast<uint32_t>(pDmxData[i])) / DMX_MAX_VALUE;
+			pE131DataPacket->DMPLayer.PropertyValues[1 + i] = (m_nMaster * static_cast<uint32_t>(pDmxData[i])) / DMX_MAX_VALUE;
 		}
 	}
 
-	m_pE131DataPacket->DMPLayer.PropertyValueCount = __builtin_bswap16(1 + nLength);
-
-	Network::Get()->SendTo(m_nHandle, m_pE131DataPacket, DATA_PACKET_SIZE(1 + nLength), nIp, E131_DEFAULT_PORT);
+	Network::Get()->SendBuffer(m_nHandle, DATA_PACKET_SIZE(1 + nLength), nIp, E131_DEFAULT_PORT);
 }
 
 void E131Controller::HandleSync(void) {
@@ -253,7 +258,6 @@ void E131Controller::HandleBlackout(void) {
 	// Data Layer
 	m_pE131DataPacket->DMPLayer.FlagsLength = __builtin_bswap16((0x07 << 12) | (DATA_LAYER_LENGTH(513)));
 	m_pE131DataPacket->DMPLayer.PropertyValueCount = __builtin_bswap16(513);
-	memset(&m_pE131DataPacket->DMPLayer.PropertyValues[1], 0, 512);
 
 	for (uint32_t nIndex = 0; nIndex < m_State.nActiveUniverses; nIndex++) {
 		uint32_t nIp;
@@ -262,7 +266,12 @@ void E131Controller::HandleBlackout(void) {
 		m_pE131DataPacket->FrameLayer.SequenceNumber = GetSequenceNumber(nUniverse, nIp);
 		m_pE131DataPacket->FrameLayer.Universe = __builtin_bswap16(nUniverse);
 
-		Network::Get()->SendTo(m_nHandle, m_pE131DataPacket, DATA_PACKET_SIZE(513), nIp, E131_DEFAULT_PORT);
+		struct TE131DataPacket *pE131DataPacket = reinterpret_cast<struct TE131DataPacket*>(Network::Get()->GetSendBuffer());
+
+		memcpy(pE131DataPacket, m_pE131DataPacket, DATA_PACKET_SIZE(1));
+		memset(&pE131DataPacket->DMPLayer.PropertyValues[1], 0, 512);
+
+		Network::Get()->SendBuffer(m_nHandle, DATA_PACKET_SIZE(513), nIp, E131_DEFAULT_PORT);
 	}
 
 	if (m_State.SynchronizationPacket.nUniverseNumber != 0) {
@@ -290,8 +299,29 @@ void E131Controller::SetSourceName(const char *pSourceName) {
 	m_SourceName[E131_SOURCE_NAME_LENGTH - 1] = '\0';
 }
 
-void E131Controller::SetPriority(uint8_t nPriority) { //TODO SetPriority
+void E131Controller::SetPriority(uint8_t nPriority) {
 	m_State.nPriority = nPriority;
+
+	if (m_pE131DataPacket != 0) {
+		m_pE131DataPacket->FrameLayer.Priority = nPriority;
+	}
+}
+
+/*
+ * Can be changed while running, the data and synchronization packet templates are updated.
+ * A zero address disables synchronization.
+ */
+void E131Controller::SetSynchronizationAddress(uint16_t nSynchronizationAddress) {
+	m_State.SynchronizationPacket.nUniverseNumber = nSynchronizationAddress;
+	m_State.SynchronizationPacket.nIpAddress = UniverseToMulticastIp(nSynchronizationAddress);
+
+	if (m_pE131DataPacket != 0) {
+		m_pE131DataPacket->FrameLayer.SynchronizationAddress = __builtin_bswap16(nSynchronizationAddress);
+	}
+
+	if (m_pE131SynchronizationPacket != 0) {
+		m_pE131SynchronizationPacket->FrameLayer.UniverseNumber = __builtin_bswap16(nSynchronizationAddress);
+	}
 }
 
 void E131Controller::SendDiscoveryPacket(void) {
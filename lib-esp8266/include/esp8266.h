@@ -2,7 +2,7 @@
  * @file esp8266.h
  *
  */
-/* Copyright (C) 2016-2017 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2016-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -50,6 +50,9 @@ extern uint16_t esp8266_read_halfword(void);
 extern uint32_t esp8266_read_word(void);
 extern void esp8266_read_str(/*@out@*/char *, uint16_t *);
 
+extern bool esp8266_read_burst(/*@out@*/uint8_t *, uint16_t);
+extern bool esp8266_write_burst(const uint8_t *, uint16_t);
+
 #ifdef __cplusplus
 }
 #endif
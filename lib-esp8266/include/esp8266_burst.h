@@ -0,0 +1,215 @@
+/**
+ * @file esp8266_burst.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ESP8266_BURST_H_
+#define ESP8266_BURST_H_
+
+/*
+ * Burst frames on the nibble bus, shared by the host (lib-esp8266) and the
+ * ESP8266 firmware (esp8266_rtos_sdk_rpi).
+ *
+ * A frame follows a command and is sent as one block:
+ *
+ *   length (2, LE) | payload (length) | CRC-16 (2, LE)
+ *
+ * The CRC is CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over length and
+ * payload. Inside a block each nibble takes a single control edge instead of
+ * a full handshake: the requester raises its control line for the low nibble
+ * and lowers it for the high nibble, the other side answers with the same level.
+ * The bus has no clock line, so the receiver cannot sample a nibble before it
+ * has seen an edge; one handshake for the whole block is not possible.
+ *
+ * Every wait for an edge is bounded by ESP8266_BURST_TIMEOUT_US. On a timeout
+ * the transfer function returns false, lowers its control line and waits for the
+ * other side to do the same. Both sides are then back at the command level.
+ *
+ * The receiver always clocks the complete frame, also when the payload does not
+ * fit or the CRC is wrong, so that both sides stay in lock-step. Only a corrupted
+ * length field cannot be recovered within the frame.
+ *
+ * Burst mode is negotiated, both sides start with the per-field transfers:
+ * - the firmware has ESP8266_BURST_SIGNATURE in its version string;
+ * - the host then sends CMD_UDP_BEGIN with port ESP8266_BURST_REQUEST_PORT;
+ * - the firmware answers with the byte ESP8266_BURST_ACK and switches.
+ * The firmware returns to the per-field transfers when the version is read,
+ * which every host does at start-up.
+ *
+ * The transfer functions are passed in, the framing itself has no hardware
+ * dependency.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ESP8266_BURST_SIGNATURE			"[burst/1]"	///< Appended to the firmware version string
+#define ESP8266_BURST_REQUEST_PORT		0			///< CMD_UDP_BEGIN with this port requests burst mode
+#define ESP8266_BURST_ACK				0xB1		///< Reply of the firmware to the request
+
+#define ESP8266_BURST_TIMEOUT_US		10000		///< Maximum wait for a control edge
+
+#define ESP8266_BURST_LENGTH_SIZE		2
+#define ESP8266_BURST_CRC_SIZE			2
+#define ESP8266_BURST_CRC_INIT			0xFFFF
+
+#define ESP8266_BURST_UDP_HEADER_SIZE	6			///< ip (4) + port (2)
+
+typedef enum esp8266_burst_error {
+	ESP8266_BURST_ERROR_LENGTH = -1,	///< The payload is shorter than the fixed header
+	ESP8266_BURST_ERROR_CRC = -2,
+	ESP8266_BURST_ERROR_TIMEOUT = -3	///< The other side stopped within the frame
+} _esp8266_burst_error;
+
+/*
+ * The transfer functions return false on a timeout
+ */
+typedef bool (*esp8266_burst_read_t)(uint8_t *, uint16_t);
+typedef bool (*esp8266_burst_write_t)(const uint8_t *, uint16_t);
+
+static const uint16_t esp8266_burst_crc_table[16] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+inline static uint16_t esp8266_burst_crc16(uint16_t crc, const uint8_t *data, uint16_t length) {
+	uint16_t i;
+
+	for (i = 0; i < length; i++) {
+		crc = (uint16_t) ((crc << 4) ^ esp8266_burst_crc_table[(crc >> 12) ^ (data[i] >> 4)]);
+		crc = (uint16_t) ((crc << 4) ^ esp8266_burst_crc_table[(crc >> 12) ^ (data[i] & 0x0F)]);
+	}
+
+	return crc;
+}
+
+/**
+ * Send a frame with the payload header | data.
+ *
+ * @return false on a timeout, the rest of the frame is not sent
+ */
+inline static bool esp8266_burst_send(esp8266_burst_write_t write, const uint8_t *header, uint16_t header_length, const uint8_t *data, uint16_t length) {
+	const uint16_t frame_length = (uint16_t) (header_length + length);
+	uint8_t field[2];
+	uint16_t crc;
+
+	field[0] = (uint8_t) (frame_length & 0xFF);
+	field[1] = (uint8_t) (frame_length >> 8);
+
+	crc = esp8266_burst_crc16(ESP8266_BURST_CRC_INIT, field, ESP8266_BURST_LENGTH_SIZE);
+
+	if (!write(field, ESP8266_BURST_LENGTH_SIZE)) {
+		return false;
+	}
+
+	if (header_length != 0) {
+		crc = esp8266_burst_crc16(crc, header, header_length);
+
+		if (!write(header, header_length)) {
+			return false;
+		}
+	}
+
+	if (length != 0) {
+		crc = esp8266_burst_crc16(crc, data, length);
+
+		if (!write(data, length)) {
+			return false;
+		}
+	}
+
+	field[0] = (uint8_t) (crc & 0xFF);
+	field[1] = (uint8_t) (crc >> 8);
+
+	return write(field, ESP8266_BURST_CRC_SIZE);
+}
+
+/**
+ * Receive a frame with the payload header | data. An empty frame is valid and has no header.
+ * Data beyond size is clocked and checked, but not stored.
+ *
+ * @return the data length (without header), or a negative _esp8266_burst_error
+ */
+inline static int32_t esp8266_burst_receive(esp8266_burst_read_t read, uint8_t *header, uint16_t header_length, uint8_t *data, uint16_t size) {
+	uint8_t field[2];
+	uint8_t discard[16];
+	uint16_t frame_length;
+	uint16_t data_length;
+	uint16_t remaining;
+	uint16_t crc;
+	uint16_t n;
+
+	if (!read(field, ESP8266_BURST_LENGTH_SIZE)) {
+		return ESP8266_BURST_ERROR_TIMEOUT;
+	}
+
+	frame_length = (uint16_t) (field[0] | (field[1] << 8));
+	crc = esp8266_burst_crc16(ESP8266_BURST_CRC_INIT, field, ESP8266_BURST_LENGTH_SIZE);
+
+	remaining = frame_length;
+
+	if (frame_length >= header_length) {
+		if (!read(header, header_length)) {
+			return ESP8266_BURST_ERROR_TIMEOUT;
+		}
+
+		crc = esp8266_burst_crc16(crc, header, header_length);
+		remaining = (uint16_t) (remaining - header_length);
+	}
+
+	data_length = remaining;
+
+	n = (remaining < size) ? remaining : size;
+	if (!read(data, n)) {
+		return ESP8266_BURST_ERROR_TIMEOUT;
+	}
+
+	crc = esp8266_burst_crc16(crc, data, n);
+	remaining = (uint16_t) (remaining - n);
+
+	while (remaining != 0) {
+		n = (remaining < sizeof(discard)) ? remaining : (uint16_t) sizeof(discard);
+		if (!read(discard, n)) {
+			return ESP8266_BURST_ERROR_TIMEOUT;
+		}
+
+		crc = esp8266_burst_crc16(crc, discard, n);
+		remaining = (uint16_t) (remaining - n);
+	}
+
+	if (!read(field, ESP8266_BURST_CRC_SIZE)) {
+		return ESP8266_BURST_ERROR_TIMEOUT;
+	}
+
+	if (crc != (uint16_t) (field[0] | (field[1] << 8))) {
+		return ESP8266_BURST_ERROR_CRC;
+	}
+
+	if ((frame_length != 0) && (frame_length < header_length)) {
+		return ESP8266_BURST_ERROR_LENGTH;
+	}
+
+	return (int32_t) data_length;
+}
+
+#endif /* ESP8266_BURST_H_ */
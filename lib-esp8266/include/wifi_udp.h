@@ -2,7 +2,7 @@
  * @file wifi_udp.h
  *
  */
-/* Copyright (C) 2016-2017 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2016-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -27,6 +27,7 @@
 #define WIFI_UDP_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -37,6 +38,9 @@ extern void wifi_udp_joingroup(uint32_t);
 extern uint16_t wifi_udp_recvfrom(const uint8_t *, uint16_t, uint32_t *, uint16_t *);
 extern void wifi_udp_sendto(const uint8_t *, uint16_t, uint32_t, uint16_t);
 
+extern bool wifi_udp_negotiate_burst(const char *);
+extern bool wifi_udp_is_burst(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -3,7 +3,7 @@
  * @file esp8266.c
  *
  */
-/* Copyright (C) 2018 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2018-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -34,6 +34,8 @@
 #include "h3_hs_timer.h"
 #include "h3_board.h"
 
+#include "esp8266_burst.h"
+
 /*
  *      Orange Pi Zero		ESP8266
  *
@@ -441,6 +443,125 @@ void esp8266_read_str(char *s, uint16_t *len) {
 	dmb();
 }
 
+inline static void _put_nibble(const uint8_t data) {
+#if defined(ORANGE_PI)
+	uint32_t out_gpio = H3_PIO_PORTA->DAT & ~( (1 << D0) | (1 << D1) | (1 << D2) | (1 << D3) );
+	out_gpio |= (data & 1) ? (1 << D0) : 0;
+	out_gpio |= (data & 2) ? (1 << D1) : 0;
+	out_gpio |= (data & 4) ? (1 << D2) : 0;
+	out_gpio |= (data & 8) ? (1 << D3) : 0;
+	H3_PIO_PORTA->DAT = out_gpio;
+#elif defined(NANO_PI)
+	uint32_t out_gpio = H3_PIO_PORTA->DAT & ~( (1 << D0) | (1 << D3) );
+	out_gpio |= (data & 1) ? (1 << D0) : 0;
+	out_gpio |= (data & 8) ? (1 << D3) : 0;
+	H3_PIO_PORTA->DAT = out_gpio;
+	out_gpio = H3_PIO_PORTG->DAT & ~( (1 << D1) | (1 << D2) );
+	out_gpio |= (data & 2) ? (1 << D1) : 0;
+	out_gpio |= (data & 4) ? (1 << D2) : 0;
+	H3_PIO_PORTG->DAT = out_gpio;
+#endif
+}
+
+inline static uint8_t _get_nibble(void) {
+#if defined(ORANGE_PI)
+	const uint32_t in_gpio = H3_PIO_PORTA->DAT;
+	uint8_t data = in_gpio & (1 << D0) ? 1 : 0;
+	data |= in_gpio & (1 << D1) ? 2 : 0;
+	data |= in_gpio & (1 << D2) ? 4 : 0;
+	data |= in_gpio & (1 << D3) ? 8 : 0;
+#elif defined(NANO_PI)
+	uint32_t in_gpio = H3_PIO_PORTA->DAT;
+	uint8_t data = in_gpio & (1 << D0) ? 1 : 0;
+	data |= in_gpio & (1 << D3) ? 8 : 0;
+	in_gpio = H3_PIO_PORTG->DAT;
+	data |= in_gpio & (1 << D1) ? 2 : 0;
+	data |= in_gpio & (1 << D2) ? 4 : 0;
+#endif
+	return data;
+}
+
+/*
+ * Burst transfers, see esp8266_burst.h
+ * One control edge per nibble: high for the low nibble, low for the high nibble.
+ */
+
+static bool _wait_cin(const bool is_high, const uint32_t timeout_us) {
+	const uint32_t micros_now = h3_hs_timer_lo_us();
+
+	while (((PORT_CIN->DAT & (1 << CIN)) != 0) != is_high) {
+		if (h3_hs_timer_lo_us() - micros_now > timeout_us) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Back to the command level: our control line low, wait for the ESP8266 to time out as well
+ */
+static void _resync(void) {
+	h3_gpio_clr(GPIO_EXT_11);
+
+	(void) _wait_cin(false, 2 * ESP8266_BURST_TIMEOUT_US);
+
+	dmb();
+}
+
+bool esp8266_read_burst(uint8_t *data, uint16_t len) {
+	uint16_t i;
+	uint8_t d;
+
+	data_gpio_fsel_input();
+
+	for (i = 0; i < len; i++) {
+		h3_gpio_set(GPIO_EXT_11);
+		if (!_wait_cin(true, ESP8266_BURST_TIMEOUT_US)) {
+			_resync();
+			return false;
+		}
+		d = _get_nibble();
+
+		h3_gpio_clr(GPIO_EXT_11);
+		if (!_wait_cin(false, ESP8266_BURST_TIMEOUT_US)) {
+			_resync();
+			return false;
+		}
+		d |= (uint8_t) (_get_nibble() << 4);
+
+		data[i] = d;
+	}
+
+	dmb();
+	return true;
+}
+
+bool esp8266_write_burst(const uint8_t *data, uint16_t len) {
+	uint16_t i;
+
+	data_gpio_fsel_output();
+
+	for (i = 0; i < len; i++) {
+		_put_nibble(data[i] & 0x0F);
+		h3_gpio_set(GPIO_EXT_11);
+		if (!_wait_cin(true, ESP8266_BURST_TIMEOUT_US)) {
+			_resync();
+			return false;
+		}
+
+		_put_nibble(data[i] >> 4);
+		h3_gpio_clr(GPIO_EXT_11);
+		if (!_wait_cin(false, ESP8266_BURST_TIMEOUT_US)) {
+			_resync();
+			return false;
+		}
+	}
+
+	dmb();
+	return true;
+}
+
 const bool esp8266_detect(void) {
 	esp8266_init();
 
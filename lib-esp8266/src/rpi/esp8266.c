@@ -2,7 +2,7 @@
  * @file esp8266.c
  *
  */
-/* Copyright (C) 2016-2017 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2016-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -31,6 +31,8 @@
 #include "bcm2835.h"
 #include "bcm2835_gpio.h"
 
+#include "esp8266_burst.h"
+
 /*
  *      RP					ESP8266		Logic Analyzer
  *
@@ -370,6 +372,102 @@ void esp8266_read_str(char *s, uint16_t *len) {
 	dmb();
 }
 
+/*
+ * Burst transfers, see esp8266_burst.h
+ * One control edge per nibble: high for the low nibble, low for the high nibble.
+ */
+
+static bool _wait_ctrl_in(const bool is_high, const uint32_t timeout_us) {
+	const uint32_t micros_now = BCM2835_ST->CLO;
+
+	while (((BCM2835_GPIO->GPLEV0 & (1 << 27)) != 0) != is_high) {
+		if (BCM2835_ST->CLO - micros_now > timeout_us) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Back to the command level: our control line low, wait for the ESP8266 to time out as well
+ */
+static void _resync(void) {
+	bcm2835_gpio_clr(17);
+	(void) _wait_ctrl_in(false, 2 * ESP8266_BURST_TIMEOUT_US);
+	dmb();
+}
+
+/**
+ *
+ * @param data
+ * @param len
+ * @return false on a timeout
+ */
+bool esp8266_read_burst(uint8_t *data, uint16_t len) {
+	uint16_t i;
+	uint8_t d;
+
+	data_gpio_fsel_input();
+
+	for (i = 0; i < len; i++) {
+		bcm2835_gpio_set(17);
+		if (!_wait_ctrl_in(true, ESP8266_BURST_TIMEOUT_US)) {
+			_resync();
+			return false;
+		}
+		d = (uint8_t) ((BCM2835_GPIO->GPLEV0 >> 22) & 0x0F);
+
+		bcm2835_gpio_clr(17);
+		if (!_wait_ctrl_in(false, ESP8266_BURST_TIMEOUT_US)) {
+			_resync();
+			return false;
+		}
+		d |= (uint8_t) (((BCM2835_GPIO->GPLEV0 >> 22) & 0x0F) << 4);
+
+		data[i] = d;
+	}
+
+	dmb();
+	return true;
+}
+
+/**
+ *
+ * @param data
+ * @param len
+ * @return false on a timeout
+ */
+bool esp8266_write_burst(const uint8_t *data, uint16_t len) {
+	uint32_t out_gpio;
+	uint16_t i;
+
+	data_gpio_fsel_output();
+
+	for (i = 0; i < len; i++) {
+		out_gpio = (uint32_t) (data[i] & 0x0F) << 22;
+		BCM2835_GPIO->GPSET0 = out_gpio;
+		BCM2835_GPIO->GPCLR0 = out_gpio ^ (0x0F << 22);
+		bcm2835_gpio_set(17);
+		if (!_wait_ctrl_in(true, ESP8266_BURST_TIMEOUT_US)) {
+			_resync();
+			return false;
+		}
+
+		out_gpio = (uint32_t) (data[i] >> 4) << 22;
+		BCM2835_GPIO->GPSET0 = out_gpio;
+		BCM2835_GPIO->GPCLR0 = out_gpio ^ (0x0F << 22);
+		bcm2835_gpio_clr(17);
+		if (!_wait_ctrl_in(false, ESP8266_BURST_TIMEOUT_US)) {
+			_resync();
+			return false;
+		}
+	}
+
+	dmb();
+	return true;
+}
+
 /**
  *
  * @return
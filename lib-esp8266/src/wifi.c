@@ -2,7 +2,7 @@
  * @file wifi.c
  *
  */
-/* Copyright (C) 2017-2018 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2017-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -28,6 +28,7 @@
 #include <string.h>
 
 #include "wifi.h"
+#include "wifi_udp.h"
 
 #include "console.h"
 
@@ -75,7 +76,13 @@ const bool wifi(const struct ip_info *info) {
 
 	printf("ESP8266 information\n");
 	printf(" SDK      : %s\n", system_get_sdk_version());
-	printf(" Firmware : %s\n", wifi_get_firmware_version());
+	const char *firmware_version = wifi_get_firmware_version();
+
+	printf(" Firmware : %s\n", firmware_version);
+
+	if (wifi_udp_negotiate_burst(firmware_version)) {
+		printf(" Burst mode\n");
+	}
 
 	if (network_params_init()) {
 		(void) console_status(CONSOLE_YELLOW, CHANGING_TO_STATION_MODE);
@@ -2,7 +2,7 @@
  * @file wifi_udp.c
  *
  */
-/* Copyright (C) 2016-2017 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2016-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -26,14 +26,89 @@
 #include <assert.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "wifi_udp.h"
 
 #include "esp8266.h"
+#include "esp8266_burst.h"
 #include "esp8266_cmd.h"
 
+#include "metrics.h"
+
 #ifndef MIN
  #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #endif
 
+/*
+ * When burst mode is negotiated, the UDP receive and send commands are followed
+ * by a burst frame instead of the separate fields.
+ */
+
+static bool s_is_burst = false;
+
+static struct metric s_metric_frame_crc_errors = METRIC_COUNTER("esp8266.frame.crc_errors");
+static struct metric s_metric_frame_length_errors = METRIC_COUNTER("esp8266.frame.length_errors");
+static struct metric s_metric_frame_timeouts = METRIC_COUNTER("esp8266.frame.timeouts");
+
+/**
+ * Request burst mode when the firmware offers it, see esp8266_burst.h
+ * Must be called after the firmware version has been read.
+ */
+bool wifi_udp_negotiate_burst(const char *firmware_version) {
+	assert(firmware_version != NULL);
+
+	s_is_burst = false;
+
+	if (strstr(firmware_version, ESP8266_BURST_SIGNATURE) == NULL) {
+		return false;
+	}
+
+	esp8266_write_4bits((uint8_t) CMD_WIFI_UDP_BEGIN);
+	esp8266_write_halfword(ESP8266_BURST_REQUEST_PORT);
+
+	if (esp8266_read_byte() != ESP8266_BURST_ACK) {
+		return false;
+	}
+
+	metrics_register(&s_metric_frame_crc_errors);
+	metrics_register(&s_metric_frame_length_errors);
+	metrics_register(&s_metric_frame_timeouts);
+
+	s_is_burst = true;
+	return true;
+}
+
+bool wifi_udp_is_burst(void) {
+	return s_is_burst;
+}
+
+static uint16_t recvfrom_burst(uint8_t *buffer, uint16_t length, uint32_t *ip_address, uint16_t *port) {
+	uint8_t header[ESP8266_BURST_UDP_HEADER_SIZE];
+
+	const int32_t bytes_received = esp8266_burst_receive(esp8266_read_burst, header, ESP8266_BURST_UDP_HEADER_SIZE, buffer, length);
+
+	if (bytes_received <= 0) {
+		if (bytes_received == ESP8266_BURST_ERROR_CRC) {
+			metric_inc(&s_metric_frame_crc_errors);
+		} else if (bytes_received == ESP8266_BURST_ERROR_LENGTH) {
+			metric_inc(&s_metric_frame_length_errors);
+		} else if (bytes_received == ESP8266_BURST_ERROR_TIMEOUT) {
+			metric_inc(&s_metric_frame_timeouts);
+		}
+
+		*ip_address = 0;
+		*port = 0;
+		return 0;
+	}
+
+	*ip_address = (uint32_t) header[0] | ((uint32_t) header[1] << 8) | ((uint32_t) header[2] << 16) | ((uint32_t) header[3] << 24);
+	*port = (uint16_t) (header[4] | (header[5] << 8));
+
+	return (uint16_t) bytes_received;
+}
+
 void wifi_udp_begin(uint16_t port) {
 	esp8266_write_4bits((uint8_t) CMD_WIFI_UDP_BEGIN);
 
@@ -54,6 +129,10 @@ uint16_t wifi_udp_recvfrom(const uint8_t *buffer, uint16_t length, uint32_t *ip_
 
 	esp8266_write_4bits((uint8_t) CMD_WIFI_UDP_RECEIVE);
 
+	if (s_is_burst) {
+		return recvfrom_burst((uint8_t *) buffer, length, ip_address, port);
+	}
+
 	bytes_received = esp8266_read_halfword();
 
 	if (bytes_received != 0) {
@@ -73,6 +152,22 @@ void wifi_udp_sendto(const uint8_t *buffer, uint16_t length, uint32_t ip_address
 
 	esp8266_write_4bits((uint8_t) CMD_WIFI_UDP_SEND);
 
+	if (s_is_burst) {
+		uint8_t header[ESP8266_BURST_UDP_HEADER_SIZE];
+
+		header[0] = (uint8_t) ip_address;
+		header[1] = (uint8_t) (ip_address >> 8);
+		header[2] = (uint8_t) (ip_address >> 16);
+		header[3] = (uint8_t) (ip_address >> 24);
+		header[4] = (uint8_t) port;
+		header[5] = (uint8_t) (port >> 8);
+
+		if (!esp8266_burst_send(esp8266_write_burst, header, ESP8266_BURST_UDP_HEADER_SIZE, buffer, length)) {
+			metric_inc(&s_metric_frame_timeouts);
+		}
+		return;
+	}
+
 	esp8266_write_halfword(length);
 	esp8266_write_word(ip_address);
 	esp8266_write_halfword(port);
@@ -36,6 +36,8 @@
 #include "h3.h"
 #include "h3_sid.h"
 
+#include "arm/synchronize.h"
+
 #include "phy.h"
 #include "mii.h"
 
@@ -56,6 +58,7 @@
 #define RX_CTL0_RX_EN				(1U << 31)
 #define RX_CTL1_RX_DMA_EN			(1 << 30)
 
+#define RX_FRM_FLT_HASH_MULTICAST	(1 << 9)
 #define RX_FRM_FLT_RX_ALL_MULTICAST	(1 << 16)
 
 #define	ARM_DMA_ALIGN	64
@@ -70,7 +73,8 @@
  */
 #define CONFIG_ETH_RXSIZE	2044 /* Note must fit in ETH_BUFSIZE */
 
-#define TX_TOTAL_BUFSIZE	(CONFIG_ETH_BUFSIZE * CONFIG_TX_DESCR_NUM)
+#define CONFIG_TX_OWN_TIMEOUT_US	2000 /* A 1518 bytes frame takes 1.2ms on 10Mbps */
+
 #define RX_TOTAL_BUFSIZE	(CONFIG_ETH_BUFSIZE * CONFIG_RX_DESCR_NUM)
 
 #define __aligned(x)            __attribute__((aligned(x)))
@@ -86,13 +90,22 @@ struct coherent_region {
 	struct emac_dma_desc rx_chain[CONFIG_TX_DESCR_NUM];
 	struct emac_dma_desc tx_chain[CONFIG_RX_DESCR_NUM];
 	char rxbuffer[RX_TOTAL_BUFSIZE] __aligned(ARM_DMA_ALIGN);
-	char txbuffer[TX_TOTAL_BUFSIZE] __aligned(ARM_DMA_ALIGN);
 	uint32_t rx_currdescnum;
 	uint32_t tx_currdescnum;
 };
 
 static struct coherent_region *p_coherent_region = 0;
 
+/*
+ * The TX buffers are in normal cacheable memory, and not in the (strongly-ordered)
+ * coherent region, so the upper layers can build frames in place with unaligned
+ * (packed) accesses. The data cache lines are cleaned before the DMA gets ownership.
+ * There is one buffer more than TX descriptors: the spare buffer is handed out by
+ * emac_eth_send_get_dma_buffer and swapped with the buffer of the descriptor on commit.
+ */
+static uint8_t s_txbuffer[CONFIG_TX_DESCR_NUM + 1][CONFIG_ETH_BUFSIZE] __aligned(ARM_DMA_ALIGN);
+static uint8_t *s_tx_spare_buffer;
+
 #define H3_EPHY_DEFAULT_VALUE	0x00058000
 #define H3_EPHY_DEFAULT_MASK	0xFFFF8000
 #define H3_EPHY_ADDR_SHIFT		20
@@ -227,18 +240,19 @@ static void _rx_descs_init(void) {
 
 static void _tx_descs_init(void) {
 	struct emac_dma_desc *desc_table_p = &p_coherent_region->tx_chain[0];
-	char *txbuffs = &p_coherent_region->txbuffer[0];
 	struct emac_dma_desc *desc_p;
 	uint32_t idx;
 
 	for (idx = 0; idx < CONFIG_TX_DESCR_NUM; idx++) {
 		desc_p = &desc_table_p[idx];
-		desc_p->buf_addr = (uintptr_t) &txbuffs[idx * CONFIG_ETH_BUFSIZE];
+		desc_p->buf_addr = (uintptr_t) &s_txbuffer[idx][0];
 		desc_p->next = (uintptr_t) &desc_table_p[idx + 1];
-		desc_p->status = (1U << 31);
+		desc_p->status = 0;	/* Owned by the CPU */
 		desc_p->st = 0;
 	}
 
+	s_tx_spare_buffer = &s_txbuffer[CONFIG_TX_DESCR_NUM][0];
+
 	/* Correcting the last pointer of the chain */
 	desc_p->next = (uintptr_t) &desc_table_p[0];
 
@@ -277,26 +291,58 @@ int emac_eth_recv(uint8_t **packetp) {
 	return -1;
 }
 
-void emac_eth_send(void *packet, int len) {
-	uint32_t value;
-	uint32_t desc_num = p_coherent_region->tx_currdescnum;
-	struct emac_dma_desc *desc_p = &p_coherent_region->tx_chain[desc_num];
-	uintptr_t data_start = (uintptr_t) desc_p->buf_addr;
+static void _tx_dma_start(void) {
+	uint32_t value = H3_EMAC->TX_CTL1;
+	value |= (1U << 31);/* mandatory */
+	value |= (1 << 30);/* mandatory */
+	H3_EMAC->TX_CTL1 = value;
+}
 
-	desc_p->st = len;
-	/* Mandatory undocumented bit */
-	desc_p->st |= (1 << 24);
+/*
+ * Clean the data cache lines (DCCMVAC) of the frame to the point of coherency
+ */
+static void _tx_clean_data_cache(uintptr_t data_start, uint32_t len) {
+	uintptr_t addr = data_start & ~(ARM_DMA_ALIGN - 1);
+	const uintptr_t data_end = data_start + len;
 
-	h3_memcpy((void *) data_start, packet, len);
+	for (; addr < data_end; addr += ARM_DMA_ALIGN) {
+		asm volatile ("mcr p15, 0, %0, c7, c10, 1" : : "r" (addr) : "memory");
+	}
 
-	debug_dump( data_start, (uint16_t) len);
+	dsb();
+}
 
-	/* frame end */
-	desc_p->st |= (1 << 30);
-	desc_p->st |= (1U << 31);
+/*
+ * The descriptor is free when the DMA has cleared the own bit.
+ * When the DMA does not release it in time, the DMA is restarted and the frame is dropped.
+ */
+static bool _tx_desc_wait_free(const struct emac_dma_desc *desc_p) {
+	if (__builtin_expect(((desc_p->status & (1U << 31)) == 0), 1)) {
+		return true;
+	}
+
+	const uint32_t micros_start = H3_TIMER->AVS_CNT1;
+
+	while (desc_p->status & (1U << 31)) {
+		if ((H3_TIMER->AVS_CNT1 - micros_start) > CONFIG_TX_OWN_TIMEOUT_US) {
+			DEBUG_PUTS("TX descriptor is owned by DMA");
+			_tx_dma_start();
+			return false;
+		}
+	}
+
+	return true;
+}
 
-	/*frame begin */
-	desc_p->st |= (1 << 29);
+static void _tx_desc_commit(struct emac_dma_desc *desc_p, uint32_t len) {
+	uint32_t desc_num = p_coherent_region->tx_currdescnum;
+
+	debug_dump((void *) desc_p->buf_addr, (uint16_t) len);
+
+	_tx_clean_data_cache(desc_p->buf_addr, len);
+
+	/* Mandatory undocumented bit (24), frame end (30), frame begin (29) */
+	desc_p->st = len | (1 << 24) | (1 << 30) | (1U << 31) | (1 << 29);
 	desc_p->status = (1U << 31);
 
 	/* Move to next Descriptor and wrap around */
@@ -306,11 +352,83 @@ void emac_eth_send(void *packet, int len) {
 
 	p_coherent_region->tx_currdescnum = desc_num;
 
-	/* Start the DMA */
-	value = H3_EMAC->TX_CTL1;
-	value |= (1U << 31);/* mandatory */
-	value |= (1 << 30);/* mandatory */
-	H3_EMAC->TX_CTL1 = value;
+	_tx_dma_start();
+}
+
+void emac_eth_send(void *packet, int len) {
+	struct emac_dma_desc *desc_p = &p_coherent_region->tx_chain[p_coherent_region->tx_currdescnum];
+
+	if (__builtin_expect((!_tx_desc_wait_free(desc_p)), 0)) {
+		return;
+	}
+
+	h3_memcpy((void *) desc_p->buf_addr, packet, len);
+
+	_tx_desc_commit(desc_p, len);
+}
+
+/*
+ * Zero-copy transmit: the frame is built in the returned buffer, and then sent with
+ * emac_eth_send_dma_buffer. Other frames can be sent with emac_eth_send in between.
+ */
+uint8_t *emac_eth_send_get_dma_buffer(void) {
+	return s_tx_spare_buffer;
+}
+
+void emac_eth_send_dma_buffer(int len) {
+	struct emac_dma_desc *desc_p = &p_coherent_region->tx_chain[p_coherent_region->tx_currdescnum];
+
+	if (__builtin_expect((!_tx_desc_wait_free(desc_p)), 0)) {
+		return;
+	}
+
+	uint8_t *p = (uint8_t *) desc_p->buf_addr;
+	desc_p->buf_addr = (uintptr_t) s_tx_spare_buffer;
+	s_tx_spare_buffer = p;
+
+	_tx_desc_commit(desc_p, len);
+}
+
+/*
+ * The 64 bits multicast hash table is indexed with the upper 6 bits
+ * of the bit reversed CRC-32 of the destination MAC address.
+ */
+uint32_t emac_multicast_hash_index(const uint8_t *mac_address) {
+	uint32_t crc = 0xFFFFFFFF;
+	uint32_t i, j;
+
+	for (i = 0; i < 6; i++) {
+		crc ^= mac_address[i];
+
+		for (j = 0; j < 8; j++) {
+			crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+		}
+	}
+
+	crc = ~crc;
+
+	uint32_t index = 0;
+
+	for (i = 0; i < 6; i++) {
+		if (crc & (1U << i)) {
+			index |= (1U << (5 - i));
+		}
+	}
+
+	return index;
+}
+
+/*
+ * hash_table[0] is bits [31:0], hash_table[1] is bits [63:32]
+ */
+void emac_multicast_hash_filter(const uint32_t *hash_table) {
+	H3_EMAC->RX_HASH0 = hash_table[1];
+	H3_EMAC->RX_HASH1 = hash_table[0];
+
+	uint32_t value = H3_EMAC->RX_FRM_FLT;
+	value &= ~RX_FRM_FLT_RX_ALL_MULTICAST;
+	value |= RX_FRM_FLT_HASH_MULTICAST;
+	H3_EMAC->RX_FRM_FLT = value;
 }
 
 void emac_free_pkt(void) {
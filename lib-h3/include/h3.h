@@ -123,6 +123,9 @@ typedef enum T_H3_IRQn {
 	H3_UART1_IRQn = 33,
 	H3_UART2_IRQn = 34,
 	H3_UART3_IRQn = 35,
+	H3_TWI0_IRQn = 38,
+	H3_TWI1_IRQn = 39,
+	H3_TWI2_IRQn = 40,
 	H3_PA_EINT_IRQn = 43,
 	H3_TIMER0_IRQn = 50,
 	H3_TIMER1_IRQn = 51,
@@ -522,7 +525,9 @@ typedef struct T_H3_EMAC {
 	__I uint32_t RES2[2];			///< 0x2C, 0x30
 	__IO uint32_t RX_DMA_DESC;		///< 0x34
 	__IO uint32_t RX_FRM_FLT;		///< 0x38
-	__I uint32_t RES3[3];			///< 0x3C, 0x40, 0x44
+	__I uint32_t RES3;				///< 0x3C
+	__IO uint32_t RX_HASH0;			///< 0x40 Hash table [63:32]
+	__IO uint32_t RX_HASH1;			///< 0x44 Hash table [31:0]
 	__IO uint32_t MII_CMD;			///< 0x48
 	__IO uint32_t MII_DATA;			///< 0x4C
 	struct {
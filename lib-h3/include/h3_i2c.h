@@ -2,7 +2,7 @@
  * @file h3_i2c.h
  *
  */
-/* Copyright (C) 2018-2019 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2018-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -27,6 +27,7 @@
 #define H3_I2C_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 
 typedef enum H3_I2C_BAUDRATE {
 	H3_I2C_NORMAL_SPEED = 100000,
@@ -41,6 +42,9 @@ typedef enum H2_I2C_RC {
 	H3_I2C_NOK_TOUT = 4
 } h3_i2c_rc_t;
 
+#define H3_I2C_ASYNC_QUEUE_SIZE		8		///< Must be a power of 2
+#define H3_I2C_ASYNC_DATA_MAX		136
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -52,6 +56,22 @@ extern uint8_t h3_i2c_read(/*@out@*/char *, uint32_t);
 extern void h3_i2c_set_baudrate(uint32_t);
 extern void h3_i2c_set_slave_address(uint8_t);
 
+/*
+ * Queued, non-blocking writes to the current slave address.
+ * h3_i2c_async_write returns false when the queue is full.
+ * h3_i2c_async_run advances the queue for at most the given microseconds.
+ */
+extern bool h3_i2c_async_write(const char *, uint32_t);
+extern void h3_i2c_async_run(uint32_t);
+extern bool h3_i2c_async_is_idle(void);
+extern uint32_t h3_i2c_async_get_errors(void);
+/*
+ * Only enable the interrupt when the application IRQ handler calls
+ * h3_i2c_async_irq_handler() for H3_TWIn_IRQn.
+ */
+extern void h3_i2c_async_set_irq(bool);
+extern void h3_i2c_async_irq_handler(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -61,6 +61,8 @@ extern int udp_bind(uint16_t);
 extern int udp_unbind(uint16_t);
 extern uint16_t udp_recv(uint8_t, uint8_t *, uint16_t, uint32_t *, uint16_t *);
 extern int udp_send(uint8_t, const uint8_t *, uint16_t, uint32_t, uint16_t);
+extern uint8_t *udp_get_send_buffer(void);
+extern int udp_send_buffer(uint8_t, uint16_t, uint32_t, uint16_t);
 //
 extern int igmp_join(uint32_t);
 extern int igmp_leave(uint32_t);
@@ -51,6 +51,7 @@ typedef union pcast32 {
 
 static struct t_arp_record s_arp_records[MAX_RECORDS] ALIGNED;
 static uint16_t s_entry_current;
+static uint32_t s_generation;
 static uint8_t s_multicast_mac[ETH_ADDR_LEN] = {0x01, 0x00, 0x5E}; // Fixed part
 
 #ifndef NDEBUG
@@ -62,6 +63,7 @@ void arp_cache_init(void) {
 	uint16_t i;
 
 	s_entry_current = 0;
+	s_generation++;
 
 	for (i = 0; i < MAX_RECORDS; i++) {
 		s_arp_records[i].ip = 0;
@@ -84,6 +86,10 @@ void arp_cache_update(uint8_t *mac_address, uint32_t ip) {
 
 	for (i = 0; i < s_entry_current; i++) {
 		if (s_arp_records[i].ip == ip) {
+			if (memcmp(s_arp_records[i].mac_address, mac_address, ETH_ADDR_LEN) != 0) {
+				memcpy(s_arp_records[i].mac_address, mac_address, ETH_ADDR_LEN);
+				s_generation++;
+			}
 			return;
 		}
 	}
@@ -92,10 +98,19 @@ void arp_cache_update(uint8_t *mac_address, uint32_t ip) {
 	s_arp_records[s_entry_current].ip = ip;
 
 	s_entry_current++;
+	s_generation++;
 
 	DEBUG2_EXIT
 }
 
+/*
+ * Incremented whenever a record is added or its MAC address changes,
+ * so that a MAC address copied from the cache can be checked for being stale.
+ */
+uint32_t arp_cache_get_generation(void) {
+	return s_generation;
+}
+
 uint32_t arp_cache_lookup(uint32_t ip, uint8_t *mac_address) {
 	DEBUG2_ENTRY
 
@@ -2,7 +2,7 @@
  * @file igmp.c
  *
  */
-/* Copyright (C) 2018-2019 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2018-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -25,6 +25,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "net/net.h"
@@ -32,14 +33,27 @@
 #include "net_packets.h"
 #include "net_debug.h"
 
+#include "h3.h"
+
 #ifndef ALIGNED
  #define ALIGNED __attribute__ ((aligned (4)))
 #endif
 
 extern uint16_t net_chksum(void *, uint32_t);
 extern void emac_eth_send(void *, int);
+extern uint32_t emac_multicast_hash_index(const uint8_t *);
+extern void emac_multicast_hash_filter(const uint32_t *);
+
+#define GROUPS_INITIAL				16		///< The table grows by doubling
+#define GROUPS_MAX					512
+#define REPORTS_PER_TICK			4		///< Rate limit, reports per 1/10 second
+#define UNSOLICITED_REPORT_INTERVAL	100		///< 1/10 seconds (RFC 2236)
+#define OLDER_QUERIER_TIMEOUT		4000	///< 1/10 seconds (RFC 3376, 8.13)
+#define QUERY_RESPONSE_INTERVAL		100		///< 1/10 seconds, IGMPv1 query
 
-#define MAX_JOINS_ALLOWED	(4 + (4 * 4))
+#define IGMPV3_ALL_ROUTERS			0x160000e0	///< 224.0.0.22
+#define IGMP_ALL_ROUTERS			0x020000e0	///< 224.0.0.2
+#define IGMP_ALL_HOSTS				0x010000e0	///< 224.0.0.1
 
 typedef enum s_state {
 	NON_MEMBER = 0,
@@ -49,8 +63,9 @@ typedef enum s_state {
 
 struct t_group_info {
 	uint32_t group_address;
-	uint8_t timer;		// 1/10 seconds
-	_state state;
+	uint16_t timer;		///< 1/10 seconds, the report is due when 0
+	uint8_t state;
+	uint8_t unsolicited;	///< Number of unsolicited reports still to be sent
 };
 
 typedef union pcast32 {
@@ -60,11 +75,85 @@ typedef union pcast32 {
 
 static struct t_igmp s_report ALIGNED;
 static struct t_igmp s_leave ALIGNED;
-static uint8_t s_multicast_mac[ETH_ADDR_LEN] ALIGNED;
-static struct t_group_info s_groups[MAX_JOINS_ALLOWED] ALIGNED;
-static uint32_t s_joins_allowed_index;
+static struct t_igmpv3 s_report_v3 ALIGNED;
+static struct t_group_info *s_groups;
+static uint32_t s_groups_count;
+static uint32_t s_groups_size;
+static uint32_t s_general_query_timer;	///< IGMPv3 current-state report, 1/10 seconds + 1
+static uint32_t s_older_querier_timer;
+static bool s_is_v3_querier;
+static uint32_t s_random;
 static uint16_t s_id ALIGNED;
 
+static void _multicast_mac(uint32_t group_address, uint8_t *mac) {
+	_pcast32 multicast_ip;
+
+	multicast_ip.u32 = group_address;
+
+	mac[0] = 0x01;
+	mac[1] = 0x00;
+	mac[2] = 0x5E;
+	mac[3] = multicast_ip.u8[1] & 0x7F;
+	mac[4] = multicast_ip.u8[2];
+	mac[5] = multicast_ip.u8[3];
+}
+
+/*
+ * The report delay is random (RFC 2236, 3) so the reports of the groups,
+ * and of the hosts, are spread over the maximum response time.
+ */
+static uint16_t _random_delay(uint32_t max_resp_time) {
+	s_random ^= s_random << 13;
+	s_random ^= s_random >> 17;
+	s_random ^= s_random << 5;
+
+	if (max_resp_time == 0) {
+		return 0;
+	}
+
+	return (uint16_t) (s_random % max_resp_time);
+}
+
+static bool _is_v3(void) {
+	return s_is_v3_querier && (s_older_querier_timer == 0);
+}
+
+static struct t_group_info *_find_group(uint32_t group_address) {
+	uint32_t i;
+
+	for (i = 0; i < s_groups_count; i++) {
+		if (s_groups[i].group_address == group_address) {
+			return &s_groups[i];
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * The EMAC multicast hash filter is programmed from the membership table.
+ * The all-hosts group is always accepted, it is used for the (general) queries.
+ */
+static void _update_hash_filter(void) {
+	uint32_t hash_table[2] = {0, 0};
+	uint8_t mac[ETH_ADDR_LEN];
+	uint32_t i;
+
+	_multicast_mac(IGMP_ALL_HOSTS, mac);
+	i = emac_multicast_hash_index(mac);
+	hash_table[i >> 5] |= (1U << (i & 0x1F));
+
+	for (i = 0; i < s_groups_count; i++) {
+		_multicast_mac(s_groups[i].group_address, mac);
+		const uint32_t index = emac_multicast_hash_index(mac);
+		hash_table[index >> 5] |= (1U << (index & 0x1F));
+	}
+
+	DEBUG_PRINTF("%08x%08x", hash_table[1], hash_table[0]);
+
+	emac_multicast_hash_filter(hash_table);
+}
+
 void igmp_set_ip(const struct ip_info  *p_ip_info) {
 	_pcast32 src;
 
@@ -72,65 +161,85 @@ void igmp_set_ip(const struct ip_info  *p_ip_info) {
 
 	memcpy(s_report.ip4.src, src.u8, IPv4_ADDR_LEN);
 	memcpy(s_leave.ip4.src, src.u8, IPv4_ADDR_LEN);
+	memcpy(s_report_v3.ip4.src, src.u8, IPv4_ADDR_LEN);
+}
+
+static void _init_ip4(struct t_ip4_packet *p_ip4) {
+	p_ip4->ver_ihl = 0x46; // Router Alert option
+	p_ip4->tos = 0;
+	p_ip4->flags_froff = __builtin_bswap16(IPv4_FLAG_DF);
+	p_ip4->ttl = 1;
+	p_ip4->proto = IPv4_PROTO_IGMP;
 }
 
 void igmp_init(uint8_t *mac_address, const struct ip_info  *p_ip_info) {
-	uint32_t i;
+	_pcast32 dst;
 
-	for (i = 0; i < MAX_JOINS_ALLOWED ; i++) {
-		memset(&s_groups[i], 0, sizeof(struct t_group_info));
+	if (s_groups == 0) {
+		s_groups = (struct t_group_info *) malloc(GROUPS_INITIAL * sizeof(struct t_group_info));
+		s_groups_size = (s_groups == 0) ? 0 : GROUPS_INITIAL;
 	}
 
-	s_joins_allowed_index = 0;
+	s_groups_count = 0;
+	s_general_query_timer = 0;
+	s_older_querier_timer = 0;
+	s_is_v3_querier = false;
 	s_id = 0;
 
-	igmp_set_ip(p_ip_info);
+	s_random = H3_TIMER->AVS_CNT1
+			^ (((uint32_t) mac_address[3]) << 16)
+			^ (((uint32_t) mac_address[4]) << 8)
+			^ mac_address[5];
+
+	if (s_random == 0) {
+		s_random = 1;
+	}
 
-	s_multicast_mac[0] = 0x01;
-	s_multicast_mac[1] = 0x00;
-	s_multicast_mac[2] = 0x5E;
+	igmp_set_ip(p_ip_info);
 
 	// Ethernet
 	memcpy(s_report.ether.src, mac_address, ETH_ADDR_LEN);
 	s_report.ether.type = __builtin_bswap16(ETHER_TYPE_IPv4);
 	// IPv4
-	s_report.ip4.ver_ihl = 0x46; // TODO
-	s_report.ip4.tos = 0;
-	s_report.ip4.flags_froff = __builtin_bswap16(IPv4_FLAG_DF);
-	s_report.ip4.ttl = 1;
-	s_report.ip4.proto = IPv4_PROTO_IGMP;
+	_init_ip4(&s_report.ip4);
 	s_report.ip4.len = __builtin_bswap16(IPv4_IGMP_REPORT_HEADERS_SIZE);
 	// IPv4 options
-	s_report.igmp.report.ip4_options = 0x00000494; // TODO
+	s_report.igmp.report.ip4_options = 0x00000494; // Router Alert
 	// IGMP
 	s_report.igmp.report.igmp.type = IGMP_TYPE_REPORT;
 	s_report.igmp.report.igmp.max_resp_time = 0;
 
 	// Ethernet
-	s_leave.ether.dst[0] = 0x01;
-	s_leave.ether.dst[1] = 0x00;
-	s_leave.ether.dst[2] = 0x5E;
-	s_leave.ether.dst[3] = 0x00;
-	s_leave.ether.dst[4] = 0x00;
-	s_leave.ether.dst[5] = 0x02;
+	_multicast_mac(IGMP_ALL_ROUTERS, s_leave.ether.dst);
 	memcpy(s_leave.ether.src, mac_address, ETH_ADDR_LEN);
 	s_leave.ether.type = __builtin_bswap16(ETHER_TYPE_IPv4);
 	// IPv4
-	s_leave.ip4.ver_ihl = 0x46; // TODO
-	s_leave.ip4.tos = 0;
-	s_leave.ip4.flags_froff = __builtin_bswap16(IPv4_FLAG_DF);
-	s_leave.ip4.ttl = 1;
-	s_leave.ip4.proto = IPv4_PROTO_IGMP;
+	_init_ip4(&s_leave.ip4);
 	s_leave.ip4.len = __builtin_bswap16(IPv4_IGMP_REPORT_HEADERS_SIZE);
-	s_leave.ip4.dst[0] = 0xE0; // 224
-	s_leave.ip4.dst[1] = 0x00; // 0
-	s_leave.ip4.dst[2] = 0x00; // 0
-	s_leave.ip4.dst[3] = 0x02; // 2
+	dst.u32 = IGMP_ALL_ROUTERS;
+	memcpy(s_leave.ip4.dst, dst.u8, IPv4_ADDR_LEN);
 	// IPv4 options
-	s_leave.igmp.report.ip4_options = 0x00000494; // TODO
+	s_leave.igmp.report.ip4_options = 0x00000494; // Router Alert
 	// IGMP
 	s_leave.igmp.report.igmp.type = IGMP_TYPE_LEAVE;
 	s_leave.igmp.report.igmp.max_resp_time = 0;
+
+	// Ethernet
+	_multicast_mac(IGMPV3_ALL_ROUTERS, s_report_v3.ether.dst);
+	memcpy(s_report_v3.ether.src, mac_address, ETH_ADDR_LEN);
+	s_report_v3.ether.type = __builtin_bswap16(ETHER_TYPE_IPv4);
+	// IPv4
+	_init_ip4(&s_report_v3.ip4);
+	dst.u32 = IGMPV3_ALL_ROUTERS;
+	memcpy(s_report_v3.ip4.dst, dst.u8, IPv4_ADDR_LEN);
+	// IPv4 options
+	s_report_v3.ip4_options = 0x00000494; // Router Alert
+	// IGMP
+	s_report_v3.igmp.type = IGMP_TYPE_V3_REPORT;
+	s_report_v3.igmp.reserved1 = 0;
+	s_report_v3.igmp.reserved2 = 0;
+
+	_update_hash_filter();
 }
 
 static void _send_report(uint32_t group_address) {
@@ -139,23 +248,19 @@ static void _send_report(uint32_t group_address) {
 
 	multicast_ip.u32 = group_address;
 
-	s_multicast_mac[3] = multicast_ip.u8[1] & 0x7F;
-	s_multicast_mac[4] = multicast_ip.u8[2];
-	s_multicast_mac[5] = multicast_ip.u8[3];
-
-	DEBUG_PRINTF(IPSTR " " MACSTR, IP2STR(group_address),MAC2STR(s_multicast_mac));
+	DEBUG_PRINTF(IPSTR, IP2STR(group_address));
 
 	// Ethernet
-	memcpy(s_report.ether.dst, s_multicast_mac, ETH_ADDR_LEN);
+	_multicast_mac(group_address, s_report.ether.dst);
 	// IPv4
 	s_report.ip4.id = s_id;
 	memcpy(s_report.ip4.dst, multicast_ip.u8, IPv4_ADDR_LEN);
 	s_report.ip4.chksum = 0;
-	s_report.ip4.chksum = net_chksum((void *)&s_report.ip4, 24); //TODO
+	s_report.ip4.chksum = net_chksum((void *)&s_report.ip4, 24);
 	// IGMP
 	memcpy(s_report.igmp.report.igmp.group_address, multicast_ip.u8, IPv4_ADDR_LEN);
 	s_report.igmp.report.igmp.checksum = 0;
-	s_report.igmp.report.igmp.checksum = net_chksum((void *)&s_report.ip4, (uint32_t)IPv4_IGMP_REPORT_HEADERS_SIZE);
+	s_report.igmp.report.igmp.checksum = net_chksum((void *)&s_report.igmp.report.igmp, (uint32_t) sizeof(struct t_igmp_packet));
 
 	debug_dump(&s_report, IGMP_REPORT_PACKET_SIZE);
 
@@ -172,16 +277,16 @@ static void _send_leave(uint32_t group_address) {
 
 	multicast_ip.u32 = group_address;
 
-	DEBUG_PRINTF(IPSTR " " MACSTR, IP2STR(group_address), MAC2STR(s_multicast_mac));
+	DEBUG_PRINTF(IPSTR, IP2STR(group_address));
 
 	// IPv4
 	s_leave.ip4.id = s_id;
 	s_leave.ip4.chksum = 0;
-	s_leave.ip4.chksum = net_chksum((void *) &s_report.ip4, 24); //TODO
+	s_leave.ip4.chksum = net_chksum((void *) &s_leave.ip4, 24);
 	// IGMP
 	memcpy(s_leave.igmp.report.igmp.group_address, multicast_ip.u8, IPv4_ADDR_LEN);
 	s_leave.igmp.report.igmp.checksum = 0;
-	s_leave.igmp.report.igmp.checksum = net_chksum((void *) &s_leave.ip4, (uint32_t) IPv4_IGMP_REPORT_HEADERS_SIZE);
+	s_leave.igmp.report.igmp.checksum = net_chksum((void *) &s_leave.igmp.report.igmp, (uint32_t) sizeof(struct t_igmp_packet));
 
 	debug_dump( &s_leave, IGMP_REPORT_PACKET_SIZE);
 
@@ -192,109 +297,285 @@ static void _send_leave(uint32_t group_address) {
 	DEBUG2_EXIT
 }
 
+/*
+ * IGMPv3 report, the group records are already filled in
+ */
+static void _send_report_v3(uint32_t records) {
+	DEBUG2_ENTRY
+	DEBUG_PRINTF("records=%u", records);
+
+	const uint32_t igmp_length = sizeof(struct t_igmpv3_report_packet) - ((IGMPV3_MAX_RECORDS - records) * sizeof(struct t_igmpv3_group_record));
+
+	// IPv4
+	s_report_v3.ip4.id = s_id;
+	s_report_v3.ip4.len = __builtin_bswap16(24 + igmp_length);
+	s_report_v3.ip4.chksum = 0;
+	s_report_v3.ip4.chksum = net_chksum((void *) &s_report_v3.ip4, 24);
+	// IGMP
+	s_report_v3.igmp.number_of_records = __builtin_bswap16(records);
+	s_report_v3.igmp.checksum = 0;
+	s_report_v3.igmp.checksum = net_chksum((void *) &s_report_v3.igmp, igmp_length);
+
+	debug_dump(&s_report_v3, IGMPV3_REPORT_PACKET_SIZE(records));
+
+	emac_eth_send((void *) &s_report_v3, IGMPV3_REPORT_PACKET_SIZE(records));
+
+	s_id++;
+
+	DEBUG2_EXIT
+}
+
+static void _add_record_v3(uint32_t record, uint8_t type, uint32_t group_address) {
+	_pcast32 multicast_ip;
+
+	multicast_ip.u32 = group_address;
+
+	struct t_igmpv3_group_record *p_record = &s_report_v3.igmp.records[record];
+
+	p_record->type = type;
+	p_record->aux_data_len = 0;
+	p_record->number_of_sources = 0;
+	memcpy(p_record->group_address, multicast_ip.u8, IPv4_ADDR_LEN);
+}
+
+/*
+ * IGMPv3 Max Resp Code (RFC 3376, 4.1.1), in 1/10 seconds
+ */
+static uint32_t _max_resp_time_v3(uint8_t max_resp_code) {
+	if (max_resp_code < 128) {
+		return max_resp_code;
+	}
+
+	const uint32_t mant = max_resp_code & 0x0F;
+	const uint32_t exp = (max_resp_code >> 4) & 0x07;
+
+	return (mant | 0x10) << (exp + 3);
+}
+
+static void _schedule_group(struct t_group_info *p_group, uint32_t max_resp_time) {
+	const uint16_t delay = _random_delay(max_resp_time);
+
+	if (p_group->state == DELAYING_MEMBER) {
+		if (delay < p_group->timer) {
+			p_group->timer = delay;
+		}
+	} else if (p_group->state == IDLE_MEMBER) {
+		p_group->state = DELAYING_MEMBER;
+		p_group->timer = delay;
+	}
+}
 
 void igmp_handle(struct t_igmp *p_igmp) {
 	DEBUG2_ENTRY
 
 	uint32_t i;
-	_pcast32 igmp_generic_address;
 	_pcast32 group_address;
 
-	if ((p_igmp->ip4.ver_ihl == 0x45) && (p_igmp->igmp.igmp.type == IGMP_TYPE_QUERY)) {
-		DEBUG_PRINTF(IPSTR, p_igmp->ip4.dst[0], p_igmp->ip4.dst[1], p_igmp->ip4.dst[2], p_igmp->ip4.dst[3]);
+	const uint32_t ip4_header_length = (uint32_t) (p_igmp->ip4.ver_ihl & 0x0F) << 2;
+	const uint32_t igmp_length = (uint32_t) __builtin_bswap16(p_igmp->ip4.len) - ip4_header_length;
+	const struct t_igmp_packet *p_igmp_packet = (struct t_igmp_packet *) ((uint8_t *) &p_igmp->ip4 + ip4_header_length);
+
+	if (igmp_length < sizeof(struct t_igmp_packet)) {
+		DEBUG2_EXIT
+		return;
+	}
+
+	memcpy(group_address.u8, p_igmp_packet->group_address, IPv4_ADDR_LEN);
 
-		bool  is_general_request = false;
+	if (p_igmp_packet->type == IGMP_TYPE_QUERY) {
+		uint32_t max_resp_time;
 
-		igmp_generic_address.u32 = 0x010000e0;
+		DEBUG_PRINTF(IPSTR " " IPSTR, p_igmp->ip4.dst[0], p_igmp->ip4.dst[1], p_igmp->ip4.dst[2], p_igmp->ip4.dst[3], IP2STR(group_address.u32));
 
-		if (memcmp(p_igmp->ip4.dst, igmp_generic_address.u8, 4) == 0) {
-			is_general_request = true;
+		if (igmp_length >= 12) {
+			s_is_v3_querier = true;
+			max_resp_time = _max_resp_time_v3(p_igmp_packet->max_resp_time);
+		} else {
+			s_older_querier_timer = OLDER_QUERIER_TIMEOUT;
+			s_is_v3_querier = false;
+			max_resp_time = (p_igmp_packet->max_resp_time == 0) ? QUERY_RESPONSE_INTERVAL : p_igmp_packet->max_resp_time;
 		}
 
-		for (i = 0; i < s_joins_allowed_index; i++) {
-			group_address.u32 = s_groups[i].group_address;
-			if (is_general_request || ( memcmp(p_igmp->ip4.dst, group_address.u8, IPv4_ADDR_LEN) == 0)) {
-				if (s_groups[i].state == DELAYING_MEMBER) {
-					if (p_igmp->igmp.igmp.max_resp_time  < s_groups[i].timer) {
-						s_groups[i].timer = 1 + p_igmp->igmp.igmp.max_resp_time / 2;
-					}
-				} else { // s_groups[s_joins_allowed_index].state == IDLE_MEMBER
-					s_groups[i].state = DELAYING_MEMBER;
-					s_groups[i].timer = 1 + p_igmp->igmp.igmp.max_resp_time / 2;
+		if (group_address.u32 == 0) {
+			if (_is_v3()) {
+				// A single current-state report for all the groups
+				const uint32_t timer = 1 + _random_delay(max_resp_time);
+
+				if ((s_general_query_timer == 0) || (timer < s_general_query_timer)) {
+					s_general_query_timer = timer;
+				}
+			} else {
+				for (i = 0; i < s_groups_count; i++) {
+					_schedule_group(&s_groups[i], max_resp_time);
 				}
 			}
+		} else {
+			struct t_group_info *p_group = _find_group(group_address.u32);
+
+			if (p_group != 0) {
+				_schedule_group(p_group, max_resp_time);
+			}
+		}
+	} else if (p_igmp_packet->type == IGMP_TYPE_REPORT) {
+		// Report suppression (RFC 2236, 3)
+		struct t_group_info *p_group = _find_group(group_address.u32);
+
+		if ((p_group != 0) && (p_group->state == DELAYING_MEMBER) && (p_group->unsolicited == 0)) {
+			p_group->state = IDLE_MEMBER;
 		}
 	}
 
 	DEBUG2_EXIT
 }
 
+/*
+ * Called every 1/10 second. The due reports are rate limited: the reports
+ * not sent are due in the next tick. With IGMPv3 the due groups are
+ * combined in a single report.
+ */
 void igmp_timer(void) {
 	uint32_t i;
+	uint32_t reports = 0;
+	uint32_t records = 0;
+	const bool is_v3 = _is_v3();
+
+	if (s_older_querier_timer > 0) {
+		s_older_querier_timer--;
+	}
+
+	if (s_general_query_timer > 0) {
+		s_general_query_timer--;
+
+		if (s_general_query_timer == 0) {
+			if (is_v3) {
+				for (i = 0; i < s_groups_count; i++) {
+					_add_record_v3(records++, IGMPV3_MODE_IS_EXCLUDE, s_groups[i].group_address);
+
+					if (records == IGMPV3_MAX_RECORDS) {
+						_send_report_v3(records);
+						records = 0;
+						reports++;
+					}
+				}
 
-	for (i = 0; i < MAX_JOINS_ALLOWED ; i++) {
+				if (records != 0) {
+					_send_report_v3(records);
+					records = 0;
+					reports++;
+				}
+			} else {
+				for (i = 0; i < s_groups_count; i++) {
+					_schedule_group(&s_groups[i], UNSOLICITED_REPORT_INTERVAL);
+				}
+			}
+		}
+	}
+
+	for (i = 0; i < s_groups_count; i++) {
+		struct t_group_info *p_group = &s_groups[i];
+
+		if (p_group->state != DELAYING_MEMBER) {
+			continue;
+		}
 
-		if ((s_groups[i].state == DELAYING_MEMBER) && (s_groups[i].timer > 0)) {
-			s_groups[i].timer--;
+		if (p_group->timer > 0) {
+			p_group->timer--;
+			continue;
+		}
+
+		if (reports >= REPORTS_PER_TICK) {
+			continue;
+		}
+
+		if (is_v3) {
+			_add_record_v3(records++, (p_group->unsolicited != 0) ? IGMPV3_CHANGE_TO_EXCLUDE : IGMPV3_MODE_IS_EXCLUDE, p_group->group_address);
 
-			if (s_groups[i].timer == 0) {
-				_send_report(s_groups[i].group_address);
-				s_groups[i].state = IDLE_MEMBER;
+			if (records == IGMPV3_MAX_RECORDS) {
+				_send_report_v3(records);
+				records = 0;
+				reports++;
 			}
+		} else {
+			_send_report(p_group->group_address);
+			reports++;
+		}
+
+		if (p_group->unsolicited != 0) {
+			p_group->unsolicited--;
+		}
+
+		if (p_group->unsolicited != 0) {
+			p_group->timer = 1 + _random_delay(UNSOLICITED_REPORT_INTERVAL);
+		} else {
+			p_group->state = IDLE_MEMBER;
 		}
 	}
+
+	if (records != 0) {
+		_send_report_v3(records);
+	}
 }
 
 // --> Public
 
 int igmp_join(uint32_t group_address) {
-	uint32_t i;
-
-	if ((group_address& 0xE0) != 0xE0) {
+	if ((group_address & 0xE0) != 0xE0) {
 		return -1;
 	}
 
-	if (s_joins_allowed_index == MAX_JOINS_ALLOWED) {
-		return -2;
+	if (_find_group(group_address) != 0) {
+		return 0;
 	}
 
-	for (i = 0; i < s_joins_allowed_index; i++) {
-		if (s_groups[i].group_address == group_address) {
-			return i;
+	if (s_groups_count == s_groups_size) {
+		if (s_groups_size == GROUPS_MAX) {
+			DEBUG_PUTS("GROUPS_MAX");
+			return -2;
+		}
+
+		const uint32_t size = (s_groups_size == 0) ? GROUPS_INITIAL : (2 * s_groups_size);
+		struct t_group_info *p_groups = (struct t_group_info *) realloc(s_groups, size * sizeof(struct t_group_info));
+
+		if (p_groups == 0) {
+			DEBUG_PUTS("realloc failed");
+			return -2;
 		}
-	}
 
-	const int current_index = s_joins_allowed_index;
+		s_groups = p_groups;
+		s_groups_size = size;
+	}
 
-	s_groups[s_joins_allowed_index].group_address = group_address;
-	s_groups[s_joins_allowed_index].state = DELAYING_MEMBER;
-	s_groups[s_joins_allowed_index].timer = 2; // TODO
+	struct t_group_info *p_group = &s_groups[s_groups_count++];
 
-	s_joins_allowed_index++;
+	// The unsolicited reports are sent (rate limited) from the timer, the first is due in the next tick
+	p_group->group_address = group_address;
+	p_group->state = DELAYING_MEMBER;
+	p_group->timer = 0;
+	p_group->unsolicited = 2;
 
-	_send_report(group_address);
+	_update_hash_filter();
 
-	return current_index;
+	return 0;
 }
 
 int igmp_leave(uint32_t group_address) {
-	uint32_t i;
+	struct t_group_info *p_group = _find_group(group_address);
 
-	for (i = 0; i < MAX_JOINS_ALLOWED; i++) {
-		if (s_groups[i].group_address == group_address) {
-			break;
-		}
+	if (p_group == 0) {
+		return -1;
 	}
 
-	if (i == MAX_JOINS_ALLOWED) {
-		return -1;
+	if (_is_v3()) {
+		_add_record_v3(0, IGMPV3_CHANGE_TO_INCLUDE, group_address);
+		_send_report_v3(1);
+	} else {
+		_send_leave(group_address);
 	}
 
-	_send_leave(s_groups[i].group_address);
+	// Keep the table compact
+	*p_group = s_groups[--s_groups_count];
 
-	s_groups[i].group_address = 0;
-	s_groups[i].state = NON_MEMBER;
-	s_groups[i].timer = 0;
+	_update_hash_filter();
 
 	return 0;
 }
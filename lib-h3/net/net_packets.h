@@ -88,7 +88,18 @@ enum ARP_OPCODE {
 enum IGMP_TYPE {
 	IGMP_TYPE_QUERY = 0x11,
 	IGMP_TYPE_REPORT = 0x16,
-	IGMP_TYPE_LEAVE = 0x17
+	IGMP_TYPE_LEAVE = 0x17,
+	IGMP_TYPE_V3_REPORT = 0x22
+};
+
+enum IGMPV3_RECORD_TYPE {
+	IGMPV3_MODE_IS_EXCLUDE = 2,
+	IGMPV3_CHANGE_TO_INCLUDE = 3,
+	IGMPV3_CHANGE_TO_EXCLUDE = 4
+};
+
+enum IGMPV3_RECORDS {
+	IGMPV3_MAX_RECORDS = 64
 };
 
 enum ICMP_TYPE {
@@ -139,6 +150,13 @@ struct t_udp_packet {
 	uint8_t data[FRAME_BUFFER_SIZE];
 }PACKED;
 
+struct t_udp_header {
+	uint16_t source_port;
+	uint16_t destination_port;
+	uint16_t len;
+	uint16_t checksum;
+}PACKED;
+
 struct t_igmp_packet {
 	uint8_t type;
 	uint8_t max_resp_time;
@@ -146,6 +164,22 @@ struct t_igmp_packet {
 	uint8_t group_address[IPv4_ADDR_LEN];
 }PACKED;
 
+struct t_igmpv3_group_record {
+	uint8_t type;
+	uint8_t aux_data_len;
+	uint16_t number_of_sources;
+	uint8_t group_address[IPv4_ADDR_LEN];
+}PACKED;
+
+struct t_igmpv3_report_packet {
+	uint8_t type;
+	uint8_t reserved1;
+	uint16_t checksum;
+	uint16_t reserved2;
+	uint16_t number_of_records;
+	struct t_igmpv3_group_record records[IGMPV3_MAX_RECORDS];
+}PACKED;
+
 struct t_icmp_packet {
 	uint8_t type;			///< 1
 	uint8_t code;			///< 1
@@ -170,6 +204,12 @@ struct t_udp {
 	struct t_udp_packet udp;
 }PACKED;
 
+struct t_udp_headers {
+	struct ether_packet ether;
+	struct t_ip4_packet ip4;
+	struct t_udp_header udp;
+}PACKED;
+
 struct t_igmp {
 	struct ether_packet ether;
 	struct t_ip4_packet ip4;
@@ -182,6 +222,13 @@ struct t_igmp {
 	} igmp;
 }PACKED;
 
+struct t_igmpv3 {
+	struct ether_packet ether;
+	struct t_ip4_packet ip4;
+	uint32_t ip4_options;
+	struct t_igmpv3_report_packet igmp;
+}PACKED;
+
 struct t_icmp {
 	struct ether_packet ether;
 	struct t_ip4_packet ip4;
@@ -195,6 +242,8 @@ struct t_icmp {
 #define IPv4_IGMP_REPORT_HEADERS_SIZE 	(sizeof(struct t_igmp) - sizeof(struct ether_packet))
 #define IGMP_REPORT_PACKET_SIZE			(sizeof(struct t_igmp))
 
+#define IGMPV3_REPORT_PACKET_SIZE(x)	(sizeof(struct t_igmpv3) - ((IGMPV3_MAX_RECORDS - (x)) * sizeof(struct t_igmpv3_group_record)))
+
 #define IPv4_ICMP_HEADERS_SIZE 			(sizeof(struct t_icmp) - sizeof(struct ether_packet))
 
 #endif /* NET_PACKETS_H_ */
@@ -39,6 +39,8 @@
 
 #include "h3.h"
 
+#include "metrics.h"
+
 extern int console_error(const char *);
 
 #ifndef ALIGNED
@@ -49,14 +51,23 @@ extern int console_error(const char *);
  #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #endif
 
-extern void emac_eth_send(void *, int);
+extern uint8_t *emac_eth_send_get_dma_buffer(void);
+extern void emac_eth_send_dma_buffer(int);
 extern uint32_t arp_cache_lookup(uint32_t, uint8_t *);
+extern uint32_t arp_cache_get_generation(void);
 extern uint16_t net_chksum(void *, uint32_t);
 
 #define MAX_PORTS_ALLOWED	16
+#define UDP_DATA_SIZE_MAX	(1500 - IPv4_UDP_HEADERS_SIZE) // MTU
 #define MAX_ENTRIES			(1 << 2) // Must always be a power of 2
 #define MAX_ENTRIES_MASK	(MAX_ENTRIES - 1)
 
+static struct metric s_metric_rx_packets = METRIC_COUNTER("udp.rx.packets");
+static struct metric s_metric_rx_overruns = METRIC_COUNTER("udp.rx.overruns");
+static struct metric s_metric_rx_unbound = METRIC_COUNTER("udp.rx.unbound");
+static struct metric s_metric_tx_packets = METRIC_COUNTER("udp.tx.packets");
+static struct metric s_metric_tx_errors = METRIC_COUNTER("udp.tx.errors");
+
 struct queue_entry {
 	uint8_t data[FRAME_BUFFER_SIZE];
 	uint32_t from_ip;
@@ -70,6 +81,17 @@ struct queue {
 	struct queue_entry entries[MAX_ENTRIES] ALIGNED;
 }ALIGNED;
 
+/*
+ * Per socket Ethernet/IPv4/UDP headers. The destination MAC and IP address
+ * are kept for the last destination, so the ARP lookup is done only when
+ * the destination changes or the ARP cache has been updated since.
+ */
+struct send_template {
+	struct t_udp_headers headers;
+	uint32_t to_ip;
+	uint32_t arp_generation;
+}ALIGNED;
+
 typedef union pcast32 {
 	uint32_t u32;
 	uint8_t u8[4];
@@ -77,16 +99,21 @@ typedef union pcast32 {
 
 static uint32_t s_ports_allowed[MAX_PORTS_ALLOWED];
 static struct queue s_recv_queue[MAX_PORTS_ALLOWED] ALIGNED;
-static struct t_udp s_send_packet ALIGNED;
+static struct send_template s_send_template[MAX_PORTS_ALLOWED] ALIGNED;
 static uint16_t s_id ALIGNED;
 static uint32_t broadcast_mask;
 
 void udp_set_ip(const struct ip_info *p_ip_info) {
 	_pcast32 src;
+	uint32_t i;
 
 	src.u32 = p_ip_info->ip.addr;
-	memcpy(s_send_packet.ip4.src, src.u8, IPv4_ADDR_LEN);
 	broadcast_mask = ~(p_ip_info->netmask.addr);
+
+	for (i = 0; i < MAX_PORTS_ALLOWED; i++) {
+		memcpy(s_send_template[i].headers.ip4.src, src.u8, IPv4_ADDR_LEN);
+		s_send_template[i].to_ip = 0;
+	}
 }
 
 void udp_init(const uint8_t *mac_address, const struct ip_info  *p_ip_info) {
@@ -100,18 +127,30 @@ void udp_init(const uint8_t *mac_address, const struct ip_info  *p_ip_info) {
 
 	s_id = 0;
 
-	// Ethernet
-	memcpy(s_send_packet.ether.src, mac_address, ETH_ADDR_LEN);
-	s_send_packet.ether.type = __builtin_bswap16(ETHER_TYPE_IPv4);
-	// IPv4
-	s_send_packet.ip4.ver_ihl = 0x45;
-	s_send_packet.ip4.tos = 0;
-	s_send_packet.ip4.flags_froff = __builtin_bswap16(IPv4_FLAG_DF);
-	s_send_packet.ip4.ttl = 64;
-	s_send_packet.ip4.proto = IPv4_PROTO_UDP;
+	metrics_register(&s_metric_rx_packets);
+	metrics_register(&s_metric_rx_overruns);
+	metrics_register(&s_metric_rx_unbound);
+	metrics_register(&s_metric_tx_packets);
+	metrics_register(&s_metric_tx_errors);
+
+	for (i = 0; i < MAX_PORTS_ALLOWED; i++) {
+		struct t_udp_headers *p_headers = &s_send_template[i].headers;
+		// Ethernet
+		memcpy(p_headers->ether.src, mac_address, ETH_ADDR_LEN);
+		p_headers->ether.type = __builtin_bswap16(ETHER_TYPE_IPv4);
+		// IPv4
+		p_headers->ip4.ver_ihl = 0x45;
+		p_headers->ip4.tos = 0;
+		p_headers->ip4.flags_froff = __builtin_bswap16(IPv4_FLAG_DF);
+		p_headers->ip4.ttl = 64;
+		p_headers->ip4.proto = IPv4_PROTO_UDP;
+		p_headers->ip4.chksum = 0;
+		// UDP
+		p_headers->udp.source_port = 0;
+		p_headers->udp.checksum = 0;
+	}
+
 	udp_set_ip(p_ip_info);
-	// UDP
-	s_send_packet.udp.checksum = 0;
 }
 
 void udp_handle(struct t_udp *p_udp) {
@@ -137,10 +176,19 @@ void udp_handle(struct t_udp *p_udp) {
 
 	if (__builtin_expect ((port_index == MAX_PORTS_ALLOWED), 0)) {
 		DEBUG_PRINTF(IPSTR ":%d", p_udp->ip4.src[0],p_udp->ip4.src[1],p_udp->ip4.src[2],p_udp->ip4.src[3], dest_port);
+		metric_inc(&s_metric_rx_unbound);
+		return;
+	}
+
+	const uint32_t entry = s_recv_queue[port_index].queue_head;
+	const uint32_t next = (entry + 1) & MAX_ENTRIES_MASK;
+
+	if (__builtin_expect((next == s_recv_queue[port_index].queue_tail), 0)) {
+		DEBUG_PRINTF("Queue full -> %d", dest_port);
+		metric_inc(&s_metric_rx_overruns);
 		return;
 	}
 
-	const uint32_t entry = s_recv_queue[port_index].queue_tail;
 	struct queue_entry *p_queue_entry = &s_recv_queue[port_index].entries[entry];
 
 	const uint32_t data_length = __builtin_bswap16(p_udp->udp.len) - UDP_HEADER_SIZE;
@@ -156,7 +204,9 @@ void udp_handle(struct t_udp *p_udp) {
 	p_queue_entry->from_port = __builtin_bswap16(p_udp->udp.source_port);
 	p_queue_entry->size = i;
 
-	s_recv_queue[port_index].queue_head = (s_recv_queue[port_index].queue_head + 1) & MAX_ENTRIES_MASK;
+	s_recv_queue[port_index].queue_head = next;
+
+	metric_inc(&s_metric_rx_packets);
 }
 
 // -->
@@ -182,6 +232,8 @@ int udp_bind(uint16_t local_port) {
 	}
 
 	s_ports_allowed[i] = local_port;
+	s_send_template[i].headers.udp.source_port = __builtin_bswap16(local_port);
+	s_send_template[i].to_ip = 0;
 
 	DEBUG_PRINTF("i=%d, local_port=%d", i, local_port);
 
@@ -228,11 +280,35 @@ uint16_t udp_recv(uint8_t idx, uint8_t *packet, uint16_t size, uint32_t *from_ip
 	return i;
 }
 
-int udp_send(uint8_t idx, const uint8_t *packet, uint16_t size, uint32_t to_ip, uint16_t remote_port) {
-	assert(idx < MAX_PORTS_ALLOWED);
-
+static bool _set_destination(struct send_template *p_template, uint32_t to_ip) {
 	_pcast32 dst;
 
+	if ((to_ip == IPv4_BROADCAST) || ((to_ip & broadcast_mask) == broadcast_mask)) {
+		memset(p_template->headers.ether.dst, 0xFF, ETH_ADDR_LEN);
+	} else if (to_ip != arp_cache_lookup(to_ip, p_template->headers.ether.dst)) {
+		p_template->to_ip = 0;
+		return false;
+	}
+
+	dst.u32 = to_ip;
+	memcpy(p_template->headers.ip4.dst, dst.u8, IPv4_ADDR_LEN);
+	p_template->to_ip = to_ip;
+	p_template->arp_generation = arp_cache_get_generation();
+
+	return true;
+}
+
+/*
+ * Zero-copy transmit. The payload is written in the buffer returned by udp_get_send_buffer,
+ * followed by udp_send_buffer. There must be no other udp_send(_buffer) in between.
+ */
+uint8_t *udp_get_send_buffer(void) {
+	return emac_eth_send_get_dma_buffer() + UDP_PACKET_HEADERS_SIZE;
+}
+
+int udp_send_buffer(uint8_t idx, uint16_t size, uint32_t to_ip, uint16_t remote_port) {
+	assert(idx < MAX_PORTS_ALLOWED);
+
 	if (__builtin_expect ((s_ports_allowed[idx] == 0), 0)) {
 		DEBUG_PUTS("ports_allowed[idx] == 0");
 		return -1;
@@ -240,43 +316,46 @@ int udp_send(uint8_t idx, const uint8_t *packet, uint16_t size, uint32_t to_ip,
 
 	DEBUG_PRINTF("[%d] %d[%d]: %d %p " IPSTR, H3_TIMER->AVS_CNT0, idx, s_ports_allowed[idx], size, to_ip, IP2STR(to_ip));
 
-	if (to_ip == IPv4_BROADCAST) {
-		memset(s_send_packet.ether.dst, 0xFF, ETH_ADDR_LEN);
-		memset(s_send_packet.ip4.dst, 0xFF, IPv4_ADDR_LEN);
-	} else if ((to_ip & broadcast_mask) == broadcast_mask) {
-		memset(s_send_packet.ether.dst, 0xFF, ETH_ADDR_LEN);
-		dst.u32 = to_ip;
-		memcpy(s_send_packet.ip4.dst, dst.u8, IPv4_ADDR_LEN);
-	} else {
-		if (to_ip == arp_cache_lookup(to_ip, s_send_packet.ether.dst)) {
-			dst.u32 = to_ip;
-			memcpy(s_send_packet.ip4.dst, dst.u8, IPv4_ADDR_LEN);
-		} else {
+	struct send_template *p_template = &s_send_template[idx];
+
+	if (__builtin_expect(((to_ip != p_template->to_ip) || (p_template->arp_generation != arp_cache_get_generation())), 0)) {
+		if (!_set_destination(p_template, to_ip)) {
 			DEBUG_PUTS("ARP lookup failed");
+			metric_inc(&s_metric_tx_errors);
 			return -2;
 		}
 	}
 
+	size = MIN(UDP_DATA_SIZE_MAX, size);
+
+	struct t_udp *p_udp = (struct t_udp *) emac_eth_send_get_dma_buffer();
+
+	h3_memcpy(p_udp, &p_template->headers, UDP_PACKET_HEADERS_SIZE);
+
 	//IPv4
-	s_send_packet.ip4.id = s_id;
-	s_send_packet.ip4.len = __builtin_bswap16(size + IPv4_UDP_HEADERS_SIZE);
-	s_send_packet.ip4.chksum = 0;
-	s_send_packet.ip4.chksum = net_chksum((void *) &s_send_packet.ip4, (uint32_t) sizeof(s_send_packet.ip4));
+	p_udp->ip4.id = s_id;
+	p_udp->ip4.len = __builtin_bswap16(size + IPv4_UDP_HEADERS_SIZE);
+	p_udp->ip4.chksum = net_chksum((void *) &p_udp->ip4, (uint32_t) sizeof(p_udp->ip4));
 
 	//UDP
-	s_send_packet.udp.source_port = __builtin_bswap16(s_ports_allowed[idx]);
-	s_send_packet.udp.destination_port = __builtin_bswap16(remote_port);
-	s_send_packet.udp.len = __builtin_bswap16(size + UDP_HEADER_SIZE);
-
-	h3_memcpy(s_send_packet.udp.data, packet, MIN(FRAME_BUFFER_SIZE, size));
+	p_udp->udp.destination_port = __builtin_bswap16(remote_port);
+	p_udp->udp.len = __builtin_bswap16(size + UDP_HEADER_SIZE);
 
-	// debug_dump( &s_send_packet, size + UDP_PACKET_HEADERS_SIZE);
+	// debug_dump(p_udp, size + UDP_PACKET_HEADERS_SIZE);
 
-	emac_eth_send((void *) &s_send_packet, size + UDP_PACKET_HEADERS_SIZE);
+	emac_eth_send_dma_buffer(size + UDP_PACKET_HEADERS_SIZE);
 
 	s_id++;
 
+	metric_inc(&s_metric_tx_packets);
+
 	return 0;
 }
 
+int udp_send(uint8_t idx, const uint8_t *packet, uint16_t size, uint32_t to_ip, uint16_t remote_port) {
+	h3_memcpy(udp_get_send_buffer(), packet, MIN(UDP_DATA_SIZE_MAX, size));
+
+	return udp_send_buffer(idx, size, to_ip, remote_port);
+}
+
 // <---
@@ -2,7 +2,7 @@
  * @file h3_i2c.c
  *
  */
-/* Copyright (C) 2018 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2018-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -24,6 +24,7 @@
  */
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <assert.h>
 #ifndef NDEBUG
  #include <stdio.h>
@@ -37,6 +38,10 @@
 
 #include "h3_board.h"
 
+#include "arm/arm.h"
+#include "arm/synchronize.h"
+#include "arm/gic.h"
+
 static uint8_t s_slave_address;
 static uint32_t s_current_baudrate;
 
@@ -362,6 +367,208 @@ static int _write(char *buffer, int len) {
 	return ret0;
 }
 
+/*
+ * Asynchronous write queue
+ *
+ * The transactions are advanced by a state machine driven by the TWI INT_FLAG.
+ * It is serviced either from the main loop with h3_i2c_async_run(), which
+ * polls for at most the given number of microseconds, or, when the
+ * application IRQ handler dispatches the TWI interrupt, from
+ * h3_i2c_async_irq_handler(). The blocking API drains the queue first.
+ */
+
+typedef enum I2C_ASYNC_STATE {
+	I2C_ASYNC_STATE_IDLE = 0,
+	I2C_ASYNC_STATE_START,
+	I2C_ASYNC_STATE_DATA
+} i2c_async_state_t;
+
+#define ASYNC_STOP_TIMEOUT		0xff
+#define ASYNC_DRAIN_TIMEOUT_US	(100 * 1000)
+
+struct i2c_async_transaction {
+	uint8_t address;
+	uint32_t length;
+	uint8_t data[H3_I2C_ASYNC_DATA_MAX];
+};
+
+static struct i2c_async_transaction s_async_queue[H3_I2C_ASYNC_QUEUE_SIZE] __attribute__((aligned(4)));
+static volatile uint32_t s_async_head;	// Next free entry
+static volatile uint32_t s_async_tail;	// Entry in progress
+static volatile i2c_async_state_t s_async_state;
+static uint32_t s_async_index;
+static uint32_t s_async_errors;
+static bool s_async_irq;
+
+static void _async_start(void) {
+	EXT_I2C->EFR = 0;
+	EXT_I2C->SRST = 1;
+	EXT_I2C->CTL |= CTL_M_STA;
+	s_async_state = I2C_ASYNC_STATE_START;
+}
+
+/*
+ * A STOP condition does not raise INT_FLAG, so wait for it here (a few bit
+ * times) and start the next queued transaction right away.
+ */
+static void _async_stop(bool is_error) {
+	int32_t time = ASYNC_STOP_TIMEOUT;
+
+	EXT_I2C->CTL |= CTL_M_STP;
+
+	while ((time--) && (EXT_I2C->CTL & CTL_M_STP))
+		;
+
+	if (is_error || (time <= 0)) {
+		s_async_errors++;
+	}
+
+	s_async_tail = (s_async_tail + 1) & (H3_I2C_ASYNC_QUEUE_SIZE - 1);
+
+	if (s_async_tail != s_async_head) {
+		_async_start();
+	} else {
+		s_async_state = I2C_ASYNC_STATE_IDLE;
+	}
+}
+
+static void _async_step(void) {
+	if (s_async_state == I2C_ASYNC_STATE_IDLE) {
+		if (s_async_tail != s_async_head) {
+			_async_start();
+		}
+		return;
+	}
+
+	if ((EXT_I2C->CTL & CTL_INT_FLAG) == 0) {
+		return;
+	}
+
+	const struct i2c_async_transaction *t = &s_async_queue[s_async_tail];
+	const uint32_t stat = EXT_I2C->STAT;
+
+	if (s_async_state == I2C_ASYNC_STATE_START) {
+		if (stat != STAT_START_TRANSMIT) {
+			_async_stop(true);
+			return;
+		}
+
+		EXT_I2C->DATA = (uint32_t) (t->address << 1) | I2C_MODE_WRITE;
+		EXT_I2C->CTL |= CTL_INT_FLAG;
+
+		s_async_index = 0;
+		s_async_state = I2C_ASYNC_STATE_DATA;
+		return;
+	}
+
+	// I2C_ASYNC_STATE_DATA
+	if ((stat != STAT_ADDRWRITE_ACK) && (stat != STAT_DATAWRITE_ACK)) {
+		_async_stop(true);
+		return;
+	}
+
+	if (s_async_index < t->length) {
+		EXT_I2C->DATA = t->data[s_async_index++];
+		EXT_I2C->CTL |= CTL_INT_FLAG;
+		return;
+	}
+
+	_async_stop(false);
+}
+
+static void _async_drain(void) {
+	const uint32_t micros = H3_TIMER->AVS_CNT1;
+
+	while ((s_async_state != I2C_ASYNC_STATE_IDLE) || (s_async_tail != s_async_head)) {
+		if (!s_async_irq) {
+			_async_step();
+		}
+
+		if ((H3_TIMER->AVS_CNT1 - micros) > ASYNC_DRAIN_TIMEOUT_US) {
+			DEBUG_PUTS("I2C async drain timeout");
+			EXT_I2C->CTL = CTL_BUS_EN | (s_async_irq ? CTL_INT_EN : 0);
+			s_async_tail = s_async_head;
+			s_async_state = I2C_ASYNC_STATE_IDLE;
+			s_async_errors++;
+			return;
+		}
+	}
+}
+
+bool h3_i2c_async_write(const char *buffer, uint32_t data_length) {
+	assert(buffer != 0);
+	assert(data_length <= H3_I2C_ASYNC_DATA_MAX);
+
+	const uint32_t next = (s_async_head + 1) & (H3_I2C_ASYNC_QUEUE_SIZE - 1);
+
+	if ((next == s_async_tail) || (data_length > H3_I2C_ASYNC_DATA_MAX)) {
+		return false;
+	}
+
+	struct i2c_async_transaction *t = &s_async_queue[s_async_head];
+
+	t->address = s_slave_address;
+	t->length = data_length;
+
+	uint32_t i;
+
+	for (i = 0; i < data_length; i++) {
+		t->data[i] = (uint8_t) buffer[i];
+	}
+
+	dmb();
+	s_async_head = next;
+
+	if (s_async_irq) {
+		__disable_irq();
+		if (s_async_state == I2C_ASYNC_STATE_IDLE) {
+			_async_start();
+		}
+		__enable_irq();
+	} else {
+		_async_step();
+	}
+
+	return true;
+}
+
+void h3_i2c_async_run(uint32_t budget_us) {
+	if (s_async_irq) {
+		return;
+	}
+
+	const uint32_t micros = H3_TIMER->AVS_CNT1;
+
+	do {
+		_async_step();
+	} while (((s_async_state != I2C_ASYNC_STATE_IDLE) || (s_async_tail != s_async_head)) && ((H3_TIMER->AVS_CNT1 - micros) < budget_us));
+}
+
+void h3_i2c_async_irq_handler(void) {
+	_async_step();
+}
+
+void h3_i2c_async_set_irq(bool enable) {
+	_async_drain();
+
+	s_async_irq = enable;
+
+	if (enable) {
+		gic_irq_config(H3_TWI0_IRQn + EXT_I2C_NUMBER, GIC_CORE0);
+		EXT_I2C->CTL |= CTL_INT_EN;
+	} else {
+		EXT_I2C->CTL &= ~CTL_INT_EN;
+	}
+}
+
+bool h3_i2c_async_is_idle(void) {
+	return (s_async_state == I2C_ASYNC_STATE_IDLE) && (s_async_tail == s_async_head);
+}
+
+uint32_t h3_i2c_async_get_errors(void) {
+	return s_async_errors;
+}
+
 void h3_i2c_begin(void) {
 	h3_gpio_fsel(EXT_I2C_SCL, ALT_FUNCTION_SCK);
 	h3_gpio_fsel(EXT_I2C_SDA, ALT_FUNCTION_SDA);
@@ -415,6 +622,8 @@ void h3_i2c_end(void) {
 }
 
 uint8_t h3_i2c_write(/*@null@*/const char *buffer, uint32_t data_length) {
+	_async_drain();
+
 	const int32_t ret = _write((char *)buffer, (int) data_length);
 #ifndef NDEBUG
 	if (ret) {
@@ -425,6 +634,8 @@ uint8_t h3_i2c_write(/*@null@*/const char *buffer, uint32_t data_length) {
 }
 
 uint8_t h3_i2c_read(/*@out@*/char *buffer, uint32_t data_length) {
+	_async_drain();
+
 	const int32_t ret = _read(buffer, (int) data_length);
 #ifndef NDEBUG
 	if (ret) {
@@ -438,6 +649,7 @@ void h3_i2c_set_baudrate(uint32_t baudrate) {
 	assert(baudrate <= H3_I2C_FULL_SPEED);
 
 	if (__builtin_expect((s_current_baudrate != baudrate),0)) {
+		_async_drain();
 		s_current_baudrate = baudrate;
 		_set_clock((uint32_t) H3_F_24M, baudrate);
 	}
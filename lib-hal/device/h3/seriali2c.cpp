@@ -33,6 +33,8 @@
 
 #include "debug.h"
 
+#define I2C_RUN_BUDGET_US	100
+
 void Serial::SetI2cAddress(uint8_t nAddress) {
 	DEBUG_PRINTF("nAddress=%.x", nAddress);
 
@@ -67,3 +69,26 @@ void Serial::SendI2c(const uint8_t *pData, uint32_t nLength) {
 
 	DEBUG_EXIT
 }
+
+/*
+ * Queued transmit, handed over to the H3 TWI transaction queue
+ */
+
+void Serial::RunI2c(void) {
+	uint32_t nLength;
+	const uint8_t *p;
+
+	while ((p = TxPeek(nLength)) != 0) {
+		h3_i2c_set_slave_address(m_I2cConfiguration.nAddress);
+
+		if (nLength > H3_I2C_ASYNC_DATA_MAX) {
+			h3_i2c_write(reinterpret_cast<const char*>(p), nLength);
+		} else if (!h3_i2c_async_write(reinterpret_cast<const char*>(p), nLength)) {
+			break;
+		}
+
+		TxConsume(nLength);
+	}
+
+	h3_i2c_async_run(I2C_RUN_BUDGET_US);
+}
@@ -25,6 +25,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 
 #include "serial.h"
@@ -33,6 +34,9 @@
 
 #include "debug.h"
 
+static const uint8_t *s_pDmaBuffer;
+static uint32_t s_nDmaBufferSize;
+
 void Serial::SetSpiSpeedHz(uint32_t nSpeedHz) {
 	DEBUG_PRINTF("nSpeedHz=%d", nSpeedHz);
 
@@ -62,6 +66,9 @@ bool Serial::InitSpi(void) {
 	h3_spi_chipSelect(H3_SPI_CS0);
 	h3_spi_setDataMode(static_cast<h3_spi_mode_t>(m_SpiConfiguration.nMode));
 
+	s_pDmaBuffer = h3_spi_dma_tx_prepare(&s_nDmaBufferSize);
+	assert(s_nDmaBufferSize >= (SERIAL_TX_BUFFER_SIZE / 2));
+
 	DEBUG_EXIT
 	return true;
 }
@@ -69,7 +76,32 @@ bool Serial::InitSpi(void) {
 void Serial::SendSpi(const uint8_t *pData, uint32_t nLength) {
 	DEBUG_ENTRY
 
+	while (h3_spi_dma_tx_is_active()) {
+	}
+
 	h3_spi_writenb(reinterpret_cast<const char *>(pData), nLength);
 
 	DEBUG_EXIT
 }
+
+/*
+ * Queued transmit, one message per DMA transfer so that each message keeps its own chip select
+ */
+
+void Serial::RunSpi(void) {
+	if (h3_spi_dma_tx_is_active()) {
+		return;
+	}
+
+	uint32_t nLength;
+	const uint8_t *p = TxPeek(nLength);
+
+	if (p == 0) {
+		return;
+	}
+
+	memcpy(const_cast<uint8_t *>(s_pDmaBuffer), p, nLength);
+	h3_spi_dma_tx_start(s_pDmaBuffer, nLength);
+
+	TxConsume(nLength);
+}
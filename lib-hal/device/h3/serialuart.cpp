@@ -178,3 +178,66 @@ void Serial::SendUart(const uint8_t *pData, uint32_t nLength) {
 
 	DEBUG_EXIT
 }
+
+/*
+ * Queued transmit
+ */
+
+void Serial::FillUartFifo(void) {
+	uint32_t nLength;
+	const uint8_t *p;
+
+	while ((p = TxPeek(nLength)) != 0) {
+		const uint32_t nAvailable = 64 - H3_UART1->TFL;
+
+		if (nAvailable == 0) {
+			return;
+		}
+
+		if (nLength > nAvailable) {
+			nLength = nAvailable;
+		}
+
+		for (uint32_t i = 0; i < nLength; i++) {
+			H3_UART1->O00.THR = static_cast<uint32_t>(p[i]);
+		}
+
+		TxConsume(nLength);
+	}
+}
+
+void Serial::RunUart(void) {
+	if (m_bUartIrq) {
+		// The THR empty interrupt does the work
+		if (!IsTxIdle()) {
+			H3_UART1->O04.IER = UART_IER_ETBEI;
+		}
+		return;
+	}
+
+	FillUartFifo();
+}
+
+void Serial::SetUartIrq(bool bEnable) {
+	DEBUG_PRINTF("bEnable=%d", bEnable);
+
+	m_bUartIrq = bEnable;
+
+	if (!bEnable) {
+		H3_UART1->O04.IER = 0;
+	}
+}
+
+void Serial::UartIrqHandler(void) {
+	const uint32_t nIIR = H3_UART1->O08.IIR;	// Reading IIR clears the THR empty interrupt
+
+	if ((nIIR & 0x0F) != UART_IIR_IID_THRE) {
+		return;
+	}
+
+	FillUartFifo();
+
+	if (IsTxIdle()) {
+		H3_UART1->O04.IER = 0;
+	}
+}
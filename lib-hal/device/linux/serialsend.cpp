@@ -28,13 +28,31 @@
 
 #include "serial.h"
 
+#include "hardware.h"
+
 #include "debug.h"
 
+static serial_tx_hook_t s_pTxHook;
+
+static void wire(const uint8_t *pData, uint32_t nLength) {
+	if (s_pTxHook != 0) {
+		s_pTxHook(pData, nLength);
+		return;
+	}
+
+	debug_dump(const_cast<uint8_t *>(pData), nLength);
+}
+
+void Serial::SetTxHook(serial_tx_hook_t pTxHook) {
+	s_pTxHook = pTxHook;
+}
+
 void Serial::SendUart(const uint8_t *pData, uint32_t nLength) {
 	assert(pData != 0);
 	assert(nLength != 0);
 
 	DEBUG_PUTS("SendUart");
+	wire(pData, nLength);
 }
 
 void Serial::SendSpi(const uint8_t *pData, uint32_t nLength) {
@@ -42,6 +60,7 @@ void Serial::SendSpi(const uint8_t *pData, uint32_t nLength) {
 	assert(nLength != 0);
 
 	DEBUG_PUTS("SendSpi");
+	wire(pData, nLength);
 }
 
 void Serial::SendI2c(const uint8_t *pData, uint32_t nLength) {
@@ -49,4 +68,88 @@ void Serial::SendI2c(const uint8_t *pData, uint32_t nLength) {
 	assert(nLength != 0);
 
 	DEBUG_PUTS("SendI2c");
+	wire(pData, nLength);
+}
+
+/*
+ * Queued transmit. There is no hardware, the queue is drained at the configured wire speed.
+ */
+
+static uint32_t s_nMicrosPrevious;
+static uint64_t s_nRemainder;	///< Fraction of a byte, in bytes * 1000000
+static uint32_t s_nCredit;		///< Bytes the wire could have sent, an idle wire does not save up
+
+static void wire_credit(uint32_t nBytesPerSecond) {
+	const uint32_t nMicros = Hardware::Get()->Micros();
+	const uint64_t nTotal = s_nRemainder + static_cast<uint64_t>(nMicros - s_nMicrosPrevious) * nBytesPerSecond;
+	const uint32_t nBytes = static_cast<uint32_t>(nTotal / 1000000);
+
+	s_nMicrosPrevious = nMicros;
+	s_nRemainder = nTotal % 1000000;
+	s_nCredit = (s_nCredit + nBytes) > SERIAL_TX_BUFFER_SIZE ? SERIAL_TX_BUFFER_SIZE : (s_nCredit + nBytes);
+}
+
+void Serial::RunUart(void) {
+	wire_credit(m_UartConfiguration.nBaud / 10);
+
+	uint32_t nLength;
+	const uint8_t *p;
+
+	while ((s_nCredit != 0) && ((p = TxPeek(nLength)) != 0)) {
+		if (nLength > s_nCredit) {
+			nLength = s_nCredit;
+		}
+
+		wire(p, nLength);
+
+		TxConsume(nLength);
+		s_nCredit -= nLength;
+	}
+
+	if (IsTxIdle()) {
+		s_nCredit = 0;
+	}
+}
+
+void Serial::RunSpi(void) {
+	wire_credit(m_SpiConfiguration.nSpeed / 8);
+
+	uint32_t nLength;
+	const uint8_t *p;
+
+	while (((p = TxPeek(nLength)) != 0) && (nLength <= s_nCredit)) {
+		wire(p, nLength);
+
+		TxConsume(nLength);
+		s_nCredit -= nLength;
+	}
+
+	if (IsTxIdle()) {
+		s_nCredit = 0;
+	}
+}
+
+void Serial::RunI2c(void) {
+	wire_credit(m_I2cConfiguration.tMode == SERIAL_I2C_SPEED_MODE_NORMAL ? (100000 / 9) : (400000 / 9));
+
+	uint32_t nLength;
+	const uint8_t *p;
+
+	while (((p = TxPeek(nLength)) != 0) && (nLength <= s_nCredit)) {
+		wire(p, nLength);
+
+		TxConsume(nLength);
+		s_nCredit -= nLength;
+	}
+
+	if (IsTxIdle()) {
+		s_nCredit = 0;
+	}
+}
+
+void Serial::SetUartIrq(bool bEnable) {
+	DEBUG_PRINTF("bEnable=%d", bEnable);
+}
+
+void Serial::UartIrqHandler(void) {
 }
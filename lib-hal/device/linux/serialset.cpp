@@ -60,6 +60,8 @@ void Serial::SetUartStopBits(uint8_t nStopBits) {
  */
 void Serial::SetSpiSpeedHz(uint32_t nSpeedHz) {
 	DEBUG_PRINTF("nSpeedHz=%d", nSpeedHz);
+
+	m_SpiConfiguration.nSpeed = nSpeedHz;
 }
 
 void Serial::SetSpiMode(TSerialSpiModes tMode) {
@@ -75,6 +77,10 @@ void Serial::SetI2cAddress(uint8_t nAddress) {
 
 void Serial::SetI2cSpeedMode(TSerialI2cSpeedModes tSpeedMode) {
 	DEBUG_PRINTF("tSpeedMode=%.x", tSpeedMode);
+
+	if (tSpeedMode < SERIAL_I2C_SPEED_MODE_UNDEFINED) {
+		m_I2cConfiguration.tMode = tSpeedMode;
+	}
 }
 
 
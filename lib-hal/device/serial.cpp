@@ -25,6 +25,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 
 #include "serial.h"
@@ -33,7 +34,15 @@
 
 Serial *Serial::s_pThis = 0;
 
-Serial::Serial(void) : m_tType(SERIAL_TYPE_UART) {
+Serial::Serial(void) :
+	m_tType(SERIAL_TYPE_UART),
+	m_nTxHead(0),
+	m_nTxTail(0),
+	m_nTxQueueHead(0),
+	m_nTxQueueTail(0),
+	m_nTxOffset(0),
+	m_bUartIrq(false)
+{
 	DEBUG_ENTRY
 
 	assert(s_pThis == 0);
@@ -50,12 +59,20 @@ Serial::Serial(void) : m_tType(SERIAL_TYPE_UART) {
 	m_I2cConfiguration.nAddress = 0x30;
 	m_I2cConfiguration.tMode = SERIAL_I2C_SPEED_MODE_FAST;
 
+	m_pTxBuffer = new uint8_t[SERIAL_TX_BUFFER_SIZE];
+	assert(m_pTxBuffer != 0);
+
+	memset(&m_TxStats, 0, sizeof(struct TSerialTxStats));
+
 	DEBUG_EXIT
 }
 
 Serial::~Serial(void) {
 	DEBUG_ENTRY
 
+	delete[] m_pTxBuffer;
+	m_pTxBuffer = 0;
+
 	s_pThis = 0;
 
 	DEBUG_EXIT
@@ -65,6 +82,8 @@ void Serial::Send(const uint8_t *pData, uint32_t nLength) {
 	DEBUG_ENTRY
 	debug_dump(const_cast<uint8_t *>(pData), nLength);
 
+	Flush();
+
 	if (m_tType == SERIAL_TYPE_UART) {
 		SendUart(pData, nLength);
 	}
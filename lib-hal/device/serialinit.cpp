@@ -32,6 +32,8 @@
 bool Serial::Init(void) {
 	DEBUG_ENTRY
 
+	InitQueue();
+
 	if (m_tType == SERIAL_TYPE_UART) {
 		return InitUart();
 	}
@@ -0,0 +1,161 @@
+/**
+ * @file serialqueue.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "serial.h"
+
+#include "metrics.h"
+
+#include "debug.h"
+
+/*
+ * A ring of bytes with a ring of messages on top of it. A message is never split
+ * over the end of the byte ring, the remainder is skipped, so the backends always
+ * see one contiguous block per message. Queue() is the only producer, Run() or
+ * the UART interrupt the only consumer.
+ */
+
+static struct metric s_MetricQueued = METRIC_COUNTER("serial.tx.queued");
+static struct metric s_MetricDropped = METRIC_COUNTER("serial.tx.dropped");
+static struct metric s_MetricBytes = METRIC_COUNTER("serial.tx.bytes");
+
+void Serial::InitQueue(void) {
+	m_nTxHead = 0;
+	m_nTxTail = 0;
+	m_nTxQueueHead = 0;
+	m_nTxQueueTail = 0;
+	m_nTxOffset = 0;
+
+	metrics_register(&s_MetricQueued);
+	metrics_register(&s_MetricDropped);
+	metrics_register(&s_MetricBytes);
+}
+
+bool Serial::Queue(const uint8_t *pData, uint32_t nLength) {
+	assert(pData != 0);
+
+	if (nLength == 0) {
+		return true;
+	}
+
+	if (nLength > (SERIAL_TX_BUFFER_SIZE / 2)) {
+		Send(pData, nLength);
+		return true;
+	}
+
+	const uint32_t nOffset = m_nTxHead & (SERIAL_TX_BUFFER_SIZE - 1);
+	const uint32_t nPad = ((nOffset + nLength) > SERIAL_TX_BUFFER_SIZE) ? (SERIAL_TX_BUFFER_SIZE - nOffset) : 0;
+	const uint32_t nUsed = m_nTxHead - m_nTxTail;
+
+	if (((m_nTxQueueHead - m_nTxQueueTail) == SERIAL_TX_QUEUE_SIZE) || ((nUsed + nPad + nLength) > SERIAL_TX_BUFFER_SIZE)) {
+		m_TxStats.nDropped++;
+		metric_inc(&s_MetricDropped);
+		Run();
+		return false;
+	}
+
+	struct TSerialTxEntry *pEntry = &m_TxQueue[m_nTxQueueHead & (SERIAL_TX_QUEUE_SIZE - 1)];
+
+	pEntry->nOffset = static_cast<uint16_t>((nOffset + nPad) & (SERIAL_TX_BUFFER_SIZE - 1));
+	pEntry->nLength = static_cast<uint16_t>(nLength);
+	pEntry->nSize = static_cast<uint16_t>(nPad + nLength);
+
+	memcpy(&m_pTxBuffer[pEntry->nOffset], pData, nLength);
+
+	m_nTxHead = m_nTxHead + nPad + nLength;
+
+	__sync_synchronize();
+
+	m_nTxQueueHead = m_nTxQueueHead + 1;
+
+	m_TxStats.nQueued++;
+	metric_inc(&s_MetricQueued);
+
+	if ((nUsed + nPad + nLength) > m_TxStats.nHighWater) {
+		m_TxStats.nHighWater = nUsed + nPad + nLength;
+	}
+
+	Run();
+
+	return true;
+}
+
+const uint8_t *Serial::TxPeek(uint32_t &nLength) const {
+	if (m_nTxQueueHead == m_nTxQueueTail) {
+		nLength = 0;
+		return 0;
+	}
+
+	const struct TSerialTxEntry *pEntry = &m_TxQueue[m_nTxQueueTail & (SERIAL_TX_QUEUE_SIZE - 1)];
+
+	nLength = pEntry->nLength - m_nTxOffset;
+
+	return &m_pTxBuffer[pEntry->nOffset + m_nTxOffset];
+}
+
+void Serial::TxConsume(uint32_t nLength) {
+	const struct TSerialTxEntry *pEntry = &m_TxQueue[m_nTxQueueTail & (SERIAL_TX_QUEUE_SIZE - 1)];
+
+	assert(m_nTxQueueHead != m_nTxQueueTail);
+	assert((m_nTxOffset + nLength) <= pEntry->nLength);
+
+	m_nTxOffset += nLength;
+	metric_add(&s_MetricBytes, nLength);
+
+	if (m_nTxOffset == pEntry->nLength) {
+		m_nTxOffset = 0;
+		m_nTxTail = m_nTxTail + pEntry->nSize;
+
+		__sync_synchronize();
+
+		m_nTxQueueTail = m_nTxQueueTail + 1;
+		m_TxStats.nSent++;
+	}
+}
+
+void Serial::Run(void) {
+	if (m_tType == SERIAL_TYPE_UART) {
+		RunUart();
+		return;
+	}
+
+	if (m_tType == SERIAL_TYPE_SPI) {
+		RunSpi();
+		return;
+	}
+
+	if (m_tType == SERIAL_TYPE_I2C) {
+		RunI2c();
+	}
+}
+
+void Serial::Flush(void) {
+	while (!IsTxIdle()) {
+		Run();
+	}
+}
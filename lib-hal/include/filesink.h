@@ -0,0 +1,62 @@
+/**
+ * @file filesink.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FILESINK_H_
+#define FILESINK_H_
+
+/*
+ * Write-only files for recording.
+ *
+ * A sink has its own file object, so it does not share the single FIL of the
+ * stdio (posix/file.c) implementation with the showfile playback and TFTP.
+ * There is no buffering here, the caller writes whole blocks.
+ * filesink_sync() updates the directory entry, so a recording survives a
+ * power cycle up to the last sync.
+ *
+ * The backend is FatFs (ff12c) on bare metal and POSIX file I/O on Linux.
+ * With a read-only FatFs configuration filesink_open() fails with EROFS.
+ */
+
+#include <stdint.h>
+
+#define FILESINK_MAX_OPEN	2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Creates or truncates the file, returns the sink index or -1 (errno is set)
+ */
+extern int filesink_open(const char *path);
+extern int32_t filesink_write(int index, const void *buffer, uint32_t length);
+extern int filesink_sync(int index);
+extern int filesink_close(int index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FILESINK_H_ */
@@ -0,0 +1,84 @@
+/**
+ * @file filestream.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FILESTREAM_H_
+#define FILESTREAM_H_
+
+/*
+ * Buffered read-only streams for playback.
+ *
+ * Each stream has two blocks of FILESTREAM_BLOCK_SIZE bytes. The block being
+ * consumed is the active block, the other one is filled ahead with
+ * filestream_prefetch(), typically called while the player is waiting for
+ * the next frame. When the active block is consumed and the next one was
+ * prefetched, the switch costs no I/O. Otherwise the read is done in place
+ * and counted as a stall.
+ *
+ * The blocks are read at block aligned file offsets, so the FatFs backend
+ * transfers whole sectors directly into the buffer (multi-sector read).
+ *
+ * The backend is FatFs (ff12c) on bare metal and POSIX file I/O on Linux.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define FILESTREAM_MAX_OPEN		4
+#define FILESTREAM_BLOCK_SIZE	(8 * 512)	///< Must be a multiple of the sector size
+
+struct filestream;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern /*@null@*/struct filestream *filestream_open(const char *path);
+extern int filestream_close(struct filestream *);
+
+extern int filestream_getc(struct filestream *);
+extern /*@null@*/char *filestream_gets(char *s, int size, struct filestream *);
+extern size_t filestream_read(void *ptr, size_t size, struct filestream *);
+
+extern int filestream_seek(struct filestream *, uint32_t offset);
+extern uint32_t filestream_tell(const struct filestream *);
+extern bool filestream_eof(const struct filestream *);
+
+extern bool filestream_prefetch(struct filestream *);
+
+/*
+ * Backend, one file per stream index below FILESTREAM_MAX_OPEN
+ */
+
+extern int filestream_source_open(uint32_t index, const char *path);
+extern int32_t filestream_source_read(uint32_t index, uint8_t *buffer, uint32_t length);
+extern int filestream_source_seek(uint32_t index, uint32_t offset);
+extern int filestream_source_close(uint32_t index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FILESTREAM_H_ */
@@ -26,6 +26,9 @@
 #ifndef HAL_I2C_H_
 #define HAL_I2C_H_
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #if defined(__linux__)
  #include "bcm2835.h"
 #elif defined(H3)
@@ -55,4 +58,26 @@ enum {
  #define FUNC_PREFIX(x) bcm2835_##x
 #endif
 
+/*
+ * Queued write, returns false when the queue is full.
+ * Without an asynchronous driver it is a blocking write.
+ */
+#if defined(H3)
+	inline static bool i2c_write_async(const char *data, uint32_t length) {
+		return h3_i2c_async_write(data, length);
+	}
+
+	inline static void i2c_async_run(uint32_t budget_us) {
+		h3_i2c_async_run(budget_us);
+	}
+#else
+	inline static bool i2c_write_async(const char *data, uint32_t length) {
+		(void) FUNC_PREFIX(i2c_write(data, length));
+		return true;
+	}
+
+	inline static void i2c_async_run(__attribute__((unused)) uint32_t budget_us) {
+	}
+#endif
+
 #endif /* HAL_I2C_H_ */
@@ -0,0 +1,100 @@
+/**
+ * @file metrics.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * The metrics are statically initialized objects, linked into the registry
+ * with metrics_register() during initialization. Updating a metric is a plain
+ * memory operation, there is no allocation and no lookup.
+ */
+
+typedef enum METRIC_TYPE {
+	METRIC_TYPE_COUNTER = 0,
+	METRIC_TYPE_GAUGE,
+	METRIC_TYPE_HISTOGRAM
+} metric_type_t;
+
+#define METRIC_HISTOGRAM_BUCKETS	8	///< The last bucket has no upper bound
+
+struct metric {
+	const char *name;
+	metric_type_t type;
+	uint32_t value;							///< Counter, gauge or number of histogram samples
+	uint32_t sum;							///< Histogram only
+	const uint32_t *bounds;					///< Histogram only, METRIC_HISTOGRAM_BUCKETS - 1 upper bounds
+	uint32_t buckets[METRIC_HISTOGRAM_BUCKETS];
+	struct metric *next;
+	bool is_registered;
+};
+
+#define METRIC_COUNTER(n)			{ (n), METRIC_TYPE_COUNTER, 0, 0, 0, {0}, 0, false }
+#define METRIC_GAUGE(n)				{ (n), METRIC_TYPE_GAUGE, 0, 0, 0, {0}, 0, false }
+#define METRIC_HISTOGRAM(n, b)		{ (n), METRIC_TYPE_HISTOGRAM, 0, 0, (b), {0}, 0, false }
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern void metrics_register(struct metric *);
+extern /*@null@*/struct metric *metrics_get_first(void);
+extern uint32_t metrics_get_count(void);
+extern void metrics_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+inline static void metric_inc(struct metric *m) {
+	m->value++;
+}
+
+inline static void metric_add(struct metric *m, uint32_t n) {
+	m->value += n;
+}
+
+inline static void metric_set(struct metric *m, uint32_t v) {
+	m->value = v;
+}
+
+inline static void metric_observe(struct metric *m, uint32_t v) {
+	uint32_t i;
+
+	for (i = 0; i < (METRIC_HISTOGRAM_BUCKETS - 1); i++) {
+		if (v <= m->bounds[i]) {
+			break;
+		}
+	}
+
+	m->buckets[i]++;
+	m->value++;
+	m->sum += v;
+}
+
+#endif /* METRICS_H_ */
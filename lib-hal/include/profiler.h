@@ -0,0 +1,183 @@
+/**
+ * @file profiler.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+/*
+ * Build with ENABLE_PROFILER in the firmware DEFINES to enable the probes.
+ * Without it, all the PROFILE_* macros expand to nothing.
+ *
+ * The time base is the 32-bit CPU cycle counter (PMU) on bare metal and
+ * the 64-bit CLOCK_MONOTONIC (in nanoseconds) on Linux, so that a probe
+ * on Linux does not wrap after 4.29 s.
+ *
+ * Usage:
+ *
+ *  PROFILER_INIT();
+ *  PROFILER_SECTION(s_profileNetwork, "nw.Run");
+ *
+ *  for (;;) {
+ *    PROFILE_LOOP();
+ *    PROFILE_BEGIN(s_profileNetwork);
+ *    nw.Run();
+ *    PROFILE_END(s_profileNetwork);
+ *    ...
+ *  }
+ *
+ *  void fiq_handler(void) {
+ *    PROFILE_ISR_ENTER(s_profileFiq);
+ *    ...
+ *    PROFILE_ISR_EXIT(s_profileFiq);
+ *  }
+ *
+ * In C++ a probe can also be scoped: { PROFILE_SCOPE("node.Run"); node.Run(); }
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PROFILER_HISTOGRAM_BUCKETS	16	///< log2 of the duration in microseconds, the last bucket has no upper bound
+#define PROFILER_RING_SIZE			64	///< Most recent samples, must be a power of 2
+
+#if defined (__linux__) || defined (__APPLE__)
+ typedef uint64_t profiler_ticks_t;
+# define PROFILER_TICKS_MAX			UINT64_MAX
+#else
+ typedef uint32_t profiler_ticks_t;
+# define PROFILER_TICKS_MAX			UINT32_MAX
+#endif
+
+struct profiler_section {
+	const char *name;
+	uint32_t count;
+	profiler_ticks_t min;							///< ticks
+	profiler_ticks_t max;							///< ticks
+	uint64_t total;								///< ticks
+	uint32_t buckets[PROFILER_HISTOGRAM_BUCKETS];
+	struct profiler_section *next;
+	bool is_isr;
+	bool is_registered;
+};
+
+struct profiler_sample {
+	const struct profiler_section *section;
+	profiler_ticks_t ticks;
+};
+
+#define PROFILER_SECTION_INIT(n, isr)	{ (n), 0, PROFILER_TICKS_MAX, 0, 0, {0}, 0, (isr), false }
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern void profiler_init(void);
+extern void profiler_reset(void);
+extern void profiler_record(struct profiler_section *, profiler_ticks_t);
+
+extern /*@null@*/const struct profiler_section *profiler_get_first(void);
+extern const struct profiler_section *profiler_get_loop(void);
+extern uint32_t profiler_get_ticks_per_us(void);
+extern void profiler_get_ring(const struct profiler_sample **, uint32_t *);
+
+extern uint32_t profiler_format(const struct profiler_section *, char *, uint32_t);
+extern void profiler_dump(void);
+
+extern void profiler_loop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if defined (__linux__) || defined (__APPLE__)
+# include <time.h>
+
+inline static profiler_ticks_t profiler_ticks(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	const uint64_t sec = ts.tv_sec;
+	const uint64_t nsec = ts.tv_nsec;
+	return (sec * 1000000000ULL) + nsec;
+}
+#elif (__ARM_ARCH >= 7)
+inline static profiler_ticks_t profiler_ticks(void) {
+	uint32_t ccnt;
+	asm volatile ("mrc p15, 0, %0, c9, c13, 0" : "=r" (ccnt));	// PMCCNTR
+	return ccnt;
+}
+#else
+inline static profiler_ticks_t profiler_ticks(void) {
+	uint32_t ccnt;
+	asm volatile ("mrc p15, 0, %0, c15, c12, 1" : "=r" (ccnt));	// ARM1176 CCR
+	return ccnt;
+}
+#endif
+
+#if defined (ENABLE_PROFILER)
+# define PROFILER_SECTION(v, n)		static struct profiler_section v = PROFILER_SECTION_INIT(n, false)
+# define PROFILER_ISR_SECTION(v, n)	static struct profiler_section v = PROFILER_SECTION_INIT(n, true)
+# define PROFILE_BEGIN(v)			const profiler_ticks_t v##_nBegin = profiler_ticks()
+# define PROFILE_END(v)				profiler_record(&(v), profiler_ticks() - v##_nBegin)
+# define PROFILE_ISR_ENTER(v)		PROFILE_BEGIN(v)
+# define PROFILE_ISR_EXIT(v)		PROFILE_END(v)
+# define PROFILE_LOOP()				profiler_loop()
+# define PROFILER_INIT()			profiler_init()
+#else
+# define PROFILER_SECTION(v, n)
+# define PROFILER_ISR_SECTION(v, n)
+# define PROFILE_BEGIN(v)
+# define PROFILE_END(v)
+# define PROFILE_ISR_ENTER(v)
+# define PROFILE_ISR_EXIT(v)
+# define PROFILE_LOOP()
+# define PROFILER_INIT()
+#endif
+
+#ifdef __cplusplus
+# if defined (ENABLE_PROFILER)
+class ProfilerScope {
+public:
+	ProfilerScope(struct profiler_section *pSection): m_pSection(pSection), m_nBegin(profiler_ticks()) {
+	}
+
+	~ProfilerScope(void) {
+		profiler_record(m_pSection, profiler_ticks() - m_nBegin);
+	}
+
+private:
+	struct profiler_section *m_pSection;
+	profiler_ticks_t m_nBegin;
+};
+
+#  define PROFILER_CONCAT_(a, b)	a##b
+#  define PROFILER_CONCAT(a, b)		PROFILER_CONCAT_(a, b)
+#  define PROFILE_SCOPE(n)			static struct profiler_section PROFILER_CONCAT(s_profile, __LINE__) = PROFILER_SECTION_INIT(n, false); \
+									ProfilerScope PROFILER_CONCAT(profilerScope, __LINE__)(&PROFILER_CONCAT(s_profile, __LINE__))
+# else
+#  define PROFILE_SCOPE(n)
+# endif
+#endif
+
+#endif /* PROFILER_H_ */
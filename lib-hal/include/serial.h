@@ -55,6 +55,20 @@ enum TSerialI2cSpeedModes {
 	SERIAL_I2C_SPEED_MODE_UNDEFINED
 };
 
+enum {
+	SERIAL_TX_BUFFER_SIZE = 4096,	///< Must be a power of 2
+	SERIAL_TX_QUEUE_SIZE = 64		///< Must be a power of 2
+};
+
+typedef void (*serial_tx_hook_t)(const uint8_t *pData, uint32_t nLength);
+
+struct TSerialTxStats {
+	uint32_t nQueued;		///< Messages accepted by Queue()
+	uint32_t nSent;			///< Messages handed over to the hardware
+	uint32_t nDropped;		///< Messages rejected because the queue was full
+	uint32_t nHighWater;	///< Maximum number of bytes in use
+};
+
 class Serial {
 public:
 	Serial(void);
@@ -62,7 +76,7 @@ public:
 
 	void SetType(TSerialTypes tType = SERIAL_TYPE_UART) {
 		if (tType < SERIAL_TYPE_UNDEFINED) {
-			m_tType = SERIAL_TYPE_UART;
+			m_tType = tType;
 		}
 	}
 	TSerialTypes GetType(void) {
@@ -94,10 +108,41 @@ public:
 	void Print(void);
 
 	/*
-	 * Send the data
+	 * Send the data, blocking. Queued data is sent first.
 	 */
 	void Send(const uint8_t *pData, uint32_t nLength);
 
+	/*
+	 * Queued transmit, returns at once. Each call is one message (one SPI chip select,
+	 * one I2C transaction). Returns false when the queue is full, the message is dropped.
+	 * Run() moves queued data to the hardware without waiting.
+	 */
+	bool Queue(const uint8_t *pData, uint32_t nLength);
+	void Run(void);
+	void Flush(void);
+
+	bool IsTxIdle(void) const {
+		return m_nTxQueueHead == m_nTxQueueTail;
+	}
+
+	const struct TSerialTxStats *GetTxStats(void) const {
+		return &m_TxStats;
+	}
+
+	/*
+	 * UART only. Only enable the interrupt when the application IRQ handler
+	 * calls UartIrqHandler() for H3_UART1_IRQn.
+	 */
+	void SetUartIrq(bool bEnable);
+	void UartIrqHandler(void);
+
+#if defined (__linux__)
+	/*
+	 * There is no hardware, the bytes put on the (simulated) wire are passed to the hook
+	 */
+	void SetTxHook(serial_tx_hook_t pTxHook);
+#endif
+
 	static const char *GetType(TSerialTypes tType);
 	static enum TSerialTypes GetType(const char *pType);
 
@@ -121,6 +166,14 @@ private:
 	bool InitI2c(void);
 	void SendI2c(const uint8_t *pData, uint32_t nLength);
 
+	void InitQueue(void);
+	const uint8_t *TxPeek(uint32_t &nLength) const;
+	void TxConsume(uint32_t nLength);
+	void RunUart(void);
+	void RunSpi(void);
+	void RunI2c(void);
+	void FillUartFifo(void);
+
 private:
 	enum TSerialTypes m_tType;
 	struct {
@@ -138,6 +191,22 @@ private:
 		TSerialI2cSpeedModes tMode;
 	} m_I2cConfiguration;
 
+	struct TSerialTxEntry {
+		uint16_t nOffset;
+		uint16_t nLength;
+		uint16_t nSize;		///< nLength plus the padding skipped at the end of the buffer
+	};
+
+	uint8_t *m_pTxBuffer;
+	struct TSerialTxEntry m_TxQueue[SERIAL_TX_QUEUE_SIZE];
+	volatile uint32_t m_nTxHead;		///< Bytes, free running
+	volatile uint32_t m_nTxTail;
+	volatile uint32_t m_nTxQueueHead;	///< Messages, free running
+	volatile uint32_t m_nTxQueueTail;
+	uint32_t m_nTxOffset;				///< Bytes of the oldest message already handed over
+	struct TSerialTxStats m_TxStats;
+	bool m_bUartIrq;
+
 	static Serial *s_pThis;
 };
 
@@ -0,0 +1,333 @@
+/**
+ * @file filestream.c
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+
+#include "filestream.h"
+
+#include "metrics.h"
+
+#include "debug.h"
+
+#if (FILESTREAM_BLOCK_SIZE & (FILESTREAM_BLOCK_SIZE - 1)) != 0
+ #error FILESTREAM_BLOCK_SIZE must be a power of 2
+#endif
+
+struct filestream {
+	uint8_t *block[2];
+	uint32_t block_offset[2];		///< File offset of the block
+	uint32_t block_length[2];		///< Valid bytes, less than FILESTREAM_BLOCK_SIZE at the end of the file
+	uint32_t source_offset;			///< File offset of the backend
+	uint32_t active;
+	uint32_t position;				///< Read position in the active block
+	uint32_t index;
+	bool is_next_valid;				///< The other block holds the block following the active one
+	bool is_open;
+};
+
+static struct filestream s_streams[FILESTREAM_MAX_OPEN];
+static uint8_t s_blocks[FILESTREAM_MAX_OPEN][2][FILESTREAM_BLOCK_SIZE] __attribute__((aligned(64)));
+
+static struct metric s_metric_reads = METRIC_COUNTER("filestream.reads");
+static struct metric s_metric_prefetches = METRIC_COUNTER("filestream.prefetches");
+static struct metric s_metric_stalls = METRIC_COUNTER("filestream.stalls");
+static struct metric s_metric_errors = METRIC_COUNTER("filestream.errors");
+
+static void load(struct filestream *fs, uint32_t which, uint32_t offset) {
+	int32_t bytes_read;
+
+	assert((offset & (FILESTREAM_BLOCK_SIZE - 1)) == 0);
+
+	fs->block_offset[which] = offset;
+	fs->block_length[which] = 0;
+
+	if (fs->source_offset != offset) {
+		if (filestream_source_seek(fs->index, offset) != 0) {
+			metric_inc(&s_metric_errors);
+			return;
+		}
+		fs->source_offset = offset;
+	}
+
+	bytes_read = filestream_source_read(fs->index, fs->block[which], FILESTREAM_BLOCK_SIZE);
+
+	metric_inc(&s_metric_reads);
+
+	if (bytes_read < 0) {
+		metric_inc(&s_metric_errors);
+		fs->source_offset = (uint32_t) ~0;	// Unknown, seek before the next read
+		return;
+	}
+
+	fs->block_length[which] = (uint32_t) bytes_read;
+	fs->source_offset += (uint32_t) bytes_read;
+}
+
+/*
+ * The active block is consumed
+ */
+static bool refill(struct filestream *fs) {
+	const uint32_t active = fs->active;
+
+	if (fs->block_length[active] < FILESTREAM_BLOCK_SIZE) {
+		return false;	// End of file
+	}
+
+	if (fs->is_next_valid) {
+		fs->active = active ^ 1;
+		fs->is_next_valid = false;
+	} else {
+		metric_inc(&s_metric_stalls);
+		load(fs, active, fs->block_offset[active] + FILESTREAM_BLOCK_SIZE);
+	}
+
+	fs->position = 0;
+
+	return fs->block_length[fs->active] != 0;
+}
+
+struct filestream *filestream_open(const char *path) {
+	struct filestream *fs = NULL;
+	uint32_t i;
+
+	assert(path != NULL);
+
+	metrics_register(&s_metric_reads);
+	metrics_register(&s_metric_prefetches);
+	metrics_register(&s_metric_stalls);
+	metrics_register(&s_metric_errors);
+
+	for (i = 0; i < FILESTREAM_MAX_OPEN; i++) {
+		if (!s_streams[i].is_open) {
+			fs = &s_streams[i];
+			break;
+		}
+	}
+
+	if (fs == NULL) {
+		errno = EMFILE;
+		return NULL;
+	}
+
+	if (filestream_source_open(i, path) != 0) {
+		return NULL;
+	}
+
+	memset(fs, 0, sizeof(struct filestream));
+
+	fs->block[0] = s_blocks[i][0];
+	fs->block[1] = s_blocks[i][1];
+	fs->index = i;
+	fs->is_open = true;
+
+	load(fs, 0, 0);
+
+	DEBUG_PRINTF("%s [%u] %u", path, (unsigned) i, (unsigned) fs->block_length[0]);
+
+	return fs;
+}
+
+int filestream_close(struct filestream *fs) {
+	if (fs == NULL) {
+		return 0;
+	}
+
+	assert(fs->is_open);
+
+	fs->is_open = false;
+
+	return filestream_source_close(fs->index);
+}
+
+int filestream_getc(struct filestream *fs) {
+	assert(fs != NULL);
+
+	if ((fs->position == fs->block_length[fs->active]) && !refill(fs)) {
+		return -1;
+	}
+
+	return fs->block[fs->active][fs->position++];
+}
+
+/*
+ * As fgets(): at most size - 1 characters, the newline is stored
+ */
+char *filestream_gets(char *s, int size, struct filestream *fs) {
+	char *p = s;
+	uint32_t n;
+
+	assert(s != NULL);
+	assert(fs != NULL);
+
+	if (size <= 0) {
+		return NULL;
+	}
+
+	n = (uint32_t) (size - 1);
+
+	while (n != 0) {
+		const uint8_t *src;
+		const uint8_t *newline;
+		uint32_t available;
+
+		if ((fs->position == fs->block_length[fs->active]) && !refill(fs)) {
+			break;
+		}
+
+		src = &fs->block[fs->active][fs->position];
+		available = fs->block_length[fs->active] - fs->position;
+
+		if (available > n) {
+			available = n;
+		}
+
+		newline = (const uint8_t *) memchr(src, '\n', available);
+
+		if (newline != NULL) {
+			available = (uint32_t) (newline - src) + 1;
+		}
+
+		memcpy(p, src, available);
+
+		p += available;
+		fs->position += available;
+		n -= available;
+
+		if (newline != NULL) {
+			break;
+		}
+	}
+
+	if (p == s) {
+		*s = '\0';
+		return NULL;
+	}
+
+	*p = '\0';
+
+	return s;
+}
+
+size_t filestream_read(void *ptr, size_t size, struct filestream *fs) {
+	uint8_t *p = (uint8_t *) ptr;
+	size_t n = size;
+
+	assert(ptr != NULL);
+	assert(fs != NULL);
+
+	while (n != 0) {
+		uint32_t available;
+
+		if ((fs->position == fs->block_length[fs->active]) && !refill(fs)) {
+			break;
+		}
+
+		available = fs->block_length[fs->active] - fs->position;
+
+		if (available > n) {
+			available = (uint32_t) n;
+		}
+
+		memcpy(p, &fs->block[fs->active][fs->position], available);
+
+		p += available;
+		fs->position += available;
+		n -= available;
+	}
+
+	return size - n;
+}
+
+/*
+ * A seek within the loaded blocks does no I/O, for example rewinding a show that fits in one block.
+ */
+int filestream_seek(struct filestream *fs, uint32_t offset) {
+	const uint32_t block_offset = offset & (uint32_t) ~(FILESTREAM_BLOCK_SIZE - 1);
+	uint32_t active;
+
+	assert(fs != NULL);
+
+	active = fs->active;
+
+	if (block_offset == fs->block_offset[active]) {
+		// The following block, if any, stays valid
+	} else if (fs->is_next_valid && (block_offset == fs->block_offset[active ^ 1])) {
+		fs->active = active ^ 1;
+		fs->is_next_valid = false;
+	} else {
+		load(fs, active, block_offset);
+		fs->is_next_valid = false;
+	}
+
+	fs->position = offset - block_offset;
+
+	if (fs->position > fs->block_length[fs->active]) {
+		fs->position = fs->block_length[fs->active];
+		errno = EINVAL;
+		return -1;
+	}
+
+	return 0;
+}
+
+uint32_t filestream_tell(const struct filestream *fs) {
+	assert(fs != NULL);
+
+	return fs->block_offset[fs->active] + fs->position;
+}
+
+bool filestream_eof(const struct filestream *fs) {
+	assert(fs != NULL);
+
+	return (fs->position == fs->block_length[fs->active]) && (fs->block_length[fs->active] < FILESTREAM_BLOCK_SIZE);
+}
+
+/*
+ * Read the block following the active one, when not done already.
+ * Returns true when I/O was done.
+ */
+bool filestream_prefetch(struct filestream *fs) {
+	uint32_t active;
+
+	assert(fs != NULL);
+
+	active = fs->active;
+
+	if (fs->is_next_valid || (fs->block_length[active] < FILESTREAM_BLOCK_SIZE)) {
+		return false;
+	}
+
+	load(fs, active ^ 1, fs->block_offset[active] + FILESTREAM_BLOCK_SIZE);
+	fs->is_next_valid = true;
+
+	metric_inc(&s_metric_prefetches);
+
+	return true;
+}
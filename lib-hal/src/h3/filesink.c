@@ -0,0 +1,161 @@
+/**
+ * @file filesink.c
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <assert.h>
+
+#include "../../ff12c/ff.h"
+
+#include "filesink.h"
+
+/*
+ * FatFs backend, each sink has its own FIL
+ */
+
+static FIL s_file_objects[FILESINK_MAX_OPEN];
+static bool s_is_open[FILESINK_MAX_OPEN];
+
+#if (_FS_READONLY == 0)
+static int fresult_to_errno(FRESULT fresult) {
+	switch (fresult) {
+	case FR_OK:
+		return 0;
+	case FR_NO_PATH:
+		return ENOENT;
+	case FR_INVALID_NAME:
+	case FR_INVALID_OBJECT:
+		return EINVAL;
+	case FR_DENIED:
+		return ENOSPC;
+	case FR_WRITE_PROTECTED:
+		return EROFS;
+	case FR_NOT_READY:
+		return EBUSY;
+	default:
+		break;
+	}
+
+	return EIO;
+}
+
+int filesink_open(const char *path) {
+	int index;
+
+	for (index = 0; index < FILESINK_MAX_OPEN; index++) {
+		if (!s_is_open[index]) {
+			break;
+		}
+	}
+
+	if (index == FILESINK_MAX_OPEN) {
+		errno = EMFILE;
+		return -1;
+	}
+
+	const FRESULT fresult = f_open(&s_file_objects[index], (const TCHAR *) path, (BYTE) (FA_WRITE | FA_CREATE_ALWAYS));
+
+	errno = fresult_to_errno(fresult);
+
+	if (fresult != FR_OK) {
+		return -1;
+	}
+
+	s_is_open[index] = true;
+
+	return index;
+}
+
+int32_t filesink_write(int index, const void *buffer, uint32_t length) {
+	UINT bytes_written;
+
+	assert((index >= 0) && (index < FILESINK_MAX_OPEN));
+	assert(s_is_open[index]);
+
+	const FRESULT fresult = f_write(&s_file_objects[index], buffer, (UINT) length, &bytes_written);
+
+	errno = fresult_to_errno(fresult);
+
+	if (fresult != FR_OK) {
+		return -1;
+	}
+
+	// The volume is full
+	if (bytes_written != (UINT) length) {
+		errno = ENOSPC;
+	}
+
+	return (int32_t) bytes_written;
+}
+
+int filesink_sync(int index) {
+	assert((index >= 0) && (index < FILESINK_MAX_OPEN));
+	assert(s_is_open[index]);
+
+	const FRESULT fresult = f_sync(&s_file_objects[index]);
+
+	errno = fresult_to_errno(fresult);
+
+	return (fresult == FR_OK) ? 0 : -1;
+}
+
+int filesink_close(int index) {
+	assert((index >= 0) && (index < FILESINK_MAX_OPEN));
+	assert(s_is_open[index]);
+
+	const FRESULT fresult = f_close(&s_file_objects[index]);
+
+	s_is_open[index] = false;
+
+	errno = fresult_to_errno(fresult);
+
+	return (fresult == FR_OK) ? 0 : -1;
+}
+#else
+/*
+ * Firmware without SD_WRITE_SUPPORT
+ */
+
+int filesink_open(__attribute__((unused)) const char *path) {
+	errno = EROFS;
+	return -1;
+}
+
+int32_t filesink_write(__attribute__((unused)) int index, __attribute__((unused)) const void *buffer, __attribute__((unused)) uint32_t length) {
+	errno = EROFS;
+	return -1;
+}
+
+int filesink_sync(__attribute__((unused)) int index) {
+	errno = EROFS;
+	return -1;
+}
+
+int filesink_close(__attribute__((unused)) int index) {
+	errno = EROFS;
+	return -1;
+}
+#endif
@@ -0,0 +1,101 @@
+/**
+ * @file filestream.c
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <assert.h>
+
+#include "../../ff12c/ff.h"
+
+#include "filestream.h"
+
+/*
+ * FatFs backend. Reading a whole number of sectors at a sector aligned offset
+ * makes f_read() transfer directly into the buffer with a multi-sector disk_read().
+ */
+
+static FIL s_file_objects[FILESTREAM_MAX_OPEN];
+
+static int fresult_to_errno(FRESULT fresult) {
+	switch (fresult) {
+	case FR_OK:
+		return 0;
+	case FR_NO_FILE:
+	case FR_NO_PATH:
+		return ENOENT;
+	case FR_INVALID_NAME:
+	case FR_INVALID_OBJECT:
+		return EINVAL;
+	case FR_NOT_READY:
+		return EBUSY;
+	default:
+		break;
+	}
+
+	return EIO;
+}
+
+int filestream_source_open(uint32_t index, const char *path) {
+	assert(index < FILESTREAM_MAX_OPEN);
+
+	const FRESULT fresult = f_open(&s_file_objects[index], (const TCHAR *) path, (BYTE) FA_READ);
+
+	errno = fresult_to_errno(fresult);
+
+	return (fresult == FR_OK) ? 0 : -1;
+}
+
+int32_t filestream_source_read(uint32_t index, uint8_t *buffer, uint32_t length) {
+	UINT bytes_read;
+
+	assert(index < FILESTREAM_MAX_OPEN);
+
+	const FRESULT fresult = f_read(&s_file_objects[index], buffer, (UINT) length, &bytes_read);
+
+	errno = fresult_to_errno(fresult);
+
+	return (fresult == FR_OK) ? (int32_t) bytes_read : -1;
+}
+
+int filestream_source_seek(uint32_t index, uint32_t offset) {
+	assert(index < FILESTREAM_MAX_OPEN);
+
+	const FRESULT fresult = f_lseek(&s_file_objects[index], (FSIZE_t) offset);
+
+	errno = fresult_to_errno(fresult);
+
+	return (fresult == FR_OK) ? 0 : -1;
+}
+
+int filestream_source_close(uint32_t index) {
+	assert(index < FILESTREAM_MAX_OPEN);
+
+	const FRESULT fresult = f_close(&s_file_objects[index]);
+
+	errno = fresult_to_errno(fresult);
+
+	return (fresult == FR_OK) ? 0 : -1;
+}
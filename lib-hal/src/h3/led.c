@@ -2,7 +2,7 @@
  * @file led.c
  *
  */
-/* Copyright (C) 2018-2019 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2018-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -29,21 +29,39 @@
 
 #include "c/hardware.h"
 
+#include "metrics.h"
+
 static uint32_t ticks_per_second = 1000000 / 2;
 static uint32_t led_counter = 0;
 static uint32_t micros_previous = 0;
 
+/*
+ * led_blink() is called once per main loop iteration,
+ * so the time between the calls is the main loop latency.
+ */
+static const uint32_t loop_bounds[METRIC_HISTOGRAM_BUCKETS - 1] = { 10, 25, 50, 100, 250, 1000, 10000 };
+static struct metric s_metric_loop = METRIC_HISTOGRAM("loop.us", loop_bounds);
+static uint32_t loop_micros_previous = 0;
+
 void led_set_ticks_per_second(uint32_t ticks) {
 	ticks_per_second = ticks;
 }
 
 void led_blink(void) {
+	const uint32_t micros_now = H3_TIMER->AVS_CNT1;
+
+	if (__builtin_expect((!s_metric_loop.is_registered), 0)) {
+		metrics_register(&s_metric_loop);
+	} else {
+		metric_observe(&s_metric_loop, micros_now - loop_micros_previous);
+	}
+
+	loop_micros_previous = micros_now;
+
 	if (__builtin_expect (ticks_per_second == 0, 0)) {
 		return;
 	}
 
-	const uint32_t micros_now = H3_TIMER->AVS_CNT1;
-
 	if (__builtin_expect ((micros_now - micros_previous < ticks_per_second), 0)) {
 		return;
 	}
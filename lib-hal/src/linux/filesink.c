@@ -0,0 +1,108 @@
+/**
+ * @file filesink.c
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <assert.h>
+
+#include "filesink.h"
+
+/*
+ * POSIX backend, used for recording on a host
+ */
+
+static int s_fd[FILESINK_MAX_OPEN];
+static bool s_is_open[FILESINK_MAX_OPEN];
+
+int filesink_open(const char *path) {
+	int index;
+
+	for (index = 0; index < FILESINK_MAX_OPEN; index++) {
+		if (!s_is_open[index]) {
+			break;
+		}
+	}
+
+	if (index == FILESINK_MAX_OPEN) {
+		errno = EMFILE;
+		return -1;
+	}
+
+	s_fd[index] = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	if (s_fd[index] < 0) {
+		return -1;
+	}
+
+	s_is_open[index] = true;
+
+	return index;
+}
+
+int32_t filesink_write(int index, const void *buffer, uint32_t length) {
+	const uint8_t *p = (const uint8_t *) buffer;
+	uint32_t total = 0;
+
+	assert((index >= 0) && (index < FILESINK_MAX_OPEN));
+	assert(s_is_open[index]);
+
+	while (total < length) {
+		const ssize_t n = write(s_fd[index], &p[total], length - total);
+
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return (total == 0) ? -1 : (int32_t) total;
+		}
+
+		total += (uint32_t) n;
+	}
+
+	return (int32_t) total;
+}
+
+/*
+ * The written data is in the page cache, it survives the process
+ */
+int filesink_sync(int index) {
+	assert((index >= 0) && (index < FILESINK_MAX_OPEN));
+	assert(s_is_open[index]);
+
+	return 0;
+}
+
+int filesink_close(int index) {
+	assert((index >= 0) && (index < FILESINK_MAX_OPEN));
+	assert(s_is_open[index]);
+
+	const int result = close(s_fd[index]);
+	s_is_open[index] = false;
+
+	return result;
+}
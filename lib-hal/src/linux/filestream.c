@@ -0,0 +1,86 @@
+/**
+ * @file filestream.c
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <assert.h>
+
+#include "filestream.h"
+
+/*
+ * POSIX backend, used for benchmarking the playback path on a host
+ */
+
+static int s_fd[FILESTREAM_MAX_OPEN];
+
+int filestream_source_open(uint32_t index, const char *path) {
+	assert(index < FILESTREAM_MAX_OPEN);
+
+	s_fd[index] = open(path, O_RDONLY);
+
+	return (s_fd[index] < 0) ? -1 : 0;
+}
+
+int32_t filestream_source_read(uint32_t index, uint8_t *buffer, uint32_t length) {
+	uint32_t total = 0;
+
+	assert(index < FILESTREAM_MAX_OPEN);
+
+	while (total < length) {
+		const ssize_t n = read(s_fd[index], &buffer[total], length - total);
+
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+
+		if (n == 0) {
+			break;
+		}
+
+		total += (uint32_t) n;
+	}
+
+	return (int32_t) total;
+}
+
+int filestream_source_seek(uint32_t index, uint32_t offset) {
+	assert(index < FILESTREAM_MAX_OPEN);
+
+	return (lseek(s_fd[index], (off_t) offset, SEEK_SET) < 0) ? -1 : 0;
+}
+
+int filestream_source_close(uint32_t index) {
+	assert(index < FILESTREAM_MAX_OPEN);
+
+	const int result = close(s_fd[index]);
+	s_fd[index] = -1;
+
+	return result;
+}
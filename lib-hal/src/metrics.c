@@ -0,0 +1,95 @@
+/**
+ * @file metrics.c
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "metrics.h"
+
+#include "debug.h"
+
+static struct metric *s_first;
+static struct metric *s_last;
+static uint32_t s_count;
+
+/*
+ * Metrics are kept in registration order, so the binary report layout is
+ * stable for a given firmware.
+ */
+void metrics_register(struct metric *m) {
+	assert(m != 0);
+	assert(m->name != 0);
+	assert((m->type != METRIC_TYPE_HISTOGRAM) || (m->bounds != 0));
+
+	if (m->is_registered) {
+		return;
+	}
+
+	m->is_registered = true;
+	m->next = 0;
+
+	if (s_last == 0) {
+		s_first = m;
+	} else {
+		s_last->next = m;
+	}
+
+	s_last = m;
+	s_count++;
+
+	DEBUG_PRINTF("%s [%u]", m->name, (unsigned) s_count);
+}
+
+struct metric *metrics_get_first(void) {
+	return s_first;
+}
+
+uint32_t metrics_get_count(void) {
+	return s_count;
+}
+
+/*
+ * One line per metric, the same format as the remote config text report
+ */
+void metrics_dump(void) {
+	const struct metric *m;
+	uint32_t i;
+
+	for (m = s_first; m != 0; m = m->next) {
+		if (m->type == METRIC_TYPE_HISTOGRAM) {
+			printf("%s h %u %u", m->name, (unsigned) m->value, (unsigned) m->sum);
+
+			for (i = 0; i < METRIC_HISTOGRAM_BUCKETS; i++) {
+				printf(" %u", (unsigned) m->buckets[i]);
+			}
+
+			puts("");
+		} else {
+			printf("%s %c %u\n", m->name, (m->type == METRIC_TYPE_COUNTER) ? 'c' : 'g', (unsigned) m->value);
+		}
+	}
+}
@@ -0,0 +1,252 @@
+/**
+ * @file profiler.c
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "profiler.h"
+
+#if !(defined (__linux__) || defined (__APPLE__))
+# include "c/hardware.h"
+#endif
+
+#include "debug.h"
+
+static struct profiler_section *s_first;
+static struct profiler_section *s_last;
+static struct profiler_section s_loop = PROFILER_SECTION_INIT("loop", false);
+static profiler_ticks_t s_loop_begin;
+static uint32_t s_ticks_per_us = 1;
+
+static struct profiler_sample s_ring[PROFILER_RING_SIZE];
+static uint32_t s_ring_index;
+
+#if defined (__linux__) || defined (__APPLE__)
+# define _irq_save()		0
+# define _irq_restore(x)	(void) (x)
+#else
+/*
+ * IRQ and FIQ masked, the previous state is restored as it was:
+ * profiler_record is also called from within the interrupt handlers.
+ */
+inline static uint32_t _irq_save(void) {
+	uint32_t cpsr;
+	asm volatile ("mrs %0, cpsr\n\tcpsid if" : "=r" (cpsr) :: "memory");
+	return cpsr;
+}
+
+inline static void _irq_restore(uint32_t cpsr) {
+	asm volatile ("msr cpsr_c, %0" :: "r" (cpsr) : "memory");
+}
+#endif
+
+static void _register(struct profiler_section *s) {
+	assert(s->name != 0);
+
+	s->is_registered = true;
+	s->next = 0;
+
+	if (s_last == 0) {
+		s_first = s;
+	} else {
+		s_last->next = s;
+	}
+
+	s_last = s;
+
+	DEBUG_PRINTF("%s", s->name);
+}
+
+void profiler_init(void) {
+#if defined (__linux__) || defined (__APPLE__)
+	s_ticks_per_us = 1000;
+#else
+	uint32_t pmcr;
+# if (__ARM_ARCH >= 7)
+	asm volatile ("mrc p15, 0, %0, c9, c12, 0" : "=r" (pmcr));
+	pmcr |= (1U << 0) | (1U << 2);	// Enable, reset cycle counter
+	pmcr &= ~(1U << 3);				// Count every cycle
+	asm volatile ("mcr p15, 0, %0, c9, c12, 0" :: "r" (pmcr));
+	asm volatile ("mcr p15, 0, %0, c9, c12, 1" :: "r" (1U << 31));	// PMCNTENSET: cycle counter
+# else
+	asm volatile ("mrc p15, 0, %0, c15, c12, 0" : "=r" (pmcr));
+	pmcr |= (1U << 0) | (1U << 2);	// Enable, reset cycle counter
+	pmcr &= ~(1U << 3);				// Count every cycle
+	asm volatile ("mcr p15, 0, %0, c15, c12, 0" :: "r" (pmcr));
+# endif
+
+	const uint32_t micros_begin = hardware_micros();
+	while (hardware_micros() == micros_begin)
+		;
+
+	const uint32_t micros_start = hardware_micros();
+	const profiler_ticks_t ticks_start = profiler_ticks();
+
+	while ((hardware_micros() - micros_start) < 1000)
+		;
+
+	s_ticks_per_us = (profiler_ticks() - ticks_start) / 1000;
+
+	if (s_ticks_per_us == 0) {
+		s_ticks_per_us = 1;
+	}
+#endif
+
+	if (!s_loop.is_registered) {
+		_register(&s_loop);
+	}
+
+	profiler_reset();
+
+	DEBUG_PRINTF("s_ticks_per_us=%u", (unsigned) s_ticks_per_us);
+}
+
+void profiler_reset(void) {
+	struct profiler_section *s;
+
+	for (s = s_first; s != 0; s = s->next) {
+		s->count = 0;
+		s->min = PROFILER_TICKS_MAX;
+		s->max = 0;
+		s->total = 0;
+		memset(s->buckets, 0, sizeof(s->buckets));
+	}
+
+	memset(s_ring, 0, sizeof(s_ring));
+	s_ring_index = 0;
+
+	s_loop_begin = profiler_ticks();
+}
+
+/*
+ * Called from both the main loop and the interrupt handlers.
+ * On bare metal the interrupts are masked while recording, so that an ISR
+ * probe cannot take the ring slot or the section list of an interrupted
+ * main loop probe.
+ */
+void profiler_record(struct profiler_section *s, profiler_ticks_t ticks) {
+	const uint32_t irq_state = _irq_save();
+
+	if (__builtin_expect((!s->is_registered), 0)) {
+		_register(s);
+	}
+
+	s->count++;
+	s->total += ticks;
+
+	if (ticks < s->min) {
+		s->min = ticks;
+	}
+
+	if (ticks > s->max) {
+		s->max = ticks;
+	}
+
+	const profiler_ticks_t ticks_us = ticks / s_ticks_per_us;
+	const uint32_t us = (ticks_us > UINT32_MAX) ? UINT32_MAX : (uint32_t) ticks_us;
+	uint32_t bucket = (us == 0) ? 0 : (uint32_t) (32 - __builtin_clz(us));
+
+	if (bucket >= PROFILER_HISTOGRAM_BUCKETS) {
+		bucket = PROFILER_HISTOGRAM_BUCKETS - 1;
+	}
+
+	s->buckets[bucket]++;
+
+	const uint32_t index = s_ring_index++ & (PROFILER_RING_SIZE - 1);
+	s_ring[index].section = s;
+	s_ring[index].ticks = ticks;
+
+	_irq_restore(irq_state);
+}
+
+void profiler_loop(void) {
+	const profiler_ticks_t now = profiler_ticks();
+
+	profiler_record(&s_loop, now - s_loop_begin);
+	s_loop_begin = now;
+}
+
+const struct profiler_section *profiler_get_first(void) {
+	return s_first;
+}
+
+const struct profiler_section *profiler_get_loop(void) {
+	return &s_loop;
+}
+
+uint32_t profiler_get_ticks_per_us(void) {
+	return s_ticks_per_us;
+}
+
+void profiler_get_ring(const struct profiler_sample **ring, uint32_t *index) {
+	*ring = s_ring;
+	*index = s_ring_index;
+}
+
+/*
+ * One line per section: name, count, min/avg/max in microseconds,
+ * the share of the total main loop time in 0.1 % and the histogram.
+ * ISR sections are marked with a '*'.
+ */
+uint32_t profiler_format(const struct profiler_section *s, char *buffer, uint32_t size) {
+	const uint32_t tpu = s_ticks_per_us;
+	const uint32_t min = (s->count == 0) ? 0 : (uint32_t) (s->min / tpu);
+	const uint32_t avg = (s->count == 0) ? 0 : (uint32_t) ((s->total / s->count) / tpu);
+	const uint32_t max = (uint32_t) (s->max / tpu);
+	const uint32_t load = (s_loop.total == 0) ? 0 : (uint32_t) ((s->total * 1000) / s_loop.total);
+
+	int length = snprintf(buffer, size, "%s%s %u %u %u %u %u.%u", s->name, s->is_isr ? "*" : "", (unsigned) s->count, (unsigned) min, (unsigned) avg, (unsigned) max, (unsigned) (load / 10), (unsigned) (load % 10));
+	uint32_t i;
+
+	for (i = 0; (i < PROFILER_HISTOGRAM_BUCKETS) && (length > 0) && ((uint32_t) length < size); i++) {
+		length += snprintf(&buffer[length], size - (uint32_t) length, " %u", (unsigned) s->buckets[i]);
+	}
+
+	if ((length > 0) && ((uint32_t) length < (size - 1))) {
+		buffer[length++] = '\n';
+		buffer[length] = '\0';
+	}
+
+	if (length < 0) {
+		return 0;
+	}
+
+	return ((uint32_t) length < size) ? (uint32_t) length : size - 1;
+}
+
+void profiler_dump(void) {
+	const struct profiler_section *s;
+	char line[160];
+
+	printf("Profiler: %u ticks/us, name count min avg max (us) load (%%) log2(us) histogram\n", (unsigned) s_ticks_per_us);
+
+	for (s = s_first; s != 0; s = s->next) {
+		profiler_format(s, line, sizeof(line));
+		printf("%s", line);
+	}
+}
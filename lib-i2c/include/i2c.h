@@ -2,7 +2,7 @@
  * @file i2c.h
  *
  */
-/* Copyright (C) 2017-2019 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2017-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -91,6 +91,28 @@ inline static void i2c_write_nb(const char *data, uint32_t length) {
 	(void) FUNC_PREFIX(i2c_write(data, length));
 }
 
+/*
+ * Queued write, returns false when the queue is full.
+ * Without an asynchronous driver it is a blocking write.
+ */
+#if defined(H3)
+	inline static bool i2c_write_async(const char *data, uint32_t length) {
+		return h3_i2c_async_write(data, length);
+	}
+
+	inline static void i2c_async_run(uint32_t budget_us) {
+		h3_i2c_async_run(budget_us);
+	}
+#else
+	inline static bool i2c_write_async(const char *data, uint32_t length) {
+		(void) FUNC_PREFIX(i2c_write(data, length));
+		return true;
+	}
+
+	inline static void i2c_async_run(__attribute__((unused)) uint32_t budget_us) {
+	}
+#endif
+
 extern void i2c_write_reg_uint8(uint8_t, uint8_t);
 extern void i2c_write_uint16(uint16_t);
 extern void i2c_write_reg_uint16(uint8_t, uint16_t);
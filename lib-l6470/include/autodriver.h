@@ -33,6 +33,16 @@
 
 #include "l6470.h"
 
+#define AUTODRIVER_MAX_BOARDS		8
+#define AUTODRIVER_BATCH_MAX_BYTES	16
+
+struct TAutoDriverBatch {
+	bool bIsActive;
+	bool bIsReading;
+	uint8_t nLength[AUTODRIVER_MAX_BOARDS];
+	uint8_t Data[AUTODRIVER_MAX_BOARDS][AUTODRIVER_BATCH_MAX_BYTES];
+};
+
 class AutoDriver: public L6470 {
 public:
 	AutoDriver(uint8_t, uint8_t, uint8_t, uint8_t);
@@ -46,6 +56,10 @@ public:
 
 private:
 	uint8_t SPIXfer(uint8_t);
+	void SPIReadBegin(void);
+	void SPIReadEnd(void);
+
+	long getStatusParam(void);
 
 	/*
 	 * Additional methods
@@ -64,14 +78,36 @@ public:
 	static uint16_t getNumBoards(void);
 	static uint8_t getNumBoards(uint8_t cs);
 
+	/*
+	 * Between BatchBegin and BatchEnd the commands for the boards in the daisy chain
+	 * are collected. They are transferred in combined frames: each frame has a byte for every board.
+	 */
+	static void BatchBegin(uint8_t cs);
+	static void BatchEnd(uint8_t cs);
+
+	/*
+	 * Reads the STATUS of all the boards in the daisy chain with one combined transfer.
+	 * busyCheck uses this status until there is another transfer on the chain.
+	 */
+	static void PollStatus(uint8_t cs);
+
+private:
+	static void BatchFlush(uint8_t cs);
+	static void SPISetup(uint8_t cs);
+
 private:
 	uint8_t m_nSpiChipSelect;
 	uint8_t m_nResetPin;
 	uint8_t m_nBusyPin;
 	uint8_t m_nPosition;
 	bool m_bIsBusy;
+	uint16_t m_nStatus;
+	uint32_t m_nStatusTransfers;
 
 	static uint8_t m_nNumBoards[2];
+	static uint32_t s_nTransfers[2];
+	static AutoDriver *s_pAutoDriver[2][AUTODRIVER_MAX_BOARDS];
+	static struct TAutoDriverBatch s_Batch[2];
 };
 
 #endif /* AUTODRIVER_H_ */
@@ -198,6 +198,17 @@ public:
 private:
 	virtual uint8_t SPIXfer(uint8_t)=0;
 
+	/*
+	 * A transfer which needs the response (getParam, getStatus) is bracketed with
+	 * SPIReadBegin/SPIReadEnd. An implementation that batches the commands must
+	 * transfer these bytes directly.
+	 */
+	virtual void SPIReadBegin(void) {
+	}
+
+	virtual void SPIReadEnd(void) {
+	}
+
 private:
 	long paramHandler(uint8_t, unsigned long);
 	long xferParam(unsigned long, uint8_t);
@@ -5,7 +5,7 @@
 /*
  * Based on https://github.com/sparkfun/L6470-AutoDriver/tree/master/Libraries/Arduino
  */
-/* Copyright (C) 2017-2019 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2017-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -27,6 +27,7 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 #include <assert.h>
 
 #include "hal_spi.h"
@@ -41,19 +42,29 @@
 #define BUSY_PIN_NOT_USED	0xFF
 
 uint8_t AutoDriver::m_nNumBoards[2];
+uint32_t AutoDriver::s_nTransfers[2];
+AutoDriver *AutoDriver::s_pAutoDriver[2][AUTODRIVER_MAX_BOARDS];
+struct TAutoDriverBatch AutoDriver::s_Batch[2];
 
 AutoDriver::AutoDriver(uint8_t nPosition, uint8_t nSpiChipSelect, uint8_t nResetPin, uint8_t nBusyPin) :
 	m_nSpiChipSelect(nSpiChipSelect),
 	m_nResetPin(nResetPin),
 	m_nBusyPin(nBusyPin),
 	m_nPosition(nPosition),
-	m_bIsBusy(false)
+	m_bIsBusy(false),
+	m_nStatus(0),
+	m_nStatusTransfers(0)
 {
 	DEBUG_ENTRY
 
 	DEBUG_PRINTF("nPosition=%d, nSpiChipSelect=%d\n", static_cast<int>(nPosition), static_cast<int>(nSpiChipSelect));
 
+	assert(nSpiChipSelect < 2);
+	assert(nPosition < AUTODRIVER_MAX_BOARDS);
+
+	m_nStatusTransfers = s_nTransfers[nSpiChipSelect] - 1;	// The polled status is not valid yet
 	m_nNumBoards[nSpiChipSelect]++;
+	s_pAutoDriver[nSpiChipSelect][nPosition] = this;
 
 	DEBUG_PRINTF("m_nNumBoards[%d]=%d", static_cast<int>(nSpiChipSelect), static_cast<int>(m_nNumBoards[nSpiChipSelect]));
 	DEBUG_EXIT
@@ -64,13 +75,20 @@ AutoDriver::AutoDriver(uint8_t nPosition, uint8_t nSpiChipSelect, uint8_t nReset
 	m_nResetPin(nResetPin),
 	m_nBusyPin(BUSY_PIN_NOT_USED),
 	m_nPosition(nPosition),
-	m_bIsBusy(false)
+	m_bIsBusy(false),
+	m_nStatus(0),
+	m_nStatusTransfers(0)
 {
 	DEBUG_ENTRY
 
 	DEBUG_PRINTF("nPosition=%d, nSpiChipSelect=%d\n", static_cast<int>(nPosition), static_cast<int>(nSpiChipSelect));
 
+	assert(nSpiChipSelect < 2);
+	assert(nPosition < AUTODRIVER_MAX_BOARDS);
+
+	m_nStatusTransfers = s_nTransfers[nSpiChipSelect] - 1;	// The polled status is not valid yet
 	m_nNumBoards[nSpiChipSelect]++;
+	s_pAutoDriver[nSpiChipSelect][nPosition] = this;
 
 	DEBUG_PRINTF("m_nNumBoards[%d]=%d", static_cast<int>(nSpiChipSelect), static_cast<int>(m_nNumBoards[nSpiChipSelect]));
 	DEBUG_EXIT
@@ -80,18 +98,19 @@ AutoDriver::~AutoDriver(void) {
 	hardHiZ();
 	m_bIsBusy = false;
 	m_nNumBoards[m_nSpiChipSelect]--;
+	s_pAutoDriver[m_nSpiChipSelect][m_nPosition] = 0;
 }
 
 int AutoDriver::busyCheck(void) {
 	if (m_nBusyPin == BUSY_PIN_NOT_USED) {
-		if (getParam(L6470_PARAM_STATUS) & L6470_STATUS_BUSY) {
+		if (getStatusParam() & L6470_STATUS_BUSY) {
 			return 0;
 		} else {
 			return 1;
 		}
 	} else {
 		if (!m_bIsBusy) {
-			if (getParam(L6470_PARAM_STATUS) & L6470_STATUS_BUSY) {
+			if (getStatusParam() & L6470_STATUS_BUSY) {
 				return 0;
 			} else {
 				m_bIsBusy = true;
@@ -108,9 +127,36 @@ int AutoDriver::busyCheck(void) {
 	}
 }
 
+long AutoDriver::getStatusParam(void) {
+	if (m_nStatusTransfers == s_nTransfers[m_nSpiChipSelect]) {
+		return m_nStatus;
+	}
+
+	return getParam(L6470_PARAM_STATUS);
+}
+
+void AutoDriver::SPISetup(uint8_t cs) {
+	FUNC_PREFIX(spi_chipSelect(cs));
+	FUNC_PREFIX(spi_set_speed_hz(4000000));
+	FUNC_PREFIX(spi_setDataMode(SPI_MODE3));
+}
+
 uint8_t AutoDriver::SPIXfer(uint8_t data) {
 	DEBUG_ENTRY
 
+	struct TAutoDriverBatch *pBatch = &s_Batch[m_nSpiChipSelect];
+
+	if (pBatch->bIsActive && !pBatch->bIsReading) {
+		if (pBatch->nLength[m_nPosition] == AUTODRIVER_BATCH_MAX_BYTES) {
+			BatchFlush(m_nSpiChipSelect);
+		}
+
+		pBatch->Data[m_nPosition][pBatch->nLength[m_nPosition]++] = data;
+
+		DEBUG_EXIT
+		return 0;
+	}
+
 	char dataPacket[m_nNumBoards[m_nSpiChipSelect]];
 
 	for (uint32_t i = 0; i < m_nNumBoards[m_nSpiChipSelect]; i++) {
@@ -119,16 +165,139 @@ uint8_t AutoDriver::SPIXfer(uint8_t data) {
 
 	dataPacket[m_nPosition] = data;
 
-	FUNC_PREFIX(spi_chipSelect(m_nSpiChipSelect));
-	FUNC_PREFIX(spi_set_speed_hz(4000000));
-	FUNC_PREFIX(spi_setDataMode(SPI_MODE3));
+	SPISetup(m_nSpiChipSelect);
 	FUNC_PREFIX(spi_transfern(dataPacket, m_nNumBoards[m_nSpiChipSelect]));
 
+	s_nTransfers[m_nSpiChipSelect]++;
+
 	DEBUG_PRINTF("data=%x, dataPacket[m_nPosition]=%x", data, m_nPosition, dataPacket[m_nPosition]);
 	DEBUG_EXIT
 	return dataPacket[m_nPosition];
 }
 
+/*
+ * The pending commands of this board are transferred first, so the order is kept.
+ * The commands of the other boards are not started yet, they get NOP's.
+ */
+void AutoDriver::SPIReadBegin(void) {
+	struct TAutoDriverBatch *pBatch = &s_Batch[m_nSpiChipSelect];
+
+	if (pBatch->bIsActive) {
+		if (pBatch->nLength[m_nPosition] != 0) {
+			BatchFlush(m_nSpiChipSelect);
+		}
+
+		pBatch->bIsReading = true;
+	}
+}
+
+void AutoDriver::SPIReadEnd(void) {
+	s_Batch[m_nSpiChipSelect].bIsReading = false;
+}
+
+void AutoDriver::BatchBegin(uint8_t cs) {
+	assert(cs < 2);
+
+	memset(&s_Batch[cs], 0, sizeof(struct TAutoDriverBatch));
+	s_Batch[cs].bIsActive = true;
+}
+
+void AutoDriver::BatchEnd(uint8_t cs) {
+	assert(cs < 2);
+
+	BatchFlush(cs);
+	s_Batch[cs].bIsActive = false;
+}
+
+/*
+ * Frame n has byte n of the commands of each board, or a NOP when the board has no more bytes.
+ * The SPI is configured once for all the frames.
+ */
+void AutoDriver::BatchFlush(uint8_t cs) {
+	DEBUG_ENTRY
+
+	struct TAutoDriverBatch *pBatch = &s_Batch[cs];
+	const uint32_t nNumBoards = m_nNumBoards[cs];
+	uint32_t nFrames = 0;
+
+	for (uint32_t i = 0; i < nNumBoards; i++) {
+		if (pBatch->nLength[i] > nFrames) {
+			nFrames = pBatch->nLength[i];
+		}
+	}
+
+	if (nFrames == 0) {
+		DEBUG_EXIT
+		return;
+	}
+
+	char dataPacket[AUTODRIVER_MAX_BOARDS];
+
+	SPISetup(cs);
+
+	for (uint32_t nFrame = 0; nFrame < nFrames; nFrame++) {
+		for (uint32_t i = 0; i < nNumBoards; i++) {
+			dataPacket[i] = (nFrame < pBatch->nLength[i]) ? pBatch->Data[i][nFrame] : L6470_CMD_NOP;
+		}
+
+		FUNC_PREFIX(spi_transfern(dataPacket, nNumBoards));
+	}
+
+	s_nTransfers[cs]++;
+
+	memset(pBatch->nLength, 0, sizeof(pBatch->nLength));
+
+	DEBUG_PRINTF("nFrames=%d", nFrames);
+	DEBUG_EXIT
+}
+
+void AutoDriver::PollStatus(uint8_t cs) {
+	DEBUG_ENTRY
+	assert(cs < 2);
+
+	const uint32_t nNumBoards = m_nNumBoards[cs];
+
+	if (nNumBoards == 0) {
+		DEBUG_EXIT
+		return;
+	}
+
+	if (s_Batch[cs].bIsActive) {
+		BatchFlush(cs);
+	}
+
+	char dataPacket[AUTODRIVER_MAX_BOARDS];
+	uint16_t nStatus[AUTODRIVER_MAX_BOARDS];
+
+	SPISetup(cs);
+
+	memset(dataPacket, L6470_PARAM_STATUS | L6470_CMD_GET_PARAM, nNumBoards);
+	FUNC_PREFIX(spi_transfern(dataPacket, nNumBoards));
+
+	memset(dataPacket, L6470_CMD_NOP, nNumBoards);
+	FUNC_PREFIX(spi_transfern(dataPacket, nNumBoards));
+
+	for (uint32_t i = 0; i < nNumBoards; i++) {
+		nStatus[i] = static_cast<uint16_t>(static_cast<uint8_t>(dataPacket[i]) << 8);
+	}
+
+	memset(dataPacket, L6470_CMD_NOP, nNumBoards);
+	FUNC_PREFIX(spi_transfern(dataPacket, nNumBoards));
+
+	s_nTransfers[cs]++;
+
+	for (uint32_t i = 0; i < nNumBoards; i++) {
+		AutoDriver *pAutoDriver = s_pAutoDriver[cs][i];
+
+		if (pAutoDriver != 0) {
+			pAutoDriver->m_nStatus = nStatus[i] | static_cast<uint8_t>(dataPacket[i]);
+			pAutoDriver->m_nStatusTransfers = s_nTransfers[cs];
+		}
+	}
+
+	DEBUG_EXIT
+}
+
 uint16_t AutoDriver::getNumBoards(void) {
 	uint16_t n = 0;
 
@@ -34,9 +34,14 @@ void L6470::setParam(TL6470ParamRegisters param, unsigned long value) {
 }
 
 long L6470::getParam(TL6470ParamRegisters param) {
+	SPIReadBegin();
+
 	SPIXfer(param | L6470_CMD_GET_PARAM);
+	const long nValue = paramHandler(param, 0);
+
+	SPIReadEnd();
 
-	return paramHandler(param, 0);
+	return nValue;
 }
 
 long L6470::getPos() {
@@ -181,9 +186,14 @@ int L6470::getStatus() {
 	int temp = 0;
 
 	uint8_t *bytePointer = reinterpret_cast<uint8_t*>(&temp);
+
+	SPIReadBegin();
+
 	SPIXfer(L6470_CMD_GET_STATUS);
 	bytePointer[1] = SPIXfer(0);
 	bytePointer[0] = SPIXfer(0);
 
+	SPIReadEnd();
+
 	return temp;
 }
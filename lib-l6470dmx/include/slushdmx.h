@@ -49,6 +49,8 @@ public:
 
 	void SetData(uint8_t nPort, const uint8_t *, uint16_t);
 
+	void Run(void);
+
 	uint32_t GetMotorsConnected(void) {
 		return m_nMotorsConnected;
 	}
@@ -137,6 +139,10 @@ private:
 	uint16_t m_nDmxFootprint;
 
 	char *m_pSlotInfoRaw;
+
+	bool m_bIsMovePending[SLUSH_DMX_MAX_MOTORS];
+	uint8_t m_DmxData[DMX_UNIVERSE_SIZE];
+	uint16_t m_nDmxDataLength;
 };
 
 #endif /* SLUSHDMX_H_ */
@@ -59,6 +59,8 @@ public:
 
 	void SetData(uint8_t nPort, const uint8_t *, uint16_t);
 
+	void Run(void);
+
 	void Print(void);
 
 	uint32_t GetMotorsConnected(void) {
@@ -152,6 +154,10 @@ private:
 	uint16_t m_nDmxFootprint;
 
 	ModeStore *m_pModeStore;
+
+	bool m_bIsMovePending[SPARKFUN_DMX_MAX_MOTORS];
+	uint8_t m_DmxData[DMX_UNIVERSE_SIZE];
+	uint16_t m_nDmxDataLength;
 };
 
 #endif /* SPARKFUNDMX_H_ */
@@ -26,6 +26,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 
 #include "slushdmx.h"
@@ -156,7 +157,8 @@ SlushDmx::SlushDmx(bool bUseSPI):
 	m_bUseSpiBusy(bUseSPI),
 	m_nMotorsConnected(0),
 	m_nDmxStartAddress(DMX_ADDRESS_INVALID),
-	m_nDmxFootprint(0)  // Invalidate DMX Start Address and DMX Footprint
+	m_nDmxFootprint(0),  // Invalidate DMX Start Address and DMX Footprint
+	m_nDmxDataLength(0)
 {
 	DEBUG_ENTRY;
 
@@ -184,6 +186,7 @@ SlushDmx::SlushDmx(bool bUseSPI):
 		m_pModeParams[i] = 0;
 		m_pL6470DmxModes[i] = 0;
 		m_pSlotInfo[i] = 0;
+		m_bIsMovePending[i] = false;
 	}
 
 	m_pSlotInfoRaw = new char[DMX_SLOT_INFO_RAW_LENGTH];
@@ -500,41 +503,43 @@ void SlushDmx::SetData(uint8_t nPortId, const uint8_t *pData, uint16_t nLength)
 	assert(pData != 0);
 	assert(nLength <= DMX_MAX_CHANNELS);
 
-	bool bIsDmxDataChanged[SLUSH_DMX_MAX_MOTORS];
-
 	for (uint32_t i = 0; i < SLUSH_DMX_MAX_MOTORS; i++) {
 		if (m_pL6470DmxModes[i] != 0) {
-			bIsDmxDataChanged[i] = m_pL6470DmxModes[i]->IsDmxDataChanged(pData, nLength);
+			const bool bIsDmxDataChanged = m_pL6470DmxModes[i]->IsDmxDataChanged(pData, nLength);
 
-			if(bIsDmxDataChanged[i]) {
+			if (bIsDmxDataChanged) {
 				m_pL6470DmxModes[i]->HandleBusy();
+				m_bIsMovePending[i] = true;
 			}
-		} else {
-			bIsDmxDataChanged[i] = false;
-		}
 #ifndef NDEBUG
-		printf("bIsDmxDataChanged[%d]=%d\n", i, bIsDmxDataChanged[i]);
+			printf("bIsDmxDataChanged[%d]=%d\n", i, bIsDmxDataChanged);
 #endif
-	}
-
-	for (uint32_t i = 0; i < SLUSH_DMX_MAX_MOTORS; i++) {
-		if (bIsDmxDataChanged[i]) {
-			while (m_pL6470DmxModes[i]->BusyCheck())
-				;
 		}
 	}
 
-	for (uint32_t i = 0; i < SLUSH_DMX_MAX_MOTORS; i++) {
-		if (bIsDmxDataChanged[i]) {
-			m_pL6470DmxModes[i]->DmxData(pData, nLength);
-		}
-	}
+	memcpy(m_DmxData, pData, nLength);
+	m_nDmxDataLength = nLength;
+
+	Run();
 
 	UpdateIOPorts(pData, nLength);
 
 	DEBUG_EXIT;
 }
 
+/*
+ * The moves for the changed motors are started when the motor is no longer busy.
+ * Each call checks the motors once, a busy motor is retried on the next call.
+ */
+void SlushDmx::Run(void) {
+	for (uint32_t i = 0; i < SLUSH_DMX_MAX_MOTORS; i++) {
+		if (m_bIsMovePending[i] && !m_pL6470DmxModes[i]->BusyCheck()) {
+			m_pL6470DmxModes[i]->DmxData(m_DmxData, m_nDmxDataLength);
+			m_bIsMovePending[i] = false;
+		}
+	}
+}
+
 void SlushDmx::UpdateIOPorts(const uint8_t *pData, uint16_t nLength) {
 	DEBUG_ENTRY;
 
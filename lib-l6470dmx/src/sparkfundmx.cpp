@@ -26,6 +26,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 
 #include "sparkfundmx.h"
@@ -62,7 +63,8 @@
 SparkFunDmx::SparkFunDmx(void):
 	m_nDmxStartAddress(DMX_ADDRESS_INVALID),
 	m_nDmxFootprint(0),
-	m_pModeStore(0)
+	m_pModeStore(0),
+	m_nDmxDataLength(0)
 {
 	DEBUG_ENTRY;
 
@@ -93,6 +95,7 @@ SparkFunDmx::SparkFunDmx(void):
 		m_pModeParams[i] = 0;
 		m_pL6470DmxModes[i] = 0;
 		m_pSlotInfo[i] = 0;
+		m_bIsMovePending[i] = false;
 	}
 
 	DEBUG_EXIT;
@@ -358,37 +361,78 @@ void SparkFunDmx::SetData(uint8_t nPortId, const uint8_t *pData, uint16_t nLengt
 	assert(pData != 0);
 	assert(nLength <= DMX_UNIVERSE_SIZE);
 
-	bool bIsDmxDataChanged[SPARKFUN_DMX_MAX_MOTORS];
+	// The status of all the boards in a daisy chain is read with one transfer,
+	// and the commands are combined in frames with a byte for every board.
+	for (uint32_t nCs = 0; nCs < 2; nCs++) {
+		AutoDriver::PollStatus(nCs);
+		AutoDriver::BatchBegin(nCs);
+	}
 
 	for (uint32_t i = 0; i < SPARKFUN_DMX_MAX_MOTORS; i++) {
 		if (m_pL6470DmxModes[i] != 0) {
-			bIsDmxDataChanged[i] = m_pL6470DmxModes[i]->IsDmxDataChanged(pData, nLength);
+			const bool bIsDmxDataChanged = m_pL6470DmxModes[i]->IsDmxDataChanged(pData, nLength);
 
-			if(bIsDmxDataChanged[i]) {
+			if (bIsDmxDataChanged) {
 				m_pL6470DmxModes[i]->HandleBusy();
+				m_bIsMovePending[i] = true;
 			}
-		} else {
-			bIsDmxDataChanged[i] = false;
-		}
 #ifndef NDEBUG
-		printf("bIsDmxDataChanged[%d]=%d\n", i, bIsDmxDataChanged[i]);
+			printf("bIsDmxDataChanged[%d]=%d\n", i, bIsDmxDataChanged);
 #endif
+		}
 	}
 
+	for (uint32_t nCs = 0; nCs < 2; nCs++) {
+		AutoDriver::BatchEnd(nCs);
+	}
+
+	memcpy(m_DmxData, pData, nLength);
+	m_nDmxDataLength = nLength;
+
+	Run();
+
+	DEBUG_EXIT;
+}
+
+/*
+ * The moves for the changed motors are started when the motor is no longer busy.
+ * Each call polls the status of the boards once, a busy motor is retried on the next call.
+ */
+void SparkFunDmx::Run(void) {
+	bool bIsMovePending = false;
+
 	for (uint32_t i = 0; i < SPARKFUN_DMX_MAX_MOTORS; i++) {
-		if (bIsDmxDataChanged[i]) {
-			while (m_pL6470DmxModes[i]->BusyCheck())
-				;
-		}
+		bIsMovePending |= m_bIsMovePending[i];
 	}
 
-	for (int i = 0; i < SPARKFUN_DMX_MAX_MOTORS; i++) {
-		if (bIsDmxDataChanged[i]) {
-			m_pL6470DmxModes[i]->DmxData(pData, nLength);
+	if (!bIsMovePending) {
+		return;
+	}
+
+	for (uint32_t nCs = 0; nCs < 2; nCs++) {
+		AutoDriver::PollStatus(nCs);
+	}
+
+	bool bIsReady[SPARKFUN_DMX_MAX_MOTORS];
+
+	for (uint32_t i = 0; i < SPARKFUN_DMX_MAX_MOTORS; i++) {
+		bIsReady[i] = m_bIsMovePending[i] && !m_pL6470DmxModes[i]->BusyCheck();
+	}
+
+	for (uint32_t nCs = 0; nCs < 2; nCs++) {
+		AutoDriver::BatchBegin(nCs);
+	}
+
+	for (uint32_t i = 0; i < SPARKFUN_DMX_MAX_MOTORS; i++) {
+		if (bIsReady[i]) {
+			m_pL6470DmxModes[i]->DmxData(m_DmxData, m_nDmxDataLength);
+			m_bIsMovePending[i] = false;
 		}
 	}
 
-	DEBUG_EXIT;
+	for (uint32_t nCs = 0; nCs < 2; nCs++) {
+		AutoDriver::BatchEnd(nCs);
+	}
 }
 
 bool SparkFunDmx::SetDmxStartAddress(uint16_t nDmxStartAddress) {
@@ -29,6 +29,7 @@
 #include <stdint.h>
 
 #include "ltc.h"
+#include "ltcdecoder.h"
 
 enum TLtcGeneratorDirection {
 	LTC_GENERATOR_FORWARD = 0,
@@ -64,6 +65,16 @@ public:
 	void ActionSetDirection(const char *pTimeCodeDirection);
 	void ActionSetPitch(const char *pTimeCodePitch, uint32_t nSize);
 	void ActionSetPitch(float fTimeCodePitch);
+	void ActionJamSync(const struct TLtcTimeCode *pLtcTimeCode, uint32_t nSubFrameUs);
+
+	/*
+	 * Jam-sync: the generator takes the timecode and the frame phase of the LTC input.
+	 * It is jammed again when it is more than a quarter frame off, and it continues
+	 * on its own clock when the input stops.
+	 */
+	void SetJamSync(LtcDecoder *pDecoder) {
+		m_pJamSyncDecoder = pDecoder;
+	}
 
 	static LtcGenerator* Get(void) {
 		return s_pThis;
@@ -76,6 +87,7 @@ private:
 	void Increment(void);
 	void Decrement(void);
 	bool PitchControl(void);
+	void HandleJamSync(void);
 
 private:
 	alignas(uint32_t) struct TLtcTimeCode *m_pStartLtcTimeCode;
@@ -92,6 +104,7 @@ private:
 	alignas(uint32_t) char m_Buffer[64];
 	uint16_t m_nBytesReceived;
 	bool m_bIsStarted;
+	LtcDecoder *m_pJamSyncDecoder;
 
 	static LtcGenerator *s_pThis;
 };
@@ -2,7 +2,7 @@
  * @file ltcreader.h
  *
  */
-/* Copyright (C) 2019 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2019-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -27,6 +27,7 @@
 #define H3_LTC_READER_H_
 
 #include "ltc.h"
+#include "ltcdecoder.h"
 
 class LtcReader {
 public:
@@ -36,9 +37,20 @@ public:
 	void Start(void);
 	void Run(void);
 
+	/*
+	 * Only the edge capture. The decoder is run by its user, nothing is sent to the outputs.
+	 * Used by the LtcGenerator for the jam-sync.
+	 */
+	void StartDecoder(void);
+
+	LtcDecoder *GetDecoder(void) {
+		return &m_Decoder;
+	}
+
 private:
 	alignas(uint32_t) struct TLtcDisabledOutputs *m_ptLtcDisabledOutputs;
 	uint8_t m_tTimeCodeTypePrevious;
+	LtcDecoder m_Decoder;
 };
 
 #endif /* H3_LTC_READER_H_ */
@@ -0,0 +1,165 @@
+/**
+ * @file ltcdecoder.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LTCDECODER_H_
+#define LTCDECODER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ltc.h"
+
+/*
+ * Portable bi-phase mark decoder. The platform only has to feed the time of
+ * every signal transition (in microseconds) with Edge(), typically from the
+ * GPIO edge interrupt. Run() is called from the main loop.
+ *
+ * - The bit period is tracked continuously, so varispeed is followed.
+ * - Both the forward and the reverse sync word are detected.
+ * - A timecode is only taken after two contiguous frames.
+ * - On a dropout the timeline freewheels at the last measured speed.
+ */
+
+enum TLtcDecoderState {
+	LTC_DECODER_STATE_NO_SIGNAL = 0,
+	LTC_DECODER_STATE_LOCKED,
+	LTC_DECODER_STATE_FREEWHEEL
+};
+
+enum TLtcDecoderDirection {
+	LTC_DECODER_FORWARD = 0,
+	LTC_DECODER_REVERSE
+};
+
+#define LTC_DECODER_FREEWHEEL_FRAMES_DEFAULT	50
+
+class LtcDecoder {
+public:
+	LtcDecoder(void);
+	~LtcDecoder(void);
+
+	void Reset(void);
+
+	// Interrupt context
+	void Edge(uint32_t nTimeUs);
+
+	// Main loop. Returns true when the current timecode has changed.
+	bool Run(uint32_t nNowUs);
+
+	const struct TLtcTimeCode *GetTimeCode(void) {
+		return &m_tTimeCode;
+	}
+
+	TLtcDecoderState GetState(void) {
+		return m_tState;
+	}
+
+	TLtcDecoderDirection GetDirection(void) {
+		return m_tDirection;
+	}
+
+	uint8_t GetFps(void) {
+		return m_nFps;
+	}
+
+	bool IsDropFrame(void) {
+		return m_bIsDropFrame;
+	}
+
+	/*
+	 * Playback speed in 1/1000, 1000 is nominal speed
+	 */
+	uint32_t GetSpeed(void);
+
+	/*
+	 * Position inside the current frame, in nominal microseconds
+	 */
+	uint32_t GetSubFrameUs(uint32_t nNowUs);
+
+	/*
+	 * Timeline position (the current timecode plus the position inside the frame), in nominal microseconds
+	 */
+	uint64_t GetPositionUs(uint32_t nNowUs);
+
+	/*
+	 * Start of the frame pTimeCode on the timeline, in nominal microseconds
+	 */
+	static uint64_t GetPositionUs(const struct TLtcTimeCode *pTimeCode, uint8_t nFps, bool bIsDropFrame);
+
+	void SetFreewheelFrames(uint32_t nFreewheelFrames) {
+		m_nFreewheelFrames = nFreewheelFrames;
+	}
+
+	uint32_t GetFreewheelFrames(void) {
+		return m_nFreewheelFrames;
+	}
+
+private:
+	void ShiftIn(uint32_t nBit, uint32_t nTimeUs);
+	void Publish(uint64_t nData, bool bReverse, uint32_t nTimeUs);
+	bool Consume(void);
+	void Step(void);
+	uint32_t GetFrameNominalUs(void);
+
+private:
+	// Interrupt context only
+	uint64_t m_nShiftData;
+	uint32_t m_nShiftSync;
+	uint32_t m_nEdgePreviousUs;
+	uint32_t m_nHalfBitUs;
+	uint32_t m_nBitPeriodUs;
+	uint32_t m_nBitsSinceSync;
+	uint32_t m_nContiguous;
+	bool m_bHalfBit;
+	bool m_bReversePrevious;
+
+	// Shared, written by Edge() read by Run()
+	struct TLtcDecoderFrame {
+		uint64_t nData;			///< Frame bits 0..63, in transmission order
+		uint32_t nEndUs;		///< Edge ending the sync word
+		uint32_t nBitPeriodUs;
+		uint32_t nContiguous;	///< Number of frames received without a break
+		bool bReverse;
+	};
+	volatile struct TLtcDecoderFrame m_tFrame;
+	volatile uint32_t m_nFrameSequence;
+
+	// Main loop only
+	uint32_t m_nFrameSequencePrevious;
+	struct TLtcTimeCode m_tTimeCode;
+	TLtcDecoderState m_tState;
+	TLtcDecoderDirection m_tDirection;
+	uint32_t m_nFrameStartUs;
+	uint32_t m_nFrameEndPreviousUs;
+	uint32_t m_nFramePeriodUs;
+	uint32_t m_nFreewheelCount;
+	uint32_t m_nFreewheelFrames;
+	uint8_t m_nFps;
+	uint8_t m_nFramesMax;
+	uint8_t m_nFramesPrevious;
+	bool m_bIsDropFrame;
+};
+
+#endif /* LTCDECODER_H_ */
@@ -46,7 +46,7 @@ struct TLtcParams {
 	uint32_t nSetList;
 	uint8_t tSource;
 	uint8_t nAutoStart;
-	uint8_t nReserved2;
+	uint8_t nJamSync;
 	uint8_t nDisabledOutputs;
 	uint8_t nShowSysTime;
 	uint8_t nDisableTimeSync;
@@ -74,7 +74,7 @@ static_assert(sizeof(struct TLtcParams) <= 32, "TLtcParams is too large");
 enum TLtcParamsMask {
 	LTC_PARAMS_MASK_SOURCE = (1 << 0),
 	LTC_PARAMS_MASK_AUTO_START = (1 << 1),
-	LTC_PARAMS_MASK_RESERVED2 = (1 << 2),
+	LTC_PARAMS_MASK_JAM_SYNC = (1 << 2),
 	LTC_PARAMS_MASK_DISABLED_OUTPUTS = (1 << 3),
 	LTC_PARAMS_MASK_SHOW_SYSTIME = (1 << 4),
 	LTC_PARAMS_MASK_DISABLE_TIMESYNC = (1 << 5),
@@ -129,6 +129,10 @@ public:
 		return ((m_tLtcParams.nAutoStart != 0) && isMaskSet(LTC_PARAMS_MASK_AUTO_START));
 	}
 
+	bool IsJamSync(void) {
+		return ((m_tLtcParams.nJamSync != 0) && isMaskSet(LTC_PARAMS_MASK_JAM_SYNC));
+	}
+
 	void CopyDisabledOutputs(struct TLtcDisabledOutputs *pLtcDisabledOutputs);
 
 	bool IsShowSysTime(void) {
@@ -33,6 +33,7 @@ public:
 
 	static const char SOURCE[];
 	static const char AUTO_START[];
+	static const char JAM_SYNC[];
 	static const char DISABLE_DISPLAY[];
 	static const char DISABLE_MAX7219[];
 	static const char DISABLE_MIDI[];
@@ -30,6 +30,7 @@
 
 #include "h3/ltcgenerator.h"
 #include "ltc.h"
+#include "ltcdecoder.h"
 #include "timecodeconst.h"
 
 #include "network.h"
@@ -41,6 +42,7 @@
 
 #include "h3.h"
 #include "h3_timer.h"
+#include "h3_hs_timer.h"
 #include "irq_timer.h"
 
 // Buttons
@@ -94,8 +96,11 @@ static volatile bool bTimeCodeAvailable;
 static struct TLtcDisabledOutputs* s_ptLtcDisabledOutputs;
 
 static struct TLtcTimeCode s_tLtcTimeCode;
+static volatile uint32_t s_nTickUs;
 
 static void irq_timer0_handler(uint32_t clo) {
+	s_nTickUs = h3_hs_timer_lo_us();
+
 	if (!s_ptLtcDisabledOutputs->bLtc) {
 		LtcSender::Get()->SetTimeCode(static_cast<const struct TLtcTimeCode*>(&s_tLtcTimeCode), false);
 	}
@@ -142,7 +147,8 @@ LtcGenerator::LtcGenerator(const struct TLtcTimeCode* pStartLtcTimeCode, const s
 	m_nButtons(0),
 	m_nHandle(-1),
 	m_nBytesReceived(0),
-	m_bIsStarted(false)
+	m_bIsStarted(false),
+	m_pJamSyncDecoder(0)
 {
 	assert(pStartLtcTimeCode != 0);
 	assert(pStopLtcTimeCode != 0);
@@ -400,6 +406,87 @@ void LtcGenerator::ActionSetPitch(float fTimeCodePitch) {
 	DEBUG_EXIT
 }
 
+void LtcGenerator::ActionJamSync(const struct TLtcTimeCode *pLtcTimeCode, uint32_t nSubFrameUs) {
+	DEBUG_ENTRY
+
+	m_nFps = TimeCodeConst::FPS[pLtcTimeCode->nType];
+	m_nTimer0Interval = TimeCodeConst::TMR_INTV[pLtcTimeCode->nType];
+	m_tDirection = LTC_GENERATOR_FORWARD;
+	m_tPitch = LTC_GENERATOR_NORMAL;
+
+	const uint32_t nFrameUs = 1000000 / m_nFps;
+
+	if (nSubFrameUs >= nFrameUs) {
+		nSubFrameUs = nFrameUs - 1;
+	}
+
+	__disable_irq();
+
+	m_bIsStarted = true;
+
+	// The next timer interrupt sends the next frame, at the frame boundary of the input
+	memcpy(&s_tLtcTimeCode, pLtcTimeCode, sizeof(struct TLtcTimeCode));
+	Increment();
+	bTimeCodeAvailable = false;
+	s_nTickUs = h3_hs_timer_lo_us() - nSubFrameUs;
+
+	H3_TIMER->TMR0_INTV = (nFrameUs - nSubFrameUs) * (TimeCodeConst::TMR_INTV[pLtcTimeCode->nType] / nFrameUs);
+	H3_TIMER->TMR0_CTRL &= ~(TIMER_CTRL_SINGLE_MODE);
+	H3_TIMER->TMR0_CTRL |= (TIMER_CTRL_EN_START | TIMER_CTRL_RELOAD);
+
+	// The reload bit is cleared by the timer, then the following periods are full frames
+	for (uint32_t i = 0; (i < 1000) && ((H3_TIMER->TMR0_CTRL & TIMER_CTRL_RELOAD) != 0); i++) {
+	}
+
+	H3_TIMER->TMR0_INTV = m_nTimer0Interval;
+
+	__enable_irq();
+
+	LtcOutputs::Get()->ResetTimeCodeTypePrevious();
+
+	DEBUG_PRINTF("%.2d:%.2d:%.2d:%.2d +%d us", pLtcTimeCode->nHours, pLtcTimeCode->nMinutes, pLtcTimeCode->nSeconds, pLtcTimeCode->nFrames, static_cast<int>(nSubFrameUs));
+	DEBUG_EXIT
+}
+
+void LtcGenerator::HandleJamSync(void) {
+	const uint32_t nNowUs = h3_hs_timer_lo_us();
+
+	// The decoder is updated at the sync word of every frame received
+	if (!m_pJamSyncDecoder->Run(nNowUs)) {
+		return;
+	}
+
+	// Without input (freewheel, no signal), or played in reverse, the generator continues on its own clock
+	if ((m_pJamSyncDecoder->GetState() != LTC_DECODER_STATE_LOCKED) || (m_pJamSyncDecoder->GetDirection() != LTC_DECODER_FORWARD)) {
+		return;
+	}
+
+	const struct TLtcTimeCode *pLtcTimeCode = m_pJamSyncDecoder->GetTimeCode();
+	const uint32_t nSubFrameUs = m_pJamSyncDecoder->GetSubFrameUs(nNowUs);
+
+	if ((!m_bIsStarted) || (m_tDirection != LTC_GENERATOR_FORWARD) || (pLtcTimeCode->nType != s_tLtcTimeCode.nType)) {
+		ActionJamSync(pLtcTimeCode, nSubFrameUs);
+		return;
+	}
+
+	dmb();
+	if (bTimeCodeAvailable) {
+		// The timer has ticked, Update() has not advanced the timecode yet
+		return;
+	}
+
+	// s_tLtcTimeCode is the next frame to be sent, the frame sent at s_nTickUs is the one before
+	const uint32_t nFrameUs = 1000000 / m_nFps;
+	const uint64_t nGeneratorUs = LtcDecoder::GetPositionUs(&s_tLtcTimeCode, m_nFps, (s_tLtcTimeCode.nType == TC_TYPE_DF)) - nFrameUs + (nNowUs - s_nTickUs);
+	const uint64_t nDecoderUs = m_pJamSyncDecoder->GetPositionUs(nNowUs);
+	const uint64_t nDriftUs = (nGeneratorUs > nDecoderUs) ? (nGeneratorUs - nDecoderUs) : (nDecoderUs - nGeneratorUs);
+
+	if (nDriftUs > (nFrameUs / 4)) {
+		DEBUG_PRINTF("Drift %d us", static_cast<int>(nDriftUs));
+		ActionJamSync(pLtcTimeCode, nSubFrameUs);
+	}
+}
+
 void LtcGenerator::HandleButtons(void) {
 	m_nButtons = H3_PIO_PA_INT->STA & BUTTONS_MASK;
 
@@ -624,11 +711,18 @@ void LtcGenerator::Print(void) {
 	printf(" %s\n", Ltc::GetType(static_cast<TTimecodeTypes>(m_pStartLtcTimeCode->nType)));
 	printf(" Start : %.2d.%.2d.%.2d:%.2d\n", m_pStartLtcTimeCode->nHours, m_pStartLtcTimeCode->nMinutes, m_pStartLtcTimeCode->nSeconds, m_pStartLtcTimeCode->nFrames);
 	printf(" Stop  : %.2d.%.2d.%.2d:%.2d\n", m_pStopLtcTimeCode->nHours, m_pStopLtcTimeCode->nMinutes, m_pStopLtcTimeCode->nSeconds, m_pStopLtcTimeCode->nFrames);
+	if (m_pJamSyncDecoder != 0) {
+		printf(" Jam-sync with LTC input\n");
+	}
 }
 
 void LtcGenerator::Run(void) {
 	Update();
 
+	if (m_pJamSyncDecoder != 0) {
+		HandleJamSync();
+	}
+
 	HandleButtons();
 	HandleUdpRequest();
 
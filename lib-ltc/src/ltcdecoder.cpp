@@ -0,0 +1,440 @@
+/**
+ * @file ltcdecoder.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "ltcdecoder.h"
+#include "ltc.h"
+
+#include "debug.h"
+
+#define FRAME_BITS				80
+
+#define SYNC_WORD_FORWARD		0xBFFC	///< Bits 64..79 : 0011 1111 1111 1101, received LSB first
+#define SYNC_WORD_REVERSE		0x3FFD	///< The same bits received in reverse order
+
+#define EDGE_MIN_US				80		///< Half bit at 30 fps is 208us, allows for 2.5x speed
+#define EDGE_MAX_US				1250	///< Full bit at 24 fps is 521us, allows for 0.4x speed
+#define BIT_PERIOD_SEED_US		463		///< Between the 30 fps (417us) and the 24 fps (521us) bit period
+
+#define JAM_SYNC_FRAMES			2
+
+#define FRAMES_INVALID			0xFF
+
+/*
+ * Edge() runs in the interrupt handler which cannot be interrupted by Run().
+ * A compiler barrier is therefore sufficient for the sequence lock.
+ */
+#define barrier()				asm volatile ("" ::: "memory")
+
+static uint64_t reverse_bits(uint64_t n) {
+	n = ((n >> 1) & 0x5555555555555555ULL) | ((n & 0x5555555555555555ULL) << 1);
+	n = ((n >> 2) & 0x3333333333333333ULL) | ((n & 0x3333333333333333ULL) << 2);
+	n = ((n >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((n & 0x0F0F0F0F0F0F0F0FULL) << 4);
+	return __builtin_bswap64(n);
+}
+
+LtcDecoder::LtcDecoder(void): m_nFreewheelFrames(LTC_DECODER_FREEWHEEL_FRAMES_DEFAULT) {
+	Reset();
+}
+
+LtcDecoder::~LtcDecoder(void) {
+}
+
+/*
+ * Must not be called while Edge() can run
+ */
+void LtcDecoder::Reset(void) {
+	m_nShiftData = 0;
+	m_nShiftSync = 0;
+	m_nEdgePreviousUs = 0;
+	m_nHalfBitUs = 0;
+	m_nBitPeriodUs = BIT_PERIOD_SEED_US;
+	m_nBitsSinceSync = 0;
+	m_nContiguous = 0;
+	m_bHalfBit = false;
+	m_bReversePrevious = false;
+
+	m_tFrame.nData = 0;
+	m_tFrame.nEndUs = 0;
+	m_tFrame.nBitPeriodUs = 0;
+	m_tFrame.nContiguous = 0;
+	m_tFrame.bReverse = false;
+	m_nFrameSequence = 0;
+
+	m_nFrameSequencePrevious = 0;
+	memset(&m_tTimeCode, 0, sizeof(struct TLtcTimeCode));
+	m_tTimeCode.nType = TC_TYPE_EBU;
+	m_tState = LTC_DECODER_STATE_NO_SIGNAL;
+	m_tDirection = LTC_DECODER_FORWARD;
+	m_nFrameStartUs = 0;
+	m_nFrameEndPreviousUs = 0;
+	m_nFramePeriodUs = 0;
+	m_nFreewheelCount = 0;
+	m_nFps = 25;
+	m_nFramesMax = 0;
+	m_nFramesPrevious = FRAMES_INVALID;
+	m_bIsDropFrame = false;
+}
+
+/*
+ * Bi-phase mark: every bit cell starts with a transition, a '1' has an
+ * additional transition in the middle of the cell.
+ */
+void LtcDecoder::Edge(uint32_t nTimeUs) {
+	const uint32_t nDeltaUs = nTimeUs - m_nEdgePreviousUs;
+	m_nEdgePreviousUs = nTimeUs;
+
+	if (__builtin_expect(((nDeltaUs < EDGE_MIN_US) || (nDeltaUs > EDGE_MAX_US)), 0)) {
+		m_bHalfBit = false;
+		m_nBitsSinceSync = 0;
+		m_nContiguous = 0;
+		m_nBitPeriodUs = BIT_PERIOD_SEED_US;
+		return;
+	}
+
+	uint32_t nBitUs;
+	uint32_t nBit;
+
+	if ((4 * nDeltaUs) > (3 * m_nBitPeriodUs)) {
+		m_bHalfBit = false;		// A pending half bit means we were out of phase
+		nBitUs = nDeltaUs;
+		nBit = 0;
+	} else if (!m_bHalfBit) {
+		m_bHalfBit = true;
+		m_nHalfBitUs = nDeltaUs;
+		return;
+	} else {
+		m_bHalfBit = false;
+		nBitUs = m_nHalfBitUs + nDeltaUs;
+		nBit = 1;
+	}
+
+	m_nBitPeriodUs = m_nBitPeriodUs - (m_nBitPeriodUs >> 3) + (nBitUs >> 3);
+
+	ShiftIn(nBit, nTimeUs);
+}
+
+/*
+ * The newest bit enters at bit 15 of m_nShiftSync, the oldest bit leaves at
+ * bit 0 of m_nShiftData. Played forward, a complete frame has the sync word in
+ * m_nShiftSync and bits 0..63 in m_nShiftData. Played in reverse, the sync
+ * word is received first and ends up in the low 16 bits of m_nShiftData.
+ */
+void LtcDecoder::ShiftIn(uint32_t nBit, uint32_t nTimeUs) {
+	m_nShiftData = (m_nShiftData >> 1) | (static_cast<uint64_t>(m_nShiftSync & 0x1) << 63);
+	m_nShiftSync = (m_nShiftSync >> 1) | (nBit << 15);
+
+	if (++m_nBitsSinceSync < FRAME_BITS) {
+		return;
+	}
+
+	if (m_nShiftSync == SYNC_WORD_FORWARD) {
+		Publish(m_nShiftData, false, nTimeUs);
+	} else if ((m_nShiftData & 0xFFFF) == SYNC_WORD_REVERSE) {
+		Publish((m_nShiftData >> 16) | (static_cast<uint64_t>(m_nShiftSync) << 48), true, nTimeUs);
+	}
+}
+
+void LtcDecoder::Publish(uint64_t nData, bool bReverse, uint32_t nTimeUs) {
+	if ((m_nBitsSinceSync == FRAME_BITS) && (bReverse == m_bReversePrevious)) {
+		m_nContiguous++;
+	} else {
+		m_nContiguous = 1;
+	}
+
+	m_nBitsSinceSync = 0;
+	m_bReversePrevious = bReverse;
+
+	m_nFrameSequence++;
+	barrier();
+
+	m_tFrame.nData = nData;
+	m_tFrame.nEndUs = nTimeUs;
+	m_tFrame.nBitPeriodUs = m_nBitPeriodUs;
+	m_tFrame.nContiguous = m_nContiguous;
+	m_tFrame.bReverse = bReverse;
+
+	barrier();
+	m_nFrameSequence++;
+}
+
+bool LtcDecoder::Run(uint32_t nNowUs) {
+	bool bIsUpdated = false;
+
+	if (m_nFrameSequence != m_nFrameSequencePrevious) {
+		bIsUpdated = Consume();
+	}
+
+	if (m_tState == LTC_DECODER_STATE_NO_SIGNAL) {
+		return bIsUpdated;
+	}
+
+	// No sync word at the expected frame boundary: continue at the last measured speed
+	for (;;) {
+		const int32_t nMarginUs = (m_tState == LTC_DECODER_STATE_LOCKED) ? static_cast<int32_t>(m_nFramePeriodUs >> 3) : 0;
+
+		// Signed, the FIQ can publish a frame ending after nNowUs was read
+		if (static_cast<int32_t>(nNowUs - m_nFrameStartUs) < (static_cast<int32_t>(m_nFramePeriodUs) + nMarginUs)) {
+			break;
+		}
+
+		m_tState = LTC_DECODER_STATE_FREEWHEEL;
+		m_nFrameStartUs += m_nFramePeriodUs;
+
+		if (++m_nFreewheelCount > m_nFreewheelFrames) {
+			DEBUG_PUTS("No signal");
+			m_tState = LTC_DECODER_STATE_NO_SIGNAL;
+			m_nFramesMax = 0;
+			m_nFramesPrevious = FRAMES_INVALID;
+			break;
+		}
+
+		Step();
+		bIsUpdated = true;
+	}
+
+	return bIsUpdated;
+}
+
+bool LtcDecoder::Consume(void) {
+	uint32_t nSequence;
+	uint64_t nData;
+	uint32_t nEndUs;
+	uint32_t nBitPeriodUs;
+	uint32_t nContiguous;
+	bool bReverse;
+
+	do {
+		nSequence = m_nFrameSequence;
+		barrier();
+		nData = m_tFrame.nData;
+		nEndUs = m_tFrame.nEndUs;
+		nBitPeriodUs = m_tFrame.nBitPeriodUs;
+		nContiguous = m_tFrame.nContiguous;
+		bReverse = m_tFrame.bReverse;
+		barrier();
+	} while (((nSequence & 0x1) != 0) || (nSequence != m_nFrameSequence));
+
+	// Each frame increments the sequence by 2, the previous frame was consumed when the difference is 2
+	const bool bIsAdjacent = ((nSequence - m_nFrameSequencePrevious) == 2);
+
+	m_nFrameSequencePrevious = nSequence;
+
+	const uint32_t nFrameEndPreviousUs = m_nFrameEndPreviousUs;
+	m_nFrameEndPreviousUs = nEndUs;
+
+	if (nContiguous < JAM_SYNC_FRAMES) {
+		m_nFramesPrevious = FRAMES_INVALID;
+		return false;
+	}
+
+	if (bReverse) {
+		nData = reverse_bits(nData);
+	}
+
+	struct TLtcTimeCode tTimeCode;
+
+	tTimeCode.nFrames = (10 * ((nData >> 8) & 0x03)) + (nData & 0x0F);
+	tTimeCode.nSeconds = (10 * ((nData >> 24) & 0x07)) + ((nData >> 16) & 0x0F);
+	tTimeCode.nMinutes = (10 * ((nData >> 40) & 0x07)) + ((nData >> 32) & 0x0F);
+	tTimeCode.nHours = (10 * ((nData >> 56) & 0x03)) + ((nData >> 48) & 0x0F);
+
+	if ((tTimeCode.nFrames >= 30) || (tTimeCode.nSeconds >= 60) || (tTimeCode.nMinutes >= 60) || (tTimeCode.nHours >= 24)) {
+		DEBUG_PUTS("Invalid timecode");
+		return false;
+	}
+
+	m_bIsDropFrame = (((nData >> 10) & 0x01) != 0);
+
+	/*
+	 * The highest frame number is the one before the frame number wraps (forward),
+	 * or the one after it (reverse). Taken at every wrap, so a rate change is followed.
+	 */
+	if (bIsAdjacent && (m_nFramesPrevious != FRAMES_INVALID)) {
+		if (!bReverse && (tTimeCode.nFrames < m_nFramesPrevious)) {
+			m_nFramesMax = m_nFramesPrevious;
+		} else if (bReverse && (tTimeCode.nFrames > m_nFramesPrevious)) {
+			m_nFramesMax = tTimeCode.nFrames;
+		}
+	}
+
+	// Zero is no wrap seen yet
+	if ((m_nFramesMax != 0) && (tTimeCode.nFrames > m_nFramesMax)) {
+		m_nFramesMax = tTimeCode.nFrames;
+	}
+
+	m_nFramesPrevious = tTimeCode.nFrames;
+
+	/*
+	 * Between two sync words the frame period is measured over 80 bits, the
+	 * filtered bit period is only used when a frame was missed.
+	 */
+	const uint32_t nFramePeriodUs = bIsAdjacent ? (nEndUs - nFrameEndPreviousUs) : (FRAME_BITS * nBitPeriodUs);
+
+	if (m_bIsDropFrame || (m_nFramesMax >= 25)) {
+		m_nFps = 30;
+	} else if (m_nFramesMax == 24) {
+		m_nFps = 25;
+	} else if (m_nFramesMax == 23) {
+		m_nFps = 24;
+	} else {
+		// Not seen a complete second yet, the frame period is only valid at nominal speed
+		m_nFps = (nFramePeriodUs >= 40833) ? 24 : ((nFramePeriodUs >= 36666) ? 25 : 30);
+
+		if (tTimeCode.nFrames >= m_nFps) {
+			m_nFps = (tTimeCode.nFrames >= 25) ? 30 : (tTimeCode.nFrames + 1);
+		}
+	}
+
+	if (m_bIsDropFrame) {
+		tTimeCode.nType = TC_TYPE_DF;
+	} else {
+		tTimeCode.nType = (m_nFps == 24) ? TC_TYPE_FILM : ((m_nFps == 25) ? TC_TYPE_EBU : TC_TYPE_SMPTE);
+	}
+
+	const struct TLtcTimeCode tTimeCodePrevious = m_tTimeCode;
+
+	m_tTimeCode = tTimeCode;
+	m_tDirection = bReverse ? LTC_DECODER_REVERSE : LTC_DECODER_FORWARD;
+	m_nFrameStartUs = nEndUs;
+	m_nFramePeriodUs = nFramePeriodUs;
+	m_nFreewheelCount = 0;
+	m_tState = LTC_DECODER_STATE_LOCKED;
+
+	// The frame just decoded has ended, the timeline is in the next (forward) or previous (reverse) frame
+	Step();
+
+	return (memcmp(&tTimeCodePrevious, &m_tTimeCode, sizeof(struct TLtcTimeCode)) != 0);
+}
+
+void LtcDecoder::Step(void) {
+	struct TLtcTimeCode& tc = m_tTimeCode;
+
+	if (m_tDirection == LTC_DECODER_FORWARD) {
+		if (++tc.nFrames < m_nFps) {
+			return;
+		}
+
+		tc.nFrames = 0;
+
+		if (++tc.nSeconds == 60) {
+			tc.nSeconds = 0;
+
+			if (++tc.nMinutes == 60) {
+				tc.nMinutes = 0;
+
+				if (++tc.nHours == 24) {
+					tc.nHours = 0;
+				}
+			}
+
+			// Drop frame: frames 0 and 1 are skipped every minute, except every 10th minute
+			if (m_bIsDropFrame && ((tc.nMinutes % 10) != 0)) {
+				tc.nFrames = 2;
+			}
+		}
+
+		return;
+	}
+
+	const uint8_t nFramesFirst = (m_bIsDropFrame && (tc.nSeconds == 0) && ((tc.nMinutes % 10) != 0)) ? 2 : 0;
+
+	if (tc.nFrames > nFramesFirst) {
+		tc.nFrames--;
+		return;
+	}
+
+	tc.nFrames = m_nFps - 1;
+
+	if (tc.nSeconds-- == 0) {
+		tc.nSeconds = 59;
+
+		if (tc.nMinutes-- == 0) {
+			tc.nMinutes = 59;
+
+			if (tc.nHours-- == 0) {
+				tc.nHours = 23;
+			}
+		}
+	}
+}
+
+uint32_t LtcDecoder::GetFrameNominalUs(void) {
+	if (m_bIsDropFrame) {
+		return 1001000 / 30;
+	}
+
+	return 1000000 / m_nFps;
+}
+
+uint32_t LtcDecoder::GetSpeed(void) {
+	if (m_tState == LTC_DECODER_STATE_NO_SIGNAL) {
+		return 0;
+	}
+
+	return static_cast<uint32_t>((static_cast<uint64_t>(GetFrameNominalUs()) * 1000) / m_nFramePeriodUs);
+}
+
+uint32_t LtcDecoder::GetSubFrameUs(uint32_t nNowUs) {
+	if (m_tState == LTC_DECODER_STATE_NO_SIGNAL) {
+		return 0;
+	}
+
+	const uint32_t nFrameNominalUs = GetFrameNominalUs();
+	const int32_t nDeltaUs = static_cast<int32_t>(nNowUs - m_nFrameStartUs);
+	uint32_t nElapsedUs = (nDeltaUs < 0) ? 0 : static_cast<uint32_t>(nDeltaUs);
+
+	// Hold at the end of the frame until the next sync word or freewheel step
+	if (nElapsedUs >= m_nFramePeriodUs) {
+		nElapsedUs = m_nFramePeriodUs - 1;
+	}
+
+	const uint32_t nSubFrameUs = static_cast<uint32_t>((static_cast<uint64_t>(nElapsedUs) * nFrameNominalUs) / m_nFramePeriodUs);
+
+	if (m_tDirection == LTC_DECODER_REVERSE) {
+		return nFrameNominalUs - 1 - nSubFrameUs;
+	}
+
+	return nSubFrameUs;
+}
+
+uint64_t LtcDecoder::GetPositionUs(uint32_t nNowUs) {
+	return GetPositionUs(&m_tTimeCode, m_nFps, m_bIsDropFrame) + GetSubFrameUs(nNowUs);
+}
+
+uint64_t LtcDecoder::GetPositionUs(const struct TLtcTimeCode *pTimeCode, uint8_t nFps, bool bIsDropFrame) {
+	const uint32_t nTotalMinutes = (60 * pTimeCode->nHours) + pTimeCode->nMinutes;
+	uint64_t nFrameNumber = static_cast<uint64_t>((60 * nTotalMinutes) + pTimeCode->nSeconds) * nFps + pTimeCode->nFrames;
+
+	if (bIsDropFrame) {
+		nFrameNumber -= 2 * (nTotalMinutes - (nTotalMinutes / 10));
+		return (nFrameNumber * 1001000) / 30;
+	}
+
+	return (nFrameNumber * 1000000) / nFps;
+}
@@ -138,6 +138,16 @@ void LtcParams::callbackFunction(const char* pLine) {
 		}
 	}
 
+	if (Sscan::Uint8(pLine, LtcParamsConst::JAM_SYNC, &value8) == SSCAN_OK) {
+		if (value8 != 0) {
+			m_tLtcParams.nJamSync = 1;
+			m_tLtcParams.nSetList |= LTC_PARAMS_MASK_JAM_SYNC;
+		} else {
+			m_tLtcParams.nJamSync = 0;
+			m_tLtcParams.nSetList &= ~LTC_PARAMS_MASK_JAM_SYNC;
+		}
+	}
+
 	HandleDisabledOutput(pLine, LtcParamsConst::DISABLE_DISPLAY, LTC_PARAMS_DISABLE_DISPLAY);
 	HandleDisabledOutput(pLine, LtcParamsConst::DISABLE_MAX7219, LTC_PARAMS_DISABLE_MAX7219);
 	HandleDisabledOutput(pLine, LtcParamsConst::DISABLE_LTC, LTC_PARAMS_DISABLE_LTC);
@@ -342,6 +352,10 @@ void LtcParams::Dump(void) {
 		printf(" %s=%d\n", LtcParamsConst::AUTO_START, m_tLtcParams.nAutoStart);
 	}
 
+	if (isMaskSet(LTC_PARAMS_MASK_JAM_SYNC)) {
+		printf(" %s=%d\n", LtcParamsConst::JAM_SYNC, m_tLtcParams.nJamSync);
+	}
+
 	if (isMaskSet(LTC_PARAMS_MASK_DISABLED_OUTPUTS)) {
 		printf(" Disabled outputs %.2x:\n", m_tLtcParams.nDisabledOutputs);
 
@@ -27,6 +27,7 @@
 const char LtcParamsConst::FILE_NAME[] = "ltc.txt";
 const char LtcParamsConst::SOURCE[] = "source";
 const char LtcParamsConst::AUTO_START[] = "auto_start";
+const char LtcParamsConst::JAM_SYNC[] = "jam_sync";
 const char LtcParamsConst::DISABLE_DISPLAY[] = "disable_display";
 const char LtcParamsConst::DISABLE_MAX7219[] = "disable_max7219";
 const char LtcParamsConst::DISABLE_MIDI[] = "disable_midi";
@@ -71,6 +71,7 @@ void LtcParams::Builder(const struct TLtcParams *ptLtcParams, char *pBuffer, uin
 	builder.Add(LtcParamsConst::AUTO_START, m_tLtcParams.nAutoStart, isMaskSet(LTC_PARAMS_MASK_AUTO_START));
 
 	builder.AddComment("source=internal");
+	builder.Add(LtcParamsConst::JAM_SYNC, m_tLtcParams.nJamSync, isMaskSet(LTC_PARAMS_MASK_JAM_SYNC));
 	builder.Add(LtcParamsConst::FPS, m_tLtcParams.nFps, isMaskSet(LTC_PARAMS_MASK_FPS));
 	builder.Add(LtcParamsConst::START_HOUR, m_tLtcParams.nStartHour, isMaskSet(LTC_PARAMS_MASK_START_HOUR));
 	builder.Add(LtcParamsConst::START_MINUTE, m_tLtcParams.nStartMinute, isMaskSet(LTC_PARAMS_MASK_START_MINUTE));
@@ -37,7 +37,8 @@ enum TNetwork {
 	NETWORK_IP_SIZE = 4,
 	NETWORK_MAC_SIZE = 6,
 	NETWORK_HOSTNAME_SIZE = 64,		/* including a terminating null byte. */
-	NETWORK_DOMAINNAME_SIZE = 64	/* including a terminating null byte. */
+	NETWORK_DOMAINNAME_SIZE = 64,	/* including a terminating null byte. */
+	NETWORK_SEND_BUFFER_SIZE = 1472	/* MTU - IPv4/UDP headers */
 };
 
 #define IP2STR(addr) (addr & 0xFF), ((addr >> 8) & 0xFF), ((addr >> 16) & 0xFF), ((addr >> 24) & 0xFF)
@@ -64,6 +65,14 @@ public:
 	virtual uint16_t RecvFrom(uint32_t nHandle, void *pBuffer, uint16_t nLength, uint32_t *pFromIp, uint16_t *pFromPort)=0;
 	virtual void SendTo(uint32_t nHandle, const void *pBuffer, uint16_t nLength, uint32_t nToIp, uint16_t nRemotePort)=0;
 
+	/*
+	 * Zero-copy transmit: the payload is built in the buffer returned by GetSendBuffer,
+	 * and then sent with SendBuffer. There must be no other SendTo/SendBuffer in between.
+	 * The default implementation uses a bounce buffer and SendTo.
+	 */
+	virtual uint8_t *GetSendBuffer(void);
+	virtual void SendBuffer(uint32_t nHandle, uint16_t nLength, uint32_t nToIp, uint16_t nRemotePort);
+
 	virtual void SetIp(uint32_t nIp)=0;
 	uint32_t GetIp(void) {
 		return m_nLocalIp;
@@ -167,6 +176,7 @@ protected:
 private:
 	uint32_t m_nQueuedLocalIp;
 	uint32_t m_nQueuedNetmask;
+	uint8_t *m_pSendBuffer;
 
 	static Network *s_pThis;
 };
@@ -52,6 +52,14 @@ public:
 	uint16_t RecvFrom(uint32_t nHandle, void *pBuffer, uint16_t nLength, uint32_t *pFromIp, uint16_t *pFromPort);
 	void SendTo(uint32_t nHandle, const void *pBuffer, uint16_t nLength, uint32_t nToIp, uint16_t nRemotePort);
 
+	uint8_t *GetSendBuffer(void) {
+		return udp_get_send_buffer();
+	}
+
+	void SendBuffer(uint32_t nHandle, uint16_t nLength, uint32_t nToIp, uint16_t nRemotePort) {
+		udp_send_buffer(nHandle, nLength, nToIp, nRemotePort);
+	}
+
 	void SetIp(uint32_t nIp);
 	void SetNetmask(uint32_t nNetmask);
 	void SetHostName(const char *pHostName);
@@ -28,6 +28,7 @@
 
 #include <stdint.h>
 #include <limits.h>
+#include <time.h>
 
 #include "network.h"
 
@@ -53,6 +54,28 @@ public:
 	uint16_t RecvFrom(uint32_t nHandle, void *pBuffer, uint16_t nLength, uint32_t *pFromIp, uint16_t *pFromPort);
 	void SendTo(uint32_t nHandle, const void *pBuffer, uint16_t nLength, uint32_t nToIp, uint16_t nRemotePort);
 
+	/*
+	 * Blocks until a socket is readable or the timeout expires, the queued
+	 * transmit packets are sent first. Returns at once when received packets
+	 * are still queued. Call this from the main loop, instead of polling.
+	 */
+	void Wait(uint32_t nTimeoutMillis);
+
+	/*
+	 * With batch send, SendTo only queues the packet. The queue is sent with
+	 * one sendmmsg() when it is full, when another socket is used, and in Wait().
+	 */
+	void SetBatchSend(bool bBatchSend);
+	void Flush(void);
+
+	/*
+	 * Kernel receive timestamp (CLOCK_REALTIME) of the last packet returned by RecvFrom.
+	 * Zero when the kernel does not provide it.
+	 */
+	const struct timespec *GetReceiveTimestamp(void) const {
+		return &m_ReceiveTimestamp;
+	}
+
 private:
 	uint32_t GetDefaultGateway(void);
 	bool IsDhclient(const char *pIfName);
@@ -61,6 +84,12 @@ private:
 #if defined(__APPLE__)
 	bool OSxGetMacaddress(const char *pIfName, uint8_t *pMacAddress);
 #endif
+	bool Receive(uint32_t nIndex);
+
+private:
+	int m_nEpoll;
+	bool m_bBatchSend;
+	struct timespec m_ReceiveTimestamp;
 };
 
 #endif /* NETWORKLINUX_H_ */
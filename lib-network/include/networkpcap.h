@@ -0,0 +1,151 @@
+/**
+ * @file networkpcap.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef NETWORKPCAP_H_
+#define NETWORKPCAP_H_
+
+/*
+ * In-memory network backend, the UDP/IPv4 packets of a pcap file are received
+ * in file order. Used for offline benchmarks of the Art-Net and sACN nodes.
+ *
+ * RecvFrom() returns the next packet when its destination port is the port of
+ * the handle. Packets for ports without a handle are skipped. Transmitted
+ * packets are counted and passed to the optional send hook.
+ *
+ * Supported link types: Ethernet (with an optional 802.1Q tag), Linux cooked
+ * capture and raw IPv4. IP fragments are skipped.
+ *
+ * Instead of a file, synthetic packets can be added with Create() and Add().
+ * With SetAvailable() the packets are released one by one, for a paced replay.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "network.h"
+#include "profiler.h"
+
+#define NETWORKPCAP_MAX_PORTS	4
+
+typedef void (*networkpcap_send_hook_t)(const uint8_t *pBuffer, uint16_t nLength, uint32_t nToIp, uint16_t nRemotePort);
+
+struct TNetworkPcapPacket {
+	const uint8_t *pPayload;
+	uint32_t nFromIp;			///< Network byte order, as NetworkLinux
+	uint16_t nFromPort;
+	uint16_t nToPort;
+	uint16_t nLength;
+};
+
+class NetworkPcap: public Network {
+public:
+	NetworkPcap(void);
+	~NetworkPcap(void);
+
+	bool Load(const char *pFileName);
+
+	/*
+	 * A table for nPackets synthetic packets, the payloads are not copied.
+	 * The previous table is replaced, the counters are not reset.
+	 */
+	void Create(uint32_t nPackets);
+	bool Add(const uint8_t *pPayload, uint16_t nLength, uint32_t nFromIp, uint16_t nFromPort, uint16_t nToPort);
+
+	int32_t Begin(uint16_t nPort);
+	int32_t End(uint16_t nPort);
+
+	void MacAddressCopyTo(uint8_t *pMacAddress);
+
+	void SetIp(uint32_t nIp);
+	void SetNetmask(uint32_t nNetmask);
+
+	void JoinGroup(uint32_t nHandle, uint32_t nIp) {
+	}
+	void LeaveGroup(uint32_t nHandle, uint32_t nIp) {
+	}
+
+	uint16_t RecvFrom(uint32_t nHandle, void *pBuffer, uint16_t nLength, uint32_t *pFromIp, uint16_t *pFromPort);
+	void SendTo(uint32_t nHandle, const void *pBuffer, uint16_t nLength, uint32_t nToIp, uint16_t nRemotePort);
+
+	/*
+	 * RecvFrom() returns the packets with an index below nPackets only
+	 */
+	void SetAvailable(uint32_t nPackets) {
+		m_nAvailable = nPackets;
+	}
+
+	void SetSendHook(networkpcap_send_hook_t pSendHook) {
+		m_pSendHook = pSendHook;
+	}
+
+	void Rewind(void) {
+		m_nIndex = 0;
+	}
+
+	bool IsEnd(void) const {
+		return m_nIndex == m_nPackets;
+	}
+
+	uint32_t GetPackets(void) const {
+		return m_nPackets;
+	}
+
+	const struct TNetworkPcapPacket *GetPacket(uint32_t nIndex) const {
+		return (nIndex < m_nPackets) ? &m_pPackets[nIndex] : 0;
+	}
+
+	uint32_t GetReceived(void) const {
+		return m_nReceived;
+	}
+
+	uint32_t GetSent(void) const {
+		return m_nSent;
+	}
+
+	/*
+	 * profiler_ticks() of the last packet returned by RecvFrom
+	 */
+	profiler_ticks_t GetReceiveTicks(void) const {
+		return m_nReceiveTicks;
+	}
+
+private:
+	bool AddPacket(const uint8_t *pFrame, uint32_t nLength, uint32_t nLinkType);
+
+private:
+	uint8_t *m_pFile;
+	struct TNetworkPcapPacket *m_pPackets;
+	uint32_t m_nPackets;
+	uint32_t m_nPacketsMax;
+	uint32_t m_nIndex;
+	uint32_t m_nAvailable;
+	uint16_t m_nPorts[NETWORKPCAP_MAX_PORTS];
+	uint32_t m_nReceived;
+	uint32_t m_nSent;
+	profiler_ticks_t m_nReceiveTicks;
+	networkpcap_send_hook_t m_pSendHook;
+};
+
+#endif /* NETWORKPCAP_H_ */
@@ -2,7 +2,7 @@
  * @file tftpdaemon.h
  *
  */
-/* Copyright (C) 2019 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2019-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -34,6 +34,12 @@ enum TTFTPMode {
 	TFTP_MODE_ASCII
 };
 
+enum TTFTPLimits {
+	TFTP_DEFAULT_BLKSIZE = 512,		///< RFC 1350
+	TFTP_MAX_BLKSIZE = 1432,		///< RFC 2348, fits in a single Ethernet frame
+	TFTP_MAX_WINDOWSIZE = 3			///< RFC 7440, the UDP receive queue (a ring of 4 entries) holds 3 packets
+};
+
 class TFTPDaemon {
 public:
 	TFTPDaemon(void);
@@ -46,28 +52,75 @@ public:
 	virtual bool FileClose(void)=0;
 	virtual int FileRead(void *pBuffer, unsigned nCount, unsigned nBlockNumber)=0;
 	virtual int FileWrite(const void *pBuffer, unsigned nCount, unsigned nBlockNumber)=0;
+	/*
+	 * Optional, used for the tsize option (RFC 2349) with a read request
+	 */
+	virtual bool FileSize(uint32_t &nFileSize) {
+		return false;
+	}
 
 	virtual void Exit(void)=0;
 
+	uint16_t GetBlockSize(void) {
+		return m_nBlockSize;
+	}
+
+	uint16_t GetWindowSize(void) {
+		return m_nWindowSize;
+	}
+
+	/*
+	 * The tsize value received with a write request, 0 when not known
+	 */
+	uint32_t GetTransferSize(void) {
+		return m_nTransferSize;
+	}
+
+	/*
+	 * Statistics of the last (or current) transfer
+	 */
+	uint32_t GetTransferBytes(void) {
+		return m_nTransferBytes;
+	}
+
+	uint32_t GetTransferMillis(void) {
+		return m_nTransferMillis;
+	}
+
 private:
+	void ParseOptions(const char *pOptions, const char *pEnd, bool bIsRead);
+	void SendOptionAck(void);
+	bool IsOptionAck(void) const {
+		return (m_nBlockSize != TFTP_DEFAULT_BLKSIZE) || (m_nWindowSize != 1) || m_bOptionTransferSize;
+	}
 	void HandleRequest(void);
 	void HandleRecvAck(void);
 	void HandleRecvData(void);
 	void SendError (uint16_t usErrorCode, const char *pErrorMessage);
 	void DoRead(void);
 	void DoWriteAck(void);
+	void DoTransferDone(void);
 
 private:
 	int m_nState;
 	int m_nIdx;
-	uint8_t m_Buffer[528];
+	uint8_t m_Buffer[4 + TFTP_MAX_BLKSIZE];
 	uint32_t m_nFromIp;
 	uint16_t m_nFromPort;
 	uint16_t m_nLength;
 	uint16_t m_nBlockNumber;
 	uint16_t m_nDataLength;
 	uint16_t m_nPacketLength;
+	uint16_t m_nBlockSize;
+	uint16_t m_nWindowSize;
+	uint16_t m_nWindowCount;
+	uint32_t m_nTransferSize;
+	uint32_t m_nTransferBytes;
+	uint32_t m_nTransferMillis;
+	uint32_t m_nStartMillis;
+	uint32_t m_nLastPacketMillis;
 	bool m_bIsLastBlock;
+	bool m_bOptionTransferSize;
 
 public:
 	static TFTPDaemon* Get(void) {
@@ -33,10 +33,17 @@
 #include <net/if.h>
 #include <ifaddrs.h>
 #include <errno.h>
+#include <time.h>
 #include <assert.h>
+#if defined (__linux__)
+# include <sys/socket.h>
+# include <sys/epoll.h>
+#endif
 
 #include "networklinux.h"
 
+#include "metrics.h"
+
 #include "debug.h"
 
 /**
@@ -55,10 +62,104 @@ static int snHandles[MAX_PORTS_ALLOWED];
  * END
  */
 
-NetworkLinux::NetworkLinux(void) {
+#if defined (__linux__)
+/*
+ * The packets are received in batches with recvmmsg(), there is a queue per socket.
+ * The sockets stay blocking for transmit, the receive is done with MSG_DONTWAIT.
+ */
+#define BATCH_SIZE			32
+#define PACKET_SIZE			1500
+#define RECEIVE_BUFFER_SIZE	(2 * 1024 * 1024)	///< Limited by net.core.rmem_max
+#define CONTROL_SIZE		(CMSG_SPACE(sizeof(struct timespec)) + CMSG_SPACE(sizeof(uint32_t)))
+
+struct TReceiveQueue {
+	struct mmsghdr msgs[BATCH_SIZE];
+	struct iovec iov[BATCH_SIZE];
+	struct sockaddr_in from[BATCH_SIZE];
+	uint8_t control[BATCH_SIZE][CONTROL_SIZE];
+	uint8_t buffer[BATCH_SIZE][PACKET_SIZE];
+	uint32_t nCount;
+	uint32_t nIndex;
+	uint32_t nDrops;		///< SO_RXQ_OVFL, total for the socket
+};
+
+struct TSendQueue {
+	struct mmsghdr msgs[BATCH_SIZE];
+	struct iovec iov[BATCH_SIZE];
+	struct sockaddr_in to[BATCH_SIZE];
+	uint8_t buffer[BATCH_SIZE][PACKET_SIZE];
+	int nSocket;
+	uint32_t nCount;
+};
+
+static struct TReceiveQueue *s_pReceiveQueues[MAX_PORTS_ALLOWED];
+static struct TSendQueue s_SendQueue;
+
+static const uint32_t s_aBatchBounds[METRIC_HISTOGRAM_BUCKETS - 1] = { 1, 2, 4, 8, 16, 24, 31 };
+static const uint32_t s_aLatencyBounds[METRIC_HISTOGRAM_BUCKETS - 1] = { 10, 20, 50, 100, 200, 500, 1000 };
+
+static struct metric s_MetricRxBatch = METRIC_HISTOGRAM("net.rx.batch", s_aBatchBounds);
+static struct metric s_MetricRxDrops = METRIC_COUNTER("net.rx.drops");
+static struct metric s_MetricRxLatency = METRIC_HISTOGRAM("net.rx.latency_us", s_aLatencyBounds);
+static struct metric s_MetricTxBatch = METRIC_HISTOGRAM("net.tx.batch", s_aBatchBounds);
+
+static int32_t get_index(uint32_t nHandle) {
+	for (int32_t i = 0; i < MAX_PORTS_ALLOWED; i++) {
+		if (snHandles[i] == static_cast<int>(nHandle)) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+#endif
+
+static struct metric s_MetricRxPackets = METRIC_COUNTER("net.rx.packets");
+static struct metric s_MetricTxPackets = METRIC_COUNTER("net.tx.packets");
+static struct metric s_MetricTxDrops = METRIC_COUNTER("net.tx.drops");
+
+NetworkLinux::NetworkLinux(void): m_nEpoll(-1), m_bBatchSend(false) {
+	m_ReceiveTimestamp.tv_sec = 0;
+	m_ReceiveTimestamp.tv_nsec = 0;
+
+#if defined (__linux__)
+	for (uint32_t i = 0; i < BATCH_SIZE; i++) {
+		s_SendQueue.iov[i].iov_base = s_SendQueue.buffer[i];
+		s_SendQueue.msgs[i].msg_hdr.msg_name = &s_SendQueue.to[i];
+		s_SendQueue.msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+		s_SendQueue.msgs[i].msg_hdr.msg_iov = &s_SendQueue.iov[i];
+		s_SendQueue.msgs[i].msg_hdr.msg_iovlen = 1;
+		s_SendQueue.msgs[i].msg_hdr.msg_control = 0;
+		s_SendQueue.msgs[i].msg_hdr.msg_controllen = 0;
+		s_SendQueue.msgs[i].msg_hdr.msg_flags = 0;
+	}
+
+	s_SendQueue.nCount = 0;
+
+	metrics_register(&s_MetricRxBatch);
+	metrics_register(&s_MetricRxDrops);
+	metrics_register(&s_MetricRxLatency);
+	metrics_register(&s_MetricTxBatch);
+#endif
+
+	metrics_register(&s_MetricRxPackets);
+	metrics_register(&s_MetricTxPackets);
+	metrics_register(&s_MetricTxDrops);
 }
 
 NetworkLinux::~NetworkLinux(void) {
+	Flush();
+
+#if defined (__linux__)
+	for (uint32_t i = 0; i < MAX_PORTS_ALLOWED; i++) {
+		delete s_pReceiveQueues[i];
+		s_pReceiveQueues[i] = 0;
+	}
+
+	if (m_nEpoll >= 0) {
+		close(m_nEpoll);
+	}
+#endif
 }
 
 int NetworkLinux::Init(const char *s) {
@@ -152,7 +253,7 @@ int32_t NetworkLinux::Begin(uint16_t nPort) {
 
 	for (i = 0; i < MAX_PORTS_ALLOWED; i++) {
 		if (s_ports_allowed[i] == nPort) {
-			return i;
+			return snHandles[i];
 		}
 
 		if (s_ports_allowed[i] == 0) {
@@ -182,6 +283,21 @@ int32_t NetworkLinux::Begin(uint16_t nPort) {
 		exit(EXIT_FAILURE);
 	}
 
+#if defined (__linux__)
+	const int nReceiveBufferSize = RECEIVE_BUFFER_SIZE;
+
+	if (setsockopt(nSocket, SOL_SOCKET, SO_RCVBUF, &nReceiveBufferSize, sizeof(int)) == -1) {
+		perror("setsockopt(SO_RCVBUF)");
+	}
+
+	if (setsockopt(nSocket, SOL_SOCKET, SO_TIMESTAMPNS, &true_flag, sizeof(int)) == -1) {
+		perror("setsockopt(SO_TIMESTAMPNS)");
+	}
+
+	if (setsockopt(nSocket, SOL_SOCKET, SO_RXQ_OVFL, &true_flag, sizeof(int)) == -1) {
+		perror("setsockopt(SO_RXQ_OVFL)");
+	}
+#else
 	struct timeval recv_timeout;
 	recv_timeout.tv_sec = 0;
 	recv_timeout.tv_usec = 10;
@@ -190,6 +306,7 @@ int32_t NetworkLinux::Begin(uint16_t nPort) {
 		perror("setsockopt(SO_RCVTIMEO)");
 		exit(EXIT_FAILURE);
 	}
+#endif
 
     memset(&si_me, 0, sizeof(si_me));
 
@@ -217,6 +334,42 @@ int32_t NetworkLinux::Begin(uint16_t nPort) {
 
 	snHandles[i] = nSocket;
 
+#if defined (__linux__)
+	struct TReceiveQueue *pQueue = new struct TReceiveQueue;
+	assert(pQueue != 0);
+
+	for (uint32_t j = 0; j < BATCH_SIZE; j++) {
+		pQueue->iov[j].iov_base = pQueue->buffer[j];
+		pQueue->iov[j].iov_len = PACKET_SIZE;
+		pQueue->msgs[j].msg_hdr.msg_name = &pQueue->from[j];
+		pQueue->msgs[j].msg_hdr.msg_iov = &pQueue->iov[j];
+		pQueue->msgs[j].msg_hdr.msg_iovlen = 1;
+		pQueue->msgs[j].msg_hdr.msg_control = pQueue->control[j];
+		pQueue->msgs[j].msg_hdr.msg_flags = 0;
+	}
+
+	pQueue->nCount = 0;
+	pQueue->nIndex = 0;
+	pQueue->nDrops = 0;
+
+	s_pReceiveQueues[i] = pQueue;
+
+	if (m_nEpoll < 0) {
+		if ((m_nEpoll = epoll_create1(0)) == -1) {
+			perror("epoll_create1");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	struct epoll_event event;
+	event.events = EPOLLIN;
+	event.data.u32 = i;
+
+	if (epoll_ctl(m_nEpoll, EPOLL_CTL_ADD, nSocket, &event) == -1) {
+		perror("epoll_ctl");
+	}
+#endif
+
 	return nSocket;
 }
 
@@ -242,6 +395,14 @@ int32_t NetworkLinux::End(uint16_t nPort) {
 	for (i = 0; i < MAX_PORTS_ALLOWED; i++) {
 		if (s_ports_allowed[i] == nPort) {
 			s_ports_allowed[i] = 0;
+#if defined (__linux__)
+			if (s_SendQueue.nSocket == snHandles[i]) {
+				Flush();
+			}
+
+			delete s_pReceiveQueues[i];
+			s_pReceiveQueues[i] = 0;
+#endif
 			printf("close");
 			if (close(snHandles[i]) == -1) {
 				perror("unbind");
@@ -334,6 +495,92 @@ void NetworkLinux::LeaveGroup(uint32_t nHandle, uint32_t ip) {
 	}
 }
 
+#if defined (__linux__)
+bool NetworkLinux::Receive(uint32_t nIndex) {
+	struct TReceiveQueue *pQueue = s_pReceiveQueues[nIndex];
+
+	for (uint32_t i = 0; i < BATCH_SIZE; i++) {
+		pQueue->msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+		pQueue->msgs[i].msg_hdr.msg_controllen = CONTROL_SIZE;
+	}
+
+	const int nReceived = recvmmsg(snHandles[nIndex], pQueue->msgs, BATCH_SIZE, MSG_DONTWAIT, 0);
+
+	if (nReceived <= 0) {
+		if ((nReceived == -1) && (errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+			perror("recvmmsg");
+		}
+		return false;
+	}
+
+	pQueue->nCount = static_cast<uint32_t>(nReceived);
+	pQueue->nIndex = 0;
+
+	metric_observe(&s_MetricRxBatch, pQueue->nCount);
+
+	return true;
+}
+
+uint16_t NetworkLinux::RecvFrom(uint32_t nHandle, void *pPacket, uint16_t nSize, uint32_t *pFromIp, uint16_t *pFromPort) {
+	assert(pPacket != NULL);
+	assert(pFromIp != NULL);
+	assert(pFromPort != NULL);
+
+	const int32_t nIndex = get_index(nHandle);
+
+	if (nIndex < 0) {
+		return 0;
+	}
+
+	struct TReceiveQueue *pQueue = s_pReceiveQueues[nIndex];
+
+	if ((pQueue->nIndex == pQueue->nCount) && !Receive(nIndex)) {
+		return 0;
+	}
+
+	const uint32_t nPacket = pQueue->nIndex++;
+	struct msghdr *pHeader = &pQueue->msgs[nPacket].msg_hdr;
+	const uint16_t nLength = (pQueue->msgs[nPacket].msg_len < nSize) ? static_cast<uint16_t>(pQueue->msgs[nPacket].msg_len) : nSize;
+
+	memcpy(pPacket, pQueue->buffer[nPacket], nLength);
+
+	*pFromIp = pQueue->from[nPacket].sin_addr.s_addr;
+	*pFromPort = ntohs(pQueue->from[nPacket].sin_port);
+
+	m_ReceiveTimestamp.tv_sec = 0;
+	m_ReceiveTimestamp.tv_nsec = 0;
+
+	for (struct cmsghdr *pCmsg = CMSG_FIRSTHDR(pHeader); pCmsg != 0; pCmsg = CMSG_NXTHDR(pHeader, pCmsg)) {
+		if (pCmsg->cmsg_level != SOL_SOCKET) {
+			continue;
+		}
+
+		if (pCmsg->cmsg_type == SCM_TIMESTAMPNS) {
+			memcpy(&m_ReceiveTimestamp, CMSG_DATA(pCmsg), sizeof(struct timespec));
+		} else if (pCmsg->cmsg_type == SO_RXQ_OVFL) {
+			uint32_t nDrops;
+			memcpy(&nDrops, CMSG_DATA(pCmsg), sizeof(uint32_t));
+			metric_add(&s_MetricRxDrops, nDrops - pQueue->nDrops);
+			pQueue->nDrops = nDrops;
+		}
+	}
+
+	if (m_ReceiveTimestamp.tv_sec != 0) {
+		struct timespec now;
+		clock_gettime(CLOCK_REALTIME, &now);
+
+		const int64_t nMicros = ((now.tv_sec - m_ReceiveTimestamp.tv_sec) * 1000000LL) + ((now.tv_nsec - m_ReceiveTimestamp.tv_nsec) / 1000);
+
+		if (nMicros >= 0) {
+			metric_observe(&s_MetricRxLatency, (nMicros > UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(nMicros));
+		}
+	}
+
+	metric_inc(&s_MetricRxPackets);
+
+	return nLength;
+}
+#else
 uint16_t NetworkLinux::RecvFrom(uint32_t nHandle, void *pPacket, uint16_t nSize, uint32_t *pFromIp, uint16_t *pFromPort) {
 	assert(pPacket != NULL);
 	assert(pFromIp != NULL);
@@ -354,9 +601,13 @@ uint16_t NetworkLinux::RecvFrom(uint32_t nHandle, void *pPacket, uint16_t nSize,
 	*pFromIp = si_other.sin_addr.s_addr;
 	*pFromPort = ntohs(si_other.sin_port);
 
+	metric_inc(&s_MetricRxPackets);
+
 	return recv_len;
 }
 
+#endif
+
 void NetworkLinux::SendTo(uint32_t nHandle, const void *pPacket, uint16_t nSize, uint32_t nToIp, uint16_t nRemotePort) {
 	struct sockaddr_in si_other;
 	int slen = sizeof(si_other);
@@ -367,13 +618,104 @@ void NetworkLinux::SendTo(uint32_t nHandle, const void *pPacket, uint16_t nSize,
 	printf("network_sendto(%p, %d, %s, %d)\n", pPacket, nSize, inet_ntoa(in), nRemotePort);
 #endif
 
+#if defined (__linux__)
+	if (m_bBatchSend && (nSize <= PACKET_SIZE)) {
+		if ((s_SendQueue.nCount == BATCH_SIZE) || ((s_SendQueue.nCount != 0) && (s_SendQueue.nSocket != static_cast<int>(nHandle)))) {
+			Flush();
+		}
+
+		const uint32_t i = s_SendQueue.nCount++;
+
+		memcpy(s_SendQueue.buffer[i], pPacket, nSize);
+		s_SendQueue.iov[i].iov_len = nSize;
+		s_SendQueue.to[i].sin_family = AF_INET;
+		s_SendQueue.to[i].sin_addr.s_addr = nToIp;
+		s_SendQueue.to[i].sin_port = htons(nRemotePort);
+		s_SendQueue.nSocket = static_cast<int>(nHandle);
+
+		return;
+	}
+
+	// Keep the order with the queued packets
+	Flush();
+#endif
+
     si_other.sin_family = AF_INET;
 	si_other.sin_addr.s_addr = nToIp;
 	si_other.sin_port = htons(nRemotePort);
 
 	if (sendto(nHandle, pPacket, nSize, 0, (struct sockaddr*) &si_other, slen) == -1) {
 		perror("sendto");
+		metric_inc(&s_MetricTxDrops);
+		return;
+	}
+
+	metric_inc(&s_MetricTxPackets);
+}
+
+void NetworkLinux::SetBatchSend(bool bBatchSend) {
+	if (!bBatchSend) {
+		Flush();
+	}
+
+	m_bBatchSend = bBatchSend;
+}
+
+void NetworkLinux::Flush(void) {
+#if defined (__linux__)
+	const uint32_t nCount = s_SendQueue.nCount;
+	uint32_t nSent = 0;
+
+	uint32_t nDrops = 0;
+
+	while ((nSent + nDrops) < nCount) {
+		const uint32_t nIndex = nSent + nDrops;
+		const int nResult = sendmmsg(s_SendQueue.nSocket, &s_SendQueue.msgs[nIndex], nCount - nIndex, 0);
+
+		if (nResult <= 0) {
+			if (nResult < 0 && errno == EINTR) {
+				continue;
+			}
+			// The first message failed, skip it so that the others are still sent
+			perror("sendmmsg");
+			nDrops++;
+			continue;
+		}
+
+		nSent += static_cast<uint32_t>(nResult);
 	}
+
+	if (nCount != 0) {
+		metric_observe(&s_MetricTxBatch, nCount);
+		metric_add(&s_MetricTxPackets, nSent);
+		metric_add(&s_MetricTxDrops, nDrops);
+	}
+
+	s_SendQueue.nCount = 0;
+#endif
+}
+
+void NetworkLinux::Wait(uint32_t nTimeoutMillis) {
+	Flush();
+
+#if defined (__linux__)
+	for (uint32_t i = 0; i < MAX_PORTS_ALLOWED; i++) {
+		if ((s_pReceiveQueues[i] != 0) && (s_pReceiveQueues[i]->nIndex != s_pReceiveQueues[i]->nCount)) {
+			return;
+		}
+	}
+
+	if (m_nEpoll < 0) {
+		return;
+	}
+
+	// Level triggered, the packets are read by RecvFrom
+	struct epoll_event events[MAX_PORTS_ALLOWED];
+
+	if ((epoll_wait(m_nEpoll, events, MAX_PORTS_ALLOWED, static_cast<int>(nTimeoutMillis)) == -1) && (errno != EINTR)) {
+		perror("epoll_wait");
+	}
+#endif
 }
 
 #if defined(__linux__)
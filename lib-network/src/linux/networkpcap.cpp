@@ -0,0 +1,398 @@
+/**
+ * @file networkpcap.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "networkpcap.h"
+
+#include "profiler.h"
+
+#include "debug.h"
+
+#define PCAP_MAGIC				0xA1B2C3D4
+#define PCAP_MAGIC_NANOSECONDS	0xA1B23C4D
+#define PCAP_HEADER_SIZE		24
+#define PCAP_RECORD_SIZE		16
+
+enum TLinkType {
+	LINKTYPE_ETHERNET = 1,
+	LINKTYPE_RAW = 101,
+	LINKTYPE_LINUX_SLL = 113,
+	LINKTYPE_IPV4 = 228
+};
+
+#define ETHERTYPE_IPV4		0x0800
+#define ETHERTYPE_VLAN		0x8100
+#define IP_PROTOCOL_UDP		17
+
+static uint32_t get_uint32(const uint8_t *p, bool bIsSwapped) {
+	uint32_t n;
+	memcpy(&n, p, sizeof(uint32_t));
+	return bIsSwapped ? __builtin_bswap32(n) : n;
+}
+
+static uint16_t get_uint16_be(const uint8_t *p) {
+	return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+NetworkPcap::NetworkPcap(void):
+	m_pFile(0),
+	m_pPackets(0),
+	m_nPackets(0),
+	m_nPacketsMax(0),
+	m_nIndex(0),
+	m_nAvailable(UINT32_MAX),
+	m_nReceived(0),
+	m_nSent(0),
+	m_nReceiveTicks(0),
+	m_pSendHook(0)
+{
+	DEBUG_ENTRY
+
+	for (uint32_t i = 0; i < NETWORKPCAP_MAX_PORTS; i++) {
+		m_nPorts[i] = 0;
+	}
+
+	memset(m_aNetMacaddr, 0, NETWORK_MAC_SIZE);
+
+	m_nLocalIp = 0x6402A8C0;	// 192.168.2.100
+	m_nNetmask = 0x00FFFFFF;	// 255.255.255.0
+	m_IsDhcpCapable = false;
+
+	strncpy(m_aHostName, "pcap", NETWORK_HOSTNAME_SIZE - 1);
+	strncpy(m_aIfName, "pcap", IFNAMSIZ - 1);
+
+	DEBUG_EXIT
+}
+
+NetworkPcap::~NetworkPcap(void) {
+	DEBUG_ENTRY
+
+	delete[] m_pPackets;
+	m_pPackets = 0;
+
+	delete[] m_pFile;
+	m_pFile = 0;
+
+	DEBUG_EXIT
+}
+
+/*
+ * The whole file is kept in memory, the packet table points into it
+ */
+bool NetworkPcap::Load(const char *pFileName) {
+	DEBUG_ENTRY
+	assert(pFileName != 0);
+	assert(m_pFile == 0);
+	assert(m_pPackets == 0);
+
+	FILE *pFile = fopen(pFileName, "rb");
+
+	if (pFile == 0) {
+		perror(pFileName);
+		DEBUG_EXIT
+		return false;
+	}
+
+	fseek(pFile, 0, SEEK_END);
+	const long nSize = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+
+	if (nSize < PCAP_HEADER_SIZE) {
+		fprintf(stderr, "%s: not a pcap file\n", pFileName);
+		fclose(pFile);
+		DEBUG_EXIT
+		return false;
+	}
+
+	m_pFile = new uint8_t[nSize];
+	assert(m_pFile != 0);
+
+	const size_t nRead = fread(m_pFile, 1, nSize, pFile);
+	fclose(pFile);
+
+	if (nRead != static_cast<size_t>(nSize)) {
+		perror(pFileName);
+		DEBUG_EXIT
+		return false;
+	}
+
+	uint32_t nMagic;
+	memcpy(&nMagic, m_pFile, sizeof(uint32_t));
+
+	bool bIsSwapped;
+
+	if ((nMagic == PCAP_MAGIC) || (nMagic == PCAP_MAGIC_NANOSECONDS)) {
+		bIsSwapped = false;
+	} else if ((__builtin_bswap32(nMagic) == PCAP_MAGIC) || (__builtin_bswap32(nMagic) == PCAP_MAGIC_NANOSECONDS)) {
+		bIsSwapped = true;
+	} else {
+		fprintf(stderr, "%s: not a pcap file (pcapng is not supported)\n", pFileName);
+		DEBUG_EXIT
+		return false;
+	}
+
+	const uint32_t nLinkType = get_uint32(&m_pFile[20], bIsSwapped);
+
+	// Count the records first, the table is allocated once
+	uint32_t nRecords = 0;
+	long nOffset = PCAP_HEADER_SIZE;
+
+	while ((nOffset + PCAP_RECORD_SIZE) <= nSize) {
+		const uint32_t nCapturedLength = get_uint32(&m_pFile[nOffset + 8], bIsSwapped);
+		nOffset += PCAP_RECORD_SIZE + nCapturedLength;
+		nRecords++;
+	}
+
+	m_pPackets = new struct TNetworkPcapPacket[nRecords];
+	assert(m_pPackets != 0);
+	m_nPacketsMax = nRecords;
+
+	nOffset = PCAP_HEADER_SIZE;
+
+	for (uint32_t i = 0; i < nRecords; i++) {
+		const uint32_t nCapturedLength = get_uint32(&m_pFile[nOffset + 8], bIsSwapped);
+
+		if ((nOffset + PCAP_RECORD_SIZE + nCapturedLength) > static_cast<uint32_t>(nSize)) {
+			break;	// Truncated capture
+		}
+
+		AddPacket(&m_pFile[nOffset + PCAP_RECORD_SIZE], nCapturedLength, nLinkType);
+
+		nOffset += PCAP_RECORD_SIZE + nCapturedLength;
+	}
+
+	printf("%s: link type %u, %u records, %u UDP packets\n", pFileName, nLinkType, nRecords, m_nPackets);
+
+	DEBUG_EXIT
+	return true;
+}
+
+void NetworkPcap::Create(uint32_t nPackets) {
+	DEBUG_ENTRY
+	assert(m_pFile == 0);
+
+	if (m_pPackets != 0) {
+		delete[] m_pPackets;
+	}
+
+	m_nPackets = 0;
+	m_nIndex = 0;
+	m_nAvailable = UINT32_MAX;
+
+	m_pPackets = new struct TNetworkPcapPacket[nPackets];
+	assert(m_pPackets != 0);
+
+	m_nPacketsMax = nPackets;
+
+	DEBUG_EXIT
+}
+
+bool NetworkPcap::Add(const uint8_t *pPayload, uint16_t nLength, uint32_t nFromIp, uint16_t nFromPort, uint16_t nToPort) {
+	assert(pPayload != 0);
+
+	if (m_nPackets == m_nPacketsMax) {
+		return false;
+	}
+
+	struct TNetworkPcapPacket *pPacket = &m_pPackets[m_nPackets++];
+
+	pPacket->pPayload = pPayload;
+	pPacket->nFromIp = nFromIp;
+	pPacket->nFromPort = nFromPort;
+	pPacket->nToPort = nToPort;
+	pPacket->nLength = nLength;
+
+	return true;
+}
+
+bool NetworkPcap::AddPacket(const uint8_t *pFrame, uint32_t nLength, uint32_t nLinkType) {
+	uint32_t nHeaderLength;
+	uint16_t nEtherType;
+
+	switch (nLinkType) {
+	case LINKTYPE_ETHERNET:
+		if (nLength < 14) {
+			return false;
+		}
+		nEtherType = get_uint16_be(&pFrame[12]);
+		nHeaderLength = 14;
+		if ((nEtherType == ETHERTYPE_VLAN) && (nLength >= 18)) {
+			nEtherType = get_uint16_be(&pFrame[16]);
+			nHeaderLength = 18;
+		}
+		break;
+	case LINKTYPE_LINUX_SLL:
+		if (nLength < 16) {
+			return false;
+		}
+		nEtherType = get_uint16_be(&pFrame[14]);
+		nHeaderLength = 16;
+		break;
+	case LINKTYPE_RAW:
+	case LINKTYPE_IPV4:
+		nEtherType = ETHERTYPE_IPV4;
+		nHeaderLength = 0;
+		break;
+	default:
+		return false;
+	}
+
+	if (nEtherType != ETHERTYPE_IPV4) {
+		return false;
+	}
+
+	const uint8_t *pIp = &pFrame[nHeaderLength];
+	nLength -= nHeaderLength;
+
+	if ((nLength < 20) || ((pIp[0] >> 4) != 4) || (pIp[9] != IP_PROTOCOL_UDP)) {
+		return false;
+	}
+
+	// More fragments or a fragment offset
+	if ((get_uint16_be(&pIp[6]) & 0x3FFF) != 0) {
+		return false;
+	}
+
+	const uint32_t nIpHeaderLength = (pIp[0] & 0x0F) * 4U;
+	const uint32_t nIpLength = get_uint16_be(&pIp[2]);
+
+	if ((nIpHeaderLength < 20) || (nIpLength > nLength) || (nIpLength < (nIpHeaderLength + 8))) {
+		return false;	// Also a capture with a snap length that cuts the packet
+	}
+
+	const uint8_t *pUdp = &pIp[nIpHeaderLength];
+	const uint32_t nUdpLength = get_uint16_be(&pUdp[4]);
+
+	if ((nUdpLength < 8) || (nUdpLength > (nIpLength - nIpHeaderLength))) {
+		return false;
+	}
+
+	struct TNetworkPcapPacket *pPacket = &m_pPackets[m_nPackets++];
+
+	memcpy(&pPacket->nFromIp, &pIp[12], sizeof(uint32_t));
+	pPacket->nFromPort = get_uint16_be(&pUdp[0]);
+	pPacket->nToPort = get_uint16_be(&pUdp[2]);
+	pPacket->pPayload = &pUdp[8];
+	pPacket->nLength = static_cast<uint16_t>(nUdpLength - 8);
+
+	return true;
+}
+
+int32_t NetworkPcap::Begin(uint16_t nPort) {
+	DEBUG_PRINTF("nPort=%u", nPort);
+
+	for (uint32_t i = 0; i < NETWORKPCAP_MAX_PORTS; i++) {
+		if ((m_nPorts[i] == nPort) || (m_nPorts[i] == 0)) {
+			m_nPorts[i] = nPort;
+			return i;
+		}
+	}
+
+	assert(0);
+	return -1;
+}
+
+int32_t NetworkPcap::End(uint16_t nPort) {
+	DEBUG_PRINTF("nPort=%u", nPort);
+
+	for (uint32_t i = 0; i < NETWORKPCAP_MAX_PORTS; i++) {
+		if (m_nPorts[i] == nPort) {
+			m_nPorts[i] = 0;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+void NetworkPcap::MacAddressCopyTo(uint8_t *pMacAddress) {
+	assert(pMacAddress != 0);
+
+	memcpy(pMacAddress, m_aNetMacaddr, NETWORK_MAC_SIZE);
+}
+
+void NetworkPcap::SetIp(uint32_t nIp) {
+	m_nLocalIp = nIp;
+}
+
+void NetworkPcap::SetNetmask(uint32_t nNetmask) {
+	m_nNetmask = nNetmask;
+}
+
+uint16_t NetworkPcap::RecvFrom(uint32_t nHandle, void *pBuffer, uint16_t nLength, uint32_t *pFromIp, uint16_t *pFromPort) {
+	assert(nHandle < NETWORKPCAP_MAX_PORTS);
+	assert(pBuffer != 0);
+	assert(pFromIp != 0);
+	assert(pFromPort != 0);
+
+	const uint32_t nPackets = (m_nAvailable < m_nPackets) ? m_nAvailable : m_nPackets;
+
+	// Skip the packets nobody listens to
+	while (m_nIndex < nPackets) {
+		const uint16_t nToPort = m_pPackets[m_nIndex].nToPort;
+		uint32_t i;
+
+		for (i = 0; i < NETWORKPCAP_MAX_PORTS; i++) {
+			if ((m_nPorts[i] != 0) && (m_nPorts[i] == nToPort)) {
+				break;
+			}
+		}
+
+		if (i != NETWORKPCAP_MAX_PORTS) {
+			break;
+		}
+
+		m_nIndex++;
+	}
+
+	if ((m_nIndex >= nPackets) || (m_pPackets[m_nIndex].nToPort != m_nPorts[nHandle])) {
+		return 0;
+	}
+
+	const struct TNetworkPcapPacket *pPacket = &m_pPackets[m_nIndex++];
+	const uint16_t nBytes = (pPacket->nLength < nLength) ? pPacket->nLength : nLength;
+
+	memcpy(pBuffer, pPacket->pPayload, nBytes);
+
+	*pFromIp = pPacket->nFromIp;
+	*pFromPort = pPacket->nFromPort;
+
+	m_nReceived++;
+	m_nReceiveTicks = profiler_ticks();
+
+	return nBytes;
+}
+
+void NetworkPcap::SendTo(uint32_t nHandle, const void *pBuffer, uint16_t nLength, uint32_t nToIp, uint16_t nRemotePort) {
+	m_nSent++;
+
+	if (m_pSendHook != 0) {
+		m_pSendHook(static_cast<const uint8_t *>(pBuffer), nLength, nToIp, nRemotePort);
+	}
+}
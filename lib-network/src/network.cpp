@@ -46,7 +46,8 @@ Network::Network(void) :
 	m_pNetworkDisplay(0),
 	m_pNetworkStore(0),
 	m_nQueuedLocalIp(0),
-	m_nQueuedNetmask(0)
+	m_nQueuedNetmask(0),
+	m_pSendBuffer(0)
 {
 	assert(s_pThis == 0);
 	s_pThis = this;
@@ -58,9 +59,28 @@ Network::Network(void) :
 }
 
 Network::~Network(void) {
+	delete[] m_pSendBuffer;
+	m_pSendBuffer = 0;
+
 	s_pThis = 0;
 }
 
+uint8_t *Network::GetSendBuffer(void) {
+	if (m_pSendBuffer == 0) {
+		m_pSendBuffer = new uint8_t[NETWORK_SEND_BUFFER_SIZE];
+		assert(m_pSendBuffer != 0);
+	}
+
+	return m_pSendBuffer;
+}
+
+void Network::SendBuffer(uint32_t nHandle, uint16_t nLength, uint32_t nToIp, uint16_t nRemotePort) {
+	assert(m_pSendBuffer != 0);
+	assert(nLength <= NETWORK_SEND_BUFFER_SIZE);
+
+	SendTo(nHandle, m_pSendBuffer, nLength, nToIp, nRemotePort);
+}
+
 bool Network::SetStaticIp(bool bQueueing, uint32_t nLocalIp, uint32_t nNetmask) {
 	DEBUG_PRINTF("bQueueing=%d, nLocalIp=" IPSTR ", nNetmask=" IPSTR, static_cast<int>(bQueueing), IP2STR(nLocalIp), IP2STR(nNetmask));
 
@@ -25,15 +25,23 @@
 
 /*
  * https://tools.ietf.org/html/rfc1350
+ * https://tools.ietf.org/html/rfc2347 Option Extension
+ * https://tools.ietf.org/html/rfc2348 Blocksize Option
+ * https://tools.ietf.org/html/rfc2349 Transfer Size Option
+ * https://tools.ietf.org/html/rfc7440 Windowsize Option
  */
 
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <assert.h>
 
 #include "tftpdaemon.h"
 
 #include "network.h"
+#include "hardware.h"
 
 #include "debug.h"
 
@@ -51,7 +59,8 @@ enum TOpCode {
 	OP_CODE_WRQ = 2,			///< Write request (WRQ)
 	OP_CODE_DATA = 3,			///< Data (DATA)
 	OP_CODE_ACK = 4,			///< Acknowledgment (ACK)
-	OP_CODE_ERROR = 5			///< Error (ERROR)
+	OP_CODE_ERROR = 5,			///< Error (ERROR)
+	OP_CODE_OACK = 6			///< Option Acknowledgment (OACK)
 };
 
 enum TErrorCode {
@@ -69,9 +78,9 @@ enum TErrorCode {
 #define MAX_FILENAME_LEN		128
 #define MAX_MODE_LEN			16
 #define MIN_FILENAME_MODE_LEN	(1+1+1+1)
-#define MAX_FILENAME_MODE_LEN	(MAX_FILENAME_LEN+1+MAX_MODE_LEN+1)
-#define MAX_DATA_LEN			512
 #define MAX_ERRMSG_LEN			128
+#define MIN_BLKSIZE				8
+#define TIMEOUT_MILLIS			1000
 
 #if  !defined (PACKED)
  #define PACKED __attribute__((packed))
@@ -79,7 +88,7 @@ enum TErrorCode {
 
 struct TTFTPReqPacket {
 	uint16_t OpCode;
-	char FileNameMode[MAX_FILENAME_MODE_LEN];
+	char FileNameMode[TFTP_MAX_BLKSIZE + 2];
 } PACKED;
 
 struct TTFTPAckPacket {
@@ -96,7 +105,12 @@ struct TTFTPErrorPacket {
 struct TTFTPDataPacket {
 	uint16_t OpCode;
 	uint16_t BlockNumber;
-	uint8_t Data[MAX_DATA_LEN];
+	uint8_t Data[TFTP_MAX_BLKSIZE];
+} PACKED;
+
+struct TTFTPOAckPacket {
+	uint16_t OpCode;
+	char Options[TFTP_MAX_BLKSIZE + 2];
 } PACKED;
 
 TFTPDaemon *TFTPDaemon::s_pThis = 0;
@@ -110,7 +124,16 @@ TFTPDaemon::TFTPDaemon(void):
 		m_nBlockNumber(0),
 		m_nDataLength(0),
 		m_nPacketLength(0),
-		m_bIsLastBlock(false)
+		m_nBlockSize(TFTP_DEFAULT_BLKSIZE),
+		m_nWindowSize(1),
+		m_nWindowCount(0),
+		m_nTransferSize(0),
+		m_nTransferBytes(0),
+		m_nTransferMillis(0),
+		m_nStartMillis(0),
+		m_nLastPacketMillis(0),
+		m_bIsLastBlock(false),
+		m_bOptionTransferSize(false)
 {
 	DEBUG_ENTRY
 	DEBUG_PRINTF("s_pThis=%p", s_pThis);
@@ -153,9 +176,14 @@ bool TFTPDaemon::Run(void) {
 		DEBUG_PRINTF("m_nIdx=%d", m_nIdx);
 
 		m_nBlockNumber = 0;
+		m_nBlockSize = TFTP_DEFAULT_BLKSIZE;
+		m_nWindowSize = 1;
+		m_nWindowCount = 0;
+		m_nTransferSize = 0;
 		m_nState = STATE_WAITING_RQ;
 		m_bIsLastBlock = false;
-		memset(&m_Buffer, 0, sizeof(struct TTFTPReqPacket));
+		m_bOptionTransferSize = false;
+		memset(&m_Buffer, 0, sizeof(m_Buffer));
 	} else {
 		m_nLength = Network::Get()->RecvFrom(m_nIdx, &m_Buffer, sizeof(m_Buffer), &m_nFromIp, &m_nFromPort);
 
@@ -174,8 +202,28 @@ bool TFTPDaemon::Run(void) {
 			}
 			break;
 		case STATE_WRQ_RECV_PACKET:
-			if (m_nLength <= sizeof(struct TTFTPDataPacket)) {
-				HandleRecvData();
+			/*
+			 * With a negotiated window, the blocks arrive back-to-back.
+			 * Drain the receive queue for (at most) a full window.
+			 */
+			for (uint32_t i = 0; i < m_nWindowSize; i++) {
+				if (m_nLength == 0) {
+					if ((m_nWindowCount != 0) && ((Hardware::Get()->Millis() - m_nLastPacketMillis) > TIMEOUT_MILLIS)) {
+						DEBUG_PRINTF("Timeout, m_nBlockNumber=%d", m_nBlockNumber);
+						DoWriteAck();
+					}
+					break;
+				}
+
+				if (m_nLength <= (4 + m_nBlockSize)) {
+					HandleRecvData();
+				}
+
+				if (m_nState != STATE_WRQ_RECV_PACKET) {
+					break;
+				}
+
+				m_nLength = Network::Get()->RecvFrom(m_nIdx, &m_Buffer, sizeof(m_Buffer), &m_nFromIp, &m_nFromPort);
 			}
 			break;
 		default:
@@ -188,6 +236,69 @@ bool TFTPDaemon::Run(void) {
 	return true;
 }
 
+void TFTPDaemon::ParseOptions(const char *pOptions, const char *pEnd, bool bIsRead) {
+	while (pOptions < pEnd) {
+		const char *pOption = pOptions;
+		const size_t nOptionLength = strnlen(pOption, pEnd - pOption);
+		const char *pValue = pOption + nOptionLength + 1;
+
+		if (pValue >= pEnd) {
+			break;
+		}
+
+		const size_t nValueLength = strnlen(pValue, pEnd - pValue);
+		const uint32_t nValue = strtoul(pValue, 0, 10);
+
+		DEBUG_PRINTF("%s=%s", pOption, pValue);
+
+		if (strcasecmp(pOption, "blksize") == 0) {
+			if (nValue >= MIN_BLKSIZE) {
+				m_nBlockSize = nValue > TFTP_MAX_BLKSIZE ? TFTP_MAX_BLKSIZE : nValue;
+			}
+		} else if (strcasecmp(pOption, "windowsize") == 0) {
+			// Read requests are sent lock-step, the blocks are not buffered for retransmission
+			if (!bIsRead && (nValue > 1)) {
+				m_nWindowSize = nValue > TFTP_MAX_WINDOWSIZE ? TFTP_MAX_WINDOWSIZE : nValue;
+			}
+		} else if (strcasecmp(pOption, "tsize") == 0) {
+			m_nTransferSize = nValue;
+			m_bOptionTransferSize = true;
+		}
+
+		pOptions = pValue + nValueLength + 1;
+	}
+}
+
+void TFTPDaemon::SendOptionAck(void) {
+	struct TTFTPOAckPacket *pOAckPacket = reinterpret_cast<struct TTFTPOAckPacket*>(&m_Buffer);
+
+	pOAckPacket->OpCode = __builtin_bswap16(OP_CODE_OACK);
+
+	char *p = pOAckPacket->Options;
+	const char *pEnd = reinterpret_cast<char *>(&m_Buffer) + sizeof(m_Buffer);
+
+	if (m_nBlockSize != TFTP_DEFAULT_BLKSIZE) {
+		p += 1 + snprintf(p, pEnd - p, "blksize");
+		p += 1 + snprintf(p, pEnd - p, "%u", static_cast<unsigned>(m_nBlockSize));
+	}
+
+	if (m_nWindowSize != 1) {
+		p += 1 + snprintf(p, pEnd - p, "windowsize");
+		p += 1 + snprintf(p, pEnd - p, "%u", static_cast<unsigned>(m_nWindowSize));
+	}
+
+	if (m_bOptionTransferSize) {
+		p += 1 + snprintf(p, pEnd - p, "tsize");
+		p += 1 + snprintf(p, pEnd - p, "%u", m_nTransferSize);
+	}
+
+	m_nPacketLength = p - reinterpret_cast<char *>(&m_Buffer);
+
+	DEBUG_PRINTF("m_nBlockSize=%d, m_nWindowSize=%d, m_nTransferSize=%d", m_nBlockSize, m_nWindowSize, m_nTransferSize);
+
+	Network::Get()->SendTo(m_nIdx, &m_Buffer, m_nPacketLength, m_nFromIp, m_nFromPort);
+}
+
 void TFTPDaemon::HandleRequest(void) {
 	struct TTFTPReqPacket *packet = reinterpret_cast<struct TTFTPReqPacket *>(&m_Buffer);
 
@@ -198,6 +309,10 @@ void TFTPDaemon::HandleRequest(void) {
 		return;
 	}
 
+	// Make sure that the request is always null terminated
+	const char *pEnd = reinterpret_cast<char *>(&m_Buffer) + m_nLength;
+	m_Buffer[m_nLength < sizeof(m_Buffer) ? m_nLength : sizeof(m_Buffer) - 1] = '\0';
+
 	const char *pFileName = packet->FileNameMode;
 	const size_t nNameLen = strlen(pFileName);
 
@@ -220,6 +335,13 @@ void TFTPDaemon::HandleRequest(void) {
 
 	DEBUG_PRINTF("Incoming %s request from " IPSTR " %s %s", nOpCode == OP_CODE_RRQ ? "read" : "write", IP2STR(m_nFromIp), pFileName, pMode);
 
+	ParseOptions(pMode + strlen(pMode) + 1, pEnd, nOpCode == OP_CODE_RRQ);
+
+	m_nTransferBytes = 0;
+	m_nTransferMillis = 0;
+	m_nStartMillis = Hardware::Get()->Millis();
+	m_nLastPacketMillis = m_nStartMillis;
+
 	switch (nOpCode) {
 		case OP_CODE_RRQ:
 			if(!FileOpen(pFileName, tMode)) {
@@ -228,8 +350,22 @@ void TFTPDaemon::HandleRequest(void) {
 			} else {
 				Network::Get()->End(TFTP_UDP_PORT);
 				m_nIdx = Network::Get()->Begin(m_nFromPort);
-				m_nState = STATE_RRQ_SEND_PACKET;
-				DoRead();
+
+				if (m_bOptionTransferSize) {
+					m_bOptionTransferSize = FileSize(m_nTransferSize);
+				}
+
+				// Without an option to acknowledge (tsize of a file with an unknown size), DATA block 1 is the answer
+				if (IsOptionAck()) {
+					// The client acknowledges the OACK with block number 0
+					m_nBlockNumber = 0;
+					m_bIsLastBlock = false;
+					m_nState = STATE_RRQ_RECV_ACK;
+					SendOptionAck();
+				} else {
+					m_nState = STATE_RRQ_SEND_PACKET;
+					DoRead();
+				}
 			}
 			break;
 		case OP_CODE_WRQ:
@@ -239,8 +375,16 @@ void TFTPDaemon::HandleRequest(void) {
 			} else {
 				Network::Get()->End(TFTP_UDP_PORT);
 				m_nIdx = Network::Get()->Begin(m_nFromPort);
-				m_nState = STATE_WRQ_SEND_ACK;
-				DoWriteAck();
+
+				if (IsOptionAck()) {
+					// The OACK takes the place of the ACK for block number 0
+					m_nBlockNumber = 0;
+					m_nState = STATE_WRQ_RECV_PACKET;
+					SendOptionAck();
+				} else {
+					m_nState = STATE_WRQ_SEND_ACK;
+					DoWriteAck();
+				}
 			}
 			break;
 		default:
@@ -255,6 +399,7 @@ void TFTPDaemon::SendError (uint16_t nErrorCode, const char *pErrorMessage) {
 	ErrorPacket.OpCode = __builtin_bswap16 (OP_CODE_ERROR);
 	ErrorPacket.ErrorCode = __builtin_bswap16 (nErrorCode);
 	strncpy(ErrorPacket.ErrMsg, pErrorMessage, sizeof(ErrorPacket.ErrMsg) - 1);
+	ErrorPacket.ErrMsg[sizeof(ErrorPacket.ErrMsg) - 1] = '\0';
 
 	Network::Get()->SendTo(m_nIdx, &ErrorPacket, sizeof ErrorPacket, m_nFromIp, m_nFromPort);
 }
@@ -263,16 +408,18 @@ void TFTPDaemon::DoRead(void) {
 	struct TTFTPDataPacket *pDataPacket = reinterpret_cast<struct TTFTPDataPacket*>(&m_Buffer);
 
 	if (m_nState == STATE_RRQ_SEND_PACKET) {
-		m_nDataLength = FileRead(pDataPacket->Data, MAX_DATA_LEN, ++m_nBlockNumber);
+		m_nDataLength = FileRead(pDataPacket->Data, m_nBlockSize, ++m_nBlockNumber);
 
 		pDataPacket->OpCode = __builtin_bswap16(OP_CODE_DATA);
 		pDataPacket->BlockNumber = __builtin_bswap16(m_nBlockNumber);
 
 		m_nPacketLength = sizeof pDataPacket->OpCode + sizeof pDataPacket->BlockNumber + m_nDataLength;
-		m_bIsLastBlock = m_nDataLength < MAX_DATA_LEN;
+		m_bIsLastBlock = m_nDataLength < m_nBlockSize;
+		m_nTransferBytes += m_nDataLength;
 
 		if (m_bIsLastBlock) {
 			FileClose();
+			DoTransferDone();
 		}
 
 		DEBUG_PRINTF("m_nDataLength=%d, m_nPacketLength=%d, m_bIsLastBlock=%d", m_nDataLength, m_nPacketLength, m_bIsLastBlock);
@@ -299,37 +446,65 @@ void TFTPDaemon::HandleRecvAck(void) {
 }
 
 void TFTPDaemon::DoWriteAck(void) {
-	struct TTFTPAckPacket *pAckPacket = reinterpret_cast<struct TTFTPAckPacket*>(&m_Buffer);
+	struct TTFTPAckPacket AckPacket;
 
-	pAckPacket->OpCode = __builtin_bswap16(OP_CODE_ACK);
-	pAckPacket->BlockNumber =  __builtin_bswap16(m_nBlockNumber);
+	AckPacket.OpCode = __builtin_bswap16(OP_CODE_ACK);
+	AckPacket.BlockNumber =  __builtin_bswap16(m_nBlockNumber);
 	m_nState = m_bIsLastBlock ? STATE_INIT : STATE_WRQ_RECV_PACKET;
+	m_nWindowCount = 0;
 
 	DEBUG_PRINTF("Sending to " IPSTR ":%d, m_nState=%d", IP2STR(m_nFromIp), m_nFromPort, m_nState);
 
-	Network::Get()->SendTo(m_nIdx, &m_Buffer, sizeof(struct TTFTPAckPacket), m_nFromIp, m_nFromPort);
+	Network::Get()->SendTo(m_nIdx, &AckPacket, sizeof(struct TTFTPAckPacket), m_nFromIp, m_nFromPort);
 }
 
 void TFTPDaemon::HandleRecvData(void) {
 	struct TTFTPDataPacket *pDataPacket = reinterpret_cast<struct TTFTPDataPacket*>(&m_Buffer);
 
 	if (pDataPacket->OpCode == __builtin_bswap16(OP_CODE_DATA)) {
+		const uint16_t nBlockNumber = __builtin_bswap16(pDataPacket->BlockNumber);
+
+		m_nLastPacketMillis = Hardware::Get()->Millis();
+
+		if (nBlockNumber != static_cast<uint16_t>(m_nBlockNumber + 1)) {
+			// Duplicate or out of order, acknowledge the last block received in sequence (RFC 7440)
+			DEBUG_PRINTF("nBlockNumber=%d, m_nBlockNumber=%d", nBlockNumber, m_nBlockNumber);
+			DoWriteAck();
+			return;
+		}
+
 		m_nDataLength = m_nLength - 4;
-		m_nBlockNumber = __builtin_bswap16(pDataPacket->BlockNumber);
+		m_nBlockNumber = nBlockNumber;
 
 		DEBUG_PRINTF("Incoming from " IPSTR ", m_nLength=%d, m_nBlockNumber=%d, m_nDataLength=%d", IP2STR(m_nFromIp), m_nLength, m_nBlockNumber,m_nDataLength);
 
 		if (m_nDataLength == FileWrite(pDataPacket->Data, m_nDataLength, m_nBlockNumber)) {
+			m_nTransferBytes += m_nDataLength;
 
-			if (m_nDataLength < MAX_DATA_LEN) {
+			if (m_nDataLength < m_nBlockSize) {
 				m_bIsLastBlock = true;
-				FileClose();
+
+				if (!FileClose()) {
+					SendError(ERROR_CODE_DISK_FULL, "Write failed");
+					m_nState = STATE_INIT;
+					return;
+				}
+
+				DoTransferDone();
 			}
 
-			DoWriteAck();
+			if (m_bIsLastBlock || (++m_nWindowCount == m_nWindowSize)) {
+				DoWriteAck();
+			}
 		} else {
 			SendError(ERROR_CODE_DISK_FULL, "Write failed");
 			m_nState = STATE_INIT;
 		}
 	}
 }
+
+void TFTPDaemon::DoTransferDone(void) {
+	m_nTransferMillis = Hardware::Get()->Millis() - m_nStartMillis;
+
+	DEBUG_PRINTF("m_nTransferBytes=%u, m_nTransferMillis=%u", m_nTransferBytes, m_nTransferMillis);
+}
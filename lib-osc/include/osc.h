@@ -33,6 +33,9 @@
 #define OSC_DEFAULT_INCOMING_PORT	8000
 #define OSC_DEFAULT_OUTGOING_PORT	9000
 
+#define OSC_TIMETAG_UNIX_OFFSET		2208988800U	///< Seconds from Jan 1st 1900 to Jan 1st 1970
+#define OSC_TIMETAG_IMMEDIATE_FRAC	1			///< With sec == 0
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -0,0 +1,74 @@
+/**
+ * @file oscbundle.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef OSCBUNDLE_H_
+#define OSCBUNDLE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include "osc.h"
+
+#define OSC_BUNDLE_TAG				"#bundle"
+#define OSC_BUNDLE_HEADER_SIZE		16	///< "#bundle\0" + timetag
+
+/*
+ * A non-owning view on a received OSC bundle.
+ * The elements are either messages or nested bundles.
+ */
+class OSCBundle {
+public:
+	OSCBundle(const uint8_t *pOscBundle, uint32_t nLength);
+
+	bool IsValid(void) const {
+		return m_bIsValid;
+	}
+
+	const osc_timetag& GetTimeTag(void) const {
+		return m_TimeTag;
+	}
+
+	bool IsImmediate(void) const {
+		return (m_TimeTag.sec == 0) && (m_TimeTag.frac == OSC_TIMETAG_IMMEDIATE_FRAC);
+	}
+
+	/*
+	 * Returns 0 when there are no more elements, or the next element is malformed.
+	 */
+	const uint8_t *GetNextElement(uint32_t& nElementLength);
+
+	static bool IsBundle(const uint8_t *pBuffer, uint32_t nLength) {
+		return (nLength >= OSC_BUNDLE_HEADER_SIZE) && (memcmp(pBuffer, OSC_BUNDLE_TAG, sizeof(OSC_BUNDLE_TAG)) == 0);
+	}
+
+private:
+	const uint8_t *m_pOscBundle;
+	uint32_t m_nLength;
+	uint32_t m_nIndex;
+	osc_timetag m_TimeTag;
+	bool m_bIsValid;
+};
+
+#endif /* OSCBUNDLE_H_ */
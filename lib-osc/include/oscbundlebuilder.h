@@ -0,0 +1,74 @@
+/**
+ * @file oscbundlebuilder.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef OSCBUNDLEBUILDER_H_
+#define OSCBUNDLEBUILDER_H_
+
+#include <stdint.h>
+
+#include "osc.h"
+
+/*
+ * Builds an OSC bundle in a caller supplied buffer.
+ * An element is built in place:
+ *
+ *  uint32_t nFree;
+ *  uint8_t *pElement = Bundle.GetElementBuffer(nFree);
+ *  OSCMessageBuilder Msg(pElement, nFree, "/path", "i");
+ *  Msg.AddInt32(1);
+ *  Bundle.AddElement(Msg.GetSize());
+ */
+class OSCBundleBuilder {
+public:
+	OSCBundleBuilder(uint8_t *pBuffer, uint32_t nBufferSize);
+	OSCBundleBuilder(uint8_t *pBuffer, uint32_t nBufferSize, const osc_timetag& TimeTag);
+
+	uint8_t *GetElementBuffer(uint32_t& nFree);
+	bool AddElement(uint32_t nElementLength);
+	bool AddMessage(const uint8_t *pMessage, uint32_t nLength);
+
+	bool IsValid(void) const {
+		return m_bIsValid;
+	}
+
+	const uint8_t *GetBundle(void) const {
+		return m_pBuffer;
+	}
+
+	uint32_t GetSize(void) const {
+		return m_nIndex;
+	}
+
+private:
+	void Init(const osc_timetag& TimeTag);
+
+private:
+	uint8_t *m_pBuffer;
+	uint32_t m_nBufferSize;
+	uint32_t m_nIndex;
+	bool m_bIsValid;
+};
+
+#endif /* OSCBUNDLEBUILDER_H_ */
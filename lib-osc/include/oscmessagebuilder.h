@@ -0,0 +1,72 @@
+/**
+ * @file oscmessagebuilder.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef OSCMESSAGEBUILDER_H_
+#define OSCMESSAGEBUILDER_H_
+
+#include <stdint.h>
+
+/*
+ * Builds an OSC message in a caller supplied buffer, typically on the stack.
+ * The path and the type tags are written by the constructor, the arguments
+ * must be added in the order of the type tags.
+ */
+class OSCMessageBuilder {
+public:
+	OSCMessageBuilder(uint8_t *pBuffer, uint32_t nBufferSize, const char *pPath, const char *pTypes);
+
+	bool AddInt32(int32_t nValue);
+	bool AddFloat(float fValue);
+	bool AddString(const char *pString);
+	bool AddBlob(const uint8_t *pData, uint32_t nSize);
+
+	/*
+	 * True when the buffer did not overflow and all the arguments are added.
+	 */
+	bool IsValid(void) const {
+		return m_bIsValid && (*m_pTypes == '\0');
+	}
+
+	const uint8_t *GetMessage(void) const {
+		return m_pBuffer;
+	}
+
+	uint32_t GetSize(void) const {
+		return m_nIndex;
+	}
+
+private:
+	bool AddArgument(char cType, uint32_t nSize);
+	void AddPadded(const char *pString);
+
+private:
+	uint8_t *m_pBuffer;
+	uint32_t m_nBufferSize;
+	const char *m_pTypes;
+	uint32_t m_nIndex;
+	bool m_bIsValid;
+};
+
+#endif /* OSCMESSAGEBUILDER_H_ */
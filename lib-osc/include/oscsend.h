@@ -29,16 +29,18 @@
 #include <stdint.h>
 #include <stdarg.h>
 
-#include "oscmessage.h"
+#include "oscmessagebuilder.h"
 
+/*
+ * The message is built on the stack, there is no heap allocation.
+ */
 class OSCSend {
 public:
 	OSCSend(unsigned nHandle, int, int, const char *, const char *, ...);
 	~OSCSend(void);
 
 private:
-	void AddVarArgs(va_list);
-	void Send(void);
+	void AddVarArgs(OSCMessageBuilder& Msg, va_list);
 
 private:
 	unsigned m_nHandle;
@@ -46,7 +48,6 @@ private:
 	int m_Port;
 	const char *m_Path;
 	const char *m_Types;
-	OSCMessage *m_Msg;
 	int m_Result;
 };
 
@@ -0,0 +1,81 @@
+/**
+ * @file oscsimplemessage.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef OSCSIMPLEMESSAGE_H_
+#define OSCSIMPLEMESSAGE_H_
+
+#include <stdint.h>
+
+#include "osc.h"
+#include "oscblob.h"
+
+/*
+ * A non-owning view on a received OSC message.
+ * The arguments are read straight from the receive buffer, nothing is copied or allocated.
+ * The buffer must stay valid, and 4-byte aligned, for the life-time of the object.
+ */
+class OSCSimpleMessage {
+public:
+	OSCSimpleMessage(const uint8_t *pOscMessage, uint32_t nLength);
+
+	bool IsValid(void) const {
+		return m_bIsValid;
+	}
+
+	const char *GetPath(void) const {
+		return reinterpret_cast<const char*>(m_pOscMessage);
+	}
+
+	int GetArgc(void) const {
+		return static_cast<int>(m_nArgc);
+	}
+
+	osc_type GetType(uint32_t nArgc) const {
+		if (nArgc >= m_nArgc) {
+			return OSC_UNKNOWN;
+		}
+
+		return static_cast<osc_type>(m_pOscMessageTypes[nArgc]);
+	}
+
+	float GetFloat(uint32_t nArgc) const;
+	int GetInt(uint32_t nArgc) const;
+	const char *GetString(uint32_t nArgc) const;
+	OSCBlob GetBlob(uint32_t nArgc) const;
+
+private:
+	const uint8_t *GetArgument(uint32_t nArgc) const;
+	static int32_t ArgSize(char cType, const uint8_t *pArgument, uint32_t nRemaining);
+
+private:
+	const uint8_t *m_pOscMessage;
+	const char *m_pOscMessageTypes;
+	const uint8_t *m_pArguments;
+	uint32_t m_nArgumentsLength;
+	uint32_t m_nArgc;
+	bool m_bIsValid;
+};
+
+#endif /* OSCSIMPLEMESSAGE_H_ */
@@ -0,0 +1,72 @@
+/**
+ * @file oscbundle.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <assert.h>
+
+#include "oscbundle.h"
+#include "osc.h"
+
+OSCBundle::OSCBundle(const uint8_t *pOscBundle, uint32_t nLength):
+	m_pOscBundle(pOscBundle),
+	m_nLength(nLength),
+	m_nIndex(OSC_BUNDLE_HEADER_SIZE),
+	m_bIsValid(false)
+{
+	assert(pOscBundle != 0);
+
+	m_TimeTag.sec = 0;
+	m_TimeTag.frac = OSC_TIMETAG_IMMEDIATE_FRAC;
+
+	if (!IsBundle(pOscBundle, nLength) || ((nLength & 0x3) != 0)) {
+		return;
+	}
+
+	const uint32_t *pTimeTag = reinterpret_cast<const uint32_t*>(&pOscBundle[8]);
+
+	m_TimeTag.sec = __builtin_bswap32(pTimeTag[0]);
+	m_TimeTag.frac = __builtin_bswap32(pTimeTag[1]);
+
+	m_bIsValid = true;
+}
+
+const uint8_t *OSCBundle::GetNextElement(uint32_t& nElementLength) {
+	if (!m_bIsValid || ((m_nIndex + 4) > m_nLength)) {
+		return 0;
+	}
+
+	nElementLength = __builtin_bswap32(*reinterpret_cast<const uint32_t*>(&m_pOscBundle[m_nIndex]));
+
+	// Compared with the remaining bytes, m_nIndex + 4 + nElementLength can wrap
+	if ((nElementLength == 0) || ((nElementLength & 0x3) != 0) || (nElementLength > (m_nLength - m_nIndex - 4))) {
+		m_bIsValid = false;
+		return 0;
+	}
+
+	const uint8_t *pElement = &m_pOscBundle[m_nIndex + 4];
+	m_nIndex += 4 + nElementLength;
+
+	return pElement;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file oscbundlebuilder.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "oscbundlebuilder.h"
+#include "oscbundle.h"
+#include "osc.h"
+
+OSCBundleBuilder::OSCBundleBuilder(uint8_t *pBuffer, uint32_t nBufferSize):
+	m_pBuffer(pBuffer),
+	m_nBufferSize(nBufferSize),
+	m_nIndex(0),
+	m_bIsValid(true)
+{
+	osc_timetag TimeTag;
+
+	TimeTag.sec = 0;
+	TimeTag.frac = OSC_TIMETAG_IMMEDIATE_FRAC;
+
+	Init(TimeTag);
+}
+
+OSCBundleBuilder::OSCBundleBuilder(uint8_t *pBuffer, uint32_t nBufferSize, const osc_timetag& TimeTag):
+	m_pBuffer(pBuffer),
+	m_nBufferSize(nBufferSize),
+	m_nIndex(0),
+	m_bIsValid(true)
+{
+	Init(TimeTag);
+}
+
+void OSCBundleBuilder::Init(const osc_timetag& TimeTag) {
+	assert(m_pBuffer != 0);
+
+	if (m_nBufferSize < OSC_BUNDLE_HEADER_SIZE) {
+		m_bIsValid = false;
+		return;
+	}
+
+	memcpy(m_pBuffer, OSC_BUNDLE_TAG, sizeof(OSC_BUNDLE_TAG));
+
+	const uint32_t aTimeTag[2] = { __builtin_bswap32(TimeTag.sec), __builtin_bswap32(TimeTag.frac) };
+	memcpy(&m_pBuffer[8], aTimeTag, sizeof(aTimeTag));
+
+	m_nIndex = OSC_BUNDLE_HEADER_SIZE;
+}
+
+uint8_t *OSCBundleBuilder::GetElementBuffer(uint32_t& nFree) {
+	if (!m_bIsValid || ((m_nIndex + 4) >= m_nBufferSize)) {
+		nFree = 0;
+		return 0;
+	}
+
+	nFree = m_nBufferSize - m_nIndex - 4;
+
+	return &m_pBuffer[m_nIndex + 4];
+}
+
+bool OSCBundleBuilder::AddElement(uint32_t nElementLength) {
+	if (!m_bIsValid || (nElementLength == 0) || ((nElementLength & 0x3) != 0) || ((m_nIndex + 4) > m_nBufferSize) || (nElementLength > (m_nBufferSize - m_nIndex - 4))) {
+		m_bIsValid = false;
+		return false;
+	}
+
+	const uint32_t nSize = __builtin_bswap32(nElementLength);
+	memcpy(&m_pBuffer[m_nIndex], &nSize, 4);
+
+	m_nIndex += 4 + nElementLength;
+
+	return true;
+}
+
+bool OSCBundleBuilder::AddMessage(const uint8_t *pMessage, uint32_t nLength) {
+	assert(pMessage != 0);
+
+	uint32_t nFree;
+	uint8_t *pElement = GetElementBuffer(nFree);
+
+	if ((pElement == 0) || (nLength > nFree)) {
+		m_bIsValid = false;
+		return false;
+	}
+
+	memcpy(pElement, pMessage, nLength);
+
+	return AddElement(nLength);
+}
@@ -0,0 +1,144 @@
+/**
+ * @file oscmessagebuilder.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "oscmessagebuilder.h"
+#include "oscstring.h"
+#include "osc.h"
+
+OSCMessageBuilder::OSCMessageBuilder(uint8_t *pBuffer, uint32_t nBufferSize, const char *pPath, const char *pTypes):
+	m_pBuffer(pBuffer),
+	m_nBufferSize(nBufferSize),
+	m_pTypes(pTypes == 0 ? "" : pTypes),
+	m_nIndex(0),
+	m_bIsValid(true)
+{
+	assert(pBuffer != 0);
+	assert(pPath != 0);
+
+	const uint32_t nTypes = strlen(m_pTypes);
+
+	if ((OSCString::Size(pPath) + (4 * ((nTypes + 1) / 4 + 1))) > m_nBufferSize) {
+		m_bIsValid = false;
+		return;
+	}
+
+	AddPadded(pPath);
+
+	// The type tag string starts with a ','
+	char *pTypeTag = reinterpret_cast<char*>(&m_pBuffer[m_nIndex]);
+	const uint32_t nTypeTagSize = 4 * ((nTypes + 1) / 4 + 1);
+
+	memset(pTypeTag, 0, nTypeTagSize);
+	pTypeTag[0] = ',';
+	memcpy(&pTypeTag[1], m_pTypes, nTypes);
+
+	m_nIndex += nTypeTagSize;
+}
+
+void OSCMessageBuilder::AddPadded(const char *pString) {
+	const uint32_t nSize = OSCString::Size(pString);
+
+	// Clear the padding first, then copy the string including the terminator
+	memset(&m_pBuffer[m_nIndex + nSize - 4], 0, 4);
+	strcpy(reinterpret_cast<char*>(&m_pBuffer[m_nIndex]), pString);
+
+	m_nIndex += nSize;
+}
+
+bool OSCMessageBuilder::AddArgument(char cType, uint32_t nSize) {
+	if (!m_bIsValid || (*m_pTypes != cType) || ((m_nIndex + nSize) > m_nBufferSize)) {
+		m_bIsValid = false;
+		return false;
+	}
+
+	m_pTypes++;
+
+	return true;
+}
+
+bool OSCMessageBuilder::AddInt32(int32_t nValue) {
+	if (!AddArgument(OSC_INT32, 4)) {
+		return false;
+	}
+
+	const uint32_t nNetwork = __builtin_bswap32(static_cast<uint32_t>(nValue));
+	memcpy(&m_pBuffer[m_nIndex], &nNetwork, 4);
+	m_nIndex += 4;
+
+	return true;
+}
+
+bool OSCMessageBuilder::AddFloat(float fValue) {
+	if (!AddArgument(OSC_FLOAT, 4)) {
+		return false;
+	}
+
+	union {
+		uint32_t u;
+		float f;
+	} cast;
+
+	cast.f = fValue;
+
+	const uint32_t nNetwork = __builtin_bswap32(cast.u);
+	memcpy(&m_pBuffer[m_nIndex], &nNetwork, 4);
+	m_nIndex += 4;
+
+	return true;
+}
+
+bool OSCMessageBuilder::AddString(const char *pString) {
+	assert(pString != 0);
+
+	if (!AddArgument(OSC_STRING, OSCString::Size(pString))) {
+		return false;
+	}
+
+	AddPadded(pString);
+
+	return true;
+}
+
+bool OSCMessageBuilder::AddBlob(const uint8_t *pData, uint32_t nSize) {
+	const uint32_t nBlobSize = 4 * ((sizeof(uint32_t) + nSize + 3) / 4);
+
+	if (!AddArgument(OSC_BLOB, nBlobSize)) {
+		return false;
+	}
+
+	const uint32_t nNetwork = __builtin_bswap32(nSize);
+
+	memset(&m_pBuffer[m_nIndex + nBlobSize - 4], 0, 4);
+	memcpy(&m_pBuffer[m_nIndex], &nNetwork, 4);
+	memcpy(&m_pBuffer[m_nIndex + 4], pData, nSize);
+
+	m_nIndex += nBlobSize;
+
+	return true;
+}
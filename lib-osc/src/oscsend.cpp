@@ -24,13 +24,13 @@
  */
 
 #include <stdint.h>
-#include <stdlib.h>
 #include <stdarg.h>
 #include <assert.h>
 
 #include "oscsend.h"
-#include "oscstring.h"
-#include "oscmessage.h"
+#include "oscmessagebuilder.h"
+#include "oscblob.h"
+#include "osc.h"
 
 #include "network.h"
 
@@ -51,74 +51,52 @@ OSCSend::OSCSend(unsigned nHandle, int address, int port, const char *path, cons
 		m_Port(port),
 		m_Path(path),
 		m_Types(types),
-		m_Msg(0),
 		m_Result(-1) {
 
+	uint8_t buffer[OSC_MAX_MSG_SIZE] __attribute__ ((aligned (4)));
+	OSCMessageBuilder Msg(buffer, sizeof(buffer), path, types);
+
 	va_list ap;
 	va_start(ap, types);
-	OSCSend::AddVarArgs(ap);
+	OSCSend::AddVarArgs(Msg, ap);
 	va_end(ap);
 
-	if ((types == 0) || (m_Result == 0)) {
-		OSCSend::Send();
+	if (Msg.IsValid()) {
+		Network::Get()->SendTo(m_nHandle, Msg.GetMessage(), static_cast<uint16_t>(Msg.GetSize()), m_Address, m_Port);
+		m_Result = 0;
+	} else {
+		DEBUG_PRINTF("Invalid message: %s", path);
 	}
 }
 
 OSCSend::~OSCSend(void) {
-	if(m_Msg) {
-		delete m_Msg;
-		m_Msg = 0;
-	}
 }
 
-void OSCSend::AddVarArgs(va_list ap) {
-	m_Msg = new OSCMessage();
-
+void OSCSend::AddVarArgs(OSCMessageBuilder& Msg, va_list ap) {
 	while (m_Types && *m_Types) {
 		switch (*m_Types++) {
-#if !defined(OSC_MESSAGE_STRING_ONLY)
 		case OSC_INT32: {
 			int32_t i = va_arg(ap, int32_t);
-			m_Result = m_Msg->AddInt32(i);
+			Msg.AddInt32(i);
 			break;
 		}
 		case OSC_FLOAT: {
 			float f = static_cast<float>(va_arg(ap, double));
-			m_Result = m_Msg->AddFloat(f);
+			Msg.AddFloat(f);
 			break;
 		}
-#endif
 		case OSC_STRING: {
 			char *s = va_arg(ap, char *);
-			m_Result = m_Msg->AddString(s);
+			Msg.AddString(s);
 			break;
 		}
-#if !defined(OSC_MESSAGE_STRING_ONLY)
 		case OSC_BLOB: {
 			OSCBlob *b = va_arg(ap, OSCBlob *);
-			m_Result = m_Msg->AddBlob(b);
+			Msg.AddBlob(reinterpret_cast<const uint8_t*>(b->GetDataPtr()), static_cast<uint32_t>(b->GetDataSize()));
 			break;
 		}
-#endif
 		default:
 			break;
 		}
-
-		if(m_Result != 0) {
-			DEBUG_PRINTF("AddVarArgs: %d", m_Result);
-		}
-	}
-}
-
-void OSCSend::Send(void) {
-	const uint16_t nDataLength = OSCString::Size(m_Path) + OSCString::Size(m_Msg->getTypes()) + m_Msg->getDataLength();
-	void *pData = m_Msg->Serialise(m_Path, 0, 0);
-
-	Network::Get()->SendTo(m_nHandle, pData, nDataLength, m_Address, m_Port);
-
-	// Free the memory allocated by m_Msg->Serialise
-	if(pData) {
-		free(pData);
-		pData = 0;
 	}
 }
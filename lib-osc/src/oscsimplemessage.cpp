@@ -0,0 +1,187 @@
+/**
+ * @file oscsimplemessage.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "oscsimplemessage.h"
+#include "oscmessage.h"
+#include "oscstring.h"
+#include "oscblob.h"
+#include "osc.h"
+
+OSCSimpleMessage::OSCSimpleMessage(const uint8_t *pOscMessage, uint32_t nLength):
+	m_pOscMessage(pOscMessage),
+	m_pOscMessageTypes(0),
+	m_pArguments(0),
+	m_nArgumentsLength(0),
+	m_nArgc(0),
+	m_bIsValid(false)
+{
+	assert(pOscMessage != 0);
+
+	int32_t nLen = static_cast<int32_t>(OSCString::Validate(const_cast<uint8_t*>(pOscMessage), nLength));
+
+	if (nLen <= 0) {
+		return;
+	}
+
+	uint32_t nRemaining = nLength - static_cast<uint32_t>(nLen);
+
+	if (nRemaining == 0) {
+		return;
+	}
+
+	const char *pTypes = reinterpret_cast<const char*>(pOscMessage) + nLen;
+
+	nLen = static_cast<int32_t>(OSCString::Validate(const_cast<char*>(pTypes), nRemaining));
+
+	if ((nLen <= 0) || (pTypes[0] != ',')) {
+		return;
+	}
+
+	nRemaining -= static_cast<uint32_t>(nLen);
+
+	m_pOscMessageTypes = &pTypes[1];
+	m_nArgc = strlen(m_pOscMessageTypes);
+	m_pArguments = reinterpret_cast<const uint8_t*>(pTypes) + nLen;
+	m_nArgumentsLength = nRemaining;
+
+	// Validate all the arguments once, so that the getters can skip the checks
+	const uint8_t *pArgument = m_pArguments;
+
+	for (uint32_t i = 0; i < m_nArgc; i++) {
+		const int32_t nSize = ArgSize(m_pOscMessageTypes[i], pArgument, nRemaining);
+
+		if (nSize < 0) {
+			m_nArgc = 0;
+			return;
+		}
+
+		nRemaining -= static_cast<uint32_t>(nSize);
+		pArgument += nSize;
+	}
+
+	if (nRemaining != 0) {
+		m_nArgc = 0;
+		return;
+	}
+
+	m_bIsValid = true;
+}
+
+int32_t OSCSimpleMessage::ArgSize(char cType, const uint8_t *pArgument, uint32_t nRemaining) {
+	switch (cType) {
+	case OSC_TRUE:
+	case OSC_FALSE:
+	case OSC_NIL:
+	case OSC_INFINITUM:
+		return 0;
+	case OSC_INT32:
+	case OSC_FLOAT:
+	case OSC_MIDI:
+	case OSC_CHAR:
+		return nRemaining >= 4 ? 4 : -OSC_INVALID_SIZE;
+	case OSC_INT64:
+	case OSC_TIMETAG:
+	case OSC_DOUBLE:
+		return nRemaining >= 8 ? 8 : -OSC_INVALID_SIZE;
+	case OSC_STRING:
+	case OSC_SYMBOL: {
+		const int32_t nLen = static_cast<int32_t>(OSCString::Validate(const_cast<uint8_t*>(pArgument), nRemaining));
+		return nLen > 0 ? nLen : -OSC_INVALID_SIZE;
+	}
+	case OSC_BLOB:
+		if (nRemaining < 4) {
+			return -OSC_INVALID_SIZE;
+		}
+		return OSCBlob::Validate(const_cast<uint8_t*>(pArgument), nRemaining);
+	default:
+		break;
+	}
+
+	return -OSC_INVALID_TYPE;
+}
+
+const uint8_t *OSCSimpleMessage::GetArgument(uint32_t nArgc) const {
+	if (nArgc >= m_nArgc) {
+		return 0;
+	}
+
+	const uint8_t *pArgument = m_pArguments;
+	uint32_t nRemaining = m_nArgumentsLength;
+
+	for (uint32_t i = 0; i < nArgc; i++) {
+		const uint32_t nSize = static_cast<uint32_t>(ArgSize(m_pOscMessageTypes[i], pArgument, nRemaining));
+		nRemaining -= nSize;
+		pArgument += nSize;
+	}
+
+	return pArgument;
+}
+
+float OSCSimpleMessage::GetFloat(uint32_t nArgc) const {
+	const uint8_t *pArgument = GetArgument(nArgc);
+
+	if (pArgument == 0) {
+		return 0;
+	}
+
+	union {
+		uint32_t u;
+		float f;
+	} cast;
+
+	cast.u = __builtin_bswap32(*reinterpret_cast<const uint32_t*>(pArgument));
+
+	return cast.f;
+}
+
+int OSCSimpleMessage::GetInt(uint32_t nArgc) const {
+	const uint8_t *pArgument = GetArgument(nArgc);
+
+	if (pArgument == 0) {
+		return 0;
+	}
+
+	return static_cast<int>(__builtin_bswap32(*reinterpret_cast<const uint32_t*>(pArgument)));
+}
+
+const char *OSCSimpleMessage::GetString(uint32_t nArgc) const {
+	return reinterpret_cast<const char*>(GetArgument(nArgc));
+}
+
+OSCBlob OSCSimpleMessage::GetBlob(uint32_t nArgc) const {
+	const uint8_t *pArgument = GetArgument(nArgc);
+
+	if ((pArgument == 0) || (m_pOscMessageTypes[nArgc] != OSC_BLOB)) {
+		return OSCBlob(0, 0);
+	}
+
+	const uint32_t nSize = __builtin_bswap32(*reinterpret_cast<const uint32_t*>(pArgument));
+
+	return OSCBlob(reinterpret_cast<const char*>(pArgument) + 4, static_cast<int>(nSize));
+}
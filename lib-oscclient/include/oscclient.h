@@ -53,6 +53,13 @@ public:
 	void Send(const char *pPath);
 	void SendCmd(uint8_t nCmd);
 
+	/*
+	 * All the paths are sent in a single bundle with the timetag 'immediately',
+	 * the server executes them at the same time.
+	 */
+	bool SendBundle(const char * const *pPaths, uint32_t nCount);
+	bool SendCmds(const uint8_t *pCmds, uint32_t nCount);
+
 	void Print(void);
 
 	void SetServerIP(uint32_t nServerIP) {
@@ -30,6 +30,7 @@
 #include <assert.h>
 
 #include "oscclient.h"
+#include "oscsimplemessage.h"
 #include "oscsend.h"
 #include "osc.h"
 
@@ -239,7 +240,7 @@ bool OscClient::HandleLedMessage(void) {
 		return false;
 	}
 
-	OSCMessage Msg(m_pBuffer, m_nBytesReceived);
+	OSCSimpleMessage Msg(reinterpret_cast<const uint8_t*>(m_pBuffer), m_nBytesReceived);
 
 	const int nArgc = Msg.GetArgc();
 
@@ -30,8 +30,12 @@
 
 #include "oscclient.h"
 #include "oscsend.h"
+#include "oscmessagebuilder.h"
+#include "oscbundlebuilder.h"
 #include "osc.h"
 
+#include "network.h"
+
 #include "debug.h"
 
 void OscClient::Send(const char *pPath) {
@@ -56,3 +60,59 @@ void OscClient::SendCmd(uint8_t nCmd) {
 
 	DEBUG_EXIT
 }
+
+bool OscClient::SendBundle(const char * const *pPaths, uint32_t nCount) {
+	DEBUG_ENTRY
+
+	assert(pPaths != 0);
+
+	uint8_t aBuffer[OSC_MAX_MSG_SIZE] __attribute__ ((aligned (4)));
+	osc_timetag TimeTag;
+
+	TimeTag.sec = 0;
+	TimeTag.frac = OSC_TIMETAG_IMMEDIATE_FRAC;
+
+	OSCBundleBuilder Bundle(aBuffer, sizeof(aBuffer), TimeTag);
+
+	for (uint32_t i = 0; i < nCount; i++) {
+		if (*pPaths[i] == 0) {
+			continue;
+		}
+
+		uint32_t nFree;
+		uint8_t *pElement = Bundle.GetElementBuffer(nFree);
+
+		if (pElement == 0) {
+			DEBUG_PUTS("Bundle too large");
+			DEBUG_EXIT
+			return false;
+		}
+
+		OSCMessageBuilder Msg(pElement, nFree, pPaths[i], 0);
+
+		if (!Msg.IsValid() || !Bundle.AddElement(Msg.GetSize())) {
+			DEBUG_PUTS("Bundle too large");
+			DEBUG_EXIT
+			return false;
+		}
+	}
+
+	Network::Get()->SendTo(m_nHandle, Bundle.GetBundle(), static_cast<uint16_t>(Bundle.GetSize()), m_nServerIP, m_nPortOutgoing);
+
+	DEBUG_EXIT
+	return true;
+}
+
+bool OscClient::SendCmds(const uint8_t *pCmds, uint32_t nCount) {
+	assert(pCmds != 0);
+	assert(nCount <= OSCCLIENT_CMD_MAX_COUNT);
+
+	const char *pPaths[OSCCLIENT_CMD_MAX_COUNT];
+
+	for (uint32_t i = 0; i < nCount; i++) {
+		assert(pCmds[i] < OSCCLIENT_CMD_MAX_COUNT);
+		pPaths[i] = &m_pCmds[pCmds[i] * OSCCLIENT_CMD_MAX_PATH_LENGTH];
+	}
+
+	return SendBundle(pPaths, nCount);
+}
@@ -36,6 +36,20 @@
 
 #define OSCSERVER_PATH_LENGTH_MAX	128
 
+#define OSCSERVER_DEFAULT_COALESCE_MILLIS	20	///< About one DMX frame
+
+#define OSCSERVER_BUNDLE_MAX_DEPTH			4
+#define OSCSERVER_SCHEDULE_ENTRIES			8
+#define OSCSERVER_SCHEDULE_MESSAGE_SIZE		(512 + 64)	///< A full universe blob, and the path
+#define OSCSERVER_SCHEDULE_MAX_SECONDS		10			///< Beyond that the clocks are considered not in sync
+
+struct TOscServerScheduled {
+	uint32_t nMillis;
+	uint32_t nRemoteIp;
+	uint8_t *pMessage;
+	uint16_t nLength;
+};
+
 class OscServer {
 public:
 	OscServer(void);
@@ -69,6 +83,16 @@ public:
 		return m_bEnableNoChangeUpdate;
 	}
 
+	/*
+	 * 0 disables coalescing, each message is an output update
+	 */
+	void SetCoalesceMillis(uint32_t nCoalesceMillis = OSCSERVER_DEFAULT_COALESCE_MILLIS) {
+		m_nCoalesceMillis = nCoalesceMillis;
+	}
+	uint32_t GetCoalesceMillis(void) const {
+		return m_nCoalesceMillis;
+	}
+
 	void Print(void);
 
 	void Start(void);
@@ -79,6 +103,13 @@ public:
 private:
 	int GetChannel(const char *p);
 	bool IsDmxDataChanged(const uint8_t *pData, uint16_t nStartChannel, uint16_t nLength);
+	void UpdateDmx(const uint8_t *pData, uint16_t nStartChannel, uint16_t nLength);
+	void UpdateOutput(bool bForce);
+	bool HandleMessage(const char *pBuffer, uint32_t nBytesReceived, uint32_t nRemoteIp);
+	void HandleBundle(const uint8_t *pBuffer, uint32_t nLength, uint32_t nRemoteIp, uint32_t nDepth, uint32_t nParentDelayMillis);
+	uint32_t GetDelayMillis(uint32_t nTimeTagSeconds, uint32_t nTimeTagFraction);
+	bool Schedule(const char *pBuffer, uint32_t nLength, uint32_t nRemoteIp, uint32_t nDelayMillis);
+	void RunSchedule(void);
 
 private:
 	uint16_t m_nPortIncoming;
@@ -87,6 +118,11 @@ private:
 	bool m_bPartialTransmission;
 	bool m_bEnableNoChangeUpdate;
 	uint16_t m_nLastChannel;
+	bool m_bDmxUpdate;
+	bool m_bDmxFullUniverse;
+	bool m_bDmxDataChanged;
+	uint32_t m_nCoalesceMillis;
+	uint32_t m_nCoalesceStartMillis;
 	char m_aPath[OSCSERVER_PATH_LENGTH_MAX];
 	char m_aPathSecond[OSCSERVER_PATH_LENGTH_MAX];
 	char m_aPathInfo[OSCSERVER_PATH_LENGTH_MAX];
@@ -99,6 +135,11 @@ private:
 	char m_Os[32];
 	const char *m_pModel;
 	const char *m_pSoC;
+	uint32_t m_nTimeSeconds;
+	uint32_t m_nTimeSecondsMillis;
+	struct TOscServerScheduled *m_pScheduled;
+	uint8_t *m_pScheduleBuffer;
+	uint32_t m_nScheduled;
 };
 
 #endif /* OSCSERVER_H_ */
@@ -38,6 +38,7 @@ public:
 	static const char PARAMS_TRANSMISSION[];
 	static const char PARAMS_PATH_INFO[];
 	static const char PARAMS_PATH_BLACKOUT[];
+	static const char PARAMS_COALESCE_WINDOW[];
 };
 
 #endif /* OSCSERVERCONST_H_ */
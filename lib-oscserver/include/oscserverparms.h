@@ -42,6 +42,7 @@ struct TOSCServerParams {
 	char aPathInfo[OSCSERVER_PATH_LENGTH_MAX];
 	char aPathBlackOut[OSCSERVER_PATH_LENGTH_MAX];
 	bool bEnableNoChangeUpdate;
+	uint8_t nCoalesceMillis;
 };
 
 enum TOSCServerParamsMask {
@@ -52,7 +53,8 @@ enum TOSCServerParamsMask {
 	OSCSERVER_PARAMS_MASK_OUTPUT = (1 << 4),
 	OSCSERVER_PARAMS_MASK_PATH_INFO = (1 << 5),
 	OSCSERVER_PARAMS_MASK_PATH_BLACKOUT = (1 << 6),
-	OSCSERVER_PARAMS_MASK_ENABLE_NO_CHANGE_OUTPUT = (1 << 7)
+	OSCSERVER_PARAMS_MASK_ENABLE_NO_CHANGE_OUTPUT = (1 << 7),
+	OSCSERVER_PARAMS_MASK_COALESCE_WINDOW = (1 << 8)
 };
 
 class OSCServerParamsStore {
@@ -98,6 +100,10 @@ public:
 		return m_tOSCServerParams.bEnableNoChangeUpdate;
 	}
 
+	uint8_t GetCoalesceMillis(void) {
+		return m_tOSCServerParams.nCoalesceMillis;
+	}
+
 public:
     static void staticCallbackFunction(void *p, const char *s);
 
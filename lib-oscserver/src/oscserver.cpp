@@ -30,7 +30,8 @@
 
 #include "oscserver.h"
 #include "osc.h"
-#include "oscmessage.h"
+#include "oscsimplemessage.h"
+#include "oscbundle.h"
 #include "oscsend.h"
 #include "oscblob.h"
 
@@ -62,8 +63,16 @@ OscServer::OscServer(void):
 	m_bPartialTransmission(false),
 	m_bEnableNoChangeUpdate(false),
 	m_nLastChannel(0),
+	m_bDmxUpdate(false),
+	m_bDmxFullUniverse(false),
+	m_bDmxDataChanged(false),
+	m_nCoalesceMillis(OSCSERVER_DEFAULT_COALESCE_MILLIS),
+	m_nCoalesceStartMillis(0),
 	m_pOscServerHandler(0),
-	m_pLightSet(0)
+	m_pLightSet(0),
+	m_nTimeSeconds(0),
+	m_nTimeSecondsMillis(0),
+	m_nScheduled(0)
 {
 	memset(m_aPath, 0, sizeof(m_aPath));
 	strcpy(m_aPath, OSCSERVER_DEFAULT_PATH_PRIMARY);
@@ -90,6 +99,16 @@ OscServer::OscServer(void):
 	m_pOsc  = new uint8_t[DMX_UNIVERSE];
 	assert(m_pOsc != 0);
 
+	m_pScheduled = new struct TOscServerScheduled[OSCSERVER_SCHEDULE_ENTRIES];
+	assert(m_pScheduled != 0);
+
+	m_pScheduleBuffer = new uint8_t[OSCSERVER_SCHEDULE_ENTRIES * OSCSERVER_SCHEDULE_MESSAGE_SIZE];
+	assert(m_pScheduleBuffer != 0);
+
+	for (uint32_t i = 0; i < OSCSERVER_SCHEDULE_ENTRIES; i++) {
+		m_pScheduled[i].pMessage = &m_pScheduleBuffer[i * OSCSERVER_SCHEDULE_MESSAGE_SIZE];
+	}
+
 	snprintf(m_Os, sizeof(m_Os), "[V%s] %s", SOFTWARE_VERSION, __DATE__);
 
 	uint8_t nHwTextLength;
@@ -114,6 +133,12 @@ OscServer::~OscServer(void) {
 
 	delete[] m_pOsc;
 	m_pOsc = 0;
+
+	delete[] m_pScheduled;
+	m_pScheduled = 0;
+
+	delete[] m_pScheduleBuffer;
+	m_pScheduleBuffer = 0;
 }
 
 void OscServer::Start(void) {
@@ -280,20 +305,59 @@ bool OscServer::IsDmxDataChanged(const uint8_t* pData, uint16_t nStartChannel, u
 	return isChanged;
 }
 
-int OscServer::Run(void) {
-	uint32_t nRemoteIp;
-	uint16_t nRemotePort;
+void OscServer::UpdateDmx(const uint8_t *pData, uint16_t nStartChannel, uint16_t nLength) {
+	if (!m_bDmxUpdate) {
+		m_bDmxUpdate = true;
+		m_nCoalesceStartMillis = Hardware::Get()->Millis();
+	}
 
-	const int nBytesReceived = Network::Get()->RecvFrom(m_nHandle, m_pBuffer, OSCSERVER_MAX_BUFFER, &nRemoteIp, &nRemotePort);
+	if (IsDmxDataChanged(pData, nStartChannel, nLength)) {
+		m_bDmxDataChanged = true;
+	}
 
-	if (nBytesReceived == 0) {
-		return 0;
+	const uint16_t nLastChannel = nStartChannel + nLength - 1;
+
+	if (nLastChannel == DMX_UNIVERSE) {
+		m_bDmxFullUniverse = true;
 	}
 
-	if (OSC::isMatch(m_pBuffer, "/ping")) {
+	m_nLastChannel = nLastChannel > m_nLastChannel ? nLastChannel : m_nLastChannel;
+}
+
+/*
+ * The channel writes are collected in m_pData, the LightSet gets one update for
+ * all of them: when the receive queue is drained, or when the coalesce window has passed.
+ * LightSet::SetData always starts at slot 0, so only 'changed' is tracked, not a range.
+ */
+void OscServer::UpdateOutput(bool bForce) {
+	if (!m_bDmxUpdate) {
+		return;
+	}
+
+	if (!bForce && ((Hardware::Get()->Millis() - m_nCoalesceStartMillis) < m_nCoalesceMillis)) {
+		return;
+	}
+
+	if (m_bDmxDataChanged || m_bEnableNoChangeUpdate) {
+		DEBUG_PRINTF("m_nLastChannel=%d", m_nLastChannel);
+
+		if ((!m_bPartialTransmission) || m_bDmxFullUniverse) {
+			m_pLightSet->SetData(0, m_pData, DMX_UNIVERSE);
+		} else {
+			m_pLightSet->SetData(0, m_pData, m_nLastChannel);
+		}
+	}
+
+	m_bDmxUpdate = false;
+	m_bDmxFullUniverse = false;
+	m_bDmxDataChanged = false;
+}
+
+bool OscServer::HandleMessage(const char *pBuffer, uint32_t nBytesReceived, uint32_t nRemoteIp) {
+	if (OSC::isMatch(pBuffer, "/ping")) {
 		DEBUG_PUTS("ping received");
 		OSCSend MsgSend(m_nHandle, nRemoteIp, m_nPortOutgoing, "/pong", 0);
-	} else if (OSC::isMatch(m_pBuffer, m_aPathInfo)) {
+	} else if (OSC::isMatch(pBuffer, m_aPathInfo)) {
 		OSCSend MsgSendInfo(m_nHandle, nRemoteIp, m_nPortOutgoing, "/info/os", "s", m_Os);
 		OSCSend MsgSendModel(m_nHandle, nRemoteIp, m_nPortOutgoing, "/info/model", "s", m_pModel);
 		OSCSend MsgSendSoc(m_nHandle, nRemoteIp, m_nPortOutgoing, "/info/soc", "s", m_pSoC);
@@ -301,10 +365,13 @@ int OscServer::Run(void) {
 		if (m_pOscServerHandler != 0) {
 			m_pOscServerHandler->Info(m_nHandle, nRemoteIp, m_nPortOutgoing);
 		}
-	} else if (OSC::isMatch(m_pBuffer, m_aPathBlackOut)) {
-		OSCMessage Msg(m_pBuffer, nBytesReceived);
+	} else if (OSC::isMatch(pBuffer, m_aPathBlackOut)) {
+		OSCSimpleMessage Msg(reinterpret_cast<const uint8_t*>(pBuffer), nBytesReceived);
 		const bool bBlackout = (Msg.GetFloat(0) != 0);
 
+		// Keep the order with the pending channel writes
+		UpdateOutput(true);
+
 		if (bBlackout) {
 			if (m_pOscServerHandler != 0) {
 				m_pOscServerHandler->Blackout();
@@ -317,15 +384,13 @@ int OscServer::Run(void) {
 			DEBUG_PUTS("Update");
 		}
 	} else {
-		bool bIsDmxDataChanged = false;
-
-		OSCMessage Msg(m_pBuffer, nBytesReceived);
+		OSCSimpleMessage Msg(reinterpret_cast<const uint8_t*>(pBuffer), nBytesReceived);
 
-		debug_dump(m_pBuffer, nBytesReceived);
+		debug_dump(const_cast<char*>(pBuffer), nBytesReceived);
 
-		DEBUG_PRINTF("[%d] path : %s", nBytesReceived, OSC::GetPath(m_pBuffer, nBytesReceived));
+		DEBUG_PRINTF("[%d] path : %s", nBytesReceived, OSC::GetPath(const_cast<char*>(pBuffer), nBytesReceived));
 
-		if (OSC::isMatch(m_pBuffer, m_aPath)) {
+		if (OSC::isMatch(pBuffer, m_aPath)) {
 			const int nArgc = Msg.GetArgc();
 
 			if ((nArgc == 1) && (Msg.GetType(0) == OSC_BLOB)) {
@@ -334,29 +399,49 @@ int OscServer::Run(void) {
 				OSCBlob blob = Msg.GetBlob(0);
 				const int size = blob.GetDataSize();
 
-				if (size <= DMX_UNIVERSE) {
+				if ((size > 0) && (size <= DMX_UNIVERSE)) {
 					const uint8_t *ptr = reinterpret_cast<const uint8_t*>(blob.GetDataPtr());
 
-					bIsDmxDataChanged = IsDmxDataChanged(ptr, 1, size);
-
-					if (bIsDmxDataChanged || m_bEnableNoChangeUpdate) {
-						if ((!m_bPartialTransmission) || (size == DMX_UNIVERSE)) {
-							m_pLightSet->SetData(0, m_pData, DMX_UNIVERSE);
-						} else {
-							m_nLastChannel = size > m_nLastChannel ? size : m_nLastChannel;
-							m_pLightSet->SetData(0, m_pData, m_nLastChannel);
-						}
-					}
+					UpdateDmx(ptr, 1, size);
 				} else {
 					DEBUG_PUTS("Too many channels");
-					return -1;
+					return false;
 				}
+			} else if ((nArgc >= 2) && (Msg.GetType(0) == OSC_INT32) && (Msg.GetType(nArgc - 1) == OSC_BLOB)) {
+				// /path start,blob or /path start,count,blob
+				if ((nArgc == 3) && (Msg.GetType(1) != OSC_INT32)) {
+					return false;
+				}
+
+				const int nChannel = 1 + Msg.GetInt(0);
+				OSCBlob blob = Msg.GetBlob(nArgc - 1);
+				int nCount = blob.GetDataSize();
+
+				if (nArgc == 3) {
+					const int nArgCount = Msg.GetInt(1);
+
+					if ((nArgCount < 0) || (nArgCount > nCount)) {
+						DEBUG_PRINTF("Invalid count [%d]", nArgCount);
+						return false;
+					}
+
+					nCount = nArgCount;
+				}
+
+				if ((nChannel < 1) || (nCount <= 0) || ((nChannel + nCount - 1) > DMX_UNIVERSE)) {
+					DEBUG_PRINTF("Invalid range [%d:%d]", nChannel, nCount);
+					return false;
+				}
+
+				DEBUG_PRINTF("Range %d:%d", nChannel, nCount);
+
+				UpdateDmx(reinterpret_cast<const uint8_t*>(blob.GetDataPtr()), nChannel, nCount);
 			} else if ((nArgc == 2) && (Msg.GetType(0) == OSC_INT32)) {
 				uint16_t nChannel = (1 + Msg.GetInt(0));
 
 				if ((nChannel < 1) || (nChannel > DMX_UNIVERSE)) {
 					DEBUG_PRINTF("Invalid channel [%d]", nChannel);
-					return -1;
+					return false;
 				}
 
 				uint8_t nData;
@@ -368,27 +453,18 @@ int OscServer::Run(void) {
 					DEBUG_PUTS("if received");
 					nData = (Msg.GetFloat(1) * DMX_MAX_VALUE);
 				} else {
-					return -1;
+					return false;
 				}
 
 				DEBUG_PRINTF("Channel = %d, Data = %.2x", nChannel, nData);
 
-				bIsDmxDataChanged = IsDmxDataChanged(&nData, nChannel, 1);
-
-				if (bIsDmxDataChanged || m_bEnableNoChangeUpdate) {
-					if (!m_bPartialTransmission) {
-						m_pLightSet->SetData(0, m_pData, DMX_UNIVERSE);
-					} else {
-						m_nLastChannel = nChannel > m_nLastChannel ? nChannel : m_nLastChannel;
-						m_pLightSet->SetData(0, m_pData, m_nLastChannel);
-					}
-				}
+				UpdateDmx(&nData, nChannel, 1);
 			}
-		} else if (OSC::isMatch(m_pBuffer, m_aPathSecond)) {
+		} else if (OSC::isMatch(pBuffer, m_aPathSecond)) {
 			const int nArgc = Msg.GetArgc();
 
 			if (nArgc == 1) { // /path/N 'i' or 'f'
-				const uint16_t nChannel = GetChannel(m_pBuffer);
+				const int nChannel = GetChannel(pBuffer);
 
 				if (nChannel >= 1 && nChannel <= DMX_UNIVERSE) {
 					uint8_t nData;
@@ -400,29 +476,175 @@ int OscServer::Run(void) {
 						DEBUG_PRINTF("f received %f", Msg.GetFloat(0));
 						nData = (Msg.GetFloat(0) * DMX_MAX_VALUE);
 					} else {
-						return -1;
+						return false;
 					}
 
 					DEBUG_PRINTF("Channel = %d, Data = %.2x", nChannel, nData);
 
-					bIsDmxDataChanged = IsDmxDataChanged(&nData, nChannel, 1);
-
-					if (bIsDmxDataChanged || m_bEnableNoChangeUpdate) {
-						if (!m_bPartialTransmission) {
-							m_pLightSet->SetData(0, m_pData, DMX_UNIVERSE);
-						} else {
-							m_nLastChannel = nChannel > m_nLastChannel ? nChannel : m_nLastChannel;
-							m_pLightSet->SetData(0, m_pData, m_nLastChannel);
-						}
-					}
+					UpdateDmx(&nData, nChannel, 1);
 				} else {
-					return -1;
+					return false;
 				}
 			} else {
-				return -1;
+				return false;
 			}
 		}
 	}
 
-	return nBytesReceived;
+	return true;
+}
+
+/*
+ * Returns the milliseconds from now until the timetag.
+ * Timetags in the past, and timetags too far in the future (the clocks are not in sync), are executed immediately.
+ */
+uint32_t OscServer::GetDelayMillis(uint32_t nTimeTagSeconds, uint32_t nTimeTagFraction) {
+	if ((nTimeTagSeconds == 0) && (nTimeTagFraction == OSC_TIMETAG_IMMEDIATE_FRAC)) {
+		return 0;
+	}
+
+	const uint32_t nSeconds = static_cast<uint32_t>(Hardware::Get()->GetTime()) + OSC_TIMETAG_UNIX_OFFSET;
+	const uint32_t nMillis = Hardware::Get()->Millis();
+
+	if (nSeconds != m_nTimeSeconds) {
+		m_nTimeSeconds = nSeconds;
+		m_nTimeSecondsMillis = nMillis;
+	}
+
+	uint32_t nFractionMillis = nMillis - m_nTimeSecondsMillis;
+
+	if (nFractionMillis > 999) {
+		nFractionMillis = 999;
+	}
+
+	const int32_t nDeltaSeconds = static_cast<int32_t>(nTimeTagSeconds - nSeconds);
+
+	if ((nDeltaSeconds < 0) || (nDeltaSeconds > OSCSERVER_SCHEDULE_MAX_SECONDS)) {
+		return 0;
+	}
+
+	const int32_t nDelayMillis = (nDeltaSeconds * 1000) + static_cast<int32_t>((static_cast<uint64_t>(nTimeTagFraction) * 1000) >> 32) - static_cast<int32_t>(nFractionMillis);
+
+	return nDelayMillis > 0 ? static_cast<uint32_t>(nDelayMillis) : 0;
+}
+
+/*
+ * The queue is kept in time order, equal times keep their arrival order.
+ * When the message does not fit, it is executed immediately.
+ */
+bool OscServer::Schedule(const char *pBuffer, uint32_t nLength, uint32_t nRemoteIp, uint32_t nDelayMillis) {
+	if ((m_nScheduled == OSCSERVER_SCHEDULE_ENTRIES) || (nLength > OSCSERVER_SCHEDULE_MESSAGE_SIZE)) {
+		DEBUG_PUTS("Schedule full");
+		return false;
+	}
+
+	const uint32_t nMillis = Hardware::Get()->Millis() + nDelayMillis;
+
+	// Each entry owns a message buffer, the entries are rotated, never copied over
+	const struct TOscServerScheduled Free = m_pScheduled[m_nScheduled];
+	uint32_t nIndex = m_nScheduled;
+
+	while ((nIndex > 0) && (static_cast<int32_t>(m_pScheduled[nIndex - 1].nMillis - nMillis) > 0)) {
+		m_pScheduled[nIndex] = m_pScheduled[nIndex - 1];
+		nIndex--;
+	}
+
+	struct TOscServerScheduled *pEntry = &m_pScheduled[nIndex];
+
+	*pEntry = Free;
+
+	memcpy(pEntry->pMessage, pBuffer, nLength);
+	pEntry->nLength = static_cast<uint16_t>(nLength);
+	pEntry->nRemoteIp = nRemoteIp;
+	pEntry->nMillis = nMillis;
+
+	m_nScheduled++;
+
+	return true;
+}
+
+void OscServer::RunSchedule(void) {
+	if (m_nScheduled == 0) {
+		return;
+	}
+
+	const uint32_t nMillis = Hardware::Get()->Millis();
+	uint32_t nDue = 0;
+
+	while ((nDue < m_nScheduled) && (static_cast<int32_t>(nMillis - m_pScheduled[nDue].nMillis) >= 0)) {
+		HandleMessage(reinterpret_cast<const char*>(m_pScheduled[nDue].pMessage), m_pScheduled[nDue].nLength, m_pScheduled[nDue].nRemoteIp);
+		nDue++;
+	}
+
+	if (nDue == 0) {
+		return;
+	}
+
+	// All the messages due at the same time are one update
+	UpdateOutput(true);
+
+	for (uint32_t i = nDue; i < m_nScheduled; i++) {
+		const struct TOscServerScheduled tmp = m_pScheduled[i - nDue];
+		m_pScheduled[i - nDue] = m_pScheduled[i];
+		m_pScheduled[i] = tmp;
+	}
+
+	m_nScheduled -= nDue;
+}
+
+void OscServer::HandleBundle(const uint8_t *pBuffer, uint32_t nLength, uint32_t nRemoteIp, uint32_t nDepth, uint32_t nParentDelayMillis) {
+	OSCBundle Bundle(pBuffer, nLength);
+
+	if (!Bundle.IsValid()) {
+		DEBUG_PUTS("Invalid bundle");
+		return;
+	}
+
+	const osc_timetag TimeTag = Bundle.GetTimeTag();
+	uint32_t nDelayMillis = GetDelayMillis(TimeTag.sec, TimeTag.frac);
+
+	// A nested bundle cannot be executed before its parent
+	if (nDelayMillis < nParentDelayMillis) {
+		nDelayMillis = nParentDelayMillis;
+	}
+
+	const uint8_t *pElement;
+	uint32_t nElementLength;
+
+	while ((pElement = Bundle.GetNextElement(nElementLength)) != 0) {
+		if (OSCBundle::IsBundle(pElement, nElementLength)) {
+			if (nDepth < OSCSERVER_BUNDLE_MAX_DEPTH) {
+				HandleBundle(pElement, nElementLength, nRemoteIp, nDepth + 1, nDelayMillis);
+			}
+		} else if ((nDelayMillis == 0) || !Schedule(reinterpret_cast<const char*>(pElement), nElementLength, nRemoteIp, nDelayMillis)) {
+			HandleMessage(reinterpret_cast<const char*>(pElement), nElementLength, nRemoteIp);
+		}
+	}
+}
+
+int OscServer::Run(void) {
+	uint32_t nRemoteIp;
+	uint16_t nRemotePort;
+
+	RunSchedule();
+
+	const int nBytesReceived = Network::Get()->RecvFrom(m_nHandle, m_pBuffer, OSCSERVER_MAX_BUFFER, &nRemoteIp, &nRemotePort);
+
+	if (nBytesReceived == 0) {
+		// The receive queue is drained
+		UpdateOutput(true);
+		return 0;
+	}
+
+	if (OSCBundle::IsBundle(reinterpret_cast<const uint8_t*>(m_pBuffer), nBytesReceived)) {
+		HandleBundle(reinterpret_cast<const uint8_t*>(m_pBuffer), nBytesReceived, nRemoteIp, 0, 0);
+		UpdateOutput(false);
+		return nBytesReceived;
+	}
+
+	const bool bIsValid = HandleMessage(m_pBuffer, nBytesReceived, nRemoteIp);
+
+	UpdateOutput(false);
+
+	return bIsValid ? nBytesReceived : -1;
 }
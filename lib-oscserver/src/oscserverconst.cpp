@@ -35,3 +35,4 @@ const char OSCServerConst::PARAMS_PATH[] = "path";
 const char OSCServerConst::PARAMS_TRANSMISSION[] = "partial_transmission";
 const char OSCServerConst::PARAMS_PATH_INFO[] = "path_info";
 const char OSCServerConst::PARAMS_PATH_BLACKOUT[] = "path_blackout";
+const char OSCServerConst::PARAMS_COALESCE_WINDOW[] = "coalesce_window";
@@ -45,6 +45,7 @@ OSCServerParams::OSCServerParams(OSCServerParamsStore *pOSCServerParamsStore): m
 	memset(&m_tOSCServerParams, 0, sizeof(struct TOSCServerParams));
 	m_tOSCServerParams.nIncomingPort = OSC_DEFAULT_INCOMING_PORT;
 	m_tOSCServerParams.nOutgoingPort = OSC_DEFAULT_OUTGOING_PORT;
+	m_tOSCServerParams.nCoalesceMillis = OSCSERVER_DEFAULT_COALESCE_MILLIS;
 }
 
 OSCServerParams::~OSCServerParams(void) {
@@ -140,6 +141,12 @@ void OSCServerParams::callbackFunction(const char *pLine) {
 		m_tOSCServerParams.nSetList |= OSCSERVER_PARAMS_MASK_ENABLE_NO_CHANGE_OUTPUT;
 		return;
 	}
+
+	if (Sscan::Uint8(pLine, OSCServerConst::PARAMS_COALESCE_WINDOW, &nValue8) == SSCAN_OK) {
+		m_tOSCServerParams.nCoalesceMillis = nValue8;
+		m_tOSCServerParams.nSetList |= OSCSERVER_PARAMS_MASK_COALESCE_WINDOW;
+		return;
+	}
 }
 
 void OSCServerParams::Dump(void) {
@@ -173,6 +180,10 @@ void OSCServerParams::Dump(void) {
 	if(isMaskSet(OSCSERVER_PARAMS_MASK_ENABLE_NO_CHANGE_OUTPUT)) {
 		printf(" %s=%d\n", LightSetConst::PARAMS_ENABLE_NO_CHANGE_UPDATE, m_tOSCServerParams.bEnableNoChangeUpdate);
 	}
+
+	if(isMaskSet(OSCSERVER_PARAMS_MASK_COALESCE_WINDOW)) {
+		printf(" %s=%d\n", OSCServerConst::PARAMS_COALESCE_WINDOW, m_tOSCServerParams.nCoalesceMillis);
+	}
 #endif
 }
 
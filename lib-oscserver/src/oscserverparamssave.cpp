@@ -58,6 +58,7 @@ void OSCServerParams::Builder(const struct TOSCServerParams *ptOSCServerParams,
 	builder.Add(OSCServerConst::PARAMS_TRANSMISSION, m_tOSCServerParams.bPartialTransmission, isMaskSet(OSCSERVER_PARAMS_MASK_TRANSMISSION));
 
 	builder.Add(LightSetConst::PARAMS_ENABLE_NO_CHANGE_UPDATE, m_tOSCServerParams.bEnableNoChangeUpdate, isMaskSet(OSCSERVER_PARAMS_MASK_ENABLE_NO_CHANGE_OUTPUT));
+	builder.Add(OSCServerConst::PARAMS_COALESCE_WINDOW, m_tOSCServerParams.nCoalesceMillis, isMaskSet(OSCSERVER_PARAMS_MASK_COALESCE_WINDOW));
 
 	nSize = builder.GetSize();
 
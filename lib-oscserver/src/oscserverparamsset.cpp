@@ -58,4 +58,8 @@ void OSCServerParams::Set(OscServer *pOscServer) {
 	if(isMaskSet(OSCSERVER_PARAMS_MASK_ENABLE_NO_CHANGE_OUTPUT)) {
 		pOscServer->SetEnableNoChangeUpdate(m_tOSCServerParams.bEnableNoChangeUpdate);
 	}
+
+	if (isMaskSet(OSCSERVER_PARAMS_MASK_COALESCE_WINDOW)) {
+		pOscServer->SetCoalesceMillis(m_tOSCServerParams.nCoalesceMillis);
+	}
 }
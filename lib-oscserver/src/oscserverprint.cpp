@@ -34,4 +34,5 @@ void OscServer::Print(void) {
 	printf(" DMX Path             : [%s][%s]\n", m_aPath, m_aPathSecond);
 	printf("  Blackout Path       : [%s]\n", m_aPathBlackOut);
 	printf(" Partial Transmission : %s\n", m_bPartialTransmission ? "Yes" : "No");
+	printf(" Coalesce window      : %d ms\n", static_cast<int>(m_nCoalesceMillis));
 }
@@ -83,6 +83,16 @@ public:
 	void SetFullOn(uint8_t, bool);
 	void SetFullOff(uint8_t, bool);
 
+	/*
+	 * Buffered writes: the channel values are kept in a shadow table and
+	 * Flush() queues each contiguous run of dirty channels as a single
+	 * auto-increment I2C transfer (or one ALL_LED write when all 16 match).
+	 * The queue is run for a bounded time, the remaining transfers complete
+	 * in a next Flush(), any other I2C transfer, or i2c_async_run().
+	 */
+	void WriteBuffered(uint8_t nChannel, uint16_t nOn, uint16_t nOff);
+	void Flush(void);
+
 	void Dump(void);
 
 private:
@@ -96,6 +106,8 @@ private:
 private:
 	void I2cSetup(void);
 
+	void I2cWriteAsync(const char *, uint32_t);
+
 	void I2cWriteReg(uint8_t, uint8_t);
 	uint8_t I2cReadReg(uint8_t);
 
@@ -106,6 +118,9 @@ private:
 
 private:
 	uint8_t m_nAddress;
+	uint16_t m_nDirty;
+	uint16_t m_aOn[PCA9685_PWM_CHANNELS];
+	uint16_t m_aOff[PCA9685_PWM_CHANNELS];
 };
 
 #endif /* PCA9685_H_ */
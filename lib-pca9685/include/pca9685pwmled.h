@@ -2,7 +2,7 @@
  * @file pwmled.h
  *
  */
-/* Copyright (C) 2017-2018 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2017-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -40,6 +40,9 @@ public:
 	void Set(uint8_t nChannel, uint16_t nData);
 	void Set(uint8_t nChannel, uint8_t nData);
 
+	void SetBuffered(uint8_t nChannel, uint16_t nData);
+	void SetBuffered(uint8_t nChannel, uint8_t nData);
+
 private:
 };
 
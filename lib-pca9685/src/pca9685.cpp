@@ -36,6 +36,8 @@
 
 #define DIV_ROUND_UP(n,d)	(((n) + (d) - 1) / (d))
 
+#define PCA9685_FLUSH_BUDGET_US	100
+
 #define PCA9685_OSC_FREQ 25000000L
 
 enum TPCA9685Reg {
@@ -79,15 +81,17 @@ enum TPCA9685Mode2 {
 	PCA9685_MODE2_INVRT = 1 << 4
 };
 
-PCA9685::PCA9685(uint8_t nAddress) : m_nAddress(nAddress) {
+PCA9685::PCA9685(uint8_t nAddress) : m_nAddress(nAddress), m_nDirty(0) {
 	FUNC_PREFIX(i2c_begin());
 
 	AutoIncrement(true);
 
-	for (uint8_t i = 0; i < 16; i ++) {
-		Write(i, static_cast<uint16_t>(0), static_cast<uint16_t>(0x1000));
+	for (uint8_t i = 0; i < PCA9685_PWM_CHANNELS; i ++) {
+		WriteBuffered(i, static_cast<uint16_t>(0), static_cast<uint16_t>(0x1000));
 	}
 
+	Flush();
+
 	Sleep(false);
 }
 
@@ -197,6 +201,72 @@ void PCA9685::Write(uint8_t nChannel, uint16_t nOn, uint16_t nOff) {
 	I2cWriteReg(reg, nOn, nOff);
 }
 
+void PCA9685::WriteBuffered(uint8_t nChannel, uint16_t nOn, uint16_t nOff) {
+	assert(nChannel < PCA9685_PWM_CHANNELS);
+
+	m_aOn[nChannel] = nOn;
+	m_aOff[nChannel] = nOff;
+	m_nDirty |= static_cast<uint16_t>(1U << nChannel);
+}
+
+void PCA9685::Flush(void) {
+	if (m_nDirty == 0) {
+		return;
+	}
+
+	if (m_nDirty == 0xFFFF) {
+		uint32_t i;
+
+		for (i = 1; i < PCA9685_PWM_CHANNELS; i++) {
+			if ((m_aOn[i] != m_aOn[0]) || (m_aOff[i] != m_aOff[0])) {
+				break;
+			}
+		}
+
+		if (i == PCA9685_PWM_CHANNELS) {
+			char buffer[5];
+
+			buffer[0] = static_cast<char>(PCA9685_REG_ALL_LED_ON_L);
+			buffer[1] = static_cast<char>(m_aOn[0] & 0xFF);
+			buffer[2] = static_cast<char>(m_aOn[0] >> 8);
+			buffer[3] = static_cast<char>(m_aOff[0] & 0xFF);
+			buffer[4] = static_cast<char>(m_aOff[0] >> 8);
+
+			I2cSetup();
+			I2cWriteAsync(buffer, sizeof(buffer));
+			i2c_async_run(PCA9685_FLUSH_BUDGET_US);
+
+			m_nDirty = 0;
+			return;
+		}
+	}
+
+	char buffer[1 + (4 * PCA9685_PWM_CHANNELS)];
+
+	I2cSetup();
+
+	while (m_nDirty != 0) {
+		const uint32_t nFirst = static_cast<uint32_t>(__builtin_ctz(m_nDirty));
+		uint32_t nChannel;
+
+		buffer[0] = static_cast<char>(PCA9685_REG_LED0_ON_L + (nFirst << 2));
+
+		char *p = &buffer[1];
+
+		for (nChannel = nFirst; (nChannel < PCA9685_PWM_CHANNELS) && (m_nDirty & (1U << nChannel)); nChannel++) {
+			*p++ = static_cast<char>(m_aOn[nChannel] & 0xFF);
+			*p++ = static_cast<char>(m_aOn[nChannel] >> 8);
+			*p++ = static_cast<char>(m_aOff[nChannel] & 0xFF);
+			*p++ = static_cast<char>(m_aOff[nChannel] >> 8);
+			m_nDirty &= static_cast<uint16_t>(~(1U << nChannel));
+		}
+
+		I2cWriteAsync(buffer, static_cast<uint32_t>(p - buffer));
+	}
+
+	i2c_async_run(PCA9685_FLUSH_BUDGET_US);
+}
+
 void PCA9685::Write(uint8_t nChannel, uint16_t nValue) {
 	Write(nChannel, static_cast<uint16_t>(0), nValue);
 }
@@ -365,6 +435,22 @@ void PCA9685::I2cSetup(void) {
 	FUNC_PREFIX(i2c_set_baudrate(I2C_FULL_SPEED));
 }
 
+/*
+ * When the queue is full it is run once more, after that the write is blocking.
+ * A blocking write first completes the transfers already queued.
+ */
+void PCA9685::I2cWriteAsync(const char *pBuffer, uint32_t nLength) {
+	if (i2c_write_async(pBuffer, nLength)) {
+		return;
+	}
+
+	i2c_async_run(PCA9685_FLUSH_BUDGET_US);
+
+	if (!i2c_write_async(pBuffer, nLength)) {
+		FUNC_PREFIX(i2c_write(pBuffer, nLength));
+	}
+}
+
 void PCA9685::I2cWriteReg(uint8_t reg, uint8_t data) {
 	char buffer[2];
 
@@ -2,7 +2,7 @@
  * @file pwmled.cpp
  *
  */
-/* Copyright (C) 2017-2018 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2017-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -59,3 +59,28 @@ void PCA9685PWMLed::Set(uint8_t nChannel, uint8_t nData) {
 		Write(nChannel, nValue);
 	}
 }
+
+/*
+ * The full ON / full OFF bits (bit 4 of LEDn_ON_H / LEDn_OFF_H) are part of
+ * the register values, so no read-modify-write is needed.
+ */
+void PCA9685PWMLed::SetBuffered(uint8_t nChannel, uint16_t nData) {
+	if (nData >= MAX_12BIT) {
+		WriteBuffered(nChannel, static_cast<uint16_t>(0x1000), static_cast<uint16_t>(0));
+	} else if (nData == 0) {
+		WriteBuffered(nChannel, static_cast<uint16_t>(0), static_cast<uint16_t>(0x1000));
+	} else {
+		WriteBuffered(nChannel, static_cast<uint16_t>(0), nData);
+	}
+}
+
+void PCA9685PWMLed::SetBuffered(uint8_t nChannel, uint8_t nData) {
+	if (nData == MAX_8BIT) {
+		WriteBuffered(nChannel, static_cast<uint16_t>(0x1000), static_cast<uint16_t>(0));
+	} else if (nData == 0) {
+		WriteBuffered(nChannel, static_cast<uint16_t>(0), static_cast<uint16_t>(0x1000));
+	} else {
+		const uint16_t nValue = (nData << 4) | (nData >> 4);
+		WriteBuffered(nChannel, static_cast<uint16_t>(0), nValue);
+	}
+}
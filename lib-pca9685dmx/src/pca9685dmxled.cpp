@@ -110,23 +110,31 @@ void PCA9685DmxLed::SetData(uint8_t nPort, const uint8_t *pDmxData, uint16_t nLe
 	uint16_t nChannel = m_nDmxStartAddress;
 
 	for (unsigned j = 0; j < m_nBoardInstances; j++) {
+		bool bIsLast = false;
+
 		for (unsigned i = 0; i < PCA9685_PWM_CHANNELS; i++) {
 			if ((nChannel >= (m_nDmxFootprint + m_nDmxStartAddress)) || (nChannel > nLength)) {
-				j = m_nBoardInstances;
+				bIsLast = true;
 				break;
 			}
 			if (*p != *q) {
 				uint8_t value = *p;
 #ifndef NDEBUG
-				printf("m_pPWMLed[%d]->SetDmx(CHANNEL(%d), %d)\n", static_cast<int>(j), static_cast<int>(i), static_cast<int>(value));
+				printf("m_pPWMLed[%d]->SetBuffered(CHANNEL(%d), %d)\n", static_cast<int>(j), static_cast<int>(i), static_cast<int>(value));
 #endif
-				m_pPWMLed[j]->Set(CHANNEL(i), value);
+				m_pPWMLed[j]->SetBuffered(CHANNEL(i), value);
 			}
 			*q = *p;
 			p++;
 			q++;
 			nChannel++;
 		}
+
+		m_pPWMLed[j]->Flush();
+
+		if (bIsLast) {
+			break;
+		}
 	}
 }
 
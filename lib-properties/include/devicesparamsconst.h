@@ -48,6 +48,9 @@ public:
 
 	static const char ACTIVE_OUT[];
 	static const char USE_SI5351A[];
+
+	static const char REFRESH_RATE[];
+	static const char GAMMA[];
 };
 
 #endif /* DEVICESPARAMSCONST_H_ */
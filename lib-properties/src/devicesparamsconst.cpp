@@ -45,3 +45,6 @@ const char DevicesParamsConst::GLOBAL_BRIGHTNESS[] = "global_brightness";
 
 const char DevicesParamsConst::ACTIVE_OUT[] = "active_out";
 const char DevicesParamsConst::USE_SI5351A[] = "use_si5351A";
+
+const char DevicesParamsConst::REFRESH_RATE[] = "refresh_rate";
+const char DevicesParamsConst::GAMMA[] = "gamma";
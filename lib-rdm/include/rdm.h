@@ -179,6 +179,14 @@ public:
 	static const uint8_t *Receive(uint8_t nPort);
 	static const uint8_t *ReceiveTimeOut(uint8_t nPort, uint32_t);
 
+	/*
+	 * Non-blocking request/response: SendRawAsync returns false when the port is busy,
+	 * ReceiveAsync returns 0 until a response arrived, or bIsTimeOut is set.
+	 * The time-out starts when the request has left the wire.
+	 */
+	static bool SendRawAsync(uint8_t nPort, const uint8_t *, uint16_t);
+	static const uint8_t *ReceiveAsync(uint8_t nPort, uint32_t nTimeOut, bool& bIsTimeOut);
+
 public:
 #if defined(H3)
 	static uint8_t m_TransactionNumber[4];
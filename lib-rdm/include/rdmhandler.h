@@ -31,6 +31,10 @@
 
 #include "rdmmessage.h"
 #include "rdmqueuedmessage.h"
+#include "rdmmanufacturerpid.h"
+
+#define RDM_PID_DISPATCH_BITS	7
+#define RDM_PID_DISPATCH_SIZE	(1U << RDM_PID_DISPATCH_BITS)	///< At least twice the number of PIDs
 
 class RDMHandler {
 public:
@@ -39,8 +43,13 @@ public:
 
 	void HandleData(const uint8_t *pRdmDataIn, uint8_t *pRdmDataOut);
 
+	uint32_t GetPidHits(uint16_t nPid) const;
+
+	void Print(void);
+
 private:
 	void Handlers(bool bIsBroadcast, uint8_t nCommandClass, uint16_t nParamId, uint8_t nParamDataLength, uint16_t nSubDevice);
+	void HandleManufacturerPid(const struct TRdmManufacturerPid *pDefinition, bool bIsBroadcast, uint8_t nCommandClass, uint8_t nParamDataLength, uint16_t nSubDevice);
 
 	typedef struct {
 		const uint16_t nPid;
@@ -55,6 +64,26 @@ private:
 	static const TPidDefinition PID_DEFINITIONS[];
 	static const TPidDefinition PID_DEFINITIONS_SUB_DEVICES[];
 
+	enum TPidTable {
+		PID_TABLE_NONE,
+		PID_TABLE_STANDARD,			///< PID_DEFINITIONS
+		PID_TABLE_MANUFACTURER		///< RDM_MANUFACTURER_PIDS
+	};
+
+	/*
+	 * Open addressing hash table, built in the constructor from PID_DEFINITIONS and RDM_MANUFACTURER_PIDS
+	 */
+	struct TPidDispatch {
+		uint16_t nPid;
+		uint8_t nTable;
+		uint8_t nIndex;
+		uint32_t nHits;
+	};
+
+	void BuildPidDispatch(void);
+	bool AddPid(uint16_t nPid, TPidTable tTable, uint32_t nIndex);
+	int32_t FindPid(uint16_t nPid) const;
+
 	// Get
 	void GetQueuedMessage(uint16_t nSubDevice);
 	void GetSupportedParameters(uint16_t nSubDevice);
@@ -133,6 +162,7 @@ private:
 	bool m_IsMuted;
 	uint8_t *m_pRdmDataIn;
 	uint8_t *m_pRdmDataOut;
+	TPidDispatch m_PidDispatch[RDM_PID_DISPATCH_SIZE];
 };
 
 #endif /* RDMHANDLER_H_ */
@@ -0,0 +1,62 @@
+/**
+ * @file rdmmanufacturerpid.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef RDMMANUFACTURERPID_H_
+#define RDMMANUFACTURERPID_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "rdm.h"
+
+#define RDM_MANUFACTURER_PID_MIN	0x8000
+#define RDM_MANUFACTURER_PID_MAX	0xFFDF
+
+/*
+ * Manufacturer-specific PIDs (0x8000-0xFFDF) are registered at compile time:
+ * the firmware defines RDM_MANUFACTURER_PIDS and RDM_MANUFACTURER_PIDS_COUNT,
+ * for example in its lib folder. Without these the library default is an empty table.
+ *
+ * A handler fills pRdmDataOut->param_data and param_data_length and returns true
+ * for an ACK, or sets nReason and returns false for a NACK.
+ */
+
+typedef bool (*RdmManufacturerGetHandler)(uint16_t nSubDevice, const struct TRdmMessageNoSc *pRdmDataIn, struct TRdmMessage *pRdmDataOut, uint16_t& nReason);
+typedef bool (*RdmManufacturerSetHandler)(bool bIsBroadcast, uint16_t nSubDevice, const struct TRdmMessageNoSc *pRdmDataIn, struct TRdmMessage *pRdmDataOut, uint16_t& nReason);
+
+struct TRdmManufacturerPid {
+	uint16_t nPid;
+	RdmManufacturerGetHandler pGetHandler;
+	RdmManufacturerSetHandler pSetHandler;
+	uint8_t nGetArgumentSize;
+	bool bIncludeInSupportedParams;
+	bool bRDM;
+	bool bRDMNet;
+};
+
+extern const struct TRdmManufacturerPid RDM_MANUFACTURER_PIDS[];
+extern const uint32_t RDM_MANUFACTURER_PIDS_COUNT;
+
+#endif /* RDMMANUFACTURERPID_H_ */
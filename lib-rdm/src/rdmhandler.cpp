@@ -48,9 +48,15 @@
 #include "rdm_e120.h"
 
 #include "hardware.h"
+#include "metrics.h"
 
 #include "debug.h"
 
+static struct metric s_MetricRequests = METRIC_COUNTER("rdm.requests");
+static struct metric s_MetricDiscovery = METRIC_COUNTER("rdm.discovery");
+static struct metric s_MetricNacks = METRIC_COUNTER("rdm.nacks");
+static struct metric s_MetricUnknownPid = METRIC_COUNTER("rdm.unknown_pid");
+
 enum TPowerState {
 	POWER_STATE_FULL_OFF = 0x00,	///< Completely disengages power to device. Device can no longer respond.
 	POWER_STATE_SHUTDOWN = 0x01,	///< Reduced power mode, may require device reset to return to normal operation. Device still responds to messages.
@@ -65,6 +71,12 @@ RDMHandler::RDMHandler(bool bIsRdm):
 	m_pRdmDataIn(0),
 	m_pRdmDataOut(0)
 {
+	metrics_register(&s_MetricRequests);
+	metrics_register(&s_MetricDiscovery);
+	metrics_register(&s_MetricNacks);
+	metrics_register(&s_MetricUnknownPid);
+
+	BuildPidDispatch();
 }
 
 RDMHandler::~RDMHandler(void) {
@@ -146,6 +158,7 @@ void RDMHandler::RespondMessageAck(void) {
 }
 
 void RDMHandler::RespondMessageNack(uint16_t nReason) {
+	metric_inc(&s_MetricNacks);
 	CreateRespondMessage(E120_RESPONSE_TYPE_NACK_REASON, nReason);
 }
 
@@ -202,6 +215,109 @@ const RDMHandler::TPidDefinition RDMHandler::PID_DEFINITIONS_SUB_DEVICES[] {
 	{E120_IDENTIFY_DEVICE,		       &RDMHandler::GetIdentifyDevice,		    	&RDMHandler::SetIdentifyDevice,		0, true, true ,  false}
 };
 
+/*
+ * Fibonacci hashing, the PIDs are clustered per range (0x00xx, 0x01xx, 0x02xx, 0x07xx, 0x10xx, 0x80xx)
+ */
+static uint32_t pid_hash(uint16_t nPid) {
+	return (static_cast<uint32_t>(nPid) * 0x9E3779B1U) >> (32 - RDM_PID_DISPATCH_BITS);
+}
+
+bool RDMHandler::AddPid(uint16_t nPid, TPidTable tTable, uint32_t nIndex) {
+	uint32_t nCount = 0;
+
+	for (uint32_t i = 0; i < RDM_PID_DISPATCH_SIZE; i++) {
+		if (m_PidDispatch[i].nTable != PID_TABLE_NONE) {
+			nCount++;
+		}
+	}
+
+	// Keep the load factor at 0.5 or less, so that the probe sequences stay short
+	if (nCount >= (RDM_PID_DISPATCH_SIZE / 2)) {
+		return false;
+	}
+
+	uint32_t nSlot = pid_hash(nPid);
+
+	while (m_PidDispatch[nSlot].nTable != PID_TABLE_NONE) {
+		if (m_PidDispatch[nSlot].nPid == nPid) {
+			return false;
+		}
+		nSlot = (nSlot + 1) & (RDM_PID_DISPATCH_SIZE - 1);
+	}
+
+	m_PidDispatch[nSlot].nPid = nPid;
+	m_PidDispatch[nSlot].nTable = tTable;
+	m_PidDispatch[nSlot].nIndex = static_cast<uint8_t>(nIndex);
+	m_PidDispatch[nSlot].nHits = 0;
+
+	return true;
+}
+
+int32_t RDMHandler::FindPid(uint16_t nPid) const {
+	uint32_t nSlot = pid_hash(nPid);
+
+	while (m_PidDispatch[nSlot].nTable != PID_TABLE_NONE) {
+		if (m_PidDispatch[nSlot].nPid == nPid) {
+			return static_cast<int32_t>(nSlot);
+		}
+		nSlot = (nSlot + 1) & (RDM_PID_DISPATCH_SIZE - 1);
+	}
+
+	return -1;
+}
+
+uint32_t RDMHandler::GetPidHits(uint16_t nPid) const {
+	const int32_t nSlot = FindPid(nPid);
+
+	if (nSlot < 0) {
+		return 0;
+	}
+
+	return m_PidDispatch[nSlot].nHits;
+}
+
+void RDMHandler::Print(void) {
+	printf("RDM PID dispatch\n");
+
+	for (uint32_t i = 0; i < RDM_PID_DISPATCH_SIZE; i++) {
+		if ((m_PidDispatch[i].nTable != PID_TABLE_NONE) && (m_PidDispatch[i].nHits != 0)) {
+			printf(" %.4x %c %u\n", m_PidDispatch[i].nPid, m_PidDispatch[i].nTable == PID_TABLE_MANUFACTURER ? 'M' : ' ', m_PidDispatch[i].nHits);
+		}
+	}
+}
+
+void RDMHandler::BuildPidDispatch(void) {
+	for (uint32_t i = 0; i < RDM_PID_DISPATCH_SIZE; i++) {
+		m_PidDispatch[i].nTable = PID_TABLE_NONE;
+	}
+
+	static_assert((2 * (sizeof(PID_DEFINITIONS) / sizeof(PID_DEFINITIONS[0]))) <= RDM_PID_DISPATCH_SIZE, "RDM_PID_DISPATCH_BITS is too small for PID_DEFINITIONS");
+
+	for (uint32_t i = 0; i < sizeof(PID_DEFINITIONS) / sizeof(PID_DEFINITIONS[0]); i++) {
+		const bool bIsAdded = AddPid(PID_DEFINITIONS[i].nPid, PID_TABLE_STANDARD, i);
+		assert(bIsAdded);
+		(void) bIsAdded;
+	}
+
+	// The manufacturer PIDs are defined by the firmware, only known at run-time
+	for (uint32_t i = 0; i < RDM_MANUFACTURER_PIDS_COUNT; i++) {
+		assert(RDM_MANUFACTURER_PIDS[i].nPid >= RDM_MANUFACTURER_PID_MIN);
+		assert(RDM_MANUFACTURER_PIDS[i].nPid <= RDM_MANUFACTURER_PID_MAX);
+
+		if (!AddPid(RDM_MANUFACTURER_PIDS[i].nPid, PID_TABLE_MANUFACTURER, i)) {
+			printf("RDM: Manufacturer PID %.4x is not added, it is a duplicate or the PID dispatch table is full\n", RDM_MANUFACTURER_PIDS[i].nPid);
+		}
+	}
+
+#ifndef NDEBUG
+	for (uint32_t i = 0; i < sizeof(PID_DEFINITIONS) / sizeof(PID_DEFINITIONS[0]); i++) {
+		const int32_t nSlot = FindPid(PID_DEFINITIONS[i].nPid);
+		assert(nSlot >= 0);
+		assert(m_PidDispatch[nSlot].nIndex == i);
+	}
+#endif
+}
+
 /**
  *
  * @param pRdmDataIn RDM with no Start Code
@@ -244,6 +360,7 @@ void RDMHandler::HandleData(const uint8_t *pRdmDataIn, uint8_t *pRdmDataOut) {
 	if ((!bIsRdmPacketForMe) && (!bIsRdmPacketBroadcast)) {
 		// Ignore RDM packet
 	} else if (command_class == E120_DISCOVERY_COMMAND) {
+		metric_inc(&s_MetricDiscovery);
 
 		if (param_id == E120_DISC_UNIQUE_BRANCH) {
 
@@ -332,6 +449,7 @@ void RDMHandler::HandleData(const uint8_t *pRdmDataIn, uint8_t *pRdmDataOut) {
 			}
 		}
 	} else {
+		metric_inc(&s_MetricRequests);
 		uint16_t sub_device = (pRdmRequest->sub_device[0] << 8) + pRdmRequest->sub_device[1];
 		Handlers(bIsRdmPacketBroadcast || bIsRdmPacketVendorcast, command_class, param_id, pRdmRequest->param_data_length, sub_device);
 	}
@@ -342,10 +460,6 @@ void RDMHandler::HandleData(const uint8_t *pRdmDataIn, uint8_t *pRdmDataOut) {
 void RDMHandler::Handlers(bool bIsBroadcast, uint8_t nCommandClass, uint16_t nParamId, uint8_t nParamDataLength, uint16_t nSubDevice) {
 	DEBUG1_ENTRY
 
-	TPidDefinition const *pid_handler = 0;
-	bool bRDM;
-	bool bRDMNet;
-
 	if (nCommandClass != E120_GET_COMMAND && nCommandClass != E120_SET_COMMAND) {
 		RespondMessageNack(E120_NR_UNSUPPORTED_COMMAND_CLASS);
 		return;
@@ -358,34 +472,45 @@ void RDMHandler::Handlers(bool bIsBroadcast, uint8_t nCommandClass, uint16_t nPa
 		return;
 	}
 
-	for (uint32_t i = 0; i < sizeof(PID_DEFINITIONS) / sizeof(PID_DEFINITIONS[0]); ++i) {
-		if (PID_DEFINITIONS[i].nPid == nParamId) {
-			pid_handler = &PID_DEFINITIONS[i];
-			bRDM = PID_DEFINITIONS[i].bRDM;
-			bRDMNet = PID_DEFINITIONS[i].bRDMNet;
-		}
-	}
+	const int32_t nSlot = FindPid(nParamId);
 
-	if (!pid_handler) {
+	if (nSlot < 0) {
+		metric_inc(&s_MetricUnknownPid);
 		RespondMessageNack(E120_NR_UNKNOWN_PID);
 		DEBUG1_EXIT
 		return;
 	}
 
-	if (m_bIsRDM) {
-		if (!bRDM) {
-			RespondMessageNack(E120_NR_UNKNOWN_PID);
-			DEBUG1_EXIT
-			return;
-		}
-	} else {
-		if (!bRDMNet) {
+	struct TPidDispatch *pDispatch = &m_PidDispatch[nSlot];
+
+	if (pDispatch->nTable == PID_TABLE_MANUFACTURER) {
+		const struct TRdmManufacturerPid *pDefinition = &RDM_MANUFACTURER_PIDS[pDispatch->nIndex];
+
+		if (m_bIsRDM ? !pDefinition->bRDM : !pDefinition->bRDMNet) {
+			metric_inc(&s_MetricUnknownPid);
 			RespondMessageNack(E120_NR_UNKNOWN_PID);
 			DEBUG1_EXIT
 			return;
 		}
+
+		pDispatch->nHits++;
+
+		HandleManufacturerPid(pDefinition, bIsBroadcast, nCommandClass, nParamDataLength, nSubDevice);
+		DEBUG1_EXIT
+		return;
+	}
+
+	const TPidDefinition *pid_handler = &PID_DEFINITIONS[pDispatch->nIndex];
+
+	if (m_bIsRDM ? !pid_handler->bRDM : !pid_handler->bRDMNet) {
+		metric_inc(&s_MetricUnknownPid);
+		RespondMessageNack(E120_NR_UNKNOWN_PID);
+		DEBUG1_EXIT
+		return;
 	}
 
+	pDispatch->nHits++;
+
 	if (nCommandClass == E120_GET_COMMAND) {
 		if (bIsBroadcast) {
 			DEBUG1_EXIT
@@ -424,6 +549,55 @@ void RDMHandler::Handlers(bool bIsBroadcast, uint8_t nCommandClass, uint16_t nPa
 	DEBUG1_EXIT
 }
 
+void RDMHandler::HandleManufacturerPid(const struct TRdmManufacturerPid *pDefinition, bool bIsBroadcast, uint8_t nCommandClass, uint8_t nParamDataLength, uint16_t nSubDevice) {
+	const struct TRdmMessageNoSc *pRdmDataIn = reinterpret_cast<const struct TRdmMessageNoSc*>(m_pRdmDataIn);
+	struct TRdmMessage *pRdmDataOut = reinterpret_cast<struct TRdmMessage*>(m_pRdmDataOut);
+	uint16_t nReason = E120_NR_HARDWARE_FAULT;
+	bool bIsAck;
+
+	pRdmDataOut->param_data_length = 0;
+
+	if (nCommandClass == E120_GET_COMMAND) {
+		if (bIsBroadcast) {
+			return;
+		}
+
+		if (nSubDevice == E120_SUB_DEVICE_ALL_CALL) {
+			RespondMessageNack(E120_NR_SUB_DEVICE_OUT_OF_RANGE);
+			return;
+		}
+
+		if (pDefinition->pGetHandler == 0) {
+			RespondMessageNack(E120_NR_UNSUPPORTED_COMMAND_CLASS);
+			return;
+		}
+
+		if (nParamDataLength != pDefinition->nGetArgumentSize) {
+			RespondMessageNack(E120_NR_FORMAT_ERROR);
+			return;
+		}
+
+		bIsAck = pDefinition->pGetHandler(nSubDevice, pRdmDataIn, pRdmDataOut, nReason);
+	} else {
+		if (pDefinition->pSetHandler == 0) {
+			RespondMessageNack(E120_NR_UNSUPPORTED_COMMAND_CLASS);
+			return;
+		}
+
+		bIsAck = pDefinition->pSetHandler(bIsBroadcast, nSubDevice, pRdmDataIn, pRdmDataOut, nReason);
+
+		if (bIsBroadcast) {
+			return;
+		}
+	}
+
+	if (bIsAck) {
+		RespondMessageAck();
+	} else {
+		RespondMessageNack(nReason);
+	}
+}
+
 void RDMHandler::GetQueuedMessage(/*@unused@*/uint16_t nSubDevice) {
 	m_RDMQueuedMessage.Handler(m_pRdmDataOut);
 	RespondMessageAck();
@@ -442,26 +616,30 @@ void RDMHandler::GetSupportedParameters(uint16_t nSubDevice) {
 		nTableSize = sizeof(PID_DEFINITIONS) / sizeof(PID_DEFINITIONS[0]);
 	}
 
+	struct TRdmMessage *pRdmDataOut = reinterpret_cast<struct TRdmMessage*>(m_pRdmDataOut);
+
 	for (uint32_t i = 0; i < nTableSize; i++) {
 		if (pPidDefinitions[i].bIncludeInSupportedParams) {
+			pRdmDataOut->param_data[nSupportedParams + nSupportedParams] = (pPidDefinitions[i].nPid >> 8);
+			pRdmDataOut->param_data[nSupportedParams + nSupportedParams + 1] = pPidDefinitions[i].nPid;
 			nSupportedParams++;
 		}
 	}
 
-	struct TRdmMessage *pRdmDataOut = reinterpret_cast<struct TRdmMessage*>(m_pRdmDataOut);
-
-	pRdmDataOut->param_data_length = (2 * nSupportedParams);
-
-	uint32_t j = 0;
+	if (nSubDevice == 0) {
+		for (uint32_t i = 0; i < RDM_MANUFACTURER_PIDS_COUNT; i++) {
+			const struct TRdmManufacturerPid *pDefinition = &RDM_MANUFACTURER_PIDS[i];
 
-	for (uint32_t i = 0; i < nTableSize; i++) {
-		if (pPidDefinitions[i].bIncludeInSupportedParams) {
-			pRdmDataOut->param_data[j + j] = (pPidDefinitions[i].nPid >> 8);
-			pRdmDataOut->param_data[j + j + 1] = pPidDefinitions[i].nPid;
-			j++;
+			if (pDefinition->bIncludeInSupportedParams && (m_bIsRDM ? pDefinition->bRDM : pDefinition->bRDMNet) && (nSupportedParams < (sizeof(pRdmDataOut->param_data) / 2))) {
+				pRdmDataOut->param_data[nSupportedParams + nSupportedParams] = (pDefinition->nPid >> 8);
+				pRdmDataOut->param_data[nSupportedParams + nSupportedParams + 1] = pDefinition->nPid;
+				nSupportedParams++;
+			}
 		}
 	}
 
+	pRdmDataOut->param_data_length = (2 * nSupportedParams);
+
 	RespondMessageAck();
 }
 
@@ -24,8 +24,14 @@ public:
 	void Copy(uint8_t nPort, uint8_t *pTod);
 	const uint8_t *Handler(uint8_t nPort, const uint8_t *pRdmData);
 
+	bool HandlerStart(uint8_t nPort, const uint8_t *pRdmData);
+	bool HandlerPoll(uint8_t nPort, const uint8_t*& pResponse);
+
 	void DumpTod(uint8_t nPort = 0);
 
+private:
+	uint16_t CopyCommand(uint8_t nPort, const uint8_t *pRdmData);
+
 private:
 	RDMDiscovery *m_Discovery[DMX_MAX_UARTS];
 	struct TRdmMessage *m_pRdmCommand;
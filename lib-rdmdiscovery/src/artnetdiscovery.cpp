@@ -42,6 +42,8 @@
 
 #include "debug.h"
 
+#define ARTNET_RDM_RESPONSE_TIMEOUT_US	20000
+
 ArtNetRdmController::ArtNetRdmController(void) : m_pRdmCommand(0){
 	for (unsigned i = 0 ; i < DMX_MAX_UARTS; i++) {
 		m_Discovery[i] = new RDMDiscovery(i);
@@ -100,6 +102,23 @@ void ArtNetRdmController::DumpTod(uint8_t nPort) {
 	m_Discovery[nPort]->Dump();
 }
 
+uint16_t ArtNetRdmController::CopyCommand(uint8_t nPort, const uint8_t *pRdmData) {
+	while (0 != RDMMessage::Receive(nPort)) {
+		// Discard late responses
+	}
+
+	const TRdmMessageNoSc *pRdmMessageNoSc = reinterpret_cast<const TRdmMessageNoSc*>(const_cast<uint8_t*>(pRdmData));
+	uint8_t *pRdmCommand = reinterpret_cast<uint8_t*>(m_pRdmCommand);
+
+	memcpy(&pRdmCommand[1], pRdmData, pRdmMessageNoSc->message_length + 2);
+
+#ifndef NDEBUG
+	RDMMessage::Print(pRdmCommand);
+#endif
+
+	return pRdmMessageNoSc->message_length + 2;
+}
+
 const uint8_t *ArtNetRdmController::Handler(uint8_t nPort, const uint8_t *pRdmData) {
 	assert(nPort < DMX_MAX_UARTS);
 
@@ -109,25 +128,40 @@ const uint8_t *ArtNetRdmController::Handler(uint8_t nPort, const uint8_t *pRdmDa
 
 	Hardware::Get()->WatchdogFeed();
 
-	while (0 != RDMMessage::Receive(nPort)) {
-		// Discard late responses
-	}
+	const uint16_t nLength = CopyCommand(nPort, pRdmData);
 
-	const TRdmMessageNoSc *pRdmMessageNoSc = reinterpret_cast<const TRdmMessageNoSc*>(const_cast<uint8_t*>(pRdmData));
-	uint8_t *pRdmCommand = reinterpret_cast<uint8_t*>(m_pRdmCommand);
+	RDMMessage::SendRaw(nPort, reinterpret_cast<const uint8_t*>(m_pRdmCommand), nLength);
 
-	memcpy(&pRdmCommand[1], pRdmData, pRdmMessageNoSc->message_length + 2);
+	const uint8_t *pResponse = RDMMessage::ReceiveTimeOut(nPort, ARTNET_RDM_RESPONSE_TIMEOUT_US);
 
 #ifndef NDEBUG
-	RDMMessage::Print(pRdmCommand);
+	RDMMessage::Print(pResponse);
 #endif
+	return pResponse;
+}
+
+bool ArtNetRdmController::HandlerStart(uint8_t nPort, const uint8_t *pRdmData) {
+	assert(nPort < DMX_MAX_UARTS);
+	assert(pRdmData != 0);
+
+	const uint16_t nLength = CopyCommand(nPort, pRdmData);
 
-	RDMMessage::SendRaw(nPort, pRdmCommand, pRdmMessageNoSc->message_length + 2);
+	return RDMMessage::SendRawAsync(nPort, reinterpret_cast<const uint8_t*>(m_pRdmCommand), nLength);
+}
+
+bool ArtNetRdmController::HandlerPoll(uint8_t nPort, const uint8_t*& pResponse) {
+	assert(nPort < DMX_MAX_UARTS);
 
-	const uint8_t *pResponse = RDMMessage::ReceiveTimeOut(nPort, 20000);
+	bool bIsTimeOut;
+
+	pResponse = RDMMessage::ReceiveAsync(nPort, ARTNET_RDM_RESPONSE_TIMEOUT_US, bIsTimeOut);
+
+	if ((pResponse == 0) && !bIsTimeOut) {
+		return false;
+	}
 
 #ifndef NDEBUG
 	RDMMessage::Print(pResponse);
 #endif
-	return pResponse;
+	return true;
 }
@@ -176,6 +176,10 @@ private:
 	void HandleList(void);
 	void HandleUptime(void);
 	void HandleVersion(void);
+	void HandleMetrics(void);
+#if defined (ENABLE_PROFILER)
+	void HandleProfile(void);
+#endif
 
 	void HandleGet(void);
 	void HandleGetRconfigTxt(uint32_t& nSize);
@@ -291,6 +295,8 @@ private:
 	bool m_bEnableTFTP;
 	TFTPFileServer* m_pTFTPFileServer;
 	uint8_t *m_pTFTPBuffer;
+	uint32_t m_nTFTPTransferBytes;
+	uint32_t m_nTFTPTransferMillis;
 	char m_aId[REMOTE_CONFIG_ID_LENGTH];
 	uint32_t m_nIdLength;
 	struct TRemoteConfigListBin m_tRemoteConfigListBin;
@@ -100,6 +100,12 @@ bool TFTPFileServer::FileCreate(const char* pFileName, TTFTPMode tMode) {
 		return false;
 	}
 
+	if (GetTransferSize() > m_nSize) {
+		DEBUG_PRINTF("GetTransferSize()=%u", GetTransferSize());
+		DEBUG_EXIT
+		return false;
+	}
+
 	printf("TFTP started ...\n");
 	Display::Get()->TextStatus("TFTP Started", DISPLAY_7SEGMENT_MSG_INFO_TFTP_STARTED);
 
@@ -127,9 +133,11 @@ int TFTPFileServer::FileRead(void* pBuffer, unsigned nCount, unsigned nBlockNumb
 }
 
 int TFTPFileServer::FileWrite(const void *pBuffer, unsigned nCount, unsigned nBlockNumber) {
-	DEBUG_PRINTF("pBuffer=%p, nCount=%d, nBlockNumber=%d (%d)", pBuffer, nCount, nBlockNumber, m_nSize / 512);
+	const uint32_t nBlockSize = GetBlockSize();
+
+	DEBUG_PRINTF("pBuffer=%p, nCount=%d, nBlockNumber=%d (%d)", pBuffer, nCount, nBlockNumber, m_nSize / nBlockSize);
 
-	if (nBlockNumber > (m_nSize / 512)) {
+	if (nBlockNumber > (m_nSize / nBlockSize)) {
 		m_nFileSize = 0;
 		return -1;
 	}
@@ -150,13 +158,13 @@ int TFTPFileServer::FileWrite(const void *pBuffer, unsigned nCount, unsigned nBl
 		// Temporarily code END
 	}
 
-	uint32_t nOffset = (nBlockNumber - 1) * 512;
+	const uint32_t nOffset = (nBlockNumber - 1) * nBlockSize;
 
 	assert((nOffset + nCount) <= m_nSize);
 
 	memcpy(&m_pBuffer[nOffset], pBuffer, nCount);
 
-	m_nFileSize += nCount; //FIXME BUG When in retry ?
+	m_nFileSize = nOffset + nCount;
 
 	return nCount;
 }
@@ -31,6 +31,8 @@
 #include "remoteconfig.h"
 
 #include "firmwareversion.h"
+#include "metrics.h"
+#include "profiler.h"
 
 #include "hardware.h"
 #include "network.h"
@@ -155,6 +157,14 @@ constexpr char sRequestUptime[] = "?uptime#";
 constexpr char sRequestVersion[] = "?version#";
 #define REQUEST_VERSION_LENGTH (sizeof(sRequestVersion) - 1)
 
+constexpr char sRequestMetrics[] = "?metrics#";
+#define REQUEST_METRICS_LENGTH (sizeof(sRequestMetrics) - 1)
+
+#if defined (ENABLE_PROFILER)
+constexpr char sRequestProfile[] = "?profile#";
+# define REQUEST_PROFILE_LENGTH (sizeof(sRequestProfile) - 1)
+#endif
+
 constexpr char sRequestStore[] = "?store#";
 #define REQUEST_STORE_LENGTH (sizeof(sRequestStore) - 1)
 
@@ -190,6 +200,8 @@ RemoteConfig::RemoteConfig(TRemoteConfig tRemoteConfig, TRemoteConfigMode tRemot
 	m_bEnableTFTP(false),
 	m_pTFTPFileServer(0),
 	m_pTFTPBuffer(0),
+	m_nTFTPTransferBytes(0),
+	m_nTFTPTransferMillis(0),
 	m_nIdLength(0),
 	m_nHandle(-1),
 	m_pUdpBuffer(0),
@@ -298,6 +310,12 @@ int RemoteConfig::Run(void) {
 			HandleVersion();
 		} else if (memcmp(m_pUdpBuffer, sRequestList, REQUEST_FILES_LENGTH) == 0) {
 			HandleList();
+		} else if ((m_nBytesReceived >= REQUEST_METRICS_LENGTH) && (memcmp(m_pUdpBuffer, sRequestMetrics, REQUEST_METRICS_LENGTH) == 0)) {
+			HandleMetrics();
+#if defined (ENABLE_PROFILER)
+		} else if ((m_nBytesReceived >= REQUEST_PROFILE_LENGTH) && (memcmp(m_pUdpBuffer, sRequestProfile, REQUEST_PROFILE_LENGTH) == 0)) {
+			HandleProfile();
+#endif
 		} else if ((m_nBytesReceived > REQUEST_GET_LENGTH) && (memcmp(m_pUdpBuffer, sRequestGet, REQUEST_GET_LENGTH) == 0)) {
 			HandleGet();
 		} else if ((m_nBytesReceived > REQUEST_STORE_LENGTH) && (memcmp(m_pUdpBuffer, sRequestStore, REQUEST_STORE_LENGTH) == 0)) {
@@ -378,6 +396,159 @@ void RemoteConfig::HandleVersion() {
 	DEBUG_EXIT
 }
 
+/*
+ * Text : one line per metric, "<name> c|g <value>" or
+ *        "<name> h <count> <sum> <bucket0> .. <bucket7>"
+ * bin  : uint16_t first index, uint16_t count, followed by the values as
+ *        uint32_t (histogram: count, sum and the buckets), in registration order
+ * A report larger than the UDP buffer is sent in more datagrams.
+ */
+void RemoteConfig::HandleMetrics(void) {
+	DEBUG_ENTRY
+
+	bool bIsBin = false;
+
+	if (m_nBytesReceived == REQUEST_METRICS_LENGTH + 3) {
+		if (memcmp(&m_pUdpBuffer[REQUEST_METRICS_LENGTH], "bin", 3) != 0) {
+			DEBUG_EXIT
+			return;
+		}
+		bIsBin = true;
+	} else if (m_nBytesReceived != REQUEST_METRICS_LENGTH) {
+		DEBUG_EXIT
+		return;
+	}
+
+	const struct metric *pMetric = metrics_get_first();
+
+	uint32_t nLength = 0;
+	uint16_t nFirst = 0;
+	uint16_t nCount = 0;
+	uint16_t nIndex = 0;
+
+	if (bIsBin) {
+		nLength = 2 * sizeof(uint16_t);
+	}
+
+	while (pMetric != 0) {
+		if (bIsBin) {
+			const uint32_t nWords = (pMetric->type == METRIC_TYPE_HISTOGRAM) ? (2 + METRIC_HISTOGRAM_BUCKETS) : 1;
+
+			if ((nLength + (nWords * sizeof(uint32_t))) > UDP_BUFFER_SIZE) {
+				memcpy(&m_pUdpBuffer[0], &nFirst, sizeof(uint16_t));
+				memcpy(&m_pUdpBuffer[sizeof(uint16_t)], &nCount, sizeof(uint16_t));
+				Network::Get()->SendTo(m_nHandle, m_pUdpBuffer, nLength, m_nIPAddressFrom, UDP_PORT);
+				nLength = 2 * sizeof(uint16_t);
+				nFirst = nIndex;
+				nCount = 0;
+			}
+
+			memcpy(&m_pUdpBuffer[nLength], &pMetric->value, sizeof(uint32_t));
+			nLength += sizeof(uint32_t);
+
+			if (pMetric->type == METRIC_TYPE_HISTOGRAM) {
+				memcpy(&m_pUdpBuffer[nLength], &pMetric->sum, sizeof(uint32_t));
+				nLength += sizeof(uint32_t);
+				memcpy(&m_pUdpBuffer[nLength], pMetric->buckets, sizeof(pMetric->buckets));
+				nLength += sizeof(pMetric->buckets);
+			}
+		} else {
+			char aLine[160];
+			uint32_t nLineLength;
+
+			if (pMetric->type == METRIC_TYPE_HISTOGRAM) {
+				const uint32_t *b = pMetric->buckets;
+				nLineLength = snprintf(aLine, sizeof(aLine), "%s h %u %u %u %u %u %u %u %u %u %u\n", pMetric->name,
+						static_cast<unsigned>(pMetric->value), static_cast<unsigned>(pMetric->sum),
+						static_cast<unsigned>(b[0]), static_cast<unsigned>(b[1]), static_cast<unsigned>(b[2]), static_cast<unsigned>(b[3]),
+						static_cast<unsigned>(b[4]), static_cast<unsigned>(b[5]), static_cast<unsigned>(b[6]), static_cast<unsigned>(b[7]));
+			} else {
+				nLineLength = snprintf(aLine, sizeof(aLine), "%s %c %u\n", pMetric->name, pMetric->type == METRIC_TYPE_COUNTER ? 'c' : 'g', static_cast<unsigned>(pMetric->value));
+			}
+
+			if (nLineLength >= sizeof(aLine)) {
+				nLineLength = sizeof(aLine) - 1;
+			}
+
+			if ((nLength + nLineLength) > UDP_BUFFER_SIZE) {
+				Network::Get()->SendTo(m_nHandle, m_pUdpBuffer, nLength, m_nIPAddressFrom, UDP_PORT);
+				nLength = 0;
+			}
+
+			memcpy(&m_pUdpBuffer[nLength], aLine, nLineLength);
+			nLength += nLineLength;
+		}
+
+		nCount++;
+		nIndex++;
+		pMetric = pMetric->next;
+	}
+
+	if (bIsBin) {
+		memcpy(&m_pUdpBuffer[0], &nFirst, sizeof(uint16_t));
+		memcpy(&m_pUdpBuffer[sizeof(uint16_t)], &nCount, sizeof(uint16_t));
+	}
+
+	if (nLength != 0) {
+		Network::Get()->SendTo(m_nHandle, m_pUdpBuffer, nLength, m_nIPAddressFrom, UDP_PORT);
+	}
+
+	DEBUG_EXIT
+}
+
+#if defined (ENABLE_PROFILER)
+/*
+ * ?profile#        report, one line per section (see profiler_format)
+ * ?profile#reset   clear all the sections
+ * ?profile#uart    print the report on the console
+ */
+void RemoteConfig::HandleProfile(void) {
+	DEBUG_ENTRY
+
+	if (m_nBytesReceived == REQUEST_PROFILE_LENGTH + 5) {
+		if (memcmp(&m_pUdpBuffer[REQUEST_PROFILE_LENGTH], "reset", 5) == 0) {
+			profiler_reset();
+		}
+		DEBUG_EXIT
+		return;
+	}
+
+	if (m_nBytesReceived == REQUEST_PROFILE_LENGTH + 4) {
+		if (memcmp(&m_pUdpBuffer[REQUEST_PROFILE_LENGTH], "uart", 4) == 0) {
+			profiler_dump();
+		}
+		DEBUG_EXIT
+		return;
+	}
+
+	if (m_nBytesReceived != REQUEST_PROFILE_LENGTH) {
+		DEBUG_EXIT
+		return;
+	}
+
+	uint32_t nLength = snprintf(m_pUdpBuffer, UDP_BUFFER_SIZE, "ticks/us %u\n", static_cast<unsigned>(profiler_get_ticks_per_us()));
+
+	for (const struct profiler_section *pSection = profiler_get_first(); pSection != 0; pSection = pSection->next) {
+		char aLine[160];
+		const uint32_t nLineLength = profiler_format(pSection, aLine, sizeof(aLine));
+
+		if ((nLength + nLineLength) > UDP_BUFFER_SIZE) {
+			Network::Get()->SendTo(m_nHandle, m_pUdpBuffer, nLength, m_nIPAddressFrom, UDP_PORT);
+			nLength = 0;
+		}
+
+		memcpy(&m_pUdpBuffer[nLength], aLine, nLineLength);
+		nLength += nLineLength;
+	}
+
+	if (nLength != 0) {
+		Network::Get()->SendTo(m_nHandle, m_pUdpBuffer, nLength, m_nIPAddressFrom, UDP_PORT);
+	}
+
+	DEBUG_EXIT
+}
+#endif
+
 void RemoteConfig::HandleList(void) {
 	DEBUG_ENTRY
 
@@ -1357,6 +1528,9 @@ void RemoteConfig::HandleTftpSet(void) {
 			}
 		}
 
+		m_nTFTPTransferBytes = m_pTFTPFileServer->GetTransferBytes();
+		m_nTFTPTransferMillis = m_pTFTPFileServer->GetTransferMillis();
+
 		printf("Delete TFTP Server\n");
 
 		delete m_pTFTPFileServer;
@@ -1384,6 +1558,18 @@ void RemoteConfig::HandleTftpGet(void) {
 		if (memcmp(&m_pUdpBuffer[GET_TFTP_LENGTH], "bin", 3) == 0) {
 			Network::Get()->SendTo(m_nHandle, &m_bEnableTFTP, sizeof(bool) , m_nIPAddressFrom, UDP_PORT);
 		}
+	} else if (m_nBytesReceived == GET_TFTP_LENGTH + 5) {
+		DEBUG_PUTS("Check for \'stats\' parameter");
+		if (memcmp(&m_pUdpBuffer[GET_TFTP_LENGTH], "stats", 5) == 0) {
+			if (m_pTFTPFileServer != 0) {
+				m_nTFTPTransferBytes = m_pTFTPFileServer->GetTransferBytes();
+				m_nTFTPTransferMillis = m_pTFTPFileServer->GetTransferMillis();
+			}
+
+			const uint32_t nKBps = m_nTFTPTransferMillis == 0 ? 0 : m_nTFTPTransferBytes / m_nTFTPTransferMillis;
+			const uint32_t nLength = snprintf(m_pUdpBuffer, UDP_BUFFER_SIZE - 1, "tftp:%u bytes, %u ms, %u kB/s\n", m_nTFTPTransferBytes, m_nTFTPTransferMillis, nKBps);
+			Network::Get()->SendTo(m_nHandle, m_pUdpBuffer, nLength, m_nIPAddressFrom, UDP_PORT);
+		}
 	}
 
 	DEBUG_EXIT
@@ -29,6 +29,8 @@
 #include <stdio.h>
 #include <stdbool.h>
 
+#include "filestream.h"
+
 #include "showfileprotocolhandler.h"
 #include "showfiledisplay.h"
 #include "showfiletftp.h"
@@ -145,7 +147,7 @@ protected:
 
 protected:
 	uint8_t m_nShowFileNumber;
-	FILE *m_pShowFile;
+	struct filestream *m_pShowFile;
 	ShowFileProtocolHandler *m_pShowFileProtocolHandler;
 	bool m_bDoLoop;
 	ShowFileDisplay *m_pShowFileDisplay;
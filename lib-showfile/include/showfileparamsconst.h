@@ -42,6 +42,8 @@ public:
 	static  const char PROTOCOL[];
 	static  const char SACN_SYNC_UNIVERSE[];
 	static  const char ARTNET_DISABLE_UNICAST[];
+
+	static  const char RECORDER_FILE_NAME[];
 };
 
 #endif /* SHOWFILEPARAMSCONST_H_ */
@@ -0,0 +1,102 @@
+/**
+ * @file showfilerecorder.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef SHOWFILERECORDER_H_
+#define SHOWFILERECORDER_H_
+
+/*
+ * Records the DMX output of a node into an OLA show file, the format played by OlaShowFile.
+ *
+ * The recorder is a LightSet and is fed from the ArtNetNode / E131Bridge output,
+ * typically chained with the real output. A frame is recorded only when its data differs
+ * from the last recorded frame of that port.
+ *
+ * The frames are timestamped in microseconds. The delay lines are in milliseconds,
+ * the remainder is carried to the next delay so the recording does not drift.
+ *
+ * SetData() only formats into a RAM ring buffer. The file is written from Run(),
+ * at most SHOWFILE_RECORDER_WRITE_SIZE bytes per call. When the ring buffer is full
+ * the frame is dropped and counted, the next change of that port is recorded again.
+ *
+ * The file is a filesink, with its own file object. Once per
+ * SHOWFILE_RECORDER_SYNC_MILLIS the written data is synced, on bare metal the
+ * recording then survives a power cycle.
+ */
+
+#include <stdint.h>
+
+#include "lightset.h"
+
+#define SHOWFILE_RECORDER_MAX_PORTS		4
+#define SHOWFILE_RECORDER_BUFFER_SIZE	(64 * 1024)	///< Must be a power of 2
+#define SHOWFILE_RECORDER_WRITE_SIZE	(8 * 512)
+#define SHOWFILE_RECORDER_SYNC_MILLIS	1000
+
+class ShowFileRecorder: public LightSet {
+public:
+	ShowFileRecorder(void);
+	~ShowFileRecorder(void);
+
+	bool Open(const char *pFileName);
+	void Close(void);
+
+	bool IsOpen(void) const {
+		return m_nFile >= 0;
+	}
+
+	void SetUniverse(uint8_t nPort, uint16_t nUniverse);
+
+	void Start(uint8_t nPort);
+	void Stop(uint8_t nPort);
+
+	void SetData(uint8_t nPort, const uint8_t *pData, uint16_t nLength);
+
+	void Run(void);
+
+	void Print(void);
+
+private:
+	bool Write(uint32_t nMax);
+	void Put(const char *pLine, uint32_t nLength);
+	uint32_t GetFree(void) const {
+		return SHOWFILE_RECORDER_BUFFER_SIZE - (m_nHead - m_nTail);
+	}
+
+private:
+	int m_nFile;					///< filesink index, -1 is closed
+	bool m_bIsWritten;				///< Written since the last sync
+	uint32_t m_nSyncMillis;
+	uint32_t m_nHead;				///< Free running, the ring buffer index is masked
+	uint32_t m_nTail;
+	uint32_t m_nBaseMicros;			///< Time of the last delay, the remainder is carried
+	uint32_t m_nPendingMillis;
+	uint32_t m_nFrames;
+	uint16_t m_nUniverse[SHOWFILE_RECORDER_MAX_PORTS];
+	uint16_t m_nLength[SHOWFILE_RECORDER_MAX_PORTS];
+	uint8_t m_Data[SHOWFILE_RECORDER_MAX_PORTS][512];
+	char m_Buffer[SHOWFILE_RECORDER_BUFFER_SIZE] __attribute__ ((aligned (4)));
+};
+
+#endif /* SHOWFILERECORDER_H_ */
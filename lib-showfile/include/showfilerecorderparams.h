@@ -0,0 +1,67 @@
+/**
+ * @file showfilerecorderparams.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef SHOWFILERECORDERPARAMS_H_
+#define SHOWFILERECORDERPARAMS_H_
+
+/*
+ * record.txt, when there is a valid show number the node records into that show file:
+ *
+ *  show=NN
+ */
+
+#include <stdint.h>
+
+#include "showfile.h"
+
+class ShowFileRecorderParams {
+public:
+	ShowFileRecorderParams(void);
+	~ShowFileRecorderParams(void);
+
+	bool Load(void);
+
+	void Dump(void);
+
+	bool IsRecord(void) const {
+		return m_bIsRecord;
+	}
+
+	const char *GetShowFileName(void) const {
+		return m_aShowFileName;
+	}
+
+public:
+    static void staticCallbackFunction(void *p, const char *s);
+
+private:
+    void callbackFunction(const char *s);
+
+private:
+	bool m_bIsRecord;
+	char m_aShowFileName[SHOWFILE_FILE_NAME_LENGTH + 1];
+};
+
+#endif /* SHOWFILERECORDERPARAMS_H_ */
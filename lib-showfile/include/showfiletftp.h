@@ -42,11 +42,20 @@ public:
 	bool FileClose(void);
 	int FileRead(void *pBuffer, unsigned nCount, unsigned nBlockNumber);
 	int FileWrite(const void *pBuffer, unsigned nCount, unsigned nBlockNumber);
+	bool FileSize(uint32_t &nFileSize);
 
 	void Exit(void);
 
+private:
+	bool Flush(void);
+
 private:
 	FILE *m_pFile;
+	/*
+	 * The TFTP blocks are collected and written in whole sectors
+	 */
+	uint8_t m_WriteBuffer[8 * 512] __attribute__ ((aligned (4)));
+	uint32_t m_nWriteBufferIndex;
 };
 
 #endif /* SHOWFILETFTP_H_ */
@@ -60,7 +60,7 @@ void OlaShowFile::ShowFileStart(void) {
 	m_nDelayMillis = 0;
 	m_nLastMillis = 0;
 
-	static_cast<void>(fseek(m_pShowFile, 0L, SEEK_SET));
+	static_cast<void>(filestream_seek(m_pShowFile, 0));
 
 	m_tState = STATE_IDLE;
 
@@ -99,7 +99,7 @@ void OlaShowFile::ShowFileRun(void) {
 			m_tState = STATE_TIME_WAITING;
 		} else if (m_tParseCode == PARSE_EOF) {
 			if (m_bDoLoop) {
-				static_cast<void>(fseek(m_pShowFile, 0L, SEEK_SET));
+				static_cast<void>(filestream_seek(m_pShowFile, 0));
 			} else {
 				SetShowFileStatus(SHOWFILE_STATUS_ENDED);
 			}
@@ -111,6 +111,9 @@ void OlaShowFile::ShowFileRun(void) {
 	if ((nMillis - m_nLastMillis) >= m_nDelayMillis) {
 		m_nLastMillis = nMillis;
 		m_tState = STATE_PARSING_DMX;
+	} else if (m_pShowFile != 0) {
+		// Waiting for the next frame, read ahead
+		static_cast<void>(filestream_prefetch(m_pShowFile));
 	}
 }
 
@@ -119,7 +122,7 @@ ParseCode OlaShowFile::ParseDmxData(const char *pLine) {
 	int64_t k = 0;
 	uint32_t nLength = 0;
 
-	while (isdigit(*p) == 1) {
+	while (isdigit(*p) != 0) {
 		k = k * 10 + *p - '0';
 
 		if (k > 255) {
@@ -131,7 +134,7 @@ ParseCode OlaShowFile::ParseDmxData(const char *pLine) {
 
 		if (*p == ',' || (isdigit(*p) == 0)) {
 
-			if (nLength > 512) {
+			if (nLength >= sizeof(m_DmxData)) {
 				DEBUG1_EXIT
 				return PARSE_FAILED;
 			}
@@ -153,7 +156,7 @@ enum ParseCode OlaShowFile::ParseLine(const char *pLine) {
 	char *p = const_cast<char *>(pLine);
 	int32_t k = 0;
 
-	while (isdigit(*p) == 1) {
+	while (isdigit(*p) != 0) {
 		k = k * 10 + *p - '0';
 		p++;
 	}
@@ -175,7 +178,7 @@ enum ParseCode OlaShowFile::ParseLine(const char *pLine) {
 
 ParseCode OlaShowFile::GetNextLine(void) {
 	if (m_pShowFile != NULL) {
-		if (fgets(s_buffer, (sizeof(s_buffer) - 1), m_pShowFile) != s_buffer) {
+		if (filestream_gets(s_buffer, (sizeof(s_buffer) - 1), m_pShowFile) != s_buffer) {
 			return PARSE_EOF;
 		}
 
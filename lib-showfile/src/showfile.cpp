@@ -65,8 +65,8 @@ void ShowFile::SetShowFile(uint8_t nShowFileNumber) {
 		ShowFileStop();
 
 		if (m_pShowFile != 0) {
-			if (fclose(m_pShowFile) != 0) {
-				perror("fclose(m_pShowFile)");
+			if (filestream_close(m_pShowFile) != 0) {
+				perror("filestream_close(m_pShowFile)");
 			}
 			m_pShowFile = 0;
 		}
@@ -77,7 +77,7 @@ void ShowFile::SetShowFile(uint8_t nShowFileNumber) {
 
 		DEBUG_PRINTF("m_aShowFileName=[%s]", m_aShowFileName);
 
-		m_pShowFile = fopen(m_aShowFileName, "r");
+		m_pShowFile = filestream_open(m_aShowFileName);
 
 		if (m_pShowFile == 0) {
 			perror(const_cast<char *>(m_aShowFileName));
@@ -132,8 +132,8 @@ void ShowFile::EnableTFTP(bool bEnableTFTP) {
 		Stop();
 
 		if (m_pShowFile != 0) {
-			if (fclose(m_pShowFile) != 0) {
-				perror("fclose(m_pShowFile)");
+			if (filestream_close(m_pShowFile) != 0) {
+				perror("filestream_close(m_pShowFile)");
 			}
 			m_pShowFile = 0;
 		}
@@ -33,7 +33,7 @@
 #include "showfileconst.h"
 #include "showfile.h"
 
-#include "oscmessage.h"
+#include "oscsimplemessage.h"
 #include "oscsend.h"
 
 #include "network.h"
@@ -159,7 +159,7 @@ void ShowFileOSC::Run(void) {
 		}
 
 		if (memcmp(&m_pBuffer[PATH_LENGTH], aShow, SHOW_LENGTH) == 0) {
-			OSCMessage Msg(m_pBuffer, nBytesReceived);
+			OSCSimpleMessage Msg(reinterpret_cast<const uint8_t*>(m_pBuffer), nBytesReceived);
 
 			const int nValue = Msg.GetInt(0);
 
@@ -173,7 +173,7 @@ void ShowFileOSC::Run(void) {
 		}
 
 		if (memcmp(&m_pBuffer[PATH_LENGTH], aLoop, LOOP_LENGTH) == 0) {
-			OSCMessage Msg(m_pBuffer, nBytesReceived);
+			OSCSimpleMessage Msg(reinterpret_cast<const uint8_t*>(m_pBuffer), nBytesReceived);
 
 			const int nValue = Msg.GetInt(0);
 
@@ -193,7 +193,7 @@ void ShowFileOSC::Run(void) {
 		}
 
 		if (memcmp(&m_pBuffer[PATH_LENGTH], aMaster, MASTER_LENGTH) == 0) {
-			OSCMessage Msg(m_pBuffer, nBytesReceived);
+			OSCSimpleMessage Msg(reinterpret_cast<const uint8_t*>(m_pBuffer), nBytesReceived);
 
 			int nValue;
 
@@ -214,7 +214,7 @@ void ShowFileOSC::Run(void) {
 		}
 
 		if (memcmp(&m_pBuffer[PATH_LENGTH], aTftp, TFTP_LENGTH) == 0) {
-			OSCMessage Msg(m_pBuffer, nBytesReceived);
+			OSCSimpleMessage Msg(reinterpret_cast<const uint8_t*>(m_pBuffer), nBytesReceived);
 
 			const int nValue = Msg.GetInt(0);
 
@@ -227,7 +227,7 @@ void ShowFileOSC::Run(void) {
 
 
 		if (memcmp(&m_pBuffer[PATH_LENGTH], aDelete, DELETE_LENGTH) == 0) {
-			OSCMessage Msg(m_pBuffer, nBytesReceived);
+			OSCSimpleMessage Msg(reinterpret_cast<const uint8_t*>(m_pBuffer), nBytesReceived);
 
 			int nValue = 255;
 
@@ -268,7 +268,7 @@ void ShowFileOSC::Run(void) {
 
 		// TouchOSC
 		if (memcmp(&m_pBuffer[PATH_LENGTH], aIndex, INDEX_LENGTH) == 0) {
-			OSCMessage Msg(m_pBuffer, nBytesReceived);
+			OSCSimpleMessage Msg(reinterpret_cast<const uint8_t*>(m_pBuffer), nBytesReceived);
 
 			if (Msg.GetType(0) != OSC_FLOAT){
 				return;
@@ -0,0 +1,305 @@
+/**
+ * @file showfilerecorder.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "showfilerecorder.h"
+
+#include "filesink.h"
+
+#include "hardware.h"
+#include "metrics.h"
+
+#include "debug.h"
+
+#if (SHOWFILE_RECORDER_BUFFER_SIZE & (SHOWFILE_RECORDER_BUFFER_SIZE - 1)) != 0
+ #error SHOWFILE_RECORDER_BUFFER_SIZE must be a power of 2
+#endif
+
+#define BUFFER_INDEX_MASK	(SHOWFILE_RECORDER_BUFFER_SIZE - 1)
+
+static struct metric s_MetricFrames = METRIC_COUNTER("showfile.record.frames");
+static struct metric s_MetricOverruns = METRIC_COUNTER("showfile.record.overruns");
+static struct metric s_MetricErrors = METRIC_COUNTER("showfile.record.errors");
+
+/*
+ * A delay line and a frame line with 512 slots "255,"
+ */
+static char s_Line[16 + 8 + (512 * 4)];
+
+static char *itoa_base10(char *p, uint32_t n) {
+	char buffer[10];
+	uint32_t i = 0;
+
+	do {
+		buffer[i++] = static_cast<char>('0' + (n % 10));
+		n /= 10;
+	} while (n != 0);
+
+	while (i != 0) {
+		*p++ = buffer[--i];
+	}
+
+	return p;
+}
+
+ShowFileRecorder::ShowFileRecorder(void):
+	m_nFile(-1),
+	m_bIsWritten(false),
+	m_nSyncMillis(0),
+	m_nHead(0),
+	m_nTail(0),
+	m_nBaseMicros(0),
+	m_nPendingMillis(0),
+	m_nFrames(0)
+{
+	DEBUG_ENTRY
+
+	for (uint32_t i = 0; i < SHOWFILE_RECORDER_MAX_PORTS; i++) {
+		m_nUniverse[i] = static_cast<uint16_t>(i);
+		m_nLength[i] = 0;
+	}
+
+	metrics_register(&s_MetricFrames);
+	metrics_register(&s_MetricOverruns);
+	metrics_register(&s_MetricErrors);
+
+	DEBUG_EXIT
+}
+
+ShowFileRecorder::~ShowFileRecorder(void) {
+	DEBUG_ENTRY
+
+	Close();
+
+	DEBUG_EXIT
+}
+
+bool ShowFileRecorder::Open(const char *pFileName) {
+	DEBUG_ENTRY
+	assert(pFileName != 0);
+
+	Close();
+
+	m_nFile = filesink_open(pFileName);
+
+	if (m_nFile < 0) {
+		perror(pFileName);
+		DEBUG_EXIT
+		return false;
+	}
+
+	m_nHead = 0;
+	m_nTail = 0;
+	m_nPendingMillis = 0;
+	m_nFrames = 0;
+	m_bIsWritten = false;
+	m_nSyncMillis = Hardware::Get()->Millis();
+
+	for (uint32_t i = 0; i < SHOWFILE_RECORDER_MAX_PORTS; i++) {
+		m_nLength[i] = 0;
+	}
+
+	DEBUG_PRINTF("%s", pFileName);
+	DEBUG_EXIT
+	return true;
+}
+
+void ShowFileRecorder::Close(void) {
+	DEBUG_ENTRY
+
+	if (m_nFile >= 0) {
+		while ((m_nHead != m_nTail) && Write(SHOWFILE_RECORDER_BUFFER_SIZE))
+			;
+
+		if (filesink_close(m_nFile) != 0) {
+			metric_inc(&s_MetricErrors);
+		}
+
+		m_nFile = -1;
+	}
+
+	DEBUG_EXIT
+}
+
+void ShowFileRecorder::SetUniverse(uint8_t nPort, uint16_t nUniverse) {
+	assert(nPort < SHOWFILE_RECORDER_MAX_PORTS);
+
+	m_nUniverse[nPort] = nUniverse;
+}
+
+void ShowFileRecorder::Start(uint8_t nPort) {
+	DEBUG_PRINTF("nPort=%u", nPort);
+}
+
+void ShowFileRecorder::Stop(uint8_t nPort) {
+	DEBUG_PRINTF("nPort=%u", nPort);
+}
+
+void ShowFileRecorder::SetData(uint8_t nPort, const uint8_t *pData, uint16_t nLength) {
+	assert(pData != 0);
+
+	if ((m_nFile < 0) || (nPort >= SHOWFILE_RECORDER_MAX_PORTS) || (nLength == 0)) {
+		return;
+	}
+
+	const uint32_t nMicros = Hardware::Get()->Micros();
+
+	if (nLength > 512) {
+		nLength = 512;
+	}
+
+	if ((nLength == m_nLength[nPort]) && (memcmp(m_Data[nPort], pData, nLength) == 0)) {
+		return;
+	}
+
+	char *p = s_Line;
+	uint32_t nMillis = 0;
+
+	// OLA show files alternate frame and delay lines, frames closer than 1 ms get a delay of 0
+	if (m_nFrames != 0) {
+		nMillis = (nMicros - m_nBaseMicros) / 1000;
+		p = itoa_base10(p, m_nPendingMillis + nMillis);
+		*p++ = '\n';
+	}
+
+	p = itoa_base10(p, m_nUniverse[nPort]);
+	*p++ = ' ';
+
+	for (uint32_t i = 0; i < nLength; i++) {
+		p = itoa_base10(p, pData[i]);
+		*p++ = ',';
+	}
+
+	p[-1] = '\n';
+
+	const uint32_t nLineLength = static_cast<uint32_t>(p - s_Line);
+
+	assert(nLineLength <= sizeof(s_Line));
+
+	if (nLineLength > GetFree()) {
+		// The time is not consumed, the next recorded frame gets the full delay
+		metric_inc(&s_MetricOverruns);
+		return;
+	}
+
+	Put(s_Line, nLineLength);
+
+	if (m_nFrames != 0) {
+		m_nBaseMicros += nMillis * 1000;
+		m_nPendingMillis = 0;
+	} else {
+		m_nBaseMicros = nMicros;
+	}
+
+	memcpy(m_Data[nPort], pData, nLength);
+	m_nLength[nPort] = nLength;
+
+	m_nFrames++;
+	metric_inc(&s_MetricFrames);
+}
+
+void ShowFileRecorder::Run(void) {
+	if (m_nFile < 0) {
+		return;
+	}
+
+	// Move whole seconds into the pending delay, so that the microseconds cannot wrap between frames
+	if (m_nFrames != 0) {
+		const uint32_t nElapsed = Hardware::Get()->Micros() - m_nBaseMicros;
+
+		if (nElapsed >= 1000000) {
+			const uint32_t nMillis = nElapsed / 1000;
+			m_nPendingMillis += nMillis;
+			m_nBaseMicros += nMillis * 1000;
+		}
+	}
+
+	Write(SHOWFILE_RECORDER_WRITE_SIZE);
+
+	const uint32_t nMillis = Hardware::Get()->Millis();
+
+	if (m_bIsWritten && ((nMillis - m_nSyncMillis) >= SHOWFILE_RECORDER_SYNC_MILLIS)) {
+		if (filesink_sync(m_nFile) != 0) {
+			metric_inc(&s_MetricErrors);
+		}
+
+		m_bIsWritten = false;
+		m_nSyncMillis = nMillis;
+	}
+}
+
+void ShowFileRecorder::Put(const char *pLine, uint32_t nLength) {
+	const uint32_t nIndex = m_nHead & BUFFER_INDEX_MASK;
+	const uint32_t nFirst = (nLength < (SHOWFILE_RECORDER_BUFFER_SIZE - nIndex)) ? nLength : (SHOWFILE_RECORDER_BUFFER_SIZE - nIndex);
+
+	memcpy(&m_Buffer[nIndex], pLine, nFirst);
+	memcpy(m_Buffer, &pLine[nFirst], nLength - nFirst);
+
+	m_nHead += nLength;
+}
+
+/*
+ * Writes one contiguous part of the ring buffer, at most nMax bytes
+ */
+bool ShowFileRecorder::Write(uint32_t nMax) {
+	const uint32_t nIndex = m_nTail & BUFFER_INDEX_MASK;
+	uint32_t nLength = m_nHead - m_nTail;
+
+	if (nLength == 0) {
+		return true;
+	}
+
+	if (nLength > (SHOWFILE_RECORDER_BUFFER_SIZE - nIndex)) {
+		nLength = SHOWFILE_RECORDER_BUFFER_SIZE - nIndex;
+	}
+
+	if (nLength > nMax) {
+		nLength = nMax;
+	}
+
+	const int32_t nWritten = filesink_write(m_nFile, &m_Buffer[nIndex], nLength);
+
+	// A failed write is not retried, otherwise the buffer stays full
+	m_nTail += nLength;
+	m_bIsWritten = true;
+
+	if (nWritten != static_cast<int32_t>(nLength)) {
+		metric_inc(&s_MetricErrors);
+		return false;
+	}
+
+	return true;
+}
+
+void ShowFileRecorder::Print(void) {
+	printf("Show file recorder\n");
+	printf(" Frames   : %u\n", m_nFrames);
+	printf(" Overruns : %u\n", s_MetricOverruns.value);
+	printf(" Buffered : %u\n", m_nHead - m_nTail);
+}
@@ -0,0 +1,87 @@
+/**
+ * @file showfilerecorderparams.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#if !defined(__clang__)	// Needed for compiling on MacOS
+ #pragma GCC push_options
+ #pragma GCC optimize ("Os")
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <assert.h>
+
+#include "showfilerecorderparams.h"
+#include "showfileparamsconst.h"
+#include "showfile.h"
+
+#include "readconfigfile.h"
+#include "sscan.h"
+
+ShowFileRecorderParams::ShowFileRecorderParams(void): m_bIsRecord(false) {
+	m_aShowFileName[0] = '\0';
+}
+
+ShowFileRecorderParams::~ShowFileRecorderParams(void) {
+}
+
+bool ShowFileRecorderParams::Load(void) {
+	m_bIsRecord = false;
+
+	ReadConfigFile configfile(ShowFileRecorderParams::staticCallbackFunction, this);
+
+	if (!configfile.Read(ShowFileParamsConst::RECORDER_FILE_NAME)) {
+		return false;
+	}
+
+	return m_bIsRecord;
+}
+
+void ShowFileRecorderParams::callbackFunction(const char *pLine) {
+	assert(pLine != 0);
+
+	uint8_t nValue8;
+
+	if (Sscan::Uint8(pLine, ShowFileParamsConst::SHOW, &nValue8) == SSCAN_OK) {
+		m_bIsRecord = ShowFile::ShowFileNameCopyTo(m_aShowFileName, sizeof(m_aShowFileName), nValue8);
+		return;
+	}
+}
+
+void ShowFileRecorderParams::Dump(void) {
+#ifndef NDEBUG
+	printf("%s::%s \'%s\':\n", __FILE__, __FUNCTION__, ShowFileParamsConst::RECORDER_FILE_NAME);
+
+	if (m_bIsRecord) {
+		printf(" %s [%s]\n", ShowFileParamsConst::SHOW, m_aShowFileName);
+	}
+#endif
+}
+
+void ShowFileRecorderParams::staticCallbackFunction(void *p, const char *s) {
+	assert(p != 0);
+	assert(s != 0);
+
+	(static_cast<ShowFileRecorderParams *>(p))->callbackFunction(s);
+}
@@ -25,13 +25,14 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "showfiletftp.h"
 #include "showfile.h"
 
 #include "debug.h"
 
-ShowFileTFTP::ShowFileTFTP(void): m_pFile(0) {
+ShowFileTFTP::ShowFileTFTP(void): m_pFile(0), m_nWriteBufferIndex(0) {
 	DEBUG_ENTRY
 
 	DEBUG_EXIT
@@ -73,6 +74,7 @@ bool ShowFileTFTP::FileCreate(const char *pFileName, TTFTPMode tMode) {
 		return false;
 	}
 
+	m_nWriteBufferIndex = 0;
 	m_pFile = fopen(pFileName, "w+");
 	return (m_pFile != 0);
 }
@@ -80,13 +82,20 @@ bool ShowFileTFTP::FileCreate(const char *pFileName, TTFTPMode tMode) {
 bool ShowFileTFTP::FileClose(void) {
 	DEBUG_ENTRY
 
+	bool bSucces = true;
+
 	if (m_pFile != 0) {
-		fclose(m_pFile);
+		bSucces = Flush();
+
+		if (fclose(m_pFile) != 0) {
+			bSucces = false;
+		}
+
 		m_pFile = 0;
 	}
 
 	DEBUG_EXIT
-	return true;
+	return bSucces;
 }
 
 int ShowFileTFTP::FileRead(void *pBuffer, unsigned nCount, unsigned nBlockNumber) {
@@ -94,5 +103,48 @@ int ShowFileTFTP::FileRead(void *pBuffer, unsigned nCount, unsigned nBlockNumber
 }
 
 int ShowFileTFTP::FileWrite(const void *pBuffer, unsigned nCount, unsigned nBlockNumber) {
-	return fwrite(pBuffer, 1, nCount, m_pFile);
+	const uint8_t *pSrc = reinterpret_cast<const uint8_t *>(pBuffer);
+	unsigned nRemaining = nCount;
+
+	while (nRemaining != 0) {
+		const uint32_t nFree = sizeof(m_WriteBuffer) - m_nWriteBufferIndex;
+		const uint32_t nLength = nRemaining < nFree ? nRemaining : nFree;
+
+		memcpy(&m_WriteBuffer[m_nWriteBufferIndex], pSrc, nLength);
+
+		m_nWriteBufferIndex += nLength;
+		pSrc += nLength;
+		nRemaining -= nLength;
+
+		if ((m_nWriteBufferIndex == sizeof(m_WriteBuffer)) && !Flush()) {
+			return -1;
+		}
+	}
+
+	return nCount;
+}
+
+bool ShowFileTFTP::FileSize(uint32_t &nFileSize) {
+	if ((m_pFile == 0) || (fseek(m_pFile, 0, SEEK_END) != 0)) {
+		return false;
+	}
+
+	nFileSize = ftell(m_pFile);
+
+	return (fseek(m_pFile, 0, SEEK_SET) == 0);
+}
+
+bool ShowFileTFTP::Flush(void) {
+	DEBUG_PRINTF("m_nWriteBufferIndex=%u", m_nWriteBufferIndex);
+
+	if (m_nWriteBufferIndex == 0) {
+		return true;
+	}
+
+	const size_t nWritten = fwrite(m_WriteBuffer, 1, m_nWriteBufferIndex, m_pFile);
+	const bool bSucces = (nWritten == m_nWriteBufferIndex);
+
+	m_nWriteBufferIndex = 0;
+
+	return bSucces;
 }
@@ -6,7 +6,7 @@
  * https://wiki.openlighting.org/index.php/USB_Protocol_Extensions
  *
  */
-/* Copyright (C) 2015-2019 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2015-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -46,7 +46,10 @@ typedef enum {
 	SEND_RDM_DISCOVERY_REQUEST = 11,			///< Send RDM Discovery Request
 	RDM_TIMEOUT = 12,							///< https://github.com/OpenLightingProject/ola/blob/master/plugins/usbpro/EnttecUsbProWidget.cpp#L353
 	MANUFACTURER_LABEL = 77,					///< https://wiki.openlighting.org/index.php/USB_Protocol_Extensions
-	GET_WIDGET_NAME_LABEL = 78					///< https://wiki.openlighting.org/index.php/USB_Protocol_Extensions
+	GET_WIDGET_NAME_LABEL = 78,					///< https://wiki.openlighting.org/index.php/USB_Protocol_Extensions
+	STREAM_MODE = 90,							///< Stream Mode Request / Reply, \ref widget_stream.h
+	STREAM_BATCH = 91,							///< Stream Records, sent when the stream mode is on
+	STREAM_STATISTICS = 92						///< Stream Statistics Request / Reply
 } _widget_codes;
 
 typedef enum {
@@ -66,6 +69,21 @@ typedef enum {
 	MODE_RDM_SNIFFER = 3						///< RDM Sniffer firmware enabled.
 } _widget_mode;
 
+typedef enum {
+	STREAM_MODE_OFF = 0,						///< Classic messages (default)
+	STREAM_MODE_ON = 1							///< Received DMX and sniffer data are sent as \ref STREAM_BATCH
+} _widget_stream_mode;
+
+struct _widget_stream_statistics {
+	uint32_t records;							///< Records sent
+	uint32_t dmx_frames;						///< Full DMX frames
+	uint32_t dmx_deltas;						///< DMX frames sent as delta
+	uint32_t rdm_packets;
+	uint32_t batches;
+	uint32_t records_dropped;					///< Records that did not fit in the transmit buffer
+	uint32_t messages_dropped;					///< Classic DMX and sniffer messages that did not fit in the transmit buffer
+};
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -77,8 +95,16 @@ extern void widget_set_mode(_widget_mode);
 extern uint32_t widget_get_received_dmx_packet_period(void);
 extern void widget_set_received_dmx_packet_period(uint32_t);
 extern uint32_t widget_get_received_dmx_packet_count(void);
+// stream
+extern _widget_stream_mode widget_stream_get_mode(void);
+extern void widget_stream_set_mode(_widget_stream_mode);
+extern void widget_stream_dmx(const uint8_t *, uint16_t, uint32_t);
+extern void widget_stream_rdm(const uint8_t *, uint16_t, uint32_t);
+extern void widget_stream_send_batch(void);
+extern void widget_stream_get_statistics(struct _widget_stream_statistics *);
 // poll table
 extern void widget_receive_data_from_host(void);
+extern void widget_send_data_to_host(void);
 extern void widget_received_dmx_packet(void);
 extern void widget_received_dmx_change_of_state_packet(void);
 extern void widget_received_rdm_packet(void);
@@ -0,0 +1,311 @@
+/**
+ * @file widget_stream.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef WIDGET_STREAM_H_
+#define WIDGET_STREAM_H_
+
+/*
+ * Stream records, a protocol extension of the DMX USB Pro Widget (labels
+ * \ref STREAM_MODE, \ref STREAM_BATCH and \ref STREAM_STATISTICS in widget.h).
+ * This file is shared by the widget firmware and the host, the encoder and
+ * decoder have no hardware dependency.
+ *
+ * A batch message holds the records queued while the USB link was busy:
+ *
+ *   dropped (2, LE) | record | record | ...
+ *
+ * dropped is the number of records that did not fit in the transmit buffer
+ * since the previous batch. A record is:
+ *
+ *   type (1) | sequence (1) | timestamp (4, LE) | length (2, LE) | body (length)
+ *
+ * The timestamp is in microseconds (free running, wraps). The sequence is
+ * incremented for every record sent, a dropped record does not use a sequence
+ * number. A gap in the sequence therefore means that a batch was lost on the
+ * link, the decoder then waits for the next full frame.
+ *
+ * A DMX frame is sent as a full frame or as a delta against the previous frame
+ * sent. The delta body is a list of runs:
+ *
+ *   offset (2, LE) | count (1) | slots (count)
+ *
+ * Short gaps between changed slots are included in the run, a new run costs
+ * WIDGET_STREAM_RUN_HEADER_SIZE bytes. A full frame is sent when the slot
+ * count changes, when the delta is not smaller, and after
+ * WIDGET_STREAM_KEY_INTERVAL deltas.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#define WIDGET_STREAM_VERSION				1
+
+#define WIDGET_STREAM_DMX_SIZE				513		///< Start code + 512 slots
+#define WIDGET_STREAM_BATCH_HEADER_SIZE		2		///< dropped (2, LE)
+#define WIDGET_STREAM_RECORD_HEADER_SIZE	8		///< type (1) | sequence (1) | timestamp (4, LE) | length (2, LE)
+#define WIDGET_STREAM_RUN_HEADER_SIZE		3		///< offset (2, LE) | count (1)
+#define WIDGET_STREAM_RUN_MAX				255
+#define WIDGET_STREAM_KEY_INTERVAL			32
+
+typedef enum widget_stream_record {
+	WIDGET_STREAM_RECORD_DMX = 0,			///< Full DMX frame, start code included
+	WIDGET_STREAM_RECORD_DMX_DELTA = 1,		///< Runs against the previous DMX frame
+	WIDGET_STREAM_RECORD_RDM = 2			///< RDM packet as received, start code included
+} _widget_stream_record;
+
+typedef enum widget_stream_error {
+	WIDGET_STREAM_ERROR_LENGTH = -1,		///< The record does not fit in the data
+	WIDGET_STREAM_ERROR_FORMAT = -2,		///< Unknown type, or a run outside of the frame
+	WIDGET_STREAM_ERROR_NO_FRAME = -3		///< A delta without a valid previous frame
+} _widget_stream_error;
+
+struct widget_stream_encoder {
+	uint8_t frame[WIDGET_STREAM_DMX_SIZE];	///< The last DMX frame sent
+	uint16_t frame_length;					///< 0 when the next DMX frame must be a full frame
+	uint8_t sequence;
+	uint8_t deltas;							///< Deltas since the last full frame
+};
+
+struct widget_stream_decoder {
+	uint8_t frame[WIDGET_STREAM_DMX_SIZE];	///< The last DMX frame received
+	uint16_t frame_length;					///< 0 until a full frame is received
+	uint8_t sequence;						///< Expected sequence
+	uint32_t lost;							///< Records lost on the link
+};
+
+struct widget_stream_record_info {
+	_widget_stream_record type;
+	uint8_t sequence;
+	uint32_t timestamp;
+	const uint8_t *body;
+	uint16_t body_length;
+};
+
+inline static void widget_stream_encoder_init(struct widget_stream_encoder *encoder) {
+	encoder->frame_length = 0;
+	encoder->sequence = 0;
+	encoder->deltas = 0;
+}
+
+inline static void widget_stream_decoder_init(struct widget_stream_decoder *decoder) {
+	decoder->frame_length = 0;
+	decoder->sequence = 0;
+	decoder->lost = 0;
+}
+
+inline static void widget_stream_record_header(uint8_t *out, _widget_stream_record type, uint8_t sequence, uint32_t timestamp, uint16_t length) {
+	out[0] = (uint8_t) type;
+	out[1] = sequence;
+	out[2] = (uint8_t) timestamp;
+	out[3] = (uint8_t) (timestamp >> 8);
+	out[4] = (uint8_t) (timestamp >> 16);
+	out[5] = (uint8_t) (timestamp >> 24);
+	out[6] = (uint8_t) length;
+	out[7] = (uint8_t) (length >> 8);
+}
+
+/**
+ * Write the delta runs of data against the previous frame. The frames have the same length.
+ *
+ * @return the body length, or 0xFFFF when the body does not fit in size
+ */
+inline static uint16_t widget_stream_encode_delta(const uint8_t *previous, const uint8_t *data, uint16_t length, uint8_t *out, uint16_t size) {
+	uint16_t out_length = 0;
+	uint16_t i = 0;
+
+	while (i < length) {
+		uint16_t start;
+		uint16_t end;
+		uint16_t j;
+
+		if (data[i] == previous[i]) {
+			i++;
+			continue;
+		}
+
+		start = i;
+		end = (uint16_t) (i + 1);
+
+		for (j = end; (j < length) && ((j - start) < WIDGET_STREAM_RUN_MAX) && ((j - end) < WIDGET_STREAM_RUN_HEADER_SIZE); j++) {
+			if (data[j] != previous[j]) {
+				end = (uint16_t) (j + 1);
+			}
+		}
+
+		if ((uint32_t) out_length + WIDGET_STREAM_RUN_HEADER_SIZE + (end - start) > size) {
+			return 0xFFFF;
+		}
+
+		out[out_length++] = (uint8_t) start;
+		out[out_length++] = (uint8_t) (start >> 8);
+		out[out_length++] = (uint8_t) (end - start);
+
+		memcpy(&out[out_length], &data[start], (size_t) (end - start));
+		out_length = (uint16_t) (out_length + (end - start));
+
+		i = end;
+	}
+
+	return out_length;
+}
+
+/**
+ * Encode a DMX frame (start code included) as a full frame or as a delta.
+ * The encoder is only updated when the record fits.
+ *
+ * @return the record length, or 0 when the record does not fit in size
+ */
+inline static uint16_t widget_stream_encode_dmx(struct widget_stream_encoder *encoder, uint8_t *out, uint16_t size, const uint8_t *data, uint16_t length, uint32_t timestamp) {
+	_widget_stream_record type = WIDGET_STREAM_RECORD_DMX_DELTA;
+	uint16_t body_length = 0xFFFF;
+
+	if (length > WIDGET_STREAM_DMX_SIZE) {
+		length = WIDGET_STREAM_DMX_SIZE;
+	}
+
+	if (size < WIDGET_STREAM_RECORD_HEADER_SIZE) {
+		return 0;
+	}
+
+	if ((encoder->frame_length != 0) && (length == encoder->frame_length) && (encoder->deltas < WIDGET_STREAM_KEY_INTERVAL)) {
+		const uint16_t available = (uint16_t) (size - WIDGET_STREAM_RECORD_HEADER_SIZE);
+		// A delta that is not smaller than the full frame is not used
+		const uint16_t limit = (available < length) ? available : (uint16_t) (length - 1);
+
+		body_length = widget_stream_encode_delta(encoder->frame, data, length, &out[WIDGET_STREAM_RECORD_HEADER_SIZE], limit);
+	}
+
+	if (body_length == 0xFFFF) {
+		if ((uint32_t) WIDGET_STREAM_RECORD_HEADER_SIZE + length > size) {
+			return 0;
+		}
+
+		type = WIDGET_STREAM_RECORD_DMX;
+		body_length = length;
+		memcpy(&out[WIDGET_STREAM_RECORD_HEADER_SIZE], data, length);
+
+		encoder->deltas = 0;
+	} else {
+		encoder->deltas++;
+	}
+
+	memcpy(encoder->frame, data, length);
+	encoder->frame_length = length;
+
+	widget_stream_record_header(out, type, encoder->sequence++, timestamp, body_length);
+
+	return (uint16_t) (WIDGET_STREAM_RECORD_HEADER_SIZE + body_length);
+}
+
+/**
+ * Encode an RDM packet (start code included).
+ *
+ * @return the record length, or 0 when the record does not fit in size
+ */
+inline static uint16_t widget_stream_encode_rdm(struct widget_stream_encoder *encoder, uint8_t *out, uint16_t size, const uint8_t *data, uint16_t length, uint32_t timestamp) {
+	if ((uint32_t) WIDGET_STREAM_RECORD_HEADER_SIZE + length > size) {
+		return 0;
+	}
+
+	widget_stream_record_header(out, WIDGET_STREAM_RECORD_RDM, encoder->sequence++, timestamp, length);
+	memcpy(&out[WIDGET_STREAM_RECORD_HEADER_SIZE], data, length);
+
+	return (uint16_t) (WIDGET_STREAM_RECORD_HEADER_SIZE + length);
+}
+
+/**
+ * Decode the record at the start of data. For a DMX record the frame is in decoder->frame.
+ *
+ * @return the record length, or a negative _widget_stream_error
+ */
+inline static int32_t widget_stream_decode(struct widget_stream_decoder *decoder, const uint8_t *data, uint16_t length, struct widget_stream_record_info *info) {
+	uint16_t i;
+
+	if (length < WIDGET_STREAM_RECORD_HEADER_SIZE) {
+		return WIDGET_STREAM_ERROR_LENGTH;
+	}
+
+	info->type = (_widget_stream_record) data[0];
+	info->sequence = data[1];
+	info->timestamp = (uint32_t) data[2] | ((uint32_t) data[3] << 8) | ((uint32_t) data[4] << 16) | ((uint32_t) data[5] << 24);
+	info->body_length = (uint16_t) (data[6] | (data[7] << 8));
+	info->body = &data[WIDGET_STREAM_RECORD_HEADER_SIZE];
+
+	if ((uint32_t) WIDGET_STREAM_RECORD_HEADER_SIZE + info->body_length > length) {
+		return WIDGET_STREAM_ERROR_LENGTH;
+	}
+
+	if (info->sequence != decoder->sequence) {
+		decoder->lost += (uint8_t) (info->sequence - decoder->sequence);
+		decoder->frame_length = 0;
+	}
+
+	decoder->sequence = (uint8_t) (info->sequence + 1);
+
+	switch (info->type) {
+	case WIDGET_STREAM_RECORD_DMX:
+		if (info->body_length > WIDGET_STREAM_DMX_SIZE) {
+			decoder->frame_length = 0;
+			return WIDGET_STREAM_ERROR_FORMAT;
+		}
+		memcpy(decoder->frame, info->body, info->body_length);
+		decoder->frame_length = info->body_length;
+		break;
+	case WIDGET_STREAM_RECORD_DMX_DELTA:
+		if (decoder->frame_length == 0) {
+			return WIDGET_STREAM_ERROR_NO_FRAME;
+		}
+		for (i = 0; i < info->body_length;) {
+			uint16_t offset;
+			uint8_t count;
+
+			if (info->body_length - i < WIDGET_STREAM_RUN_HEADER_SIZE) {
+				decoder->frame_length = 0;
+				return WIDGET_STREAM_ERROR_FORMAT;
+			}
+
+			offset = (uint16_t) (info->body[i] | (info->body[i + 1] << 8));
+			count = info->body[i + 2];
+			i = (uint16_t) (i + WIDGET_STREAM_RUN_HEADER_SIZE);
+
+			if (((uint32_t) offset + count > decoder->frame_length) || ((uint32_t) i + count > info->body_length)) {
+				decoder->frame_length = 0;
+				return WIDGET_STREAM_ERROR_FORMAT;
+			}
+
+			memcpy(&decoder->frame[offset], &info->body[i], count);
+			i = (uint16_t) (i + count);
+		}
+		break;
+	case WIDGET_STREAM_RECORD_RDM:
+		break;
+	default:
+		return WIDGET_STREAM_ERROR_FORMAT;
+	}
+
+	return WIDGET_STREAM_RECORD_HEADER_SIZE + info->body_length;
+}
+
+#endif /* WIDGET_STREAM_H_ */
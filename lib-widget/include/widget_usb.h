@@ -2,7 +2,7 @@
  * @file widget_usb.h
  *
  */
-/* Copyright (C) 2015, 2016 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2015-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -27,8 +27,19 @@
 #define WIDGET_USB_H_
 
 #include <stdint.h>
+#include <stdbool.h>
+
+#define WIDGET_USB_TX_BUFFER_SIZE	4096	///< Must be a power of 2
+#define WIDGET_USB_MESSAGE_SIZE(n)	((uint32_t) (n) + 5)	///< Start code, label, length (2), data (n), end code
+
+extern void widget_usb_tx_poll(void);
+extern uint32_t widget_usb_tx_free(void);
+extern bool widget_usb_tx_is_empty(void);
+extern bool widget_usb_tx_reserve(uint32_t);
+extern uint32_t widget_usb_tx_get_dropped(void);
 
 extern void widget_usb_send_header(const uint8_t, const uint16_t);
+extern void widget_usb_send_byte(const uint8_t);
 extern void widget_usb_send_data(const uint8_t *, const uint16_t);
 extern void widget_usb_send_footer(void);
 extern void widget_usb_send_message(const uint8_t, const uint8_t *, const uint16_t);
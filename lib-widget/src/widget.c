@@ -6,7 +6,7 @@
  * https://wiki.openlighting.org/index.php/USB_Protocol_Extensions
  *
  */
-/* Copyright (C) 2015-2018 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2015-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -38,6 +38,7 @@
 #include "widget_params.h"
 #include "widget_usb.h"
 #include "widget_monitor.h"
+#include "widget_stream.h"
 
 #include "dmx.h"
 #include "rdm.h"
@@ -170,12 +171,21 @@ void widget_received_dmx_packet(void) {
 	const struct _dmx_data *dmx_statistics = (struct _dmx_data *)dmx_data;
 	const uint16_t length = (uint16_t)(dmx_statistics->statistics.slots_in_packet + 1);
 
+	if (widget_stream_get_mode() == STREAM_MODE_ON) {
+		widget_stream_dmx(dmx_data, length, micros_now);
+		return;
+	}
+
+	if (!widget_usb_tx_reserve(WIDGET_USB_MESSAGE_SIZE(length + 1))) {
+		return;
+	}
+
 	monitor_line(MONITOR_LINE_LABEL, "poll:RECEIVED_DMX_PACKET");
 	monitor_line(MONITOR_LINE_INFO, "Send DMX data to HOST, %d", length);
 	monitor_line(MONITOR_LINE_STATUS, NULL);
 
 	widget_usb_send_header(RECEIVED_DMX_PACKET, length + 1);
-	usb_send_byte(0); 	// DMX Receive status
+	widget_usb_send_byte(0); 	// DMX Receive status
 	widget_usb_send_data(dmx_data, length);
 	widget_usb_send_footer();
 }
@@ -212,7 +222,7 @@ void widget_received_rdm_packet(void) {
 		monitor_line(MONITOR_LINE_STATUS, "RECEIVED_RDM_PACKET SC:0xCC");
 
 		widget_usb_send_header(RECEIVED_DMX_PACKET, 1 + message_length);
-		usb_send_byte(0); 	// RDM Receive status
+		widget_usb_send_byte(0); 	// RDM Receive status
 		widget_usb_send_data(rdm_data, message_length);
 		widget_usb_send_footer();
 
@@ -230,7 +240,7 @@ void widget_received_rdm_packet(void) {
 		monitor_line(MONITOR_LINE_STATUS, "RECEIVED_RDM_PACKET SC:0xFE");
 
 		widget_usb_send_header(RECEIVED_DMX_PACKET, 1 + message_length);
-		usb_send_byte(0); 	// RDM Receive status
+		widget_usb_send_byte(0); 	// RDM Receive status
 		widget_usb_send_data(rdm_data, message_length);
 		widget_usb_send_footer();
 
@@ -368,6 +378,17 @@ void widget_received_dmx_change_of_state_packet(void) {
 		return;
 	}
 
+	if (widget_stream_get_mode() == STREAM_MODE_ON) {
+		const uint8_t *dmx_data = dmx_is_data_changed();
+
+		if (dmx_data != NULL) {
+			const struct _dmx_data *dmx_statistics = (struct _dmx_data *)dmx_data;
+			widget_stream_dmx(dmx_data, (uint16_t)(dmx_statistics->statistics.slots_in_packet + 1), hardware_micros());
+		}
+
+		return;
+	}
+
 	if (dmx_is_data_changed()) {
 		monitor_line(MONITOR_LINE_INFO, "RECEIVED_DMX_COS_TYPE");
 		monitor_line(MONITOR_LINE_STATUS, NULL);
@@ -498,6 +519,59 @@ static void widget_get_name_reply(void) {
 	widget_received_dmx_packet_start = hardware_micros();
 }
 
+/**
+ *
+ * Stream Mode Request / Reply (Label = 90 \ref STREAM_MODE)
+ *
+ * Request data: mode (1), \ref _widget_stream_mode. Reply data: version (1), mode (1).
+ * The mode is not stored, after a reset the Widget sends the classic messages.
+ */
+static void widget_stream_mode_reply(uint16_t data_length) {
+	uint8_t reply[2];
+
+	monitor_line(MONITOR_LINE_INFO, "STREAM_MODE");
+	monitor_line(MONITOR_LINE_STATUS, NULL);
+
+	if (data_length != 0) {
+		widget_stream_set_mode((widget_data[0] == STREAM_MODE_ON) ? STREAM_MODE_ON : STREAM_MODE_OFF);
+	}
+
+	reply[0] = WIDGET_STREAM_VERSION;
+	reply[1] = (uint8_t) widget_stream_get_mode();
+
+	widget_usb_send_message(STREAM_MODE, reply, sizeof(reply));
+}
+
+/**
+ *
+ * Stream Statistics Request / Reply (Label = 92 \ref STREAM_STATISTICS)
+ *
+ * Reply data: \ref _widget_stream_statistics, all counters are uint32_t (LE).
+ */
+static void widget_stream_statistics_reply(void) {
+	struct _widget_stream_statistics statistics;
+
+	monitor_line(MONITOR_LINE_INFO, "STREAM_STATISTICS");
+	monitor_line(MONITOR_LINE_STATUS, NULL);
+
+	widget_stream_get_statistics(&statistics);
+	widget_usb_send_message(STREAM_STATISTICS, (uint8_t *) &statistics, sizeof(struct _widget_stream_statistics));
+}
+
+/**
+ *
+ * Write queued bytes to host
+ *
+ * This function is called from the poll table in \ref main.c
+ */
+void widget_send_data_to_host(void) {
+	if (widget_usb_tx_is_empty()) {
+		widget_stream_send_batch();
+	}
+
+	widget_usb_tx_poll();
+}
+
 /**
  *
  * Read bytes from host
@@ -552,6 +626,12 @@ void widget_receive_data_from_host(void) {
 			case SEND_RDM_DISCOVERY_REQUEST:
 				widget_send_rdm_discovery_request(data_length);
 				break;
+			case STREAM_MODE:
+				widget_stream_mode_reply(data_length);
+				break;
+			case STREAM_STATISTICS:
+				widget_stream_statistics_reply();
+				break;
 			default:
 				break;
 			}
@@ -2,7 +2,7 @@
  * @file widget_sniffer.c
  *
  */
-/* Copyright (C) 2015-2018 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2015-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -63,13 +63,13 @@ static void usb_send_package(const uint8_t *data, uint16_t start, uint16_t data_
 		widget_usb_send_header((uint8_t) SNIFFER_PACKET, (uint16_t) SNIFFER_PACKET_SIZE);
 
 		for (i = 0; i < data_length; i++) {
-			usb_send_byte(DATA_MASK);
-			usb_send_byte(data[i + start]);
+			widget_usb_send_byte(DATA_MASK);
+			widget_usb_send_byte(data[i + start]);
 		}
 
 		for (i = data_length; i < SNIFFER_PACKET_SIZE / 2; i++) {
-			usb_send_byte((uint8_t) CONTROL_MASK);
-			usb_send_byte(0x02);
+			widget_usb_send_byte((uint8_t) CONTROL_MASK);
+			widget_usb_send_byte(0x02);
 		}
 
 		widget_usb_send_footer();
@@ -77,8 +77,8 @@ static void usb_send_package(const uint8_t *data, uint16_t start, uint16_t data_
 		widget_usb_send_header((uint8_t) SNIFFER_PACKET, (uint16_t) SNIFFER_PACKET_SIZE);
 
 		for (i = 0; i < SNIFFER_PACKET_SIZE / 2; i++) {
-			usb_send_byte((uint8_t) DATA_MASK);
-			usb_send_byte(data[i + start]);
+			widget_usb_send_byte((uint8_t) DATA_MASK);
+			widget_usb_send_byte(data[i + start]);
 		}
 
 		widget_usb_send_footer();
@@ -87,6 +87,15 @@ static void usb_send_package(const uint8_t *data, uint16_t start, uint16_t data_
 	}
 }
 
+/*
+ * Each data byte takes 2 bytes, a packet has SNIFFER_PACKET_SIZE / 2 data bytes.
+ * A packet with the remaining bytes is always sent, also when it is empty.
+ */
+static uint32_t usb_package_size(uint16_t data_length) {
+	const uint32_t packets = ((uint32_t) data_length / (SNIFFER_PACKET_SIZE / 2)) + 1;
+	return packets * WIDGET_USB_MESSAGE_SIZE(SNIFFER_PACKET_SIZE);
+}
+
 static bool can_send(void) {
 	const uint32_t micros = hardware_micros();
 
@@ -105,7 +114,19 @@ static bool can_send(void) {
  * This function is called from the poll table in main.c
  */
 void widget_sniffer_dmx(void) {
-	if ((widget_get_mode() != MODE_RDM_SNIFFER) || !can_send()) {
+	if (widget_get_mode() != MODE_RDM_SNIFFER) {
+		return;
+	}
+
+	if (widget_stream_get_mode() == STREAM_MODE_ON) {
+		// Every frame is sent, the timestamp is the time it was picked up
+		const uint8_t *dmx_data = dmx_get_available();
+
+		if (dmx_data != NULL) {
+			const struct _dmx_data *dmx_statistics = (struct _dmx_data *)dmx_data;
+			widget_stream_dmx(dmx_data, (uint16_t)(dmx_statistics->statistics.slots_in_packet + 1), hardware_micros());
+		}
+
 		return;
 	}
 
@@ -118,7 +139,8 @@ void widget_sniffer_dmx(void) {
 	const struct _dmx_data *dmx_statistics = (struct _dmx_data *)dmx_data;
 	const uint16_t data_length = (uint16_t)(dmx_statistics->statistics.slots_in_packet + 1);
 
-	if (!can_send()) {
+	if (!widget_usb_tx_reserve(usb_package_size(data_length))) {
+		monitor_line(MONITOR_LINE_INFO, "!Dropped! DMX data");
 		return;
 	}
 
@@ -130,7 +152,7 @@ void widget_sniffer_dmx(void) {
  * This function is called from the poll table in main.c
  */
 void widget_sniffer_rdm(void) {
-	if ((widget_get_mode() != MODE_RDM_SNIFFER) || !can_send()) {
+	if (widget_get_mode() != MODE_RDM_SNIFFER) {
 		return;
 	}
 
@@ -166,7 +188,15 @@ void widget_sniffer_rdm(void) {
 		message_length = 24;
 	}
 
-	if (!can_send()) {
+	if (widget_stream_get_mode() == STREAM_MODE_ON) {
+		if (message_length != 0) {
+			widget_stream_rdm(rdm_data, message_length, rdm_get_data_receive_end());
+		}
+		return;
+	}
+
+	if (!widget_usb_tx_reserve(usb_package_size(message_length))) {
+		monitor_line(MONITOR_LINE_INFO, "!Dropped! RDM data");
 		return;
 	}
 
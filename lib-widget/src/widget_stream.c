@@ -0,0 +1,147 @@
+/**
+ * @file widget_stream.c
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "widget.h"
+#include "widget_usb.h"
+#include "widget_stream.h"
+
+#ifndef ALIGNED
+ #define ALIGNED __attribute__ ((aligned (4)))
+#endif
+
+#define STREAM_BATCH_SIZE	1024	///< Records, at least one full DMX frame
+
+/*
+ * The records are collected in a batch. The batch is queued as one message when
+ * the transmit buffer is empty, or when the next record does not fit. While the
+ * host is reading, the records are collected. When the link is idle, a record
+ * is sent on the next pass of the poll table.
+ */
+
+static struct widget_stream_encoder encoder ALIGNED;
+static uint8_t batch[WIDGET_STREAM_BATCH_HEADER_SIZE + STREAM_BATCH_SIZE] ALIGNED;
+static uint16_t batch_length;		///< Records in the batch
+static uint32_t batch_dropped;		///< Records dropped since the previous batch
+static _widget_stream_mode stream_mode = STREAM_MODE_OFF;
+static struct _widget_stream_statistics stream_statistics ALIGNED;
+
+_widget_stream_mode widget_stream_get_mode(void) {
+	return stream_mode;
+}
+
+void widget_stream_set_mode(_widget_stream_mode mode) {
+	stream_mode = mode;
+
+	widget_stream_encoder_init(&encoder);
+	batch_length = 0;
+	batch_dropped = 0;
+}
+
+static bool queue_batch(void) {
+	const uint16_t dropped = (batch_dropped > 0xFFFF) ? (uint16_t) 0xFFFF : (uint16_t) batch_dropped;
+
+	if (batch_length == 0) {
+		return true;
+	}
+
+	if (WIDGET_USB_MESSAGE_SIZE(WIDGET_STREAM_BATCH_HEADER_SIZE + batch_length) > widget_usb_tx_free()) {
+		return false;
+	}
+
+	batch[0] = (uint8_t) dropped;
+	batch[1] = (uint8_t) (dropped >> 8);
+
+	widget_usb_send_message(STREAM_BATCH, batch, (uint16_t) (WIDGET_STREAM_BATCH_HEADER_SIZE + batch_length));
+
+	stream_statistics.batches++;
+
+	batch_length = 0;
+	batch_dropped = 0;
+
+	return true;
+}
+
+static void add_record(uint16_t length) {
+	if (length == 0) {
+		stream_statistics.records_dropped++;
+		batch_dropped++;
+		return;
+	}
+
+	batch_length = (uint16_t) (batch_length + length);
+	stream_statistics.records++;
+}
+
+void widget_stream_dmx(const uint8_t *data, uint16_t length, uint32_t timestamp) {
+	uint8_t *record = &batch[WIDGET_STREAM_BATCH_HEADER_SIZE + batch_length];
+	uint16_t record_length = widget_stream_encode_dmx(&encoder, record, (uint16_t) (STREAM_BATCH_SIZE - batch_length), data, length, timestamp);
+
+	if ((record_length == 0) && queue_batch()) {
+		record = &batch[WIDGET_STREAM_BATCH_HEADER_SIZE];
+		record_length = widget_stream_encode_dmx(&encoder, record, STREAM_BATCH_SIZE, data, length, timestamp);
+	}
+
+	if (record_length != 0) {
+		if (record[0] == WIDGET_STREAM_RECORD_DMX) {
+			stream_statistics.dmx_frames++;
+		} else {
+			stream_statistics.dmx_deltas++;
+		}
+	}
+
+	add_record(record_length);
+}
+
+void widget_stream_rdm(const uint8_t *data, uint16_t length, uint32_t timestamp) {
+	uint16_t record_length = widget_stream_encode_rdm(&encoder, &batch[WIDGET_STREAM_BATCH_HEADER_SIZE + batch_length], (uint16_t) (STREAM_BATCH_SIZE - batch_length), data, length, timestamp);
+
+	if ((record_length == 0) && queue_batch()) {
+		record_length = widget_stream_encode_rdm(&encoder, &batch[WIDGET_STREAM_BATCH_HEADER_SIZE], STREAM_BATCH_SIZE, data, length, timestamp);
+	}
+
+	if (record_length != 0) {
+		stream_statistics.rdm_packets++;
+	}
+
+	add_record(record_length);
+}
+
+/**
+ * This function is called from \ref widget_send_data_to_host when the transmit buffer is empty
+ */
+void widget_stream_send_batch(void) {
+	if (stream_mode == STREAM_MODE_ON) {
+		(void) queue_batch();
+	}
+}
+
+void widget_stream_get_statistics(struct _widget_stream_statistics *statistics) {
+	memcpy(statistics, &stream_statistics, sizeof(struct _widget_stream_statistics));
+	statistics->messages_dropped = widget_usb_tx_get_dropped();
+}
@@ -2,7 +2,7 @@
  * @file widget_usb.c
  *
  */
-/* Copyright (C) 2015-2018 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2015-2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -24,26 +24,96 @@
  */
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "widget.h"
+#include "widget_usb.h"
 #include "usb.h"
 
+#ifndef ALIGNED
+ #define ALIGNED __attribute__ ((aligned (4)))
+#endif
+
+#if (WIDGET_USB_TX_BUFFER_SIZE & (WIDGET_USB_TX_BUFFER_SIZE - 1)) != 0
+ #error WIDGET_USB_TX_BUFFER_SIZE must be a power of 2
+#endif
+
+/*
+ * The messages to the host are queued in a transmit buffer. widget_usb_tx_poll()
+ * writes to the FT245RL as long as its FIFO accepts data, and returns when the
+ * FIFO is full. The widget keeps receiving DMX while the host is reading.
+ *
+ * A message is only blocking when the transmit buffer is full. Unsolicited
+ * messages (DMX, sniffer) call widget_usb_tx_reserve() first and are dropped,
+ * and counted, when they do not fit.
+ */
+
+static uint8_t tx_buffer[WIDGET_USB_TX_BUFFER_SIZE] ALIGNED;
+static uint32_t tx_head;		///< Free running, written by the queue functions
+static uint32_t tx_tail;		///< Free running, written by widget_usb_tx_poll
+static uint32_t tx_dropped;		///< Messages that did not fit
+
+static void tx_put(uint8_t byte) {
+	while ((tx_head - tx_tail) == WIDGET_USB_TX_BUFFER_SIZE) {
+		while (!usb_can_write())
+			;
+		FT245RL_write_data(tx_buffer[tx_tail & (WIDGET_USB_TX_BUFFER_SIZE - 1)]);
+		tx_tail++;
+	}
+
+	tx_buffer[tx_head & (WIDGET_USB_TX_BUFFER_SIZE - 1)] = byte;
+	tx_head++;
+}
+
+void widget_usb_tx_poll(void) {
+	while ((tx_tail != tx_head) && usb_can_write()) {
+		FT245RL_write_data(tx_buffer[tx_tail & (WIDGET_USB_TX_BUFFER_SIZE - 1)]);
+		tx_tail++;
+	}
+}
+
+uint32_t widget_usb_tx_free(void) {
+	return WIDGET_USB_TX_BUFFER_SIZE - (tx_head - tx_tail);
+}
+
+bool widget_usb_tx_is_empty(void) {
+	return tx_head == tx_tail;
+}
+
+bool widget_usb_tx_reserve(uint32_t length) {
+	if (length > widget_usb_tx_free()) {
+		tx_dropped++;
+		return false;
+	}
+
+	return true;
+}
+
+uint32_t widget_usb_tx_get_dropped(void) {
+	return tx_dropped;
+}
+
 void widget_usb_send_header(uint8_t label, uint16_t length) {
-	usb_send_byte(AMF_START_CODE);
-	usb_send_byte(label);
-	usb_send_byte((uint8_t) (length & 0x00FF));
-	usb_send_byte((uint8_t) (length >> 8));
+	tx_put(AMF_START_CODE);
+	tx_put(label);
+	tx_put((uint8_t) (length & 0x00FF));
+	tx_put((uint8_t) (length >> 8));
+}
+
+void widget_usb_send_byte(uint8_t byte) {
+	tx_put(byte);
 }
 
 void widget_usb_send_data(const uint8_t *data, uint16_t length) {
 	uint32_t i;
 	for (i = 0; i < length; i++) {
-		usb_send_byte(data[i]);
+		tx_put(data[i]);
 	}
 }
 
 void widget_usb_send_footer(void) {
-	usb_send_byte(AMF_END_CODE);
+	tx_put(AMF_END_CODE);
+	widget_usb_tx_poll();
 }
 
 void widget_usb_send_message(uint8_t label, const uint8_t *data, uint16_t length) {
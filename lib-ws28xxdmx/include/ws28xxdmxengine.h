@@ -0,0 +1,121 @@
+/**
+ * @file ws28xxdmxengine.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef WS28XXDMXENGINE_H_
+#define WS28XXDMXENGINE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Frame interpolation and temporal dithering between the DMX input and the pixel encoder.
+ *
+ * The DMX frames are collected with SetData() and committed with SetFrame(). The strip is
+ * refreshed at the refresh rate with a linear interpolation from the previous frame to the
+ * latest frame, over the measured DMX frame interval. This adds one DMX frame of latency.
+ *
+ * The interpolation and the gamma correction are done in 16-bit, the error of the conversion
+ * to 8-bit is carried to the next refresh (temporal dithering), so low-level fades do not band.
+ *
+ * Run() renders at most the pixel budget per call, a refresh can take several calls.
+ * The output is sent only when the refresh is completely rendered.
+ */
+
+#define WS28XXDMXENGINE_MAX_CHANNELS_PER_PIXEL	4
+#define WS28XXDMXENGINE_REFRESH_RATE_DEFAULT	200		///< Hz
+#define WS28XXDMXENGINE_GAMMA_DEFAULT			2.2f
+#define WS28XXDMXENGINE_PIXEL_BUDGET_DEFAULT	256		///< Pixels per Run()
+
+class WS28xxDmxEngineOutput {
+public:
+	virtual ~WS28xxDmxEngineOutput(void) {}
+
+	virtual void SetPixels(uint32_t nOutput, uint32_t nPixelIndex, const uint8_t *pData, uint32_t nPixels)=0;
+	virtual void Update(void)=0;
+};
+
+class WS28xxDmxEngine {
+public:
+	WS28xxDmxEngine(WS28xxDmxEngineOutput *pOutput, uint32_t nOutputs, uint32_t nPixels, uint32_t nChannelsPerPixel);
+	~WS28xxDmxEngine(void);
+
+	void SetRefreshRate(uint32_t nRefreshRate);
+	uint32_t GetRefreshRate(void) {
+		return 1000000 / m_nRefreshMicros;
+	}
+
+	void SetGamma(float fGamma);
+	float GetGamma(void) {
+		return m_fGamma;
+	}
+
+	void SetPixelBudget(uint32_t nPixels) {
+		m_nPixelBudget = (nPixels == 0) ? 1 : nPixels;
+	}
+	uint32_t GetPixelBudget(void) {
+		return m_nPixelBudget;
+	}
+
+	void SetData(uint32_t nOutput, uint32_t nPixelIndex, const uint8_t *pData, uint32_t nLength);
+	void SetFrame(void);
+
+	/**
+	 * @return true when a refresh is completed and sent to the output
+	 */
+	bool Run(uint32_t nMicros);
+
+	uint32_t GetFrameIntervalMicros(void) {
+		return m_nFrameIntervalMicros;
+	}
+
+	void Print(void);
+
+private:
+	void RenderPixels(uint32_t nChannelIndex, uint32_t nPixels, uint8_t *pOut);
+
+private:
+	WS28xxDmxEngineOutput *m_pOutput;
+	uint32_t m_nOutputs;
+	uint32_t m_nPixels;					///< Per output
+	uint32_t m_nChannelsPerPixel;
+	uint32_t m_nChannels;				///< All outputs
+	uint8_t *m_pPrevious;
+	uint8_t *m_pTarget;
+	uint8_t *m_pNext;					///< Filled by SetData()
+	uint8_t *m_pError;					///< Dithering residual, 8 fractional bits
+	uint16_t m_aGamma[257];				///< 8.8 fixed point, the last entry is for the interpolation
+	float m_fGamma;
+	uint32_t m_nRefreshMicros;
+	uint32_t m_nPixelBudget;
+	uint32_t m_nFrameMicros;			///< Start of the interpolation
+	uint32_t m_nFrameIntervalMicros;
+	uint32_t m_nRefreshStartMicros;
+	uint32_t m_nRenderIndex;			///< Next pixel of the refresh in progress, over all outputs
+	uint32_t m_nFactor;					///< Interpolation factor of the refresh in progress, 0-256
+	bool m_bFramePending;
+	bool m_bIsRendering;
+};
+
+#endif /* WS28XXDMXENGINE_H_ */
@@ -31,6 +31,7 @@
 #include "lightset.h"
 
 #include "ws28xxmulti.h"
+#include "ws28xxdmxengine.h"
 
 #include "rgbmapping.h"
 
@@ -39,7 +40,7 @@ enum TWS28xxDmxMultiSrc {
 	WS28XXDMXMULTI_SRC_E131
 };
 
-class WS28xxDmxMulti: public LightSet {
+class WS28xxDmxMulti: public LightSet, public WS28xxDmxEngineOutput {
 public:
 	WS28xxDmxMulti(TWS28xxDmxMultiSrc tSrc);
 	virtual ~WS28xxDmxMulti(void);
@@ -53,6 +54,27 @@ public:
 
 	void Blackout(bool bBlackout);
 
+	/**
+	 * With a refresh rate, set before Initialize(), the output is driven by the
+	 * WS28xxDmxEngine and Run() must be called from the main loop.
+	 */
+	void SetRefreshRate(uint32_t nRefreshRate) {
+		m_nRefreshRate = nRefreshRate;
+	}
+	uint32_t GetRefreshRate(void) {
+		return m_nRefreshRate;
+	}
+
+	void SetGamma(float fGamma) {
+		m_fGamma = fGamma;
+	}
+
+	void Run(void);
+
+	// WS28xxDmxEngineOutput
+	void SetPixels(uint32_t nOutput, uint32_t nPixelIndex, const uint8_t *pData, uint32_t nPixels);
+	void Update(void);
+
 	virtual void SetLEDType(TWS28XXType tWS28xxMultiType);
 	TWS28XXType GetLEDType(void) {
 		if (m_pLEDStripe != 0) {
@@ -131,6 +153,10 @@ private:
 
 	uint32_t m_nPortIdLast;
 	bool m_bUseSI5351A;
+
+	WS28xxDmxEngine *m_pEngine;
+	uint32_t m_nRefreshRate;
+	float m_fGamma;
 };
 
 #endif /* WS28XXDMXMULTI_H_ */
@@ -49,6 +49,8 @@ struct TWS28xxDmxParams {
 	uint8_t nRgbMapping;
 	uint8_t nLowCode;
 	uint8_t nHighCode;
+	uint16_t nRefreshRate;
+	uint8_t nGamma;
 };
 
 enum TWS28xxDmxParamsMask {
@@ -63,7 +65,9 @@ enum TWS28xxDmxParamsMask {
 	WS28XXDMX_PARAMS_MASK_LED_GROUP_COUNT = (1 << 8),
 	WS28XXDMX_PARAMS_MASK_RGB_MAPPING = (1 << 9),
 	WS28XXDMX_PARAMS_MASK_LOW_CODE = (1 << 10),
-	WS28XXDMX_PARAMS_MASK_HIGH_CODE = (1 << 11)
+	WS28XXDMX_PARAMS_MASK_HIGH_CODE = (1 << 11),
+	WS28XXDMX_PARAMS_MASK_REFRESH_RATE = (1 << 12),
+	WS28XXDMX_PARAMS_MASK_GAMMA = (1 << 13)
 };
 
 class WS28xxDmxParamsStore {
@@ -138,6 +142,14 @@ public:
 		return WS28xx::ConvertTxH(m_tWS28xxParams.nHighCode);
 	}
 
+	uint16_t GetRefreshRate(void) {
+		return m_tWS28xxParams.nRefreshRate;
+	}
+
+	float GetGamma(void) {
+		return static_cast<float>(m_tWS28xxParams.nGamma) / 10;
+	}
+
 public:
 	static void staticCallbackFunction(void *p, const char *s);
 
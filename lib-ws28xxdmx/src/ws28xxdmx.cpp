@@ -39,10 +39,18 @@
 #include "lightset.h"
 #include "lightsetdisplay.h"
 
+#include "hardware.h"
+#include "metrics.h"
+
 #ifndef MIN
  #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #endif
 
+static constexpr uint32_t s_aWaitBounds[METRIC_HISTOGRAM_BUCKETS - 1] = { 10, 50, 100, 500, 1000, 5000, 10000 };
+
+static struct metric s_MetricUpdates = METRIC_COUNTER("pixel.updates");
+static struct metric s_MetricWaitMicros = METRIC_HISTOGRAM("pixel.wait_us", s_aWaitBounds);
+
 WS28xxDmx::WS28xxDmx(void) :
 	m_tLedType(WS2812B),
 	m_tRGBMapping(RGB_MAPPING_UNDEFINED),
@@ -78,6 +86,9 @@ void WS28xxDmx::Start(uint8_t nPort) {
 
 	m_bIsStarted = true;
 
+	metrics_register(&s_MetricUpdates);
+	metrics_register(&s_MetricWaitMicros);
+
 	if (m_pLEDStripe == 0) {
 		m_pLEDStripe = new WS28xx(m_tLedType, m_nLedCount, m_tRGBMapping, m_nLowCode, m_nHighCode, m_nClockSpeedHz);
 		assert(m_pLEDStripe != 0);
@@ -148,8 +159,14 @@ void WS28xxDmx::SetData(uint8_t nPortId, const uint8_t *pData, uint16_t nLength)
 #endif
 #endif
 
-	while (m_pLEDStripe->IsUpdating()) {
-		// wait for completion
+	if (m_pLEDStripe->IsUpdating()) {
+		const uint32_t nMicros = Hardware::Get()->Micros();
+
+		while (m_pLEDStripe->IsUpdating()) {
+			// wait for completion
+		}
+
+		metric_observe(&s_MetricWaitMicros, Hardware::Get()->Micros() - nMicros);
 	}
 
 	for (uint32_t j = beginIndex; j < endIndex; j++) {
@@ -171,6 +188,7 @@ void WS28xxDmx::SetData(uint8_t nPortId, const uint8_t *pData, uint16_t nLength)
 
 	if (nPortId == m_nPortIdLast) {
 		m_pLEDStripe->Update();
+		metric_inc(&s_MetricUpdates);
 	}
 }
 
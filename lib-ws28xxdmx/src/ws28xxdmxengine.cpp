@@ -0,0 +1,246 @@
+/**
+ * @file ws28xxdmxengine.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#include "ws28xxdmxengine.h"
+
+#include "metrics.h"
+
+#include "debug.h"
+
+#ifndef MIN
+ #define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+
+#define FRAME_INTERVAL_MIN_MICROS	5000
+#define FRAME_INTERVAL_MAX_MICROS	100000
+#define RENDER_BLOCK_PIXELS			32
+
+static struct metric s_MetricFrames = METRIC_COUNTER("pixel.engine.frames");
+static struct metric s_MetricRefreshes = METRIC_COUNTER("pixel.engine.refreshes");
+static struct metric s_MetricFrameIntervalMicros = METRIC_GAUGE("pixel.engine.frame_interval_us");
+
+WS28xxDmxEngine::WS28xxDmxEngine(WS28xxDmxEngineOutput *pOutput, uint32_t nOutputs, uint32_t nPixels, uint32_t nChannelsPerPixel):
+	m_pOutput(pOutput),
+	m_nOutputs(nOutputs),
+	m_nPixels(nPixels),
+	m_nChannelsPerPixel(nChannelsPerPixel),
+	m_nChannels(nOutputs * nPixels * nChannelsPerPixel),
+	m_fGamma(0),
+	m_nRefreshMicros(1000000 / WS28XXDMXENGINE_REFRESH_RATE_DEFAULT),
+	m_nPixelBudget(WS28XXDMXENGINE_PIXEL_BUDGET_DEFAULT),
+	m_nFrameMicros(0),
+	m_nFrameIntervalMicros(FRAME_INTERVAL_MAX_MICROS / 4),
+	m_nRefreshStartMicros(0),
+	m_nRenderIndex(0),
+	m_nFactor(256),
+	m_bFramePending(false),
+	m_bIsRendering(false)
+{
+	DEBUG_ENTRY
+
+	assert(m_pOutput != 0);
+	assert(nChannelsPerPixel <= WS28XXDMXENGINE_MAX_CHANNELS_PER_PIXEL);
+
+	m_pPrevious = new uint8_t[m_nChannels];
+	assert(m_pPrevious != 0);
+	m_pTarget = new uint8_t[m_nChannels];
+	assert(m_pTarget != 0);
+	m_pNext = new uint8_t[m_nChannels];
+	assert(m_pNext != 0);
+	m_pError = new uint8_t[m_nChannels];
+	assert(m_pError != 0);
+
+	memset(m_pPrevious, 0, m_nChannels);
+	memset(m_pTarget, 0, m_nChannels);
+	memset(m_pNext, 0, m_nChannels);
+	memset(m_pError, 0, m_nChannels);
+
+	SetGamma(WS28XXDMXENGINE_GAMMA_DEFAULT);
+
+	metrics_register(&s_MetricFrames);
+	metrics_register(&s_MetricRefreshes);
+	metrics_register(&s_MetricFrameIntervalMicros);
+
+	DEBUG_PRINTF("m_nOutputs=%u, m_nPixels=%u, m_nChannels=%u", m_nOutputs, m_nPixels, m_nChannels);
+	DEBUG_EXIT
+}
+
+WS28xxDmxEngine::~WS28xxDmxEngine(void) {
+	delete [] m_pError;
+	delete [] m_pNext;
+	delete [] m_pTarget;
+	delete [] m_pPrevious;
+}
+
+void WS28xxDmxEngine::SetRefreshRate(uint32_t nRefreshRate) {
+	m_nRefreshMicros = 1000000 / ((nRefreshRate == 0) ? 1 : nRefreshRate);
+}
+
+/*
+ * Input and output are 8.8 fixed point, full scale is 255.0 (0xFF00).
+ * Entry 256 repeats full scale, it is read only with a zero fraction.
+ */
+void WS28xxDmxEngine::SetGamma(float fGamma) {
+	m_fGamma = (fGamma <= 0) ? 1.0f : fGamma;
+
+	for (uint32_t i = 0; i < 256; i++) {
+		const float f = 65280.0f * powf(static_cast<float>(i) / 255.0f, m_fGamma) + 0.5f;
+		m_aGamma[i] = (f >= 65280.0f) ? 0xFF00 : static_cast<uint16_t>(f);
+	}
+
+	m_aGamma[256] = 0xFF00;
+}
+
+void WS28xxDmxEngine::SetData(uint32_t nOutput, uint32_t nPixelIndex, const uint8_t *pData, uint32_t nLength) {
+	assert(pData != 0);
+
+	if ((nOutput >= m_nOutputs) || (nPixelIndex >= m_nPixels)) {
+		return;
+	}
+
+	const uint32_t nIndex = ((nOutput * m_nPixels) + nPixelIndex) * m_nChannelsPerPixel;
+
+	memcpy(&m_pNext[nIndex], pData, MIN(nLength, (m_nPixels - nPixelIndex) * m_nChannelsPerPixel));
+}
+
+void WS28xxDmxEngine::SetFrame(void) {
+	m_bFramePending = true;
+}
+
+/*
+ * The value interpolated from the previous to the target frame, in 8.8 fixed point,
+ * through the gamma table and truncated to 8-bit with the residual of the previous refresh.
+ */
+void WS28xxDmxEngine::RenderPixels(uint32_t nChannelIndex, uint32_t nPixels, uint8_t *pOut) {
+	const uint8_t *pPrevious = &m_pPrevious[nChannelIndex];
+	const uint8_t *pTarget = &m_pTarget[nChannelIndex];
+	uint8_t *pError = &m_pError[nChannelIndex];
+	const int32_t nFactor = static_cast<int32_t>(m_nFactor);
+	const uint32_t nChannels = nPixels * m_nChannelsPerPixel;
+
+	for (uint32_t i = 0; i < nChannels; i++) {
+		const int32_t nFrom = pPrevious[i] << 8;
+		const int32_t nTo = pTarget[i] << 8;
+		const uint32_t nValue = static_cast<uint32_t>(nFrom + (((nTo - nFrom) * nFactor) / 256));
+
+		const uint32_t nGammaIndex = nValue >> 8;
+		const uint32_t nGammaLow = m_aGamma[nGammaIndex];
+		const uint32_t nGamma = nGammaLow + (((m_aGamma[nGammaIndex + 1] - nGammaLow) * (nValue & 0xFF)) >> 8);
+
+		const uint32_t nSum = nGamma + pError[i];	// At most 0xFF00 + 0xFF
+
+		pOut[i] = static_cast<uint8_t>(nSum >> 8);
+		pError[i] = static_cast<uint8_t>(nSum & 0xFF);
+	}
+}
+
+bool WS28xxDmxEngine::Run(uint32_t nMicros) {
+	if (m_bFramePending && !m_bIsRendering) {
+		uint32_t nInterval = nMicros - m_nFrameMicros;
+
+		if (nInterval < FRAME_INTERVAL_MIN_MICROS) {
+			nInterval = FRAME_INTERVAL_MIN_MICROS;
+		} else if (nInterval > FRAME_INTERVAL_MAX_MICROS) {
+			nInterval = FRAME_INTERVAL_MAX_MICROS;
+		}
+
+		m_nFrameIntervalMicros = ((3 * m_nFrameIntervalMicros) + nInterval) / 4;
+		m_nFrameMicros = nMicros;
+
+		// The target becomes the start of the interpolation, the collected frame the new target
+		uint8_t *pPrevious = m_pPrevious;
+		m_pPrevious = m_pTarget;
+		m_pTarget = m_pNext;
+		m_pNext = pPrevious;
+
+		// A partial update of the next frame keeps the other values
+		memcpy(m_pNext, m_pTarget, m_nChannels);
+
+		m_bFramePending = false;
+
+		metric_inc(&s_MetricFrames);
+		metric_set(&s_MetricFrameIntervalMicros, m_nFrameIntervalMicros);
+	}
+
+	if (!m_bIsRendering) {
+		if ((nMicros - m_nRefreshStartMicros) < m_nRefreshMicros) {
+			return false;
+		}
+
+		// On schedule, so a late Run() does not lower the refresh rate. After a stall the schedule restarts.
+		if ((nMicros - m_nRefreshStartMicros) < (2 * m_nRefreshMicros)) {
+			m_nRefreshStartMicros += m_nRefreshMicros;
+		} else {
+			m_nRefreshStartMicros = nMicros;
+		}
+
+		const uint32_t nElapsed = nMicros - m_nFrameMicros;
+
+		m_nFactor = (nElapsed >= m_nFrameIntervalMicros) ? 256 : (nElapsed * 256) / m_nFrameIntervalMicros;
+		m_nRenderIndex = 0;
+		m_bIsRendering = true;
+	}
+
+	const uint32_t nTotal = m_nOutputs * m_nPixels;
+	const uint32_t nEnd = MIN(nTotal, m_nRenderIndex + m_nPixelBudget);
+	uint8_t aPixels[RENDER_BLOCK_PIXELS * WS28XXDMXENGINE_MAX_CHANNELS_PER_PIXEL];
+
+	while (m_nRenderIndex < nEnd) {
+		const uint32_t nOutput = m_nRenderIndex / m_nPixels;
+		const uint32_t nPixelIndex = m_nRenderIndex - (nOutput * m_nPixels);
+		const uint32_t nPixels = MIN(MIN(nEnd - m_nRenderIndex, m_nPixels - nPixelIndex), static_cast<uint32_t>(RENDER_BLOCK_PIXELS));
+
+		RenderPixels(m_nRenderIndex * m_nChannelsPerPixel, nPixels, aPixels);
+		m_pOutput->SetPixels(nOutput, nPixelIndex, aPixels, nPixels);
+
+		m_nRenderIndex += nPixels;
+	}
+
+	if (m_nRenderIndex < nTotal) {
+		return false;
+	}
+
+	m_bIsRendering = false;
+	m_pOutput->Update();
+
+	metric_inc(&s_MetricRefreshes);
+
+	return true;
+}
+
+void WS28xxDmxEngine::Print(void) {
+	printf(" Engine\n");
+	printf("  Refresh  : %u Hz\n", GetRefreshRate());
+	printf("  Gamma    : %.1f\n", m_fGamma);
+	printf("  Budget   : %u pixels\n", m_nPixelBudget);
+	printf("  Interval : %u us\n", m_nFrameIntervalMicros);
+}
@@ -28,12 +28,15 @@
 #include <assert.h>
 
 #include "ws28xxdmxmulti.h"
+#include "ws28xxdmxengine.h"
 #include "ws28xxmulti.h"
 #include "ws28xxdmxparams.h"
 #include "ws28xx.h"
 
 #include "rgbmapping.h"
 
+#include "hardware.h"
+
 #include "debug.h"
 
 #ifndef MIN
@@ -57,7 +60,10 @@ WS28xxDmxMulti::WS28xxDmxMulti(TWS28xxDmxMultiSrc tSrc):
 	m_nBeginIndexPortId3(510),
 	m_nChannelsPerLed(3),
 	m_nPortIdLast(3), // -> (m_nActiveOutputs * m_nUniverses) -1;
-	m_bUseSI5351A(false)
+	m_bUseSI5351A(false),
+	m_pEngine(0),
+	m_nRefreshRate(0),
+	m_fGamma(WS28XXDMXENGINE_GAMMA_DEFAULT)
 {
 	DEBUG_ENTRY
 
@@ -69,6 +75,9 @@ WS28xxDmxMulti::WS28xxDmxMulti(TWS28xxDmxMultiSrc tSrc):
 }
 
 WS28xxDmxMulti::~WS28xxDmxMulti(void) {
+	delete m_pEngine;
+	m_pEngine = 0;
+
 	delete m_pLEDStripe;
 	m_pLEDStripe = 0;
 }
@@ -83,6 +92,14 @@ void WS28xxDmxMulti::Initialize(void) {
 	}
 
 	m_pLEDStripe->Blackout();
+
+	if (m_nRefreshRate != 0) {
+		m_pEngine = new WS28xxDmxEngine(this, m_nActiveOutputs, m_nLedCount, m_nChannelsPerLed);
+		assert(m_pEngine != 0);
+
+		m_pEngine->SetRefreshRate(m_nRefreshRate);
+		m_pEngine->SetGamma(m_fGamma);
+	}
 }
 
 void WS28xxDmxMulti::Start(uint8_t nPort) {
@@ -163,6 +180,18 @@ void WS28xxDmxMulti::SetData(uint8_t nPortId, const uint8_t* pData, uint16_t nLe
 			static_cast<int>(nPortId), static_cast<int>(nLength), static_cast<int>(nOutIndex),
 			static_cast<int>(nPortId) & ~m_nUniverses & 0x03, static_cast<int>(beginIndex), static_cast<int>(endIndex));
 
+	if (m_pEngine != 0) {
+		if (endIndex > beginIndex) {
+			m_pEngine->SetData(nOutIndex, beginIndex, pData, (endIndex - beginIndex) * m_nChannelsPerLed);
+		}
+
+		if (nPortId == m_nPortIdLast) {
+			m_pEngine->SetFrame();
+		}
+
+		return;
+	}
+
 	while (m_pLEDStripe->IsUpdating()) {
 		// wait for completion
 	}
@@ -203,6 +232,30 @@ void WS28xxDmxMulti::Blackout(bool bBlackout) {
 	}
 }
 
+void WS28xxDmxMulti::Run(void) {
+	if ((m_pEngine == 0) || !m_bIsStarted || m_bBlackout || m_pLEDStripe->IsUpdating()) {
+		return;
+	}
+
+	m_pEngine->Run(Hardware::Get()->Micros());
+}
+
+void WS28xxDmxMulti::SetPixels(uint32_t nOutput, uint32_t nPixelIndex, const uint8_t *pData, uint32_t nPixels) {
+	if (m_nChannelsPerLed == 4) {
+		for (uint32_t i = 0; i < nPixels; i++, pData += 4) {
+			m_pLEDStripe->SetLED(nOutput, nPixelIndex + i, pData[0], pData[1], pData[2], pData[3]);
+		}
+	} else {
+		for (uint32_t i = 0; i < nPixels; i++, pData += 3) {
+			m_pLEDStripe->SetLED(nOutput, nPixelIndex + i, pData[0], pData[1], pData[2]);
+		}
+	}
+}
+
+void WS28xxDmxMulti::Update(void) {
+	m_pLEDStripe->Update();
+}
+
 void WS28xxDmxMulti::SetLEDType(TWS28XXType tWS28xxMultiType) {
 	DEBUG_ENTRY
 
@@ -269,4 +322,7 @@ void WS28xxDmxMulti::Print(void) {
 	if (m_pLEDStripe->GetBoard() == WS28XXMULTI_BOARD_4X) {
 		printf("  SI5351A : %c\n", m_bUseSI5351A ? 'Y' : 'N');
 	}
+	if (m_pEngine != 0) {
+		m_pEngine->Print();
+	}
 }
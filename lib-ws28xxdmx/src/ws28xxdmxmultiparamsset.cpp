@@ -58,4 +58,12 @@ void WS28xxDmxParams::Set(WS28xxDmxMulti *pWS28xxDmxMulti) {
 	if (isMaskSet(WS28XXDMX_PARAMS_MASK_USE_SI5351A)) {
 		pWS28xxDmxMulti->SetUseSI5351A(m_tWS28xxParams.bUseSI5351A);
 	}
+
+	if (isMaskSet(WS28XXDMX_PARAMS_MASK_REFRESH_RATE)) {
+		pWS28xxDmxMulti->SetRefreshRate(m_tWS28xxParams.nRefreshRate);
+	}
+
+	if (isMaskSet(WS28XXDMX_PARAMS_MASK_GAMMA)) {
+		pWS28xxDmxMulti->SetGamma(GetGamma());
+	}
 }
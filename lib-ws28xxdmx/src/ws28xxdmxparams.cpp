@@ -71,6 +71,8 @@ WS28xxDmxParams::WS28xxDmxParams(WS28xxDmxParamsStore *pWS28XXStripeParamsStore)
 	m_tWS28xxParams.nRgbMapping = RGB_MAPPING_UNDEFINED;
 	m_tWS28xxParams.nLowCode = 0;
 	m_tWS28xxParams.nHighCode = 0;
+	m_tWS28xxParams.nRefreshRate = 0;
+	m_tWS28xxParams.nGamma = static_cast<uint8_t>(WS28XXDMXENGINE_GAMMA_DEFAULT * 10);
 }
 
 WS28xxDmxParams::~WS28xxDmxParams(void) {
@@ -226,6 +228,22 @@ void WS28xxDmxParams::callbackFunction(const char *pLine) {
 		return;
 	}
 
+	if (Sscan::Uint16(pLine, DevicesParamsConst::REFRESH_RATE, &nValue16) == SSCAN_OK) {
+		if (nValue16 <= 1000) {
+			m_tWS28xxParams.nRefreshRate = nValue16;
+			m_tWS28xxParams.nSetList |= WS28XXDMX_PARAMS_MASK_REFRESH_RATE;
+		}
+		return;
+	}
+
+	if (Sscan::Float(pLine, DevicesParamsConst::GAMMA, &fValue) == SSCAN_OK) {
+		if ((fValue >= 1.0f) && (fValue <= 4.0f)) {
+			m_tWS28xxParams.nGamma = static_cast<uint8_t>((fValue * 10) + 0.5f);
+			m_tWS28xxParams.nSetList |= WS28XXDMX_PARAMS_MASK_GAMMA;
+		}
+		return;
+	}
+
 	if (Sscan::Uint16(pLine, LightSetConst::PARAMS_DMX_START_ADDRESS, &nValue16) == SSCAN_OK) {
 		if (nValue16 != 0 && nValue16 <= DMX_UNIVERSE_SIZE) {
 			m_tWS28xxParams.nDmxStartAddress = nValue16;
@@ -286,6 +304,14 @@ void WS28xxDmxParams::Dump(void) {
 	if (isMaskSet(WS28XXDMX_PARAMS_MASK_DMX_START_ADDRESS)) {
 		printf(" %s=%d\n", LightSetConst::PARAMS_DMX_START_ADDRESS, static_cast<int>(m_tWS28xxParams.nDmxStartAddress));
 	}
+
+	if (isMaskSet(WS28XXDMX_PARAMS_MASK_REFRESH_RATE)) {
+		printf(" %s=%d\n", DevicesParamsConst::REFRESH_RATE, static_cast<int>(m_tWS28xxParams.nRefreshRate));
+	}
+
+	if (isMaskSet(WS28XXDMX_PARAMS_MASK_GAMMA)) {
+		printf(" %s=%.1f\n", DevicesParamsConst::GAMMA, GetGamma());
+	}
 #endif
 }
 
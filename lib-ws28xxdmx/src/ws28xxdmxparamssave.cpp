@@ -96,6 +96,10 @@ void WS28xxDmxParams::Builder(const struct TWS28xxDmxParams *ptWS28xxParams, cha
 	builder.Add(DevicesParamsConst::ACTIVE_OUT, m_tWS28xxParams.nActiveOutputs, isMaskSet(WS28XXDMX_PARAMS_MASK_ACTIVE_OUT));
 	builder.Add(DevicesParamsConst::USE_SI5351A, m_tWS28xxParams.bUseSI5351A, isMaskSet(WS28XXDMX_PARAMS_MASK_USE_SI5351A));
 
+	builder.AddComment("Interpolation and dithering, refresh rate 0 is off");
+	builder.Add(DevicesParamsConst::REFRESH_RATE, m_tWS28xxParams.nRefreshRate, isMaskSet(WS28XXDMX_PARAMS_MASK_REFRESH_RATE));
+	builder.Add(DevicesParamsConst::GAMMA, GetGamma(), isMaskSet(WS28XXDMX_PARAMS_MASK_GAMMA), 1);
+
 	nSize = builder.GetSize();
 
 	DEBUG_PRINTF("nSize=%d", nSize);
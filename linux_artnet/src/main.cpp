@@ -28,6 +28,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <signal.h>
 
 #include "hardware.h"
 #include "networklinux.h"
@@ -36,10 +37,16 @@
 #include "artnet4node.h"
 #include "artnet4params.h"
 
+#include "artnete131gateway.h"
+#include "artnete131gatewayparams.h"
+
 #include "dmxmonitor.h"
 #include "dmxmonitorparams.h"
 #include "storemonitor.h"
 
+#include "lightsetchain.h"
+#include "showfilerecorder.h"
+
 #include "identify.h"
 #include "artnetrdmresponder.h"
 
@@ -60,6 +67,15 @@
 #include "firmwareversion.h"
 #include "software_version.h"
 
+#include "profiler.h"
+#include "metrics.h"
+
+static volatile sig_atomic_t s_nStop;
+
+static void stop_handler(int nSignal) {
+	s_nStop = nSignal;
+}
+
 int main(int argc, char **argv) {
 	Hardware hw;
 	NetworkLinux nw;
@@ -67,7 +83,7 @@ int main(int argc, char **argv) {
 	FirmwareVersion fw(SOFTWARE_VERSION, __DATE__, __TIME__);
 
 	if (argc < 2) {
-		printf("Usage: %s ip_address|interface_name\n", argv[0]);
+		printf("Usage: %s ip_address|interface_name [record_file]\n", argv[0]);
 		return -1;
 	}
 
@@ -78,6 +94,39 @@ int main(int argc, char **argv) {
 		return -1;
 	}
 
+	ArtNetE131GatewayParams gatewayParams;
+
+	// With a gateway.txt this is a network to network Art-Net <-> sACN gateway, there is no node
+	if (gatewayParams.Load()) {
+		gatewayParams.Dump();
+
+		ArtNetE131Gateway gateway;
+		gatewayParams.Set(&gateway);
+
+		nw.Print();
+		gateway.Print();
+
+		nw.SetBatchSend(true);
+
+		signal(SIGINT, stop_handler);
+		signal(SIGTERM, stop_handler);
+
+		gateway.Start();
+
+		PROFILER_INIT();
+
+		while (s_nStop == 0) {
+			PROFILE_LOOP();
+			{ PROFILE_SCOPE("gateway.Run"); gateway.Run(); }
+			{ PROFILE_SCOPE("network.Wait"); nw.Wait(1); }
+		}
+
+		gateway.Stop();
+		metrics_dump();
+
+		return 0;
+	}
+
 	SpiFlashStore spiFlashStore;
 	ArtNet4Params artnet4Params(spiFlashStore.GetStoreArtNet4());
 
@@ -106,7 +155,22 @@ int main(int argc, char **argv) {
 		monitorParams.Set(&monitor);
 	}
 
-	node.SetOutput(&monitor);
+	// With a record file the received DMX is also recorded as an OLA show file
+	ShowFileRecorder recorder;
+	LightSetChain chain;
+
+	if (argc > 2) {
+		if (!recorder.Open(argv[2])) {
+			return -1;
+		}
+
+		chain.Add(&monitor, LIGHTSET_OUTPUT_TYPE_MONITOR);
+		chain.Add(&recorder);
+
+		node.SetOutput(&chain);
+	} else {
+		node.SetOutput(&monitor);
+	}
 #if defined (__linux__)
 	if (getuid() == 0) {
 		node.SetIpProgHandler(new IpProg);
@@ -154,11 +218,23 @@ int main(int argc, char **argv) {
 		}
 	}
 
+	for (uint32_t i = 0; i < SHOWFILE_RECORDER_MAX_PORTS; i++) {
+		uint16_t nUniverse;
+
+		if (node.GetPortAddress(i, nUniverse)) {
+			recorder.SetUniverse(i, nUniverse);
+		}
+	}
+
 	Identify identify;
 
 	nw.Print();
 	node.Print();
 
+	if (recorder.IsOpen()) {
+		recorder.Print();
+	}
+
 	if(artnet4Params.IsRdm()) {
 		RdmResponder.Print();
 	}
@@ -176,14 +252,35 @@ int main(int argc, char **argv) {
 	while (spiFlashStore.Flash())
 		;
 
+	nw.SetBatchSend(true);
+
+	signal(SIGINT, stop_handler);
+	signal(SIGTERM, stop_handler);
+
 	node.Start();
 
-	for (;;) {
-		node.Run();
+	PROFILER_INIT();
+
+	while (s_nStop == 0) {
+		PROFILE_LOOP();
+		{ PROFILE_SCOPE("node.Run"); node.Run(); }
 		identify.Run();
-		remoteConfig.Run();
-		spiFlashStore.Flash();
+		{ PROFILE_SCOPE("remoteConfig.Run"); remoteConfig.Run(); }
+		{ PROFILE_SCOPE("spiFlashStore.Flash"); spiFlashStore.Flash(); }
+
+		if (recorder.IsOpen()) {
+			PROFILE_SCOPE("recorder.Run");
+			recorder.Run();
+		}
+
+		// Sleeps until a packet arrives, the queued replies are sent first
+		{ PROFILE_SCOPE("network.Wait"); nw.Wait(1); }
 	}
 
+	node.Stop();
+	recorder.Close();
+
+	metrics_dump();
+
 	return 0;
 }
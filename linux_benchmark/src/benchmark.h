@@ -0,0 +1,66 @@
+/**
+ * @file benchmark.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <stdint.h>
+
+#include "networkpcap.h"
+
+#define MAX_SAMPLES		(4 * 1024 * 1024)
+
+struct TSamples {
+	const char *pName;
+	uint32_t *pSamples;
+	uint32_t nCount;
+};
+
+void samples_add(struct TSamples *pSamples, uint32_t nTicks);
+void samples_print(struct TSamples *pSamples);
+
+/*
+ * The value of a registered metric, 0 when there is none
+ */
+uint32_t metric_value(const char *pName);
+
+/*
+ * The checks return 0 when passed, they print the failures
+ */
+int pixel_benchmark(uint32_t nPixels, uint32_t nOutputs);
+int widget_benchmark(uint32_t nFrames, uint32_t nChanged);
+int poll_benchmark(NetworkPcap &nw, uint32_t nControllers, uint32_t nRounds, uint32_t nJitterMillis);
+int rdm_benchmark(NetworkPcap &nw, uint32_t nRequests, uint32_t nTransactionMicros);
+int rdmpid_benchmark(void);
+int priority_benchmark(NetworkPcap &nw, uint32_t nRounds);
+int serial_benchmark(uint32_t nMessages);
+int ltc_benchmark(const char *pMode, const char *pFileName);
+int esp8266_benchmark(uint32_t nFrames);
+int showfile_benchmark(const char *pFileName, uint32_t nFrames);
+int record_benchmark(NetworkPcap &nw, uint32_t nFrames);
+int osc_benchmark(void);
+int gateway_benchmark(NetworkPcap &nw);
+
+#endif /* BENCHMARK_H_ */
@@ -0,0 +1,55 @@
+/**
+ * @file benchmarkshowfile.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef BENCHMARKSHOWFILE_H_
+#define BENCHMARKSHOWFILE_H_
+
+#include "olashowfile.h"
+#include "filestream.h"
+
+/*
+ * OlaShowFile with a file name instead of a show number
+ */
+class BenchmarkShowFile: public OlaShowFile {
+public:
+	bool Open(const char *pFileName) {
+		if (m_pShowFile != 0) {
+			static_cast<void>(filestream_close(m_pShowFile));
+		}
+
+		m_pShowFile = filestream_open(pFileName);
+
+		return m_pShowFile != 0;
+	}
+
+	void Close(void) {
+		if (m_pShowFile != 0) {
+			static_cast<void>(filestream_close(m_pShowFile));
+			m_pShowFile = 0;
+		}
+	}
+};
+
+#endif /* BENCHMARKSHOWFILE_H_ */
@@ -0,0 +1,454 @@
+/**
+ * @file esp8266.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"	// C header, shared with the ESP8266 firmware
+#include "esp8266_burst.h"
+#pragma GCC diagnostic pop
+
+#include "benchmark.h"
+
+/*
+ * The burst frames of esp8266_burst.h over a simulated nibble bus.
+ *
+ * The bus carries a nibble with the level of the control line of the sender:
+ * high for the low nibble, low for the high nibble. The receiver checks the
+ * levels. The clock is simulated, an edge takes 1 us. A side that waits for an
+ * edge that does not come gives up after ESP8266_BURST_TIMEOUT_US, as the
+ * drivers do. Nibbles that are left when the receiver returns were never
+ * acknowledged: the sender times out on them and both sides resync.
+ *
+ * Checked are: the round trip of random frames, that every single bit error
+ * is rejected, a payload larger than the receive buffer, a link that breaks
+ * within the frame, and the negotiation between old and new host and firmware.
+ */
+
+#define BUS_SIZE			(2 * 4096)
+#define RECEIVE_SIZE		800			///< UDP_BUFFER_SIZE of the ESP8266 firmware
+#define MAX_PAYLOAD			1472
+#define NO_ERROR			0xFFFFFFFF
+
+struct TBus {
+	uint8_t aNibble[BUS_SIZE];
+	uint8_t aLevel[BUS_SIZE];
+	uint32_t nHead;
+	uint32_t nTail;
+	uint32_t nBreakAfter;		///< The link breaks after this many nibbles
+	uint32_t nCorrupt;			///< Nibble with a bit error
+	uint8_t nCorruptMask;
+	uint32_t nWritten;
+	uint32_t nEdges;
+	uint32_t nTimeouts;
+	uint32_t nLevelErrors;
+	uint64_t nMicros;
+};
+
+static struct TBus s_Bus;
+
+static void bus_reset(void) {
+	memset(&s_Bus, 0, sizeof(s_Bus));
+	s_Bus.nBreakAfter = NO_ERROR;
+	s_Bus.nCorrupt = NO_ERROR;
+}
+
+static bool bus_put(uint8_t nNibble, uint8_t nLevel) {
+	if ((s_Bus.nWritten == s_Bus.nBreakAfter) || ((s_Bus.nHead - s_Bus.nTail) == BUS_SIZE)) {
+		s_Bus.nMicros += ESP8266_BURST_TIMEOUT_US;
+		s_Bus.nTimeouts++;
+		return false;
+	}
+
+	if (s_Bus.nWritten == s_Bus.nCorrupt) {
+		nNibble ^= s_Bus.nCorruptMask;
+	}
+
+	s_Bus.aNibble[s_Bus.nHead % BUS_SIZE] = nNibble;
+	s_Bus.aLevel[s_Bus.nHead % BUS_SIZE] = nLevel;
+	s_Bus.nHead++;
+	s_Bus.nWritten++;
+	s_Bus.nEdges++;
+	s_Bus.nMicros++;
+
+	return true;
+}
+
+static bool bus_get(uint8_t &nNibble, uint8_t nLevel) {
+	if (s_Bus.nHead == s_Bus.nTail) {
+		s_Bus.nMicros += ESP8266_BURST_TIMEOUT_US;
+		s_Bus.nTimeouts++;
+		return false;
+	}
+
+	if (s_Bus.aLevel[s_Bus.nTail % BUS_SIZE] != nLevel) {
+		s_Bus.nLevelErrors++;
+	}
+
+	nNibble = s_Bus.aNibble[s_Bus.nTail % BUS_SIZE];
+	s_Bus.nTail++;
+
+	return true;
+}
+
+/*
+ * The sender waits for the acknowledge of the nibbles that are left
+ */
+static void bus_settle(void) {
+	if (s_Bus.nHead != s_Bus.nTail) {
+		s_Bus.nMicros += ESP8266_BURST_TIMEOUT_US;
+		s_Bus.nTimeouts++;
+		s_Bus.nTail = s_Bus.nHead;
+	}
+}
+
+static bool bus_write(const uint8_t *pData, uint16_t nLength) {
+	for (uint32_t i = 0; i < nLength; i++) {
+		if (!bus_put(pData[i] & 0x0F, 1) || !bus_put(pData[i] >> 4, 0)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool bus_read(uint8_t *pData, uint16_t nLength) {
+	for (uint32_t i = 0; i < nLength; i++) {
+		uint8_t nLow, nHigh;
+
+		if (!bus_get(nLow, 1) || !bus_get(nHigh, 0)) {
+			return false;
+		}
+
+		pData[i] = static_cast<uint8_t>(nLow | (nHigh << 4));
+	}
+
+	return true;
+}
+
+static uint32_t s_nSeed = 1;
+
+static uint32_t random_next(void) {
+	s_nSeed = s_nSeed * 1103515245 + 12345;
+	return s_nSeed >> 16;
+}
+
+static void frame_fill(uint8_t *pHeader, uint8_t *pData, uint32_t nLength) {
+	for (uint32_t i = 0; i < ESP8266_BURST_UDP_HEADER_SIZE; i++) {
+		pHeader[i] = static_cast<uint8_t>(random_next());
+	}
+
+	for (uint32_t i = 0; i < nLength; i++) {
+		pData[i] = static_cast<uint8_t>(random_next());
+	}
+}
+
+/*
+ * Send and receive one frame, the receive is done after the send
+ */
+static int32_t transfer(const uint8_t *pHeader, const uint8_t *pData, uint16_t nLength, uint8_t *pHeaderIn, uint8_t *pDataIn, uint16_t nSize, bool &bIsSent) {
+	bIsSent = esp8266_burst_send(bus_write, pHeader, ESP8266_BURST_UDP_HEADER_SIZE, pData, nLength);
+	const int32_t nReceived = esp8266_burst_receive(bus_read, pHeaderIn, ESP8266_BURST_UDP_HEADER_SIZE, pDataIn, nSize);
+	bus_settle();
+
+	return nReceived;
+}
+
+static int run_round_trip(uint32_t nFrames) {
+	uint8_t aHeader[ESP8266_BURST_UDP_HEADER_SIZE], aHeaderIn[ESP8266_BURST_UDP_HEADER_SIZE];
+	uint8_t aData[MAX_PAYLOAD], aDataIn[MAX_PAYLOAD];
+	uint32_t nBytes = 0;
+	uint32_t nErrors = 0;
+
+	bus_reset();
+
+	for (uint32_t nFrame = 0; nFrame < nFrames; nFrame++) {
+		const uint16_t nLength = static_cast<uint16_t>(random_next() % (RECEIVE_SIZE + 1));
+		bool bIsSent;
+
+		frame_fill(aHeader, aData, nLength);
+
+		const int32_t nReceived = transfer(aHeader, aData, nLength, aHeaderIn, aDataIn, RECEIVE_SIZE, bIsSent);
+
+		if (!bIsSent || (nReceived != nLength) || (memcmp(aHeader, aHeaderIn, sizeof(aHeader)) != 0) || (memcmp(aData, aDataIn, nLength) != 0)) {
+			if (nErrors < 4) {
+				printf("  FAIL      : frame %u, length %u, received %d\n", nFrame, nLength, nReceived);
+			}
+			nErrors++;
+		}
+
+		nBytes += ESP8266_BURST_LENGTH_SIZE + ESP8266_BURST_UDP_HEADER_SIZE + nLength + ESP8266_BURST_CRC_SIZE;
+	}
+
+	if ((s_Bus.nTimeouts != 0) || (s_Bus.nLevelErrors != 0) || (s_Bus.nEdges != (2 * nBytes))) {
+		printf("  FAIL      : %u timeouts, %u level errors, %u edges for %u bytes\n", s_Bus.nTimeouts, s_Bus.nLevelErrors, s_Bus.nEdges, nBytes);
+		nErrors++;
+	}
+
+	printf(" Round trip : %u frames, %u bytes, %u edges, %u errors\n", nFrames, nBytes, s_Bus.nEdges, nErrors);
+
+	return (nErrors == 0) ? 0 : -1;
+}
+
+/*
+ * An empty frame is what the firmware sends when there is no datagram
+ */
+static int run_empty(void) {
+	uint8_t aHeaderIn[ESP8266_BURST_UDP_HEADER_SIZE];
+	uint8_t aDataIn[RECEIVE_SIZE];
+
+	bus_reset();
+
+	const bool bIsSent = esp8266_burst_send(bus_write, 0, 0, 0, 0);
+	const int32_t nReceived = esp8266_burst_receive(bus_read, aHeaderIn, ESP8266_BURST_UDP_HEADER_SIZE, aDataIn, RECEIVE_SIZE);
+	bus_settle();
+
+	printf(" Empty      : received %d, %u edges\n", nReceived, s_Bus.nEdges);
+
+	if (!bIsSent || (nReceived != 0) || (s_Bus.nEdges != (2 * (ESP8266_BURST_LENGTH_SIZE + ESP8266_BURST_CRC_SIZE))) || (s_Bus.nTimeouts != 0)) {
+		printf("  FAIL      : empty frame\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Every bit of every nibble of a frame is flipped. The frame must be rejected,
+ * the next frame must be received.
+ */
+static int run_bit_errors(void) {
+	uint8_t aHeader[ESP8266_BURST_UDP_HEADER_SIZE], aHeaderIn[ESP8266_BURST_UDP_HEADER_SIZE];
+	uint8_t aData[64], aDataIn[64];
+	const uint16_t nLength = 16;
+	const uint32_t nNibbles = 2 * (ESP8266_BURST_LENGTH_SIZE + ESP8266_BURST_UDP_HEADER_SIZE + nLength + ESP8266_BURST_CRC_SIZE);
+	uint32_t nCrc = 0, nLengthErrors = 0, nTimeouts = 0;
+	uint32_t nErrors = 0;
+
+	for (uint32_t nNibble = 0; nNibble < nNibbles; nNibble++) {
+		for (uint32_t nBit = 0; nBit < 4; nBit++) {
+			bool bIsSent;
+
+			bus_reset();
+			s_Bus.nCorrupt = nNibble;
+			s_Bus.nCorruptMask = static_cast<uint8_t>(1U << nBit);
+
+			frame_fill(aHeader, aData, nLength);
+
+			const int32_t nReceived = transfer(aHeader, aData, nLength, aHeaderIn, aDataIn, sizeof(aDataIn), bIsSent);
+
+			if (nReceived == ESP8266_BURST_ERROR_CRC) {
+				nCrc++;
+			} else if (nReceived == ESP8266_BURST_ERROR_LENGTH) {
+				nLengthErrors++;
+			} else if (nReceived == ESP8266_BURST_ERROR_TIMEOUT) {
+				nTimeouts++;
+			} else {
+				printf("  FAIL      : nibble %u bit %u not detected, received %d\n", nNibble, nBit, nReceived);
+				nErrors++;
+			}
+
+			// Back in lock-step
+			s_Bus.nCorrupt = NO_ERROR;
+			frame_fill(aHeader, aData, nLength);
+
+			if (transfer(aHeader, aData, nLength, aHeaderIn, aDataIn, sizeof(aDataIn), bIsSent) != nLength) {
+				printf("  FAIL      : nibble %u bit %u, next frame lost\n", nNibble, nBit);
+				nErrors++;
+			}
+		}
+	}
+
+	printf(" Bit errors : %u injected, %u crc, %u length, %u timeout, %u errors\n", nNibbles * 4, nCrc, nLengthErrors, nTimeouts, nErrors);
+
+	return (nErrors == 0) ? 0 : -1;
+}
+
+/*
+ * The data beyond the receive buffer is clocked and checked, not stored
+ */
+static int run_oversized(void) {
+	uint8_t aHeader[ESP8266_BURST_UDP_HEADER_SIZE], aHeaderIn[ESP8266_BURST_UDP_HEADER_SIZE];
+	uint8_t aData[MAX_PAYLOAD], aDataIn[MAX_PAYLOAD];
+	uint32_t nErrors = 0;
+	bool bIsSent;
+
+	bus_reset();
+
+	frame_fill(aHeader, aData, MAX_PAYLOAD);
+	memset(aDataIn, 0xAA, sizeof(aDataIn));
+
+	const int32_t nReceived = transfer(aHeader, aData, MAX_PAYLOAD, aHeaderIn, aDataIn, RECEIVE_SIZE, bIsSent);
+
+	if ((nReceived != MAX_PAYLOAD) || (memcmp(aData, aDataIn, RECEIVE_SIZE) != 0) || (aDataIn[RECEIVE_SIZE] != 0xAA) || (s_Bus.nTimeouts != 0)) {
+		printf("  FAIL      : oversized, received %d, %u timeouts\n", nReceived, s_Bus.nTimeouts);
+		nErrors++;
+	}
+
+	frame_fill(aHeader, aData, 100);
+
+	if (transfer(aHeader, aData, 100, aHeaderIn, aDataIn, RECEIVE_SIZE, bIsSent) != 100) {
+		printf("  FAIL      : oversized, next frame lost\n");
+		nErrors++;
+	}
+
+	printf(" Oversized  : %u bytes, %u stored, %u errors\n", MAX_PAYLOAD, RECEIVE_SIZE, nErrors);
+
+	return (nErrors == 0) ? 0 : -1;
+}
+
+/*
+ * The link breaks after n nibbles. Both sides must give up within their
+ * timeouts, the next frame must be received.
+ */
+static int run_link_break(void) {
+	uint8_t aHeader[ESP8266_BURST_UDP_HEADER_SIZE], aHeaderIn[ESP8266_BURST_UDP_HEADER_SIZE];
+	uint8_t aData[256], aDataIn[256];
+	const uint16_t nLength = 200;
+	const uint32_t nNibbles = 2 * (ESP8266_BURST_LENGTH_SIZE + ESP8266_BURST_UDP_HEADER_SIZE + nLength + ESP8266_BURST_CRC_SIZE);
+	uint32_t nBreaks = 0;
+	uint64_t nMaxMicros = 0;
+	uint32_t nErrors = 0;
+
+	for (uint32_t nBreakAfter = 0; nBreakAfter < nNibbles; nBreakAfter += 7) {
+		bool bIsSent;
+
+		bus_reset();
+		s_Bus.nBreakAfter = nBreakAfter;
+
+		frame_fill(aHeader, aData, nLength);
+
+		const int32_t nReceived = transfer(aHeader, aData, nLength, aHeaderIn, aDataIn, sizeof(aDataIn), bIsSent);
+		// Each side waits at most one timeout
+		const uint64_t nMicros = s_Bus.nMicros - nBreakAfter;
+
+		if (bIsSent || (nReceived != ESP8266_BURST_ERROR_TIMEOUT) || (nMicros > (2 * ESP8266_BURST_TIMEOUT_US))) {
+			printf("  FAIL      : break after %u nibbles, sent %d, received %d, %u us\n", nBreakAfter, bIsSent, nReceived, static_cast<uint32_t>(nMicros));
+			nErrors++;
+		}
+
+		if (nMicros > nMaxMicros) {
+			nMaxMicros = nMicros;
+		}
+
+		s_Bus.nBreakAfter = NO_ERROR;
+		frame_fill(aHeader, aData, nLength);
+
+		if (transfer(aHeader, aData, nLength, aHeaderIn, aDataIn, sizeof(aDataIn), bIsSent) != nLength) {
+			printf("  FAIL      : break after %u nibbles, next frame lost\n", nBreakAfter);
+			nErrors++;
+		}
+
+		nBreaks++;
+	}
+
+	printf(" Link break : %u breaks, max %u us stalled, %u errors\n", nBreaks, static_cast<uint32_t>(nMaxMicros), nErrors);
+
+	return (nErrors == 0) ? 0 : -1;
+}
+
+/*
+ * The negotiation of esp8266_burst.h, as wifi_udp_negotiate_burst() and the
+ * firmware (user_main.c) do it
+ */
+struct TFirmware {
+	bool bHasBurst;
+	bool bIsBurst;
+};
+
+static const char *firmware_version(struct TFirmware &firmware) {
+	firmware.bIsBurst = false;
+	return firmware.bHasBurst ? "Compiled on Jan  1 2020 at 00:00:00 " ESP8266_BURST_SIGNATURE : "Compiled on Jan  1 2020 at 00:00:00";
+}
+
+/*
+ * @return the reply byte, -1 when the firmware does not reply
+ */
+static int firmware_udp_begin(struct TFirmware &firmware, uint16_t nPort) {
+	if (firmware.bHasBurst && (nPort == ESP8266_BURST_REQUEST_PORT)) {
+		firmware.bIsBurst = true;
+		return ESP8266_BURST_ACK;
+	}
+
+	return -1;
+}
+
+static bool host_start(struct TFirmware &firmware, bool bHasBurst) {
+	const char *pVersion = firmware_version(firmware);
+
+	if (!bHasBurst || (strstr(pVersion, ESP8266_BURST_SIGNATURE) == 0)) {
+		return false;
+	}
+
+	return (firmware_udp_begin(firmware, ESP8266_BURST_REQUEST_PORT) == ESP8266_BURST_ACK);
+}
+
+static int run_negotiation(void) {
+	uint32_t nErrors = 0;
+
+	for (uint32_t i = 0; i < 4; i++) {
+		const bool bHostHasBurst = (i & 1) != 0;
+		struct TFirmware firmware;
+
+		firmware.bHasBurst = (i & 2) != 0;
+		firmware.bIsBurst = false;
+
+		const bool bHostIsBurst = host_start(firmware, bHostHasBurst);
+
+		if ((bHostIsBurst != firmware.bIsBurst) || (bHostIsBurst != (bHostHasBurst && firmware.bHasBurst))) {
+			printf("  FAIL      : host %s, firmware %s: host burst %d, firmware burst %d\n", bHostHasBurst ? "new" : "old", firmware.bHasBurst ? "new" : "old", bHostIsBurst, firmware.bIsBurst);
+			nErrors++;
+		}
+
+		// An old host is started, the firmware keeps running
+		if (host_start(firmware, false) || firmware.bIsBurst) {
+			printf("  FAIL      : host %s, firmware %s: burst after a restart with an old host\n", bHostHasBurst ? "new" : "old", firmware.bHasBurst ? "new" : "old");
+			nErrors++;
+		}
+	}
+
+	printf(" Negotiate  : 4 combinations, %u errors\n", nErrors);
+
+	return (nErrors == 0) ? 0 : -1;
+}
+
+int esp8266_benchmark(uint32_t nFrames) {
+	printf("Benchmark esp8266, timeout %u us\n", ESP8266_BURST_TIMEOUT_US);
+
+	int nResult = 0;
+
+	nResult |= run_round_trip(nFrames);
+	nResult |= run_empty();
+	nResult |= run_bit_errors();
+	nResult |= run_oversized();
+	nResult |= run_link_break();
+	nResult |= run_negotiation();
+
+	puts(nResult == 0 ? "PASS" : "FAIL");
+
+	return nResult;
+}
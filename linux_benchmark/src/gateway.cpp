@@ -0,0 +1,588 @@
+/**
+ * @file gateway.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "networkpcap.h"
+
+#include "artnete131gateway.h"
+
+#include "artnet.h"
+#include "packets.h"
+#include "e131.h"
+#include "e131packets.h"
+#include "e117const.h"
+
+#include "benchmark.h"
+
+/*
+ * The ArtNetE131Gateway with synthetic packets. The packets sent by the
+ * gateway are captured with the send hook and decoded. Checked are:
+ * - Art-Net Port-Addresses are sent as the mapped sACN universes, with the
+ *   same data, and sACN universes as the mapped Port-Addresses, an odd slot
+ *   count padded with a zero slot;
+ * - unmapped universes, preview data and the own packets are not forwarded;
+ * - with two sources the output is the HTP merge, a third source is discarded;
+ * - ArtSync is sent as an E1.31 synchronization packet on the synchronization
+ *   address, and the E1.31 synchronization of a received universe as ArtSync;
+ * - the statistics of the gateway agree.
+ */
+
+#define GATEWAY_MAPPINGS		2
+#define GATEWAY_ARTNET_FROM		1		///< Port-Address 1 and 2 ...
+#define GATEWAY_SACN_TO			101		///< ... are sent as universe 101 and 102
+#define GATEWAY_SACN_FROM		201		///< Universe 201 and 202 ...
+#define GATEWAY_ARTNET_TO		16		///< ... are sent as Port-Address 16 and 17
+#define GATEWAY_UNMAPPED		300
+#define GATEWAY_PRIORITY		120
+#define GATEWAY_SYNC_ADDRESS	4000	///< The gateway sends the ArtSync here
+#define GATEWAY_SACN_SYNC		7000	///< The sACN source sends its synchronization here
+
+#define SOURCE_A				0x0102A8C0	// 192.168.2.1
+#define SOURCE_B				0x0202A8C0
+#define SOURCE_C				0x0302A8C0
+
+#define MAX_PACKETS				8
+#define MAX_OUTPUTS				16
+
+struct TGatewayOutput {
+	uint8_t aData[sizeof(struct TE131DataPacket)];
+	uint16_t nLength;
+	uint16_t nPort;
+	uint32_t nToIp;
+};
+
+static uint8_t s_Packets[MAX_PACKETS][sizeof(struct TE131DataPacket)];
+static uint32_t s_nPackets;
+
+static struct TGatewayOutput s_Outputs[MAX_OUTPUTS];
+static uint32_t s_nOutputs;
+static uint32_t s_nOverflows;
+
+static struct TArtNetE131GatewayStats s_Expected;
+
+static void send_hook(const uint8_t *pBuffer, uint16_t nLength, uint32_t nToIp, uint16_t nRemotePort) {
+	if (s_nOutputs == MAX_OUTPUTS) {
+		s_nOverflows++;
+		return;
+	}
+
+	struct TGatewayOutput *pOutput = &s_Outputs[s_nOutputs++];
+
+	pOutput->nLength = (nLength < sizeof(pOutput->aData)) ? nLength : sizeof(pOutput->aData);
+	pOutput->nPort = nRemotePort;
+	pOutput->nToIp = nToIp;
+
+	memcpy(pOutput->aData, pBuffer, pOutput->nLength);
+}
+
+static uint8_t slot_value(uint32_t nSeed, uint32_t nSlot) {
+	return static_cast<uint8_t>((nSeed * 37) + (nSlot * 3));
+}
+
+static uint32_t multicast_ip(uint16_t nUniverse) {
+	return 0x0000FFEF | ((nUniverse & 0xFF) << 24) | ((nUniverse & 0xFF00) << 8);
+}
+
+static void add_artdmx(NetworkPcap &nw, uint16_t nPortAddress, uint16_t nSlots, uint32_t nSeed, uint32_t nFromIp) {
+	struct TArtDmx *pArtDmx = reinterpret_cast<struct TArtDmx *>(s_Packets[s_nPackets++]);
+
+	memset(pArtDmx, 0, sizeof(struct TArtDmx));
+	memcpy(pArtDmx->Id, "Art-Net", 8);
+	pArtDmx->OpCode = OP_DMX;
+	pArtDmx->ProtVerLo = ARTNET_PROTOCOL_REVISION;
+	pArtDmx->PortAddress = nPortAddress;
+	pArtDmx->LengthHi = static_cast<uint8_t>(nSlots >> 8);
+	pArtDmx->Length = static_cast<uint8_t>(nSlots);
+
+	for (uint32_t i = 0; i < nSlots; i++) {
+		pArtDmx->Data[i] = slot_value(nSeed, i);
+	}
+
+	nw.Add(reinterpret_cast<uint8_t *>(pArtDmx), static_cast<uint16_t>(sizeof(struct TArtDmx) - ARTNET_DMX_LENGTH + nSlots), nFromIp, ARTNET_UDP_PORT, ARTNET_UDP_PORT);
+}
+
+static void add_artsync(NetworkPcap &nw, uint32_t nFromIp) {
+	struct TArtSync *pArtSync = reinterpret_cast<struct TArtSync *>(s_Packets[s_nPackets++]);
+
+	memset(pArtSync, 0, sizeof(struct TArtSync));
+	memcpy(pArtSync->Id, "Art-Net", 8);
+	pArtSync->OpCode = OP_SYNC;
+	pArtSync->ProtVerLo = ARTNET_PROTOCOL_REVISION;
+
+	nw.Add(reinterpret_cast<uint8_t *>(pArtSync), sizeof(struct TArtSync), nFromIp, ARTNET_UDP_PORT, ARTNET_UDP_PORT);
+}
+
+static void fill_root_layer(struct TRootLayer *pRootLayer, uint32_t nVector) {
+	pRootLayer->PreAmbleSize = __builtin_bswap16(0x0010);
+	memcpy(pRootLayer->ACNPacketIdentifier, E117Const::ACN_PACKET_IDENTIFIER, E117_PACKET_IDENTIFIER_LENGTH);
+	pRootLayer->Vector = __builtin_bswap32(nVector);
+	memset(pRootLayer->Cid, 0xA0, E131_CID_LENGTH);
+}
+
+static void add_e131(NetworkPcap &nw, uint16_t nUniverse, uint16_t nSlots, uint32_t nSeed, uint32_t nFromIp, uint16_t nSynchronizationAddress = 0, uint8_t nOptions = 0) {
+	struct TE131DataPacket *pPacket = reinterpret_cast<struct TE131DataPacket *>(s_Packets[s_nPackets++]);
+
+	memset(pPacket, 0, sizeof(struct TE131DataPacket));
+
+	fill_root_layer(&pPacket->RootLayer, E131_VECTOR_ROOT_DATA);
+
+	pPacket->FrameLayer.Vector = __builtin_bswap32(E131_VECTOR_DATA_PACKET);
+	pPacket->FrameLayer.Priority = E131_PRIORITY_DEFAULT;
+	pPacket->FrameLayer.SynchronizationAddress = __builtin_bswap16(nSynchronizationAddress);
+	pPacket->FrameLayer.Options = nOptions;
+	pPacket->FrameLayer.Universe = __builtin_bswap16(nUniverse);
+
+	pPacket->DMPLayer.Vector = E131_VECTOR_DMP_SET_PROPERTY;
+	pPacket->DMPLayer.Type = 0xa1;
+	pPacket->DMPLayer.FirstAddressProperty = __builtin_bswap16(0x0000);
+	pPacket->DMPLayer.AddressIncrement = __builtin_bswap16(0x0001);
+	pPacket->DMPLayer.PropertyValueCount = __builtin_bswap16(static_cast<uint16_t>(1 + nSlots));
+	pPacket->DMPLayer.PropertyValues[0] = E131_START_CODE_DMX;
+
+	for (uint32_t i = 0; i < nSlots; i++) {
+		pPacket->DMPLayer.PropertyValues[1 + i] = slot_value(nSeed, i);
+	}
+
+	nw.Add(reinterpret_cast<uint8_t *>(pPacket), static_cast<uint16_t>(DATA_PACKET_SIZE(1 + nSlots)), nFromIp, E131_DEFAULT_PORT, E131_DEFAULT_PORT);
+}
+
+static void add_e131_sync(NetworkPcap &nw, uint16_t nUniverse, uint32_t nFromIp) {
+	struct TE131SynchronizationPacket *pPacket = reinterpret_cast<struct TE131SynchronizationPacket *>(s_Packets[s_nPackets++]);
+
+	memset(pPacket, 0, sizeof(struct TE131SynchronizationPacket));
+
+	fill_root_layer(&pPacket->RootLayer, E131_VECTOR_ROOT_EXTENDED);
+
+	pPacket->FrameLayer.Vector = __builtin_bswap32(E131_VECTOR_EXTENDED_SYNCHRONIZATION);
+	pPacket->FrameLayer.UniverseNumber = __builtin_bswap16(nUniverse);
+
+	nw.Add(reinterpret_cast<uint8_t *>(pPacket), SYNCHRONIZATION_PACKET_SIZE, nFromIp, E131_DEFAULT_PORT, E131_DEFAULT_PORT);
+}
+
+/*
+ * All the added packets are received by the gateway, what it sends is in s_Outputs
+ */
+static void feed(NetworkPcap &nw, ArtNetE131Gateway &gateway) {
+	// The received counter is not reset by Create()
+	const uint32_t nReceived = nw.GetReceived();
+
+	s_nOutputs = 0;
+
+	nw.Rewind();
+	nw.SetAvailable(s_nPackets);
+
+	for (uint32_t i = 0; (i < 1000) && ((nw.GetReceived() - nReceived) < s_nPackets); i++) {
+		gateway.Run();
+	}
+}
+
+static void begin(NetworkPcap &nw) {
+	s_nPackets = 0;
+	nw.Create(MAX_PACKETS);
+}
+
+static const struct TArtDmx *get_artdmx(const struct TGatewayOutput *pOutput) {
+	const struct TArtDmx *pArtDmx = reinterpret_cast<const struct TArtDmx *>(pOutput->aData);
+
+	if ((pOutput->nPort != ARTNET_UDP_PORT) || (pOutput->nLength <= (sizeof(struct TArtDmx) - ARTNET_DMX_LENGTH)) || (pArtDmx->OpCode != OP_DMX)) {
+		return 0;
+	}
+
+	return pArtDmx;
+}
+
+static bool is_artsync(const struct TGatewayOutput *pOutput) {
+	const struct TArtSync *pArtSync = reinterpret_cast<const struct TArtSync *>(pOutput->aData);
+
+	return (pOutput->nPort == ARTNET_UDP_PORT) && (pOutput->nLength == sizeof(struct TArtSync)) && (pArtSync->OpCode == OP_SYNC);
+}
+
+static const struct TE131DataPacket *get_e131(const struct TGatewayOutput *pOutput) {
+	const struct TE131DataPacket *pPacket = reinterpret_cast<const struct TE131DataPacket *>(pOutput->aData);
+
+	if ((pOutput->nPort != E131_DEFAULT_PORT) || (pOutput->nLength < DATA_PACKET_SIZE(1)) || (pPacket->RootLayer.Vector != __builtin_bswap32(E131_VECTOR_ROOT_DATA))) {
+		return 0;
+	}
+
+	return pPacket;
+}
+
+static const struct TE131SynchronizationPacket *get_e131_sync(const struct TGatewayOutput *pOutput) {
+	const struct TE131SynchronizationPacket *pPacket = reinterpret_cast<const struct TE131SynchronizationPacket *>(pOutput->aData);
+
+	if ((pOutput->nPort != E131_DEFAULT_PORT)
+			|| (pOutput->nLength != SYNCHRONIZATION_PACKET_SIZE)
+			|| (pPacket->RootLayer.Vector != __builtin_bswap32(E131_VECTOR_ROOT_EXTENDED))
+			|| (pPacket->FrameLayer.Vector != __builtin_bswap32(E131_VECTOR_EXTENDED_SYNCHRONIZATION))) {
+		return 0;
+	}
+
+	return pPacket;
+}
+
+/*
+ * The expected slot: of one source, or the HTP merge of two (nSeedB != 0)
+ */
+static uint8_t expected_slot(uint32_t nSeedA, uint32_t nSeedB, uint32_t nSlot) {
+	const uint8_t nA = slot_value(nSeedA, nSlot);
+
+	if (nSeedB == 0) {
+		return nA;
+	}
+
+	const uint8_t nB = slot_value(nSeedB, nSlot);
+
+	return (nA > nB) ? nA : nB;
+}
+
+/*
+ * The nIndex-th sACN data packet sent must be universe nUniverse with these slots
+ */
+static uint32_t check_e131(uint32_t nIndex, uint16_t nUniverse, uint16_t nSlots, uint32_t nSeedA, uint32_t nSeedB = 0) {
+	const struct TE131DataPacket *pPacket = 0;
+	const struct TGatewayOutput *pOutput = 0;
+
+	for (uint32_t i = 0, nCount = 0; i < s_nOutputs; i++) {
+		if (get_e131(&s_Outputs[i]) != 0) {
+			if (nCount++ == nIndex) {
+				pOutput = &s_Outputs[i];
+				pPacket = get_e131(pOutput);
+				break;
+			}
+		}
+	}
+
+	if (pPacket == 0) {
+		printf("  FAIL      : no sACN universe %u\n", nUniverse);
+		return 1;
+	}
+
+	const uint16_t nUniverseSent = __builtin_bswap16(pPacket->FrameLayer.Universe);
+	const uint16_t nSlotsSent = static_cast<uint16_t>(__builtin_bswap16(pPacket->DMPLayer.PropertyValueCount) - 1);
+
+	if ((nUniverseSent != nUniverse) || (nSlotsSent != nSlots) || (pOutput->nLength != DATA_PACKET_SIZE(1 + nSlots))) {
+		printf("  FAIL      : sACN universe %u with %u slots, expected universe %u with %u slots\n", nUniverseSent, nSlotsSent, nUniverse, nSlots);
+		return 1;
+	}
+
+	if ((pOutput->nToIp != multicast_ip(nUniverse)) || (pPacket->FrameLayer.Priority != GATEWAY_PRIORITY) || (pPacket->DMPLayer.PropertyValues[0] != E131_START_CODE_DMX)) {
+		printf("  FAIL      : sACN universe %u, destination, priority %u or start code\n", nUniverse, pPacket->FrameLayer.Priority);
+		return 1;
+	}
+
+	for (uint32_t i = 0; i < nSlots; i++) {
+		if (pPacket->DMPLayer.PropertyValues[1 + i] != expected_slot(nSeedA, nSeedB, i)) {
+			printf("  FAIL      : sACN universe %u, slot %u is %u, expected %u\n", nUniverse, i, pPacket->DMPLayer.PropertyValues[1 + i], expected_slot(nSeedA, nSeedB, i));
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * The nIndex-th ArtDmx sent must be Port-Address nPortAddress with these slots,
+ * nSlots is the received slot count: an odd count is padded with a zero slot
+ */
+static uint32_t check_artdmx(NetworkPcap &nw, uint32_t nIndex, uint16_t nPortAddress, uint16_t nSlots, uint32_t nSeedA, uint32_t nSeedB = 0) {
+	const struct TArtDmx *pArtDmx = 0;
+	const struct TGatewayOutput *pOutput = 0;
+
+	for (uint32_t i = 0, nCount = 0; i < s_nOutputs; i++) {
+		if (get_artdmx(&s_Outputs[i]) != 0) {
+			if (nCount++ == nIndex) {
+				pOutput = &s_Outputs[i];
+				pArtDmx = get_artdmx(pOutput);
+				break;
+			}
+		}
+	}
+
+	if (pArtDmx == 0) {
+		printf("  FAIL      : no ArtDmx Port-Address %u\n", nPortAddress);
+		return 1;
+	}
+
+	const uint16_t nLength = static_cast<uint16_t>((pArtDmx->LengthHi << 8) | pArtDmx->Length);
+	const uint16_t nExpectedLength = static_cast<uint16_t>((nSlots + 1) & ~1);
+
+	if ((pArtDmx->PortAddress != nPortAddress) || (nLength != nExpectedLength) || (pOutput->nLength != (sizeof(struct TArtDmx) - ARTNET_DMX_LENGTH + nLength))) {
+		printf("  FAIL      : ArtDmx Port-Address %u with %u slots, expected Port-Address %u with %u slots\n", pArtDmx->PortAddress, nLength, nPortAddress, nExpectedLength);
+		return 1;
+	}
+
+	if (pOutput->nToIp != nw.GetBroadcastIp()) {
+		printf("  FAIL      : ArtDmx Port-Address %u is not broadcast\n", nPortAddress);
+		return 1;
+	}
+
+	for (uint32_t i = 0; i < nLength; i++) {
+		const uint8_t nExpected = (i < nSlots) ? expected_slot(nSeedA, nSeedB, i) : 0;
+
+		if (pArtDmx->Data[i] != nExpected) {
+			printf("  FAIL      : ArtDmx Port-Address %u, slot %u is %u, expected %u\n", nPortAddress, i, pArtDmx->Data[i], nExpected);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * The number of sent packets of a kind
+ */
+static uint32_t count_outputs(uint32_t& nArtDmx, uint32_t& nArtSync, uint32_t& nE131, uint32_t& nE131Sync) {
+	nArtDmx = 0;
+	nArtSync = 0;
+	nE131 = 0;
+	nE131Sync = 0;
+
+	for (uint32_t i = 0; i < s_nOutputs; i++) {
+		if (get_artdmx(&s_Outputs[i]) != 0) {
+			nArtDmx++;
+		} else if (is_artsync(&s_Outputs[i])) {
+			nArtSync++;
+		} else if (get_e131(&s_Outputs[i]) != 0) {
+			nE131++;
+		} else if (get_e131_sync(&s_Outputs[i]) != 0) {
+			nE131Sync++;
+		}
+	}
+
+	return nArtDmx + nArtSync + nE131 + nE131Sync;
+}
+
+static uint32_t check_counts(const char *pStep, uint32_t nArtDmx, uint32_t nArtSync, uint32_t nE131, uint32_t nE131Sync) {
+	uint32_t nCount[4];
+
+	count_outputs(nCount[0], nCount[1], nCount[2], nCount[3]);
+
+	if ((nCount[0] != nArtDmx) || (nCount[1] != nArtSync) || (nCount[2] != nE131) || (nCount[3] != nE131Sync)) {
+		printf("  FAIL      : %s sent ArtDmx %u, ArtSync %u, sACN %u, sACN sync %u, expected %u, %u, %u, %u\n",
+				pStep, nCount[0], nCount[1], nCount[2], nCount[3], nArtDmx, nArtSync, nE131, nE131Sync);
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Port-Address 5 is not mapped, the gateway does not receive its own packets
+ */
+static int run_artnet_to_sacn(NetworkPcap &nw, ArtNetE131Gateway &gateway) {
+	uint32_t nErrors = 0;
+
+	begin(nw);
+	add_artdmx(nw, GATEWAY_ARTNET_FROM, 512, 1, SOURCE_A);
+	add_artdmx(nw, GATEWAY_ARTNET_FROM + 1, 100, 2, SOURCE_A);
+	add_artdmx(nw, 5, 512, 3, SOURCE_A);
+	add_artdmx(nw, GATEWAY_ARTNET_FROM, 512, 4, nw.GetIp());
+	feed(nw, gateway);
+
+	s_Expected.nArtNetToSacn += 2;
+
+	nErrors += check_counts("Art-Net", 0, 0, 2, 0);
+	nErrors += check_e131(0, GATEWAY_SACN_TO, 512, 1);
+	nErrors += check_e131(1, GATEWAY_SACN_TO + 1, 100, 2);
+
+	printf(" Art-Net    : %u -> %u, %u -> %u, %u errors\n", GATEWAY_ARTNET_FROM, GATEWAY_SACN_TO, GATEWAY_ARTNET_FROM + 1, GATEWAY_SACN_TO + 1, nErrors);
+
+	return (nErrors == 0) ? 0 : -1;
+}
+
+/*
+ * Universe 300 is not mapped, preview data is not forwarded
+ */
+static int run_sacn_to_artnet(NetworkPcap &nw, ArtNetE131Gateway &gateway) {
+	uint32_t nErrors = 0;
+
+	begin(nw);
+	add_e131(nw, GATEWAY_SACN_FROM, 512, 5, SOURCE_A);
+	add_e131(nw, GATEWAY_SACN_FROM + 1, 101, 6, SOURCE_A);
+	add_e131(nw, GATEWAY_UNMAPPED, 512, 7, SOURCE_A);
+	add_e131(nw, GATEWAY_SACN_FROM, 512, 8, SOURCE_A, 0, E131_OPTIONS_MASK_PREVIEW_DATA);
+	feed(nw, gateway);
+
+	s_Expected.nSacnToArtNet += 2;
+
+	nErrors += check_counts("sACN", 2, 0, 0, 0);
+	nErrors += check_artdmx(nw, 0, GATEWAY_ARTNET_TO, 512, 5);
+	nErrors += check_artdmx(nw, 1, GATEWAY_ARTNET_TO + 1, 101, 6);
+
+	printf(" sACN       : %u -> %u, %u -> %u, %u errors\n", GATEWAY_SACN_FROM, GATEWAY_ARTNET_TO, GATEWAY_SACN_FROM + 1, GATEWAY_ARTNET_TO + 1, nErrors);
+
+	return (nErrors == 0) ? 0 : -1;
+}
+
+/*
+ * Source A already sent to both universes, without merge. The first packet of
+ * source B is sent as is, source A has nothing stored. The next packet of
+ * source A is merged with source B. A third source is discarded.
+ */
+static int run_merge(NetworkPcap &nw, ArtNetE131Gateway &gateway) {
+	uint32_t nErrors = 0;
+
+	begin(nw);
+	add_artdmx(nw, GATEWAY_ARTNET_FROM, 512, 9, SOURCE_B);
+	add_artdmx(nw, GATEWAY_ARTNET_FROM, 512, 10, SOURCE_A);
+	add_e131(nw, GATEWAY_SACN_FROM, 512, 11, SOURCE_B);
+	add_e131(nw, GATEWAY_SACN_FROM, 512, 12, SOURCE_A);
+	add_e131(nw, GATEWAY_SACN_FROM, 512, 13, SOURCE_C);
+	feed(nw, gateway);
+
+	s_Expected.nArtNetToSacn += 2;
+	s_Expected.nSacnToArtNet += 2;
+	s_Expected.nMerged += 2;
+	s_Expected.nDiscarded += 1;
+
+	nErrors += check_counts("Merge", 2, 0, 2, 0);
+	nErrors += check_e131(0, GATEWAY_SACN_TO, 512, 9);
+	nErrors += check_e131(1, GATEWAY_SACN_TO, 512, 10, 9);
+	nErrors += check_artdmx(nw, 0, GATEWAY_ARTNET_TO, 512, 11);
+	nErrors += check_artdmx(nw, 1, GATEWAY_ARTNET_TO, 512, 12, 11);
+
+	printf(" Merge      : HTP of 2 sources, a third discarded, %u errors\n", nErrors);
+
+	return (nErrors == 0) ? 0 : -1;
+}
+
+/*
+ * ArtSync is sent as sACN synchronization on GATEWAY_SYNC_ADDRESS, the data
+ * after the first ArtSync refers to it. The sACN source synchronizes on
+ * GATEWAY_SACN_SYNC, a synchronization on another address is not forwarded.
+ */
+static int run_sync(NetworkPcap &nw, ArtNetE131Gateway &gateway) {
+	uint32_t nErrors = 0;
+
+	begin(nw);
+	add_artdmx(nw, GATEWAY_ARTNET_FROM + 1, 512, 14, SOURCE_A);
+	add_artsync(nw, SOURCE_A);
+	add_artdmx(nw, GATEWAY_ARTNET_FROM + 1, 512, 15, SOURCE_A);
+	add_artsync(nw, SOURCE_A);
+	feed(nw, gateway);
+
+	s_Expected.nArtNetToSacn += 2;
+	s_Expected.nSync += 2;
+
+	nErrors += check_counts("ArtSync", 0, 0, 2, 2);
+	nErrors += check_e131(1, GATEWAY_SACN_TO + 1, 512, 15);
+
+	// The order: data, sync, data, sync
+	for (uint32_t i = 0; i < s_nOutputs; i++) {
+		const struct TE131SynchronizationPacket *pSync = get_e131_sync(&s_Outputs[i]);
+		const struct TE131DataPacket *pData = get_e131(&s_Outputs[i]);
+
+		if (((i & 0x1) != 0) && ((pSync == 0) || (__builtin_bswap16(pSync->FrameLayer.UniverseNumber) != GATEWAY_SYNC_ADDRESS) || (s_Outputs[i].nToIp != multicast_ip(GATEWAY_SYNC_ADDRESS)))) {
+			printf("  FAIL      : packet %u is not a synchronization on universe %u\n", i, GATEWAY_SYNC_ADDRESS);
+			nErrors++;
+		}
+
+		if ((i == 2) && ((pData == 0) || (__builtin_bswap16(pData->FrameLayer.SynchronizationAddress) != GATEWAY_SYNC_ADDRESS))) {
+			printf("  FAIL      : the data after ArtSync has no synchronization address %u\n", GATEWAY_SYNC_ADDRESS);
+			nErrors++;
+		}
+	}
+
+	begin(nw);
+	add_e131(nw, GATEWAY_SACN_FROM + 1, 512, 16, SOURCE_A, GATEWAY_SACN_SYNC);
+	add_e131_sync(nw, GATEWAY_SACN_SYNC, SOURCE_A);
+	add_e131(nw, GATEWAY_SACN_FROM + 1, 512, 17, SOURCE_A, GATEWAY_SACN_SYNC);
+	add_e131_sync(nw, GATEWAY_SACN_SYNC + 1, SOURCE_A);
+	feed(nw, gateway);
+
+	s_Expected.nSacnToArtNet += 2;
+	s_Expected.nSync += 1;
+
+	nErrors += check_counts("sACN sync", 2, 1, 0, 0);
+
+	if ((s_nOutputs < 2) || !is_artsync(&s_Outputs[1]) || (s_Outputs[1].nToIp != nw.GetBroadcastIp())) {
+		printf("  FAIL      : no broadcast ArtSync after the first ArtDmx\n");
+		nErrors++;
+	}
+
+	printf(" Sync       : ArtSync -> universe %u, universe %u -> ArtSync, %u errors\n", GATEWAY_SYNC_ADDRESS, GATEWAY_SACN_SYNC, nErrors);
+
+	return (nErrors == 0) ? 0 : -1;
+}
+
+static int run_stats(ArtNetE131Gateway &gateway) {
+	const struct TArtNetE131GatewayStats *pStats = gateway.GetStats();
+
+	printf(" Stats      : Art-Net -> sACN %u, sACN -> Art-Net %u, merged %u, discarded %u, sync %u\n",
+			pStats->nArtNetToSacn, pStats->nSacnToArtNet, pStats->nMerged, pStats->nDiscarded, pStats->nSync);
+
+	if (memcmp(pStats, &s_Expected, sizeof(struct TArtNetE131GatewayStats)) != 0) {
+		printf("  FAIL      : expected %u, %u, %u, %u, %u\n",
+				s_Expected.nArtNetToSacn, s_Expected.nSacnToArtNet, s_Expected.nMerged, s_Expected.nDiscarded, s_Expected.nSync);
+		return -1;
+	}
+
+	if (s_nOverflows != 0) {
+		printf("  FAIL      : %u packets not captured\n", s_nOverflows);
+		return -1;
+	}
+
+	return 0;
+}
+
+int gateway_benchmark(NetworkPcap &nw) {
+	ArtNetE131Gateway gateway;
+
+	printf("Benchmark gateway, %u mappings per direction\n", GATEWAY_MAPPINGS);
+
+	if (!gateway.AddMapping(GATEWAY_ARTNET_TO_SACN, GATEWAY_ARTNET_FROM, GATEWAY_SACN_TO, GATEWAY_MAPPINGS)
+			|| !gateway.AddMapping(GATEWAY_SACN_TO_ARTNET, GATEWAY_SACN_FROM, GATEWAY_ARTNET_TO, GATEWAY_MAPPINGS)) {
+		puts("  FAIL      : mapping not added");
+		puts("FAIL");
+		return -1;
+	}
+
+	memset(&s_Expected, 0, sizeof(struct TArtNetE131GatewayStats));
+
+	gateway.SetMergeMode(E131_MERGE_HTP);
+	gateway.SetPriority(GATEWAY_PRIORITY);
+	gateway.SetSynchronizationAddress(GATEWAY_SYNC_ADDRESS);
+
+	nw.SetSendHook(send_hook);
+	gateway.Start();
+
+	int nResult = 0;
+
+	nResult |= run_artnet_to_sacn(nw, gateway);
+	nResult |= run_sacn_to_artnet(nw, gateway);
+	nResult |= run_merge(nw, gateway);
+	nResult |= run_sync(nw, gateway);
+	nResult |= run_stats(gateway);
+
+	gateway.Stop();
+	nw.SetSendHook(0);
+
+	puts(nResult == 0 ? "PASS" : "FAIL");
+
+	return nResult;
+}
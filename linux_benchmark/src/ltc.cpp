@@ -0,0 +1,569 @@
+/**
+ * @file ltc.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ltcdecoder.h"
+#include "ltc.h"
+
+#include "benchmark.h"
+
+/*
+ * The edges of a bi-phase mark LTC signal are generated for a sequence of
+ * frames, with a timing jitter, and fed to the LtcDecoder as the FIQ would.
+ * Run() is called after every edge, as the main loop would.
+ *
+ * From the fourth frame on checked are, after every edge (the timecode is taken
+ * after two contiguous frames, away from nominal speed the first frame is lost
+ * while the bit period converges):
+ * - the timecode is the one of the frame in progress;
+ * - the timeline position (GetPositionUs) is within 1/50 frame of the real position;
+ * - the frame rate and the type, once a complete second has been received.
+ * When the signal stops, the timeline must freewheel for the set number of
+ * frames, one frame per frame period, and then report no signal.
+ *
+ * With replay, recorded edge timings (one time in microseconds per line) are
+ * replayed and the timecodes are printed. While locked, every timecode must
+ * follow the previous one by one frame. With record, the edges of the 25 fps
+ * stream are written in that format.
+ */
+
+#define MAX_FRAMES			256
+#define JITTER_US			4
+
+struct TFrame {
+	struct TLtcTimeCode tTimeCode;
+	uint8_t nFps;
+	bool bDropFrame;
+};
+
+static uint32_t s_nSeed = 1;
+static FILE *s_pRecord;
+
+static int32_t jitter(void) {
+	s_nSeed = s_nSeed * 1103515245 + 12345;
+	return static_cast<int32_t>((s_nSeed >> 16) % (2 * JITTER_US + 1)) - JITTER_US;
+}
+
+static uint32_t frame_nominal_us(const struct TFrame *pFrame) {
+	return pFrame->bDropFrame ? (1001000 / 30) : (1000000 / pFrame->nFps);
+}
+
+static uint8_t timecode_type(const struct TFrame *pFrame) {
+	if (pFrame->bDropFrame) {
+		return TC_TYPE_DF;
+	}
+
+	return (pFrame->nFps == 24) ? TC_TYPE_FILM : ((pFrame->nFps == 25) ? TC_TYPE_EBU : TC_TYPE_SMPTE);
+}
+
+static bool is_dropped(const struct TLtcTimeCode *pTimeCode) {
+	return (pTimeCode->nSeconds == 0) && (pTimeCode->nFrames < 2) && ((pTimeCode->nMinutes % 10) != 0);
+}
+
+static void next_frame(struct TFrame *pFrame) {
+	struct TLtcTimeCode *p = &pFrame->tTimeCode;
+
+	do {
+		if (++p->nFrames == pFrame->nFps) {
+			p->nFrames = 0;
+			if (++p->nSeconds == 60) {
+				p->nSeconds = 0;
+				if (++p->nMinutes == 60) {
+					p->nMinutes = 0;
+					p->nHours = (p->nHours + 1) % 24;
+				}
+			}
+		}
+	} while (pFrame->bDropFrame && is_dropped(p));
+}
+
+static void previous_frame(struct TFrame *pFrame) {
+	struct TLtcTimeCode *p = &pFrame->tTimeCode;
+
+	do {
+		if (p->nFrames-- == 0) {
+			p->nFrames = pFrame->nFps - 1;
+			if (p->nSeconds-- == 0) {
+				p->nSeconds = 59;
+				if (p->nMinutes-- == 0) {
+					p->nMinutes = 59;
+					p->nHours = (p->nHours + 23) % 24;
+				}
+			}
+		}
+	} while (pFrame->bDropFrame && is_dropped(p));
+}
+
+static uint64_t position_us(const struct TFrame *pFrame) {
+	const struct TLtcTimeCode *p = &pFrame->tTimeCode;
+	const uint64_t nMinutes = (60 * p->nHours) + p->nMinutes;
+	uint64_t nFrame = (((60 * nMinutes) + p->nSeconds) * pFrame->nFps) + p->nFrames;
+
+	if (pFrame->bDropFrame) {
+		nFrame -= 2 * (nMinutes - (nMinutes / 10));
+
+		return (nFrame * 1001000) / 30;
+	}
+
+	return (nFrame * 1000000) / pFrame->nFps;
+}
+
+/*
+ * Bits 0..63 as transmitted, bits 64..79 are the sync word 0011 1111 1111 1101
+ */
+static bool frame_bit(const struct TFrame *pFrame, uint32_t nBit) {
+	const struct TLtcTimeCode *p = &pFrame->tTimeCode;
+
+	if (nBit >= 64) {
+		return (nBit >= 66) && (nBit != 78);
+	}
+
+	uint64_t nData = static_cast<uint64_t>(p->nFrames % 10);
+	nData |= static_cast<uint64_t>(p->nFrames / 10) << 8;
+	nData |= static_cast<uint64_t>(pFrame->bDropFrame ? 1 : 0) << 10;
+	nData |= static_cast<uint64_t>(p->nSeconds % 10) << 16;
+	nData |= static_cast<uint64_t>(p->nSeconds / 10) << 24;
+	nData |= static_cast<uint64_t>(p->nMinutes % 10) << 32;
+	nData |= static_cast<uint64_t>(p->nMinutes / 10) << 40;
+	nData |= static_cast<uint64_t>(p->nHours % 10) << 48;
+	nData |= static_cast<uint64_t>(p->nHours / 10) << 56;
+
+	return ((nData >> nBit) & 0x1) != 0;
+}
+
+class LtcStream {
+public:
+	LtcStream(const char *pName): m_pName(pName), m_fNowUs(1000), m_nErrors(0), m_nChecks(0), m_nFrames(0) {
+		s_nSeed = 1;
+	}
+
+	void Add(const struct TFrame *pFrame) {
+		if (m_nFrames < MAX_FRAMES) {
+			m_aFrames[m_nFrames++] = *pFrame;
+		}
+	}
+
+	/*
+	 * Speed in 1/1000, 1000 is nominal speed
+	 */
+	uint32_t Play(LtcDecoder &decoder, uint32_t nSpeed, bool bReverse) {
+		uint32_t nFpsKnownFrom = MAX_FRAMES;
+		uint32_t nSettledFrom = 3;
+
+		for (uint32_t i = 0; i < m_nFrames; i++) {
+			const struct TFrame *pFrame = &m_aFrames[i];
+			const double fBitUs = (static_cast<double>(frame_nominal_us(pFrame)) * 1000) / (80 * static_cast<double>(nSpeed));
+
+			// The decoder knows the frame rate once a wrap of the frame number at this rate has been decoded
+			if ((i >= 2) && (nFpsKnownFrom == MAX_FRAMES) && (m_aFrames[i - 2].nFps == pFrame->nFps) && (m_aFrames[i - 1].nFps == pFrame->nFps)) {
+				const uint8_t nFramesBefore = m_aFrames[i - 2].tTimeCode.nFrames;
+				const uint8_t nFramesAfter = m_aFrames[i - 1].tTimeCode.nFrames;
+
+				if (bReverse ? (nFramesAfter > nFramesBefore) : (nFramesAfter < nFramesBefore)) {
+					nFpsKnownFrom = i;
+				}
+			}
+
+			// At a rate change the frame boundary moves, the timeline may freewheel until the new rate is measured
+			if ((i > 0) && (m_aFrames[i - 1].nFps != pFrame->nFps)) {
+				nFpsKnownFrom = MAX_FRAMES;
+				nSettledFrom = i + 2;
+			}
+
+			const double fFrameStartUs = m_fNowUs;
+
+			for (uint32_t nCell = 0; nCell < 80; nCell++) {
+				const uint32_t nBit = bReverse ? (79 - nCell) : nCell;
+
+				Edge(decoder);
+
+				if (i >= nSettledFrom) {
+					Check(decoder, pFrame, fFrameStartUs, fBitUs * 80, bReverse, i >= nFpsKnownFrom);
+				}
+
+				if (frame_bit(pFrame, nBit)) {
+					m_fNowUs += fBitUs / 2;
+					Edge(decoder);
+					m_fNowUs += fBitUs / 2;
+				} else {
+					m_fNowUs += fBitUs;
+				}
+			}
+		}
+
+		// The edge that ends the last bit
+		Edge(decoder);
+
+		return static_cast<uint32_t>(m_fNowUs);
+	}
+
+	uint32_t GetErrors(void) {
+		return m_nErrors;
+	}
+
+	uint32_t GetChecks(void) {
+		return m_nChecks;
+	}
+
+	const struct TFrame *GetLast(void) {
+		return &m_aFrames[m_nFrames - 1];
+	}
+
+	void Error(const char *pWhat, const struct TLtcTimeCode *pExpected, const struct TLtcTimeCode *pDecoded) {
+		if (m_nErrors++ < 8) {
+			printf("  FAIL      : %s %s, expected %.2d:%.2d:%.2d:%.2d, decoded %.2d:%.2d:%.2d:%.2d\n", m_pName, pWhat,
+					pExpected->nHours, pExpected->nMinutes, pExpected->nSeconds, pExpected->nFrames,
+					pDecoded->nHours, pDecoded->nMinutes, pDecoded->nSeconds, pDecoded->nFrames);
+		}
+	}
+
+private:
+	void Edge(LtcDecoder &decoder) {
+		const uint32_t nEdgeUs = static_cast<uint32_t>(static_cast<int32_t>(m_fNowUs) + jitter());
+		decoder.Edge(nEdgeUs);
+
+		if (s_pRecord != 0) {
+			fprintf(s_pRecord, "%u\n", nEdgeUs);
+		}
+		decoder.Run(static_cast<uint32_t>(m_fNowUs));
+	}
+
+	void Check(LtcDecoder &decoder, const struct TFrame *pFrame, double fFrameStartUs, double fFramePeriodUs, bool bReverse, bool bIsFpsKnown) {
+		const struct TLtcTimeCode *pDecoded = decoder.GetTimeCode();
+		const struct TLtcTimeCode *pExpected = &pFrame->tTimeCode;
+
+		m_nChecks++;
+
+		if (decoder.GetState() != LTC_DECODER_STATE_LOCKED) {
+			Error("not locked", pExpected, pDecoded);
+			return;
+		}
+
+		// Until the frame rate is known the frame after 22 can be 23 or 0, and so on
+		if (!bIsFpsKnown && ((pExpected->nFrames == 0) || (pExpected->nFrames >= 23))) {
+			return;
+		}
+
+		if ((pDecoded->nFrames != pExpected->nFrames) || (pDecoded->nSeconds != pExpected->nSeconds) || (pDecoded->nMinutes != pExpected->nMinutes) || (pDecoded->nHours != pExpected->nHours)) {
+			Error("timecode", pExpected, pDecoded);
+			return;
+		}
+
+		if (decoder.GetDirection() != (bReverse ? LTC_DECODER_REVERSE : LTC_DECODER_FORWARD)) {
+			Error("direction", pExpected, pDecoded);
+			return;
+		}
+
+		if (bIsFpsKnown && ((decoder.GetFps() != pFrame->nFps) || (pDecoded->nType != timecode_type(pFrame)))) {
+			Error("frame rate", pExpected, pDecoded);
+			return;
+		}
+
+		// The position is only compared when the frame rate is known, before that the nominal frame duration is a guess
+		if (bIsFpsKnown) {
+			const double fNominalUs = frame_nominal_us(pFrame);
+			const double fElapsed = (m_fNowUs - fFrameStartUs) / fFramePeriodUs;
+			const double fSubFrameUs = bReverse ? (fNominalUs * (1 - fElapsed)) : (fNominalUs * fElapsed);
+			const double fExpectedUs = static_cast<double>(position_us(pFrame)) + fSubFrameUs;
+			const double fDecodedUs = static_cast<double>(decoder.GetPositionUs(static_cast<uint32_t>(m_fNowUs)));
+			const double fErrorUs = (fDecodedUs > fExpectedUs) ? (fDecodedUs - fExpectedUs) : (fExpectedUs - fDecodedUs);
+
+			if (fErrorUs > (fNominalUs / 50)) {
+				Error("position", pExpected, pDecoded);
+				if (m_nErrors <= 8) {
+					printf("              position error %.0f us\n", fErrorUs);
+				}
+			}
+		}
+	}
+
+private:
+	const char *m_pName;
+	double m_fNowUs;
+	uint32_t m_nErrors;
+	uint32_t m_nChecks;
+	uint32_t m_nFrames;
+	struct TFrame m_aFrames[MAX_FRAMES];
+};
+
+static void set_frame(struct TFrame *pFrame, uint8_t nHours, uint8_t nMinutes, uint8_t nSeconds, uint8_t nFrames, uint8_t nFps, bool bDropFrame) {
+	memset(pFrame, 0, sizeof(struct TFrame));
+	pFrame->tTimeCode.nHours = nHours;
+	pFrame->tTimeCode.nMinutes = nMinutes;
+	pFrame->tTimeCode.nSeconds = nSeconds;
+	pFrame->tTimeCode.nFrames = nFrames;
+	pFrame->nFps = nFps;
+	pFrame->bDropFrame = bDropFrame;
+	pFrame->tTimeCode.nType = timecode_type(pFrame);
+}
+
+static int run_stream(const char *pName, struct TFrame *pFirst, uint32_t nFrames, uint32_t nSpeed, bool bReverse) {
+	LtcStream stream(pName);
+	LtcDecoder decoder;
+
+	struct TFrame frame = *pFirst;
+
+	for (uint32_t i = 0; i < nFrames; i++) {
+		stream.Add(&frame);
+		if (bReverse) {
+			previous_frame(&frame);
+		} else {
+			next_frame(&frame);
+		}
+	}
+
+	stream.Play(decoder, nSpeed, bReverse);
+
+	const uint32_t nMeasured = decoder.GetSpeed();
+	const uint32_t nDiff = (nMeasured > nSpeed) ? (nMeasured - nSpeed) : (nSpeed - nMeasured);
+
+	if (nDiff > (nSpeed / 50)) {
+		printf("  FAIL      : %s speed %u, expected %u\n", pName, nMeasured, nSpeed);
+		return -1;
+	}
+
+	printf(" %-20s: %u frames, %u checks, speed %u, %u errors\n", pName, nFrames, stream.GetChecks(), nMeasured, stream.GetErrors());
+
+	return (stream.GetErrors() == 0) ? 0 : -1;
+}
+
+/*
+ * 30 fps followed by 25 fps without a break in the signal
+ */
+static int run_rate_change(void) {
+	LtcStream stream("rate 30 -> 25");
+	LtcDecoder decoder;
+
+	struct TFrame frame;
+	set_frame(&frame, 2, 0, 0, 20, 30, false);
+
+	for (uint32_t i = 0; i < 60; i++) {
+		stream.Add(&frame);
+		next_frame(&frame);
+	}
+
+	frame.nFps = 25;
+	frame.tTimeCode.nType = timecode_type(&frame);
+
+	for (uint32_t i = 0; i < 75; i++) {
+		stream.Add(&frame);
+		next_frame(&frame);
+	}
+
+	stream.Play(decoder, 1000, false);
+
+	printf(" %-20s: 135 frames, %u checks, fps %u, %u errors\n", "rate 30 -> 25", stream.GetChecks(), decoder.GetFps(), stream.GetErrors());
+
+	return ((stream.GetErrors() == 0) && (decoder.GetFps() == 25)) ? 0 : -1;
+}
+
+/*
+ * The signal stops: the timeline continues one frame per frame period
+ */
+static int run_freewheel(void) {
+	LtcStream stream("freewheel");
+	LtcDecoder decoder;
+
+	struct TFrame frame;
+	set_frame(&frame, 3, 59, 59, 0, 25, false);
+
+	for (uint32_t i = 0; i < 50; i++) {
+		stream.Add(&frame);
+		next_frame(&frame);
+	}
+
+	const uint32_t nEndUs = stream.Play(decoder, 1000, false);
+	const uint32_t nFrameUs = 40000;
+
+	// After the last edge the timeline is in the frame after the last one sent
+	uint32_t nSteps = 0;
+	uint32_t nErrors = stream.GetErrors();
+
+	for (uint32_t nNowUs = nEndUs; nNowUs < (nEndUs + (60 * nFrameUs)); nNowUs += 500) {
+		if (!decoder.Run(nNowUs)) {
+			continue;
+		}
+
+		if (decoder.GetState() == LTC_DECODER_STATE_NO_SIGNAL) {
+			break;
+		}
+
+		nSteps++;
+		next_frame(&frame);
+
+		const struct TLtcTimeCode *pDecoded = decoder.GetTimeCode();
+
+		if ((decoder.GetState() != LTC_DECODER_STATE_FREEWHEEL) || (memcmp(pDecoded, &frame.tTimeCode, sizeof(struct TLtcTimeCode)) != 0)) {
+			stream.Error("freewheel", &frame.tTimeCode, pDecoded);
+			nErrors++;
+			break;
+		}
+
+		// A step is made at the frame boundary, the first one with a margin of 1/8 frame
+		const uint32_t nDueUs = nEndUs + (nSteps * nFrameUs) + ((nSteps == 1) ? (nFrameUs / 8) : 0);
+
+		if ((nNowUs < nDueUs) || (nNowUs > (nDueUs + 500 + (nFrameUs / 8)))) {
+			printf("  FAIL      : freewheel step %u at +%u us\n", nSteps, nNowUs - nEndUs);
+			nErrors++;
+			break;
+		}
+	}
+
+	if (decoder.GetState() != LTC_DECODER_STATE_NO_SIGNAL) {
+		printf("  FAIL      : freewheel does not end\n");
+		nErrors++;
+	}
+
+	if (nSteps != decoder.GetFreewheelFrames()) {
+		printf("  FAIL      : freewheel %u frames, expected %u\n", nSteps, decoder.GetFreewheelFrames());
+		nErrors++;
+	}
+
+	printf(" %-20s: %u frames freewheel, %u errors\n", "freewheel", nSteps, nErrors);
+
+	return (nErrors == 0) ? 0 : -1;
+}
+
+static int replay(const char *pFileName) {
+	FILE *pFile = fopen(pFileName, "r");
+
+	if (pFile == 0) {
+		perror(pFileName);
+		return -1;
+	}
+
+	LtcDecoder decoder;
+	char aLine[32];
+	uint32_t nEdges = 0;
+	uint32_t nUpdates = 0;
+	uint32_t nErrors = 0;
+	uint64_t nPositionPreviousUs = 0;
+	bool bIsLockedPrevious = false;
+
+	while (fgets(aLine, sizeof(aLine), pFile) != 0) {
+		const uint32_t nTimeUs = static_cast<uint32_t>(strtoul(aLine, 0, 10));
+
+		decoder.Edge(nTimeUs);
+		nEdges++;
+
+		if (!decoder.Run(nTimeUs)) {
+			continue;
+		}
+
+		const struct TLtcTimeCode *p = decoder.GetTimeCode();
+		const bool bIsLocked = (decoder.GetState() == LTC_DECODER_STATE_LOCKED);
+		const uint64_t nPositionUs = LtcDecoder::GetPositionUs(p, decoder.GetFps(), p->nType == TC_TYPE_DF);
+
+		printf("%10u %.2d:%.2d:%.2d:%.2d %s fps %u speed %u %s\n", nTimeUs, p->nHours, p->nMinutes, p->nSeconds, p->nFrames,
+				decoder.GetDirection() == LTC_DECODER_FORWARD ? ">" : "<", decoder.GetFps(), decoder.GetSpeed(),
+				bIsLocked ? "locked" : "freewheel");
+
+		// Locked to locked, a timecode must follow the previous one by one frame
+		if (bIsLocked && bIsLockedPrevious) {
+			const uint64_t nStepUs = (nPositionUs > nPositionPreviousUs) ? (nPositionUs - nPositionPreviousUs) : (nPositionPreviousUs - nPositionUs);
+			const uint64_t nNominalUs = (p->nType == TC_TYPE_DF) ? (1001000 / 30) : (1000000 / decoder.GetFps());
+
+			if ((nStepUs + 1) < nNominalUs || nStepUs > (nNominalUs + 1)) {
+				printf("  FAIL      : not contiguous\n");
+				nErrors++;
+			}
+		}
+
+		nPositionPreviousUs = nPositionUs;
+		bIsLockedPrevious = bIsLocked;
+		nUpdates++;
+	}
+
+	fclose(pFile);
+
+	printf("%u edges, %u timecodes, %u errors\n", nEdges, nUpdates, nErrors);
+
+	const int nResult = ((nUpdates != 0) && (nErrors == 0)) ? 0 : -1;
+
+	puts(nResult == 0 ? "PASS" : "FAIL");
+
+	return nResult;
+}
+
+int ltc_benchmark(const char *pMode, const char *pFileName) {
+	if ((pMode != 0) && (strcmp(pMode, "replay") == 0)) {
+		return replay(pFileName);
+	}
+
+	struct TFrame frame;
+	int nResult = 0;
+
+	if ((pMode != 0) && (strcmp(pMode, "record") == 0)) {
+		if ((s_pRecord = fopen(pFileName, "w")) == 0) {
+			perror(pFileName);
+			return -1;
+		}
+
+		set_frame(&frame, 10, 0, 58, 10, 25, false);
+		nResult = run_stream("25 fps", &frame, 100, 1000, false);
+
+		fclose(s_pRecord);
+		s_pRecord = 0;
+
+		return nResult;
+	}
+
+	printf("Benchmark ltc, jitter %d us\n", JITTER_US);
+
+	set_frame(&frame, 10, 0, 58, 10, 25, false);
+	nResult |= run_stream("25 fps", &frame, 100, 1000, false);
+
+	set_frame(&frame, 23, 59, 59, 0, 24, false);
+	nResult |= run_stream("24 fps", &frame, 60, 1000, false);
+
+	set_frame(&frame, 0, 0, 59, 10, 30, true);
+	nResult |= run_stream("30 fps drop frame", &frame, 60, 1000, false);
+
+	set_frame(&frame, 0, 9, 59, 10, 30, true);
+	nResult |= run_stream("30 fps df 10th min", &frame, 60, 1000, false);
+
+	set_frame(&frame, 1, 0, 1, 10, 25, false);
+	nResult |= run_stream("25 fps reverse", &frame, 60, 1000, true);
+
+	set_frame(&frame, 1, 0, 0, 10, 25, false);
+	nResult |= run_stream("25 fps 0.5x", &frame, 60, 500, false);
+
+	set_frame(&frame, 1, 0, 0, 10, 25, false);
+	nResult |= run_stream("25 fps 2x", &frame, 100, 2000, false);
+
+	set_frame(&frame, 1, 0, 0, 10, 30, false);
+	nResult |= run_stream("30 fps 1.5x reverse", &frame, 100, 1500, true);
+
+	nResult |= run_rate_change();
+	nResult |= run_freewheel();
+
+	puts(nResult == 0 ? "PASS" : "FAIL");
+
+	return nResult;
+}
@@ -0,0 +1,564 @@
+/**
+ * @file main.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hardware.h"
+#include "networkpcap.h"
+#include "ledblink.h"
+
+#include "artnetnode.h"
+#include "packets.h"
+#include "e131bridge.h"
+#include "e131.h"
+#include "e131packets.h"
+#include "e117const.h"
+
+#include "lightset.h"
+
+#include "metrics.h"
+#include "profiler.h"
+
+#include "benchmark.h"
+
+/*
+ * Offline benchmark, the artnet and e131 modes: the packets of a pcap file, or
+ * generated frames, are fed to an ArtNetNode or E131Bridge, the output goes to
+ * a null LightSet. The received packets must be all the packets for the node,
+ * with generated frames every packet must be a DMX update.
+ *
+ * Reported are the packets per second, the cost of a Run() that handled a
+ * packet, the latency from the receive to the LightSet and the merge cost.
+ * The durations are in nanoseconds (CLOCK_MONOTONIC).
+ *
+ * The pixel mode checks the interpolation, the dithering and the refresh rate of
+ * the WS28xxDmxEngine, and reports the pixels per second, see pixel.cpp.
+ *
+ * The poll mode sends rounds of ArtPoll from several controllers to an
+ * ArtNetNode, without and with jitter, and checks the replies per round, see
+ * poll.cpp.
+ *
+ * The widget mode encodes synthetic DMX frames as USB Pro Widget stream
+ * records, decodes and checks them, and reports the bytes per frame. The
+ * frames are also sent over a simulated FT245RL to a fast and a slow host,
+ * see widget.cpp.
+ *
+ * The rdm mode checks the non-blocking ArtRdm handling against the blocking
+ * handler, see rdm.cpp.
+ *
+ * The rdmpid mode checks the hashed RDM PID dispatch against a table of the
+ * implemented PIDs, for every PID, see rdmpid.cpp.
+ *
+ * The priority mode checks the per-address priority (0xDD) merge of 32 ports
+ * with two competing sources and reports the cost per frame, see priority.cpp.
+ *
+ * The serial mode checks the ordering and the throughput of the Serial
+ * transmit queue with the Linux backend, see serialtx.cpp.
+ *
+ * The ltc mode checks the LtcDecoder with synthetic or recorded edges, see ltc.cpp.
+ *
+ * The esp8266 mode checks the ESP8266 burst frames over a simulated nibble bus,
+ * see esp8266.cpp.
+ *
+ * The showfile mode plays OLA show files through the filestream read-ahead and
+ * reports the frames per second and the stalls, see showfile.cpp.
+ *
+ * The record mode records the output of an ArtNetNode and an E131Bridge with
+ * the ShowFileRecorder and checks the replay, see record.cpp.
+ *
+ * The osc mode checks the parsing of received OSC bundles, also truncated and
+ * with element lengths that wrap, see oscbundle.cpp.
+ *
+ * The gateway mode checks the Art-Net <-> sACN universe mapping, the HTP merge
+ * and the synchronization passthrough of the ArtNetE131Gateway, see gateway.cpp.
+ */
+
+#define MAX_UNIVERSES	4
+
+#define GENERATED_FRAMES_DEFAULT	2048
+#define GENERATED_SLOTS				512
+#define GENERATED_SOURCE_A			0x0102A8C0	// 192.168.2.1
+#define GENERATED_SOURCE_B			0x0202A8C0	///< Merged with source A on the first universe
+
+class NullLightSet: public LightSet {
+public:
+	NullLightSet(NetworkPcap *pNetwork, struct TSamples *pLatency): m_pNetwork(pNetwork), m_pLatency(pLatency), m_nUpdates(0) {
+	}
+	~NullLightSet(void) {
+	}
+
+	void Start(uint8_t nPort) {
+	}
+
+	void Stop(uint8_t nPort) {
+	}
+
+	void SetData(uint8_t nPort, const uint8_t *pData, uint16_t nLength) {
+		samples_add(m_pLatency, static_cast<uint32_t>(profiler_ticks() - m_pNetwork->GetReceiveTicks()));
+		m_nUpdates++;
+	}
+
+	uint32_t GetUpdates(void) const {
+		return m_nUpdates;
+	}
+
+private:
+	NetworkPcap *m_pNetwork;
+	struct TSamples *m_pLatency;
+	uint32_t m_nUpdates;
+};
+
+/*
+ * The first MAX_UNIVERSES universes with DMX data in the capture
+ */
+static uint32_t find_universes(const NetworkPcap &nw, bool bIsArtNet, uint16_t *pUniverses) {
+	uint32_t nUniverses = 0;
+
+	for (uint32_t i = 0; (i < nw.GetPackets()) && (nUniverses < MAX_UNIVERSES); i++) {
+		const struct TNetworkPcapPacket *pPacket = nw.GetPacket(i);
+		const uint8_t *p = pPacket->pPayload;
+		uint16_t nUniverse;
+
+		if (bIsArtNet) {
+			// "Art-Net", OpDmx (0x5000), universe at 14 (little endian)
+			if ((pPacket->nToPort != ARTNET_UDP_PORT) || (pPacket->nLength < 18) || (memcmp(p, "Art-Net", 8) != 0) || (p[8] != 0x00) || (p[9] != 0x50)) {
+				continue;
+			}
+			nUniverse = static_cast<uint16_t>(p[14] | (p[15] << 8));
+		} else {
+			// Root vector VECTOR_ROOT_E131_DATA (4), universe at 113 (big endian)
+			if ((pPacket->nToPort != E131_DEFAULT_PORT) || (pPacket->nLength < 126) || (p[21] != 0x04) || (p[43] != 0x02)) {
+				continue;
+			}
+			nUniverse = static_cast<uint16_t>((p[113] << 8) | p[114]);
+		}
+
+		uint32_t j;
+
+		for (j = 0; j < nUniverses; j++) {
+			if (pUniverses[j] == nUniverse) {
+				break;
+			}
+		}
+
+		if (j == nUniverses) {
+			pUniverses[nUniverses++] = nUniverse;
+		}
+	}
+
+	return nUniverses;
+}
+
+static uint8_t generated_slot(uint32_t nFrame, uint32_t nIndex, uint32_t nSlot) {
+	return static_cast<uint8_t>((nFrame * 5) + (nIndex * 29) + (nSlot * 3));
+}
+
+/*
+ * Per frame a packet for each of the MAX_UNIVERSES universes from source A, and
+ * one for the first universe from source B. The data changes every frame.
+ * The number of frames is a multiple of 256, so the E1.31 sequence numbers
+ * continue over the loops.
+ */
+static uint8_t *generate(NetworkPcap &nw, bool bIsArtNet, uint32_t nFrames) {
+	const uint32_t nPacketsPerFrame = MAX_UNIVERSES + 1;
+	const uint32_t nPacketSize = sizeof(struct TE131DataPacket);
+	uint8_t *pPackets = new uint8_t[nFrames * nPacketsPerFrame * nPacketSize];
+	uint8_t *pPacket = pPackets;
+
+	nw.Create(nFrames * nPacketsPerFrame);
+
+	for (uint32_t nFrame = 0; nFrame < nFrames; nFrame++) {
+		for (uint32_t i = 0; i < nPacketsPerFrame; i++) {
+			const uint32_t nIndex = (i < MAX_UNIVERSES) ? i : 0;
+			const uint32_t nFromIp = (i < MAX_UNIVERSES) ? GENERATED_SOURCE_A : GENERATED_SOURCE_B;
+			const uint16_t nUniverse = static_cast<uint16_t>(1 + nIndex);
+
+			if (bIsArtNet) {
+				struct TArtDmx *pArtDmx = reinterpret_cast<struct TArtDmx *>(pPacket);
+
+				memset(pArtDmx, 0, sizeof(struct TArtDmx));
+				memcpy(pArtDmx->Id, "Art-Net", 8);
+				pArtDmx->OpCode = OP_DMX;
+				pArtDmx->ProtVerLo = ARTNET_PROTOCOL_REVISION;
+				pArtDmx->Sequence = static_cast<uint8_t>(1 + (nFrame % 255));
+				pArtDmx->PortAddress = nUniverse;
+				pArtDmx->LengthHi = static_cast<uint8_t>(GENERATED_SLOTS >> 8);
+				pArtDmx->Length = static_cast<uint8_t>(GENERATED_SLOTS);
+
+				for (uint32_t nSlot = 0; nSlot < GENERATED_SLOTS; nSlot++) {
+					pArtDmx->Data[nSlot] = generated_slot(nFrame, i, nSlot);
+				}
+
+				nw.Add(pPacket, sizeof(struct TArtDmx), nFromIp, ARTNET_UDP_PORT, ARTNET_UDP_PORT);
+			} else {
+				struct TE131DataPacket *pE131 = reinterpret_cast<struct TE131DataPacket *>(pPacket);
+
+				memset(pE131, 0, sizeof(struct TE131DataPacket));
+
+				pE131->RootLayer.PreAmbleSize = __builtin_bswap16(0x0010);
+				memcpy(pE131->RootLayer.ACNPacketIdentifier, E117Const::ACN_PACKET_IDENTIFIER, E117_PACKET_IDENTIFIER_LENGTH);
+				pE131->RootLayer.Vector = __builtin_bswap32(E131_VECTOR_ROOT_DATA);
+				memset(pE131->RootLayer.Cid, (nFromIp == GENERATED_SOURCE_A) ? 0xA0 : 0xB0, E131_CID_LENGTH);
+
+				pE131->FrameLayer.Vector = __builtin_bswap32(E131_VECTOR_DATA_PACKET);
+				pE131->FrameLayer.Priority = E131_PRIORITY_DEFAULT;
+				pE131->FrameLayer.SequenceNumber = static_cast<uint8_t>(nFrame);
+				pE131->FrameLayer.Universe = __builtin_bswap16(nUniverse);
+
+				pE131->DMPLayer.Vector = E131_VECTOR_DMP_SET_PROPERTY;
+				pE131->DMPLayer.Type = 0xa1;
+				pE131->DMPLayer.FirstAddressProperty = __builtin_bswap16(0x0000);
+				pE131->DMPLayer.AddressIncrement = __builtin_bswap16(0x0001);
+				pE131->DMPLayer.PropertyValueCount = __builtin_bswap16(1 + GENERATED_SLOTS);
+				pE131->DMPLayer.PropertyValues[0] = E131_START_CODE_DMX;
+
+				for (uint32_t nSlot = 0; nSlot < GENERATED_SLOTS; nSlot++) {
+					pE131->DMPLayer.PropertyValues[1 + nSlot] = generated_slot(nFrame, i, nSlot);
+				}
+
+				nw.Add(pPacket, DATA_PACKET_SIZE(1 + GENERATED_SLOTS), nFromIp, E131_DEFAULT_PORT, E131_DEFAULT_PORT);
+			}
+
+			pPacket += nPacketSize;
+		}
+	}
+
+	return pPackets;
+}
+
+/*
+ * The packets the node listens to, these must all be received
+ */
+static uint32_t count_packets(const NetworkPcap &nw, bool bIsArtNet) {
+	const uint16_t nPort = bIsArtNet ? ARTNET_UDP_PORT : E131_DEFAULT_PORT;
+	uint32_t nPackets = 0;
+
+	for (uint32_t i = 0; i < nw.GetPackets(); i++) {
+		if (nw.GetPacket(i)->nToPort == nPort) {
+			nPackets++;
+		}
+	}
+
+	return nPackets;
+}
+
+int main(int argc, char **argv) {
+	Hardware hw;
+	NetworkPcap nw;
+	LedBlink lb;
+
+	if ((argc > 1) && (strcmp(argv[1], "pixel") == 0)) {
+		const uint32_t nPixels = (argc > 2) ? static_cast<uint32_t>(atoi(argv[2])) : 680;
+		const uint32_t nOutputs = (argc > 3) ? static_cast<uint32_t>(atoi(argv[3])) : 8;
+
+		if ((nPixels == 0) || (nOutputs == 0)) {
+			fprintf(stderr, "Invalid pixels or outputs\n");
+			return -1;
+		}
+
+		return pixel_benchmark(nPixels, nOutputs);
+	}
+
+	if ((argc > 1) && (strcmp(argv[1], "poll") == 0)) {
+		const uint32_t nControllers = (argc > 2) ? static_cast<uint32_t>(atoi(argv[2])) : 8;
+		const uint32_t nRounds = (argc > 3) ? static_cast<uint32_t>(atoi(argv[3])) : 10;
+		const uint32_t nJitterMillis = (argc > 4) ? static_cast<uint32_t>(atoi(argv[4])) : 200;
+
+		if ((nControllers == 0) || (nRounds == 0) || (nJitterMillis == 0) || (nJitterMillis > ARTNET_POLLREPLY_JITTER_MAX_MILLIS)) {
+			fprintf(stderr, "Invalid controllers, rounds or jitter (1-%d)\n", ARTNET_POLLREPLY_JITTER_MAX_MILLIS);
+			return -1;
+		}
+
+		return poll_benchmark(nw, nControllers, nRounds, nJitterMillis);
+	}
+
+	if ((argc > 1) && (strcmp(argv[1], "widget") == 0)) {
+		const uint32_t nFrames = (argc > 2) ? static_cast<uint32_t>(atoi(argv[2])) : 100000;
+		const uint32_t nChanged = (argc > 3) ? static_cast<uint32_t>(atoi(argv[3])) : 16;
+
+		if (nFrames == 0) {
+			fprintf(stderr, "Invalid frames\n");
+			return -1;
+		}
+
+		return widget_benchmark(nFrames, nChanged);
+	}
+
+	if ((argc > 1) && (strcmp(argv[1], "rdm") == 0)) {
+		const uint32_t nRequests = (argc > 2) ? static_cast<uint32_t>(atoi(argv[2])) : 64;
+		const uint32_t nTransactionMicros = (argc > 3) ? static_cast<uint32_t>(atoi(argv[3])) : 2000;
+
+		if ((nRequests == 0) || (nRequests > 256) || (nTransactionMicros == 0)) {
+			fprintf(stderr, "Invalid requests (1-256) or transaction time\n");
+			return -1;
+		}
+
+		return rdm_benchmark(nw, nRequests, nTransactionMicros);
+	}
+
+	if ((argc > 1) && (strcmp(argv[1], "rdmpid") == 0)) {
+		return rdmpid_benchmark();
+	}
+
+	if ((argc > 1) && (strcmp(argv[1], "priority") == 0)) {
+		const uint32_t nRounds = (argc > 2) ? static_cast<uint32_t>(atoi(argv[2])) : 1000;
+
+		if (nRounds < 2) {
+			fprintf(stderr, "Invalid rounds (2 or more)\n");
+			return -1;
+		}
+
+		return priority_benchmark(nw, nRounds);
+	}
+
+	if ((argc > 1) && (strcmp(argv[1], "serial") == 0)) {
+		const uint32_t nMessages = (argc > 2) ? static_cast<uint32_t>(atoi(argv[2])) : 2000;
+
+		if (nMessages == 0) {
+			fprintf(stderr, "Invalid messages\n");
+			return -1;
+		}
+
+		return serial_benchmark(nMessages);
+	}
+
+	if ((argc > 1) && (strcmp(argv[1], "ltc") == 0)) {
+		if ((argc == 3) || ((argc > 3) && (strcmp(argv[2], "replay") != 0) && (strcmp(argv[2], "record") != 0))) {
+			fprintf(stderr, "Usage: %s ltc [replay|record edges.txt]\n", argv[0]);
+			return -1;
+		}
+
+		return ltc_benchmark((argc > 3) ? argv[2] : 0, (argc > 3) ? argv[3] : 0);
+	}
+
+	if ((argc > 1) && (strcmp(argv[1], "esp8266") == 0)) {
+		const uint32_t nFrames = (argc > 2) ? static_cast<uint32_t>(atoi(argv[2])) : 1000;
+
+		if (nFrames == 0) {
+			fprintf(stderr, "Invalid frames\n");
+			return -1;
+		}
+
+		return esp8266_benchmark(nFrames);
+	}
+
+	if ((argc > 1) && (strcmp(argv[1], "showfile") == 0)) {
+		if ((argc > 2) && (access(argv[2], R_OK) == 0)) {
+			return showfile_benchmark(argv[2], 0);
+		}
+
+		const uint32_t nFrames = (argc > 2) ? static_cast<uint32_t>(atoi(argv[2])) : 500;
+
+		if (nFrames < 2) {
+			fprintf(stderr, "Invalid frames (2 or more) or show file\n");
+			return -1;
+		}
+
+		return showfile_benchmark(0, nFrames);
+	}
+
+	if ((argc > 1) && (strcmp(argv[1], "record") == 0)) {
+		const uint32_t nFrames = (argc > 2) ? static_cast<uint32_t>(atoi(argv[2])) : 500;
+
+		if (nFrames == 0) {
+			fprintf(stderr, "Invalid frames\n");
+			return -1;
+		}
+
+		return record_benchmark(nw, nFrames);
+	}
+
+	if ((argc > 1) && (strcmp(argv[1], "osc") == 0)) {
+		return osc_benchmark();
+	}
+
+	if ((argc > 1) && (strcmp(argv[1], "gateway") == 0)) {
+		return gateway_benchmark(nw);
+	}
+
+	if (argc < 2) {
+		printf("Usage: %s artnet|e131 [file.pcap|frames] [loops]\n", argv[0]);
+		printf("       %s pixel [pixels] [outputs]\n", argv[0]);
+		printf("       %s poll [controllers] [rounds] [jitter_ms]\n", argv[0]);
+		printf("       %s widget [frames] [changed_slots]\n", argv[0]);
+		printf("       %s rdm [requests] [transaction_us]\n", argv[0]);
+		printf("       %s rdmpid\n", argv[0]);
+		printf("       %s priority [rounds]\n", argv[0]);
+		printf("       %s serial [messages]\n", argv[0]);
+		printf("       %s ltc [replay|record edges.txt]\n", argv[0]);
+		printf("       %s esp8266 [frames]\n", argv[0]);
+		printf("       %s showfile [frames|show.txt]\n", argv[0]);
+		printf("       %s record [frames]\n", argv[0]);
+		printf("       %s osc\n", argv[0]);
+		printf("       %s gateway\n", argv[0]);
+		return -1;
+	}
+
+	const bool bIsArtNet = (strcmp(argv[1], "artnet") == 0);
+
+	if (!bIsArtNet && (strcmp(argv[1], "e131") != 0)) {
+		fprintf(stderr, "Unknown protocol: %s\n", argv[1]);
+		return -1;
+	}
+
+	const uint32_t nLoops = (argc > 3) ? static_cast<uint32_t>(atoi(argv[3])) : 1;
+	const bool bIsGenerated = (argc < 3) || (access(argv[2], R_OK) != 0);
+	uint8_t *pGenerated = 0;
+
+	if (nLoops == 0) {
+		fprintf(stderr, "Invalid loops\n");
+		return -1;
+	}
+
+	if (bIsGenerated) {
+		const uint32_t nFrames = (argc > 2) ? static_cast<uint32_t>(atoi(argv[2])) : GENERATED_FRAMES_DEFAULT;
+
+		if (nFrames == 0) {
+			fprintf(stderr, "Invalid frames or pcap file\n");
+			return -1;
+		}
+
+		pGenerated = generate(nw, bIsArtNet, (nFrames + 255) & ~255U);
+	} else if (!nw.Load(argv[2])) {
+		return -1;
+	}
+
+	uint16_t aUniverses[MAX_UNIVERSES];
+	const uint32_t nUniverses = find_universes(nw, bIsArtNet, aUniverses);
+
+	if (nUniverses == 0) {
+		fprintf(stderr, "No %s DMX data in %s\n", argv[1], bIsGenerated ? "the generated frames" : argv[2]);
+		delete[] pGenerated;
+		return -1;
+	}
+
+	struct TSamples tRun = { "run", new uint32_t[MAX_SAMPLES], 0 };
+	struct TSamples tLatency = { "latency", new uint32_t[MAX_SAMPLES], 0 };
+
+	NullLightSet lightSet(&nw, &tLatency);
+
+	ArtNetNode node;
+	E131Bridge bridge;
+
+	if (bIsArtNet) {
+		// The ports share net and sub-net, these are taken from the first universe
+		node.SetNetSwitch(static_cast<uint8_t>((aUniverses[0] >> 8) & 0x7F));
+		node.SetSubnetSwitch(static_cast<uint8_t>((aUniverses[0] >> 4) & 0x0F));
+
+		for (uint32_t i = 0; i < nUniverses; i++) {
+			if ((aUniverses[i] & 0x7FF0) == (aUniverses[0] & 0x7FF0)) {
+				node.SetUniverseSwitch(i, ARTNET_OUTPUT_PORT, aUniverses[i] & 0x0F);
+			}
+		}
+
+		node.SetDirectUpdate(true);
+		node.SetOutput(&lightSet);
+		node.Print();
+		node.Start();
+	} else {
+		for (uint32_t i = 0; i < nUniverses; i++) {
+			bridge.SetUniverse(i, E131_OUTPUT_PORT, aUniverses[i]);
+		}
+
+		bridge.SetDirectUpdate(true);
+		bridge.SetOutput(&lightSet);
+		bridge.Print();
+		bridge.Start();
+	}
+
+	PROFILER_INIT();
+
+	const uint32_t nExpected = count_packets(nw, bIsArtNet) * nLoops;
+	uint64_t nElapsed = 0;
+
+	for (uint32_t nLoop = 0; nLoop < nLoops; nLoop++) {
+		nw.Rewind();
+
+		const profiler_ticks_t nLoopBegin = profiler_ticks();
+
+		while (!nw.IsEnd()) {
+			const uint32_t nReceived = nw.GetReceived();
+			const profiler_ticks_t nRunBegin = profiler_ticks();
+
+			if (bIsArtNet) {
+				node.Run();
+			} else {
+				bridge.Run();
+			}
+
+			if (nw.GetReceived() != nReceived) {
+				samples_add(&tRun, static_cast<uint32_t>(profiler_ticks() - nRunBegin));
+			}
+		}
+
+		nElapsed += profiler_ticks() - nLoopBegin;
+	}
+
+	printf("Benchmark %s, %s, %u loop(s)\n", argv[1], bIsGenerated ? "generated frames" : argv[2], nLoops);
+	printf(" Packets    : %u received, %u sent, %u DMX updates\n", nw.GetReceived(), nw.GetSent(), lightSet.GetUpdates());
+	printf(" Elapsed    : %llu us\n", static_cast<unsigned long long>(nElapsed / 1000));
+	printf(" Throughput : %u packets/s\n", (nElapsed == 0) ? 0 : static_cast<uint32_t>((static_cast<uint64_t>(nw.GetReceived()) * 1000000000ULL) / nElapsed));
+
+	puts("Durations (ns)");
+	samples_print(&tRun);
+	samples_print(&tLatency);
+
+	for (const struct profiler_section *pSection = profiler_get_first(); pSection != 0; pSection = pSection->next) {
+		if ((pSection->count != 0) && (pSection != profiler_get_loop())) {
+			printf(" %-10s : %u calls, avg %u, min %u, max %u\n", pSection->name, pSection->count, static_cast<uint32_t>(pSection->total / pSection->count), static_cast<uint32_t>(pSection->min), static_cast<uint32_t>(pSection->max));
+		}
+	}
+
+	puts("Metrics");
+
+	for (const struct metric *pMetric = metrics_get_first(); pMetric != 0; pMetric = pMetric->next) {
+		printf(" %-28s : %u\n", pMetric->name, pMetric->value);
+	}
+
+	int nResult = 0;
+
+	if (nw.GetReceived() != nExpected) {
+		printf("  FAIL      : %u packets received, expected %u\n", nw.GetReceived(), nExpected);
+		nResult = -1;
+	}
+
+	// Of a capture the sources and the sequence numbers are not known, only of the generated frames
+	if (bIsGenerated ? (lightSet.GetUpdates() != nExpected) : ((lightSet.GetUpdates() == 0) || (lightSet.GetUpdates() > nExpected))) {
+		printf("  FAIL      : %u DMX updates, expected %s%u\n", lightSet.GetUpdates(), bIsGenerated ? "" : "1 to ", nExpected);
+		nResult = -1;
+	}
+
+	puts(nResult == 0 ? "PASS" : "FAIL");
+
+	delete[] tLatency.pSamples;
+	delete[] tRun.pSamples;
+	delete[] pGenerated;
+
+	return nResult;
+}
@@ -0,0 +1,240 @@
+/**
+ * @file oscbundle.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "oscbundle.h"
+#include "oscbundlebuilder.h"
+#include "oscmessagebuilder.h"
+
+#include "benchmark.h"
+
+/*
+ * The parsing of received OSC bundles with OSCBundle.
+ *
+ * Checked are: a bundle with messages and a nested bundle, every truncation
+ * of that bundle, and element lengths that wrap the index (0xFFFFFFFC and
+ * others) as first and as later element.
+ */
+
+#define BUNDLE_SIZE		512
+#define MESSAGES		3
+
+static uint8_t s_Bundle[BUNDLE_SIZE];
+static uint32_t s_aElementLength[MESSAGES + 1];
+
+static uint32_t build_bundle(void) {
+	OSCBundleBuilder bundle(s_Bundle, sizeof(s_Bundle));
+	char aPath[16];
+
+	for (uint32_t i = 0; i < MESSAGES; i++) {
+		uint32_t nFree;
+		uint8_t *pElement = bundle.GetElementBuffer(nFree);
+
+		snprintf(aPath, sizeof(aPath), "/dmx1/%u", i + 1);
+
+		OSCMessageBuilder msg(pElement, nFree, aPath, "i");
+		msg.AddInt32(static_cast<int32_t>(i));
+
+		s_aElementLength[i] = msg.GetSize();
+		bundle.AddElement(msg.GetSize());
+	}
+
+	uint32_t nFree;
+	uint8_t *pElement = bundle.GetElementBuffer(nFree);
+	OSCBundleBuilder nested(pElement, nFree);
+
+	uint8_t aMessage[32];
+	OSCMessageBuilder msg(aMessage, sizeof(aMessage), "/blackout", "");
+	nested.AddMessage(msg.GetMessage(), msg.GetSize());
+
+	s_aElementLength[MESSAGES] = nested.GetSize();
+	bundle.AddElement(nested.GetSize());
+
+	return bundle.IsValid() ? bundle.GetSize() : 0;
+}
+
+/*
+ * Returns the number of elements, every element must be inside the bundle
+ */
+static uint32_t parse(const uint8_t *pBundle, uint32_t nLength, uint32_t& nErrors) {
+	OSCBundle bundle(pBundle, nLength);
+	uint32_t nElements = 0;
+	uint32_t nElementLength;
+	const uint8_t *pElement;
+
+	while ((pElement = bundle.GetNextElement(nElementLength)) != 0) {
+		if ((pElement < pBundle) || ((pElement + nElementLength) > (pBundle + nLength)) || (nElements > MESSAGES)) {
+			printf("  FAIL      : length %u, element %u (%u bytes) is outside the bundle\n", nLength, nElements, nElementLength);
+			nErrors++;
+			break;
+		}
+
+		nElements++;
+	}
+
+	return nElements;
+}
+
+static int run_valid(uint32_t nSize) {
+	uint32_t nErrors = 0;
+
+	OSCBundle bundle(s_Bundle, nSize);
+	uint32_t nElements = 0;
+	uint32_t nElementLength;
+	const uint8_t *pElement;
+
+	while ((pElement = bundle.GetNextElement(nElementLength)) != 0) {
+		if ((nElements > MESSAGES) || (nElementLength != s_aElementLength[nElements])) {
+			printf("  FAIL      : element %u, length %u\n", nElements, nElementLength);
+			nErrors++;
+			break;
+		}
+
+		if ((nElements == MESSAGES) && (parse(pElement, nElementLength, nErrors) != 1)) {
+			printf("  FAIL      : nested bundle\n");
+			nErrors++;
+		}
+
+		nElements++;
+	}
+
+	if ((nElements != (MESSAGES + 1)) || !bundle.IsValid()) {
+		printf("  FAIL      : %u elements, valid %d\n", nElements, bundle.IsValid());
+		nErrors++;
+	}
+
+	printf(" Valid      : %u bytes, %u elements, %u errors\n", nSize, nElements, nErrors);
+
+	return (nErrors == 0) ? 0 : -1;
+}
+
+/*
+ * Only the elements that are complete within the length are returned
+ */
+static int run_truncated(uint32_t nSize) {
+	uint32_t nErrors = 0;
+	uint32_t nBundles = 0;
+
+	for (uint32_t nLength = OSC_BUNDLE_HEADER_SIZE; nLength < nSize; nLength += 4) {
+		uint32_t nComplete = 0;
+		uint32_t nEnd = OSC_BUNDLE_HEADER_SIZE;
+
+		for (uint32_t i = 0; i <= MESSAGES; i++) {
+			nEnd += 4 + s_aElementLength[i];
+
+			if (nEnd > nLength) {
+				break;
+			}
+
+			nComplete++;
+		}
+
+		const uint32_t nElements = parse(s_Bundle, nLength, nErrors);
+
+		if (nElements != nComplete) {
+			printf("  FAIL      : truncated to %u bytes, %u elements, expected %u\n", nLength, nElements, nComplete);
+			nErrors++;
+		}
+
+		nBundles++;
+	}
+
+	printf(" Truncated  : %u bundles, %u errors\n", nBundles, nErrors);
+
+	return (nErrors == 0) ? 0 : -1;
+}
+
+/*
+ * An element length that makes m_nIndex + 4 + nElementLength wrap
+ */
+static int run_oversized(void) {
+	static const uint32_t aLength[] = { 0xFFFFFFFC, 0xFFFFFFF0, 0xFFFFFFEC, 0x80000000 };
+	uint32_t nErrors = 0;
+	uint8_t aBundle[64];
+
+	for (uint32_t i = 0; i < sizeof(aLength) / sizeof(aLength[0]); i++) {
+		for (uint32_t nFirst = 0; nFirst < 2; nFirst++) {
+			OSCBundleBuilder builder(aBundle, sizeof(aBundle));
+
+			if (nFirst != 0) {
+				uint8_t aMessage[16];
+				OSCMessageBuilder msg(aMessage, sizeof(aMessage), "/a", "");
+				builder.AddMessage(msg.GetMessage(), msg.GetSize());
+			}
+
+			uint32_t nIndex = builder.GetSize();
+			const uint32_t nLength = __builtin_bswap32(aLength[i]);
+
+			memcpy(&aBundle[nIndex], &nLength, 4);
+			nIndex += 4;
+			memset(&aBundle[nIndex], 0, 16);
+			nIndex += 16;
+
+			const uint32_t nElements = parse(aBundle, nIndex, nErrors);
+
+			if (nElements != nFirst) {
+				printf("  FAIL      : element length 0x%.8x after %u elements, %u elements\n", aLength[i], nFirst, nElements);
+				nErrors++;
+			}
+		}
+	}
+
+	// The builder must not accept such a length either
+	OSCBundleBuilder builder(aBundle, sizeof(aBundle));
+
+	if (builder.AddElement(0xFFFFFFFC)) {
+		printf("  FAIL      : builder accepted element length 0xfffffffc\n");
+		nErrors++;
+	}
+
+	printf(" Oversized  : %u lengths, %u errors\n", static_cast<uint32_t>(sizeof(aLength) / sizeof(aLength[0])), nErrors);
+
+	return (nErrors == 0) ? 0 : -1;
+}
+
+int osc_benchmark(void) {
+	const uint32_t nSize = build_bundle();
+
+	printf("Benchmark osc, bundle of %u messages and a nested bundle\n", MESSAGES);
+
+	if (nSize == 0) {
+		puts("  FAIL      : bundle not built");
+		puts("FAIL");
+		return -1;
+	}
+
+	int nResult = 0;
+
+	nResult |= run_valid(nSize);
+	nResult |= run_truncated(nSize);
+	nResult |= run_oversized();
+
+	puts(nResult == 0 ? "PASS" : "FAIL");
+
+	return nResult;
+}
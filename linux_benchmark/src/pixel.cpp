@@ -0,0 +1,368 @@
+/**
+ * @file pixel.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "ws28xxdmxengine.h"
+
+#include "profiler.h"
+
+#include "benchmark.h"
+
+/*
+ * The WS28xxDmxEngine with a simulated clock. Checked are:
+ * - with gamma 1.0 a completed interpolation (factor 256) is the target frame;
+ * - the average of the dithered output of a static frame is the 16-bit gamma
+ *   corrected value, within 1 LSB;
+ * - the number of refreshes follows the refresh rate, also when a refresh
+ *   takes several Run() calls.
+ * The throughput is measured with fades, rendered back to back.
+ */
+
+#define PIXEL_CHANNELS_PER_PIXEL	3
+#define PIXEL_DMX_FRAME_MICROS		25000	///< 40 Hz input
+#define PIXEL_REFRESHES				4000
+#define PIXEL_HOLD_MICROS			150000	///< Longer than the longest frame interval
+#define PIXEL_CHECK_PIXELS			86		///< 258 channels, every value 0-255
+#define PIXEL_DITHER_REFRESHES		1024
+#define PIXEL_RATE_SECONDS			2
+#define PIXEL_RATE_STEP_MICROS		100
+
+class NullPixelOutput: public WS28xxDmxEngineOutput {
+public:
+	NullPixelOutput(void): m_nPixels(0), m_nUpdates(0), m_nChecksum(0) {
+	}
+	~NullPixelOutput(void) {
+	}
+
+	void SetPixels(uint32_t nOutput, uint32_t nPixelIndex, const uint8_t *pData, uint32_t nPixels) {
+		m_nChecksum += pData[0];
+		m_nPixels += nPixels;
+	}
+
+	void Update(void) {
+		m_nUpdates++;
+	}
+
+	uint64_t GetPixels(void) const {
+		return m_nPixels;
+	}
+
+	uint32_t GetUpdates(void) const {
+		return m_nUpdates;
+	}
+
+	uint32_t GetChecksum(void) const {
+		return m_nChecksum;
+	}
+
+private:
+	uint64_t m_nPixels;
+	uint32_t m_nUpdates;
+	uint32_t m_nChecksum;
+};
+
+/*
+ * Keeps the channels of the last refresh, and the sum per channel over the refreshes
+ */
+class CapturePixelOutput: public WS28xxDmxEngineOutput {
+public:
+	CapturePixelOutput(uint32_t nOutputs, uint32_t nPixels):
+		m_nPixels(nPixels), m_nChannels(nOutputs * nPixels * PIXEL_CHANNELS_PER_PIXEL), m_nUpdates(0)
+	{
+		m_pFrame = new uint8_t[m_nChannels];
+		m_pSum = new uint32_t[m_nChannels];
+		Reset();
+	}
+	~CapturePixelOutput(void) {
+		delete[] m_pSum;
+		delete[] m_pFrame;
+	}
+
+	void SetPixels(uint32_t nOutput, uint32_t nPixelIndex, const uint8_t *pData, uint32_t nPixels) {
+		const uint32_t nIndex = ((nOutput * m_nPixels) + nPixelIndex) * PIXEL_CHANNELS_PER_PIXEL;
+
+		memcpy(&m_pFrame[nIndex], pData, nPixels * PIXEL_CHANNELS_PER_PIXEL);
+
+		for (uint32_t i = 0; i < (nPixels * PIXEL_CHANNELS_PER_PIXEL); i++) {
+			m_pSum[nIndex + i] += pData[i];
+		}
+	}
+
+	void Update(void) {
+		m_nUpdates++;
+	}
+
+	void Reset(void) {
+		memset(m_pFrame, 0, m_nChannels);
+		memset(m_pSum, 0, m_nChannels * sizeof(uint32_t));
+		m_nUpdates = 0;
+	}
+
+	const uint8_t *GetFrame(void) const {
+		return m_pFrame;
+	}
+
+	const uint32_t *GetSum(void) const {
+		return m_pSum;
+	}
+
+	uint32_t GetUpdates(void) const {
+		return m_nUpdates;
+	}
+
+private:
+	uint32_t m_nPixels;
+	uint32_t m_nChannels;
+	uint8_t *m_pFrame;
+	uint32_t *m_pSum;
+	uint32_t m_nUpdates;
+};
+
+static void set_frame(WS28xxDmxEngine &engine, const uint8_t *pData, uint32_t nChannels) {
+	engine.SetData(0, 0, pData, nChannels);
+	engine.SetFrame();
+}
+
+/*
+ * Runs the engine for nDuration microseconds of the simulated clock
+ */
+static void run_engine(WS28xxDmxEngine &engine, uint32_t &nMicros, uint32_t nDuration, uint32_t nStep) {
+	const uint32_t nEnd = nMicros + nDuration;
+
+	while (static_cast<int32_t>(nEnd - nMicros) > 0) {
+		engine.Run(nMicros);
+		nMicros += nStep;
+	}
+}
+
+static int run_exact(void) {
+	const uint32_t nChannels = PIXEL_CHECK_PIXELS * PIXEL_CHANNELS_PER_PIXEL;
+	uint32_t nErrors = 0;
+	uint32_t nMicros = 0;
+	uint8_t aData[nChannels];
+
+	CapturePixelOutput output(1, PIXEL_CHECK_PIXELS);
+	WS28xxDmxEngine engine(&output, 1, PIXEL_CHECK_PIXELS, PIXEL_CHANNELS_PER_PIXEL);
+
+	engine.SetGamma(1.0f);
+
+	// The fades in between leave a dithering residual
+	for (uint32_t nFrame = 0; nFrame < 16; nFrame++) {
+		for (uint32_t i = 0; i < nChannels; i++) {
+			aData[i] = static_cast<uint8_t>((nFrame * 53) + (i * 7));
+		}
+
+		set_frame(engine, aData, nChannels);
+		run_engine(engine, nMicros, PIXEL_DMX_FRAME_MICROS, 1000);
+
+		if ((nFrame & 0x3) != 0x3) {
+			continue;
+		}
+
+		run_engine(engine, nMicros, PIXEL_HOLD_MICROS, 1000);
+
+		const uint8_t *pFrame = output.GetFrame();
+
+		for (uint32_t i = 0; i < nChannels; i++) {
+			if (pFrame[i] != aData[i]) {
+				printf("  FAIL      : frame %u, channel %u is %u, expected %u\n", nFrame, i, pFrame[i], aData[i]);
+				nErrors++;
+				break;
+			}
+		}
+	}
+
+	printf(" Exact      : 4 frames with gamma 1.0, %u errors\n", nErrors);
+
+	return (nErrors == 0) ? 0 : -1;
+}
+
+static int run_dither(void) {
+	const uint32_t nChannels = PIXEL_CHECK_PIXELS * PIXEL_CHANNELS_PER_PIXEL;
+	uint32_t nErrors = 0;
+	uint32_t nMicros = 0;
+	uint32_t nDithered = 0;
+	double fMaxError = 0;
+	uint8_t aData[nChannels];
+
+	for (uint32_t i = 0; i < nChannels; i++) {
+		aData[i] = static_cast<uint8_t>(i);
+	}
+
+	CapturePixelOutput output(1, PIXEL_CHECK_PIXELS);
+	WS28xxDmxEngine engine(&output, 1, PIXEL_CHECK_PIXELS, PIXEL_CHANNELS_PER_PIXEL);
+
+	// The interpolation is completed first, then the output is static apart from the dithering
+	set_frame(engine, aData, nChannels);
+	run_engine(engine, nMicros, PIXEL_HOLD_MICROS, 1000);
+
+	const uint32_t nRefreshMicros = 1000000 / engine.GetRefreshRate();
+
+	output.Reset();
+	run_engine(engine, nMicros, PIXEL_DITHER_REFRESHES * nRefreshMicros, nRefreshMicros);
+
+	const uint32_t nRefreshes = output.GetUpdates();
+	const uint32_t *pSum = output.GetSum();
+
+	for (uint32_t i = 0; (nRefreshes != 0) && (i < nChannels); i++) {
+		const double fExpected = 65280.0 * pow(static_cast<double>(aData[i]) / 255.0, WS28XXDMXENGINE_GAMMA_DEFAULT);
+		const double fAverage = (static_cast<double>(pSum[i]) * 256.0) / nRefreshes;
+		const double fError = fabs(fAverage - fExpected);
+
+		if (fError > fMaxError) {
+			fMaxError = fError;
+		}
+
+		if (fError > 1.0) {
+			printf("  FAIL      : value %u, average %.2f, expected %.2f (16-bit)\n", aData[i], fAverage, fExpected);
+			nErrors++;
+		}
+
+		if ((pSum[i] % nRefreshes) != 0) {
+			nDithered++;
+		}
+	}
+
+	if ((nRefreshes != PIXEL_DITHER_REFRESHES) || (nDithered == 0)) {
+		printf("  FAIL      : %u refreshes, %u values dithered\n", nRefreshes, nDithered);
+		nErrors++;
+	}
+
+	printf(" Dither     : %u refreshes, %u of %u values dithered, max error %.2f LSB (16-bit), %u errors\n", nRefreshes, nDithered, nChannels, fMaxError, nErrors);
+
+	return (nErrors == 0) ? 0 : -1;
+}
+
+/*
+ * The clock advances in small steps, with a budget a refresh takes several Run() calls
+ */
+static int run_rate(uint32_t nRefreshRate, uint32_t nPixelBudget) {
+	uint32_t nMicros = 0;
+
+	NullPixelOutput output;
+	WS28xxDmxEngine engine(&output, 1, PIXEL_CHECK_PIXELS, PIXEL_CHANNELS_PER_PIXEL);
+
+	engine.SetRefreshRate(nRefreshRate);
+	engine.SetPixelBudget(nPixelBudget);
+
+	run_engine(engine, nMicros, PIXEL_RATE_SECONDS * 1000000, PIXEL_RATE_STEP_MICROS);
+
+	const uint32_t nExpected = PIXEL_RATE_SECONDS * nRefreshRate;
+	const uint32_t nUpdates = output.GetUpdates();
+	const bool bIsOk = (nUpdates + 1 >= nExpected) && (nUpdates <= nExpected + 1);
+
+	printf(" Rate       : %u Hz, budget %u pixels, %u refreshes in %u s, expected %u\n", nRefreshRate, nPixelBudget, nUpdates, PIXEL_RATE_SECONDS, nExpected);
+
+	if (!bIsOk) {
+		printf("  FAIL      : refresh rate %u Hz\n", nRefreshRate);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * The clock is simulated, the refreshes are rendered back to back.
+ * The DMX frames are fades with a different phase per channel.
+ */
+static void run_throughput(uint32_t nPixels, uint32_t nOutputs) {
+	const uint32_t nChannels = nPixels * PIXEL_CHANNELS_PER_PIXEL;
+
+	NullPixelOutput output;
+	WS28xxDmxEngine engine(&output, nOutputs, nPixels, PIXEL_CHANNELS_PER_PIXEL);
+
+	engine.SetPixelBudget(nOutputs * nPixels);
+
+	const uint32_t nRefreshMicros = 1000000 / engine.GetRefreshRate();
+	uint8_t *pData = new uint8_t[nChannels];
+	struct TSamples tRefresh = { "refresh", new uint32_t[PIXEL_REFRESHES], 0 };
+
+	uint32_t nMicros = 0;
+	uint32_t nFrameMicros = 0;
+	uint32_t nFrame = 0;
+	uint64_t nElapsed = 0;
+
+	while (tRefresh.nCount < PIXEL_REFRESHES) {
+		if ((nMicros - nFrameMicros) >= PIXEL_DMX_FRAME_MICROS) {
+			nFrameMicros = nMicros;
+
+			for (uint32_t i = 0; i < nChannels; i++) {
+				pData[i] = static_cast<uint8_t>(nFrame + i);
+			}
+
+			for (uint32_t nOutput = 0; nOutput < nOutputs; nOutput++) {
+				engine.SetData(nOutput, 0, pData, nChannels);
+			}
+
+			engine.SetFrame();
+			nFrame++;
+		}
+
+		const profiler_ticks_t nBegin = profiler_ticks();
+
+		if (engine.Run(nMicros)) {
+			const uint32_t nTicks = static_cast<uint32_t>(profiler_ticks() - nBegin);
+			samples_add(&tRefresh, nTicks);
+			nElapsed += nTicks;
+		}
+
+		nMicros += nRefreshMicros;
+	}
+
+	const uint64_t nPixelsPerSecond = (nElapsed == 0) ? 0 : (output.GetPixels() * 1000000000ULL) / nElapsed;
+
+	printf(" Frames     : %u outputs x %u pixels, %u DMX frames\n", nOutputs, nPixels, nFrame);
+	printf(" Refreshes  : %u (checksum %u)\n", output.GetUpdates(), output.GetChecksum());
+	printf(" Elapsed    : %u us\n", static_cast<uint32_t>(nElapsed / 1000));
+	printf(" Throughput : %u pixels/s\n", static_cast<uint32_t>(nPixelsPerSecond));
+	printf(" Budget     : %u pixels per 100 us Run()\n", static_cast<uint32_t>(nPixelsPerSecond / 10000));
+
+	puts("Durations (ns)");
+	samples_print(&tRefresh);
+
+	delete[] tRefresh.pSamples;
+	delete[] pData;
+}
+
+int pixel_benchmark(uint32_t nPixels, uint32_t nOutputs) {
+	printf("Benchmark pixel, %u outputs x %u pixels\n", nOutputs, nPixels);
+
+	int nResult = 0;
+
+	nResult |= run_exact();
+	nResult |= run_dither();
+	nResult |= run_rate(WS28XXDMXENGINE_REFRESH_RATE_DEFAULT, PIXEL_CHECK_PIXELS);
+	nResult |= run_rate(333, PIXEL_CHECK_PIXELS / 4);
+
+	run_throughput(nPixels, nOutputs);
+
+	puts(nResult == 0 ? "PASS" : "FAIL");
+
+	return nResult;
+}
@@ -0,0 +1,273 @@
+/**
+ * @file poll.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "networkpcap.h"
+
+#include "artnetnode.h"
+#include "packets.h"
+
+#include "hardware.h"
+
+#include "metrics.h"
+#include "profiler.h"
+
+#include "benchmark.h"
+
+/*
+ * Rounds of ArtPoll from several controllers, the packets arrive back to back,
+ * are sent to an ArtNetNode. Between the rounds the node is idle, a round is
+ * long enough for a delayed reply and the minimum interval after it.
+ *
+ * The replies are broadcast, so per round there is one reply for the first
+ * poll and, when that reply was sent immediately, one more after the minimum
+ * interval for the polls that arrived meanwhile. Checked per round are the
+ * replies, that the first reply is not later than the jitter, and that the
+ * replies are at least the minimum interval apart. The NodeReport of every
+ * reply must be as formatted with snprintf.
+ *
+ * The rounds are run without jitter, every first reply must be immediate,
+ * and with jitter, where at least one reply must be delayed.
+ */
+
+#define POLL_ROUND_MILLIS	(2 * ARTNET_POLLREPLY_MIN_INTERVAL_MILLIS + 50)
+#define POLL_MAX_REPLIES	(4 * 1024)
+
+static uint32_t s_aReplyMillis[POLL_MAX_REPLIES];
+static uint32_t s_nReplies;
+static uint32_t s_nReportErrors;
+
+/*
+ * The NodeReport is "%04x [%04d] <sysname> AvV"
+ */
+static bool is_node_report_valid(const struct TArtPollReply *pPollReply) {
+	char aReport[ARTNET_REPORT_LENGTH + 1];
+	memcpy(aReport, pPollReply->NodeReport, ARTNET_REPORT_LENGTH);
+	aReport[ARTNET_REPORT_LENGTH] = '\0';
+
+	uint8_t nSysNameLength;
+	const char *pSysName = Hardware::Get()->GetSysName(nSysNameLength);
+	char aExpected[ARTNET_REPORT_LENGTH];
+	unsigned nCode;
+	int nCount;
+	int nPrefix = 0;
+
+	if ((sscanf(aReport, "%4x [%4d] %n", &nCode, &nCount, &nPrefix) != 2) || (nPrefix != 12) || (memchr(pPollReply->NodeReport, '\0', ARTNET_REPORT_LENGTH) == 0)) {
+		return false;
+	}
+
+	snprintf(aExpected, sizeof aExpected, "%04x [%04d] %.15s AvV", nCode, nCount, pSysName);
+
+	return strcmp(aReport, aExpected) == 0;
+}
+
+static void reply_capture(const uint8_t *pBuffer, uint16_t nLength, __attribute__((unused)) uint32_t nToIp, __attribute__((unused)) uint16_t nRemotePort) {
+	if ((nLength < 10) || (pBuffer[8] != (OP_POLLREPLY & 0xFF)) || (pBuffer[9] != (OP_POLLREPLY >> 8))) {
+		return;
+	}
+
+	if ((nLength != sizeof(struct TArtPollReply)) || !is_node_report_valid(reinterpret_cast<const struct TArtPollReply *>(pBuffer))) {
+		s_nReportErrors++;
+	}
+
+	if (s_nReplies < POLL_MAX_REPLIES) {
+		s_aReplyMillis[s_nReplies] = Hardware::Get()->Millis();
+	}
+
+	s_nReplies++;
+}
+
+static void run_idle(ArtNetNode &node, uint32_t nMillis) {
+	const uint32_t nBegin = Hardware::Get()->Millis();
+
+	while ((Hardware::Get()->Millis() - nBegin) < nMillis) {
+		node.Run();
+	}
+}
+
+static int run_rounds(NetworkPcap &nw, ArtNetNode &node, uint32_t nControllers, uint32_t nRounds, uint32_t nJitterMillis) {
+	node.SetPollReplyJitter(nJitterMillis);
+
+	const uint32_t nJitter = node.GetPollReplyJitter();
+	const uint32_t nRoundMillis = POLL_ROUND_MILLIS + nJitter;
+
+	struct TSamples tPoll = { "poll", new uint32_t[MAX_SAMPLES], 0 };
+	struct TSamples tReply = { "reply", new uint32_t[MAX_SAMPLES], 0 };
+
+	const uint32_t nPollsStart = nw.GetReceived();
+	const uint32_t nRepliesStart = s_nReplies;
+	uint32_t nPreviousReplyMillis = (s_nReplies == 0) ? 0 : s_aReplyMillis[(s_nReplies - 1) % POLL_MAX_REPLIES];
+	uint32_t nImmediate = 0;
+	uint32_t nMaxDelay = 0;
+	uint32_t nErrors = 0;
+
+	for (uint32_t nRound = 0; nRound < nRounds; nRound++) {
+		const uint32_t nRoundBegin = Hardware::Get()->Millis();
+		const uint32_t nRoundReplies = s_nReplies;
+		uint32_t nFirstPollMillis = 0;
+		bool bIsImmediate = false;
+
+		nw.Rewind();
+
+		while ((Hardware::Get()->Millis() - nRoundBegin) < nRoundMillis) {
+			const uint32_t nReceived = nw.GetReceived();
+			const uint32_t nSent = nw.GetSent();
+			const profiler_ticks_t nRunBegin = profiler_ticks();
+
+			node.Run();
+
+			const uint32_t nTicks = static_cast<uint32_t>(profiler_ticks() - nRunBegin);
+
+			if (nw.GetReceived() != nReceived) {
+				samples_add(&tPoll, nTicks);
+
+				if (nw.GetReceived() == (nPollsStart + (nRound * nControllers) + 1)) {
+					nFirstPollMillis = Hardware::Get()->Millis();
+					bIsImmediate = (s_nReplies != nRoundReplies);
+				}
+			} else if (nw.GetSent() != nSent) {
+				samples_add(&tReply, nTicks);
+			}
+		}
+
+		const uint32_t nReplies = s_nReplies - nRoundReplies;
+		const uint32_t nExpected = (bIsImmediate && (nControllers > 1)) ? 2 : 1;
+
+		if (nReplies != nExpected) {
+			printf("  FAIL      : round %u, %u replies, expected %u\n", nRound, nReplies, nExpected);
+			nErrors++;
+		}
+
+		if ((nJitter == 0) && !bIsImmediate) {
+			printf("  FAIL      : round %u, the reply is delayed without jitter\n", nRound);
+			nErrors++;
+		}
+
+		for (uint32_t i = nRoundReplies; (i < s_nReplies) && (i < POLL_MAX_REPLIES); i++) {
+			if ((i != 0) && ((s_aReplyMillis[i] - nPreviousReplyMillis) < (ARTNET_POLLREPLY_MIN_INTERVAL_MILLIS - 1))) {
+				printf("  FAIL      : round %u, replies %u ms apart\n", nRound, s_aReplyMillis[i] - nPreviousReplyMillis);
+				nErrors++;
+			}
+
+			nPreviousReplyMillis = s_aReplyMillis[i];
+		}
+
+		if ((nReplies != 0) && (nRoundReplies < POLL_MAX_REPLIES)) {
+			const uint32_t nDelay = s_aReplyMillis[nRoundReplies] - nFirstPollMillis;
+
+			// One millisecond for the clock ticking between the Run() and the capture
+			if (nDelay > (nJitter + 1)) {
+				printf("  FAIL      : round %u, first reply after %u ms, jitter %u ms\n", nRound, nDelay, nJitter);
+				nErrors++;
+			}
+
+			if (nDelay > nMaxDelay) {
+				nMaxDelay = nDelay;
+			}
+		}
+
+		if (bIsImmediate) {
+			nImmediate++;
+		}
+	}
+
+	if ((nJitter != 0) && (nImmediate == nRounds)) {
+		printf("  FAIL      : no reply was delayed, jitter %u ms\n", nJitter);
+		nErrors++;
+	}
+
+	const uint32_t nPolls = nw.GetReceived() - nPollsStart;
+	const uint32_t nReplies = s_nReplies - nRepliesStart;
+
+	printf(" Jitter %-4u: %u polls, %u replies (%u.%02u per poll), %u immediate, first reply max %u ms, %u errors\n", nJitter, nPolls, nReplies,
+			nReplies / nPolls, ((nReplies * 100) / nPolls) % 100, nImmediate, nMaxDelay, nErrors);
+
+	samples_print(&tPoll);
+	samples_print(&tReply);
+
+	delete[] tReply.pSamples;
+	delete[] tPoll.pSamples;
+
+	return (nErrors == 0) ? 0 : -1;
+}
+
+int poll_benchmark(NetworkPcap &nw, uint32_t nControllers, uint32_t nRounds, uint32_t nJitterMillis) {
+	ArtNetNode node;
+
+	node.SetUniverseSwitch(0, ARTNET_OUTPUT_PORT, 1);
+	node.Start();
+
+	// The reply on startup is not part of a round
+	run_idle(node, ARTNET_POLLREPLY_MIN_INTERVAL_MILLIS);
+
+	struct TArtPoll tArtPoll;
+
+	memset(&tArtPoll, 0, sizeof(struct TArtPoll));
+	memcpy(tArtPoll.Id, "Art-Net", 8);
+	tArtPoll.OpCode = OP_POLL;
+	tArtPoll.ProtVerLo = ARTNET_PROTOCOL_REVISION;
+
+	nw.Create(nControllers);
+
+	for (uint32_t i = 0; i < nControllers; i++) {
+		const uint32_t nFromIp = 0x0002A8C0 | ((i + 1) << 24);	// 192.168.2.(i + 1)
+		nw.Add(reinterpret_cast<const uint8_t *>(&tArtPoll), sizeof(struct TArtPoll), nFromIp, ARTNET_UDP_PORT, ARTNET_UDP_PORT);
+	}
+
+	s_nReplies = 0;
+	s_nReportErrors = 0;
+	nw.SetSendHook(reply_capture);
+
+	printf("Benchmark poll, %u controllers, %u rounds, minimum interval %u ms\n", nControllers, nRounds, ARTNET_POLLREPLY_MIN_INTERVAL_MILLIS);
+	puts("Durations (ns)");
+
+	int nResult = 0;
+
+	nResult |= run_rounds(nw, node, nControllers, nRounds, 0);
+	nResult |= run_rounds(nw, node, nControllers, nRounds, nJitterMillis);
+
+	nw.SetSendHook(0);
+
+	if (s_nReportErrors != 0) {
+		printf("  FAIL      : %u replies with an invalid NodeReport\n", s_nReportErrors);
+		nResult = -1;
+	}
+
+	puts("Metrics");
+
+	for (const struct metric *pMetric = metrics_get_first(); pMetric != 0; pMetric = pMetric->next) {
+		if (strncmp(pMetric->name, "artnet.pollreply", 16) == 0) {
+			printf(" %-28s : %u\n", pMetric->name, pMetric->value);
+		}
+	}
+
+	puts(nResult == 0 ? "PASS" : "FAIL");
+
+	return nResult;
+}
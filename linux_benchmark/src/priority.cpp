@@ -0,0 +1,305 @@
+/**
+ * @file priority.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "networkpcap.h"
+
+#include "e131bridge.h"
+#include "e131.h"
+#include "e131packets.h"
+#include "e117const.h"
+
+#include "lightset.h"
+
+#include "profiler.h"
+
+#include "benchmark.h"
+
+/*
+ * Two sources send DMX data and per-address priority (0xDD) to all 32 ports of
+ * an E131Bridge. Every round a source sends, per universe, a 0xDD packet
+ * followed by a DMX packet. The slot priorities are such that on a port a
+ * quarter of the slots is driven by source A, a quarter by source B, a quarter
+ * has equal priorities (merged HTP) and a quarter is not driven (0).
+ *
+ * After every round the output of each port is compared with a reference merge.
+ * The 0xDD packets of the first round are not used, these arrive before the
+ * source is known; the output is checked from the second round on.
+ */
+
+#define PRIORITY_PORTS			E131_MAX_PORTS
+#define PRIORITY_SOURCES		2
+#define PRIORITY_SLOTS			510		///< Not a multiple of 16, the slot count is taken from the packet
+#define PRIORITY_UNIVERSE		1
+
+class PriorityLightSet: public LightSet {
+public:
+	PriorityLightSet(void): m_nUpdates(0) {
+		memset(m_nLength, 0, sizeof(m_nLength));
+		memset(m_Data, 0, sizeof(m_Data));
+	}
+	~PriorityLightSet(void) {
+	}
+
+	void Start(uint8_t nPort) {
+	}
+
+	void Stop(uint8_t nPort) {
+	}
+
+	void SetData(uint8_t nPort, const uint8_t *pData, uint16_t nLength) {
+		if ((nPort < PRIORITY_PORTS) && (nLength <= E131_DMX_LENGTH)) {
+			memcpy(m_Data[nPort], pData, nLength);
+			m_nLength[nPort] = nLength;
+		}
+
+		m_nUpdates++;
+	}
+
+	const uint8_t *GetData(uint32_t nPort) const {
+		return m_Data[nPort];
+	}
+
+	uint16_t GetLength(uint32_t nPort) const {
+		return m_nLength[nPort];
+	}
+
+	uint32_t GetUpdates(void) const {
+		return m_nUpdates;
+	}
+
+private:
+	uint32_t m_nUpdates;
+	uint16_t m_nLength[PRIORITY_PORTS];
+	uint8_t m_Data[PRIORITY_PORTS][E131_DMX_LENGTH];
+};
+
+static uint32_t source_ip(uint32_t nSource) {
+	return 0x0002A8C0 | ((nSource + 1) << 24);	// 192.168.2.(nSource + 1)
+}
+
+static uint8_t slot_priority(uint32_t nSource, uint32_t nPort, uint32_t nSlot) {
+	static const uint8_t aPriority[PRIORITY_SOURCES][4] = { { 200, 100, 150, 0 }, { 100, 200, 150, 0 } };
+
+	return aPriority[nSource][(nSlot + nPort) & 0x3];
+}
+
+static uint8_t slot_data(uint32_t nSource, uint32_t nRound, uint32_t nPort, uint32_t nSlot) {
+	if (nSource == 0) {
+		return static_cast<uint8_t>(nSlot + nRound + nPort);
+	}
+
+	return static_cast<uint8_t>(0xFF - nSlot + (2 * nRound));
+}
+
+static uint8_t reference_merge(uint32_t nRound, uint32_t nPort, uint32_t nSlot) {
+	const uint8_t nPriorityA = slot_priority(0, nPort, nSlot);
+	const uint8_t nPriorityB = slot_priority(1, nPort, nSlot);
+	const uint8_t nDataA = slot_data(0, nRound, nPort, nSlot);
+	const uint8_t nDataB = slot_data(1, nRound, nPort, nSlot);
+
+	if (nPriorityA > nPriorityB) {
+		return nDataA;
+	}
+
+	if (nPriorityB > nPriorityA) {
+		return nDataB;
+	}
+
+	if (nPriorityA == 0) {
+		return 0;
+	}
+
+	return (nDataA > nDataB) ? nDataA : nDataB;
+}
+
+static void fill_packet(struct TE131DataPacket *pPacket, uint32_t nSource, uint32_t nPort, uint8_t nStartCode) {
+	memset(pPacket, 0, sizeof(struct TE131DataPacket));
+
+	pPacket->RootLayer.PreAmbleSize = __builtin_bswap16(0x0010);
+	memcpy(pPacket->RootLayer.ACNPacketIdentifier, E117Const::ACN_PACKET_IDENTIFIER, E117_PACKET_IDENTIFIER_LENGTH);
+	pPacket->RootLayer.Vector = __builtin_bswap32(E131_VECTOR_ROOT_DATA);
+	memset(pPacket->RootLayer.Cid, 0xA0 + nSource, E131_CID_LENGTH);
+
+	pPacket->FrameLayer.Vector = __builtin_bswap32(E131_VECTOR_DATA_PACKET);
+	pPacket->FrameLayer.Priority = E131_PRIORITY_DEFAULT;
+	pPacket->FrameLayer.Universe = __builtin_bswap16(static_cast<uint16_t>(PRIORITY_UNIVERSE + nPort));
+
+	pPacket->DMPLayer.Vector = E131_VECTOR_DMP_SET_PROPERTY;
+	pPacket->DMPLayer.Type = 0xa1;
+	pPacket->DMPLayer.FirstAddressProperty = __builtin_bswap16(0x0000);
+	pPacket->DMPLayer.AddressIncrement = __builtin_bswap16(0x0001);
+	pPacket->DMPLayer.PropertyValueCount = __builtin_bswap16(1 + PRIORITY_SLOTS);
+	pPacket->DMPLayer.PropertyValues[0] = nStartCode;
+
+	if (nStartCode == E131_START_CODE_PER_ADDRESS_PRIORITY) {
+		for (uint32_t nSlot = 0; nSlot < PRIORITY_SLOTS; nSlot++) {
+			pPacket->DMPLayer.PropertyValues[1 + nSlot] = slot_priority(nSource, nPort, nSlot);
+		}
+	}
+}
+
+int priority_benchmark(NetworkPcap &nw, uint32_t nRounds) {
+	// Per round and source: the 0xDD packets of all ports, then the DMX packets
+	const uint32_t nPackets = PRIORITY_SOURCES * 2 * PRIORITY_PORTS;
+
+	struct TE131DataPacket *pPackets = new struct TE131DataPacket[nPackets];
+
+	nw.Create(nPackets);
+
+	for (uint32_t nSource = 0; nSource < PRIORITY_SOURCES; nSource++) {
+		for (uint32_t i = 0; i < (2 * PRIORITY_PORTS); i++) {
+			const uint32_t nPort = i % PRIORITY_PORTS;
+			const uint8_t nStartCode = (i < PRIORITY_PORTS) ? E131_START_CODE_PER_ADDRESS_PRIORITY : E131_START_CODE_DMX;
+			struct TE131DataPacket *pPacket = &pPackets[(nSource * 2 * PRIORITY_PORTS) + i];
+
+			fill_packet(pPacket, nSource, nPort, nStartCode);
+			nw.Add(reinterpret_cast<const uint8_t *>(pPacket), DATA_PACKET_SIZE(PRIORITY_SLOTS + 1), source_ip(nSource), E131_DEFAULT_PORT, E131_DEFAULT_PORT);
+		}
+	}
+
+	PriorityLightSet lightSet;
+	E131Bridge bridge;
+
+	for (uint32_t nPort = 0; nPort < PRIORITY_PORTS; nPort++) {
+		bridge.SetUniverse(nPort, E131_OUTPUT_PORT, static_cast<uint16_t>(PRIORITY_UNIVERSE + nPort));
+	}
+
+	bridge.SetDirectUpdate(true);
+	bridge.SetOutput(&lightSet);
+	bridge.Start();
+
+	PROFILER_INIT();
+
+	struct TSamples tFrame = { "frame", new uint32_t[MAX_SAMPLES], 0 };
+	struct TSamples tPriority = { "priority", new uint32_t[MAX_SAMPLES], 0 };
+
+	uint32_t nErrors = 0;
+	uint32_t nChecks = 0;
+	uint64_t nElapsed = 0;
+
+	for (uint32_t nRound = 0; nRound < nRounds; nRound++) {
+		const uint8_t nSequence = static_cast<uint8_t>(nRound);
+
+		for (uint32_t i = 0; i < nPackets; i++) {
+			struct TE131DataPacket *pPacket = &pPackets[i];
+			const uint32_t nSource = i / (2 * PRIORITY_PORTS);
+			const uint32_t nPort = i % PRIORITY_PORTS;
+			// The bridge keeps one sequence number per source and port, for both start codes
+			const bool bIsDmx = (pPacket->DMPLayer.PropertyValues[0] == E131_START_CODE_DMX);
+
+			pPacket->FrameLayer.SequenceNumber = static_cast<uint8_t>((2 * nSequence) + (bIsDmx ? 1 : 0));
+
+			if (bIsDmx) {
+				for (uint32_t nSlot = 0; nSlot < PRIORITY_SLOTS; nSlot++) {
+					pPacket->DMPLayer.PropertyValues[1 + nSlot] = slot_data(nSource, nRound, nPort, nSlot);
+				}
+			}
+		}
+
+		nw.Rewind();
+
+		const profiler_ticks_t nRoundBegin = profiler_ticks();
+
+		while (!nw.IsEnd()) {
+			const uint32_t nReceived = nw.GetReceived();
+			const profiler_ticks_t nRunBegin = profiler_ticks();
+
+			bridge.Run();
+
+			const uint32_t nTicks = static_cast<uint32_t>(profiler_ticks() - nRunBegin);
+
+			if (nw.GetReceived() != nReceived) {
+				const struct TE131DataPacket *pPacket = &pPackets[(nw.GetReceived() - 1) % nPackets];
+
+				if (pPacket->DMPLayer.PropertyValues[0] == E131_START_CODE_DMX) {
+					samples_add(&tFrame, nTicks);
+				} else {
+					samples_add(&tPriority, nTicks);
+				}
+			}
+		}
+
+		nElapsed += profiler_ticks() - nRoundBegin;
+
+		if (nRound == 0) {
+			continue;
+		}
+
+		for (uint32_t nPort = 0; nPort < PRIORITY_PORTS; nPort++) {
+			const uint8_t *pData = lightSet.GetData(nPort);
+
+			nChecks++;
+
+			if (lightSet.GetLength(nPort) != PRIORITY_SLOTS) {
+				if (nErrors++ < 8) {
+					printf("  FAIL      : round %u port %u length %u\n", nRound, nPort, lightSet.GetLength(nPort));
+				}
+				continue;
+			}
+
+			for (uint32_t nSlot = 0; nSlot < PRIORITY_SLOTS; nSlot++) {
+				const uint8_t nExpected = reference_merge(nRound, nPort, nSlot);
+
+				if (pData[nSlot] != nExpected) {
+					if (nErrors++ < 8) {
+						printf("  FAIL      : round %u port %u slot %u is %u, expected %u\n", nRound, nPort, nSlot, pData[nSlot], nExpected);
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	const uint32_t nFrames = nRounds * PRIORITY_PORTS;
+
+	printf("Benchmark priority, %u ports, %u sources, %u slots, %u rounds\n", PRIORITY_PORTS, PRIORITY_SOURCES, PRIORITY_SLOTS, nRounds);
+	printf(" Packets    : %u received, %u DMX updates\n", nw.GetReceived(), lightSet.GetUpdates());
+	printf(" Per frame  : %u ns (a 0xDD and a DMX packet of each source)\n", static_cast<uint32_t>(nElapsed / nFrames));
+	printf(" Checked    : %u port outputs, %u errors\n", nChecks, nErrors);
+
+	puts("Durations (ns)");
+	samples_print(&tFrame);
+	samples_print(&tPriority);
+
+	for (const struct profiler_section *pSection = profiler_get_first(); pSection != 0; pSection = pSection->next) {
+		if ((pSection->count != 0) && (strcmp(pSection->name, "e131.slotmerge") == 0)) {
+			printf(" %-10s : %u calls, avg %u, min %u, max %u\n", pSection->name, pSection->count, static_cast<uint32_t>(pSection->total / pSection->count), static_cast<uint32_t>(pSection->min), static_cast<uint32_t>(pSection->max));
+		}
+	}
+
+	delete[] tPriority.pSamples;
+	delete[] tFrame.pSamples;
+	delete[] pPackets;
+
+	const int nResult = ((nErrors == 0) && (nChecks != 0)) ? 0 : -1;
+
+	puts(nResult == 0 ? "PASS" : "FAIL");
+
+	return nResult;
+}
@@ -0,0 +1,616 @@
+/**
+ * @file rdm.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "hardware.h"
+#include "networkpcap.h"
+
+#include "artnetnode.h"
+#include "artnetrdm.h"
+
+#include "rdm.h"
+
+#include "lightset.h"
+
+#include "profiler.h"
+
+#include "benchmark.h"
+
+/*
+ * ArtRdm requests are interleaved with ArtDmx packets, the packets are released
+ * in real time. The RDM bus is simulated: the response is available when
+ * nTransactionMicros have passed since the request was sent, every 8th request
+ * has no response (time-out).
+ *
+ * The blocking Handler() is compared with HandlerStart()/HandlerPoll().
+ * Checked are the replies (destination, transaction number, command class),
+ * that a transaction is never started while the bus is busy, that the LightSet
+ * of the port is not started or stopped during a transaction, and that with
+ * the non-blocking path a Run() never waits for the bus.
+ *
+ * An ArtTodControl (AtcFlush) that arrives during a transaction must not wait
+ * for it either: the discovery follows the reply, then the ArtTodData is sent.
+ */
+
+#define RDM_SLOT_MICROS			250		///< A packet every 250 us
+#define RDM_SLOTS_PER_REQUEST	16		///< 1 ArtRdm and 15 ArtDmx
+#define RDM_CONTROLLERS			4
+#define RDM_NO_RESPONSE_MASK	7		///< Every 8th request is not answered
+#define RDM_BURST				(2 * ARTNET_RDM_QUEUE_ENTRIES)
+
+#define RDM_GET_COMMAND				0x20
+#define RDM_GET_COMMAND_RESPONSE	0x21
+
+static uint32_t controller_ip(uint32_t nController) {
+	return 0x0002A8C0 | ((nController + 1) << 24);	// 192.168.2.(nController + 1)
+}
+
+class SimulatedRdm: public ArtNetRdm {
+public:
+	SimulatedRdm(bool bIsBlocking, uint32_t nTransactionMicros):
+		m_bIsBlocking(bIsBlocking),
+		m_nTransactionMicros(nTransactionMicros),
+		m_bIsBusy(false),
+		m_nStartMicros(0),
+		m_nTransactions(0),
+		m_nOverlaps(0),
+		m_nFulls(0),
+		m_nFullsBusy(0)
+	{
+		memset(&m_Response, 0, sizeof(struct TRdmMessage));
+	}
+	~SimulatedRdm(void) {
+	}
+
+	void Full(uint8_t nPort) {
+		m_nFulls++;
+
+		if (m_bIsBusy) {
+			m_nFullsBusy++;
+		}
+	}
+
+	uint8_t GetUidCount(uint8_t nPort) {
+		return 0;
+	}
+
+	void Copy(uint8_t nPort, uint8_t *pTod) {
+	}
+
+	const uint8_t *Handler(uint8_t nPort, const uint8_t *pRdmData) {
+		Begin(pRdmData);
+
+		while ((Hardware::Get()->Micros() - m_nStartMicros) < m_nTransactionMicros) {
+		}
+
+		return End();
+	}
+
+	bool HandlerStart(uint8_t nPort, const uint8_t *pRdmData) {
+		if (m_bIsBlocking) {
+			return ArtNetRdm::HandlerStart(nPort, pRdmData);
+		}
+
+		if (m_bIsBusy) {
+			m_nOverlaps++;
+			return false;
+		}
+
+		Begin(pRdmData);
+		return true;
+	}
+
+	bool HandlerPoll(uint8_t nPort, const uint8_t*& pResponse) {
+		if (m_bIsBlocking) {
+			return ArtNetRdm::HandlerPoll(nPort, pResponse);
+		}
+
+		if ((Hardware::Get()->Micros() - m_nStartMicros) < m_nTransactionMicros) {
+			return false;
+		}
+
+		pResponse = End();
+		return true;
+	}
+
+	bool IsBusy(void) const {
+		return m_bIsBusy;
+	}
+
+	uint32_t GetTransactions(void) const {
+		return m_nTransactions;
+	}
+
+	uint32_t GetOverlaps(void) const {
+		return m_nOverlaps;
+	}
+
+	uint32_t GetFulls(void) const {
+		return m_nFulls;
+	}
+
+	uint32_t GetFullsBusy(void) const {
+		return m_nFullsBusy;
+	}
+
+private:
+	void Begin(const uint8_t *pRdmData) {
+		const struct TRdmMessageNoSc *pRequest = reinterpret_cast<const struct TRdmMessageNoSc *>(pRdmData);
+
+		m_Response.start_code = 0xCC;
+		m_Response.sub_start_code = pRequest->sub_start_code;
+		m_Response.message_length = RDM_MESSAGE_MINIMUM_SIZE;
+		memcpy(m_Response.destination_uid, pRequest->source_uid, RDM_UID_SIZE);
+		memcpy(m_Response.source_uid, pRequest->destination_uid, RDM_UID_SIZE);
+		m_Response.transaction_number = pRequest->transaction_number;
+		m_Response.command_class = static_cast<uint8_t>(pRequest->command_class + 1);
+		memcpy(m_Response.param_id, pRequest->param_id, 2);
+
+		m_bIsBusy = true;
+		m_nStartMicros = Hardware::Get()->Micros();
+	}
+
+	const uint8_t *End(void) {
+		m_bIsBusy = false;
+		m_nTransactions++;
+
+		if ((m_Response.transaction_number & RDM_NO_RESPONSE_MASK) == RDM_NO_RESPONSE_MASK) {
+			return 0;
+		}
+
+		return reinterpret_cast<const uint8_t *>(&m_Response);
+	}
+
+private:
+	bool m_bIsBlocking;
+	uint32_t m_nTransactionMicros;
+	bool m_bIsBusy;
+	uint32_t m_nStartMicros;
+	uint32_t m_nTransactions;
+	uint32_t m_nOverlaps;
+	uint32_t m_nFulls;
+	uint32_t m_nFullsBusy;
+	struct TRdmMessage m_Response;
+};
+
+class CheckLightSet: public LightSet {
+public:
+	CheckLightSet(void): m_pRdm(0), m_nUpdates(0), m_nViolations(0) {
+	}
+	~CheckLightSet(void) {
+	}
+
+	void SetRdm(const SimulatedRdm *pRdm) {
+		m_pRdm = pRdm;
+	}
+
+	void Start(uint8_t nPort) {
+		Check();
+	}
+
+	void Stop(uint8_t nPort) {
+		Check();
+	}
+
+	void SetData(uint8_t nPort, const uint8_t *pData, uint16_t nLength) {
+		m_nUpdates++;
+	}
+
+	uint32_t GetUpdates(void) const {
+		return m_nUpdates;
+	}
+
+	uint32_t GetViolations(void) const {
+		return m_nViolations;
+	}
+
+private:
+	void Check(void) {
+		if ((m_pRdm != 0) && m_pRdm->IsBusy()) {
+			m_nViolations++;
+		}
+	}
+
+private:
+	const SimulatedRdm *m_pRdm;
+	uint32_t m_nUpdates;
+	uint32_t m_nViolations;
+};
+
+/*
+ * The replies are checked in the send hook, in order
+ */
+static uint32_t s_nReplies;
+static uint32_t s_nBadReplies;
+static uint8_t s_nExpectedTransaction;
+
+static void send_hook(const uint8_t *pBuffer, uint16_t nLength, uint32_t nToIp, uint16_t nRemotePort) {
+	const struct TArtRdm *pArtRdm = reinterpret_cast<const struct TArtRdm *>(pBuffer);
+
+	if ((nLength < 9) || (pArtRdm->OpCode != OP_RDM)) {
+		return;
+	}
+
+	const struct TRdmMessageNoSc *pResponse = reinterpret_cast<const struct TRdmMessageNoSc *>(pArtRdm->RdmPacket);
+
+	// The requests without a response are skipped
+	while ((s_nExpectedTransaction & RDM_NO_RESPONSE_MASK) == RDM_NO_RESPONSE_MASK) {
+		s_nExpectedTransaction++;
+	}
+
+	const uint32_t nController = s_nExpectedTransaction % RDM_CONTROLLERS;
+
+	if ((pResponse->transaction_number != s_nExpectedTransaction)
+			|| (pResponse->command_class != RDM_GET_COMMAND_RESPONSE)
+			|| (pArtRdm->Address != 1)
+			|| (nToIp != controller_ip(nController))
+			|| (nRemotePort != ARTNET_UDP_PORT)) {
+		printf(" Bad reply  : transaction %u, expected %u\n", pResponse->transaction_number, s_nExpectedTransaction);
+		s_nBadReplies++;
+	}
+
+	s_nExpectedTransaction++;
+	s_nReplies++;
+}
+
+static void make_request(struct TArtRdm *pArtRdm, uint8_t nTransaction) {
+	memset(pArtRdm, 0, sizeof(struct TArtRdm));
+	memcpy(pArtRdm->Id, "Art-Net", 8);
+	pArtRdm->OpCode = OP_RDM;
+	pArtRdm->ProtVerLo = ARTNET_PROTOCOL_REVISION;
+	pArtRdm->RdmVer = 0x01;
+	pArtRdm->Address = 1;
+
+	struct TRdmMessageNoSc *pRequest = reinterpret_cast<struct TRdmMessageNoSc *>(pArtRdm->RdmPacket);
+
+	pRequest->sub_start_code = 0x01;
+	pRequest->message_length = RDM_MESSAGE_MINIMUM_SIZE;
+	memset(pRequest->destination_uid, 0x11, RDM_UID_SIZE);
+	memset(pRequest->source_uid, 0x22, RDM_UID_SIZE);
+	pRequest->transaction_number = nTransaction;
+	pRequest->slot16.port_id = 1;
+	pRequest->command_class = RDM_GET_COMMAND;
+	pRequest->param_id[0] = 0x00;
+	pRequest->param_id[1] = 0x60;	// DEVICE_INFO
+}
+
+static void make_dmx(struct TArtDmx *pArtDmx) {
+	memset(pArtDmx, 0, sizeof(struct TArtDmx));
+	memcpy(pArtDmx->Id, "Art-Net", 8);
+	pArtDmx->OpCode = OP_DMX;
+	pArtDmx->ProtVerLo = ARTNET_PROTOCOL_REVISION;
+	pArtDmx->PortAddress = 1;
+	pArtDmx->LengthHi = 2;	// 512
+}
+
+static uint64_t thread_nanos(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL) + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+/*
+ * The packets are released every nSlotMicros, runs until all requests are handled.
+ * A Run() of at least nLongNanos is counted when it also used that much processor time,
+ * a Run() that was preempted by the host is not waiting for the bus.
+ */
+static uint32_t run(NetworkPcap &nw, ArtNetNode &node, const SimulatedRdm &rdm, uint32_t nRequests, uint32_t nLongNanos, struct TSamples *pRun, struct TSamples *pLate) {
+	const uint32_t nTimeOutMicros = (nw.GetPackets() * RDM_SLOT_MICROS) + 1000000;
+	const uint32_t nBeginMicros = Hardware::Get()->Micros();
+	uint32_t nLongRuns = 0;
+
+	nw.Rewind();
+
+	for (;;) {
+		const uint32_t nElapsed = Hardware::Get()->Micros() - nBeginMicros;
+
+		nw.SetAvailable(1 + (nElapsed / RDM_SLOT_MICROS));
+
+		if ((nw.IsEnd() && (rdm.GetTransactions() == nRequests)) || (nElapsed > nTimeOutMicros)) {
+			return nLongRuns;
+		}
+
+		const uint32_t nReceived = nw.GetReceived();
+		const uint64_t nCpuBegin = thread_nanos();
+		const profiler_ticks_t nRunBegin = profiler_ticks();
+
+		node.Run();
+
+		const uint32_t nTicks = static_cast<uint32_t>(profiler_ticks() - nRunBegin);
+
+		samples_add(pRun, nTicks);
+
+		if ((nTicks >= nLongNanos) && ((thread_nanos() - nCpuBegin) >= nLongNanos)) {
+			nLongRuns++;
+		}
+
+		if (nw.GetReceived() != nReceived) {
+			const uint32_t nDueMicros = (nw.GetReceived() - 1) * RDM_SLOT_MICROS;
+			const uint32_t nNowMicros = Hardware::Get()->Micros() - nBeginMicros;
+			samples_add(pLate, (nNowMicros > nDueMicros) ? (nNowMicros - nDueMicros) : 0);
+		}
+	}
+}
+
+static int run_mode(NetworkPcap &nw, bool bIsBlocking, uint32_t nRequests, uint32_t nTransactionMicros, const uint8_t *pPackets, uint32_t nPacketSize) {
+	const uint32_t nPackets = nRequests * RDM_SLOTS_PER_REQUEST;
+
+	nw.Create(nPackets);
+
+	for (uint32_t i = 0; i < nPackets; i++) {
+		const uint8_t *pPacket = &pPackets[i * nPacketSize];
+
+		if ((i % RDM_SLOTS_PER_REQUEST) == 0) {
+			const uint32_t nController = (i / RDM_SLOTS_PER_REQUEST) % RDM_CONTROLLERS;
+			nw.Add(pPacket, sizeof(struct TArtRdm), controller_ip(nController), ARTNET_UDP_PORT, ARTNET_UDP_PORT);
+		} else {
+			nw.Add(pPacket, sizeof(struct TArtDmx), controller_ip(0), ARTNET_UDP_PORT, ARTNET_UDP_PORT);
+		}
+	}
+
+	nw.SetSendHook(send_hook);
+
+	SimulatedRdm rdm(bIsBlocking, nTransactionMicros);
+	CheckLightSet lightSet;
+
+	lightSet.SetRdm(&rdm);
+
+	ArtNetNode node;
+
+	node.SetUniverseSwitch(0, ARTNET_OUTPUT_PORT, 1);
+	node.SetOutput(&lightSet);
+	node.SetRdmHandler(&rdm);
+	node.Start();
+
+	s_nReplies = 0;
+	s_nBadReplies = 0;
+	s_nExpectedTransaction = 0;
+
+	struct TSamples tRun = { "run", new uint32_t[MAX_SAMPLES], 0 };
+	struct TSamples tLate = { "late (us)", new uint32_t[MAX_SAMPLES], 0 };	///< Packet received after it was released
+
+	// A Run() that waited for the bus
+	const uint32_t nLongRuns = run(nw, node, rdm, nRequests, nTransactionMicros * 1000 / 2, &tRun, &tLate);
+
+	uint32_t nResponses = 0;
+
+	for (uint32_t i = 0; i < nRequests; i++) {
+		if ((i & RDM_NO_RESPONSE_MASK) != RDM_NO_RESPONSE_MASK) {
+			nResponses++;
+		}
+	}
+
+	printf(" %s\n", bIsBlocking ? "Handler (blocking)" : "HandlerStart/HandlerPoll");
+	printf("  Requests  : %u, transactions %u, replies %u (expected %u), bad %u\n", nRequests, rdm.GetTransactions(), s_nReplies, nResponses, s_nBadReplies);
+	printf("  DMX       : %u updates, LightSet start/stop during a transaction %u, overlapping transactions %u\n", lightSet.GetUpdates(), lightSet.GetViolations(), rdm.GetOverlaps());
+
+	puts("  Durations (ns)");
+	samples_print(&tRun);
+	samples_print(&tLate);
+
+	printf("  Long Run(): %u\n", nLongRuns);
+
+	int nResult = 0;
+
+	if ((rdm.GetTransactions() != nRequests) || (s_nReplies != nResponses) || (s_nBadReplies != 0) || (lightSet.GetViolations() != 0) || (rdm.GetOverlaps() != 0)) {
+		nResult = -1;
+	}
+
+	if ((lightSet.GetUpdates() != (nRequests * (RDM_SLOTS_PER_REQUEST - 1)))) {
+		printf("  FAIL      : DMX updates\n");
+		nResult = -1;
+	}
+
+	if (!bIsBlocking && (nLongRuns >= (nRequests / 4))) {
+		printf("  FAIL      : Run() waits for the RDM transaction\n");
+		nResult = -1;
+	}
+
+	delete[] tLate.pSamples;
+	delete[] tRun.pSamples;
+
+	return nResult;
+}
+
+/*
+ * RDM_BURST requests back to back, the first is started, ARTNET_RDM_QUEUE_ENTRIES - 1 wait.
+ */
+static int run_burst(NetworkPcap &nw, uint32_t nTransactionMicros) {
+	struct TArtRdm *pRequests = new struct TArtRdm[RDM_BURST];
+
+	nw.Create(RDM_BURST);
+	nw.SetSendHook(0);
+
+	for (uint32_t i = 0; i < RDM_BURST; i++) {
+		make_request(&pRequests[i], static_cast<uint8_t>(i));
+		nw.Add(reinterpret_cast<const uint8_t *>(&pRequests[i]), sizeof(struct TArtRdm), controller_ip(i % RDM_CONTROLLERS), ARTNET_UDP_PORT, ARTNET_UDP_PORT);
+	}
+
+	SimulatedRdm rdm(false, nTransactionMicros);
+	CheckLightSet lightSet;
+
+	ArtNetNode node;
+
+	node.SetUniverseSwitch(0, ARTNET_OUTPUT_PORT, 1);
+	node.SetOutput(&lightSet);
+	node.SetRdmHandler(&rdm);
+	node.Start();
+
+	for (uint32_t i = 0; i < RDM_BURST; i++) {
+		node.Run();
+	}
+
+	// Until the queue is handled, the time-out is generous for a loaded host. Then no other request may follow.
+	uint32_t nBeginMicros = Hardware::Get()->Micros();
+
+	while (((rdm.GetTransactions() < ARTNET_RDM_QUEUE_ENTRIES) || rdm.IsBusy()) && ((Hardware::Get()->Micros() - nBeginMicros) < (100 * nTransactionMicros))) {
+		node.Run();
+	}
+
+	nBeginMicros = Hardware::Get()->Micros();
+
+	while ((Hardware::Get()->Micros() - nBeginMicros) < (2 * nTransactionMicros)) {
+		node.Run();
+	}
+
+	printf(" Burst of %u requests, queue %u : %u transactions\n", RDM_BURST, ARTNET_RDM_QUEUE_ENTRIES, rdm.GetTransactions());
+
+	delete[] pRequests;
+
+	return (rdm.GetTransactions() == ARTNET_RDM_QUEUE_ENTRIES) ? 0 : -1;
+}
+
+/*
+ * The order of the packets sent, in the send hook
+ */
+static uint32_t s_nTodSent;
+static uint32_t s_nTodReplySent;
+static uint32_t s_nTodDataSent;
+
+static void tod_hook(const uint8_t *pBuffer, uint16_t nLength, uint32_t nToIp, uint16_t nRemotePort) {
+	const struct TArtTodData *pArtTodData = reinterpret_cast<const struct TArtTodData *>(pBuffer);
+
+	if (nLength < 10) {
+		return;
+	}
+
+	s_nTodSent++;
+
+	if (pArtTodData->OpCode == OP_RDM) {
+		s_nTodReplySent = s_nTodSent;
+	} else if (pArtTodData->OpCode == OP_TODDATA) {
+		s_nTodDataSent = s_nTodSent;
+	}
+}
+
+static int run_todcontrol(NetworkPcap &nw, uint32_t nTransactionMicros) {
+	struct TArtRdm artRdm;
+	struct TArtTodControl artTodControl;
+
+	make_request(&artRdm, 0);
+
+	memset(&artTodControl, 0, sizeof(struct TArtTodControl));
+	memcpy(artTodControl.Id, "Art-Net", 8);
+	artTodControl.OpCode = OP_TODCONTROL;
+	artTodControl.ProtVerLo = ARTNET_PROTOCOL_REVISION;
+	artTodControl.Command = 0x01;	// AtcFlush
+	artTodControl.Address = 1;
+
+	nw.Create(2);
+	nw.Add(reinterpret_cast<const uint8_t *>(&artRdm), sizeof(struct TArtRdm), controller_ip(0), ARTNET_UDP_PORT, ARTNET_UDP_PORT);
+	nw.Add(reinterpret_cast<const uint8_t *>(&artTodControl), sizeof(struct TArtTodControl), controller_ip(1), ARTNET_UDP_PORT, ARTNET_UDP_PORT);
+	nw.SetSendHook(tod_hook);
+
+	SimulatedRdm rdm(false, nTransactionMicros);
+	CheckLightSet lightSet;
+
+	lightSet.SetRdm(&rdm);
+
+	ArtNetNode node;
+
+	node.SetUniverseSwitch(0, ARTNET_OUTPUT_PORT, 1);
+	node.SetOutput(&lightSet);
+	node.SetRdmHandler(&rdm);
+	node.Start();
+
+	s_nTodSent = 0;
+	s_nTodReplySent = 0;
+	s_nTodDataSent = 0;
+
+	// The ArtRdm starts the transaction
+	node.Run();
+
+	// The Run() that handles the ArtTodControl
+	const uint64_t nCpuBegin = thread_nanos();
+	const profiler_ticks_t nRunBegin = profiler_ticks();
+
+	node.Run();
+
+	const uint32_t nRunNanos = static_cast<uint32_t>(profiler_ticks() - nRunBegin);
+	const uint64_t nCpuNanos = thread_nanos() - nCpuBegin;
+	const bool bIsWaiting = (nRunNanos >= (nTransactionMicros * 1000 / 2)) && (nCpuNanos >= (nTransactionMicros * 1000 / 2));
+
+	const uint32_t nBeginMicros = Hardware::Get()->Micros();
+
+	while ((s_nTodDataSent == 0) && ((Hardware::Get()->Micros() - nBeginMicros) < (100 * nTransactionMicros))) {
+		node.Run();
+	}
+
+	printf(" ArtTodControl during a transaction : Run() %u ns, reply #%u, ArtTodData #%u, discovery %u (%u during a transaction)\n", nRunNanos, s_nTodReplySent, s_nTodDataSent, rdm.GetFulls(), rdm.GetFullsBusy());
+
+	int nResult = 0;
+
+	if (bIsWaiting) {
+		printf("  FAIL      : Run() waits for the RDM transaction\n");
+		nResult = -1;
+	}
+
+	if ((rdm.GetFulls() != 1) || (rdm.GetFullsBusy() != 0) || (lightSet.GetViolations() != 0)) {
+		printf("  FAIL      : discovery\n");
+		nResult = -1;
+	}
+
+	if ((s_nTodReplySent == 0) || (s_nTodDataSent <= s_nTodReplySent)) {
+		printf("  FAIL      : the ArtTodData does not follow the reply\n");
+		nResult = -1;
+	}
+
+	return nResult;
+}
+
+int rdm_benchmark(NetworkPcap &nw, uint32_t nRequests, uint32_t nTransactionMicros) {
+	const uint32_t nPacketSize = sizeof(struct TArtDmx) > sizeof(struct TArtRdm) ? sizeof(struct TArtDmx) : sizeof(struct TArtRdm);
+	const uint32_t nPackets = nRequests * RDM_SLOTS_PER_REQUEST;
+	uint8_t *pPackets = new uint8_t[nPackets * nPacketSize];
+
+	for (uint32_t i = 0; i < nPackets; i++) {
+		uint8_t *pPacket = &pPackets[i * nPacketSize];
+
+		if ((i % RDM_SLOTS_PER_REQUEST) == 0) {
+			make_request(reinterpret_cast<struct TArtRdm *>(pPacket), static_cast<uint8_t>(i / RDM_SLOTS_PER_REQUEST));
+		} else {
+			struct TArtDmx *pArtDmx = reinterpret_cast<struct TArtDmx *>(pPacket);
+			make_dmx(pArtDmx);
+			pArtDmx->Data[0] = static_cast<uint8_t>(i);
+		}
+	}
+
+	printf("Benchmark rdm, %u requests, transaction %u us, a packet every %u us\n", nRequests, nTransactionMicros, RDM_SLOT_MICROS);
+
+	int nResult = run_mode(nw, true, nRequests, nTransactionMicros, pPackets, nPacketSize);
+	nResult |= run_mode(nw, false, nRequests, nTransactionMicros, pPackets, nPacketSize);
+	nResult |= run_burst(nw, nTransactionMicros);
+	nResult |= run_todcontrol(nw, nTransactionMicros);
+
+	puts(nResult == 0 ? "PASS" : "FAIL");
+
+	delete[] pPackets;
+
+	return nResult;
+}
@@ -0,0 +1,651 @@
+/**
+ * @file rdmpid.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "rdmhandler.h"
+#include "rdmmanufacturerpid.h"
+#include "rdmdeviceresponder.h"
+#include "rdmpersonality.h"
+#include "rdmidentify.h"
+
+#include "rdm.h"
+#include "rdm_e120.h"
+
+#include "lightset.h"
+
+#include "profiler.h"
+
+#include "benchmark.h"
+
+/*
+ * The hashed PID dispatch of RDMHandler is checked against a table of the
+ * PIDs the responder implements, searched linearly. Every PID 0x0000-0xFFFF
+ * is sent as GET with 0 to 4 parameter bytes, GET to sub-device 1, SET and
+ * broadcast SET, for RDM and for RDMNet.
+ *
+ * The response is known from the table for unknown PIDs (NACK UNKNOWN_PID),
+ * for PIDs not enabled for RDM or RDMNet, for a missing GET or SET handler,
+ * for a wrong GET parameter size and for sub-device 1, which does not exist.
+ * It must then be byte-equal, as must SUPPORTED_PARAMETERS, which lists the
+ * E1.20 PIDs followed by the manufacturer PIDs below, the GET of the labels,
+ * language, factory defaults and start address, which follow from the
+ * responder, and the responses of the manufacturer PIDs. Other requests must
+ * reach the PID handler: neither UNKNOWN_PID nor UNSUPPORTED_COMMAND_CLASS,
+ * with the PID and command class of the request, and a GET ACK with the
+ * length of the table when that is fixed. The hit counters must match the requests dispatched to a
+ * PID, rdm.unknown_pid the NACKs with UNKNOWN_PID.
+ *
+ * Reported is the duration of HandleData() for known and for unknown PIDs,
+ * and of the linear search of the table, which is what the hashed dispatch
+ * replaced.
+ */
+
+#define RDMPID_SOURCE_UID			{ 0x7F, 0xF0, 0x00, 0x00, 0x00, 0x01 }
+#define RDMPID_SLOTS				4
+#define RDMPID_SET_BROADCAST_LENGTH	5
+
+static bool manufacturer_get(uint16_t nSubDevice, const struct TRdmMessageNoSc *pRdmDataIn, struct TRdmMessage *pRdmDataOut, uint16_t &nReason) {
+	if (nSubDevice != 0) {
+		nReason = E120_NR_SUB_DEVICE_OUT_OF_RANGE;
+		return false;
+	}
+
+	pRdmDataOut->param_data[0] = pRdmDataIn->param_id[0];
+	pRdmDataOut->param_data[1] = pRdmDataIn->param_id[1];
+	pRdmDataOut->param_data_length = 2;
+
+	return true;
+}
+
+static bool manufacturer_set(__attribute__((unused)) bool bIsBroadcast, __attribute__((unused)) uint16_t nSubDevice, const struct TRdmMessageNoSc *pRdmDataIn, __attribute__((unused)) struct TRdmMessage *pRdmDataOut, uint16_t &nReason) {
+	if (pRdmDataIn->param_data_length != 1) {
+		nReason = E120_NR_FORMAT_ERROR;
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * These take precedence over the empty default of lib-rdm
+ */
+extern const struct TRdmManufacturerPid RDM_MANUFACTURER_PIDS[] = {
+	{ 0x8000, manufacturer_get, 0,                0, true,  true,  false },
+	{ 0x8001, manufacturer_get, manufacturer_set, 1, true,  true,  true  },
+	{ 0xFFDF, 0,                manufacturer_set, 0, false, true,  true  }
+};
+
+extern const uint32_t RDM_MANUFACTURER_PIDS_COUNT = sizeof(RDM_MANUFACTURER_PIDS) / sizeof(RDM_MANUFACTURER_PIDS[0]);
+
+/*
+ * The root device PIDs as E1.20, E1.37-1 and E1.37-2 define them for this
+ * responder, in the order of SUPPORTED_PARAMETERS
+ */
+struct TRdmPidExpected {
+	uint16_t nPid;
+	bool bGet;
+	bool bSet;
+	uint8_t nGetArgumentSize;
+	uint8_t nGetLength;			///< Of the ACK, 0 is variable
+	bool bIncludeInSupportedParams;
+	bool bRDM;
+	bool bRDMNet;
+};
+
+static const struct TRdmPidExpected s_Pids[] = {
+	{ E120_SUPPORTED_PARAMETERS,               true,  false, 0,  0, false, true,  false },
+	{ E120_DEVICE_INFO,                        true,  false, 0, 19, false, true,  true  },
+	{ E120_PRODUCT_DETAIL_ID_LIST,             true,  false, 0,  0, true,  true,  false },
+	{ E120_DEVICE_MODEL_DESCRIPTION,           true,  false, 0,  0, true,  true,  true  },
+	{ E120_MANUFACTURER_LABEL,                 true,  false, 0,  0, true,  true,  true  },
+	{ E120_DEVICE_LABEL,                       true,  true,  0,  0, true,  true,  true  },
+	{ E120_FACTORY_DEFAULTS,                   true,  true,  0,  1, true,  true,  true  },
+	{ E120_LANGUAGE_CAPABILITIES,              true,  false, 0,  0, true,  true,  false },
+	{ E120_LANGUAGE,                           true,  true,  0,  2, true,  true,  false },
+	{ E120_SOFTWARE_VERSION_LABEL,             true,  false, 0,  0, false, true,  false },
+	{ E120_BOOT_SOFTWARE_VERSION_ID,           true,  false, 0,  4, true,  true,  false },
+	{ E120_BOOT_SOFTWARE_VERSION_LABEL,        true,  false, 0,  0, true,  true,  false },
+	{ E120_DMX_PERSONALITY,                    true,  true,  0,  2, true,  true,  false },
+	{ E120_DMX_PERSONALITY_DESCRIPTION,        true,  false, 1,  0, true,  true,  false },
+	{ E120_DMX_START_ADDRESS,                  true,  true,  0,  2, false, true,  false },
+	{ E120_SLOT_INFO,                          true,  false, 0,  0, true,  true,  false },
+	{ E120_SLOT_DESCRIPTION,                   true,  false, 2,  0, true,  true,  false },
+	{ E120_SENSOR_DEFINITION,                  true,  false, 1,  0, true,  true,  false },
+	{ E120_SENSOR_VALUE,                       true,  true,  1,  0, true,  true,  false },
+	{ E120_RECORD_SENSORS,                     false, true,  0,  0, true,  true,  false },
+	{ E120_DEVICE_HOURS,                       true,  true,  0,  4, true,  true,  false },
+	{ E120_REAL_TIME_CLOCK,                    true,  true,  0,  7, true,  true,  false },
+	{ E120_IDENTIFY_DEVICE,                    true,  true,  0,  1, false, true,  true  },
+	{ E120_RESET_DEVICE,                       false, true,  0,  0, true,  true,  true  },
+	{ E120_POWER_STATE,                        true,  true,  0,  1, true,  true,  false },
+	{ E137_1_IDENTIFY_MODE,                    true,  true,  0,  1, true,  true,  false },
+	{ E137_2_LIST_INTERFACES,                  true,  false, 0,  0, false, false, true  },
+	{ E137_2_INTERFACE_LABEL,                  true,  false, 4,  0, false, false, true  },
+	{ E137_2_INTERFACE_HARDWARE_ADDRESS_TYPE1, true,  false, 4, 10, false, false, true  },
+	{ E137_2_IPV4_DHCP_MODE,                   true,  true,  4,  5, false, false, true  },
+	{ E137_2_IPV4_ZEROCONF_MODE,               true,  true,  4,  5, false, false, true  },
+	{ E137_2_IPV4_CURRENT_ADDRESS,             true,  false, 4, 10, false, false, true  },
+	{ E137_2_IPV4_STATIC_ADDRESS,              true,  true,  4,  9, false, false, true  },
+	{ E137_2_INTERFACE_APPLY_CONFIGURATION,    false, true,  4,  0, false, false, true  },
+	{ E137_2_DNS_IPV4_NAME_SERVER,             true,  false, 1,  0, false, false, true  },
+	{ E137_2_IPV4_DEFAULT_ROUTE,               true,  true,  4,  0, false, false, true  },
+	{ E137_2_DNS_HOSTNAME,                     true,  true,  0,  0, false, false, true  },
+	{ E137_2_DNS_DOMAIN_NAME,                  true,  true,  0,  0, false, false, true  }
+};
+
+#define RDMPID_PIDS		(sizeof(s_Pids) / sizeof(s_Pids[0]))
+
+class RdmPidIdentify: public RDMIdentify {
+public:
+	void SetMode(TRdmIdentifyMode nMode) {
+		m_nMode = nMode;
+	}
+};
+
+class RdmPidOutput: public LightSet {
+public:
+	void Start(__attribute__((unused)) uint8_t nPort) {}
+	void Stop(__attribute__((unused)) uint8_t nPort) {}
+	void SetData(__attribute__((unused)) uint8_t nPort, __attribute__((unused)) const uint8_t *pData, __attribute__((unused)) uint16_t nLength) {}
+
+	// GET SLOT_INFO fills the response for the whole footprint
+	uint16_t GetDmxFootprint(void) {
+		return RDMPID_SLOTS;
+	}
+};
+
+struct TRdmPidRequest {
+	uint8_t nCommandClass;
+	uint16_t nSubDevice;
+	uint8_t nParamDataLength;
+	bool bIsBroadcast;
+};
+
+static uint8_t s_Request[sizeof(struct TRdmMessage)];
+static uint8_t s_Response[sizeof(struct TRdmMessage)];
+static uint8_t s_Expected[sizeof(struct TRdmMessage)];
+
+/*
+ * The handlers change the request, it is built again for every call
+ */
+static void request_build(const uint8_t *pUid, uint16_t nPid, const struct TRdmPidRequest *pRequest) {
+	static const uint8_t s_SourceUid[RDM_UID_SIZE] = RDMPID_SOURCE_UID;
+	struct TRdmMessageNoSc *pRdmRequest = reinterpret_cast<struct TRdmMessageNoSc*>(s_Request);
+
+	memset(s_Request, 0, sizeof(s_Request));
+
+	pRdmRequest->sub_start_code = E120_SC_SUB_MESSAGE;
+	pRdmRequest->message_length = static_cast<uint8_t>(RDM_MESSAGE_MINIMUM_SIZE + pRequest->nParamDataLength);
+	memcpy(pRdmRequest->destination_uid, pRequest->bIsBroadcast ? UID_ALL : pUid, RDM_UID_SIZE);
+	memcpy(pRdmRequest->source_uid, s_SourceUid, RDM_UID_SIZE);
+	pRdmRequest->transaction_number = static_cast<uint8_t>(nPid);
+	pRdmRequest->sub_device[0] = static_cast<uint8_t>(pRequest->nSubDevice >> 8);
+	pRdmRequest->sub_device[1] = static_cast<uint8_t>(pRequest->nSubDevice);
+	pRdmRequest->command_class = pRequest->nCommandClass;
+	pRdmRequest->param_id[0] = static_cast<uint8_t>(nPid >> 8);
+	pRdmRequest->param_id[1] = static_cast<uint8_t>(nPid);
+	pRdmRequest->param_data_length = pRequest->nParamDataLength;
+
+	for (uint32_t i = 0; i < pRequest->nParamDataLength; i++) {
+		pRdmRequest->param_data[i] = 1;
+	}
+}
+
+/*
+ * Including the checksum, 0 is no response
+ */
+static uint32_t response_length(const uint8_t *pResponse) {
+	if (pResponse[0] == 0xFF) {
+		return 0;
+	}
+
+	return reinterpret_cast<const struct TRdmMessage*>(pResponse)->message_length + 2U;
+}
+
+static bool response_is_nack(const uint8_t *pResponse, uint16_t nReason) {
+	const struct TRdmMessage *pRdmResponse = reinterpret_cast<const struct TRdmMessage*>(pResponse);
+
+	return (response_length(pResponse) != 0) && (pRdmResponse->slot16.response_type == E120_RESPONSE_TYPE_NACK_REASON) && (pRdmResponse->param_data[0] == (nReason >> 8)) && (pRdmResponse->param_data[1] == (nReason & 0xFF));
+}
+
+/*
+ * The response to the request in s_Request, as E1.20 6.2 defines it
+ */
+static void expected_set(const uint8_t *pUid, uint8_t nResponseType, const uint8_t *pData, uint8_t nLength) {
+	const struct TRdmMessageNoSc *pRdmRequest = reinterpret_cast<const struct TRdmMessageNoSc*>(s_Request);
+	struct TRdmMessage *pRdmResponse = reinterpret_cast<struct TRdmMessage*>(s_Expected);
+
+	memset(s_Expected, 0, sizeof(s_Expected));
+
+	pRdmResponse->start_code = E120_SC_RDM;
+	pRdmResponse->sub_start_code = pRdmRequest->sub_start_code;
+	pRdmResponse->message_length = static_cast<uint8_t>(RDM_MESSAGE_MINIMUM_SIZE + nLength);
+	memcpy(pRdmResponse->destination_uid, pRdmRequest->source_uid, RDM_UID_SIZE);
+	memcpy(pRdmResponse->source_uid, pUid, RDM_UID_SIZE);
+	pRdmResponse->transaction_number = pRdmRequest->transaction_number;
+	pRdmResponse->slot16.response_type = nResponseType;
+	pRdmResponse->sub_device[0] = pRdmRequest->sub_device[0];
+	pRdmResponse->sub_device[1] = pRdmRequest->sub_device[1];
+	pRdmResponse->command_class = static_cast<uint8_t>(pRdmRequest->command_class + 1);
+	pRdmResponse->param_id[0] = pRdmRequest->param_id[0];
+	pRdmResponse->param_id[1] = pRdmRequest->param_id[1];
+	pRdmResponse->param_data_length = nLength;
+	if (nLength != 0) {
+		memcpy(pRdmResponse->param_data, pData, nLength);
+	}
+
+	uint16_t nChecksum = 0;
+	uint32_t i;
+
+	for (i = 0; i < pRdmResponse->message_length; i++) {
+		nChecksum = static_cast<uint16_t>(nChecksum + s_Expected[i]);
+	}
+
+	s_Expected[i++] = static_cast<uint8_t>(nChecksum >> 8);
+	s_Expected[i] = static_cast<uint8_t>(nChecksum);
+}
+
+static void expected_set_nack(const uint8_t *pUid, uint16_t nReason) {
+	const uint8_t aReason[2] = { static_cast<uint8_t>(nReason >> 8), static_cast<uint8_t>(nReason) };
+	expected_set(pUid, E120_RESPONSE_TYPE_NACK_REASON, aReason, 2);
+}
+
+static void expected_set_none(void) {
+	s_Expected[0] = 0xFF;
+}
+
+static bool is_enabled(const struct TRdmManufacturerPid *pDefinition, bool bIsRdm) {
+	return bIsRdm ? pDefinition->bRDM : pDefinition->bRDMNet;
+}
+
+static const struct TRdmPidExpected *pid_find(uint16_t nPid) {
+	for (uint32_t i = 0; i < RDMPID_PIDS; i++) {
+		if (s_Pids[i].nPid == nPid) {
+			return &s_Pids[i];
+		}
+	}
+
+	return 0;
+}
+
+static const struct TRdmManufacturerPid *manufacturer_find(uint16_t nPid) {
+	for (uint32_t i = 0; i < RDM_MANUFACTURER_PIDS_COUNT; i++) {
+		if (RDM_MANUFACTURER_PIDS[i].nPid == nPid) {
+			return &RDM_MANUFACTURER_PIDS[i];
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * The GET responses that follow from the state of the responder
+ */
+static bool expected_get_data(uint16_t nPid, uint8_t *pData, uint8_t &nLength) {
+	RDMDeviceResponder *pResponder = RDMDeviceResponder::Get();
+	struct TRDMDeviceInfoData tInfo;
+
+	switch (nPid) {
+	case E120_MANUFACTURER_LABEL:
+		pResponder->GetManufacturerName(&tInfo);
+		break;
+	case E120_DEVICE_LABEL:
+		pResponder->GetLabel(RDM_ROOT_DEVICE, &tInfo);
+		break;
+	case E120_SOFTWARE_VERSION_LABEL:
+		tInfo.data = const_cast<char*>(pResponder->GetSoftwareVersion());
+		tInfo.length = pResponder->GetSoftwareVersionLength();
+		break;
+	case E120_LANGUAGE_CAPABILITIES:
+	case E120_LANGUAGE:
+		tInfo.data = const_cast<char*>(pResponder->GetLanguage());
+		tInfo.length = RDM_DEVICE_SUPPORTED_LANGUAGE_LENGTH;
+		break;
+	case E120_FACTORY_DEFAULTS:
+		pData[0] = pResponder->GetFactoryDefaults() ? 1 : 0;
+		nLength = 1;
+		return true;
+	case E120_DMX_START_ADDRESS:
+		pData[0] = static_cast<uint8_t>(pResponder->GetDmxStartAddress() >> 8);
+		pData[1] = static_cast<uint8_t>(pResponder->GetDmxStartAddress());
+		nLength = 2;
+		return true;
+	default:
+		return false;
+	}
+
+	if (tInfo.length > RDM_DEVICE_LABEL_MAX_LENGTH) {
+		return false;
+	}
+
+	memcpy(pData, tInfo.data, tInfo.length);
+	nLength = tInfo.length;
+
+	return true;
+}
+
+enum TRdmPidOutcome {
+	OUTCOME_EXACT,			///< s_Expected holds the response, 0xFF is none
+	OUTCOME_HANDLER,		///< The PID handler decides
+};
+
+/*
+ * The checks before the PID handler, in the order of RDMHandler::Handlers()
+ */
+static TRdmPidOutcome expected_build(const uint8_t *pUid, uint16_t nPid, const struct TRdmPidRequest *pRequest, bool bIsRdm, bool &bIsDispatched) {
+	bIsDispatched = false;
+
+	if (pRequest->nSubDevice != 0) {
+		expected_set_nack(pUid, E120_NR_SUB_DEVICE_OUT_OF_RANGE);
+		return OUTCOME_EXACT;
+	}
+
+	const struct TRdmManufacturerPid *pManufacturer = manufacturer_find(nPid);
+
+	if (pManufacturer != 0) {
+		if (!is_enabled(pManufacturer, bIsRdm)) {
+			expected_set_nack(pUid, E120_NR_UNKNOWN_PID);
+			return OUTCOME_EXACT;
+		}
+
+		bIsDispatched = true;
+
+		if (pRequest->nCommandClass == E120_GET_COMMAND) {
+			if (pRequest->bIsBroadcast) {
+				expected_set_none();
+			} else if (pManufacturer->pGetHandler == 0) {
+				expected_set_nack(pUid, E120_NR_UNSUPPORTED_COMMAND_CLASS);
+			} else if (pRequest->nParamDataLength != pManufacturer->nGetArgumentSize) {
+				expected_set_nack(pUid, E120_NR_FORMAT_ERROR);
+			} else {
+				// manufacturer_get
+				const uint8_t aData[2] = { static_cast<uint8_t>(nPid >> 8), static_cast<uint8_t>(nPid) };
+				expected_set(pUid, E120_RESPONSE_TYPE_ACK, aData, 2);
+			}
+		} else {
+			if (pManufacturer->pSetHandler == 0) {
+				expected_set_nack(pUid, E120_NR_UNSUPPORTED_COMMAND_CLASS);
+			} else if (pRequest->bIsBroadcast) {
+				expected_set_none();
+			} else if (pRequest->nParamDataLength != 1) {
+				// manufacturer_set
+				expected_set_nack(pUid, E120_NR_FORMAT_ERROR);
+			} else {
+				expected_set(pUid, E120_RESPONSE_TYPE_ACK, 0, 0);
+			}
+		}
+
+		return OUTCOME_EXACT;
+	}
+
+	const struct TRdmPidExpected *pPid = pid_find(nPid);
+
+	if ((pPid == 0) || !(bIsRdm ? pPid->bRDM : pPid->bRDMNet)) {
+		expected_set_nack(pUid, E120_NR_UNKNOWN_PID);
+		return OUTCOME_EXACT;
+	}
+
+	bIsDispatched = true;
+
+	if (pRequest->nCommandClass == E120_GET_COMMAND) {
+		if (pRequest->bIsBroadcast) {
+			expected_set_none();
+			return OUTCOME_EXACT;
+		}
+
+		if (!pPid->bGet) {
+			expected_set_nack(pUid, E120_NR_UNSUPPORTED_COMMAND_CLASS);
+			return OUTCOME_EXACT;
+		}
+
+		if (pRequest->nParamDataLength != pPid->nGetArgumentSize) {
+			expected_set_nack(pUid, E120_NR_FORMAT_ERROR);
+			return OUTCOME_EXACT;
+		}
+
+		if (nPid == E120_SUPPORTED_PARAMETERS) {
+			uint8_t aData[2 * (RDMPID_PIDS + RDM_MANUFACTURER_PIDS_COUNT)];
+			uint32_t nDataLength = 0;
+
+			for (uint32_t i = 0; i < RDMPID_PIDS; i++) {
+				if (s_Pids[i].bIncludeInSupportedParams) {
+					aData[nDataLength++] = static_cast<uint8_t>(s_Pids[i].nPid >> 8);
+					aData[nDataLength++] = static_cast<uint8_t>(s_Pids[i].nPid);
+				}
+			}
+
+			for (uint32_t i = 0; i < RDM_MANUFACTURER_PIDS_COUNT; i++) {
+				if (RDM_MANUFACTURER_PIDS[i].bIncludeInSupportedParams && is_enabled(&RDM_MANUFACTURER_PIDS[i], bIsRdm)) {
+					aData[nDataLength++] = static_cast<uint8_t>(RDM_MANUFACTURER_PIDS[i].nPid >> 8);
+					aData[nDataLength++] = static_cast<uint8_t>(RDM_MANUFACTURER_PIDS[i].nPid);
+				}
+			}
+
+			expected_set(pUid, E120_RESPONSE_TYPE_ACK, aData, static_cast<uint8_t>(nDataLength));
+			return OUTCOME_EXACT;
+		}
+
+		uint8_t aData[RDM_DEVICE_LABEL_MAX_LENGTH];
+		uint8_t nDataLength;
+
+		if (expected_get_data(nPid, aData, nDataLength)) {
+			expected_set(pUid, E120_RESPONSE_TYPE_ACK, aData, nDataLength);
+			return OUTCOME_EXACT;
+		}
+
+		return OUTCOME_HANDLER;
+	}
+
+	if (!pPid->bSet) {
+		expected_set_nack(pUid, E120_NR_UNSUPPORTED_COMMAND_CLASS);
+		return OUTCOME_EXACT;
+	}
+
+	return OUTCOME_HANDLER;
+}
+
+/*
+ * A response of the PID handler itself. A unicast GET is always answered,
+ * an ACK with the length that E1.20 or E1.37 defines.
+ */
+static bool handler_response_is_valid(uint16_t nPid, const struct TRdmPidRequest *pRequest) {
+	if (response_length(s_Response) == 0) {
+		return pRequest->bIsBroadcast || (pRequest->nCommandClass != E120_GET_COMMAND);
+	}
+
+	if (response_is_nack(s_Response, E120_NR_UNKNOWN_PID) || response_is_nack(s_Response, E120_NR_UNSUPPORTED_COMMAND_CLASS)) {
+		return false;
+	}
+
+	const struct TRdmMessageNoSc *pRdmRequest = reinterpret_cast<const struct TRdmMessageNoSc*>(s_Request);
+	const struct TRdmMessage *pRdmResponse = reinterpret_cast<const struct TRdmMessage*>(s_Response);
+
+	if ((pRdmResponse->command_class != (pRdmRequest->command_class + 1)) || (memcmp(pRdmResponse->param_id, pRdmRequest->param_id, 2) != 0)) {
+		return false;
+	}
+
+	if ((pRequest->nCommandClass == E120_GET_COMMAND) && (pRdmResponse->slot16.response_type == E120_RESPONSE_TYPE_ACK)) {
+		const struct TRdmPidExpected *pPid = pid_find(nPid);
+		return (pPid->nGetLength == 0) || (pRdmResponse->param_data_length == pPid->nGetLength);
+	}
+
+	return true;
+}
+
+/*
+ * These change the responder or the host
+ */
+static bool is_set_skipped(uint16_t nPid) {
+	return (nPid == E120_RESET_DEVICE) || (nPid == E120_FACTORY_DEFAULTS) || (nPid == E120_REAL_TIME_CLOCK);
+}
+
+struct TRdmPidResult {
+	uint32_t nRequests;
+	uint32_t nAcks;
+	uint32_t nManufacturer;
+	uint32_t nErrors;
+};
+
+static void run(bool bIsRdm, const uint8_t *pUid, struct TSamples *pKnown, struct TSamples *pUnknown, struct TSamples *pScan, struct TRdmPidResult &tResult) {
+	static const struct TRdmPidRequest s_Requests[] = {
+		{ E120_GET_COMMAND, 0, 0, false },
+		{ E120_GET_COMMAND, 0, 1, false },
+		{ E120_GET_COMMAND, 0, 2, false },
+		{ E120_GET_COMMAND, 0, 3, false },
+		{ E120_GET_COMMAND, 0, 4, false },
+		{ E120_GET_COMMAND, 1, 0, false },
+		{ E120_SET_COMMAND, 0, 0, false },
+		{ E120_SET_COMMAND, 0, RDMPID_SET_BROADCAST_LENGTH, true }
+	};
+
+	RDMHandler hashed(bIsRdm);
+
+	uint32_t aHits[RDMPID_PIDS + RDM_MANUFACTURER_PIDS_COUNT];
+	memset(aHits, 0, sizeof(aHits));
+
+	const uint32_t nUnknownPid = metric_value("rdm.unknown_pid");
+	uint32_t nUnknownPidNacks = 0;
+
+	memset(&tResult, 0, sizeof(struct TRdmPidResult));
+
+	for (uint32_t nPid = 0; nPid <= 0xFFFF; nPid++) {
+		profiler_ticks_t nTicks = profiler_ticks();
+		const struct TRdmPidExpected *pPid = pid_find(static_cast<uint16_t>(nPid));
+		samples_add(pScan, static_cast<uint32_t>(profiler_ticks() - nTicks));
+
+		const struct TRdmManufacturerPid *pManufacturer = manufacturer_find(static_cast<uint16_t>(nPid));
+
+		for (uint32_t i = 0; i < sizeof(s_Requests) / sizeof(s_Requests[0]); i++) {
+			const struct TRdmPidRequest *pRequest = &s_Requests[i];
+
+			if ((pRequest->nCommandClass == E120_SET_COMMAND) && is_set_skipped(static_cast<uint16_t>(nPid))) {
+				continue;
+			}
+
+			request_build(pUid, static_cast<uint16_t>(nPid), pRequest);
+
+			bool bIsDispatched;
+			const TRdmPidOutcome tOutcome = expected_build(pUid, static_cast<uint16_t>(nPid), pRequest, bIsRdm, bIsDispatched);
+
+			nTicks = profiler_ticks();
+			hashed.HandleData(s_Request, s_Response);
+			samples_add(response_is_nack(s_Response, E120_NR_UNKNOWN_PID) ? pUnknown : pKnown, static_cast<uint32_t>(profiler_ticks() - nTicks));
+
+			tResult.nRequests++;
+
+			if (bIsDispatched) {
+				if (pManufacturer != 0) {
+					aHits[RDMPID_PIDS + static_cast<uint32_t>(pManufacturer - RDM_MANUFACTURER_PIDS)]++;
+					tResult.nManufacturer++;
+				} else {
+					aHits[pPid - s_Pids]++;
+				}
+			}
+
+			if (response_is_nack(s_Response, E120_NR_UNKNOWN_PID)) {
+				nUnknownPidNacks++;
+			} else if ((response_length(s_Response) != 0) && (reinterpret_cast<const struct TRdmMessage*>(s_Response)->slot16.response_type == E120_RESPONSE_TYPE_ACK)) {
+				tResult.nAcks++;
+			}
+
+			bool bIsValid;
+
+			if (tOutcome == OUTCOME_EXACT) {
+				const uint32_t nLength = response_length(s_Expected);
+				bIsValid = (response_length(s_Response) == nLength) && (memcmp(s_Response, s_Expected, nLength) == 0);
+			} else {
+				bIsValid = handler_response_is_valid(static_cast<uint16_t>(nPid), pRequest);
+			}
+
+			if (!bIsValid) {
+				if (tResult.nErrors == 0) {
+					printf("  FAIL      : PID %.4x, %s, sub-device %u, %u bytes%s\n", nPid, (pRequest->nCommandClass == E120_GET_COMMAND) ? "GET" : "SET",
+							pRequest->nSubDevice, pRequest->nParamDataLength, pRequest->bIsBroadcast ? ", broadcast" : "");
+				}
+				tResult.nErrors++;
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < RDMPID_PIDS + RDM_MANUFACTURER_PIDS_COUNT; i++) {
+		const uint16_t nPid = (i < RDMPID_PIDS) ? s_Pids[i].nPid : RDM_MANUFACTURER_PIDS[i - RDMPID_PIDS].nPid;
+
+		if (hashed.GetPidHits(nPid) != aHits[i]) {
+			printf("  FAIL      : PID %.4x, %u hits, expected %u\n", nPid, hashed.GetPidHits(nPid), aHits[i]);
+			tResult.nErrors++;
+		}
+	}
+
+	if ((metric_value("rdm.unknown_pid") - nUnknownPid) != nUnknownPidNacks) {
+		printf("  FAIL      : rdm.unknown_pid %u, expected %u\n", metric_value("rdm.unknown_pid") - nUnknownPid, nUnknownPidNacks);
+		tResult.nErrors++;
+	}
+}
+
+int rdmpid_benchmark(void) {
+	RdmPidIdentify identify;
+	RdmPidOutput output;
+	RDMPersonality personality("rdmpid", RDMPID_SLOTS);
+	RDMDeviceResponder responder(&personality, &output);
+
+	responder.Init();
+
+	printf("Benchmark rdmpid, PIDs 0x0000-0xFFFF, %u root device PIDs, %u manufacturer PIDs\n", static_cast<uint32_t>(RDMPID_PIDS), RDM_MANUFACTURER_PIDS_COUNT);
+
+	struct TSamples tKnown = { "known", new uint32_t[MAX_SAMPLES], 0 };
+	struct TSamples tUnknown = { "unknown", new uint32_t[MAX_SAMPLES], 0 };
+	struct TSamples tScan = { "scan", new uint32_t[MAX_SAMPLES], 0 };
+	struct TRdmPidResult tResult;
+	int nResult = 0;
+
+	for (uint32_t i = 0; i < 2; i++) {
+		const bool bIsRdm = (i == 0);
+
+		run(bIsRdm, responder.GetUID(), &tKnown, &tUnknown, &tScan, tResult);
+
+		printf(" %-10s : %u requests, %u ACK, %u manufacturer, %u different\n", bIsRdm ? "RDM" : "RDMNet", tResult.nRequests, tResult.nAcks, tResult.nManufacturer, tResult.nErrors);
+
+		// Not passed because everything is NACKed
+		if ((tResult.nErrors != 0) || (tResult.nAcks == 0)) {
+			nResult = -1;
+		}
+	}
+
+	puts("Durations (ns)");
+	samples_print(&tKnown);
+	samples_print(&tUnknown);
+	samples_print(&tScan);
+
+	delete[] tScan.pSamples;
+	delete[] tUnknown.pSamples;
+	delete[] tKnown.pSamples;
+
+	puts(nResult == 0 ? "PASS" : "FAIL");
+
+	return nResult;
+}
@@ -0,0 +1,408 @@
+/**
+ * @file record.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "networkpcap.h"
+
+#include "artnetnode.h"
+#include "packets.h"
+#include "e131bridge.h"
+#include "e131.h"
+#include "e131packets.h"
+#include "e117const.h"
+
+#include "lightset.h"
+#include "lightsetchain.h"
+#include "showfilerecorder.h"
+#include "showfileprotocolhandler.h"
+
+#include "hardware.h"
+
+#include "benchmark.h"
+#include "benchmarkshowfile.h"
+
+/*
+ * The DMX output of an ArtNetNode and of an E131Bridge is recorded as in
+ * linux_artnet and linux_e131: the output is a LightSetChain with a
+ * ShowFileRecorder. The packets are synthetic, for RECORD_UNIVERSES universes
+ * with different slot counts. Some packets repeat the previous data of their
+ * universe, these must not be recorded. Every RECORD_PAUSE_FRAMES frames the
+ * sender pauses RECORD_PAUSE_MS.
+ *
+ * The show file is played back with OlaShowFile. Checked are:
+ * - the replayed frames are the changed frames, in order and byte exact;
+ * - the delays add up to the recording time, the recording does not drift;
+ * - there are no ring buffer overruns and no write errors.
+ */
+
+#define RECORD_UNIVERSES		4
+#define RECORD_FIRST_UNIVERSE	1
+#define RECORD_REPEAT_FRAMES	7	///< In every 7 frames one universe repeats its data
+#define RECORD_PAUSE_FRAMES		50
+#define RECORD_PAUSE_MS			5
+
+static const uint16_t s_nSlots[RECORD_UNIVERSES] = { 512, 512, 256, 100 };
+
+struct TRecordFrame {
+	uint16_t nUniverse;
+	uint16_t nLength;
+	uint32_t nVersion;		///< The frame the data is generated for
+};
+
+static uint8_t slot_value(uint32_t nVersion, uint32_t nUniverse, uint32_t nSlot) {
+	return static_cast<uint8_t>((nVersion * 5) + (nUniverse * 29) + (nSlot * 3));
+}
+
+/*
+ * The frame nFrame of universe index nIndex has the data of this version
+ */
+static uint32_t frame_version(uint32_t nFrame, uint32_t nIndex) {
+	if ((nFrame != 0) && ((nFrame % RECORD_REPEAT_FRAMES) == nIndex)) {
+		return frame_version(nFrame - 1, nIndex);
+	}
+
+	return nFrame;
+}
+
+class ReplayProtocolHandler: public ShowFileProtocolHandler {
+public:
+	ReplayProtocolHandler(const struct TRecordFrame *pExpected, uint32_t nExpected):
+		m_pExpected(pExpected), m_nExpected(nExpected), m_nFrames(0), m_nErrors(0), m_nFirstError(0) {
+	}
+
+	void DmxOut(uint16_t nUniverse, const uint8_t *pDmxData, uint16_t nLength) {
+		bool bIsEqual = false;
+
+		if (m_nFrames < m_nExpected) {
+			const struct TRecordFrame *pFrame = &m_pExpected[m_nFrames];
+
+			bIsEqual = (nUniverse == pFrame->nUniverse) && (nLength == pFrame->nLength);
+
+			for (uint32_t i = 0; bIsEqual && (i < nLength); i++) {
+				bIsEqual = (pDmxData[i] == slot_value(pFrame->nVersion, nUniverse, i));
+			}
+		}
+
+		if (!bIsEqual) {
+			if (m_nErrors == 0) {
+				m_nFirstError = m_nFrames;
+			}
+			m_nErrors++;
+		}
+
+		m_nFrames++;
+	}
+	void DmxSync(void) {}
+	void DmxBlackout(void) {}
+	void DmxMaster(__attribute__((unused)) uint32_t nMaster) {}
+	void DoRunCleanupProcess(__attribute__((unused)) bool bDoRun) {}
+	void Start(void) {}
+	void Stop(void) {}
+	void Run(void) {}
+	bool IsSyncDisabled(void) {
+		return false;
+	}
+	void Print(void) {}
+
+	const struct TRecordFrame *m_pExpected;
+	uint32_t m_nExpected;
+	uint32_t m_nFrames;
+	uint32_t m_nErrors;
+	uint32_t m_nFirstError;
+};
+
+class NullOutput: public LightSet {
+public:
+	void Start(__attribute__((unused)) uint8_t nPort) {}
+	void Stop(__attribute__((unused)) uint8_t nPort) {}
+	void SetData(__attribute__((unused)) uint8_t nPort, __attribute__((unused)) const uint8_t *pData, __attribute__((unused)) uint16_t nLength) {}
+};
+
+static void fill_artdmx(uint8_t *pBuffer, uint32_t nFrame, uint32_t nIndex, uint32_t nVersion) {
+	struct TArtDmx *pArtDmx = reinterpret_cast<struct TArtDmx *>(pBuffer);
+	const uint16_t nUniverse = static_cast<uint16_t>(RECORD_FIRST_UNIVERSE + nIndex);
+
+	memset(pArtDmx, 0, sizeof(struct TArtDmx));
+	memcpy(pArtDmx->Id, "Art-Net", 8);
+	pArtDmx->OpCode = OP_DMX;
+	pArtDmx->ProtVerLo = ARTNET_PROTOCOL_REVISION;
+	pArtDmx->Sequence = static_cast<uint8_t>(1 + (nFrame % 255));
+	pArtDmx->PortAddress = nUniverse;
+	pArtDmx->LengthHi = static_cast<uint8_t>(s_nSlots[nIndex] >> 8);
+	pArtDmx->Length = static_cast<uint8_t>(s_nSlots[nIndex]);
+
+	for (uint32_t i = 0; i < s_nSlots[nIndex]; i++) {
+		pArtDmx->Data[i] = slot_value(nVersion, nUniverse, i);
+	}
+}
+
+static void fill_e131(uint8_t *pBuffer, uint32_t nFrame, uint32_t nIndex, uint32_t nVersion) {
+	struct TE131DataPacket *pPacket = reinterpret_cast<struct TE131DataPacket *>(pBuffer);
+	const uint16_t nUniverse = static_cast<uint16_t>(RECORD_FIRST_UNIVERSE + nIndex);
+
+	memset(pPacket, 0, sizeof(struct TE131DataPacket));
+
+	pPacket->RootLayer.PreAmbleSize = __builtin_bswap16(0x0010);
+	memcpy(pPacket->RootLayer.ACNPacketIdentifier, E117Const::ACN_PACKET_IDENTIFIER, E117_PACKET_IDENTIFIER_LENGTH);
+	pPacket->RootLayer.Vector = __builtin_bswap32(E131_VECTOR_ROOT_DATA);
+	memset(pPacket->RootLayer.Cid, 0xA0, E131_CID_LENGTH);
+
+	pPacket->FrameLayer.Vector = __builtin_bswap32(E131_VECTOR_DATA_PACKET);
+	pPacket->FrameLayer.Priority = E131_PRIORITY_DEFAULT;
+	pPacket->FrameLayer.SequenceNumber = static_cast<uint8_t>(nFrame);
+	pPacket->FrameLayer.Universe = __builtin_bswap16(nUniverse);
+
+	pPacket->DMPLayer.Vector = E131_VECTOR_DMP_SET_PROPERTY;
+	pPacket->DMPLayer.Type = 0xa1;
+	pPacket->DMPLayer.FirstAddressProperty = __builtin_bswap16(0x0000);
+	pPacket->DMPLayer.AddressIncrement = __builtin_bswap16(0x0001);
+	pPacket->DMPLayer.PropertyValueCount = __builtin_bswap16(static_cast<uint16_t>(1 + s_nSlots[nIndex]));
+	pPacket->DMPLayer.PropertyValues[0] = E131_START_CODE_DMX;
+
+	for (uint32_t i = 0; i < s_nSlots[nIndex]; i++) {
+		pPacket->DMPLayer.PropertyValues[1 + i] = slot_value(nVersion, nUniverse, i);
+	}
+}
+
+/*
+ * The sum of the delay lines in milliseconds
+ */
+static bool show_delays(const char *pFileName, uint32_t &nMillis) {
+	FILE *pFile = fopen(pFileName, "r");
+
+	if (pFile == 0) {
+		perror(pFileName);
+		return false;
+	}
+
+	static char s_Line[4096];
+
+	nMillis = 0;
+
+	while (fgets(s_Line, sizeof(s_Line), pFile) != 0) {
+		if (strchr(s_Line, ' ') == 0) {
+			nMillis += static_cast<uint32_t>(atoi(s_Line));
+		}
+	}
+
+	fclose(pFile);
+
+	return true;
+}
+
+static int run_record(NetworkPcap &nw, BenchmarkShowFile &showFile, ArtNetNode &node, E131Bridge &bridge, bool bIsArtNet, uint32_t nFrames) {
+	const char *pName = bIsArtNet ? "Art-Net" : "sACN";
+	const uint32_t nPacketSize = bIsArtNet ? sizeof(struct TArtDmx) : sizeof(struct TE131DataPacket);
+	const uint32_t nPackets = nFrames * RECORD_UNIVERSES;
+	uint8_t *pPackets = new uint8_t[nPackets * nPacketSize];
+	struct TRecordFrame *pExpected = new struct TRecordFrame[nPackets];
+	uint32_t nExpected = 0;
+
+	nw.Create(nPackets);
+
+	for (uint32_t nFrame = 0; nFrame < nFrames; nFrame++) {
+		for (uint32_t nIndex = 0; nIndex < RECORD_UNIVERSES; nIndex++) {
+			uint8_t *pPacket = &pPackets[((nFrame * RECORD_UNIVERSES) + nIndex) * nPacketSize];
+			const uint32_t nVersion = frame_version(nFrame, nIndex);
+
+			if (bIsArtNet) {
+				fill_artdmx(pPacket, nFrame, nIndex, nVersion);
+				nw.Add(pPacket, static_cast<uint16_t>(sizeof(struct TArtDmx) - ARTNET_DMX_LENGTH + s_nSlots[nIndex]), 0x0102A8C0, ARTNET_UDP_PORT, ARTNET_UDP_PORT);
+			} else {
+				fill_e131(pPacket, nFrame, nIndex, nVersion);
+				nw.Add(pPacket, static_cast<uint16_t>(DATA_PACKET_SIZE(1 + s_nSlots[nIndex])), 0x0102A8C0, E131_DEFAULT_PORT, E131_DEFAULT_PORT);
+			}
+
+			if (nVersion == nFrame) {
+				pExpected[nExpected].nUniverse = static_cast<uint16_t>(RECORD_FIRST_UNIVERSE + nIndex);
+				pExpected[nExpected].nLength = s_nSlots[nIndex];
+				pExpected[nExpected].nVersion = nVersion;
+				nExpected++;
+			}
+		}
+	}
+
+	char aFileName[] = "/tmp/recordXXXXXX";
+	const int nFd = mkstemp(aFileName);
+
+	if (nFd < 0) {
+		perror("mkstemp");
+		delete[] pExpected;
+		delete[] pPackets;
+		return -1;
+	}
+
+	close(nFd);
+
+	NullOutput output;
+	ShowFileRecorder recorder;
+	LightSetChain chain;
+
+	chain.Add(&output, LIGHTSET_OUTPUT_TYPE_DMX);
+	chain.Add(&recorder);
+
+	for (uint32_t nIndex = 0; nIndex < RECORD_UNIVERSES; nIndex++) {
+		if (bIsArtNet) {
+			node.SetUniverseSwitch(nIndex, ARTNET_OUTPUT_PORT, static_cast<uint8_t>(RECORD_FIRST_UNIVERSE + nIndex));
+		} else {
+			bridge.SetUniverse(nIndex, E131_OUTPUT_PORT, static_cast<uint16_t>(RECORD_FIRST_UNIVERSE + nIndex));
+		}
+	}
+
+	if (bIsArtNet) {
+		node.SetDirectUpdate(true);
+		node.SetOutput(&chain);
+		node.Start();
+	} else {
+		bridge.SetDirectUpdate(true);
+		bridge.SetOutput(&chain);
+		bridge.Start();
+	}
+
+	for (uint32_t nIndex = 0; nIndex < RECORD_UNIVERSES; nIndex++) {
+		uint16_t nUniverse;
+
+		if (bIsArtNet ? node.GetPortAddress(nIndex, nUniverse) : bridge.GetUniverse(nIndex, nUniverse)) {
+			recorder.SetUniverse(nIndex, nUniverse);
+		}
+	}
+
+	const uint32_t nOverruns = metric_value("showfile.record.overruns");
+	const uint32_t nWriteErrors = metric_value("showfile.record.errors");
+	const uint32_t nRecorded = metric_value("showfile.record.frames");
+	uint32_t nBeginMicros = 0;
+	uint32_t nEndMicros = 0;
+	int nResult = 0;
+
+	if (!recorder.Open(aFileName)) {
+		nResult = -1;
+	}
+
+	nw.Rewind();
+
+	// The received counter is not reset by Create()
+	const uint32_t nReceived = nw.GetReceived();
+
+	for (uint32_t i = 0; (nResult == 0) && (i < nPackets); i++) {
+		nw.SetAvailable(i + 1);
+
+		while ((nw.GetReceived() - nReceived) == i) {
+			if (bIsArtNet) {
+				node.Run();
+			} else {
+				bridge.Run();
+			}
+		}
+
+		// The first and the last packet are recorded, these are the recording time
+		if (i == 0) {
+			nBeginMicros = Hardware::Get()->Micros();
+		} else if (i == (nPackets - 1)) {
+			nEndMicros = Hardware::Get()->Micros();
+		}
+
+		recorder.Run();
+
+		if ((i % (RECORD_PAUSE_FRAMES * RECORD_UNIVERSES)) == ((RECORD_PAUSE_FRAMES * RECORD_UNIVERSES) - 1)) {
+			usleep(RECORD_PAUSE_MS * 1000);
+		}
+	}
+
+	if (bIsArtNet) {
+		node.Stop();
+	} else {
+		bridge.Stop();
+	}
+
+	recorder.Close();
+
+	const uint32_t nRecordMillis = (nEndMicros - nBeginMicros) / 1000;
+	const uint32_t nFramesRecorded = metric_value("showfile.record.frames") - nRecorded;
+
+	ReplayProtocolHandler handler(pExpected, nExpected);
+	uint32_t nDelayMillis = 0;
+
+	if ((nResult == 0) && show_delays(aFileName, nDelayMillis) && showFile.Open(aFileName)) {
+		showFile.SetProtocolHandler(&handler);
+		showFile.Start();
+
+		while (showFile.GetStatus() == SHOWFILE_STATUS_RUNNING) {
+			showFile.Run();
+		}
+
+		showFile.Close();
+	} else {
+		nResult = -1;
+	}
+
+	unlink(aFileName);
+
+	printf(" %-10s : %u packets, %u frames recorded, %u replayed, %u ms recorded, %u ms delays\n", pName, nPackets, nFramesRecorded, handler.m_nFrames, nRecordMillis, nDelayMillis);
+
+	if ((nFramesRecorded != nExpected) || (handler.m_nFrames != nExpected) || (handler.m_nErrors != 0)) {
+		printf("  FAIL      : %u recorded, %u replayed, expected %u, %u different (first %u)\n", nFramesRecorded, handler.m_nFrames, nExpected, handler.m_nErrors, handler.m_nFirstError);
+		nResult = -1;
+	}
+
+	// The delays are truncated to milliseconds, the remainder is carried
+	if ((nDelayMillis > (nRecordMillis + 1)) || ((nDelayMillis + 1) < nRecordMillis)) {
+		printf("  FAIL      : %u ms delays, recorded %u ms\n", nDelayMillis, nRecordMillis);
+		nResult = -1;
+	}
+
+	if ((metric_value("showfile.record.overruns") != nOverruns) || (metric_value("showfile.record.errors") != nWriteErrors)) {
+		printf("  FAIL      : %u overruns, %u write errors\n", metric_value("showfile.record.overruns") - nOverruns, metric_value("showfile.record.errors") - nWriteErrors);
+		nResult = -1;
+	}
+
+	delete[] pExpected;
+	delete[] pPackets;
+
+	return nResult;
+}
+
+int record_benchmark(NetworkPcap &nw, uint32_t nFrames) {
+	BenchmarkShowFile showFile;
+	ArtNetNode node;
+	E131Bridge bridge;
+
+	showFile.DoLoop(false);
+
+	printf("Benchmark record, %u universes, %u frames\n", RECORD_UNIVERSES, nFrames);
+
+	int nResult = 0;
+
+	nResult |= run_record(nw, showFile, node, bridge, true, nFrames);
+	nResult |= run_record(nw, showFile, node, bridge, false, nFrames);
+
+	puts(nResult == 0 ? "PASS" : "FAIL");
+
+	return nResult;
+}
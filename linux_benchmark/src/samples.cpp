@@ -0,0 +1,82 @@
+/**
+ * @file samples.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "metrics.h"
+
+#include "benchmark.h"
+
+void samples_add(struct TSamples *pSamples, uint32_t nTicks) {
+	if (pSamples->nCount < MAX_SAMPLES) {
+		pSamples->pSamples[pSamples->nCount++] = nTicks;
+	}
+}
+
+static int compare(const void *a, const void *b) {
+	const uint32_t nA = *static_cast<const uint32_t *>(a);
+	const uint32_t nB = *static_cast<const uint32_t *>(b);
+	return (nA > nB) - (nA < nB);
+}
+
+void samples_print(struct TSamples *pSamples) {
+	const uint32_t nCount = pSamples->nCount;
+
+	if (nCount == 0) {
+		printf(" %-10s : -\n", pSamples->pName);
+		return;
+	}
+
+	qsort(pSamples->pSamples, nCount, sizeof(uint32_t), compare);
+
+	uint64_t nTotal = 0;
+
+	for (uint32_t i = 0; i < nCount; i++) {
+		nTotal += pSamples->pSamples[i];
+	}
+
+	printf(" %-10s : %u samples, avg %u, min %u, p50 %u, p90 %u, p99 %u, p99.9 %u, max %u\n",
+			pSamples->pName, nCount,
+			static_cast<uint32_t>(nTotal / nCount),
+			pSamples->pSamples[0],
+			pSamples->pSamples[(nCount * 50U) / 100U],
+			pSamples->pSamples[(nCount * 90U) / 100U],
+			pSamples->pSamples[(static_cast<uint64_t>(nCount) * 99U) / 100U],
+			pSamples->pSamples[(static_cast<uint64_t>(nCount) * 999U) / 1000U],
+			pSamples->pSamples[nCount - 1]);
+}
+
+uint32_t metric_value(const char *pName) {
+	for (const struct metric *pMetric = metrics_get_first(); pMetric != 0; pMetric = pMetric->next) {
+		if (strcmp(pMetric->name, pName) == 0) {
+			return pMetric->value;
+		}
+	}
+
+	return 0;
+}
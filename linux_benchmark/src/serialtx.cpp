@@ -0,0 +1,235 @@
+/**
+ * @file serialtx.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "serial.h"
+
+#include "hardware.h"
+
+#include "benchmark.h"
+
+/*
+ * The Serial transmit queue with the Linux backend, which drains the queue at
+ * the wire speed of the configuration. The bytes put on the wire are captured.
+ *
+ * Ordering: messages of 1 to 299 bytes, wrapping the ring many times, and a few
+ * messages larger than half the ring (sent blocking, after the queue is flushed).
+ * A rejected message is queued again when a message has been sent. Checked are
+ * that the wire has all messages complete and in order, and the counters: queued,
+ * sent and dropped must match the Queue() calls.
+ *
+ * Throughput: for UART, SPI and I2C the queue is kept full, the bytes per second
+ * on the wire must be within 2% of the configured speed.
+ */
+
+#define SERIAL_CAPTURE_SIZE		(1024 * 1024)
+#define SERIAL_LARGE_MESSAGE	3000
+#define SERIAL_THROUGHPUT_MS	500
+
+static uint8_t *s_pCapture;
+static uint32_t s_nCaptured;
+
+static void capture(const uint8_t *pData, uint32_t nLength) {
+	if ((s_nCaptured + nLength) <= SERIAL_CAPTURE_SIZE) {
+		memcpy(&s_pCapture[s_nCaptured], pData, nLength);
+	}
+
+	s_nCaptured += nLength;
+}
+
+static uint32_t s_nSeed = 1;
+
+static uint32_t random_next(void) {
+	s_nSeed = s_nSeed * 1103515245 + 12345;
+	return s_nSeed >> 16;
+}
+
+static uint32_t message_fill(uint8_t *pMessage, uint32_t nMessage, uint32_t nLength) {
+	for (uint32_t i = 0; i < nLength; i++) {
+		pMessage[i] = static_cast<uint8_t>((nMessage * 7) + i);
+	}
+
+	return nLength;
+}
+
+static int run_ordering(Serial &serial, uint32_t nMessages) {
+	uint8_t *pExpected = new uint8_t[SERIAL_CAPTURE_SIZE];
+	uint8_t aMessage[SERIAL_LARGE_MESSAGE];
+	uint32_t nExpected = 0;
+	uint32_t nRejected = 0;
+	uint32_t nQueueCalls = 0;
+	uint32_t nLarge = 0;
+
+	serial.SetUartBaud(4000000);
+	serial.Init();
+
+	s_nCaptured = 0;
+
+	const struct TSerialTxStats *pStats = serial.GetTxStats();
+
+	for (uint32_t nMessage = 0; nMessage < nMessages; nMessage++) {
+		const bool bIsLarge = ((nMessage % 500) == 250);
+		const uint32_t nLength = message_fill(aMessage, nMessage, bIsLarge ? SERIAL_LARGE_MESSAGE : (1 + (random_next() % 299)));
+
+		if ((nExpected + nLength) > SERIAL_CAPTURE_SIZE) {
+			break;
+		}
+
+		memcpy(&pExpected[nExpected], aMessage, nLength);
+		nExpected += nLength;
+
+		nQueueCalls++;
+
+		while (!serial.Queue(aMessage, nLength)) {
+			nRejected++;
+			nQueueCalls++;
+
+			// Queued again when a message has left the queue
+			const uint32_t nSent = pStats->nSent;
+
+			while (pStats->nSent == nSent) {
+				serial.Run();
+			}
+		}
+
+		if (bIsLarge) {
+			nLarge++;
+		}
+	}
+
+	serial.Flush();
+
+	uint32_t nErrors = 0;
+
+	if ((s_nCaptured != nExpected) || (memcmp(s_pCapture, pExpected, nExpected) != 0)) {
+		uint32_t nOffset = 0;
+
+		while ((nOffset < nExpected) && (nOffset < s_nCaptured) && (s_pCapture[nOffset] == pExpected[nOffset])) {
+			nOffset++;
+		}
+
+		printf("  FAIL      : wire %u bytes, expected %u, first difference at %u\n", s_nCaptured, nExpected, nOffset);
+		nErrors++;
+	}
+
+	// The large messages bypass the queue
+	if ((pStats->nQueued != (nQueueCalls - nRejected - nLarge)) || (pStats->nSent != pStats->nQueued) || (pStats->nDropped != nRejected)) {
+		printf("  FAIL      : queued %u, sent %u, dropped %u, expected %u, %u, %u\n", pStats->nQueued, pStats->nSent, pStats->nDropped,
+				nQueueCalls - nRejected - nLarge, nQueueCalls - nRejected - nLarge, nRejected);
+		nErrors++;
+	}
+
+	if (pStats->nHighWater > SERIAL_TX_BUFFER_SIZE) {
+		printf("  FAIL      : high water %u\n", pStats->nHighWater);
+		nErrors++;
+	}
+
+	printf(" Ordering   : %u messages, %u bytes, %u rejected, high water %u, %u errors\n", nQueueCalls - nRejected, nExpected, nRejected, pStats->nHighWater, nErrors);
+
+	delete[] pExpected;
+
+	return (nErrors == 0) ? 0 : -1;
+}
+
+/*
+ * nBytesPerSecond is the wire speed as the backend models it
+ */
+static int run_throughput(Serial &serial, const char *pName, uint32_t nMessageLength, uint32_t nBytesPerSecond) {
+	uint8_t aMessage[256];
+
+	message_fill(aMessage, 0, nMessageLength);
+
+	serial.Init();
+
+	// Fill the queue before the measurement
+	while (serial.Queue(aMessage, nMessageLength)) {
+	}
+
+	s_nCaptured = 0;
+
+	const uint32_t nBegin = Hardware::Get()->Micros();
+	uint32_t nElapsed;
+
+	do {
+		if (!serial.Queue(aMessage, nMessageLength)) {
+			serial.Run();
+		}
+
+		nElapsed = Hardware::Get()->Micros() - nBegin;
+	} while (nElapsed < (SERIAL_THROUGHPUT_MS * 1000));
+
+	const uint32_t nMeasured = static_cast<uint32_t>((static_cast<uint64_t>(s_nCaptured) * 1000000) / nElapsed);
+	// A message is only put on the wire complete for SPI and I2C
+	const uint32_t nTolerance = (nBytesPerSecond / 50) + ((nMessageLength * 1000) / SERIAL_THROUGHPUT_MS);
+	const uint32_t nDiff = (nMeasured > nBytesPerSecond) ? (nMeasured - nBytesPerSecond) : (nBytesPerSecond - nMeasured);
+
+	serial.Flush();
+
+	printf(" %-10s : %u bytes/s, expected %u\n", pName, nMeasured, nBytesPerSecond);
+
+	if (nDiff > nTolerance) {
+		printf("  FAIL      : %s throughput\n", pName);
+		return -1;
+	}
+
+	return 0;
+}
+
+int serial_benchmark(uint32_t nMessages) {
+	s_pCapture = new uint8_t[SERIAL_CAPTURE_SIZE];
+
+	Serial serial;
+	serial.SetTxHook(capture);
+
+	printf("Benchmark serial, ring %u bytes, %u messages\n", SERIAL_TX_BUFFER_SIZE, SERIAL_TX_QUEUE_SIZE);
+
+	int nResult = 0;
+
+	serial.SetType(SERIAL_TYPE_UART);
+	nResult |= run_ordering(serial, nMessages);
+
+	serial.SetType(SERIAL_TYPE_UART);
+	serial.SetUartBaud(1000000);
+	nResult |= run_throughput(serial, "UART 1M", 64, 1000000 / 10);
+
+	serial.SetType(SERIAL_TYPE_SPI);
+	serial.SetSpiSpeedHz(1000000);
+	nResult |= run_throughput(serial, "SPI 1MHz", 128, 1000000 / 8);
+
+	serial.SetType(SERIAL_TYPE_I2C);
+	serial.SetI2cSpeedMode(SERIAL_I2C_SPEED_MODE_FAST);
+	nResult |= run_throughput(serial, "I2C fast", 32, 400000 / 9);
+
+	serial.SetTxHook(0);
+
+	delete[] s_pCapture;
+
+	puts(nResult == 0 ? "PASS" : "FAIL");
+
+	return nResult;
+}
@@ -0,0 +1,257 @@
+/**
+ * @file showfile.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "showfileprotocolhandler.h"
+#include "filestream.h"
+
+#include "hardware.h"
+
+#include "benchmark.h"
+#include "benchmarkshowfile.h"
+
+/*
+ * OLA show files played with OlaShowFile, which reads them through the
+ * filestream_* read-ahead layer. The DMX output goes to a handler that counts
+ * the frames and sums the data.
+ *
+ * Paced: a show with one universe and a delay of 2 ms per frame, played in
+ * real time. A frame is smaller than a block, so the next block is always
+ * prefetched while waiting: there must be no stall.
+ *
+ * Unpaced: a show with four universes and a delay of 0 ms, so the player never
+ * waits. This is the parse throughput; every block switch is a stall.
+ *
+ * For both the frames and the data must match the show as written.
+ * A given show file is played in real time, the result is reported only.
+ */
+
+#define SHOW_UNIVERSE_SLOTS		512
+#define SHOW_PACED_DELAY_MS		2
+
+class CountingProtocolHandler: public ShowFileProtocolHandler {
+public:
+	CountingProtocolHandler(void): m_nFrames(0), m_nSyncs(0), m_nSum(0) {}
+
+	void DmxOut(uint16_t nUniverse, const uint8_t *pDmxData, uint16_t nLength) {
+		m_nFrames++;
+		m_nSum = m_nSum * 31 + nUniverse;
+
+		for (uint32_t i = 0; i < nLength; i++) {
+			m_nSum = m_nSum * 31 + pDmxData[i];
+		}
+	}
+	void DmxSync(void) {
+		m_nSyncs++;
+	}
+	void DmxBlackout(void) {}
+	void DmxMaster(__attribute__((unused)) uint32_t nMaster) {}
+	void DoRunCleanupProcess(__attribute__((unused)) bool bDoRun) {}
+	void Start(void) {}
+	void Stop(void) {}
+	void Run(void) {}
+	bool IsSyncDisabled(void) {
+		return false;
+	}
+	void Print(void) {}
+
+	void Reset(void) {
+		m_nFrames = 0;
+		m_nSyncs = 0;
+		m_nSum = 0;
+	}
+
+	uint32_t m_nFrames;
+	uint32_t m_nSyncs;
+	uint32_t m_nSum;
+};
+
+static uint8_t slot_value(uint32_t nFrame, uint32_t nUniverse, uint32_t nSlot) {
+	return static_cast<uint8_t>((nFrame * 3) + (nUniverse * 17) + nSlot);
+}
+
+/*
+ * Writes the show and returns the sum as CountingProtocolHandler computes it
+ */
+static bool show_write(const char *pFileName, uint32_t nFrames, uint32_t nUniverses, uint32_t nDelayMillis, uint32_t &nSum) {
+	FILE *pFile = fopen(pFileName, "w");
+
+	if (pFile == 0) {
+		perror(pFileName);
+		return false;
+	}
+
+	nSum = 0;
+
+	for (uint32_t nFrame = 0; nFrame < nFrames; nFrame++) {
+		for (uint32_t nUniverse = 1; nUniverse <= nUniverses; nUniverse++) {
+			nSum = nSum * 31 + nUniverse;
+			fprintf(pFile, "%u ", nUniverse);
+
+			for (uint32_t nSlot = 0; nSlot < SHOW_UNIVERSE_SLOTS; nSlot++) {
+				const uint8_t nValue = slot_value(nFrame, nUniverse, nSlot);
+				nSum = nSum * 31 + nValue;
+				fprintf(pFile, (nSlot == 0) ? "%u" : ",%u", nValue);
+			}
+
+			fputc('\n', pFile);
+		}
+
+		fprintf(pFile, "%u\n", nDelayMillis);
+	}
+
+	fclose(pFile);
+
+	return true;
+}
+
+struct TPlayResult {
+	uint32_t nMicros;
+	uint32_t nStalls;
+	uint32_t nReads;
+	uint32_t nPrefetches;
+};
+
+static bool play(BenchmarkShowFile &showFile, CountingProtocolHandler &handler, const char *pFileName, struct TPlayResult &tResult) {
+	if (!showFile.Open(pFileName)) {
+		perror(pFileName);
+		return false;
+	}
+
+	handler.Reset();
+
+	// The first block is read by the open
+	const uint32_t nStalls = metric_value("filestream.stalls");
+	const uint32_t nReads = metric_value("filestream.reads");
+	const uint32_t nPrefetches = metric_value("filestream.prefetches");
+
+	const uint32_t nBegin = Hardware::Get()->Micros();
+
+	showFile.Start();
+
+	while (showFile.GetStatus() == SHOWFILE_STATUS_RUNNING) {
+		showFile.Run();
+	}
+
+	tResult.nMicros = Hardware::Get()->Micros() - nBegin;
+	tResult.nStalls = metric_value("filestream.stalls") - nStalls;
+	tResult.nReads = metric_value("filestream.reads") - nReads;
+	tResult.nPrefetches = metric_value("filestream.prefetches") - nPrefetches;
+
+	showFile.Close();
+
+	return true;
+}
+
+static void print_result(const char *pName, const CountingProtocolHandler &handler, const struct TPlayResult &tResult) {
+	const uint32_t nFramesPerSecond = (tResult.nMicros == 0) ? 0 : static_cast<uint32_t>((static_cast<uint64_t>(handler.m_nFrames) * 1000000) / tResult.nMicros);
+
+	printf(" %-10s : %u DMX frames, %u frames/s, %u reads, %u prefetches, filestream.stalls %u\n", pName, handler.m_nFrames, nFramesPerSecond, tResult.nReads, tResult.nPrefetches, tResult.nStalls);
+}
+
+static int run_synthetic(BenchmarkShowFile &showFile, CountingProtocolHandler &handler, const char *pName, uint32_t nFrames, uint32_t nUniverses, uint32_t nDelayMillis) {
+	char aFileName[] = "/tmp/showfileXXXXXX";
+	const int nFd = mkstemp(aFileName);
+
+	if (nFd < 0) {
+		perror("mkstemp");
+		return -1;
+	}
+
+	close(nFd);
+
+	uint32_t nSum;
+	struct TPlayResult tResult;
+	int nResult = 0;
+
+	if (!show_write(aFileName, nFrames, nUniverses, nDelayMillis, nSum) || !play(showFile, handler, aFileName, tResult)) {
+		unlink(aFileName);
+		return -1;
+	}
+
+	unlink(aFileName);
+
+	print_result(pName, handler, tResult);
+
+	if ((handler.m_nFrames != (nFrames * nUniverses)) || (handler.m_nSum != nSum)) {
+		printf("  FAIL      : %u frames, expected %u, data %s\n", handler.m_nFrames, nFrames * nUniverses, (handler.m_nSum == nSum) ? "equal" : "different");
+		nResult = -1;
+	}
+
+	// The next block is prefetched while waiting, when a frame fits in a block
+	if ((nDelayMillis != 0) && (tResult.nStalls != 0)) {
+		printf("  FAIL      : %u stalls\n", tResult.nStalls);
+		nResult = -1;
+	}
+
+	// Without waiting, every read after the open is a stall
+	if ((nDelayMillis == 0) && ((tResult.nPrefetches != 0) || (tResult.nStalls != tResult.nReads))) {
+		printf("  FAIL      : %u stalls, %u reads, %u prefetches\n", tResult.nStalls, tResult.nReads, tResult.nPrefetches);
+		nResult = -1;
+	}
+
+	if ((nDelayMillis != 0) && (tResult.nMicros < (nFrames - 1) * nDelayMillis * 1000)) {
+		printf("  FAIL      : played in %u us, expected at least %u us\n", tResult.nMicros, (nFrames - 1) * nDelayMillis * 1000);
+		nResult = -1;
+	}
+
+	return nResult;
+}
+
+int showfile_benchmark(const char *pFileName, uint32_t nFrames) {
+	BenchmarkShowFile showFile;
+	CountingProtocolHandler handler;
+
+	showFile.SetProtocolHandler(&handler);
+	showFile.DoLoop(false);
+
+	printf("Benchmark showfile, block %u bytes\n", FILESTREAM_BLOCK_SIZE);
+
+	if (pFileName != 0) {
+		struct TPlayResult tResult;
+
+		if (!play(showFile, handler, pFileName, tResult)) {
+			return -1;
+		}
+
+		print_result("File", handler, tResult);
+
+		return 0;
+	}
+
+	int nResult = 0;
+
+	nResult |= run_synthetic(showFile, handler, "Paced", nFrames, 1, SHOW_PACED_DELAY_MS);
+	nResult |= run_synthetic(showFile, handler, "Unpaced", 4 * nFrames, 4, 0);
+
+	puts(nResult == 0 ? "PASS" : "FAIL");
+
+	return nResult;
+}
@@ -0,0 +1,350 @@
+/**
+ * @file widget.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"	// C headers, shared with the widget firmware
+#include "widget.h"
+extern "C" {
+#include "widget_usb.h"
+}
+#include "widget_stream.h"
+#pragma GCC diagnostic pop
+
+#include "widgetusb.h"
+
+#include "profiler.h"
+
+#include "benchmark.h"
+
+/*
+ * Codec: synthetic DMX frames are encoded as stream records, decoded and
+ * compared with the frames. Each frame changes nChanged random slots of the
+ * previous frame.
+ *
+ * Link: DMX frames at 44 Hz are sent with widget_stream_dmx() through the
+ * transmit path of the firmware (widget_usb.c and widget_stream.c) to a
+ * simulated FT245RL, see widgetusb.c. The host reads the FIFO at a given rate.
+ * The bytes on the link are parsed as the host does, every record must decode
+ * to the frame of its timestamp, and the records received plus the records
+ * dropped must be the frames sent, as the statistics count them. With a fast
+ * host nothing is dropped, with a slow host records are dropped and the bytes
+ * on the link are within the rate.
+ */
+
+#define WIDGET_BATCH_SIZE			1024
+#define WIDGET_CLASSIC_DMX_SIZE		(5 + 1 + WIDGET_STREAM_DMX_SIZE)	///< Label 5: framing, status, frame
+#define WIDGET_CLASSIC_SNIFFER_SIZE	(6 * 205)							///< Label 0x81: 6 packets of 200 bytes
+
+#define WIDGET_LINK_FRAMES			2000
+#define WIDGET_LINK_FRAME_US		22727		///< 44 Hz, DMX with 512 slots
+#define WIDGET_LINK_POLL_US			100			///< A pass of the poll table of the firmware
+#define WIDGET_LINK_CAPTURE_SIZE	(WIDGET_LINK_FRAMES * 1024)
+
+struct TWidgetLink {
+	const char *pName;
+	uint32_t nBytesPerSecond;
+	bool bIsSaturated;			///< Records must be dropped
+};
+
+static const struct TWidgetLink s_aLinks[] = {
+		{ "Fast host", 1000000, false },
+		{ "Slow host", 2000, true }
+};
+
+static int run_codec(uint32_t nFrames, uint32_t nChanged) {
+	struct widget_stream_encoder encoder;
+	struct widget_stream_decoder decoder;
+	uint8_t frame[WIDGET_STREAM_DMX_SIZE];
+	uint8_t *pBatch = new uint8_t[WIDGET_BATCH_SIZE];
+	struct TSamples tEncode = { "encode", new uint32_t[nFrames], 0 };
+	struct TSamples tDecode = { "decode", new uint32_t[nFrames], 0 };
+
+	widget_stream_encoder_init(&encoder);
+	widget_stream_decoder_init(&decoder);
+
+	memset(frame, 0, sizeof(frame));
+	srand(1);
+
+	uint64_t nBytes = 0;
+	uint32_t nFull = 0;
+	uint32_t nErrors = 0;
+
+	for (uint32_t nFrame = 0; nFrame < nFrames; nFrame++) {
+		for (uint32_t i = 0; i < nChanged; i++) {
+			frame[1 + (static_cast<uint32_t>(rand()) % (WIDGET_STREAM_DMX_SIZE - 1))] = static_cast<uint8_t>(rand());
+		}
+
+		profiler_ticks_t nBegin = profiler_ticks();
+		const uint16_t nLength = widget_stream_encode_dmx(&encoder, pBatch, WIDGET_BATCH_SIZE, frame, WIDGET_STREAM_DMX_SIZE, nFrame);
+		samples_add(&tEncode, static_cast<uint32_t>(profiler_ticks() - nBegin));
+
+		struct widget_stream_record_info info;
+
+		nBegin = profiler_ticks();
+		const int32_t nResult = widget_stream_decode(&decoder, pBatch, nLength, &info);
+		samples_add(&tDecode, static_cast<uint32_t>(profiler_ticks() - nBegin));
+
+		if ((nResult != nLength) || (decoder.frame_length != WIDGET_STREAM_DMX_SIZE) || (memcmp(decoder.frame, frame, WIDGET_STREAM_DMX_SIZE) != 0)) {
+			nErrors++;
+		}
+
+		if (pBatch[0] == WIDGET_STREAM_RECORD_DMX) {
+			nFull++;
+		}
+
+		nBytes += nLength;
+	}
+
+	const uint32_t nBytesPerFrame = static_cast<uint32_t>(nBytes / nFrames);
+
+	printf(" Records    : %u full, %u delta, %u errors\n", nFull, nFrames - nFull, nErrors);
+	printf(" Bytes      : %u per frame (classic %u, sniffer %u)\n", nBytesPerFrame, WIDGET_CLASSIC_DMX_SIZE, WIDGET_CLASSIC_SNIFFER_SIZE);
+	printf(" Link       : %u frames/s at 1 MB/s\n", (nBytesPerFrame == 0) ? 0 : 1000000 / nBytesPerFrame);
+
+	puts("Durations (ns)");
+	samples_print(&tEncode);
+	samples_print(&tDecode);
+
+	delete[] tDecode.pSamples;
+	delete[] tEncode.pSamples;
+	delete[] pBatch;
+
+	if (nErrors != 0) {
+		printf("  FAIL      : codec, %u errors\n", nErrors);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Up to 20 random slots change per frame, all slots every 500 frames
+ */
+static void link_frames(uint8_t *pFrames) {
+	memset(pFrames, 0, WIDGET_STREAM_DMX_SIZE);
+
+	for (uint32_t nFrame = 1; nFrame < WIDGET_LINK_FRAMES; nFrame++) {
+		uint8_t *pFrame = &pFrames[nFrame * WIDGET_STREAM_DMX_SIZE];
+
+		memcpy(pFrame, pFrame - WIDGET_STREAM_DMX_SIZE, WIDGET_STREAM_DMX_SIZE);
+
+		const uint32_t nChanged = ((nFrame % 500) == 499) ? (WIDGET_STREAM_DMX_SIZE - 1) : (static_cast<uint32_t>(rand()) % 20);
+
+		for (uint32_t i = 0; i < nChanged; i++) {
+			const uint32_t nSlot = (nChanged == (WIDGET_STREAM_DMX_SIZE - 1)) ? (1 + i) : (1 + (static_cast<uint32_t>(rand()) % (WIDGET_STREAM_DMX_SIZE - 1)));
+			pFrame[nSlot] = static_cast<uint8_t>(rand());
+		}
+	}
+}
+
+/*
+ * As widget_send_data_to_host() in widget.c
+ */
+static void send_data_to_host(void) {
+	if (widget_usb_tx_is_empty()) {
+		widget_stream_send_batch();
+	}
+
+	widget_usb_tx_poll();
+}
+
+struct TLinkResult {
+	uint32_t nBatches;
+	uint32_t nRecords;
+	uint32_t nDropped;	///< As the batch headers count them
+	uint32_t nErrors;
+};
+
+/*
+ * Parses the messages on the link as the host does
+ */
+static void link_parse(const uint8_t *pFrames, const uint8_t *pCapture, uint32_t nCaptured, struct TLinkResult &tResult) {
+	struct widget_stream_decoder decoder;
+
+	widget_stream_decoder_init(&decoder);
+
+	uint32_t nOffset = 0;
+
+	while (nOffset < nCaptured) {
+		if (((nCaptured - nOffset) < 5) || (pCapture[nOffset] != AMF_START_CODE) || (pCapture[nOffset + 1] != STREAM_BATCH)) {
+			printf("  FAIL      : no batch at %u\n", nOffset);
+			tResult.nErrors++;
+			return;
+		}
+
+		const uint32_t nLength = static_cast<uint32_t>(pCapture[nOffset + 2] | (pCapture[nOffset + 3] << 8));
+		const uint8_t *pBatch = &pCapture[nOffset + 4];
+
+		if ((nOffset + 5 + nLength > nCaptured) || (pBatch[nLength] != AMF_END_CODE) || (nLength < WIDGET_STREAM_BATCH_HEADER_SIZE)) {
+			printf("  FAIL      : batch at %u, length %u\n", nOffset, nLength);
+			tResult.nErrors++;
+			return;
+		}
+
+		tResult.nBatches++;
+		tResult.nDropped += static_cast<uint32_t>(pBatch[0] | (pBatch[1] << 8));
+
+		uint32_t nRecord = WIDGET_STREAM_BATCH_HEADER_SIZE;
+
+		while (nRecord < nLength) {
+			struct widget_stream_record_info info;
+			const int32_t nResult = widget_stream_decode(&decoder, &pBatch[nRecord], static_cast<uint16_t>(nLength - nRecord), &info);
+
+			if (nResult < 0) {
+				printf("  FAIL      : record at %u, error %d\n", nOffset + 4 + nRecord, nResult);
+				tResult.nErrors++;
+				return;
+			}
+
+			const uint32_t nFrame = info.timestamp / WIDGET_LINK_FRAME_US;
+
+			if ((nFrame >= WIDGET_LINK_FRAMES) || (decoder.frame_length != WIDGET_STREAM_DMX_SIZE) || (memcmp(decoder.frame, &pFrames[nFrame * WIDGET_STREAM_DMX_SIZE], WIDGET_STREAM_DMX_SIZE) != 0)) {
+				tResult.nErrors++;
+			}
+
+			tResult.nRecords++;
+			nRecord += static_cast<uint32_t>(nResult);
+		}
+
+		nOffset += 5 + nLength;
+	}
+
+	if (decoder.lost != 0) {
+		printf("  FAIL      : %u records lost\n", decoder.lost);
+		tResult.nErrors++;
+	}
+}
+
+static int run_link(const uint8_t *pFrames, uint8_t *pCapture, const struct TWidgetLink &tLink) {
+	struct _widget_stream_statistics tBefore;
+	struct _widget_stream_statistics tAfter;
+
+	widget_stream_get_statistics(&tBefore);
+
+	widgetusb_set_capture(pCapture, WIDGET_LINK_CAPTURE_SIZE);
+	widget_stream_set_mode(STREAM_MODE_ON);
+
+	uint64_t nBudget = 0;	///< Bytes * microseconds
+	uint32_t nMicros = 0;
+
+	for (uint32_t nFrame = 0; nFrame < WIDGET_LINK_FRAMES; nFrame++) {
+		widget_stream_dmx(&pFrames[nFrame * WIDGET_STREAM_DMX_SIZE], WIDGET_STREAM_DMX_SIZE, nFrame * WIDGET_LINK_FRAME_US);
+
+		for (; nMicros < ((nFrame + 1) * WIDGET_LINK_FRAME_US); nMicros += WIDGET_LINK_POLL_US) {
+			nBudget += static_cast<uint64_t>(tLink.nBytesPerSecond) * WIDGET_LINK_POLL_US;
+			widgetusb_add_credit(static_cast<uint32_t>(nBudget / 1000000));
+			nBudget %= 1000000;
+
+			send_data_to_host();
+		}
+	}
+
+	const uint32_t nOnTime = widgetusb_get_captured();
+
+	// The host keeps reading until the last batch is sent
+	for (uint32_t i = 0; i < 2; i++) {
+		do {
+			widgetusb_add_credit(WIDGETUSB_FIFO_SIZE);
+			send_data_to_host();
+		} while (!widget_usb_tx_is_empty());
+	}
+
+	widget_stream_set_mode(STREAM_MODE_OFF);
+	widget_stream_get_statistics(&tAfter);
+
+	const uint32_t nCaptured = widgetusb_get_captured();
+	struct TLinkResult tResult;
+
+	memset(&tResult, 0, sizeof(struct TLinkResult));
+
+	if (nCaptured > WIDGET_LINK_CAPTURE_SIZE) {
+		printf("  FAIL      : %u bytes on the link, capture is %u\n", nCaptured, WIDGET_LINK_CAPTURE_SIZE);
+		return -1;
+	}
+
+	link_parse(pFrames, pCapture, nCaptured, tResult);
+
+	const uint32_t nRecords = tAfter.records - tBefore.records;
+	const uint32_t nDropped = tAfter.records_dropped - tBefore.records_dropped;
+	const uint64_t nMaxOnTime = ((static_cast<uint64_t>(tLink.nBytesPerSecond) * WIDGET_LINK_FRAMES * WIDGET_LINK_FRAME_US) / 1000000) + WIDGETUSB_FIFO_SIZE;
+
+	printf(" %-10s : %u B/s, %u batches, %u records, %u dropped, %u bytes, %u errors\n", tLink.pName, tLink.nBytesPerSecond, tResult.nBatches, tResult.nRecords, tResult.nDropped, nCaptured, tResult.nErrors);
+
+	if (tResult.nErrors != 0) {
+		printf("  FAIL      : %s, %u records differ\n", tLink.pName, tResult.nErrors);
+	}
+
+	if ((tResult.nRecords + tResult.nDropped) != WIDGET_LINK_FRAMES) {
+		printf("  FAIL      : %s, %u records and %u dropped, expected %u frames\n", tLink.pName, tResult.nRecords, tResult.nDropped, WIDGET_LINK_FRAMES);
+		tResult.nErrors++;
+	}
+
+	if ((nRecords != tResult.nRecords) || (nDropped != tResult.nDropped)) {
+		printf("  FAIL      : %s, statistics %u records and %u dropped\n", tLink.pName, nRecords, nDropped);
+		tResult.nErrors++;
+	}
+
+	if (tLink.bIsSaturated != (tResult.nDropped != 0)) {
+		printf("  FAIL      : %s, %u dropped\n", tLink.pName, tResult.nDropped);
+		tResult.nErrors++;
+	}
+
+	if (nOnTime > nMaxOnTime) {
+		printf("  FAIL      : %s, %u bytes read, at most %u\n", tLink.pName, nOnTime, static_cast<uint32_t>(nMaxOnTime));
+		tResult.nErrors++;
+	}
+
+	return (tResult.nErrors == 0) ? 0 : -1;
+}
+
+int widget_benchmark(uint32_t nFrames, uint32_t nChanged) {
+	printf("Benchmark widget, %u frames, %u changed slots per frame\n", nFrames, nChanged);
+
+	int nResult = run_codec(nFrames, nChanged);
+
+	uint8_t *pFrames = new uint8_t[WIDGET_LINK_FRAMES * WIDGET_STREAM_DMX_SIZE];
+	uint8_t *pCapture = new uint8_t[WIDGET_LINK_CAPTURE_SIZE];
+
+	link_frames(pFrames);
+
+	printf("Link, %u frames at 44 Hz, FT245RL FIFO %u bytes\n", WIDGET_LINK_FRAMES, WIDGETUSB_FIFO_SIZE);
+
+	for (uint32_t i = 0; i < (sizeof(s_aLinks) / sizeof(s_aLinks[0])); i++) {
+		nResult |= run_link(pFrames, pCapture, s_aLinks[i]);
+	}
+
+	delete[] pCapture;
+	delete[] pFrames;
+
+	puts(nResult == 0 ? "PASS" : "FAIL");
+
+	return nResult;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file widgetusb.c
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/*
+ * The transmit path of lib-widget, widget_usb.c and widget_stream.c as they
+ * are built for the widget firmware, with a simulated FT245RL. The FIFO
+ * accepts a byte when the host has read one (the credit), see widget.cpp.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../../lib-widget/src/widget_usb.c"
+#include "../../lib-widget/src/widget_stream.c"
+
+#include "widgetusb.h"
+
+static uint8_t *capture;
+static uint32_t capture_size;
+static uint32_t captured;
+static uint32_t credit;
+
+void widgetusb_set_capture(uint8_t *buffer, uint32_t size) {
+	capture = buffer;
+	capture_size = size;
+	captured = 0;
+	credit = 0;
+}
+
+uint32_t widgetusb_get_captured(void) {
+	return captured;
+}
+
+void widgetusb_add_credit(uint32_t bytes) {
+	credit += bytes;
+
+	if (credit > WIDGETUSB_FIFO_SIZE) {
+		credit = WIDGETUSB_FIFO_SIZE;
+	}
+}
+
+void FT245RL_init(void) {
+}
+
+bool FT245RL_data_available(void) {
+	return false;
+}
+
+uint8_t FT245RL_read_data(void) {
+	return 0;
+}
+
+bool FT245RL_can_write(void) {
+	return credit != 0;
+}
+
+void FT245RL_write_data(uint8_t data) {
+	credit--;
+
+	if (captured < capture_size) {
+		capture[captured] = data;
+	}
+
+	captured++;
+}
@@ -0,0 +1,51 @@
+/**
+ * @file widgetusb.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef WIDGETUSB_H_
+#define WIDGETUSB_H_
+
+#include <stdint.h>
+
+#define WIDGETUSB_FIFO_SIZE	256	///< FT245RL transmit FIFO
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The bytes written to the simulated FT245RL are captured in buffer
+ */
+extern void widgetusb_set_capture(uint8_t *buffer, uint32_t size);
+extern uint32_t widgetusb_get_captured(void);
+/*
+ * The host has read bytes, the FIFO accepts at most WIDGETUSB_FIFO_SIZE
+ */
+extern void widgetusb_add_credit(uint32_t bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WIDGETUSB_H_ */
@@ -27,6 +27,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
+#include <signal.h>
 
 #include "hardware.h"
 #include "networklinux.h"
@@ -40,6 +41,9 @@
 #include "dmxmonitorparams.h"
 #include "storemonitor.h"
 
+#include "lightsetchain.h"
+#include "showfilerecorder.h"
+
 #include "spiflashstore.h"
 
 #include "remoteconfig.h"
@@ -49,6 +53,14 @@
 #include "firmwareversion.h"
 #include "software_version.h"
 
+#include "metrics.h"
+
+static volatile sig_atomic_t s_nStop;
+
+static void stop_handler(int nSignal) {
+	s_nStop = nSignal;
+}
+
 int main(int argc, char **argv) {
 	Hardware hw;
 	NetworkLinux nw;
@@ -56,7 +68,7 @@ int main(int argc, char **argv) {
 	FirmwareVersion fw(SOFTWARE_VERSION, __DATE__, __TIME__);
 
 	if (argc < 2) {
-		printf("Usage: %s ip_address|interface_name\n", argv[0]);
+		printf("Usage: %s ip_address|interface_name [record_file]\n", argv[0]);
 		return -1;
 	}
 
@@ -91,7 +103,22 @@ int main(int argc, char **argv) {
 		monitorParams.Set(&monitor);
 	}
 
-	bridge.SetOutput(&monitor);
+	// With a record file the received DMX is also recorded as an OLA show file
+	ShowFileRecorder recorder;
+	LightSetChain chain;
+
+	if (argc > 2) {
+		if (!recorder.Open(argv[2])) {
+			return -1;
+		}
+
+		chain.Add(&monitor, LIGHTSET_OUTPUT_TYPE_MONITOR);
+		chain.Add(&recorder);
+
+		bridge.SetOutput(&chain);
+	} else {
+		bridge.SetOutput(&monitor);
+	}
 
 	uint16_t nUniverse;
 	bool bIsSetIndividual = false;
@@ -113,9 +140,19 @@ int main(int argc, char **argv) {
 		bridge.SetUniverse(3, E131_OUTPUT_PORT, 3 + e131Params.GetUniverse());
 	}
 
+	for (uint32_t i = 0; i < SHOWFILE_RECORDER_MAX_PORTS; i++) {
+		if (bridge.GetUniverse(i, nUniverse)) {
+			recorder.SetUniverse(i, nUniverse);
+		}
+	}
+
 	nw.Print();
 	bridge.Print();
 
+	if (recorder.IsOpen()) {
+		recorder.Print();
+	}
+
 	RemoteConfig remoteConfig(REMOTE_CONFIG_E131, REMOTE_CONFIG_MODE_MONITOR, bridge.GetActiveOutputPorts());
 
 	StoreRemoteConfig storeRemoteConfig;
@@ -129,13 +166,24 @@ int main(int argc, char **argv) {
 	while (spiFlashStore.Flash())
 		;
 
+	nw.SetBatchSend(true);
+
+	signal(SIGINT, stop_handler);
+	signal(SIGTERM, stop_handler);
+
 	bridge.Start();
 
-	for (;;) {
+	while (s_nStop == 0) {
 		bridge.Run();
 		remoteConfig.Run();
 		spiFlashStore.Flash();
+		recorder.Run();
+		nw.Wait(1);
 	}
 
+	bridge.Stop();
+	recorder.Close();
+	metrics_dump();
+
 	return 0;
 }
@@ -0,0 +1,197 @@
+/**
+ * @file main.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/*
+ * Art-Net load generator: sends ArtDmx for a range of universes at a fixed
+ * frame rate, for testing the Linux network backend on loopback.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "artnet.h"
+#include "packets.h"
+
+#define BATCH_SIZE	64
+
+static volatile sig_atomic_t s_nStop;
+
+static void stop_handler(int nSignal) {
+	s_nStop = nSignal;
+}
+
+static uint64_t get_nanos(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL) + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		printf("Usage: %s ip_address [universes] [fps] [seconds]\n", argv[0]);
+		return -1;
+	}
+
+	struct sockaddr_in to;
+	memset(&to, 0, sizeof(struct sockaddr_in));
+	to.sin_family = AF_INET;
+	to.sin_port = htons(ARTNET_UDP_PORT);
+
+	if (inet_pton(AF_INET, argv[1], &to.sin_addr) != 1) {
+		fprintf(stderr, "Invalid ip address %s\n", argv[1]);
+		return -1;
+	}
+
+	const uint32_t nUniverses = (argc > 2) ? static_cast<uint32_t>(atoi(argv[2])) : 1024;
+	const uint32_t nFps = (argc > 3) ? static_cast<uint32_t>(atoi(argv[3])) : 44;
+	const uint32_t nSeconds = (argc > 4) ? static_cast<uint32_t>(atoi(argv[4])) : 10;
+
+	if ((nUniverses == 0) || (nUniverses > 32768) || (nFps == 0)) {
+		fprintf(stderr, "Invalid arguments\n");
+		return -1;
+	}
+
+	const int nSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+	if (nSocket == -1) {
+		perror("socket");
+		return -1;
+	}
+
+	const int nTrue = 1;
+
+	if (setsockopt(nSocket, SOL_SOCKET, SO_BROADCAST, &nTrue, sizeof(int)) == -1) {
+		perror("setsockopt(SO_BROADCAST)");
+	}
+
+	struct TArtDmx *pPackets = new struct TArtDmx[BATCH_SIZE];
+	struct mmsghdr *pMsgs = new struct mmsghdr[BATCH_SIZE];
+	struct iovec *pIov = new struct iovec[BATCH_SIZE];
+
+	memset(pMsgs, 0, BATCH_SIZE * sizeof(struct mmsghdr));
+
+	for (uint32_t i = 0; i < BATCH_SIZE; i++) {
+		memcpy(pPackets[i].Id, NODE_ID, sizeof(pPackets[i].Id));
+		pPackets[i].OpCode = OP_DMX;
+		pPackets[i].ProtVerHi = 0;
+		pPackets[i].ProtVerLo = ARTNET_PROTOCOL_REVISION;
+		pPackets[i].Physical = 0;
+		pPackets[i].LengthHi = (ARTNET_DMX_LENGTH >> 8);
+		pPackets[i].Length = (ARTNET_DMX_LENGTH & 0xFF);
+
+		pIov[i].iov_base = &pPackets[i];
+		pIov[i].iov_len = sizeof(struct TArtDmx);
+		pMsgs[i].msg_hdr.msg_name = &to;
+		pMsgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+		pMsgs[i].msg_hdr.msg_iov = &pIov[i];
+		pMsgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	signal(SIGINT, stop_handler);
+	signal(SIGTERM, stop_handler);
+
+	printf("%u universes at %u fps to %s:%u, %u packets/s\n", nUniverses, nFps, argv[1], ARTNET_UDP_PORT, nUniverses * nFps);
+
+	const uint64_t nFrameNanos = 1000000000ULL / nFps;
+	const uint64_t nStart = get_nanos();
+	uint64_t nNextFrame = nStart;
+	uint64_t nSent = 0;
+	uint64_t nErrors = 0;
+	uint32_t nFrames = 0;
+	uint32_t nLateFrames = 0;
+	uint8_t nSequence = 1;
+
+	while ((s_nStop == 0) && ((nSeconds == 0) || (nFrames < (nSeconds * nFps)))) {
+		for (uint32_t nUniverse = 0; nUniverse < nUniverses; nUniverse += BATCH_SIZE) {
+			const uint32_t nCount = ((nUniverses - nUniverse) < BATCH_SIZE) ? (nUniverses - nUniverse) : BATCH_SIZE;
+
+			for (uint32_t i = 0; i < nCount; i++) {
+				pPackets[i].Sequence = nSequence;
+				pPackets[i].PortAddress = static_cast<uint16_t>(nUniverse + i);
+				memset(pPackets[i].Data, static_cast<int>(nFrames & 0xFF), ARTNET_DMX_LENGTH);
+			}
+
+			uint32_t nDone = 0;
+
+			while (nDone < nCount) {
+				const int nResult = sendmmsg(nSocket, &pMsgs[nDone], nCount - nDone, 0);
+
+				if (nResult <= 0) {
+					if ((errno == ENOBUFS) || (errno == EAGAIN)) {
+						nErrors++;
+						continue;
+					}
+					perror("sendmmsg");
+					s_nStop = 1;
+					break;
+				}
+
+				nDone += static_cast<uint32_t>(nResult);
+			}
+
+			nSent += nDone;
+		}
+
+		nFrames++;
+		nSequence = (nSequence == 255) ? 1 : static_cast<uint8_t>(nSequence + 1);
+		nNextFrame += nFrameNanos;
+
+		const uint64_t nNow = get_nanos();
+
+		if (nNow >= nNextFrame) {
+			nLateFrames++;
+			continue;
+		}
+
+		struct timespec ts;
+		ts.tv_sec = static_cast<time_t>((nNextFrame - nNow) / 1000000000ULL);
+		ts.tv_nsec = static_cast<long>((nNextFrame - nNow) % 1000000000ULL);
+		nanosleep(&ts, 0);
+	}
+
+	const double fSeconds = static_cast<double>(get_nanos() - nStart) / 1e9;
+
+	printf("%u frames, %llu packets in %.2f s : %.0f packets/s, %u late frames, %llu send retries\n", nFrames,
+			static_cast<unsigned long long>(nSent), fSeconds, static_cast<double>(nSent) / fSeconds, nLateFrames,
+			static_cast<unsigned long long>(nErrors));
+
+	delete[] pIov;
+	delete[] pMsgs;
+	delete[] pPackets;
+
+	close(nSocket);
+
+	return 0;
+}
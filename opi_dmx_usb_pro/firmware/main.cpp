@@ -73,7 +73,8 @@ struct _poll {
 		{ widget_received_rdm_packet },
 		{ widget_rdm_timeout },
 		{ widget_sniffer_rdm },
-		{ widget_sniffer_dmx } };
+		{ widget_sniffer_dmx },
+		{ widget_send_data_to_host } };
 
 void notmain(void) {
 	// Do not change order
@@ -55,6 +55,10 @@
 #include "storerdmdevice.h"
 // DMX Input
 #include "dmxinput.h"
+// Show file recording
+#include "lightsetchain.h"
+#include "showfilerecorder.h"
+#include "showfilerecorderparams.h"
 
 #include "spiflashinstall.h"
 #include "spiflashstore.h"
@@ -132,6 +136,7 @@ void notmain(void) {
 
 	DMXSend *pDmxOutput;
 	DmxInput *pDmxInput;
+	ShowFileRecorder *pRecorder = 0;
 
 	if (artnetparams.GetDirection() == ARTNET_INPUT_PORT) {
 		pDmxInput = new DmxInput;
@@ -154,7 +159,37 @@ void notmain(void) {
 
 		node.SetUniverseSwitch(0, ARTNET_OUTPUT_PORT, artnetparams.GetUniverse());
 		node.SetDirectUpdate(false);
-		node.SetOutput(pDmxOutput);
+
+		ShowFileRecorderParams recorderParams;
+
+		// With a record.txt the received DMX is also recorded into a show file on the SD card
+		if (recorderParams.Load()) {
+			recorderParams.Dump();
+
+			pRecorder = new ShowFileRecorder;
+			assert(pRecorder != 0);
+
+			uint16_t nUniverse;
+
+			if (pRecorder->Open(recorderParams.GetShowFileName()) && node.GetPortAddress(0, nUniverse)) {
+				pRecorder->SetUniverse(0, nUniverse);
+
+				LightSetChain *pChain = new LightSetChain;
+				assert(pChain != 0);
+
+				pChain->Add(pDmxOutput, LIGHTSET_OUTPUT_TYPE_DMX);
+				pChain->Add(pRecorder);
+
+				node.SetOutput(pChain);
+			} else {
+				delete pRecorder;
+				pRecorder = 0;
+			}
+		}
+
+		if (pRecorder == 0) {
+			node.SetOutput(pDmxOutput);
+		}
 
 		if (artnetparams.IsRdm()) {
 			RDMDeviceParams rdmDeviceParams(&storeRdmDevice);
@@ -179,6 +214,10 @@ void notmain(void) {
 
 	node.Print();
 
+	if (pRecorder != 0) {
+		pRecorder->Print();
+	}
+
 	display.SetTitle("Art-Net 4 %s", artnetparams.GetDirection() == ARTNET_INPUT_PORT ? "DMX Input" : (artnetparams.IsRdm() ? "RDM" : "DMX Output"));
 	display.Set(2, DISPLAY_UDF_LABEL_NODE_NAME);
 	display.Set(3, DISPLAY_UDF_LABEL_IP);
@@ -225,6 +264,9 @@ void notmain(void) {
 		hw.WatchdogFeed();
 		nw.Run();
 		node.Run();
+		if (pRecorder != 0) {
+			pRecorder->Run();
+		}
 		remoteConfig.Run();
 		spiFlashStore.Flash();
 		lb.Run();
@@ -69,6 +69,8 @@
 #include "displayudfhandler.h"
 #include "displayhandler.h"
 
+#include "profiler.h"
+
 extern "C" {
 
 void notmain(void) {
@@ -285,14 +287,17 @@ void notmain(void) {
 
 	hw.WatchdogInit();
 
+	PROFILER_INIT();
+
 	for (;;) {
+		PROFILE_LOOP();
 		hw.WatchdogFeed();
-		nw.Run();
-		node.Run();
-		remoteConfig.Run();
-		spiFlashStore.Flash();
+		{ PROFILE_SCOPE("nw.Run"); nw.Run(); }
+		{ PROFILE_SCOPE("node.Run"); node.Run(); }
+		{ PROFILE_SCOPE("remoteConfig.Run"); remoteConfig.Run(); }
+		{ PROFILE_SCOPE("spiFlashStore.Flash"); spiFlashStore.Flash(); }
 		lb.Run();
-		display.Run();
+		{ PROFILE_SCOPE("display.Run"); display.Run(); }
 	}
 }
 
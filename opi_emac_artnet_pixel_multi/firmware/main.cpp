@@ -226,6 +226,7 @@ void notmain(void) {
 		hw.WatchdogFeed();
 		nw.Run();
 		node.Run();;
+		ws28xxDmxMulti.Run();
 		remoteConfig.Run();
 		spiFlashStore.Flash();
 		lb.Run();
@@ -305,6 +305,11 @@ void notmain(void) {
 		hw.WatchdogFeed();
 		nw.Run();
 		node.Run();
+#if defined (ORANGE_PI_ONE)
+		pSlushDmx->Run();
+#else
+		pSparkFunDmx->Run();
+#endif
 		identify.Run();
 #if defined (ORANGE_PI)
 		remoteConfig.Run();
@@ -52,6 +52,10 @@
 #include "storedmxsend.h"
 // DMX Input
 #include "dmxinput.h"
+// Show file recording
+#include "lightsetchain.h"
+#include "showfilerecorder.h"
+#include "showfilerecorderparams.h"
 
 #include "spiflashinstall.h"
 #include "spiflashstore.h"
@@ -118,6 +122,7 @@ void notmain(void) {
 
 	DMXSend *pDmxOutput;
 	DmxInput *pDmxInput;
+	ShowFileRecorder *pRecorder = 0;
 
 	const uint16_t nUniverse = e131params.GetUniverse();
 
@@ -142,11 +147,43 @@ void notmain(void) {
 
 		bridge.SetUniverse(0, E131_OUTPUT_PORT, nUniverse);
 		bridge.SetDirectUpdate(false);
-		bridge.SetOutput(pDmxOutput);
+
+		ShowFileRecorderParams recorderParams;
+
+		// With a record.txt the received DMX is also recorded into a show file on the SD card
+		if (recorderParams.Load()) {
+			recorderParams.Dump();
+
+			pRecorder = new ShowFileRecorder;
+			assert(pRecorder != 0);
+
+			if (pRecorder->Open(recorderParams.GetShowFileName())) {
+				pRecorder->SetUniverse(0, nUniverse);
+
+				LightSetChain *pChain = new LightSetChain;
+				assert(pChain != 0);
+
+				pChain->Add(pDmxOutput, LIGHTSET_OUTPUT_TYPE_DMX);
+				pChain->Add(pRecorder);
+
+				bridge.SetOutput(pChain);
+			} else {
+				delete pRecorder;
+				pRecorder = 0;
+			}
+		}
+
+		if (pRecorder == 0) {
+			bridge.SetOutput(pDmxOutput);
+		}
 	}
 
 	bridge.Print();
 
+	if (pRecorder != 0) {
+		pRecorder->Print();
+	}
+
 	display.SetTitle("sACN E1.31 DMX %s", e131params.GetDirection() == E131_INPUT_PORT ? "Input" : "Output");
 	display.Set(2, DISPLAY_UDF_LABEL_BOARDNAME);
 	display.Set(3, DISPLAY_UDF_LABEL_IP);
@@ -193,6 +230,9 @@ void notmain(void) {
 		hw.WatchdogFeed();
 		nw.Run();
 		bridge.Run();
+		if (pRecorder != 0) {
+			pRecorder->Run();
+		}
 		remoteConfig.Run();
 		spiFlashStore.Flash();
 		lb.Run();
@@ -210,6 +210,7 @@ void notmain(void) {
 		hw.WatchdogFeed();
 		nw.Run();
 		bridge.Run();
+		ws28xxDmxMulti.Run();
 		remoteConfig.Run();
 		spiFlashStore.Flash();
 		lb.Run();
@@ -354,6 +354,10 @@ void notmain(void) {
 		break;
 	case LTC_READER_SOURCE_INTERNAL:
 		ltcGenerator.Start();
+		if (ltcParams.IsJamSync()) {
+			ltcReader.StartDecoder();
+			ltcGenerator.SetJamSync(ltcReader.GetDecoder());
+		}
 		ltcGenerator.Print();
 		break;
 	case LTC_READER_SOURCE_APPLEMIDI:
@@ -33,7 +33,7 @@
 
 #include "oscserver.h"
 #include "osc.h"
-#include "oscmessage.h"
+#include "oscsimplemessage.h"
 
 #include "network.h"
 
@@ -160,7 +160,7 @@ void OSCServer::Run(void) {
 
 		// */pitch f
 		if (memcmp(&m_pBuffer[m_nPathLength], aPitch, PITCH_LENGTH) == 0) {
-			OSCMessage Msg(m_pBuffer, nBytesReceived);
+			OSCSimpleMessage Msg(reinterpret_cast<const uint8_t*>(m_pBuffer), nBytesReceived);
 
 			const float fValue = Msg.GetFloat(0);
 
@@ -297,7 +297,7 @@ void OSCServer::Run(void) {
 			// type i
 			if (nCommandLength == (m_nPathLength + TCNET_LENGTH + TCNETTYPE_LENGTH)) {
 				if (memcmp(&m_pBuffer[m_nPathLength + TCNET_LENGTH], aTCNetType, TCNETTYPE_LENGTH) == 0) {
-					OSCMessage Msg(m_pBuffer, nBytesReceived);
+					OSCSimpleMessage Msg(reinterpret_cast<const uint8_t*>(m_pBuffer), nBytesReceived);
 
 					const int nValue = Msg.GetInt(0);
 
@@ -330,7 +330,7 @@ void OSCServer::Run(void) {
 			// timecode i
 			if (nCommandLength == (m_nPathLength + TCNET_LENGTH + TCNETTIMECODE_LENGTH)) {
 				if (memcmp(&m_pBuffer[m_nPathLength + TCNET_LENGTH], aTCNetType, TCNETTIMECODE_LENGTH) == 0) {
-					OSCMessage Msg(m_pBuffer, nBytesReceived);
+					OSCSimpleMessage Msg(reinterpret_cast<const uint8_t*>(m_pBuffer), nBytesReceived);
 
 					const int nValue = Msg.GetInt(0);
 					const bool bUseTimeCode = (nValue > 0);
@@ -352,7 +352,7 @@ void OSCServer::Run(void) {
 			// ws28xx/master i
 			if (nCommandLength == (m_nPathLength + WS28XX_LENGTH + WS28XXMASTER_LENGTH)) {
 				if (memcmp(&m_pBuffer[m_nPathLength + WS28XX_LENGTH], aWS28xxMaster, WS28XXMASTER_LENGTH) == 0) {
-					OSCMessage Msg(m_pBuffer, nBytesReceived);
+					OSCSimpleMessage Msg(reinterpret_cast<const uint8_t*>(m_pBuffer), nBytesReceived);
 
 					const int nValue = Msg.GetInt(0);
 
@@ -366,9 +366,14 @@ void OSCServer::Run(void) {
 			// ws28xx/message string
 			if (nCommandLength == (m_nPathLength + WS28XX_LENGTH + WS28XXMESSAGE_LENGTH)) {
 				if (memcmp(&m_pBuffer[m_nPathLength + WS28XX_LENGTH], aWS28xxMessage, WS28XXMESSAGE_LENGTH) == 0) {
-					OSCMessage Msg(m_pBuffer, nBytesReceived);
+					OSCSimpleMessage Msg(reinterpret_cast<const uint8_t*>(m_pBuffer), nBytesReceived);
+
+					const char *pString = Msg.GetString(0);
+
+					if (pString == 0) {
+						return;
+					}
 
-					char *pString = Msg.GetString(0);
 					const uint8_t nSize = strlen(pString);
 
 					LtcDisplayWS28xx::Get()->SetMessage(pString, nSize);
@@ -414,7 +419,7 @@ void OSCServer::Run(void) {
 }
 
 void OSCServer::SetWS28xxRGB(uint32_t nSize, TLtcDisplayWS28xxColourIndex tIndex) {
-	OSCMessage Msg(m_pBuffer, nSize);
+	OSCSimpleMessage Msg(reinterpret_cast<const uint8_t*>(m_pBuffer), nSize);
 
 	if (Msg.GetArgc() == 3) {
 		const int nRed = Msg.GetInt(0);
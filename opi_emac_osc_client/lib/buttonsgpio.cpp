@@ -122,24 +122,21 @@ void ButtonsGpio::Run(void) {
 
 		DEBUG_PRINTF("%d-%d-%d-%d", BUTTON(BUTTON0_GPIO), BUTTON(BUTTON1_GPIO), BUTTON(BUTTON2_GPIO), BUTTON(BUTTON3_GPIO));
 
-		if (BUTTON_STATE(BUTTON0_GPIO)) {
-			m_pOscClient->SendCmd(0);
-			DEBUG_PUTS("");
+		const uint8_t aButtons[4] = { BUTTON0_GPIO, BUTTON1_GPIO, BUTTON2_GPIO, BUTTON3_GPIO };
+		uint8_t aCmds[4];
+		uint32_t nCmds = 0;
+
+		for (uint32_t i = 0; i < 4; i++) {
+			if (BUTTON_STATE(aButtons[i])) {
+				aCmds[nCmds++] = static_cast<uint8_t>(i);
+			}
 		}
 
-		if (BUTTON_STATE(BUTTON1_GPIO)) {
-			m_pOscClient->SendCmd(1);
-			DEBUG_PUTS("");
-		}
-
-		if (BUTTON_STATE(BUTTON2_GPIO)) {
-			m_pOscClient->SendCmd(2);
-			DEBUG_PUTS("");
-		}
-
-		if (BUTTON_STATE(BUTTON3_GPIO)) {
-			m_pOscClient->SendCmd(3);
-			DEBUG_PUTS("");
+		// Buttons pressed together are sent as one bundle, executed at the same time
+		if (nCmds == 1) {
+			m_pOscClient->SendCmd(aCmds[0]);
+		} else if (nCmds > 1) {
+			m_pOscClient->SendCmds(aCmds, nCmds);
 		}
 	}
 }
@@ -118,11 +118,21 @@ void ButtonsMcp::Run(void) {
 
 		DEBUG_PRINTF("%.2x", nButtonsChanged);
 
+		uint8_t aCmds[8];
+		uint32_t nCmds = 0;
+
 		for (uint32_t i = 0; i < 8; i++) {
 			if ((nButtonsChanged & (1 << i)) == ((1 << i))) {
-				m_pOscClient->SendCmd(i);
+				aCmds[nCmds++] = static_cast<uint8_t>(i);
 			}
 		}
+
+		// Buttons pressed together are sent as one bundle, executed at the same time
+		if (nCmds == 1) {
+			m_pOscClient->SendCmd(aCmds[0]);
+		} else if (nCmds > 1) {
+			m_pOscClient->SendCmds(aCmds, nCmds);
+		}
 	}
 }
 
@@ -63,6 +63,7 @@ struct _poll {
 		{ widget_rdm_timeout },
 		{ widget_sniffer_rdm },
 		{ widget_sniffer_dmx },
+		{ widget_send_data_to_host },
 		{ led_blink } };
 
 struct _event {